@@ -7,11 +7,14 @@
 #define PIKA_BINLOG_H_
 
 #include <atomic>
+#include <deque>
+#include <vector>
 
 #include "pstd/include/env.h"
 #include "pstd/include/pstd_mutex.h"
 #include "pstd/include/pstd_status.h"
 #include "pstd/include/noncopyable.h"
+#include "include/pika_binlog_tail_cache.h"
 #include "include/pika_define.h"
 
 std::string NewFileName(const std::string& name, uint32_t current);
@@ -51,7 +54,14 @@ class Binlog : public pstd::noncopyable {
   void Lock() { mutex_.lock(); }
   void Unlock() { mutex_.unlock(); }
 
+  /*
+   * Put is safe to be called concurrently. Concurrent callers are grouped:
+   * the first one in the queue becomes the leader, writes the whole batch and
+   * publishes the producer offset and logic id once for all of them.
+   */
   pstd::Status Put(const std::string& item);
+  // Appends items back to back within a single group commit batch
+  pstd::Status Put(const std::vector<std::string>& items);
 
   pstd::Status GetProducerStatus(uint32_t* filenum, uint64_t* pro_offset, uint32_t* term = nullptr, uint64_t* logic_id = nullptr);
   /*
@@ -77,16 +87,54 @@ class Binlog : public pstd::noncopyable {
 
   void Close();
 
+  struct GroupCommitStats {
+    uint64_t batches = 0;
+    uint64_t items = 0;
+    uint64_t max_batch_size = 0;
+    uint64_t wait_us = 0;
+  };
+  GroupCommitStats group_commit_stats() {
+    GroupCommitStats stats;
+    stats.batches = gc_batches_.load(std::memory_order_relaxed);
+    stats.items = gc_items_.load(std::memory_order_relaxed);
+    stats.max_batch_size = gc_max_batch_size_.load(std::memory_order_relaxed);
+    stats.wait_us = gc_wait_us_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+  // The records published last, for replicas that are close to the tail
+  BinlogTailCache* tail_cache() { return &tail_cache_; }
+
  private:
-  pstd::Status Put(const char* item, int len);
-  pstd::Status EmitPhysicalRecord(RecordType t, const char* ptr, size_t n, int* temp_pro_offset);
+  struct Writer {
+    Writer(const std::string* items, size_t num) : items(items), num(num) {}
+    const std::string* items;
+    size_t num;
+    pstd::Status status;
+    bool done = false;
+    pstd::CondVar cv;
+  };
+
+  static int GroupCommitMaxBatch();
+  static int64_t GroupCommitMaxDelayUs();
+  static int64_t TailCacheSize();
+
+  pstd::Status Append(const std::string* items, size_t num);
+  // Need to hold mutex_, write batch and publish the producer status once,
+  // written is the number of writers whose items are all written
+  pstd::Status WriteBatch(const std::vector<Writer*>& batch, size_t* written);
+  // Need to hold mutex_, moves the records of a published batch into tail_cache_
+  void CacheTail(std::vector<BinlogTailCache::Record>* records);
+  // Need to hold mutex_, pro_offset is the current uncommitted producer offset
+  pstd::Status Put(const char* item, int len, uint64_t* pro_offset, uint64_t logic_id);
+  pstd::Status EmitPhysicalRecord(RecordType t, const char* ptr, size_t n, uint64_t* temp_pro_offset);
   static pstd::Status AppendPadding(pstd::WritableFile* file, uint64_t* len);
   void InitLogFile();
 
   /*
    * Produce
    */
-  pstd::Status Produce(const pstd::Slice& item, int* pro_offset);
+  pstd::Status Produce(const pstd::Slice& item, uint64_t* pro_offset);
 
   std::atomic<bool> opened_;
 
@@ -108,6 +156,19 @@ class Binlog : public pstd::noncopyable {
   std::string filename_;
 
   std::atomic<bool> binlog_io_error_;
+
+  /*
+   * Group commit
+   */
+  pstd::Mutex writers_mutex_;
+  std::deque<Writer*> writers_;
+
+  std::atomic<uint64_t> gc_batches_ = 0;
+  std::atomic<uint64_t> gc_items_ = 0;
+  std::atomic<uint64_t> gc_max_batch_size_ = 0;
+  std::atomic<uint64_t> gc_wait_us_ = 0;
+
+  BinlogTailCache tail_cache_;
 };
 
 #endif
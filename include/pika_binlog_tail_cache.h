@@ -0,0 +1,75 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef PIKA_BINLOG_TAIL_CACHE_H_
+#define PIKA_BINLOG_TAIL_CACHE_H_
+
+#include <atomic>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "include/pika_define.h"
+
+/*
+ * The most recently published binlog records of one DB, kept in memory so
+ * that replicas close to the tail of the binlog are served without reading
+ * and decoding the binlog file again for each one of them. Records are
+ * evicted from the front once the total size of their items is above the
+ * capacity, a lagging replica whose offset is not in the cache any more
+ * falls back to its PikaBinlogReader.
+ */
+class BinlogTailCache {
+ public:
+  struct Record {
+    // Where a PikaBinlogReader stands right before reading this record
+    BinlogOffset prev_offset;
+    // Where it stands right after, with the term and logic id of the record,
+    // the same offset PikaBinlogReader::Get reports
+    LogOffset offset;
+    // The encoded binlog item
+    std::string binlog;
+  };
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t served_records = 0;
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+  };
+
+  BinlogTailCache() = default;
+
+  // Appends records published back to back, trimming the cache down to
+  // capacity bytes afterwards. A capacity of 0 disables the cache.
+  void Append(std::vector<Record>* records, uint64_t capacity);
+  void Clear();
+
+  /*
+   * Copies the records following offset into records, at most max_num of
+   * them and stopping at the first one after their size exceeds max_bytes.
+   * Returns false if the cache does not hold the records following offset,
+   * a replica that has caught up with the cache gets true and no record.
+   */
+  bool Read(const BinlogOffset& offset, size_t max_num, size_t max_bytes, std::vector<Record>* records);
+
+  Stats stats();
+
+ private:
+  // Need to hold rwlock_
+  void Trim(uint64_t capacity);
+
+  std::shared_mutex rwlock_;
+  std::deque<Record> records_;
+  uint64_t bytes_ = 0;
+
+  std::atomic<uint64_t> hits_ = 0;
+  std::atomic<uint64_t> misses_ = 0;
+  std::atomic<uint64_t> served_records_ = 0;
+};
+
+#endif  // PIKA_BINLOG_TAIL_CACHE_H_
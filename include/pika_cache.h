@@ -6,15 +6,20 @@
 #ifndef PIKA_CACHE_H_
 #define PIKA_CACHE_H_
 
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <memory>
 #include <sstream>
 #include <vector>
 
 #include "include/pika_define.h"
 #include "include/pika_zset.h"
 #include "include/pika_command.h"
+#include "pstd/include/frequency_sketch.h"
 #include "pstd/include/pstd_mutex.h"
 #include "pstd/include/pstd_status.h"
+#include "pstd/include/single_flight.h"
 #include "cache/include/cache.h"
 #include "storage/storage.h"
 
@@ -34,6 +39,12 @@ struct CacheInfo {
   int64_t misses = 0;
   uint64_t async_load_keys_num = 0;
   uint32_t waitting_load_keys_num = 0;
+  uint64_t coalesced_misses = 0;
+  uint64_t admission_rejects = 0;
+  uint64_t loads = 0;
+  uint64_t load_us = 0;
+  std::vector<CacheKeyStat> hot_keys;
+  std::vector<CacheShardInfo> shards;
   void clear() {
     status = PIKA_CACHE_STATUS_NONE;
     cache_num = 0;
@@ -43,6 +54,12 @@ struct CacheInfo {
     misses = 0;
     async_load_keys_num = 0;
     waitting_load_keys_num = 0;
+    coalesced_misses = 0;
+    admission_rejects = 0;
+    loads = 0;
+    load_us = 0;
+    hot_keys.clear();
+    shards.clear();
   }
 };
 
@@ -63,7 +80,18 @@ class PikaCache : public pstd::noncopyable, public std::enable_shared_from_this<
   void Info(CacheInfo& info);
   bool Exists(std::string& key);
   void FlushCache(void);
-  void ProcessCronTask(void);
+
+  /*
+   * Read path of Cmd::DoCommand. Every read is counted in the admission
+   * sketch and the hot key list. A missed key is loaded from the db by a
+   * single reader, BeginLoad returns false to the others once it is done,
+   * they read the cache again. Admit tells whether the loaded key may go
+   * into the cache, see cache-admission.
+   */
+  void RecordRead(const std::string& key, bool hit);
+  bool BeginLoad(const std::string& key);
+  void EndLoad(const std::string& key, uint64_t load_us);
+  bool Admit(const std::string& key);
 
   rocksdb::Status Del(const std::vector<std::string>& keys);
   rocksdb::Status Expire(std::string& key, int64_t ttl);
@@ -209,6 +237,9 @@ class PikaCache : public pstd::noncopyable, public std::enable_shared_from_this<
   bool ReloadCacheKeyIfNeeded(cache::RedisCache* cache_obj, std::string& key, int mem_len = -1, int db_len = -1,
                               const std::shared_ptr<DB>& db = nullptr);
   rocksdb::Status CleanCacheKeyIfNeeded(cache::RedisCache* cache_obj, std::string& key);
+  // Sized for the keys cache-maxmemory holds, see kCachedKeyBytes
+  static size_t AdmissionSketchCapacity();
+  static CacheKeyStat* FindHotKey(std::vector<CacheKeyStat>* hot_keys, const std::string& key, bool insert);
 
  private:
   std::atomic<int> cache_status_;
@@ -218,9 +249,44 @@ class PikaCache : public pstd::noncopyable, public std::enable_shared_from_this<
   int zset_cache_start_direction_ = 0;
   int zset_cache_field_num_per_key_ = 0;
   std::shared_mutex rwlock_;
-  std::unique_ptr<PikaCacheLoadThread> cache_load_thread_;
   std::vector<cache::RedisCache*> caches_;
   std::vector<std::shared_ptr<pstd::Mutex>> cache_mutexs_;
+  /*
+   * One per shard, loads its keys and expires them. Memory and eviction
+   * stay global: rediscache counts memory in its allocator and evicts
+   * against one process wide cache-maxmemory, a limit per shard needs
+   * support in rediscache first. The loaders are not pinned to CPUs either,
+   * the worker threads they would follow are not pinned.
+   */
+  std::vector<std::unique_ptr<PikaCacheLoadThread>> cache_load_threads_;
+
+  // How long readers wait for the load of a key another reader missed
+  static constexpr std::chrono::milliseconds kLoadWait{100};
+  // Random keys of the shard whose coldest stands in for the victim a loaded key would evict
+  static constexpr int kAdmitSamples = 5;
+  // A rough size of a cached key with its value, to guess how many keys the cache holds
+  static constexpr uint64_t kCachedKeyBytes = 512;
+  static constexpr size_t kMinSketchCapacity = 1 << 12;
+  static constexpr size_t kMaxSketchCapacity = 1 << 22;
+  // Hits are only counted per key from this sketch frequency on
+  static constexpr int kHotKeyFrequency = 8;
+  static constexpr size_t kHotKeyNum = 32;
+  static constexpr size_t kHotKeyStripes = 16;
+
+  // Replaced by Init and ResetConfig under rwlock_, read under its shared lock
+  std::unique_ptr<pstd::FrequencySketch> admission_sketch_;
+  pstd::SingleFlight loads_;
+  std::atomic<uint64_t> coalesced_misses_ = 0;
+  std::atomic<uint64_t> admission_rejects_ = 0;
+  std::atomic<uint64_t> loads_num_ = 0;
+  std::atomic<uint64_t> load_us_ = 0;
+  // A key is counted in the space-saving list of kHotKeyNum keys of its stripe
+  struct HotKeyStripe {
+    pstd::Mutex mu;
+    std::vector<CacheKeyStat> keys;
+  };
+  std::array<HotKeyStripe, kHotKeyStripes> hot_keys_;
+  HotKeyStripe& HotKeyStripeOf(const std::string& key);
 };
 
 #endif
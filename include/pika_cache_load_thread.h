@@ -14,12 +14,19 @@
 
 #include "include/pika_cache.h"
 #include "include/pika_define.h"
+#include "cache/include/cache.h"
 #include "net/include/net_thread.h"
 #include "storage/storage.h"
 
+/*
+ * Loads the keys of one cache shard from the db in the background and runs
+ * the active expire cycle of the shard, so shards neither share a load queue
+ * nor wait for each other to expire keys.
+ */
 class PikaCacheLoadThread : public net::Thread {
  public:
-  PikaCacheLoadThread(int zset_cache_start_direction, int zset_cache_field_num_per_key);
+  PikaCacheLoadThread(int zset_cache_start_direction, int zset_cache_field_num_per_key,
+                      cache::RedisCache* cache_obj, pstd::Mutex* cache_mutex);
   ~PikaCacheLoadThread() override;
 
   uint64_t AsyncLoadKeysNum(void) { return async_load_keys_num_; }
@@ -33,6 +40,7 @@ class PikaCacheLoadThread : public net::Thread {
   bool LoadSet(std::string& key, const std::shared_ptr<DB>& db);
   bool LoadZset(std::string& key, const std::shared_ptr<DB>& db);
   bool LoadKey(const char key_type, std::string& key, const std::shared_ptr<DB>& db);
+  void ActiveExpireCycleIfNeeded();
   virtual void* ThreadMain() override;
 
  private:
@@ -50,6 +58,10 @@ class PikaCacheLoadThread : public net::Thread {
   int zset_cache_start_direction_;
   int zset_cache_field_num_per_key_;
   std::shared_ptr<PikaCache> cache_;
+  // The shard, guarded by cache_mutex_
+  cache::RedisCache* cache_obj_;
+  pstd::Mutex* cache_mutex_;
+  uint64_t last_expire_cycle_us_ = 0;
 };
 
 #endif  // PIKA_CACHE_LOAD_THREAD_H_
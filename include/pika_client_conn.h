@@ -67,9 +67,9 @@ class PikaClientConn : public net::RedisConn {
                  const net::HandleType& handle_type, int max_conn_rbuf_size);
   ~PikaClientConn() = default;
 
-  void ProcessRedisCmds(const std::vector<net::RedisCmdArgsType>& argvs, bool async, std::string* response) override;
+  void ProcessRedisCmds(std::vector<net::RedisCmdArgsType>&& argvs, bool async, std::string* response) override;
 
-  void BatchExecRedisCmd(const std::vector<net::RedisCmdArgsType>& argvs);
+  void BatchExecRedisCmd(std::vector<net::RedisCmdArgsType>&& argvs);
   int DealMessage(const net::RedisCmdArgsType& argv, std::string* response) override { return 0; }
   static void DoBackgroundTask(void* arg);
 
@@ -112,6 +112,8 @@ class PikaClientConn : public net::RedisConn {
 
   std::atomic<int> resp_num;
   std::vector<std::shared_ptr<std::string>> resp_array;
+  // Large bulk strings of each reply, sent ahead of the matching resp_array entry
+  std::vector<std::vector<std::string>> resp_chunks;
 
   std::shared_ptr<TimeStat> time_stat_;
  private:
@@ -121,19 +123,25 @@ class PikaClientConn : public net::RedisConn {
   bool is_pubsub_ = false;
   std::queue<std::shared_ptr<Cmd>> txn_cmd_que_;
   std::bitset<16> txn_state_;
+  // Pipelined writes waiting to be executed together, with their index in resp_array
+  std::vector<std::pair<std::shared_ptr<Cmd>, size_t>> write_batch_;
   std::unordered_set<std::string> watched_db_keys_;
   std::mutex txn_state_mu_;
 
   bool authenticated_ = false;
   std::shared_ptr<User> user_;
 
-  std::shared_ptr<Cmd> DoCmd(const PikaCmdArgsType& argv, const std::string& opt,
-                             const std::shared_ptr<std::string>& resp_ptr);
+  // With batch_write a batchable command is queued to write_batch_ instead of executed
+  std::shared_ptr<Cmd> DoCmd(PikaCmdArgsType&& args, const std::string& opt,
+                             const std::shared_ptr<std::string>& resp_ptr, bool batch_write);
+  void FinishCmd(const std::shared_ptr<Cmd>& c_ptr);
+  void ExecWriteBatch();
 
   void ProcessSlowlog(const PikaCmdArgsType& argv, uint64_t do_duration);
   void ProcessMonitor(const PikaCmdArgsType& argv);
 
-  void ExecRedisCmd(const PikaCmdArgsType& argv, std::shared_ptr<std::string>& resp_ptr);
+  void ExecRedisCmd(PikaCmdArgsType&& argv, size_t resp_index, bool batch_write);
+  void TakeCmdResp(const std::shared_ptr<Cmd>& cmd_ptr, size_t resp_index);
   void TryWriteResp();
 };
 
@@ -11,18 +11,27 @@
 #include <memory>
 #include "net/include/bg_thread.h"
 #include "net/include/thread_pool.h"
+#include "net/include/work_stealing_pool.h"
 
 class PikaClientProcessor {
  public:
-  PikaClientProcessor(size_t worker_num, size_t max_queue_size, const std::string& name_prefix = "CliProcessor");
+  PikaClientProcessor(size_t worker_num, size_t max_queue_size, bool work_stealing = false,
+                      const std::string& name_prefix = "CliProcessor");
   ~PikaClientProcessor();
   int Start();
   void Stop();
-  void SchedulePool(net::TaskFunc func, void* arg);
+  // affinity picks the home worker of the task, only used by the work-stealing pool
+  void SchedulePool(net::TaskFunc func, void* arg, uint64_t affinity = net::WorkStealingPool::kNoAffinity);
   size_t ThreadPoolCurQueueSize();
   size_t ThreadPoolMaxQueueSize();
+  // Deepest queue of a single worker
+  size_t ThreadPoolMaxWorkerQueueSize();
+  uint64_t ThreadPoolStealCount();
+  bool IsWorkStealing() { return ws_pool_ != nullptr; }
 
  private:
+  // Exactly one of them is created
   std::unique_ptr<net::ThreadPool> pool_;
+  std::unique_ptr<net::WorkStealingPool> ws_pool_;
 };
 #endif  // PIKA_CLIENT_PROCESSOR_H_
@@ -336,20 +336,25 @@ class CmdRes {
 
   CmdRes() = default;
 
-  bool none() const { return ret_ == kNone && message_.empty(); }
+  // Bulk strings at least this large are kept as their own reply chunk
+  // instead of being copied into message_
+  static constexpr size_t kMinChunkSize = 16 * 1024;
+
+  bool none() const { return ret_ == kNone && message_.empty() && chunks_.empty(); }
   bool ok() const { return ret_ == kOk || ret_ == kNone; }
   CmdRet ret() const { return ret_; }
   void clear() {
     message_.clear();
+    chunks_.clear();
     ret_ = kNone;
   }
   bool CacheMiss() const { return ret_ == kCacheMiss; }
-  std::string raw_message() const { return message_; }
+  std::string raw_message() const { return JoinChunks(); }
   std::string message() const {
     std::string result;
     switch (ret_) {
       case kNone:
-        return message_;
+        return JoinChunks();
       case kOk:
         return "+OK\r\n";
       case kPong:
@@ -447,6 +452,17 @@ class CmdRes {
     AppendStringLenUint64(value.size());
     AppendContent(value);
   }
+  void AppendString(std::string&& value) {
+    if (value.size() < kMinChunkSize) {
+      AppendString(static_cast<const std::string&>(value));
+      return;
+    }
+    AppendStringLenUint64(value.size());
+    chunks_.push_back(std::move(message_));
+    chunks_.push_back(std::move(value));
+    message_.clear();
+    message_.append(kNewLine);
+  }
   void AppendStringRaw(const std::string& value) { message_.append(value); }
 
   void AppendStringVector(const std::vector<std::string>& strArray) {
@@ -463,12 +479,46 @@ class CmdRes {
   void SetRes(CmdRet _ret, const std::string& content = "") {
     ret_ = _ret;
     if (!content.empty()) {
+      chunks_.clear();
       message_ = content;
     }
   }
 
+  // Moves the reply out as a list of buffers, large bulk strings are handed
+  // over as they are so the connection can send them with writev
+  std::vector<std::string> TakeChunks() {
+    std::vector<std::string> chunks;
+    if (ret_ != kNone) {
+      chunks.push_back(message());
+    } else {
+      chunks.swap(chunks_);
+      chunks.push_back(std::move(message_));
+    }
+    clear();
+    return chunks;
+  }
+
  private:
+  std::string JoinChunks() const {
+    if (chunks_.empty()) {
+      return message_;
+    }
+    size_t size = message_.size();
+    for (const auto& chunk : chunks_) {
+      size += chunk.size();
+    }
+    std::string result;
+    result.reserve(size);
+    for (const auto& chunk : chunks_) {
+      result.append(chunk);
+    }
+    result.append(message_);
+    return result;
+  }
+
   std::string message_;
+  // Reply data written before message_, see AppendString(std::string&&)
+  std::vector<std::string> chunks_;
   CmdRet ret_ = kNone;
 };
 
@@ -528,10 +578,23 @@ class Cmd : public std::enable_shared_from_this<Cmd> {
   // used for execute multikey command into different slots
   virtual void Split(const HintKeys& hint_keys) = 0;
   virtual void Merge() = 0;
+  // A run of pipelined commands of the same kind that all return true here
+  // may be executed together by ExecuteBatch, DoBatch applies the writes of
+  // all of them with a single storage write
+  virtual bool CanBatch() const { return false; }
+  virtual void DoBatch(const std::vector<std::shared_ptr<Cmd>>& cmds) {}
+  static void ExecuteBatch(const std::vector<std::shared_ptr<Cmd>>& cmds);
 
   int8_t SubCmdIndex(const std::string& cmdName);  // if the command no subCommand，return -1；
 
   void Initial(const PikaCmdArgsType& argv, const std::string& db_name);
+  void Initial(PikaCmdArgsType&& argv, const std::string& db_name);
+  // Instances of a command returning true are kept in a per thread pool by
+  // PikaCmdTableManager and reused instead of cloned, its Clear must reset
+  // everything a previous request left behind
+  virtual bool IsPooled() const { return false; }
+  // Drops the state of the last request before the instance is pooled
+  void ResetState();
   uint32_t flag() const;
   bool hasFlag(uint32_t flag) const;
   bool is_read() const;
@@ -579,6 +642,7 @@ class Cmd : public std::enable_shared_from_this<Cmd> {
   void ProcessCommand(const HintKeys& hint_key = HintKeys());
   void InternalProcessCommand(const HintKeys& hint_key);
   void DoCommand(const HintKeys& hint_key);
+  static void DoBinlogBatch(const std::vector<std::shared_ptr<Cmd>>& cmds);
   void LogCommand() const;
 
   std::string name_;
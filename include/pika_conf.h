@@ -23,6 +23,12 @@
 
 #define kBinlogReadWinDefaultSize 9000
 #define kBinlogReadWinMaxSize 90000
+#define kBinlogGroupCommitDefaultBatch 64
+#define kBinlogGroupCommitMaxBatch 4096
+#define kBinlogGroupCommitMaxDelayUs 10000
+#define kBinlogTailCacheDefaultSize (32 << 20)
+#define kReplBatchDefaultMaxBytes (1 << 20)
+#define kReplBatchMaxDelayUs 100000
 const uint32_t configRunIDSize = 40;
 const uint32_t configReplicationIDSize = 50;
 
@@ -57,6 +63,18 @@ class PikaConf : public pstd::BaseConf {
     std::shared_lock l(rwlock_);
     return thread_pool_size_;
   }
+  bool work_stealing_pool() {
+    std::shared_lock l(rwlock_);
+    return work_stealing_pool_;
+  }
+  bool io_uring() {
+    std::shared_lock l(rwlock_);
+    return io_uring_;
+  }
+  bool reuse_port() {
+    std::shared_lock l(rwlock_);
+    return reuse_port_;
+  }
   int slow_cmd_thread_pool_size() {
     std::shared_lock l(rwlock_);
     return slow_cmd_thread_pool_size_;
@@ -190,6 +208,10 @@ class PikaConf : public pstd::BaseConf {
     std::shared_lock l(rwlock_);
     return slotmigrate_;
   }
+  bool slot_key_prefix() {
+    std::shared_lock l(rwlock_);
+    return slot_key_prefix_;
+  }
   bool slow_cmd_pool() {
     std::shared_lock l(rwlock_);
     return slow_cmd_pool_;
@@ -259,6 +281,10 @@ class PikaConf : public pstd::BaseConf {
     std::shared_lock l(rwlock_);
     return compression_;
   }
+  std::string repl_compression() {
+    std::shared_lock l(rwlock_);
+    return repl_compression_;
+  }
   int target_file_size_base() {
     std::shared_lock l(rwlock_);
     return target_file_size_base_;
@@ -281,6 +307,14 @@ class PikaConf : public pstd::BaseConf {
     std::shared_lock l(rwlock_);
     return small_compaction_duration_threshold_;
   }
+  int zset_rank_index_threshold() {
+    std::shared_lock l(rwlock_);
+    return zset_rank_index_threshold_;
+  }
+  int reap_expired_keys_per_sec() {
+    std::shared_lock l(rwlock_);
+    return reap_expired_keys_per_sec_;
+  }
   int max_background_flushes() {
     std::shared_lock l(rwlock_);
     return max_background_flushes_;
@@ -366,6 +400,7 @@ class PikaConf : public pstd::BaseConf {
     return root_connection_num_;
   }
   bool slowlog_write_errorlog() { return slowlog_write_errorlog_.load(); }
+  bool pipeline_write_batch() { return pipeline_write_batch_.load(); }
   int slowlog_slower_than() { return slowlog_log_slower_than_.load(); }
   int slowlog_max_len() {
     std::shared_lock l(rwlock_);
@@ -377,6 +412,11 @@ class PikaConf : public pstd::BaseConf {
   }
   int cache_mode() { return cache_mode_; }
   int sync_window_size() { return sync_window_size_.load(); }
+  int binlog_group_commit_max_batch() { return binlog_group_commit_max_batch_.load(); }
+  int64_t binlog_group_commit_max_delay_us() { return binlog_group_commit_max_delay_us_.load(); }
+  int64_t binlog_tail_cache_size() { return binlog_tail_cache_size_.load(); }
+  int64_t repl_batch_max_bytes() { return repl_batch_max_bytes_.load(); }
+  int64_t repl_batch_max_delay_us() { return repl_batch_max_delay_us_.load(); }
   int max_conn_rbuf_size() { return max_conn_rbuf_size_.load(); }
   int consensus_level() { return consensus_level_.load(); }
   int replication_num() { return replication_num_.load(); }
@@ -416,6 +456,7 @@ class PikaConf : public pstd::BaseConf {
   void SetCacheMaxmemoryPolicy(const int value) { cache_maxmemory_policy_ = value; }
   void SetCacheMaxmemorySamples(const int value) { cache_maxmemory_samples_ = value; }
   void SetCacheLFUDecayTime(const int value) { cache_lfu_decay_time_ = value; }
+  void SetCacheAdmission(const bool value) { cache_admission_ = value; }
   void UnsetCacheDisableFlag() { tmp_cache_disable_flag_ = false; }
   bool enable_blob_files() { return enable_blob_files_; }
   int64_t min_blob_size() { return min_blob_size_; }
@@ -436,6 +477,7 @@ class PikaConf : public pstd::BaseConf {
     std::shared_lock l(rwlock_);
     return max_rsync_parallel_num_;
   }
+  int max_rsync_window_size() { return max_rsync_window_size_.load(std::memory_order_relaxed); }
   int64_t rsync_timeout_ms() {
       return rsync_timeout_ms_.load(std::memory_order::memory_order_relaxed);
   }
@@ -552,6 +594,16 @@ class PikaConf : public pstd::BaseConf {
     TryPushDiffCommands("small-compaction-duration-threshold", std::to_string(value));
     small_compaction_duration_threshold_ = value;
   }
+  void SetZSetRankIndexThreshold(const int value) {
+    std::lock_guard l(rwlock_);
+    TryPushDiffCommands("zset-rank-index-threshold", std::to_string(value));
+    zset_rank_index_threshold_ = value;
+  }
+  void SetReapExpiredKeysPerSec(const int value) {
+    std::lock_guard l(rwlock_);
+    TryPushDiffCommands("reap-expired-keys-per-sec", std::to_string(value));
+    reap_expired_keys_per_sec_ = value;
+  }
   void SetMaxClientResponseSize(const int value) {
     std::lock_guard l(rwlock_);
     TryPushDiffCommands("max-client-response-size", std::to_string(value));
@@ -647,6 +699,11 @@ class PikaConf : public pstd::BaseConf {
     TryPushDiffCommands("slowlog-write-errorlog", value ? "yes" : "no");
     slowlog_write_errorlog_.store(value);
   }
+  void SetPipelineWriteBatch(const bool value) {
+    std::lock_guard l(rwlock_);
+    TryPushDiffCommands("pipeline-write-batch", value ? "yes" : "no");
+    pipeline_write_batch_.store(value);
+  }
   void SetSlowlogSlowerThan(const int value) {
     std::lock_guard l(rwlock_);
     TryPushDiffCommands("slowlog-log-slower-than", std::to_string(value));
@@ -701,6 +758,31 @@ class PikaConf : public pstd::BaseConf {
     TryPushDiffCommands("sync-window-size", std::to_string(value));
     sync_window_size_.store(value);
   }
+  void SetBinlogGroupCommitMaxBatch(const int& value) {
+    TryPushDiffCommands("binlog-group-commit-max-batch", std::to_string(value));
+    binlog_group_commit_max_batch_.store(value);
+  }
+  void SetBinlogGroupCommitMaxDelayUs(const int64_t& value) {
+    TryPushDiffCommands("binlog-group-commit-max-delay-us", std::to_string(value));
+    binlog_group_commit_max_delay_us_.store(value);
+  }
+  void SetBinlogTailCacheSize(const int64_t& value) {
+    TryPushDiffCommands("binlog-tail-cache-size", std::to_string(value));
+    binlog_tail_cache_size_.store(value);
+  }
+  void SetReplCompression(const std::string& value) {
+    std::lock_guard l(rwlock_);
+    TryPushDiffCommands("repl-compression", value);
+    repl_compression_ = value;
+  }
+  void SetReplBatchMaxBytes(const int64_t& value) {
+    TryPushDiffCommands("repl-batch-max-bytes", std::to_string(value));
+    repl_batch_max_bytes_.store(value);
+  }
+  void SetReplBatchMaxDelayUs(const int64_t& value) {
+    TryPushDiffCommands("repl-batch-max-delay-us", std::to_string(value));
+    repl_batch_max_delay_us_.store(value);
+  }
   void SetMaxConnRbufSize(const int& value) {
     TryPushDiffCommands("max-conn-rbuf-size", std::to_string(value));
     max_conn_rbuf_size_.store(value);
@@ -798,6 +880,12 @@ class PikaConf : public pstd::BaseConf {
     max_rsync_parallel_num_ = value;
   }
 
+  void SetMaxRsyncWindowSize(const int value) {
+    std::lock_guard l(rwlock_);
+    TryPushDiffCommands("max-rsync-window-size", std::to_string(value));
+    max_rsync_window_size_.store(value);
+  }
+
   void SetRsyncTimeoutMs(int64_t value){
     std::lock_guard l(rwlock_);
     TryPushDiffCommands("rsync-timeout-ms", std::to_string(value));
@@ -848,6 +936,7 @@ class PikaConf : public pstd::BaseConf {
   int cache_maxmemory_policy() { return cache_maxmemory_policy_; }
   int cache_maxmemory_samples() { return cache_maxmemory_samples_; }
   int cache_lfu_decay_time() { return cache_lfu_decay_time_; }
+  bool cache_admission() { return cache_admission_; }
   int Load();
   int ConfigRewrite();
   int ConfigRewriteReplicationID();
@@ -858,6 +947,9 @@ class PikaConf : public pstd::BaseConf {
   int slave_priority_ = 0;
   int thread_num_ = 0;
   int thread_pool_size_ = 0;
+  bool work_stealing_pool_ = false;
+  bool io_uring_ = false;
+  bool reuse_port_ = false;
   int slow_cmd_thread_pool_size_ = 0;
   int admin_thread_pool_size_ = 0;
   std::unordered_set<std::string> slow_cmd_set_;
@@ -917,8 +1009,10 @@ class PikaConf : public pstd::BaseConf {
   int maxclients_ = 0;
   int root_connection_num_ = 0;
   std::atomic<bool> slowlog_write_errorlog_;
+  std::atomic<bool> pipeline_write_batch_ = false;
   std::atomic<int> slowlog_log_slower_than_;
   std::atomic<bool> slotmigrate_;
+  bool slot_key_prefix_ = false;
   std::atomic<int> binlog_writer_num_;
   int slowlog_max_len_ = 0;
   int expire_logs_days_ = 0;
@@ -929,6 +1023,8 @@ class PikaConf : public pstd::BaseConf {
   int max_cache_statistic_keys_ = 0;
   int small_compaction_threshold_ = 0;
   int small_compaction_duration_threshold_ = 0;
+  int zset_rank_index_threshold_ = 0;
+  int reap_expired_keys_per_sec_ = 1000;
   int max_background_flushes_ = -1;
   int max_background_compactions_ = -1;
   int max_background_jobs_ = 0;
@@ -953,6 +1049,12 @@ class PikaConf : public pstd::BaseConf {
   bool rate_limiter_auto_tuned_ = true;
 
   std::atomic<int> sync_window_size_;
+  std::atomic<int> binlog_group_commit_max_batch_ = kBinlogGroupCommitDefaultBatch;
+  std::atomic<int64_t> binlog_group_commit_max_delay_us_ = 0;
+  std::atomic<int64_t> binlog_tail_cache_size_ = kBinlogTailCacheDefaultSize;
+  std::string repl_compression_ = "none";
+  std::atomic<int64_t> repl_batch_max_bytes_ = kReplBatchDefaultMaxBytes;
+  std::atomic<int64_t> repl_batch_max_delay_us_ = 0;
   std::atomic<int> max_conn_rbuf_size_;
   std::atomic<int> consensus_level_;
   std::atomic<int> replication_num_;
@@ -996,6 +1098,7 @@ class PikaConf : public pstd::BaseConf {
   std::atomic_int cache_maxmemory_policy_ = 1;
   std::atomic_int cache_maxmemory_samples_ = 5;
   std::atomic_int cache_lfu_decay_time_ = 1;
+  std::atomic_bool cache_admission_ = true;
 
   // rocksdb blob
   bool enable_blob_files_ = false;
@@ -1013,6 +1116,7 @@ class PikaConf : public pstd::BaseConf {
   // Rsync Rate limiting configuration
   int throttle_bytes_per_second_ = 200 << 20; // 200MB/s
   int max_rsync_parallel_num_ = kMaxRsyncParallelNum;
+  std::atomic_int max_rsync_window_size_ = kDefaultRsyncWindowSize;
   std::atomic_int64_t rsync_timeout_ms_ = 1000;
 };
 
@@ -10,7 +10,7 @@
 
 #include "storage/storage.h"
 #include "include/pika_command.h"
-#include "lock_mgr.h"
+#include "pstd/include/record_lock_mgr.h"
 #include "pika_cache.h"
 #include "pika_define.h"
 #include "storage/backupable.h"
@@ -61,6 +61,12 @@ struct DisplayCacheInfo {
   uint64_t last_time_us = 0;
   uint64_t last_load_keys_num = 0;
   uint32_t waitting_load_keys_num = 0;
+  uint64_t coalesced_misses = 0;
+  uint64_t admission_rejects = 0;
+  uint64_t loads = 0;
+  uint64_t load_us = 0;
+  std::vector<CacheKeyStat> hot_keys;
+  std::vector<CacheShardInfo> shards;
   DisplayCacheInfo& operator=(const DisplayCacheInfo &obj) {
     status = obj.status;
     cache_num = obj.cache_num;
@@ -76,6 +82,12 @@ struct DisplayCacheInfo {
     last_time_us = obj.last_time_us;
     last_load_keys_num = obj.last_load_keys_num;
     waitting_load_keys_num = obj.waitting_load_keys_num;
+    coalesced_misses = obj.coalesced_misses;
+    admission_rejects = obj.admission_rejects;
+    loads = obj.loads;
+    load_us = obj.load_us;
+    hot_keys = obj.hot_keys;
+    shards = obj.shards;
     return *this;
   }
 };
@@ -128,7 +140,7 @@ class DB : public std::enable_shared_from_this<DB>, public pstd::noncopyable {
 
   void SetCompactRangeOptions(const bool is_canceled);
 
-  std::shared_ptr<pstd::lock::LockMgr> LockMgr();
+  std::shared_ptr<pstd::lock::RecordLockMgr> LockMgr();
   /*
    * Cache used
    */
@@ -161,7 +173,7 @@ class DB : public std::enable_shared_from_this<DB>, public pstd::noncopyable {
   std::atomic<bool> binlog_io_error_;
   std::shared_mutex dbs_rw_;
   // class may be shared, using shared_ptr would be a better choice
-  std::shared_ptr<pstd::lock::LockMgr> lock_mgr_;
+  std::shared_ptr<pstd::lock::RecordLockMgr> lock_mgr_;
   std::shared_ptr<storage::Storage> storage_;
   std::shared_ptr<PikaCache> cache_;
   /*
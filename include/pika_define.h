@@ -43,6 +43,9 @@ const std::string kDefaultRsyncAuth = "default";
 
 /* Rsync */
 const int kMaxRsyncParallelNum = 4;
+// Upper bound of the chunk requests a rsync worker keeps in flight for one file
+const int kMaxRsyncWindowSize = 16;
+const int kDefaultRsyncWindowSize = 4;
 constexpr int kMaxRsyncInitReTryTimes = 64;
 
 struct DBStruct {
@@ -275,6 +278,8 @@ struct WriteTask {
   struct RmNode rm_node_;
   struct BinlogChip binlog_chip_;
   LogOffset prev_offset_;
+  // When it was put into the write queue
+  uint64_t enqueue_us_ = 0;
   WriteTask(const RmNode& rm_node, const BinlogChip& binlog_chip, const LogOffset& prev_offset)
       : rm_node_(rm_node), binlog_chip_(binlog_chip), prev_offset_(prev_offset) {}
 };
@@ -374,6 +379,8 @@ const uint32_t kDBSyncMaxGap = 50;
 const std::string kDBSyncModule = "document";
 
 const std::string kBgsaveInfoFile = "info";
+// Size and checksum of the SST files of a dump, see rsync_sst_identity.h
+const std::string kBgsaveSstMetaFile = "sst_meta";
 
 /*
  * cache status
@@ -408,5 +415,27 @@ enum CacheBgTask {
 const int64_t CACHE_LOAD_QUEUE_MAX_SIZE = 2048;
 const int64_t CACHE_VALUE_ITEM_MAX_SIZE = 2048;
 const int64_t CACHE_LOAD_NUM_ONE_TIME = 256;
+// Each cache shard runs its active expire cycle this often, as redis does with hz 10
+const int64_t CACHE_EXPIRE_CYCLE_INTERVAL_MS = 100;
+
+/*
+ * cache statistics, pika_db.h and pika_cache.h include each other through
+ * the command headers, so they live here
+ */
+// Reads of a hot key, estimated by a space-saving top list
+struct CacheKeyStat {
+  std::string key;
+  uint64_t reads = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t loads = 0;
+  uint64_t load_us = 0;
+};
+
+struct CacheShardInfo {
+  uint64_t keys_num = 0;
+  uint64_t async_load_keys_num = 0;
+  uint32_t waitting_load_keys_num = 0;
+};
 
 #endif
@@ -14,6 +14,8 @@ inline const std::string STATS_METRIC_NET_INPUT = "stats_metric_net_input";
 inline const std::string STATS_METRIC_NET_OUTPUT = "stats_metric_net_output";
 inline const std::string STATS_METRIC_NET_INPUT_REPLICATION = "stats_metric_net_input_replication";
 inline const std::string STATS_METRIC_NET_OUTPUT_REPLICATION = "stats_metric_net_output_replication";
+/* Followed by the index of the worker thread */
+inline const std::string STATS_METRIC_WORKER_ACCEPTS = "stats_metric_worker_accepts_";
 
 /* The following two are used to track instantaneous metrics, like
 * number of operations per second, network traffic. */
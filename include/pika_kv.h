@@ -29,7 +29,11 @@ class SetCmd : public Cmd {
   void DoThroughDB() override;
   void Split(const HintKeys& hint_keys) override{};
   void Merge() override{};
+  // Only a plain SET key value, the same as one entry of MSET
+  bool CanBatch() const override { return condition_ == kNONE; }
+  void DoBatch(const std::vector<std::shared_ptr<Cmd>>& cmds) override;
   Cmd* Clone() override { return new SetCmd(*this); }
+  bool IsPooled() const override { return true; }
 
  private:
   std::string key_;
@@ -41,8 +45,14 @@ class SetCmd : public Cmd {
   SetCmd::SetCondition condition_{kNONE};
   void DoInitial() override;
   void Clear() override {
+    key_.clear();
+    // A pooled instance should not hold on to a large value
+    value_.clear();
+    value_.shrink_to_fit();
+    target_.clear();
     sec_ = 0;
     success_ = 0;
+    has_ttl_ = false;
     condition_ = kNONE;
   }
   std::string ToRedisProtocol() override;
@@ -65,12 +75,19 @@ class GetCmd : public Cmd {
   void Split(const HintKeys& hint_keys) override{};
   void Merge() override{};
   Cmd* Clone() override { return new GetCmd(*this); }
+  bool IsPooled() const override { return true; }
 
  private:
   std::string key_;
   std::string value_;
   int64_t sec_ = 0;
   void DoInitial() override;
+  void Clear() override {
+    key_.clear();
+    value_.clear();
+    value_.shrink_to_fit();
+    sec_ = 0;
+  }
   rocksdb::Status s_;
 };
 
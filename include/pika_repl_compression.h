@@ -0,0 +1,40 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef PIKA_REPL_COMPRESSION_H_
+#define PIKA_REPL_COMPRESSION_H_
+
+#include <string>
+
+#include "pika_inner_message.pb.h"
+
+// Frames smaller than this are sent as they are, compressing them saves too little
+#define kReplCompressMinBytes 512
+
+/*
+ * Codecs for the BinlogSync frames sent from a master to its slaves. A slave
+ * lists the codecs it supports in its MetaSync request and the master picks
+ * the one of repl-compression if the slave supports it.
+ */
+const char* ReplCompressionName(InnerMessage::CompressionType type);
+// Returns false if name is not none, lz4 or zstd
+bool ReplCompressionFromName(const std::string& name, InnerMessage::CompressionType* type);
+
+bool ReplCompress(InnerMessage::CompressionType type, const std::string& raw, std::string* compressed);
+// raw_size is the size of the frame before it was compressed
+bool ReplDecompress(InnerMessage::CompressionType type, const std::string& compressed, size_t raw_size,
+                    std::string* raw);
+
+/*
+ * Serializes into wire an InnerResponse holding the serialized BinlogSync
+ * frame compressed with type. Returns false if compressing the frame does
+ * not pay off, it is then sent as it is.
+ */
+bool ReplCompressFrame(InnerMessage::CompressionType type, const std::string& frame, std::string* wire);
+// Parses the frame held by response, rejects frames larger than max_raw_size once decompressed
+bool ReplDecompressFrame(const InnerMessage::InnerResponse& response, size_t max_raw_size,
+                         InnerMessage::InnerResponse* frame);
+
+#endif  // PIKA_REPL_COMPRESSION_H_
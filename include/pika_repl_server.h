@@ -33,6 +33,8 @@ class PikaReplServer {
 
   pstd::Status SendSlaveBinlogChips(const std::string& ip, int port, const std::vector<WriteTask>& tasks);
   pstd::Status Write(const std::string& ip, int port, const std::string& msg);
+  // Writes a serialized BinlogSync frame, compressed if the slave agreed to it
+  pstd::Status WriteBinlogFrame(const std::string& ip, int port, const std::string& frame);
 
   void BuildBinlogOffset(const LogOffset& offset, InnerMessage::BinlogOffset* boffset);
   void BuildBinlogSyncResp(const std::vector<WriteTask>& tasks, InnerMessage::InnerResponse* resp);
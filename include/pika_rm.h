@@ -6,6 +6,7 @@
 #ifndef PIKA_RM_H_
 #define PIKA_RM_H_
 
+#include <atomic>
 #include <memory>
 #include <queue>
 #include <shared_mutex>
@@ -25,6 +26,8 @@
 
 #define kBinlogSendPacketNum 40
 #define kBinlogSendBatchNum 100
+// Frames to a slave using compression are bounded by repl-batch-max-bytes instead
+#define kBinlogSendCompressedBatchNum 10000
 
 // unit seconds
 #define kSendKeepAliveTimeout (2 * 1000000)
@@ -69,6 +72,7 @@ class SyncMasterDB : public SyncDB {
   // consensus use
   pstd::Status ConsensusUpdateSlave(const std::string& ip, int port, const LogOffset& start, const LogOffset& end);
   pstd::Status ConsensusProposeLog(const std::shared_ptr<Cmd>& cmd_ptr);
+  pstd::Status ConsensusProposeLogs(const std::vector<std::shared_ptr<Cmd>>& cmds);
   pstd::Status ConsensusProcessLeaderLog(const std::shared_ptr<Cmd>& cmd_ptr, const BinlogItem& attribute);
   LogOffset ConsensusCommittedIndex();
   LogOffset ConsensusLastIndex();
@@ -85,6 +89,9 @@ class SyncMasterDB : public SyncDB {
  private:
   // invoker need to hold slave_mu_
   pstd::Status ReadBinlogFileToWq(const std::shared_ptr<SlaveNode>& slave_ptr);
+  // Sends the records following sent_offset from the binlog tail cache,
+  // returns false if the cache does not hold them
+  bool ReadBinlogTailToWq(const std::shared_ptr<SlaveNode>& slave_ptr, int cnt, std::vector<WriteTask>* tasks);
 
   std::shared_ptr<SlaveNode> GetSlaveNode(const std::string& ip, int port);
   std::unordered_map<std::string, std::shared_ptr<SlaveNode>> GetAllSlaveNodes();
@@ -117,6 +124,7 @@ class SyncSlaveDB : public SyncDB {
   void StopRsync();
   pstd::Status ActivateRsync();
   bool IsRsyncRunning() { return rsync_cli_->IsRunning(); }
+  rsync::RsyncClient::Stats RsyncStats() { return rsync_cli_->GetStats(); }
 
  private:
   std::unique_ptr<rsync::RsyncClient> rsync_cli_;
@@ -176,6 +184,21 @@ class PikaReplicaManager {
   void DropItemInOneWriteQueue(const std::string& ip, int port, const std::string& db_name);
   void DropItemInWriteQueue(const std::string& ip, int port);
   int ConsumeWriteQueue();
+  // Microseconds until a write queue held back to fill up its frame is due, 0 if none is held
+  uint64_t WriteQueueDueUs() { return write_queue_due_us_.load(std::memory_order_relaxed); }
+
+  // BinlogSync frames sent to a slave, keyed by "ip:port"
+  struct SlaveFrameStats {
+    InnerMessage::CompressionType compression = InnerMessage::kNoCompression;
+    uint64_t frames = 0;
+    uint64_t raw_bytes = 0;
+    uint64_t wire_bytes = 0;
+  };
+  void SetSlaveCompression(const std::string& ip_port, InnerMessage::CompressionType compression);
+  InnerMessage::CompressionType SlaveCompression(const std::string& ip_port);
+  void AddSlaveFrame(const std::string& ip_port, uint64_t raw_bytes, uint64_t wire_bytes);
+  SlaveFrameStats GetSlaveFrameStats(const std::string& ip_port);
+  void RemoveSlaveFrames(const std::string& ip_port);
 
   // Schedule Task
   void ScheduleReplServerBGTask(net::TaskFunc func, void* arg);
@@ -214,8 +237,16 @@ class PikaReplicaManager {
 
   pstd::Mutex write_queue_mu_;
 
+  struct WriteQueue {
+    std::queue<WriteTask> tasks;
+    size_t bytes = 0;
+  };
   // every host owns a queue, the key is "ip + port"
-  std::unordered_map<std::string, std::unordered_map<std::string, std::queue<WriteTask>>> write_queues_;
+  std::unordered_map<std::string, std::unordered_map<std::string, WriteQueue>> write_queues_;
+  std::atomic<uint64_t> write_queue_due_us_ = 0;
+
+  pstd::Mutex slave_frames_mu_;
+  std::unordered_map<std::string, SlaveFrameStats> slave_frames_;
   std::unique_ptr<PikaReplClient> pika_repl_client_;
   std::unique_ptr<PikaReplServer> pika_repl_server_;
 };
@@ -138,6 +138,7 @@ class PikaServer : public pstd::noncopyable {
   void DBSetMaxCacheStatisticKeys(uint32_t max_cache_statistic_keys);
   void DBSetSmallCompactionThreshold(uint32_t small_compaction_threshold);
   void DBSetSmallCompactionDurationThreshold(uint32_t small_compaction_duration_threshold);
+  void DBSetZSetRankIndexThreshold(uint32_t zset_rank_index_threshold);
   bool GetDBBinlogOffset(const std::string& db_name, BinlogOffset* boffset);
   pstd::Status DoSameThingEveryDB(const TaskType& type);
 
@@ -180,11 +181,16 @@ class PikaServer : public pstd::noncopyable {
   /*
    * PikaClientProcessor Process Task
    */
-  void ScheduleClientPool(net::TaskFunc func, void* arg, bool is_slow_cmd, bool is_admin_cmd);
+  // affinity keeps the tasks of a connection on one worker of the work-stealing pool
+  void ScheduleClientPool(net::TaskFunc func, void* arg, bool is_slow_cmd, bool is_admin_cmd,
+                          uint64_t affinity = net::WorkStealingPool::kNoAffinity);
 
   // for info debug
   size_t ClientProcessorThreadPoolCurQueueSize();
   size_t ClientProcessorThreadPoolMaxQueueSize();
+  size_t ClientProcessorThreadPoolMaxWorkerQueueSize();
+  uint64_t ClientProcessorThreadPoolStealCount();
+  bool ClientProcessorWorkStealing();
   size_t SlowCmdThreadPoolCurQueueSize();
   size_t SlowCmdThreadPoolMaxQueueSize();
 
@@ -249,9 +255,14 @@ class PikaServer : public pstd::noncopyable {
   uint64_t accumulative_connections();
   void ResetStat();
   void incr_accumulative_connections();
+  uint64_t pipeline_write_batches();
+  uint64_t pipeline_write_batched_cmds();
+  void incr_pipeline_write_batches(uint64_t cmds);
   void ResetLastSecQuerynum();
-  void UpdateQueryNumAndExecCountDB(const std::string& db_name, const std::string& command, bool is_write);
+  void UpdateQueryNumAndExecCountDB(const std::string& db_name, uint32_t cmd_id, bool is_write);
+  void UpdateCmdTimeStat(uint32_t cmd_id, uint64_t queue_time, uint64_t process_time, uint64_t total_time);
   std::unordered_map<std::string, uint64_t> ServerExecCountDB();
+  std::map<std::string, CommandStatistics> ServerCmdStats(bool with_latency);
   std::unordered_map<std::string, QpsStatistic> ServerAllDBStat();
 
   /*
@@ -275,6 +286,9 @@ class PikaServer : public pstd::noncopyable {
   float InstantaneousOutputKbps();
   float InstantaneousInputReplKbps();
   float InstantaneousOutputReplKbps();
+  // Connections taken in by each client worker thread, in total and per second
+  std::vector<uint64_t> WorkerAcceptedConns();
+  std::vector<uint64_t> InstantaneousWorkerAccepts();
 
   /*
    * Slave to Master communication used
@@ -483,7 +497,6 @@ class PikaServer : public pstd::noncopyable {
   void UpdateCacheInfo(void);
   void ResetDisplayCacheInfo(int status, std::shared_ptr<DB> db);
   void CacheConfigInit(cache::CacheConfig &cache_cfg);
-  void ProcessCronTask();
   double HitRatio();
 
   /*
@@ -497,15 +510,21 @@ class PikaServer : public pstd::noncopyable {
   int64_t GetLastSave() const {return lastsave_;}
   void UpdateLastSave(int64_t lastsave) {lastsave_ = lastsave;}
   void InitStatistic(CmdTable *inited_cmd_table) {
-    // we insert all cmd name to statistic_.server_stat.exec_count_db,
-    // then when we can call PikaServer::UpdateQueryNumAndExecCountDB(const std::string&, const std::string&, bool) in parallel without lock
-    // although exec_count_db(unordered_map) is not thread-safe, but we won't trigger any insert or erase operation toward exec_count_db(unordered_map) during the running of pika
-    auto &exec_stat_map = statistic_.server_stat.exec_count_db;
+    // statistic shards are indexed by cmd id and db, so all of them must be known before serving,
+    // then we can call PikaServer::UpdateQueryNumAndExecCountDB in parallel without lock
+    std::vector<std::string> cmd_names;
     for (auto& it : *inited_cmd_table) {
-      std::string cmd_name = it.first; //value copy is needed
-      pstd::StringToUpper(cmd_name); //cmd_name now is all uppercase
-      exec_stat_map.insert(std::make_pair(cmd_name, 0));
+      uint32_t cmd_id = it.second->GetCmdId();
+      if (cmd_names.size() <= cmd_id) {
+        cmd_names.resize(cmd_id + 1);
+      }
+      cmd_names[cmd_id] = it.first;
     }
+    std::vector<std::string> db_names;
+    for (const auto& db_struct : g_pika_conf->db_structs()) {
+      db_names.push_back(db_struct.db_name);
+    }
+    statistic_.Init(cmd_names, db_names);
   }
  private:
   /*
@@ -513,6 +532,7 @@ class PikaServer : public pstd::noncopyable {
    */
   void DoTimingTask();
   void AutoCompactRange();
+  void AutoReapExpiredKeys();
   void AutoPurge();
   void AutoDeleteExpiredDump();
   void AutoUpdateNetworkMetric();
@@ -548,6 +568,11 @@ class PikaServer : public pstd::noncopyable {
    */
   struct timeval last_check_resume_time_;
 
+  /*
+   * ReapExpiredKeys used
+   */
+  uint64_t last_reap_time_;
+
   /*
    * Communicate with the client used
    */
@@ -20,6 +20,14 @@ void RemSlotKey(const std::string& key, const std::shared_ptr<DB>& db);
 int DeleteKey(const std::string& key, const char key_type, const std::shared_ptr<DB>& db);
 void RemSlotKeyByType(const std::string& type, const std::string& key, const std::shared_ptr<DB>& db);
 std::string GetSlotKey(uint32_t slot);
+// The number of keys and the keys of a slot, read from the slot key set, or
+// from the key range of the slot in the slot prefix key layout
+rocksdb::Status GetSlotKeyNum(uint32_t slot, int32_t* len, const std::shared_ptr<DB>& db);
+rocksdb::Status ScanSlotKeys(uint32_t slot, int64_t cursor, const std::string& pattern, int64_t count,
+                             std::vector<std::string>* members, int64_t* next_cursor, const std::shared_ptr<DB>& db);
+// Keys of slot sharing the hash tag crc, only in the slot prefix key layout
+rocksdb::Status GetSlotTagKeys(uint32_t slot, uint32_t crc, std::vector<std::string>* members,
+                               const std::shared_ptr<DB>& db);
 std::string GetSlotsTagKey(uint32_t crc);
 
 class PikaMigrate {
@@ -191,11 +199,13 @@ class SlotsScanCmd : public Cmd {
 
  private:
   std::string key_;
+  int64_t slot_ = 0;
   std::string pattern_ = "*";
   int64_t cursor_ = 0;
   int64_t count_ = 10;
   void DoInitial()  override;
   void Clear() override {
+    slot_ = 0;
     pattern_ = "*";
     count_ = 10;
   }
@@ -7,9 +7,13 @@
 #define PIKA_STATISTIC_H_
 
 #include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <shared_mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 class QpsStatistic {
  public:
@@ -31,23 +35,106 @@ class QpsStatistic {
   std::atomic<uint64_t> last_time_us;
 };
 
+/*
+ * HDR-style log-linear histogram of latencies in microseconds. Every power
+ * of two range is split into kSubBucketNum linear buckets, so the relative
+ * error of a percentile is below 1 / kSubBucketNum.
+ * Add() must only be called by the owner thread, readers may Merge() at any time.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 3;
+  static constexpr int kSubBucketNum = 1 << kSubBucketBits;
+  static constexpr int kMaxValueBits = 40;
+  static constexpr int kBucketNum = (kMaxValueBits - kSubBucketBits + 1) * kSubBucketNum;
+
+  LatencyHistogram();
+  LatencyHistogram(const LatencyHistogram& other);
+  LatencyHistogram& operator=(const LatencyHistogram& other) = delete;
+
+  void Add(uint64_t value);
+  void Merge(const LatencyHistogram& other);
+  uint64_t Count() const;
+  // p is in [0, 100]
+  uint64_t Percentile(double p) const;
+
+ private:
+  static int BucketIndex(uint64_t value);
+  static uint64_t BucketUpperBound(int index);
+
+  std::atomic<uint64_t> buckets_[kBucketNum];
+};
+
+struct CmdLatencyStatistic {
+  LatencyHistogram queue_time;
+  LatencyHistogram process_time;
+  LatencyHistogram total_time;
+};
+
+// Aggregated statistic of one command, used by info commandstats and latencystats
+struct CommandStatistics {
+  uint64_t exec_count = 0;
+  uint64_t cmd_count = 0;
+  uint64_t cmd_time_consuming = 0;
+  // Only merged when asked for, the histograms are large
+  std::unique_ptr<CmdLatencyStatistic> latency;
+};
+
+/*
+ * Counters owned by a single thread. The owner updates them without any
+ * shared write, INFO sums all the shards up when it is called.
+ */
+struct StatisticShard {
+  struct CmdSlot {
+    CmdSlot() = default;
+    ~CmdSlot() { delete latency.load(); }
+    std::atomic<uint64_t> exec_count = 0;
+    std::atomic<uint64_t> cmd_count = 0;
+    std::atomic<uint64_t> cmd_time_consuming = 0;
+    // Allocated by the owner thread when the command is executed the first time
+    std::atomic<CmdLatencyStatistic*> latency = nullptr;
+  };
+  struct DBSlot {
+    std::atomic<uint64_t> querynum = 0;
+    std::atomic<uint64_t> write_querynum = 0;
+  };
+
+  StatisticShard(size_t cmd_num, size_t db_num) : cmd_slots(cmd_num), db_slots(db_num) {}
+
+  std::atomic<uint64_t> querynum = 0;
+  std::vector<CmdSlot> cmd_slots;
+  std::vector<DBSlot> db_slots;
+};
+
 struct ServerStatistic {
   ServerStatistic() = default;
   ~ServerStatistic() = default;
 
   std::atomic<uint64_t> accumulative_connections;
-  std::unordered_map<std::string, std::atomic<uint64_t>> exec_count_db;
+  // pipelined writes executed together, see pipeline-write-batch
+  std::atomic<uint64_t> pipeline_write_batches = 0;
+  std::atomic<uint64_t> pipeline_write_batched_cmds = 0;
   QpsStatistic qps;
 };
 
 struct Statistic {
   Statistic();
 
+  // Must be called before any worker thread updates the statistic
+  void Init(const std::vector<std::string>& cmd_names, const std::vector<std::string>& db_names);
+
   QpsStatistic DBStat(const std::string& db_name);
   std::unordered_map<std::string, QpsStatistic> AllDBStat();
 
-  void UpdateDBQps(const std::string& db_name, const std::string& command, bool is_write);
-  void ResetDBLastSecQuerynum();
+  void UpdateDBQps(const std::string& db_name, uint32_t cmd_id, bool is_write);
+  void UpdateCmdTimeStat(uint32_t cmd_id, uint64_t queue_time, uint64_t process_time, uint64_t total_time);
+  // Sum up the shards and refresh the qps of the server and every single table
+  void ResetLastSecQuerynum();
+  void ResetQueryNum();
+
+  uint64_t QueryNum();
+  std::unordered_map<std::string, uint64_t> ExecCount();
+  std::map<std::string, CommandStatistics> CmdStats(bool with_latency);
 
   // statistic shows accumulated data of all tables
   ServerStatistic server_stat;
@@ -55,6 +142,18 @@ struct Statistic {
   // statistic shows accumulated data of every single table
   std::shared_mutex db_stat_rw;
   std::unordered_map<std::string, QpsStatistic> db_stat;
+
+ private:
+  StatisticShard* LocalShard();
+
+  // Immutable after Init
+  std::vector<std::string> cmd_names_;
+  std::vector<std::string> db_names_;
+  std::unordered_map<std::string, size_t> db_index_;
+
+  std::mutex shards_mu_;
+  std::vector<std::unique_ptr<StatisticShard>> shards_;
+  std::atomic<uint64_t> querynum_base_ = 0;
 };
 
 struct DiskStatistic {
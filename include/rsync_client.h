@@ -10,6 +10,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <list>
+#include <map>
 #include <atomic>
 #include <memory>
 #include <thread>
@@ -26,6 +27,9 @@
 #include "pstd/include/pstd_status.h"
 #include "include/pika_define.h"
 #include "include/rsync_client_thread.h"
+#include "include/rsync_fetcher.h"
+#include "include/rsync_sst_identity.h"
+#include "include/rsync_window.h"
 #include "include/throttle.h"
 #include "rsync_service.pb.h"
 
@@ -33,18 +37,11 @@ extern std::unique_ptr<PikaConf> g_pika_conf;
 
 const std::string kDumpMetaFileName = "DUMP_META_DATA";
 const std::string kUuidPrefix = "snapshot-uuid:";
-const size_t kInvalidOffset = 0xFFFFFFFF;
 
 namespace rsync {
 
-class RsyncWriter;
 class Session;
-class WaitObject;
-class WaitObjectManager;
 
-using pstd::Status;
-
-using ResponseSPtr = std::shared_ptr<RsyncService::RsyncResponse>;
 class RsyncClient : public net::Thread {
  public:
   enum State {
@@ -52,6 +49,13 @@ class RsyncClient : public net::Thread {
       RUNNING,
       STOP,
   };
+  // Of the last full sync
+  struct Stats {
+    uint64_t reused_files = 0;
+    uint64_t reused_bytes = 0;
+    uint64_t transferred_files = 0;
+    uint64_t transferred_bytes = 0;
+  };
   RsyncClient(const std::string& dir, const std::string& db_name);
   void* ThreadMain() override;
   void Copy(const std::set<std::string>& file_set, int index);
@@ -67,10 +71,11 @@ class RsyncClient : public net::Thread {
   }
   bool IsIdle() { return state_.load() == IDLE;}
   void OnReceive(RsyncService::RsyncResponse* resp);
+  Stats GetStats();
 private:
   bool ComparisonUpdate();
-  Status CopyRemoteFile(const std::string& filename, int index);
-  Status PullRemoteMeta(std::string* snapshot_uuid, std::set<std::string>* file_set);
+  Status PullRemoteMeta(std::string* snapshot_uuid, std::set<std::string>* file_set, SstIdentityMap* remote_ssts);
+  void ReuseLocalSstFiles(const SstIdentityMap& remote_ssts);
   Status LoadLocalMeta(std::string* snapshot_uuid, std::map<std::string, std::string>* file_map);
   std::string GetLocalMetaFilePath();
   Status FlushMetaTable();
@@ -91,9 +96,14 @@ private:
   std::vector<std::thread> work_threads_;
   std::atomic<int> finished_work_cnt_ = 0;
 
+  std::atomic<uint64_t> reused_files_ = 0;
+  std::atomic<uint64_t> reused_bytes_ = 0;
+  std::atomic<uint64_t> transferred_files_ = 0;
+
   std::atomic<State> state_;
   int max_retries_ = 10;
   std::unique_ptr<WaitObjectManager> wo_mgr_;
+  std::unique_ptr<RsyncFetcher> fetcher_;
   std::condition_variable cond_;
   std::mutex mu_;
 
@@ -103,140 +113,5 @@ private:
   int parallel_num_;
 };
 
-class RsyncWriter {
- public:
-  RsyncWriter(const std::string& filepath) {
-    filepath_ = filepath;
-    fd_ = open(filepath.c_str(), O_RDWR | O_APPEND | O_CREAT, 0644);
-  }
-  ~RsyncWriter() {}
-  Status Write(uint64_t offset, size_t n, const char* data) {
-    const char* ptr = data;
-    size_t left = n;
-    Status s;
-    while (left != 0) {
-      ssize_t done = write(fd_, ptr, left);
-      if (done < 0) {
-        if (errno == EINTR) {
-          continue;
-        }
-        LOG(WARNING) << "pwrite failed, filename: " << filepath_ << "errno: " << strerror(errno) << "n: " << n;
-        return Status::IOError(filepath_, "pwrite failed");
-      }
-      left -= done;
-      ptr += done;
-      offset += done;
-    }
-    return Status::OK();
-  }
-  Status Close() {
-    close(fd_);
-    return Status::OK();
-  }
-  Status Fsync() {
-    fsync(fd_);
-    return Status::OK();
-  }
-
- private:
-  std::string filepath_;
-  int fd_ = -1;
-};
-
-class WaitObject {
- public:
-  WaitObject() : filename_(""), type_(RsyncService::kRsyncMeta), offset_(0), resp_(nullptr) {}
-  ~WaitObject() {}
-
-  void Reset(const std::string& filename, RsyncService::Type t, size_t offset) {
-    std::lock_guard<std::mutex> guard(mu_);
-    resp_.reset();
-    filename_ = filename;
-    type_ = t;
-    offset_ = offset;
-  }
-
-  pstd::Status Wait(ResponseSPtr& resp) {
-    auto timeout = g_pika_conf->rsync_timeout_ms();
-    std::unique_lock<std::mutex> lock(mu_);
-    auto cv_s = cond_.wait_for(lock, std::chrono::milliseconds(timeout), [this] {
-      return resp_.get() != nullptr;
-    });
-    if (!cv_s) {
-      std::string timout_info("timeout during(in ms) is ");
-      timout_info.append(std::to_string(timeout));
-      return pstd::Status::Timeout("rsync timeout", timout_info);
-    }
-    resp = resp_;
-    return pstd::Status::OK();
-  }
-
-  void WakeUp(RsyncService::RsyncResponse* resp) {
-    std::unique_lock<std::mutex> lock(mu_);
-    resp_.reset(resp);
-    offset_ = kInvalidOffset;
-    cond_.notify_all();
-  }
-
-  std::string Filename() {return filename_;}
-  RsyncService::Type Type() {return type_;}
-  size_t Offset() {return offset_;}
- private:
-  std::string filename_;
-  RsyncService::Type type_;
-  size_t offset_ = kInvalidOffset;
-  ResponseSPtr resp_ = nullptr;
-  std::condition_variable cond_;
-  std::mutex mu_;
-};
-
-class WaitObjectManager {
- public:
-  WaitObjectManager() {
-    wo_vec_.resize(kMaxRsyncParallelNum);
-    for (int i = 0; i < kMaxRsyncParallelNum; i++) {
-      wo_vec_[i] = new WaitObject();
-    }
-  }
-  ~WaitObjectManager() {
-    for (int i = 0; i < wo_vec_.size(); i++) {
-      delete wo_vec_[i];
-      wo_vec_[i] = nullptr;
-    }
-  }
-
-  WaitObject* UpdateWaitObject(int worker_index, const std::string& filename,
-                               RsyncService::Type type, size_t offset) {
-    std::lock_guard<std::mutex> guard(mu_);
-    wo_vec_[worker_index]->Reset(filename, type, offset);
-    return wo_vec_[worker_index];
-  }
-
-  void WakeUp(RsyncService::RsyncResponse* resp) {
-    std::lock_guard<std::mutex> guard(mu_);
-    int index = resp->reader_index();
-    if (wo_vec_[index] == nullptr || resp->type() != wo_vec_[index]->Type()) {
-      delete resp;
-      return;
-    }
-    if (resp->code() != RsyncService::kOk) {
-      LOG(WARNING) << "rsync response error";
-      wo_vec_[index]->WakeUp(resp);
-      return;
-    }
-
-    if (resp->type() == RsyncService::kRsyncFile &&
-        ((resp->file_resp().filename() != wo_vec_[index]->Filename()) ||
-	 (resp->file_resp().offset() != wo_vec_[index]->Offset()))) {
-      delete resp;
-      return;
-    }
-    wo_vec_[index]->WakeUp(resp);
-  }
- private:
-  std::vector<WaitObject*> wo_vec_;
-  std::mutex mu_;
-};
-
 } // end namespace rsync
 #endif
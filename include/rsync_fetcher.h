@@ -0,0 +1,253 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef RSYNC_FETCHER_H_
+#define RSYNC_FETCHER_H_
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "pstd/include/pstd_status.h"
+#include "include/pika_define.h"
+#include "include/rsync_client_thread.h"
+#include "include/rsync_window.h"
+#include "include/throttle.h"
+#include "rsync_service.pb.h"
+
+const size_t kInvalidOffset = 0xFFFFFFFF;
+// Size of the chunk requests of RsyncFetcher unless told otherwise
+const size_t kRsyncBytesPerRequest = 4 << 20;
+
+namespace rsync {
+
+using pstd::Status;
+
+using ResponseSPtr = std::shared_ptr<RsyncService::RsyncResponse>;
+
+class RsyncWriter {
+ public:
+  RsyncWriter(const std::string& filepath) {
+    filepath_ = filepath;
+    fd_ = open(filepath.c_str(), O_RDWR | O_APPEND | O_CREAT, 0644);
+  }
+  ~RsyncWriter() {}
+  Status Write(uint64_t offset, size_t n, const char* data) {
+    const char* ptr = data;
+    size_t left = n;
+    Status s;
+    while (left != 0) {
+      ssize_t done = write(fd_, ptr, left);
+      if (done < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        LOG(WARNING) << "pwrite failed, filename: " << filepath_ << "errno: " << strerror(errno) << "n: " << n;
+        return Status::IOError(filepath_, "pwrite failed");
+      }
+      left -= done;
+      ptr += done;
+      offset += done;
+    }
+    return Status::OK();
+  }
+  Status Close() {
+    close(fd_);
+    return Status::OK();
+  }
+  Status Fsync() {
+    fsync(fd_);
+    return Status::OK();
+  }
+
+ private:
+  std::string filepath_;
+  int fd_ = -1;
+};
+
+/*
+ * The responses a rsync worker waits for. A worker keeps several chunk
+ * requests of a file in flight, each one expected at its offset, and takes
+ * their responses in order. The meta request is expected at kInvalidOffset.
+ */
+class WaitObject {
+ public:
+  WaitObject() : filename_(""), type_(RsyncService::kRsyncMeta) {}
+  ~WaitObject() {}
+
+  // Forgets the requests in flight, their responses are dropped from now on
+  void Reset(const std::string& filename, RsyncService::Type t) {
+    std::lock_guard<std::mutex> guard(mu_);
+    pending_.clear();
+    error_.reset();
+    filename_ = filename;
+    type_ = t;
+  }
+
+  // Must be called before the request of offset is sent
+  void Expect(size_t offset) {
+    std::lock_guard<std::mutex> guard(mu_);
+    pending_[offset] = nullptr;
+  }
+
+  // Waits for the response to the request of offset, or for an error response
+  pstd::Status Wait(size_t offset, int64_t timeout_ms, ResponseSPtr& resp) {
+    std::unique_lock<std::mutex> lock(mu_);
+    auto cv_s = cond_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this, offset] {
+      auto iter = pending_.find(offset);
+      return error_ != nullptr || (iter != pending_.end() && iter->second != nullptr);
+    });
+    if (!cv_s) {
+      std::string timout_info("timeout during(in ms) is ");
+      timout_info.append(std::to_string(timeout_ms));
+      return pstd::Status::Timeout("rsync timeout", timout_info);
+    }
+    if (error_ != nullptr) {
+      resp = error_;
+      error_.reset();
+      return pstd::Status::OK();
+    }
+    auto iter = pending_.find(offset);
+    resp = iter->second;
+    pending_.erase(iter);
+    return pstd::Status::OK();
+  }
+
+  // Returns false if resp does not answer a request in flight
+  bool WakeUp(RsyncService::RsyncResponse* resp) {
+    std::lock_guard<std::mutex> guard(mu_);
+    if (resp->type() != type_) {
+      return false;
+    }
+    if (resp->code() != RsyncService::kOk) {
+      LOG(WARNING) << "rsync response error";
+      error_.reset(resp);
+      cond_.notify_all();
+      return true;
+    }
+    size_t offset = kInvalidOffset;
+    if (resp->type() == RsyncService::kRsyncFile) {
+      if (resp->file_resp().filename() != filename_) {
+        return false;
+      }
+      offset = resp->file_resp().offset();
+    }
+    auto iter = pending_.find(offset);
+    if (iter == pending_.end() || iter->second != nullptr) {
+      return false;
+    }
+    iter->second.reset(resp);
+    cond_.notify_all();
+    return true;
+  }
+
+ private:
+  std::string filename_;
+  RsyncService::Type type_;
+  // Offsets of the requests in flight, with their responses once received
+  std::map<size_t, ResponseSPtr> pending_;
+  ResponseSPtr error_ = nullptr;
+  std::condition_variable cond_;
+  std::mutex mu_;
+};
+
+class WaitObjectManager {
+ public:
+  WaitObjectManager() {
+    wo_vec_.resize(kMaxRsyncParallelNum);
+    for (int i = 0; i < kMaxRsyncParallelNum; i++) {
+      wo_vec_[i] = new WaitObject();
+    }
+  }
+  ~WaitObjectManager() {
+    for (int i = 0; i < wo_vec_.size(); i++) {
+      delete wo_vec_[i];
+      wo_vec_[i] = nullptr;
+    }
+  }
+
+  WaitObject* UpdateWaitObject(int worker_index, const std::string& filename, RsyncService::Type type) {
+    std::lock_guard<std::mutex> guard(mu_);
+    wo_vec_[worker_index]->Reset(filename, type);
+    return wo_vec_[worker_index];
+  }
+
+  void WakeUp(RsyncService::RsyncResponse* resp) {
+    std::lock_guard<std::mutex> guard(mu_);
+    int index = resp->reader_index();
+    if (index < 0 || index >= static_cast<int>(wo_vec_.size()) || wo_vec_[index] == nullptr ||
+        !wo_vec_[index]->WakeUp(resp)) {
+      delete resp;
+    }
+  }
+ private:
+  std::vector<WaitObject*> wo_vec_;
+  std::mutex mu_;
+};
+
+/*
+ * Pulls the files of a dump from the rsync server of a master, the part of
+ * RsyncClient that needs nothing of the pika server, so that
+ * tools/rsync_benchmark measures it as it runs. Each worker keeps up to the
+ * size of its RsyncWindow chunk requests in flight, within the bandwidth
+ * the throttle hands out.
+ */
+class RsyncFetcher {
+ public:
+  RsyncFetcher(const std::string& dir, const std::string& db_name, RsyncClientThread* client_thread,
+               WaitObjectManager* wo_mgr, Throttle* throttle);
+
+  // The rsync server of the master and the dump it serves, set before the files are pulled
+  void SetSource(const std::string& ip, int port, const std::string& snapshot_uuid);
+  // Checked between chunks, a copy gives up once it returns false
+  void SetRunning(std::function<bool()> running) { running_ = std::move(running); }
+  // Read before each wait, it may change at runtime
+  void SetTimeout(std::function<int64_t()> timeout_ms) { timeout_ms_ = std::move(timeout_ms); }
+  void SetChunkSize(size_t chunk_size) { chunk_size_ = chunk_size; }
+
+  /*
+   * Pulls filename of the dump into dir as worker index. Returns Incomplete
+   * when it gave up because running turned false or because the master
+   * serves a newer dump by now, the partial file is removed on any error.
+   */
+  Status CopyRemoteFile(const std::string& filename, int index, RsyncWindow* window);
+
+  uint64_t transferred_bytes() const { return transferred_bytes_.load(); }
+  void ResetStats() { transferred_bytes_.store(0); }
+
+ private:
+  Status SendFileRequest(const std::string& filename, int index, size_t offset, size_t count);
+
+  std::string dir_;
+  std::string db_name_;
+  RsyncClientThread* client_thread_ = nullptr;
+  WaitObjectManager* wo_mgr_ = nullptr;
+  Throttle* throttle_ = nullptr;
+
+  std::string master_ip_;
+  int master_port_ = 0;
+  std::string snapshot_uuid_;
+  std::function<bool()> running_ = [] { return true; };
+  std::function<int64_t()> timeout_ms_ = [] { return int64_t{1000}; };
+  size_t chunk_size_ = kRsyncBytesPerRequest;
+  int max_retries_ = 10;
+
+  std::atomic<uint64_t> transferred_bytes_ = 0;
+};
+
+}  // namespace rsync
+#endif  // RSYNC_FETCHER_H_
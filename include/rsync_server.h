@@ -10,6 +10,10 @@
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <algorithm>
 
 #include "net/include/net_conn.h"
 #include "net/include/net_thread.h"
@@ -19,7 +23,9 @@
 #include "net/src/holy_thread.h"
 #include "net/src/net_multiplexer.h"
 #include "pstd/include/env.h"
+#include "pstd/include/pstd_status.h"
 #include "pstd_hash.h"
+#include "include/pika_define.h"
 #include "rsync_service.pb.h"
 
 namespace rsync {
@@ -33,14 +39,32 @@ struct RsyncServerTaskArg {
 class RsyncReader;
 class RsyncServerThread;
 
+/*
+ * Where the rsync server finds the dumps it serves, pika serves the last
+ * bgsave of each DB, tools/rsync_benchmark a plain directory.
+ */
+class RsyncDumpProvider {
+ public:
+  virtual ~RsyncDumpProvider() = default;
+  // Fills in the files of the dump of db_name, fails while the dump is being written
+  virtual pstd::Status GetDumpMeta(const std::string& db_name, std::string* snapshot_uuid,
+                                   RsyncService::MetaResponse* meta) = 0;
+  // The directory the files of the dump of db_name are read from
+  virtual pstd::Status GetDumpPath(const std::string& db_name, std::string* snapshot_uuid,
+                                   std::string* dump_path) = 0;
+};
+
 class RsyncServer {
  public:
-  RsyncServer(const std::set<std::string>& ips, const int port);
+  RsyncServer(const std::set<std::string>& ips, const int port, std::unique_ptr<RsyncDumpProvider> provider,
+              int work_num = kMaxRsyncParallelNum);
   ~RsyncServer();
   void Schedule(net::TaskFunc func, void* arg);
   int Start();
   int Stop();
+  RsyncDumpProvider* provider() { return provider_.get(); }
  private:
+  std::unique_ptr<RsyncDumpProvider> provider_;
   std::unique_ptr<net::ThreadPool> work_thread_;
   std::unique_ptr<RsyncServerThread> rsync_server_thread_;
 };
@@ -93,93 +117,127 @@ class RsyncServerThread : public net::HolyThread {
 
 class RsyncReader {
  public:
-  RsyncReader() {
-    block_data_ = new char[kBlockSize];
-  }
+  RsyncReader() = default;
   ~RsyncReader() {
     if (!filepath_.empty()) {
       Reset();
     }
-    delete []block_data_;
   }
-  pstd::Status Read(const std::string filepath, const size_t offset,
-                    const size_t count, char* data, size_t* bytes_read,
-                    std::string* checksum, bool* is_eof) {
+
+  /*
+   * Serializes response into frame, followed by the chunk of at most count
+   * bytes at offset of filepath. The chunk is read from the file straight
+   * into the frame, as the data of a second file_resp record that protobuf
+   * parsers merge into the first one, instead of being copied into the
+   * message and then into its serialization. The count, offset, eof and
+   * file_size of the file_resp of response are filled in here, a chunk
+   * past the end of the file is empty.
+   */
+  pstd::Status ReadFrame(const std::string& filepath, const size_t offset, const size_t count,
+                         RsyncService::RsyncResponse* response, std::string* frame) {
     std::lock_guard<std::mutex> guard(mu_);
-    pstd::Status s = readAhead(filepath, offset);
+    pstd::Status s = open(filepath);
     if (!s.ok()) {
       return s;
     }
-    size_t offset_in_block = offset % kBlockSize;
-    size_t copy_count = count > (end_offset_ - offset) ? end_offset_ - offset : count;
-    memcpy(data, block_data_ + offset_in_block, copy_count);
-    *bytes_read = copy_count;
-    *is_eof = (offset + copy_count == total_size_);
-    return pstd::Status::OK();
-  }
-
-private:
-  pstd::Status readAhead(const std::string filepath, const size_t offset) {
-    if (filepath == filepath_ && offset >= start_offset_ && offset < end_offset_) {
+    size_t bytes = offset < total_size_ ? std::min(count, total_size_ - offset) : 0;
+    RsyncService::FileResponse* file_resp = response->mutable_file_resp();
+    file_resp->set_data("");
+    file_resp->set_count(bytes);
+    file_resp->set_offset(offset);
+    file_resp->set_eof(offset + bytes >= total_size_);
+    file_resp->set_file_size(total_size_);
+    if (!response->SerializeToString(frame)) {
+      return pstd::Status::Corruption("serialize rsync response failed");
+    }
+    if (bytes == 0) {
       return pstd::Status::OK();
     }
-    if (filepath != filepath_) {
-      Reset();
-      fd_ = open(filepath.c_str(), O_RDONLY);
-      if (fd_ < 0) {
-        LOG(ERROR) << "open file [" << filepath <<  "] failed! error: " << strerror(errno);
-        return pstd::Status::IOError("open file [" + filepath +  "] failed! error: " + strerror(errno));
+
+    // The tag of the data field takes a single byte
+    size_t data_record_size = 1 + varintLength(bytes) + bytes;
+    appendLengthDelimited(RsyncService::RsyncResponse::kFileRespFieldNumber, data_record_size, frame);
+    appendLengthDelimited(RsyncService::FileResponse::kDataFieldNumber, bytes, frame);
+    size_t pos = frame->size();
+    frame->resize(pos + bytes);
+    char* ptr = frame->data() + pos;
+    size_t read_offset = offset;
+    size_t left = bytes;
+    while (left > 0) {
+      ssize_t bytesin = pread(fd_, ptr, left, read_offset);
+      if (bytesin < 0 && errno == EINTR) {
+        continue;
       }
-      filepath_ = filepath;
-      struct stat buf;
-      stat(filepath.c_str(), &buf);
-      total_size_ = buf.st_size;
-    }
-    start_offset_ = (offset / kBlockSize) * kBlockSize;
-
-    size_t read_offset = start_offset_;
-    size_t read_count = kBlockSize > (total_size_ - read_offset) ? (total_size_ - read_offset) : kBlockSize;
-    ssize_t bytesin = 0;
-    char* ptr = block_data_;
-    while ((bytesin = pread(fd_, ptr, read_count, read_offset)) > 0) {
-      read_count -= bytesin;
+      if (bytesin <= 0) {
+        LOG(ERROR) << "unable to read from " << filepath << ". error: " << strerror(errno);
+        Reset();
+        return pstd::Status::IOError("unable to read from " + filepath + ". error: " + strerror(errno));
+      }
+      left -= bytesin;
       read_offset += bytesin;
       ptr += bytesin;
-      if (read_count <= 0) {
-        break;
-      }
     }
-    if (bytesin < 0) {
-      LOG(ERROR) << "unable to read from " << filepath << ". error: " << strerror(errno);
+    return pstd::Status::OK();
+  }
+
+ private:
+  pstd::Status open(const std::string& filepath) {
+    if (filepath == filepath_) {
+      return pstd::Status::OK();
+    }
+    Reset();
+    fd_ = ::open(filepath.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+      LOG(ERROR) << "open file [" << filepath <<  "] failed! error: " << strerror(errno);
+      return pstd::Status::IOError("open file [" + filepath +  "] failed! error: " + strerror(errno));
+    }
+    struct stat buf;
+    if (fstat(fd_, &buf) != 0) {
+      LOG(ERROR) << "stat file [" << filepath <<  "] failed! error: " << strerror(errno);
       Reset();
-      return pstd::Status::IOError("unable to read from " + filepath + ". error: " + strerror(errno));
+      return pstd::Status::IOError("stat file [" + filepath +  "] failed! error: " + strerror(errno));
     }
-    end_offset_ = start_offset_ + (ptr - block_data_);
+    // Chunks of a file are asked for in order, let the kernel read ahead of them
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+    filepath_ = filepath;
+    total_size_ = buf.st_size;
     return pstd::Status::OK();
   }
   void Reset() {
-    total_size_ = -1;
-    start_offset_ = 0xFFFFFFFF;
-    end_offset_ = 0xFFFFFFFF;
-    memset(block_data_, 0, kBlockSize);
-    md5_.reset(new pstd::MD5());
+    total_size_ = 0;
     filepath_ = "";
-    close(fd_);
+    if (fd_ >= 0) {
+      close(fd_);
+    }
     fd_ = -1;
   }
 
+  static size_t varintLength(uint64_t value) {
+    size_t len = 1;
+    while (value >= 0x80) {
+      value >>= 7;
+      len++;
+    }
+    return len;
+  }
+  // Appends the tag and the length of a length delimited protobuf field
+  static void appendLengthDelimited(int field_number, uint64_t length, std::string* frame) {
+    uint64_t tag = (static_cast<uint64_t>(field_number) << 3) | 2;
+    for (uint64_t value : {tag, length}) {
+      while (value >= 0x80) {
+        frame->push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+      }
+      frame->push_back(static_cast<char>(value));
+    }
+  }
+
  private:
   std::mutex mu_;
-  const size_t kBlockSize = 16 << 20;
-
-  char* block_data_;
-  size_t start_offset_ = -1;
-  size_t end_offset_ = -1;
-  size_t total_size_ = -1;
 
+  size_t total_size_ = 0;
   int fd_ = -1;
   std::string filepath_;
-  std::unique_ptr<pstd::MD5> md5_;
 };
 
 } //end namespace rsync
@@ -0,0 +1,58 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef RSYNC_SST_IDENTITY_H_
+#define RSYNC_SST_IDENTITY_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "pstd/include/pstd_status.h"
+#include "storage/storage.h"
+
+namespace rsync {
+
+/*
+ * What tells two copies of an SST file apart. A master and its slave number
+ * the files they create on their own, so two files of the same name may hold
+ * anything. The unique id RocksDB derives from the table properties, the
+ * session of the DB that wrote the file and the file number it had there, is
+ * kept by every copy of the file and by no other file. The size and the
+ * checksum in the MANIFEST, when there is one, are checked along with it.
+ */
+struct SstIdentity {
+  uint64_t size = 0;
+  std::string checksum_func;
+  // Hex encoded
+  std::string checksum;
+  // Hex encoded, see rocksdb::GetUniqueIdFromTableProperties
+  std::string unique_id;
+  // Where the file is, only set for the files of the local DB
+  std::string path;
+
+  bool SameContent(const SstIdentity& other) const {
+    return !unique_id.empty() && unique_id == other.unique_id && size == other.size &&
+           checksum_func == other.checksum_func && checksum == other.checksum;
+  }
+};
+
+// Keyed by <instance index>/<file name>, the way rsync names the files of a dump
+using SstIdentityMap = std::map<std::string, SstIdentity>;
+
+// The live SST files of storage that have a checksum in the MANIFEST and a unique id
+void GetLiveSstIdentities(storage::Storage* storage, int instance_num, SstIdentityMap* ssts);
+
+/*
+ * Saves the identities of the SST files in the dump at dump_path, taken from
+ * the live DB the dump was checkpointed from. The files of the dump are hard
+ * links to the live ones, those that are gone or changed size by now are left
+ * out and always transferred.
+ */
+pstd::Status WriteDumpSstIdentities(storage::Storage* storage, int instance_num, const std::string& dump_path);
+pstd::Status ReadDumpSstIdentities(const std::string& dump_path, SstIdentityMap* ssts);
+
+}  // namespace rsync
+#endif  // RSYNC_SST_IDENTITY_H_
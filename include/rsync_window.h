@@ -0,0 +1,86 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef RSYNC_WINDOW_H_
+#define RSYNC_WINDOW_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "pstd/include/env.h"
+
+namespace rsync {
+
+/*
+ * The number of file chunk requests a rsync worker keeps in flight. It is
+ * measured over rounds of as many chunks as the window holds: the window
+ * grows by one while the throughput of a round improves on the previous
+ * one, shrinks by one when it drops, and falls back to a single request
+ * after a timeout. A window that is not adaptive stays at max_size.
+ */
+class RsyncWindow {
+ public:
+  explicit RsyncWindow(size_t max_size, bool adaptive = true)
+      : max_size_(std::max<size_t>(max_size, 1)),
+        size_(adaptive ? std::min<size_t>(2, max_size_) : max_size_),
+        adaptive_(adaptive) {}
+
+  size_t Size() const { return size_; }
+
+  // Called for each chunk received, bytes is the size of its data
+  void OnChunk(size_t bytes) {
+    if (!adaptive_) {
+      return;
+    }
+    uint64_t now = pstd::NowMicros();
+    // A round starts when a chunk arrives and ends with the size_-th one after it
+    if (round_start_us_ == 0) {
+      round_start_us_ = now;
+      return;
+    }
+    round_bytes_ += bytes;
+    if (++round_chunks_ < size_) {
+      return;
+    }
+    double throughput =
+        static_cast<double>(round_bytes_) / static_cast<double>(std::max<uint64_t>(now - round_start_us_, 1));
+    if (throughput > last_throughput_ * kGrowRatio) {
+      size_ = std::min(size_ + 1, max_size_);
+    } else if (throughput < last_throughput_ * kShrinkRatio) {
+      size_ = std::max<size_t>(size_ - 1, 1);
+    }
+    last_throughput_ = throughput;
+    round_start_us_ = now;
+    round_chunks_ = 0;
+    round_bytes_ = 0;
+  }
+
+  void OnTimeout() {
+    if (!adaptive_) {
+      return;
+    }
+    size_ = 1;
+    last_throughput_ = 0;
+    round_start_us_ = 0;
+    round_chunks_ = 0;
+    round_bytes_ = 0;
+  }
+
+ private:
+  static constexpr double kGrowRatio = 1.05;
+  static constexpr double kShrinkRatio = 0.9;
+
+  size_t max_size_;
+  size_t size_;
+  bool adaptive_;
+  size_t round_chunks_ = 0;
+  size_t round_bytes_ = 0;
+  uint64_t round_start_us_ = 0;
+  double last_throughput_ = 0;
+};
+
+}  // namespace rsync
+#endif  // RSYNC_WINDOW_H_
@@ -0,0 +1,102 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+// Mixed GET/SET throughput of a cache sharded the way PikaCache does it,
+// crc32 of the key picks a RedisCache and its mutex, for a growing number
+// of shards.
+//
+//   ./cache_bench [threads] [seconds] [keys] [value_size] [get_percent]
+
+#include <zlib.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cache/include/cache.h"
+#include "cache/include/config.h"
+
+using namespace std::chrono;
+
+struct Shards {
+  std::vector<std::unique_ptr<cache::RedisCache>> caches;
+  std::vector<std::unique_ptr<std::mutex>> mutexs;
+
+  size_t Index(const std::string& key) const {
+    return crc32(0L, reinterpret_cast<const Bytef*>(key.data()), static_cast<uInt>(key.size())) % caches.size();
+  }
+};
+
+static double Run(size_t shard_num, int threads, int seconds, int keys, size_t value_size, int get_percent) {
+  Shards shards;
+  for (size_t i = 0; i < shard_num; i++) {
+    auto cache_obj = std::make_unique<cache::RedisCache>();
+    cache::Status s = cache_obj->Open();
+    if (!s.ok()) {
+      fprintf(stderr, "Open cache failed: %s\n", s.ToString().c_str());
+      exit(1);
+    }
+    shards.caches.push_back(std::move(cache_obj));
+    shards.mutexs.push_back(std::make_unique<std::mutex>());
+  }
+
+  std::atomic<bool> stop = false;
+  std::atomic<uint64_t> ops = 0;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      std::uniform_int_distribution<int> key_dist(0, keys - 1);
+      std::uniform_int_distribution<int> op_dist(0, 99);
+      std::string value(value_size, 'v');
+      std::string result;
+      uint64_t done = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        std::string key = "key:" + std::to_string(key_dist(rng));
+        size_t index = shards.Index(key);
+        std::lock_guard l(*shards.mutexs[index]);
+        if (op_dist(rng) < get_percent) {
+          shards.caches[index]->Get(key, &result);
+        } else {
+          shards.caches[index]->SetWithoutTTL(key, value);
+        }
+        done++;
+      }
+      ops += done;
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(seconds));
+  stop = true;
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return static_cast<double>(ops.load()) / seconds;
+}
+
+int main(int argc, char* argv[]) {
+  int threads = argc > 1 ? atoi(argv[1]) : static_cast<int>(std::thread::hardware_concurrency());
+  int seconds = argc > 2 ? atoi(argv[2]) : 5;
+  int keys = argc > 3 ? atoi(argv[3]) : 1000000;
+  size_t value_size = argc > 4 ? atoi(argv[4]) : 64;
+  int get_percent = argc > 5 ? atoi(argv[5]) : 80;
+
+  cache::CacheConfig cache_cfg;
+  cache_cfg.maxmemory_policy = cache::CACHE_ALLKEYS_LRU;
+  cache::RedisCache::SetConfig(&cache_cfg);
+
+  printf("threads %d, keys %d, value %zu bytes, %d%% GET\n", threads, keys, value_size, get_percent);
+  for (size_t shard_num = 1; shard_num <= 64; shard_num *= 2) {
+    double qps = Run(shard_num, threads, seconds, keys, value_size, get_percent);
+    printf("shards %2zu: %.0f ops/s\n", shard_num, qps);
+  }
+  return 0;
+}
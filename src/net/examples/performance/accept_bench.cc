@@ -0,0 +1,113 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "net/include/net_stats.h"
+#include "net/include/redis_conn.h"
+#include "net/include/server_thread.h"
+
+using namespace net;
+
+extern std::unique_ptr<NetworkStatistic> g_network_statistic;
+
+uint64_t NowMicros() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+class IdleConn : public RedisConn {
+ public:
+  IdleConn(int fd, const std::string& ip_port, Thread* thread) : RedisConn(fd, ip_port, thread) {}
+
+  int DealMessage(const RedisCmdArgsType& argv, std::string* response) override { return 0; }
+  const std::string& GetCurrentTable() override { return table_; }
+
+ private:
+  std::string table_ = "db0";
+};
+
+class IdleConnFactory : public ConnFactory {
+ public:
+  std::shared_ptr<NetConn> NewNetConn(int connfd, const std::string& ip_port, Thread* thread,
+                                      void* worker_specific_data, NetMultiplexer* net_mpx) const override {
+    return std::make_shared<IdleConn>(connfd, ip_port, thread);
+  }
+};
+
+static void Connect(int port, int conns, std::vector<int>* fds) {
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(port);
+  for (int i = 0; i < conns; i++) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+      perror("connect");
+      exit(-1);
+    }
+    fds->push_back(fd);
+  }
+}
+
+// Opens conns connections from clients threads at once, times until the workers took all of them in
+static void RunBench(bool reuse_port, int port, int workers, int clients, int conns) {
+  IdleConnFactory factory;
+  std::unique_ptr<ServerThread> st(NewDispatchThread("127.0.0.1", port, workers, &factory, 1000, conns));
+  st->SetReusePort(reuse_port);
+  if (st->StartThread() != 0) {
+    printf("StartThread failed\n");
+    exit(-1);
+  }
+
+  std::vector<std::vector<int>> fds(clients);
+  std::vector<std::thread> threads;
+  uint64_t start = NowMicros();
+  for (int i = 0; i < clients; i++) {
+    threads.emplace_back(Connect, port, conns / clients, &fds[i]);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  int total = conns / clients * clients;
+  while (st->conn_num() < total) {
+    std::this_thread::yield();
+  }
+  uint64_t cost = NowMicros() - start;
+
+  std::string spread;
+  for (uint64_t accepted : st->accepted_conns()) {
+    spread += " " + std::to_string(accepted);
+  }
+  printf("%-11s conns %6d: %8.0f accepts/s, per worker%s\n", reuse_port ? "reuse-port" : "dispatcher", total,
+         static_cast<double>(total) * 1000000 / cost, spread.c_str());
+
+  for (auto& client_fds : fds) {
+    for (int fd : client_fds) {
+      close(fd);
+    }
+  }
+  st->StopThread();
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 2 || std::string(argv[1]) == "-h") {
+    printf("Usage: ./accept_bench port [conns]\n");
+    printf("opens many connections at once against a dispatch thread, with and without SO_REUSEPORT\n");
+    exit(0);
+  }
+  int port = atoi(argv[1]);
+  int conns = argc > 2 ? atoi(argv[2]) : 20000;
+  g_network_statistic = std::make_unique<NetworkStatistic>();
+  RunBench(false, port, 8, 16, conns);
+  RunBench(true, port + 1, 8, 16, conns);
+  return 0;
+}
@@ -0,0 +1,187 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "net/include/net_stats.h"
+#include "net/include/redis_conn.h"
+
+using namespace net;
+
+extern std::unique_ptr<NetworkStatistic> g_network_statistic;
+
+static std::atomic<uint64_t> g_allocs{0};
+
+void* operator new(size_t size) {
+  g_allocs.fetch_add(1, std::memory_order_relaxed);
+  void* p = malloc(size == 0 ? 1 : size);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+uint64_t NowMicros() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+// Stands for a SET or GET command, key_ and value_ are taken from argv_ like DoInitial does
+struct BenchCmd {
+  virtual ~BenchCmd() = default;
+  virtual BenchCmd* Clone() { return new BenchCmd(*this); }
+  void Initial() {
+    key_ = argv_[1];
+    if (argv_.size() > 2) {
+      value_ = argv_[2];
+    }
+  }
+  RedisCmdArgsType argv_;
+  std::string key_;
+  std::string value_;
+};
+
+struct BenchTask {
+  std::vector<RedisCmdArgsType> redis_cmds;
+};
+
+/*
+ * Hands the parsed commands over the way PikaClientConn does. copied repeats
+ * the copies of the previous code: the parser, the task queued to the worker
+ * and Cmd::Initial each copied the arguments, and every command was cloned.
+ * moved hands them over with moves into commands taken from a freelist.
+ */
+class BenchConn : public RedisConn {
+ public:
+  BenchConn(int fd, const std::string& ip_port, bool copied) : RedisConn(fd, ip_port, nullptr), copied_(copied) {}
+
+  int DealMessage(const RedisCmdArgsType& argv, std::string* response) override { return 0; }
+  const std::string& GetCurrentTable() override { return table_; }
+
+  void ProcessRedisCmds(std::vector<RedisCmdArgsType>&& argvs, bool async, std::string* response) override {
+    auto task = std::make_unique<BenchTask>();
+    if (copied_) {
+      std::vector<RedisCmdArgsType> parsed = argvs;
+      task->redis_cmds = parsed;
+      for (const auto& argv : task->redis_cmds) {
+        std::shared_ptr<BenchCmd> cmd(proto_.Clone());
+        cmd->argv_ = argv;
+        cmd->Initial();
+        processed_++;
+      }
+    } else {
+      task->redis_cmds = std::move(argvs);
+      for (auto& argv : task->redis_cmds) {
+        std::shared_ptr<BenchCmd> cmd = Acquire();
+        cmd->argv_ = std::move(argv);
+        cmd->Initial();
+        processed_++;
+      }
+    }
+  }
+
+  uint64_t processed() const { return processed_; }
+
+ private:
+  std::shared_ptr<BenchCmd> Acquire() {
+    BenchCmd* cmd = nullptr;
+    if (free_cmds_.empty()) {
+      cmd = proto_.Clone();
+    } else {
+      cmd = free_cmds_.back();
+      free_cmds_.pop_back();
+    }
+    return {cmd, [this](BenchCmd* released) {
+              released->argv_.clear();
+              free_cmds_.push_back(released);
+            }};
+  }
+
+  bool copied_;
+  uint64_t processed_ = 0;
+  BenchCmd proto_;
+  std::vector<BenchCmd*> free_cmds_;
+  std::string table_ = "db0";
+};
+
+static std::string Request(const std::vector<std::string>& argv) {
+  std::string req = "*" + std::to_string(argv.size()) + "\r\n";
+  for (const auto& arg : argv) {
+    req += "$" + std::to_string(arg.size()) + "\r\n" + arg + "\r\n";
+  }
+  return req;
+}
+
+static void RunBench(const char* name, bool copied, bool set, size_t value_size, int pipeline, int rounds) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    perror("socketpair");
+    exit(-1);
+  }
+  auto conn = std::make_unique<BenchConn>(fds[0], "bench", copied);
+  conn->SetNonblock();
+
+  std::string batch;
+  for (int i = 0; i < pipeline; i++) {
+    std::string key = "key:" + std::to_string(i);
+    batch += set ? Request({"set", key, std::string(value_size, 'x')}) : Request({"get", key});
+  }
+
+  uint64_t allocs = 0;
+  uint64_t cost = 0;
+  for (int i = 0; i < rounds; i++) {
+    if (write(fds[1], batch.data(), batch.size()) != static_cast<ssize_t>(batch.size())) {
+      perror("write");
+      exit(-1);
+    }
+    uint64_t start_allocs = g_allocs.load();
+    uint64_t start = NowMicros();
+    uint64_t expected = conn->processed() + pipeline;
+    while (conn->processed() < expected) {
+      ReadStatus status = conn->GetRequest();
+      if (status != kReadAll && status != kReadHalf) {
+        printf("%s: read failed %d\n", name, status);
+        exit(-1);
+      }
+    }
+    cost += NowMicros() - start;
+    allocs += g_allocs.load() - start_allocs;
+  }
+
+  uint64_t cmds = static_cast<uint64_t>(pipeline) * rounds;
+  printf("%-7s %s value_size %6zu pipeline %4d: %6.2f allocs/cmd, %8.3f us/cmd\n", name, set ? "SET" : "GET",
+         value_size, pipeline, static_cast<double>(allocs) / cmds, static_cast<double>(cost) / cmds);
+  close(fds[0]);
+  close(fds[1]);
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1 && std::string(argv[1]) == "-h") {
+    printf("Usage: ./argv_bench [rounds]\n");
+    printf("counts the allocations per command of copying the parsed arguments against moving them\n");
+    exit(0);
+  }
+  int rounds = argc > 1 ? atoi(argv[1]) : 1000;
+  g_network_statistic = std::make_unique<NetworkStatistic>();
+
+  const std::vector<std::pair<size_t, int>> cases = {{64, 1}, {64, 32}, {1024, 32}};
+  for (const auto& [value_size, pipeline] : cases) {
+    for (bool set : {true, false}) {
+      RunBench("copied", true, set, value_size, pipeline, rounds);
+      RunBench("moved", false, set, value_size, pipeline, rounds);
+    }
+  }
+  return 0;
+}
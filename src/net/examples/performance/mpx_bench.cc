@@ -0,0 +1,115 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "net/include/net_define.h"
+#include "net/src/net_multiplexer.h"
+
+using namespace net;
+
+uint64_t NowMicros() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+/*
+ * Serves the connections the way WorkerThread does: a readable fd is read
+ * and switched to writable, a writable fd is answered and switched back to
+ * readable, so each request costs two NetModEvent calls and a NetPoll.
+ */
+static void Serve(NetMultiplexer* mpx, const std::vector<int>& fds, std::atomic<bool>* stop) {
+  char buf[64];
+  for (int fd : fds) {
+    mpx->NetAddEvent(fd, kReadable);
+  }
+  while (!stop->load()) {
+    int nfds = mpx->NetPoll(10);
+    for (int i = 0; i < nfds; i++) {
+      NetFiredEvent* pfe = mpx->FiredEvents() + i;
+      if (pfe->mask & kReadable) {
+        if (read(pfe->fd, buf, sizeof(buf)) > 0) {
+          mpx->NetModEvent(pfe->fd, 0, kWritable);
+        }
+      } else if (pfe->mask & kWritable) {
+        if (write(pfe->fd, "+PONG\r\n", 7) == 7) {
+          mpx->NetModEvent(pfe->fd, 0, kReadable);
+        }
+      }
+    }
+  }
+  for (int fd : fds) {
+    mpx->NetDelEvent(fd, 0);
+  }
+}
+
+static void RunBench(const char* name, NetBackend backend, int conns, int seconds) {
+  std::unique_ptr<NetMultiplexer> mpx(CreateNetMultiplexer(NetMultiplexer::kUnlimitedQueue, backend));
+  mpx->Initialize();
+
+  std::vector<int> server_fds;
+  std::vector<int> client_fds;
+  for (int i = 0; i < conns; i++) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+      perror("socketpair");
+      exit(-1);
+    }
+    server_fds.push_back(fds[0]);
+    client_fds.push_back(fds[1]);
+  }
+
+  std::atomic<bool> stop = false;
+  std::thread server(Serve, mpx.get(), server_fds, &stop);
+
+  // Every connection has one request in flight
+  uint64_t requests = 0;
+  char buf[64];
+  uint64_t start = NowMicros();
+  uint64_t deadline = start + static_cast<uint64_t>(seconds) * 1000000;
+  while (NowMicros() < deadline) {
+    for (int fd : client_fds) {
+      if (write(fd, "PING\r\n", 6) != 6) {
+        perror("write");
+        exit(-1);
+      }
+    }
+    for (int fd : client_fds) {
+      if (read(fd, buf, sizeof(buf)) <= 0) {
+        perror("read");
+        exit(-1);
+      }
+    }
+    requests += conns;
+  }
+  uint64_t cost = NowMicros() - start;
+  stop.store(true);
+  server.join();
+
+  printf("%-8s conns %4d: %10.0f requests/s\n", name, conns, static_cast<double>(requests) * 1000000 / cost);
+  for (int i = 0; i < conns; i++) {
+    close(server_fds[i]);
+    close(client_fds[i]);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1 && std::string(argv[1]) == "-h") {
+    printf("Usage: ./mpx_bench [seconds]\n");
+    printf("serves ping requests over socketpairs with the epoll and the io_uring multiplexer\n");
+    exit(0);
+  }
+  int seconds = argc > 1 ? atoi(argv[1]) : 2;
+  for (int conns : {1, 16, 256}) {
+    RunBench("epoll", NetBackend::kEpoll, conns, seconds);
+    RunBench("io_uring", NetBackend::kIoUring, conns, seconds);
+  }
+  return 0;
+}
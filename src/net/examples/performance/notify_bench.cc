@@ -0,0 +1,84 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "net/src/net_item.h"
+#include "net/src/net_multiplexer.h"
+
+using namespace net;
+
+uint64_t NowMicros() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+// Polls in, every item taken from it is registered back to out
+static void Reflect(NetMultiplexer* in, NetMultiplexer* out, std::atomic<bool>* stop, uint64_t* round_trips,
+                    uint64_t* wakeups) {
+  std::vector<NetItem> items;
+  while (!stop->load()) {
+    int nfds = in->NetPoll(10);
+    for (int i = 0; i < nfds; i++) {
+      NetFiredEvent* pfe = in->FiredEvents() + i;
+      if (pfe->fd != in->NotifyReceiveFd() || (pfe->mask & kReadable) == 0) {
+        continue;
+      }
+      in->NotifyQueuePopAll(&items);
+      (*wakeups)++;
+      for (const auto& item : items) {
+        (*round_trips)++;
+        out->Register(item, true);
+      }
+    }
+  }
+}
+
+static void RunBench(int inflight, int seconds) {
+  std::unique_ptr<NetMultiplexer> ping(CreateNetMultiplexer());
+  std::unique_ptr<NetMultiplexer> pong(CreateNetMultiplexer());
+  ping->Initialize();
+  pong->Initialize();
+
+  std::atomic<bool> stop = false;
+  uint64_t ping_trips = 0;
+  uint64_t ping_wakeups = 0;
+  uint64_t pong_trips = 0;
+  uint64_t pong_wakeups = 0;
+  std::thread pinger(Reflect, ping.get(), pong.get(), &stop, &ping_trips, &ping_wakeups);
+  std::thread ponger(Reflect, pong.get(), ping.get(), &stop, &pong_trips, &pong_wakeups);
+
+  uint64_t start = NowMicros();
+  for (int i = 0; i < inflight; i++) {
+    pong->Register(NetItem(i, "bench", kNotiEpollin), true);
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(seconds));
+  stop.store(true);
+  pinger.join();
+  ponger.join();
+  uint64_t cost = NowMicros() - start;
+
+  uint64_t trips = ping_trips;
+  uint64_t wakeups = ping_wakeups + pong_wakeups;
+  printf("inflight %5d: %10.0f round trips/s, %6.2f items per wakeup\n", inflight,
+         static_cast<double>(trips) * 1000000 / (cost ? cost : 1),
+         static_cast<double>(ping_trips + pong_trips) / (wakeups ? wakeups : 1));
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1 && std::string(argv[1]) == "-h") {
+    printf("Usage: ./notify_bench [seconds]\n");
+    printf("bounces notifications between two NetMultiplexers polled by their own threads\n");
+    exit(0);
+  }
+  int seconds = argc > 1 ? atoi(argv[1]) : 2;
+  for (int inflight : {1, 16, 256, 4096}) {
+    RunBench(inflight, seconds);
+  }
+  return 0;
+}
@@ -0,0 +1,99 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include <type_traits>
+#include <thread>
+#include <vector>
+
+#include "net/include/thread_pool.h"
+#include "net/include/work_stealing_pool.h"
+
+using namespace net;
+
+uint64_t NowMicros() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+struct BenchTask {
+  std::atomic<uint64_t>* done;
+  // busy loop rounds, stands in for the cost of a command
+  int cost;
+};
+
+static void RunTask(void* arg) {
+  auto task = static_cast<BenchTask*>(arg);
+  volatile uint64_t sum = 0;
+  for (int i = 0; i < task->cost; i++) {
+    sum += i;
+  }
+  task->done->fetch_add(1, std::memory_order_relaxed);
+}
+
+// Every producer stands in for a client connection, one in every
+// slow_every of its tasks costs a hundred times the others
+template <typename Pool>
+static void RunBench(const char* name, Pool* pool, int producers, int tasks, int cost, int slow_every) {
+  std::atomic<uint64_t> done{0};
+  std::vector<std::vector<BenchTask>> args(producers);
+  for (int p = 0; p < producers; p++) {
+    for (int i = 0; i < tasks; i++) {
+      bool slow = slow_every > 0 && i % slow_every == 0;
+      args[p].push_back({&done, slow ? cost * 100 : cost});
+    }
+  }
+
+  uint64_t total = static_cast<uint64_t>(producers) * tasks;
+  uint64_t start = NowMicros();
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; p++) {
+    threads.emplace_back([&, p] {
+      for (auto& arg : args[p]) {
+        if constexpr (std::is_same_v<Pool, WorkStealingPool>) {
+          pool->Schedule(&RunTask, &arg, p);
+        } else {
+          pool->Schedule(&RunTask, &arg);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  while (done.load() < total) {
+    std::this_thread::yield();
+  }
+  uint64_t cost_us = NowMicros() - start;
+  printf("%-14s producers %3d cost %5d slow_every %4d: %10.0f tasks/s\n", name, producers, cost, slow_every,
+         static_cast<double>(total) * 1000000 / (cost_us ? cost_us : 1));
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1 && std::string(argv[1]) == "-h") {
+    printf("Usage: ./pool_bench [workers] [tasks per producer]\n");
+    printf("compares the FIFO ThreadPool against the WorkStealingPool\n");
+    exit(0);
+  }
+  int workers = argc > 1 ? atoi(argv[1]) : 8;
+  int tasks = argc > 2 ? atoi(argv[2]) : 100000;
+
+  ThreadPool thread_pool(workers, 100000);
+  WorkStealingPool work_stealing_pool(workers, 100000);
+  thread_pool.start_thread_pool();
+  work_stealing_pool.start_thread_pool();
+
+  const std::vector<std::vector<int>> cases = {{1, 10, 0}, {8, 10, 0}, {32, 10, 0}, {8, 1000, 0}, {32, 100, 64}};
+  for (const auto& c : cases) {
+    RunBench("thread_pool", &thread_pool, c[0], tasks, c[1], c[2]);
+    RunBench("work_stealing", &work_stealing_pool, c[0], tasks, c[1], c[2]);
+  }
+
+  thread_pool.stop_thread_pool();
+  work_stealing_pool.stop_thread_pool();
+  printf("work_stealing steals %lu\n", work_stealing_pool.steal_count());
+  return 0;
+}
@@ -0,0 +1,150 @@
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "net/include/net_stats.h"
+#include "net/include/redis_conn.h"
+
+using namespace net;
+
+extern std::unique_ptr<NetworkStatistic> g_network_statistic;
+
+uint64_t NowMicros() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+class BenchConn : public RedisConn {
+ public:
+  BenchConn(int fd, const std::string& ip_port) : RedisConn(fd, ip_port, nullptr) {}
+
+  int DealMessage(const RedisCmdArgsType& argv, std::string* response) override { return 0; }
+  const std::string& GetCurrentTable() override { return table_; }
+
+ private:
+  std::string table_ = "db0";
+};
+
+static void Drain(int fd, uint64_t total) {
+  std::vector<char> buf(1024 * 1024);
+  uint64_t nread = 0;
+  while (nread < total) {
+    ssize_t n = read(fd, buf.data(), buf.size());
+    if (n <= 0) {
+      break;
+    }
+    nread += n;
+  }
+}
+
+static bool Flush(BenchConn* conn, int fd) {
+  while (true) {
+    WriteStatus status = conn->SendReply();
+    if (status == kWriteAll) {
+      return true;
+    } else if (status == kWriteError) {
+      return false;
+    }
+    struct pollfd pfd = {fd, POLLOUT, 0};
+    poll(&pfd, 1, 1000);
+  }
+}
+
+static std::string BulkHeader(size_t len) { return "$" + std::to_string(len) + "\r\n"; }
+
+// Builds each reply the way CmdRes used to, every bulk string copied into one buffer
+static bool SendCopied(BenchConn* conn, int fd, const std::string& value, int values, int rounds) {
+  for (int i = 0; i < rounds; i++) {
+    std::vector<std::string> elements(values, value);
+    std::string reply = "*" + std::to_string(values) + "\r\n";
+    for (const auto& element : elements) {
+      reply.append(BulkHeader(element.size()));
+      reply.append(element);
+      reply.append("\r\n");
+    }
+    conn->WriteResp(reply);
+    if (!Flush(conn, fd)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Hands each bulk string to the connection as its own chunk, sent with writev
+static bool SendChained(BenchConn* conn, int fd, const std::string& value, int values, int rounds) {
+  for (int i = 0; i < rounds; i++) {
+    std::vector<std::string> elements(values, value);
+    std::string header = "*" + std::to_string(values) + "\r\n";
+    for (auto& element : elements) {
+      header.append(BulkHeader(element.size()));
+      conn->WriteResp(std::move(header));
+      conn->WriteResp(std::move(element));
+      header = "\r\n";
+    }
+    conn->WriteResp(std::move(header));
+    if (!Flush(conn, fd)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void RunBench(const char* name, bool chained, size_t value_size, int values, int rounds) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    perror("socketpair");
+    exit(-1);
+  }
+  auto conn = std::make_unique<BenchConn>(fds[0], "bench");
+  conn->SetNonblock();
+
+  std::string value(value_size, 'x');
+  uint64_t reply_size = 1 + std::to_string(values).size() + 2 + values * (BulkHeader(value_size).size() + value_size + 2);
+  uint64_t total = reply_size * rounds;
+  std::thread reader(Drain, fds[1], total);
+
+  uint64_t start = NowMicros();
+  bool ok = chained ? SendChained(conn.get(), fds[0], value, values, rounds)
+                    : SendCopied(conn.get(), fds[0], value, values, rounds);
+  if (!ok) {
+    shutdown(fds[0], SHUT_RDWR);
+  }
+  reader.join();
+  uint64_t cost = NowMicros() - start;
+
+  if (!ok) {
+    printf("%s: write failed\n", name);
+  } else {
+    printf("%-8s value_size %8zu values %5d: %8.2f us/reply, %8.2f MB/s\n", name, value_size, values,
+           static_cast<double>(cost) / rounds, static_cast<double>(total) / (cost ? cost : 1));
+  }
+  close(fds[0]);
+  close(fds[1]);
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1 && std::string(argv[1]) == "-h") {
+    printf("Usage: ./reply_bench [rounds]\n");
+    printf("compares replies copied into one buffer against chained buffers sent with writev\n");
+    exit(0);
+  }
+  int rounds = argc > 1 ? atoi(argv[1]) : 200;
+  g_network_statistic = std::make_unique<NetworkStatistic>();
+
+  const std::vector<std::pair<size_t, int>> cases = {
+      {16, 1000}, {1024, 1000}, {16 * 1024, 100}, {64 * 1024, 100}, {1024 * 1024, 10}};
+  for (const auto& [value_size, values] : cases) {
+    RunBench("copied", false, value_size, values, rounds);
+    RunBench("chained", true, value_size, values, rounds);
+  }
+  return 0;
+}
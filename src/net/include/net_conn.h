@@ -7,6 +7,7 @@
 #define NET_INCLUDE_NET_CONN_H_
 
 #include <sys/time.h>
+#include <memory>
 #include <sstream>
 #include <string>
 
@@ -46,6 +47,8 @@ class NetConn : public std::enable_shared_from_this<NetConn>, public pstd::nonco
   virtual ReadStatus GetRequest() = 0;
   virtual WriteStatus SendReply() = 0;
   virtual int WriteResp(const std::string& resp) { return 0; }
+  // Queues resp, which may be queued to other connections as well
+  virtual int WriteResp(const std::shared_ptr<const std::string>& resp) { return WriteResp(*resp); }
 
   virtual void TryResizeBuffer() {}
 
@@ -44,6 +44,15 @@ enum NotifyType {
   kNotiWait = 6,
 };
 
+/*
+ * How the worker threads of a dispatch thread wait for their connections
+ */
+enum class NetBackend {
+  kEpoll = 0,
+  // Falls back to epoll when the kernel does not support it
+  kIoUring = 1,
+};
+
 enum EventStatus {
   kNone = 0,
   kReadable = 0x1,
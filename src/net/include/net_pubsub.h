@@ -8,8 +8,10 @@
 
 #include <fcntl.h>
 #include <atomic>
+#include <deque>
 #include <functional>
 #include <map>
+#include <memory>
 #include <queue>
 #include <set>
 #include <string>
@@ -23,6 +25,7 @@
 #include "net/include/net_define.h"
 #include "net/include/net_thread.h"
 #include "net/src/net_multiplexer.h"
+#include "net/src/pubsub_pattern_index.h"
 
 namespace net {
 
@@ -35,8 +38,19 @@ class PubSubThread : public Thread {
 
   ~PubSubThread() override;
 
+  // A subscriber whose undelivered messages take more than this is disconnected
+  static constexpr size_t kMaxSubscriberPendingBytes = 32 * 1024 * 1024;
+  // Publish blocks while this many messages are queued to the pubsub thread
+  static constexpr size_t kMaxPendingPublish = 100000;
+
   // PubSub
 
+  /*
+   * Queues msg for delivery by the pubsub thread and returns without waiting
+   * for it. The returned number of receivers is counted when the message is
+   * queued: the subscribers of channel plus those of the matching patterns,
+   * a subscriber disconnected or evicted before delivery is still counted.
+   */
   int Publish(const std::string& channel, const std::string& msg);
 
   void Subscribe(const std::shared_ptr<NetConn>& conn, const std::vector<std::string>& channels, bool pattern,
@@ -70,6 +84,15 @@ class PubSubThread : public Thread {
     bool IsReady();
     std::shared_ptr<NetConn> conn;
     ReadyState ready_state;
+
+    // Messages not yet moved to the reply buffer of conn, only touched by
+    // the pubsub thread
+    std::deque<std::shared_ptr<const std::string>> pending_msgs;
+    size_t pending_bytes = 0;
+    bool flush_scheduled = false;
+    // Waiting for conn to become writable, nothing more is moved to its reply buffer
+    bool write_blocked = false;
+    bool evicted = false;
   };
 
   void UpdateConnReadyState(int fd, const ReadyState& state);
@@ -84,15 +107,39 @@ class PubSubThread : public Thread {
 
   int ClientChannelSize(const std::shared_ptr<NetConn>& conn);
 
+  struct PublishMsg {
+    PublishMsg(const std::string& _channel, const std::string& _msg) : channel(_channel), msg(_msg) {}
+    std::string channel;
+    std::string msg;
+    // Patterns matching channel when it was published
+    std::vector<std::string> patterns;
+    PublishMsg* next = nullptr;
+  };
+
+  // Delivers the published messages to the subscribers, then flushes them
+  void DeliverPublished();
+  void DeliverMsg(const PublishMsg& msg, std::vector<std::shared_ptr<ConnHandle>>* touched);
+  void QueueMsg(const std::shared_ptr<NetConn>& conn, const std::shared_ptr<const std::string>& payload,
+                std::vector<std::shared_ptr<ConnHandle>>* touched);
+  WriteStatus FlushConn(const std::shared_ptr<ConnHandle>& handle);
+  // Drops the patterns left without subscribers, pattern_mutex_ must be held
+  void PruneEmptyPatterns();
+
   int msg_pfd_[2];
   bool should_exit_;
 
   mutable pstd::RWMutex rwlock_; /* For external statistics */
   std::map<int, std::shared_ptr<ConnHandle>> conns_;
 
-  pstd::Mutex pub_mutex_;
-  pstd::CondVar receiver_rsignal_;
-  pstd::Mutex receiver_mutex_;
+  /*
+   * Messages published and not yet delivered, pushed by any thread, taken
+   * all at once by the pubsub thread, newest first
+   */
+  std::atomic<PublishMsg*> published_{nullptr};
+  std::atomic<size_t> published_num_{0};
+  // Publish waits on publish_cv_ for published_num_ to drop below kMaxPendingPublish
+  pstd::Mutex publish_mutex_;
+  pstd::CondVar publish_cv_;
 
   /*
    * receive fd from worker thread
@@ -100,10 +147,6 @@ class PubSubThread : public Thread {
   pstd::Mutex mutex_;
   std::queue<NetItem> queue_;
 
-  std::string channel_;
-  std::string message_;
-  int receivers_{-1};
-
   /*
    * The epoll handler
    */
@@ -120,6 +163,7 @@ class PubSubThread : public Thread {
 
   std::map<std::string, std::vector<std::shared_ptr<NetConn>>> pubsub_channel_;  // channel <---> conns
   std::map<std::string, std::vector<std::shared_ptr<NetConn>>> pubsub_pattern_;  // channel <---> conns
+  PatternIndex pattern_index_;  // patterns of pubsub_pattern_, protected by pattern_mutex_
 
 };  // class PubSubThread
 
@@ -33,6 +33,8 @@ class PbConn : public NetConn {
   WriteStatus SendReply() override;
   void TryResizeBuffer() override;
   int WriteResp(const std::string& resp) override;
+  // Queues resp without copying it, for large responses
+  int WriteResp(std::string&& resp);
   void NotifyWrite();
   void NotifyClose();
   void set_is_reply(bool reply) override;
@@ -6,7 +6,9 @@
 #ifndef NET_INCLUDE_REDIS_CONN_H_
 #define NET_INCLUDE_REDIS_CONN_H_
 
+#include <deque>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -30,12 +32,17 @@ class RedisConn : public NetConn {
   ReadStatus GetRequest() override;
   WriteStatus SendReply() override;
   int WriteResp(const std::string& resp) override;
+  // Takes over resp, a large one is queued as is and sent with writev
+  // instead of being copied into the reply buffer
+  int WriteResp(std::string&& resp);
+  // Queues resp as is, it is sent from the buffer shared with the others
+  int WriteResp(const std::shared_ptr<const std::string>& resp) override;
 
   void TryResizeBuffer() override;
   void SetHandleType(const HandleType& handle_type);
   HandleType GetHandleType();
 
-  virtual void ProcessRedisCmds(const std::vector<RedisCmdArgsType>& argvs, bool async, std::string* response);
+  virtual void ProcessRedisCmds(std::vector<RedisCmdArgsType>&& argvs, bool async, std::string* response);
   void NotifyEpoll(bool success);
 
   virtual int DealMessage(const RedisCmdArgsType& argv, std::string* response) = 0;
@@ -43,8 +50,13 @@ class RedisConn : public NetConn {
 
  private:
   static int ParserDealMessageCb(RedisParser* parser, const RedisCmdArgsType& argv);
-  static int ParserCompleteCb(RedisParser* parser, const std::vector<RedisCmdArgsType>& argvs);
+  static int ParserCompleteCb(RedisParser* parser, std::vector<RedisCmdArgsType>& argvs);
   ReadStatus ParseRedisParserStatus(RedisParserStatus status);
+  // Drops the nwritten bytes sent from the head of the reply
+  void ConsumeReply(size_t nwritten);
+
+  static constexpr int kMaxReplyIovecs = 128;
+  static constexpr size_t kMinReplyChunkSize = 16 * 1024;
 
   HandleType handle_type_ = kSynchronous;
 
@@ -54,7 +66,10 @@ class RedisConn : public NetConn {
   int msg_peak_ = 0;
   int command_len_ = 0;
 
-  uint32_t wbuf_pos_ = 0;
+  // The reply is resp_chain_ followed by response_, wbuf_pos_ is the
+  // offset already sent of the first of them
+  size_t wbuf_pos_ = 0;
+  std::deque<std::shared_ptr<const std::string>> resp_chain_;
   std::string response_;
 
   // For Redis Protocol parser
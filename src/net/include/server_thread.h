@@ -71,7 +71,8 @@ class ServerHandle {
 
   /*
    *  AccessHandle(...) will be invoked after client fd accept()
-   *  but before handled.
+   *  but before handled. With SetReusePort(true) the worker threads
+   *  accept, so it may be invoked from several threads at once.
    */
   virtual bool AccessHandle(std::string& ip) const {
     UNUSED(ip);
@@ -159,6 +160,15 @@ class ServerThread : public Thread {
 
   virtual void SetQueueLimit(int queue_limit) {}
 
+  /*
+   * Every worker thread listens on the port with its own SO_REUSEPORT
+   * socket and accepts by itself, set before StartThread
+   */
+  virtual void SetReusePort(bool /*reuse_port*/) {}
+
+  // Connections taken in by each worker thread since start
+  virtual std::vector<uint64_t> accepted_conns() const { return {}; }
+
   ~ServerThread() override;
 
  protected:
@@ -197,6 +207,11 @@ class ServerThread : public Thread {
 
   virtual int InitHandle();
   void* ThreadMain() override;
+  /*
+   * Accepts a connection of listen_fd and checks it with the handle,
+   * returns false when accept fails, *connfd is -1 when it was refused
+   */
+  bool AcceptConn(int listen_fd, int* connfd, std::string* ip_port);
   /*
    * The server event handle
    */
@@ -238,5 +253,12 @@ extern ServerThread* NewDispatchThread(const std::set<std::string>& ips, int por
                                        ConnFactory* conn_factory, int cron_interval = 0, int queue_limit = 1000,
                                        const ServerHandle* handle = nullptr);
 
+/*
+ * Backend of the worker threads of the dispatch threads created afterwards,
+ * epoll by default
+ */
+extern void SetNetBackend(NetBackend backend);
+extern NetBackend GetNetBackend();
+
 }  // namespace net
 #endif  // NET_INCLUDE_SERVER_THREAD_H_
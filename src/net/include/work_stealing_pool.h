@@ -0,0 +1,101 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef NET_INCLUDE_WORK_STEALING_POOL_H_
+#define NET_INCLUDE_WORK_STEALING_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "net/include/thread_pool.h"
+#include "pstd/include/noncopyable.h"
+
+namespace net {
+
+/*
+ * Bounded lock-free multi-producer multi-consumer queue of tasks, producers
+ * are the threads scheduling tasks, consumers are the owner worker and the
+ * workers stealing from it.
+ */
+class TaskQueue : public pstd::noncopyable {
+ public:
+  // capacity is rounded up to a power of two
+  explicit TaskQueue(size_t capacity);
+
+  bool Push(const Task& task);
+  bool Pop(Task* task);
+  // Approximate when called concurrently with Push or Pop
+  size_t Size() const;
+
+ private:
+  struct Cell {
+    std::atomic<size_t> seq;
+    Task task;
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_ = 0;
+  alignas(64) std::atomic<size_t> enqueue_pos_ = 0;
+  alignas(64) std::atomic<size_t> dequeue_pos_ = 0;
+};
+
+/*
+ * Thread pool with a queue per worker instead of a single locked queue.
+ * A task is queued to the home worker of its affinity hint, a worker
+ * running out of tasks steals from the others before going to sleep.
+ * Tasks with the same hint run in FIFO order as long as the caller has at
+ * most one of them queued at a time, which is how client connections use it.
+ */
+class WorkStealingPool : public pstd::noncopyable {
+ public:
+  static constexpr uint64_t kNoAffinity = UINT64_MAX;
+
+  WorkStealingPool(size_t worker_num, size_t max_queue_size, std::string thread_pool_name = "WorkStealingPool");
+  ~WorkStealingPool();
+
+  int start_thread_pool();
+  int stop_thread_pool();
+  bool should_stop();
+
+  // Blocks while every queue is full
+  void Schedule(TaskFunc func, void* arg, uint64_t affinity = kNoAffinity);
+  size_t max_queue_size();
+  size_t worker_size();
+  void cur_queue_size(size_t* qsize);
+  // Length of the queue of every worker
+  std::vector<size_t> queue_depths();
+  uint64_t steal_count();
+  std::string thread_pool_name();
+
+ private:
+  void RunWorker(size_t index);
+  bool Steal(size_t index, Task* task);
+  bool HasTask();
+  void WakeUpWorker();
+
+  size_t worker_num_;
+  size_t max_queue_size_;
+  std::string thread_pool_name_;
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<bool> running_ = false;
+  std::atomic<bool> should_stop_ = false;
+  std::atomic<uint64_t> next_worker_ = 0;
+  std::atomic<uint64_t> steals_ = 0;
+
+  // Only used to put idle workers to sleep
+  std::mutex park_mu_;
+  std::condition_variable park_cv_;
+  std::atomic<int> parked_num_ = 0;
+};
+
+}  // namespace net
+
+#endif  // NET_INCLUDE_WORK_STEALING_POOL_H_
@@ -3,11 +3,13 @@
 // LICENSE file in the root directory of this source tree. An additional grant
 // of patent rights can be found in the PATENTS file in the same directory.
 
+#include <atomic>
 #include <vector>
 
 #include <glog/logging.h>
 
 #include "net/src/dispatch_thread.h"
+#include "net/src/server_socket.h"
 #include "net/src/worker_thread.h"
 
 namespace net {
@@ -48,6 +50,12 @@ DispatchThread::DispatchThread(const std::set<std::string>& ips, int port, int w
 DispatchThread::~DispatchThread() = default;
 
 int DispatchThread::StartThread() {
+  if (reuse_port_) {
+    int ret = ListenInWorkers();
+    if (ret != kSuccess) {
+      return ret;
+    }
+  }
   for (int i = 0; i < work_num_; i++) {
     int ret = handle_->CreateWorkerSpecificData(&(worker_thread_[i]->private_data_));
     if (ret) {
@@ -92,6 +100,35 @@ int DispatchThread::StopThread() {
   return ServerThread::StopThread();
 }
 
+int DispatchThread::InitHandle() {
+  if (reuse_port_) {
+    // The workers listen by themselves, see ListenInWorkers
+    return kSuccess;
+  }
+  return ServerThread::InitHandle();
+}
+
+int DispatchThread::ListenInWorkers() {
+  std::set<std::string> ips = ips_;
+  if (ips.find("0.0.0.0") != ips.end()) {
+    ips = {"0.0.0.0"};
+  }
+  for (int i = 0; i < work_num_; i++) {
+    for (const auto& ip : ips) {
+      auto socket_p = std::make_shared<ServerSocket>(port_);
+      socket_p->set_reuse_port(true);
+      int ret = socket_p->Listen(ip);
+      if (ret != kSuccess) {
+        LOG(WARNING) << "worker " << i << " listen on " << ip << ":" << port_ << " failed, " << ret;
+        return ret;
+      }
+      worker_thread_[i]->AddListener(socket_p);
+    }
+  }
+  LOG(INFO) << work_num_ << " workers listen on port " << port_ << " with SO_REUSEPORT";
+  return kSuccess;
+}
+
 void DispatchThread::set_keepalive_timeout(int timeout) {
   for (int i = 0; i < work_num_; ++i) {
     worker_thread_[i]->set_keepalive_timeout(timeout);
@@ -106,6 +143,15 @@ int DispatchThread::conn_num() const {
   return conn_num;
 }
 
+std::vector<uint64_t> DispatchThread::accepted_conns() const {
+  std::vector<uint64_t> result;
+  result.reserve(work_num_);
+  for (int i = 0; i < work_num_; ++i) {
+    result.push_back(worker_thread_[i]->accepted_conns());
+  }
+  return result;
+}
+
 std::vector<ServerThread::ConnInfo> DispatchThread::conns_info() const {
   std::vector<ServerThread::ConnInfo> result;
   for (int i = 0; i < work_num_; ++i) {
@@ -346,4 +392,10 @@ extern ServerThread* NewDispatchThread(const std::set<std::string>& ips, int por
   return new DispatchThread(ips, port, work_num, conn_factory, cron_interval, queue_limit, handle);
 }
 
+static std::atomic<NetBackend> net_backend = NetBackend::kEpoll;
+
+extern void SetNetBackend(NetBackend backend) { net_backend.store(backend); }
+
+extern NetBackend GetNetBackend() { return net_backend.load(); }
+
 };  // namespace net
@@ -89,6 +89,10 @@ class DispatchThread : public ServerThread {
 
   void SetQueueLimit(int queue_limit) override;
 
+  void SetReusePort(bool reuse_port) override { reuse_port_ = reuse_port; }
+
+  std::vector<uint64_t> accepted_conns() const override;
+
   void AllConn(const std::function<void(const std::shared_ptr<NetConn>&)>& func);
 
   /**
@@ -134,6 +138,11 @@ class DispatchThread : public ServerThread {
   std::vector<std::unique_ptr<WorkerThread>> worker_thread_;
   int queue_limit_;
   std::map<WorkerThread*, void*> localdata_;
+  /*
+   * The workers accept on their own SO_REUSEPORT sockets instead of
+   * this thread handing them the new connections
+   */
+  bool reuse_port_ = false;
 
   std::unordered_map<std::string, std::unordered_set<std::shared_ptr<NetConn>>> key_conns_map_;
   std::unordered_map<std::shared_ptr<NetConn>, std::unordered_set<std::string>> conn_keys_map_;
@@ -141,6 +150,9 @@ class DispatchThread : public ServerThread {
 
   void HandleConnEvent(NetFiredEvent* pfe) override { UNUSED(pfe); }
 
+  int InitHandle() override;
+  int ListenInWorkers();
+
   /*
    *  Blpop/BRpop used
    */
@@ -12,11 +12,20 @@
 #include <glog/logging.h>
 
 #include "net/include/net_define.h"
+#include "net/src/net_io_uring.h"
 #include "pstd/include/xdebug.h"
 
 namespace net {
 
-NetMultiplexer* CreateNetMultiplexer(int limit) { return new NetEpoll(limit); }
+NetMultiplexer* CreateNetMultiplexer(int limit, NetBackend backend) {
+  if (backend == NetBackend::kIoUring) {
+    if (NetMultiplexer* net_io_uring = NetIoUring::Create(limit)) {
+      return net_io_uring;
+    }
+    LOG(WARNING) << "io_uring is not supported, fall back to epoll";
+  }
+  return new NetEpoll(limit);
+}
 
 NetEpoll::NetEpoll(int queue_limit) : NetMultiplexer(queue_limit) {
 #if defined(EPOLL_CLOEXEC)
@@ -0,0 +1,297 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "net/src/net_io_uring.h"
+
+#include <endian.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <glog/logging.h>
+
+#include "net/include/net_define.h"
+
+namespace net {
+
+static constexpr unsigned kSqEntries = 4096;
+// Every registered fd may have a completion pending
+static constexpr unsigned kCqEntries = 64 * 1024;
+// user_data of the poll removals, their own completions are dropped
+static constexpr uint64_t kRemoveData = UINT64_MAX;
+
+static uint64_t UserData(int fd, uint32_t gen) {
+  return (static_cast<uint64_t>(gen) << 32) | static_cast<uint32_t>(fd);
+}
+
+NetIoUring* NetIoUring::Create(int queue_limit) {
+  auto mpx = new NetIoUring(queue_limit);
+  if (!mpx->Setup()) {
+    delete mpx;
+    return nullptr;
+  }
+  return mpx;
+}
+
+NetIoUring::NetIoUring(int queue_limit) : NetMultiplexer(queue_limit) {}
+
+NetIoUring::~NetIoUring() {
+  if (sqes_) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (ring_) {
+    munmap(ring_, ring_size_);
+  }
+}
+
+bool NetIoUring::Setup() {
+  struct io_uring_params p;
+  memset(&p, 0, sizeof(p));
+  p.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+  p.cq_entries = kCqEntries;
+  multiplexer_ = static_cast<int>(syscall(__NR_io_uring_setup, kSqEntries, &p));
+  if (multiplexer_ < 0) {
+    LOG(WARNING) << "io_uring_setup failed, errno " << errno;
+    return false;
+  }
+  unsigned needed = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+  if ((p.features & needed) != needed) {
+    LOG(WARNING) << "io_uring lacks needed features, has " << p.features;
+    return false;
+  }
+
+  size_t sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  size_t cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  ring_size_ = std::max(sq_size, cq_size);
+  void* ring = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, multiplexer_,
+                    IORING_OFF_SQ_RING);
+  if (ring == MAP_FAILED) {
+    LOG(WARNING) << "io_uring ring mmap failed, errno " << errno;
+    return false;
+  }
+  ring_ = ring;
+  sqes_size_ = p.sq_entries * sizeof(struct io_uring_sqe);
+  void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, multiplexer_,
+                    IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    LOG(WARNING) << "io_uring sqes mmap failed, errno " << errno;
+    return false;
+  }
+  sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+  auto base = static_cast<char*>(ring_);
+  sq_head_ = reinterpret_cast<unsigned*>(base + p.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned*>(base + p.sq_off.tail);
+  sq_array_ = reinterpret_cast<unsigned*>(base + p.sq_off.array);
+  sq_mask_ = *reinterpret_cast<unsigned*>(base + p.sq_off.ring_mask);
+  sq_entries_ = p.sq_entries;
+  sqe_tail_ = *sq_tail_;
+  cq_head_ = reinterpret_cast<unsigned*>(base + p.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned*>(base + p.cq_off.tail);
+  cqes_ = reinterpret_cast<struct io_uring_cqe*>(base + p.cq_off.cqes);
+  cq_mask_ = *reinterpret_cast<unsigned*>(base + p.cq_off.ring_mask);
+  return true;
+}
+
+int NetIoUring::NetAddEvent(int fd, int mask) {
+  std::lock_guard l(mu_);
+  Update(fd, mask);
+  return 0;
+}
+
+int NetIoUring::NetModEvent(int fd, int old_mask, int mask) {
+  std::lock_guard l(mu_);
+  Update(fd, old_mask | mask);
+  return 0;
+}
+
+int NetIoUring::NetDelEvent(int fd, [[maybe_unused]] int mask) {
+  std::lock_guard l(mu_);
+  if (fd >= 0 && static_cast<size_t>(fd) < fds_.size()) {
+    Update(fd, 0);
+  }
+  return 0;
+}
+
+NetIoUring::FdState& NetIoUring::State(int fd) {
+  if (static_cast<size_t>(fd) >= fds_.size()) {
+    fds_.resize(fd + 1);
+  }
+  return fds_[fd];
+}
+
+void NetIoUring::Update(int fd, int mask) {
+  FdState& state = State(fd);
+  if (state.armed && state.mask == mask) {
+    return;
+  }
+  if (state.armed) {
+    PrepPollRemove(fd, state);
+    state.armed = false;
+  }
+  state.gen++;
+  state.mask = mask;
+  MarkDirty(fd);
+}
+
+void NetIoUring::MarkDirty(int fd) {
+  FdState& state = fds_[fd];
+  if (!state.dirty) {
+    state.dirty = true;
+    dirty_fds_.push_back(fd);
+  }
+}
+
+struct io_uring_sqe* NetIoUring::GetSqe() {
+  unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  if (sqe_tail_ - head >= sq_entries_) {
+    // Full, hand what is queued to the kernel without waiting
+    __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+    Enter(sqe_tail_ - head, 0, 0);
+    head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sqe_tail_ - head >= sq_entries_) {
+      return nullptr;
+    }
+  }
+  unsigned index = sqe_tail_ & sq_mask_;
+  struct io_uring_sqe* sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sq_array_[index] = index;
+  sqe_tail_++;
+  return sqe;
+}
+
+bool NetIoUring::PrepPollAdd(int fd, const FdState& state) {
+  struct io_uring_sqe* sqe = GetSqe();
+  if (!sqe) {
+    return false;
+  }
+  uint32_t events = 0;
+  if (state.mask & kReadable) {
+    events |= POLLIN;
+  }
+  if (state.mask & kWritable) {
+    events |= POLLOUT;
+  }
+#if __BYTE_ORDER == __BIG_ENDIAN
+  events = (events << 16) | (events >> 16);
+#endif
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = events;
+  sqe->user_data = UserData(fd, state.gen);
+  return true;
+}
+
+void NetIoUring::PrepPollRemove(int fd, const FdState& state) {
+  struct io_uring_sqe* sqe = GetSqe();
+  if (!sqe) {
+    // Its completion is dropped, the file is released once the poll fires
+    LOG(WARNING) << "io_uring submission queue full, poll of fd " << fd << " left armed";
+    return;
+  }
+  sqe->opcode = IORING_OP_POLL_REMOVE;
+  sqe->fd = -1;
+  sqe->addr = UserData(fd, state.gen);
+  sqe->user_data = kRemoveData;
+}
+
+int NetIoUring::Enter(unsigned to_submit, unsigned min_complete, int timeout) {
+  if (min_complete == 0) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, multiplexer_, to_submit, 0, 0, nullptr, 0));
+  }
+  struct __kernel_timespec ts;
+  struct io_uring_getevents_arg arg;
+  memset(&arg, 0, sizeof(arg));
+  if (timeout >= 0) {
+    ts.tv_sec = timeout / 1000;
+    ts.tv_nsec = (timeout % 1000) * 1000000LL;
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+  }
+  return static_cast<int>(syscall(__NR_io_uring_enter, multiplexer_, to_submit, min_complete,
+                                  IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg)));
+}
+
+int NetIoUring::NetPoll(int timeout) {
+  unsigned to_submit = 0;
+  bool ready = false;
+  {
+    std::lock_guard l(mu_);
+    // Arm again what fired or changed since the last round
+    size_t kept = 0;
+    for (int fd : dirty_fds_) {
+      FdState& state = fds_[fd];
+      if (!state.armed && state.mask != 0) {
+        if (!PrepPollAdd(fd, state)) {
+          // Retried next round
+          dirty_fds_[kept++] = fd;
+          continue;
+        }
+        state.armed = true;
+      }
+      state.dirty = false;
+    }
+    dirty_fds_.resize(kept);
+    __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+    to_submit = sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    ready = *cq_head_ != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  }
+
+  if (to_submit > 0 || !ready) {
+    int ret = Enter(to_submit, (ready || timeout == 0) ? 0 : 1, timeout);
+    if (ret < 0 && errno != ETIME && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      LOG(WARNING) << "io_uring_enter failed, errno " << errno;
+    }
+  }
+
+  std::lock_guard l(mu_);
+  return Reap();
+}
+
+int NetIoUring::Reap() {
+  int num_events = 0;
+  unsigned head = *cq_head_;
+  unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  while (head != tail && num_events < NET_MAX_CLIENTS) {
+    const struct io_uring_cqe& cqe = cqes_[head & cq_mask_];
+    head++;
+    if (cqe.user_data == kRemoveData) {
+      continue;
+    }
+    auto fd = static_cast<int>(cqe.user_data & 0xffffffff);
+    auto gen = static_cast<uint32_t>(cqe.user_data >> 32);
+    if (static_cast<size_t>(fd) >= fds_.size() || fds_[fd].gen != gen || !fds_[fd].armed) {
+      // Fired before its removal or change was submitted
+      continue;
+    }
+    fds_[fd].armed = false;
+    MarkDirty(fd);
+
+    NetFiredEvent& ev = fired_events_[num_events++];
+    ev.fd = fd;
+    ev.mask = 0;
+    if (cqe.res < 0) {
+      ev.mask |= kErrorEvent;
+      continue;
+    }
+    if (cqe.res & POLLIN) {
+      ev.mask |= kReadable;
+    }
+    if (cqe.res & POLLOUT) {
+      ev.mask |= kWritable;
+    }
+    if (cqe.res & (POLLERR | POLLHUP)) {
+      ev.mask |= kErrorEvent;
+    }
+  }
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  return num_events;
+}
+
+}  // namespace net
@@ -0,0 +1,83 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef NET_SRC_NET_IO_URING_H_
+#define NET_SRC_NET_IO_URING_H_
+#include <vector>
+
+#include <linux/io_uring.h>
+
+#include "net/src/net_multiplexer.h"
+
+namespace net {
+
+/*
+ * Readiness multiplexer on top of io_uring poll requests. Adding, changing
+ * and removing the events of a fd only queue submissions, they are all sent
+ * to the kernel by the io_uring_enter that waits in NetPoll, so a loop round
+ * costs one syscall whatever the number of NetModEvent calls.
+ *
+ * A poll request fires once and is armed again at the next NetPoll, which
+ * checks the fd right away and keeps the level-triggered behaviour of epoll.
+ *
+ * Unlike epoll a pending poll request holds a reference to the file, so
+ * NetDelEvent has to be called before a registered fd is closed.
+ */
+class NetIoUring final : public NetMultiplexer {
+ public:
+  // Returns nullptr when the kernel lacks io_uring or a feature in use
+  static NetIoUring* Create(int queue_limit = kUnlimitedQueue);
+  ~NetIoUring() override;
+
+  int NetAddEvent(int fd, int mask) override;
+  int NetDelEvent(int fd, [[maybe_unused]] int mask) override;
+  int NetModEvent(int fd, int old_mask, int mask) override;
+
+  int NetPoll(int timeout) override;
+
+ private:
+  struct FdState {
+    int mask = 0;
+    // Bumped on every change, completions of older requests are dropped
+    uint32_t gen = 0;
+    bool armed = false;
+    bool dirty = false;
+  };
+
+  explicit NetIoUring(int queue_limit);
+  bool Setup();
+  FdState& State(int fd);
+  void Update(int fd, int mask);
+  void MarkDirty(int fd);
+  struct io_uring_sqe* GetSqe();
+  bool PrepPollAdd(int fd, const FdState& state);
+  void PrepPollRemove(int fd, const FdState& state);
+  int Enter(unsigned to_submit, unsigned min_complete, int timeout);
+  int Reap();
+
+  // Guards the submission queue and fds_, NetDelEvent may come from
+  // another thread when a connection is moved out
+  pstd::Mutex mu_;
+  std::vector<FdState> fds_;
+  std::vector<int> dirty_fds_;
+
+  void* ring_ = nullptr;
+  size_t ring_size_ = 0;
+  struct io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned sq_entries_ = 0;
+  unsigned sqe_tail_ = 0;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  struct io_uring_cqe* cqes_ = nullptr;
+  unsigned cq_mask_ = 0;
+};
+
+}  // namespace net
+#endif  // NET_SRC_NET_IO_URING_H_
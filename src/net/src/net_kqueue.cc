@@ -16,7 +16,7 @@
 
 namespace net {
 
-NetMultiplexer* CreateNetMultiplexer(int limit) { return new NetKqueue(limit); }
+NetMultiplexer* CreateNetMultiplexer(int limit, [[maybe_unused]] NetBackend backend) { return new NetKqueue(limit); }
 
 NetKqueue::NetKqueue(int queue_limit) : NetMultiplexer(queue_limit) {
   multiplexer_ = ::kqueue();
@@ -7,6 +7,9 @@
 
 #include <fcntl.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
 #include <cstdlib>
 
 #include <glog/logging.h>
@@ -16,6 +19,13 @@
 namespace net {
 
 NetMultiplexer::NetMultiplexer(int queue_limit) : queue_limit_(queue_limit), fired_events_(NET_MAX_CLIENTS) {
+#ifdef __linux__
+  notify_receive_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (notify_receive_fd_ == -1) {
+    exit(-1);
+  }
+  notify_send_fd_ = notify_receive_fd_;
+#else
   int fds[2];
   if (pipe(fds) != 0) {
     exit(-1);
@@ -25,12 +35,24 @@ NetMultiplexer::NetMultiplexer(int queue_limit) : queue_limit_(queue_limit), fir
 
   fcntl(notify_receive_fd_, F_SETFD, fcntl(notify_receive_fd_, F_GETFD) | FD_CLOEXEC);
   fcntl(notify_send_fd_, F_SETFD, fcntl(notify_send_fd_, F_GETFD) | FD_CLOEXEC);
+  fcntl(notify_receive_fd_, F_SETFL, fcntl(notify_receive_fd_, F_GETFL) | O_NONBLOCK);
+#endif
 }
 
 NetMultiplexer::~NetMultiplexer() {
   if (multiplexer_ != -1) {
     ::close(multiplexer_);
   }
+  NotifyNode* node = notify_head_.exchange(nullptr);
+  while (node) {
+    NotifyNode* next = node->next;
+    delete node;
+    node = next;
+  }
+  ::close(notify_receive_fd_);
+  if (notify_send_fd_ != notify_receive_fd_) {
+    ::close(notify_send_fd_);
+  }
 }
 
 void NetMultiplexer::Initialize() {
@@ -38,18 +60,41 @@ void NetMultiplexer::Initialize() {
   init_ = true;
 }
 
-NetItem NetMultiplexer::NotifyQueuePop() {
+void NetMultiplexer::NotifyQueuePopAll(std::vector<NetItem>* items) {
   if (!init_) {
     LOG(ERROR) << "please call NetMultiplexer::Initialize()";
     std::abort();
   }
 
-  NetItem it;
-  notify_queue_protector_.lock();
-  it = notify_queue_.front();
-  notify_queue_.pop();
-  notify_queue_protector_.unlock();
-  return it;
+  items->clear();
+  // Consume the signal before taking the items, an item registered after
+  // this point either is taken below or signals again
+#ifdef __linux__
+  uint64_t count = 0;
+  ssize_t n = read(notify_receive_fd_, &count, sizeof(count));
+  (void)(n);
+#else
+  char buf[128];
+  while (read(notify_receive_fd_, buf, sizeof(buf)) > 0) {
+  }
+#endif
+
+  NotifyNode* node = notify_head_.exchange(nullptr, std::memory_order_acquire);
+  // The list is newest first
+  NotifyNode* oldest = nullptr;
+  while (node) {
+    NotifyNode* next = node->next;
+    node->next = oldest;
+    oldest = node;
+    node = next;
+  }
+  while (oldest) {
+    NotifyNode* next = oldest->next;
+    items->push_back(std::move(oldest->item));
+    delete oldest;
+    oldest = next;
+  }
+  notify_queue_size_.fetch_sub(items->size(), std::memory_order_relaxed);
 }
 
 bool NetMultiplexer::Register(const NetItem& it, bool force) {
@@ -58,18 +103,28 @@ bool NetMultiplexer::Register(const NetItem& it, bool force) {
     return false;
   }
 
-  bool success = false;
-  notify_queue_protector_.lock();
-  if (force || queue_limit_ == kUnlimitedQueue || notify_queue_.size() < static_cast<size_t>(queue_limit_)) {
-    notify_queue_.push(it);
-    success = true;
+  if (!force && queue_limit_ != kUnlimitedQueue &&
+      notify_queue_size_.load(std::memory_order_relaxed) >= static_cast<size_t>(queue_limit_)) {
+    return false;
   }
-  notify_queue_protector_.unlock();
-  if (success) {
+  notify_queue_size_.fetch_add(1, std::memory_order_relaxed);
+
+  auto node = new NotifyNode{it, nullptr};
+  NotifyNode* prev = notify_head_.load(std::memory_order_relaxed);
+  do {
+    node->next = prev;
+  } while (!notify_head_.compare_exchange_weak(prev, node, std::memory_order_release, std::memory_order_relaxed));
+  // Only the first item of a batch wakes up the polling thread
+  if (!prev) {
+#ifdef __linux__
+    uint64_t one = 1;
+    ssize_t n = write(notify_send_fd_, &one, sizeof(one));
+#else
     ssize_t n = write(notify_send_fd_, "", 1);
+#endif
     (void)(n);
   }
-  return success;
+  return true;
 }
 
 }  // namespace net
@@ -5,7 +5,7 @@
 
 #ifndef NET_SRC_NET_MULTIPLEXER_H_
 #define NET_SRC_NET_MULTIPLEXER_H_
-#include <queue>
+#include <atomic>
 #include <vector>
 
 #include "net/src/net_item.h"
@@ -34,8 +34,11 @@ class NetMultiplexer {
 
   int NotifyReceiveFd() const { return notify_receive_fd_; }
   int NotifySendFd() const { return notify_send_fd_; }
-  NetItem NotifyQueuePop();
+  // Takes every queued item in the order they were registered, to be
+  // called each time NotifyReceiveFd becomes readable
+  void NotifyQueuePopAll(std::vector<NetItem>* items);
 
+  // Lock-free, may be called from any thread
   bool Register(const NetItem& it, bool force);
 
   static const int kUnlimitedQueue = -1;
@@ -46,15 +49,21 @@ class NetMultiplexer {
  protected:
   int multiplexer_ = -1;
   /*
-   * The PbItem queue is the fd queue, receive from dispatch thread
+   * The items registered by other threads, pushed to the head of a
+   * lock-free list and taken all at once by the polling thread
    */
+  struct NotifyNode {
+    NetItem item;
+    NotifyNode* next = nullptr;
+  };
   int queue_limit_ = kUnlimitedQueue;
-  pstd::Mutex notify_queue_protector_;
-  std::queue<NetItem> notify_queue_;
+  std::atomic<NotifyNode*> notify_head_ = nullptr;
+  std::atomic<size_t> notify_queue_size_ = 0;
   std::vector<NetFiredEvent> fired_events_;
 
   /*
-   * These two fd receive the notify from dispatch thread
+   * Signaled only when the first item lands in an empty queue, an eventfd
+   * where available, both are the same fd then
    */
   int notify_receive_fd_ = -1;
   int notify_send_fd_ = -1;
@@ -62,7 +71,8 @@ class NetMultiplexer {
   bool init_ = false;
 };
 
-NetMultiplexer* CreateNetMultiplexer(int queue_limit = NetMultiplexer::kUnlimitedQueue);
+NetMultiplexer* CreateNetMultiplexer(int queue_limit = NetMultiplexer::kUnlimitedQueue,
+                                     NetBackend backend = NetBackend::kEpoll);
 
 }  // namespace net
 #endif  // NET_SRC_NET_EPOLL_H_
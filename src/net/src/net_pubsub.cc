@@ -7,6 +7,8 @@
 #include <sstream>
 #include <vector>
 
+#include <glog/logging.h>
+
 #include "net/src/worker_thread.h"
 
 #include "net/include/net_conn.h"
@@ -60,7 +62,15 @@ PubSubThread::PubSubThread() {
   net_multiplexer_->NetAddEvent(msg_pfd_[0], kReadable);
 }
 
-PubSubThread::~PubSubThread() { StopThread(); }
+PubSubThread::~PubSubThread() {
+  StopThread();
+  PublishMsg* msg = published_.exchange(nullptr);
+  while (msg) {
+    PublishMsg* next = msg->next;
+    delete msg;
+    msg = next;
+  }
+}
 
 void PubSubThread::MoveConnOut(const std::shared_ptr<NetConn>& conn) {
   RemoveConn(conn);
@@ -135,6 +145,7 @@ void PubSubThread::RemoveConn(const std::shared_ptr<NetConn>& conn) {
         }
       }
     }
+    PruneEmptyPatterns();
   }
 
   {
@@ -160,22 +171,182 @@ void PubSubThread::CloseConn(const std::shared_ptr<NetConn>& conn) {
 }
 
 int PubSubThread::Publish(const std::string& channel, const std::string& msg) {
-  // TODO(LIBA-S): change the Publish Mode to Asynchronous
-  std::lock_guard lk(pub_mutex_);
-  channel_ = channel;
-  message_ = msg;
-  // Send signal to ThreadMain()
-  ssize_t n = write(msg_pfd_[1], "", 1);
-  (void)(n);
-  std::unique_lock lock(receiver_mutex_);
-  receiver_rsignal_.wait(lock, [this]() { return receivers_ != -1; });
-
-  int receivers = receivers_;
-  receivers_ = -1;
+  auto pub_msg = std::make_unique<PublishMsg>(channel, msg);
+  int receivers = 0;
+  {
+    std::lock_guard l(channel_mutex_);
+    auto it = pubsub_channel_.find(channel);
+    if (it != pubsub_channel_.end()) {
+      receivers += static_cast<int>(it->second.size());
+    }
+  }
+  {
+    std::lock_guard l(pattern_mutex_);
+    pattern_index_.Match(channel, [&](const std::string& pattern) {
+      auto it = pubsub_pattern_.find(pattern);
+      if (it != pubsub_pattern_.end()) {
+        receivers += static_cast<int>(it->second.size());
+      }
+      pub_msg->patterns.push_back(pattern);
+    });
+  }
+  if (receivers == 0) {
+    return 0;
+  }
 
+  // Back pressure, the pubsub thread falls behind
+  if (published_num_.load() >= kMaxPendingPublish) {
+    std::unique_lock lock(publish_mutex_);
+    publish_cv_.wait(lock, [this] { return published_num_.load() < kMaxPendingPublish || should_stop(); });
+  }
+  published_num_.fetch_add(1);
+  PublishMsg* head = pub_msg.release();
+  PublishMsg* prev = published_.load();
+  do {
+    head->next = prev;
+  } while (!published_.compare_exchange_weak(prev, head));
+  // Only the first message pushed to an empty list has to wake up the pubsub
+  // thread, it takes every message pushed before it gets to the list
+  if (!prev) {
+    ssize_t n = write(msg_pfd_[1], "", 1);
+    (void)(n);
+  }
   return receivers;
 }
 
+void PubSubThread::DeliverPublished() {
+  // Only this thread takes messages off, a publisher waiting on a full queue
+  // saw at least as many as this
+  bool wake_publishers = published_num_.load() >= kMaxPendingPublish;
+  PublishMsg* msg = published_.exchange(nullptr);
+  // Reverse into publish order
+  PublishMsg* msgs = nullptr;
+  while (msg) {
+    PublishMsg* next = msg->next;
+    msg->next = msgs;
+    msgs = msg;
+    msg = next;
+  }
+
+  std::vector<std::shared_ptr<ConnHandle>> touched;
+  while (msgs) {
+    std::unique_ptr<PublishMsg> cur(msgs);
+    msgs = msgs->next;
+    published_num_.fetch_sub(1);
+    DeliverMsg(*cur, &touched);
+  }
+  if (wake_publishers) {
+    std::lock_guard lock(publish_mutex_);
+    publish_cv_.notify_all();
+  }
+
+  // One flush per subscriber for the whole batch
+  for (const auto& handle : touched) {
+    handle->flush_scheduled = false;
+    const auto& conn = handle->conn;
+    if (handle->evicted) {
+      LOG(WARNING) << "Subscriber " << conn->ip_port() << " evicted, " << handle->pending_bytes
+                   << " bytes of messages undelivered";
+      MoveConnOut(conn);
+      CloseFd(conn);
+      continue;
+    }
+    if (handle->write_blocked) {
+      continue;
+    }
+    WriteStatus write_status = FlushConn(handle);
+    if (write_status == kWriteHalf) {
+      handle->write_blocked = true;
+      net_multiplexer_->NetModEvent(conn->fd(), kReadable, kWritable);
+    } else if (write_status == kWriteError) {
+      MoveConnOut(conn);
+      CloseFd(conn);
+    }
+  }
+}
+
+void PubSubThread::DeliverMsg(const PublishMsg& msg, std::vector<std::shared_ptr<ConnHandle>>* touched) {
+  {
+    std::lock_guard l(channel_mutex_);
+    auto it = pubsub_channel_.find(msg.channel);
+    if (it != pubsub_channel_.end() && !it->second.empty()) {
+      // Every subscriber of the channel gets the same reply
+      auto payload = std::make_shared<const std::string>(ConstructPublishResp(it->first, msg.channel, msg.msg, false));
+      std::shared_lock cl(rwlock_);
+      for (const auto& conn : it->second) {
+        QueueMsg(conn, payload, touched);
+      }
+    }
+  }
+
+  std::lock_guard l(pattern_mutex_);
+  for (const auto& pattern : msg.patterns) {
+    auto it = pubsub_pattern_.find(pattern);
+    if (it == pubsub_pattern_.end() || it->second.empty()) {
+      continue;
+    }
+    auto payload = std::make_shared<const std::string>(ConstructPublishResp(it->first, msg.channel, msg.msg, true));
+    std::shared_lock cl(rwlock_);
+    for (const auto& conn : it->second) {
+      QueueMsg(conn, payload, touched);
+    }
+  }
+}
+
+// REQUIRES: rwlock_ is held
+void PubSubThread::QueueMsg(const std::shared_ptr<NetConn>& conn, const std::shared_ptr<const std::string>& payload,
+                            std::vector<std::shared_ptr<ConnHandle>>* touched) {
+  auto it = conns_.find(conn->fd());
+  if (it == conns_.end() || it->second->conn != conn) {
+    return;
+  }
+  const auto& handle = it->second;
+  if (!handle->IsReady() || handle->evicted) {
+    return;
+  }
+  handle->pending_msgs.push_back(payload);
+  handle->pending_bytes += payload->size();
+  if (handle->pending_bytes > kMaxSubscriberPendingBytes) {
+    handle->evicted = true;
+  }
+  if (!handle->flush_scheduled) {
+    handle->flush_scheduled = true;
+    touched->push_back(handle);
+  }
+}
+
+WriteStatus PubSubThread::FlushConn(const std::shared_ptr<ConnHandle>& handle) {
+  // Bytes queued to the reply at a time, the payloads are queued as they are,
+  // every subscriber is sent from the same buffer
+  constexpr size_t kFlushBytes = 64 * 1024;
+  const auto& conn = handle->conn;
+  while (true) {
+    size_t moved = 0;
+    while (!handle->pending_msgs.empty() && moved < kFlushBytes) {
+      const auto& payload = handle->pending_msgs.front();
+      conn->WriteResp(payload);
+      moved += payload->size();
+      handle->pending_bytes -= payload->size();
+      handle->pending_msgs.pop_front();
+    }
+    WriteStatus write_status = conn->SendReply();
+    if (write_status != kWriteAll || handle->pending_msgs.empty()) {
+      return write_status;
+    }
+  }
+}
+
+void PubSubThread::PruneEmptyPatterns() {
+  for (auto it = pubsub_pattern_.begin(); it != pubsub_pattern_.end();) {
+    if (it->second.empty()) {
+      pattern_index_.Remove(it->first);
+      it = pubsub_pattern_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 /*
  * return the number of channels that the specific connection currently subscribed
  */
@@ -223,6 +394,7 @@ void PubSubThread::Subscribe(const std::shared_ptr<NetConn>& conn, const std::ve
       } else {  // the channel first subscribed
         std::vector<std::shared_ptr<NetConn>> conns = {conn};
         pubsub_pattern_[channel] = conns;
+        pattern_index_.Add(channel);
         ++subscribed;
       }
       result->emplace_back(channel, subscribed);
@@ -289,6 +461,7 @@ int PubSubThread::UnSubscribe(const std::shared_ptr<NetConn>& conn, const std::v
           channel_ptr->second.erase(std::remove(channel_ptr->second.begin(), channel_ptr->second.end(), conn),
                                     channel_ptr->second.end());
           result->emplace_back(channel, --subscribed);
+          PruneEmptyPatterns();
         } else {
           result->emplace_back(channel, subscribed);
         }
@@ -403,6 +576,7 @@ void PubSubThread::ConnCanSubscribe(const std::vector<std::string>& allChannel,
         }
       }
     }
+    PruneEmptyPatterns();
   }
 }
 
@@ -411,7 +585,7 @@ void* PubSubThread::ThreadMain() {
   NetFiredEvent* pfe;
   pstd::Status s;
   std::shared_ptr<NetConn> in_conn = nullptr;
-  char triger[1];
+  std::vector<NetItem> items;
 
   while (!should_stop()) {
     nfds = net_multiplexer_->NetPoll(NET_CRON_INTERVAL);
@@ -419,10 +593,8 @@ void* PubSubThread::ThreadMain() {
       pfe = (net_multiplexer_->FiredEvents()) + i;
       if (pfe->fd == net_multiplexer_->NotifyReceiveFd()) {  // New connection comming
         if (pfe->mask & kReadable) {
-          ssize_t n = read(net_multiplexer_->NotifyReceiveFd(), triger, 1);
-          (void)(n);
-          {
-            NetItem ti = net_multiplexer_->NotifyQueuePop();
+          net_multiplexer_->NotifyQueuePopAll(&items);
+          for (const NetItem& ti : items) {
             if (ti.notify_type() == kNotiClose) {
             } else if (ti.notify_type() == kNotiEpollout) {
               net_multiplexer_->NetModEvent(ti.fd(), 0, kWritable);
@@ -440,83 +612,16 @@ void* PubSubThread::ThreadMain() {
       }
       if (pfe->fd == msg_pfd_[0]) {  // Publish message
         if (pfe->mask & kReadable) {
-          ssize_t n = read(msg_pfd_[0], triger, 1);
+          char buf[128];
+          ssize_t n = read(msg_pfd_[0], buf, sizeof(buf));
           (void)(n);
-          std::string channel;
-          std::string msg;
-          int32_t receivers = 0;
-          channel = channel_;
-          msg = message_;
-          channel_.clear();
-          message_.clear();
-
-          // Send message to a channel's clients
-          channel_mutex_.lock();
-          auto it = pubsub_channel_.find(channel);
-          if (it != pubsub_channel_.end()) {
-            for (size_t i = 0; i < it->second.size(); i++) {
-              auto& conn = it->second[i];
-              if (!IsReady(conn->fd())) {
-                continue;
-              }
-              std::string resp = ConstructPublishResp(it->first, channel, msg, false);
-              conn->WriteResp(resp);
-              WriteStatus write_status = conn->SendReply();
-              if (write_status == kWriteHalf) {
-                net_multiplexer_->NetModEvent(conn->fd(), kReadable, kWritable);
-              } else if (write_status == kWriteError) {
-                channel_mutex_.unlock();
-
-                MoveConnOut(conn);
-
-                channel_mutex_.lock();
-                CloseFd(conn);
-              } else if (write_status == kWriteAll) {
-                receivers++;
-              }
-            }
-          }
-          channel_mutex_.unlock();
-
-          // Send message to a channel pattern's clients
-          pattern_mutex_.lock();
-          for (auto& it : pubsub_pattern_) {
-            if (pstd::stringmatchlen(it.first.c_str(), static_cast<int32_t>(it.first.size()), channel.c_str(),
-                                     static_cast<int32_t>(channel.size()), 0)) {
-              for (size_t i = 0; i < it.second.size(); i++) {
-                auto& conn = it.second[i];
-                if (!IsReady(conn->fd())) {
-                  continue;
-                }
-                std::string resp = ConstructPublishResp(it.first, channel, msg, true);
-                conn->WriteResp(resp);
-                WriteStatus write_status = conn->SendReply();
-                if (write_status == kWriteHalf) {
-                  net_multiplexer_->NetModEvent(conn->fd(), kReadable, kWritable);
-                } else if (write_status == kWriteError) {
-                  pattern_mutex_.unlock();
-
-                  MoveConnOut(conn);
-
-                  pattern_mutex_.lock();
-                  CloseFd(conn);
-                } else if (write_status == kWriteAll) {
-                  receivers++;
-                }
-              }
-            }
-          }
-          pattern_mutex_.unlock();
-
-          receiver_mutex_.lock();
-          receivers_ = receivers;
-          receiver_rsignal_.notify_one();
-          receiver_mutex_.unlock();
+          DeliverPublished();
         } else {
           continue;
         }
       } else {
         in_conn = nullptr;
+        std::shared_ptr<ConnHandle> handle;
         bool should_close = false;
 
         {
@@ -525,16 +630,17 @@ void* PubSubThread::ThreadMain() {
             net_multiplexer_->NetDelEvent(pfe->fd, 0);
             continue;
           } else {
-
-            in_conn = iter->second->conn;
+            handle = iter->second;
+            in_conn = handle->conn;
           }
         }
 
-        // Send reply
-        if ((pfe->mask & kWritable) && in_conn->is_ready_to_reply()) {
-          WriteStatus write_status = in_conn->SendReply();
+        // Send reply, then the messages queued while it was blocked
+        if ((pfe->mask & kWritable) && (in_conn->is_ready_to_reply() || handle->write_blocked)) {
+          WriteStatus write_status = FlushConn(handle);
           if (write_status == kWriteAll) {
             in_conn->set_is_reply(false);
+            handle->write_blocked = false;
             net_multiplexer_->NetModEvent(pfe->fd, 0, kReadable);  // Remove kWritable
           } else if (write_status == kWriteHalf) {
             continue;  //  send all write buffer,
@@ -557,6 +663,7 @@ void* PubSubThread::ThreadMain() {
             if (write_status == kWriteAll) {
               in_conn->set_is_reply(false);
             } else if (write_status == kWriteHalf) {
+              handle->write_blocked = true;
               net_multiplexer_->NetModEvent(pfe->fd, kReadable, kWritable);
             } else if (write_status == kWriteError) {
               should_close = true;
@@ -574,6 +681,11 @@ void* PubSubThread::ThreadMain() {
       }
     }
   }
+  {
+    // Publishers waiting on a full queue give up
+    std::lock_guard lock(publish_mutex_);
+    publish_cv_.notify_all();
+  }
   Cleanup();
   return nullptr;
 }
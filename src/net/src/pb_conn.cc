@@ -118,7 +118,7 @@ WriteStatus PbConn::SendReply() {
   size_t item_len;
   std::lock_guard l(resp_mu_);
   while (!write_buf_.queue_.empty()) {
-    std::string item = write_buf_.queue_.front();
+    const std::string& item = write_buf_.queue_.front();
     item_len = item.size();
     while (item_len - write_buf_.item_pos_ > 0) {
       nwritten = write(fd(), item.data() + write_buf_.item_pos_, item_len - write_buf_.item_pos_);
@@ -175,6 +175,16 @@ int PbConn::WriteResp(const std::string& resp) {
   return 0;
 }
 
+int PbConn::WriteResp(std::string&& resp) {
+  std::string tag;
+  BuildInternalTag(resp, &tag);
+  std::lock_guard l(resp_mu_);
+  write_buf_.queue_.push(std::move(tag));
+  write_buf_.queue_.push(std::move(resp));
+  set_is_reply(true);
+  return 0;
+}
+
 void PbConn::BuildInternalTag(const std::string& resp, std::string* tag) {
   uint32_t resp_size = resp.size();
   resp_size = htonl(resp_size);
@@ -0,0 +1,81 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "net/src/pubsub_pattern_index.h"
+
+#include <algorithm>
+
+#include "pstd/include/pstd_string.h"
+
+namespace net {
+
+size_t PatternIndex::LiteralPrefixLen(const std::string& pattern) {
+  size_t len = pattern.find_first_of("*?[\\");
+  return len == std::string::npos ? pattern.size() : len;
+}
+
+void PatternIndex::Add(const std::string& pattern) {
+  Node* node = &root_;
+  size_t prefix_len = LiteralPrefixLen(pattern);
+  for (size_t i = 0; i < prefix_len; i++) {
+    auto& child = node->children[pattern[i]];
+    if (!child) {
+      child = std::make_unique<Node>();
+    }
+    node = child.get();
+  }
+  if (std::find(node->patterns.begin(), node->patterns.end(), pattern) == node->patterns.end()) {
+    node->patterns.push_back(pattern);
+    size_++;
+  }
+}
+
+void PatternIndex::Remove(const std::string& pattern) {
+  std::vector<Node*> path = {&root_};
+  size_t prefix_len = LiteralPrefixLen(pattern);
+  for (size_t i = 0; i < prefix_len; i++) {
+    auto it = path.back()->children.find(pattern[i]);
+    if (it == path.back()->children.end()) {
+      return;
+    }
+    path.push_back(it->second.get());
+  }
+  auto& patterns = path.back()->patterns;
+  auto it = std::find(patterns.begin(), patterns.end(), pattern);
+  if (it == patterns.end()) {
+    return;
+  }
+  patterns.erase(it);
+  size_--;
+
+  // Prune the nodes left without patterns or children
+  for (size_t i = prefix_len; i > 0; i--) {
+    Node* node = path[i];
+    if (!node->patterns.empty() || !node->children.empty()) {
+      break;
+    }
+    path[i - 1]->children.erase(pattern[i - 1]);
+  }
+}
+
+void PatternIndex::Match(const std::string& channel, const std::function<void(const std::string&)>& func) const {
+  const Node* node = &root_;
+  size_t depth = 0;
+  while (node) {
+    for (const auto& pattern : node->patterns) {
+      if (pstd::stringmatchlen(pattern.data(), static_cast<int32_t>(pattern.size()), channel.data(),
+                               static_cast<int32_t>(channel.size()), 0)) {
+        func(pattern);
+      }
+    }
+    if (depth == channel.size()) {
+      break;
+    }
+    auto it = node->children.find(channel[depth++]);
+    node = it == node->children.end() ? nullptr : it->second.get();
+  }
+}
+
+}  // namespace net
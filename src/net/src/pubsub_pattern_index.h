@@ -0,0 +1,43 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef NET_SRC_PUBSUB_PATTERN_INDEX_H_
+#define NET_SRC_PUBSUB_PATTERN_INDEX_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace net {
+
+/*
+ * Trie of the subscribed patterns keyed by their literal prefix, the part
+ * before the first glob character. A channel only has to be matched against
+ * the patterns whose prefix it starts with, instead of against every one.
+ */
+class PatternIndex {
+ public:
+  void Add(const std::string& pattern);
+  void Remove(const std::string& pattern);
+  // Calls func with every pattern matching channel
+  void Match(const std::string& channel, const std::function<void(const std::string&)>& func) const;
+  size_t size() const { return size_; }
+
+ private:
+  struct Node {
+    std::map<char, std::unique_ptr<Node>> children;
+    std::vector<std::string> patterns;
+  };
+
+  static size_t LiteralPrefixLen(const std::string& pattern);
+
+  Node root_;
+  size_t size_ = 0;
+};
+
+}  // namespace net
+#endif  // NET_SRC_PUBSUB_PATTERN_INDEX_H_
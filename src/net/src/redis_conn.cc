@@ -5,6 +5,8 @@
 
 #include "net/include/redis_conn.h"
 
+#include <sys/uio.h>
+
 #include <cstdlib>
 #include <sstream>
 
@@ -119,48 +121,72 @@ ReadStatus RedisConn::GetRequest() {
     last_read_pos_ = -1;
     bulk_len_ = redis_parser_.get_bulk_len();
   }
-  if (!response_.empty()) {
+  if (!response_.empty() || !resp_chain_.empty()) {
     set_is_reply(true);
   }
   return read_status;  // OK || HALF || FULL_ERROR || PARSE_ERROR
 }
 
 WriteStatus RedisConn::SendReply() {
-  ssize_t nwritten = 0;
-  size_t wbuf_len = response_.size();
-  while (wbuf_len > 0) {
-    nwritten = write(fd(), response_.data() + wbuf_pos_, wbuf_len - wbuf_pos_);
-    if (nwritten <= 0) {
-      break;
+  struct iovec iov[kMaxReplyIovecs];
+  while (!resp_chain_.empty() || !response_.empty()) {
+    int iovcnt = 0;
+    for (auto& chunk : resp_chain_) {
+      if (iovcnt == kMaxReplyIovecs) {
+        break;
+      }
+      iov[iovcnt].iov_base = const_cast<char*>(chunk->data());
+      iov[iovcnt].iov_len = chunk->size();
+      iovcnt++;
+    }
+    if (iovcnt < kMaxReplyIovecs && !response_.empty()) {
+      iov[iovcnt].iov_base = response_.data();
+      iov[iovcnt].iov_len = response_.size();
+      iovcnt++;
+    }
+    iov[0].iov_base = static_cast<char*>(iov[0].iov_base) + wbuf_pos_;
+    iov[0].iov_len -= wbuf_pos_;
+
+    ssize_t nwritten = writev(fd(), iov, iovcnt);
+    if (nwritten == -1) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return kWriteHalf;
+      } else {
+        // Here we should close the connection
+        return kWriteError;
+      }
+    }
+    if (nwritten == 0) {
+      return kWriteHalf;
     }
     g_network_statistic->IncrRedisOutputBytes(nwritten);
-    wbuf_pos_ += nwritten;
-    if (wbuf_pos_ == wbuf_len) {
+    ConsumeReply(static_cast<size_t>(nwritten));
+  }
+  return kWriteAll;
+}
+
+void RedisConn::ConsumeReply(size_t nwritten) {
+  while (nwritten > 0) {
+    size_t front_len = resp_chain_.empty() ? response_.size() : resp_chain_.front()->size();
+    size_t left = front_len - wbuf_pos_;
+    if (nwritten < left) {
+      wbuf_pos_ += nwritten;
+      return;
+    }
+    nwritten -= left;
+    wbuf_pos_ = 0;
+    if (!resp_chain_.empty()) {
+      resp_chain_.pop_front();
+    } else {
       // Have sended all response data
-      if (wbuf_len > DEFAULT_WBUF_SIZE) {
+      if (response_.size() > DEFAULT_WBUF_SIZE) {
         std::string buf;
         buf.reserve(DEFAULT_WBUF_SIZE);
         response_.swap(buf);
       }
       response_.clear();
-
-      wbuf_len = 0;
-      wbuf_pos_ = 0;
     }
   }
-  if (nwritten == -1) {
-    if (errno == EAGAIN || errno == EWOULDBLOCK) {
-      return kWriteHalf;
-    } else {
-      // Here we should close the connection
-      return kWriteError;
-    }
-  }
-  if (wbuf_len == 0) {
-    return kWriteAll;
-  } else {
-    return kWriteHalf;
-  }
 }
 
 int RedisConn::WriteResp(const std::string& resp) {
@@ -169,6 +195,23 @@ int RedisConn::WriteResp(const std::string& resp) {
   return 0;
 }
 
+int RedisConn::WriteResp(std::string&& resp) {
+  if (resp.size() < kMinReplyChunkSize) {
+    return WriteResp(static_cast<const std::string&>(resp));
+  }
+  return WriteResp(std::make_shared<const std::string>(std::move(resp)));
+}
+
+int RedisConn::WriteResp(const std::shared_ptr<const std::string>& resp) {
+  if (!response_.empty()) {
+    resp_chain_.push_back(std::make_shared<const std::string>(std::move(response_)));
+    response_.clear();
+  }
+  resp_chain_.push_back(resp);
+  set_is_reply(true);
+  return 0;
+}
+
 void RedisConn::TryResizeBuffer() {
   struct timeval now;
   gettimeofday(&now, nullptr);
@@ -188,7 +231,7 @@ void RedisConn::SetHandleType(const HandleType& handle_type) { handle_type_ = ha
 
 HandleType RedisConn::GetHandleType() { return handle_type_; }
 
-void RedisConn::ProcessRedisCmds(const std::vector<RedisCmdArgsType>& argvs, bool async, std::string* response) {}
+void RedisConn::ProcessRedisCmds(std::vector<RedisCmdArgsType>&& argvs, bool async, std::string* response) {}
 
 void RedisConn::NotifyEpoll(bool success) {
   NetItem ti(fd(), ip_port(), success ? kNotiEpolloutAndEpollin : kNotiClose);
@@ -204,10 +247,10 @@ int RedisConn::ParserDealMessageCb(RedisParser* parser, const RedisCmdArgsType&
   }
 }
 
-int RedisConn::ParserCompleteCb(RedisParser* parser, const std::vector<RedisCmdArgsType>& argvs) {
+int RedisConn::ParserCompleteCb(RedisParser* parser, std::vector<RedisCmdArgsType>& argvs) {
   auto conn = reinterpret_cast<RedisConn*>(parser->data);
   bool async = conn->GetHandleType() == HandleType::kAsynchronous;
-  conn->ProcessRedisCmds(argvs, async, &(conn->response_));
+  conn->ProcessRedisCmds(std::move(argvs), async, &(conn->response_));
   return 0;
 }
 
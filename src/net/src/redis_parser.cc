@@ -5,6 +5,7 @@
 
 #include "net/include/redis_parser.h"
 
+#include <algorithm>
 #include <cassert> /* assert */
 
 #include <glog/logging.h>
@@ -14,6 +15,9 @@
 
 namespace net {
 
+// Upper bound of the arguments reserved up front for a multibulk request
+static constexpr long kMaxArgvReserve = 1024;
+
 static bool IsHexDigit(char ch) {
   return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F');
 }
@@ -244,6 +248,8 @@ RedisParserStatus RedisParser::ProcessMultibulkBuffer() {
       }
       cur_pos_ = pos + 1;
       argv_.clear();
+      // The length comes from the client, so only trust it that far
+      argv_.reserve(std::min<long>(multibulk_len_, kMaxArgvReserve));
       if (cur_pos_ > length_ - 1) {
         SetParserStatus(kRedisParserHalf);
         return status_code_;
@@ -367,9 +373,9 @@ RedisParserStatus RedisParser::ProcessRequestBuffer() {
       return kRedisParserError;
     }
     if (!argv_.empty()) {
-      argvs_.push_back(argv_);
+      argvs_.push_back(std::move(argv_));
       if (parser_settings_.DealMessage) {
-        if (parser_settings_.DealMessage(this, argv_) != 0) {
+        if (parser_settings_.DealMessage(this, argvs_.back()) != 0) {
           SetParserStatus(kRedisParserError, kRedisParserDealError);
           return status_code_;
         }
@@ -39,6 +39,14 @@ int ServerSocket::Listen(const std::string& bind_ip) {
   if (ret < 0) {
     return kSetSockOptError;
   }
+#ifdef SO_REUSEPORT
+  if (reuse_port_) {
+    ret = setsockopt(sockfd_, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(yes));
+    if (ret < 0) {
+      return kSetSockOptError;
+    }
+  }
+#endif
 
   servaddr_.sin_family = AF_INET;
   if (bind_ip.empty()) {
@@ -40,6 +40,10 @@ class ServerSocket : public pstd::noncopyable {
   void set_keep_alive(bool keep_alive) { keep_alive_ = keep_alive; }
   bool keep_alive() const { return keep_alive_; }
 
+  // Several sockets may listen on the same port, the kernel spreads the new connections over them
+  void set_reuse_port(bool reuse_port) { reuse_port_ = reuse_port; }
+  bool reuse_port() const { return reuse_port_; }
+
   void set_send_timeout(int send_timeout) { send_timeout_ = send_timeout; }
   int send_timeout() const { return send_timeout_; }
 
@@ -65,6 +69,7 @@ class ServerSocket : public pstd::noncopyable {
   int tcp_send_buffer_{0};
   int tcp_recv_buffer_{0};
   bool keep_alive_{false};
+  bool reuse_port_{false};
   bool listening_{false};
   bool is_block_;
 
@@ -0,0 +1,214 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "net/include/work_stealing_pool.h"
+#include "net/src/net_thread_name.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace net {
+
+// Rounds of looking for a task before an idle worker goes to sleep
+static constexpr int kSpinRounds = 64;
+// Bounds the wake up latency of a parked worker should a notification be missed
+static constexpr auto kParkTimeout = std::chrono::milliseconds(10);
+
+TaskQueue::TaskQueue(size_t capacity) {
+  size_t size = 2;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  cells_ = std::make_unique<Cell[]>(size);
+  mask_ = size - 1;
+  for (size_t i = 0; i < size; i++) {
+    cells_[i].seq.store(i, std::memory_order_relaxed);
+  }
+}
+
+bool TaskQueue::Push(const Task& task) {
+  size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  while (true) {
+    Cell* cell = &cells_[pos & mask_];
+    size_t seq = cell->seq.load(std::memory_order_acquire);
+    auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      // seq_cst, pairs with the check of a worker going to sleep
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1)) {
+        cell->task = task;
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      // full
+      return false;
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool TaskQueue::Pop(Task* task) {
+  size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+  while (true) {
+    Cell* cell = &cells_[pos & mask_];
+    size_t seq = cell->seq.load(std::memory_order_acquire);
+    auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+    if (diff == 0) {
+      if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        *task = cell->task;
+        cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      // empty
+      return false;
+    } else {
+      pos = dequeue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+size_t TaskQueue::Size() const {
+  size_t enqueue_pos = enqueue_pos_.load();
+  size_t dequeue_pos = dequeue_pos_.load();
+  return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+}
+
+WorkStealingPool::WorkStealingPool(size_t worker_num, size_t max_queue_size, std::string thread_pool_name)
+    : worker_num_(worker_num == 0 ? 1 : worker_num),
+      max_queue_size_(max_queue_size),
+      thread_pool_name_(std::move(thread_pool_name)) {
+  size_t capacity = std::max<size_t>(max_queue_size_ / worker_num_, 1);
+  for (size_t i = 0; i < worker_num_; i++) {
+    queues_.push_back(std::make_unique<TaskQueue>(capacity));
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() { stop_thread_pool(); }
+
+int WorkStealingPool::start_thread_pool() {
+  if (!running_.load()) {
+    should_stop_.store(false);
+    for (size_t i = 0; i < worker_num_; i++) {
+      workers_.emplace_back(&WorkStealingPool::RunWorker, this, i);
+      SetThreadName(workers_.back().native_handle(), thread_pool_name_ + "_Worker_" + std::to_string(i));
+    }
+    running_.store(true);
+  }
+  return kSuccess;
+}
+
+int WorkStealingPool::stop_thread_pool() {
+  if (running_.load()) {
+    should_stop_.store(true);
+    {
+      std::lock_guard lock(park_mu_);
+      park_cv_.notify_all();
+    }
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+    workers_.clear();
+    running_.store(false);
+  }
+  return 0;
+}
+
+bool WorkStealingPool::should_stop() { return should_stop_.load(); }
+
+void WorkStealingPool::Schedule(TaskFunc func, void* arg, uint64_t affinity) {
+  uint64_t home = affinity == kNoAffinity ? next_worker_.fetch_add(1, std::memory_order_relaxed) : affinity;
+  Task task(func, arg);
+  while (!should_stop()) {
+    // The home queue first, the others only when it is full
+    for (size_t i = 0; i < worker_num_; i++) {
+      if (queues_[(home + i) % worker_num_]->Push(task)) {
+        WakeUpWorker();
+        return;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+size_t WorkStealingPool::max_queue_size() { return max_queue_size_; }
+
+size_t WorkStealingPool::worker_size() { return worker_num_; }
+
+void WorkStealingPool::cur_queue_size(size_t* qsize) {
+  *qsize = 0;
+  for (const auto& queue : queues_) {
+    *qsize += queue->Size();
+  }
+}
+
+std::vector<size_t> WorkStealingPool::queue_depths() {
+  std::vector<size_t> depths;
+  depths.reserve(queues_.size());
+  for (const auto& queue : queues_) {
+    depths.push_back(queue->Size());
+  }
+  return depths;
+}
+
+uint64_t WorkStealingPool::steal_count() { return steals_.load(std::memory_order_relaxed); }
+
+std::string WorkStealingPool::thread_pool_name() { return thread_pool_name_; }
+
+void WorkStealingPool::RunWorker(size_t index) {
+  Task task;
+  int idle_rounds = 0;
+  while (!should_stop()) {
+    if (queues_[index]->Pop(&task) || Steal(index, &task)) {
+      idle_rounds = 0;
+      (*task.func)(task.arg);
+      continue;
+    }
+    if (++idle_rounds < kSpinRounds) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    idle_rounds = 0;
+    std::unique_lock lock(park_mu_);
+    // Announce before the last look at the queues, a producer either sees
+    // the parked worker or the worker sees its task
+    parked_num_.fetch_add(1);
+    if (!HasTask() && !should_stop()) {
+      park_cv_.wait_for(lock, kParkTimeout);
+    }
+    parked_num_.fetch_sub(1);
+  }
+}
+
+bool WorkStealingPool::Steal(size_t index, Task* task) {
+  for (size_t i = 1; i < worker_num_; i++) {
+    if (queues_[(index + i) % worker_num_]->Pop(task)) {
+      steals_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool WorkStealingPool::HasTask() {
+  for (const auto& queue : queues_) {
+    if (queue->Size() != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::WakeUpWorker() {
+  if (parked_num_.load() > 0) {
+    std::lock_guard lock(park_mu_);
+    park_cv_.notify_one();
+  }
+}
+
+}  // namespace net
@@ -13,9 +13,13 @@
 #include "dispatch_thread.h"
 #include "net/include/net_conn.h"
 #include "net/src/net_item.h"
+#include "net/src/server_socket.h"
 
 namespace net {
 
+// Bounds the time a reconnect storm takes from the connections already served
+static const int kMaxAcceptsPerPoll = 128;
+
 WorkerThread::WorkerThread(ConnFactory* conn_factory, ServerThread* server_thread, int queue_limit, int cron_interval)
     :
       server_thread_(server_thread),
@@ -25,7 +29,7 @@ WorkerThread::WorkerThread(ConnFactory* conn_factory, ServerThread* server_threa
   /*
    * install the protobuf handler here
    */
-  net_multiplexer_.reset(CreateNetMultiplexer(queue_limit));
+  net_multiplexer_.reset(CreateNetMultiplexer(queue_limit, GetNetBackend()));
   net_multiplexer_->Initialize();
 }
 
@@ -74,8 +78,7 @@ bool WorkerThread::MoveConnIn(const NetItem& it, bool force) { return net_multip
 void* WorkerThread::ThreadMain() {
   int nfds;
   NetFiredEvent* pfe = nullptr;
-  char bb[2048];
-  NetItem ti;
+  std::vector<NetItem> items;
   std::shared_ptr<NetConn> in_conn = nullptr;
 
   struct timeval when;
@@ -111,49 +114,33 @@ void* WorkerThread::ThreadMain() {
       }
       if (pfe->fd == net_multiplexer_->NotifyReceiveFd()) {
         if ((pfe->mask & kReadable) != 0) {
-          auto nread = static_cast<int32_t>(read(net_multiplexer_->NotifyReceiveFd(), bb, 2048));
-          if (nread == 0) {
-            continue;
-          } else {
-            for (int32_t idx = 0; idx < nread; ++idx) {
-              NetItem ti = net_multiplexer_->NotifyQueuePop();
-              if (ti.notify_type() == kNotiConnect) {
-                std::shared_ptr<NetConn> tc = conn_factory_->NewNetConn(ti.fd(), ti.ip_port(), server_thread_,
-                                                                        private_data_, net_multiplexer_.get());
-                if (!tc || !tc->SetNonblock()) {
-                  continue;
-                }
-
-#ifdef __ENABLE_SSL
-                // Create SSL failed
-                if (server_thread_->security() && !tc->CreateSSL(server_thread_->ssl_ctx())) {
-                  CloseFd(tc);
-                  continue;
-                }
-#endif
-
-                {
-                  std::lock_guard lock(rwlock_);
-                  conns_[ti.fd()] = tc;
-                }
-                net_multiplexer_->NetAddEvent(ti.fd(), kReadable);
-              } else if (ti.notify_type() == kNotiClose) {
-                // should close?
-              } else if (ti.notify_type() == kNotiEpollout) {
-                net_multiplexer_->NetModEvent(ti.fd(), 0, kWritable);
-              } else if (ti.notify_type() == kNotiEpollin) {
-                net_multiplexer_->NetModEvent(ti.fd(), 0, kReadable);
-              } else if (ti.notify_type() == kNotiEpolloutAndEpollin) {
-                net_multiplexer_->NetModEvent(ti.fd(), 0, kReadable | kWritable);
-              } else if (ti.notify_type() == kNotiWait) {
-                // do not register events
-                net_multiplexer_->NetAddEvent(ti.fd(), 0);
-              }
+          net_multiplexer_->NotifyQueuePopAll(&items);
+          for (const NetItem& ti : items) {
+            if (ti.notify_type() == kNotiConnect) {
+              NewConn(ti.fd(), ti.ip_port());
+            } else if (ti.notify_type() == kNotiClose) {
+              // should close?
+            } else if (ti.notify_type() == kNotiEpollout) {
+              net_multiplexer_->NetModEvent(ti.fd(), 0, kWritable);
+            } else if (ti.notify_type() == kNotiEpollin) {
+              net_multiplexer_->NetModEvent(ti.fd(), 0, kReadable);
+            } else if (ti.notify_type() == kNotiEpolloutAndEpollin) {
+              net_multiplexer_->NetModEvent(ti.fd(), 0, kReadable | kWritable);
+            } else if (ti.notify_type() == kNotiWait) {
+              // do not register events
+              net_multiplexer_->NetAddEvent(ti.fd(), 0);
             }
           }
         } else {
           continue;
         }
+      } else if (listen_fds_.find(pfe->fd) != listen_fds_.end()) {
+        if ((pfe->mask & kReadable) != 0) {
+          AcceptConns(pfe->fd);
+        } else if ((pfe->mask & kErrorEvent) != 0) {
+          LOG(WARNING) << "error on listen fd " << pfe->fd << ", stop accepting on it";
+          net_multiplexer_->NetDelEvent(pfe->fd, 0);
+        }
       } else {
         in_conn = nullptr;
         int should_close = 0;
@@ -202,7 +189,6 @@ void* WorkerThread::ThreadMain() {
         if (((pfe->mask & kErrorEvent) != 0) || (should_close != 0)) {
           //check if this conn disconnected from being blocked by blpop/brpop
           dynamic_cast<net::DispatchThread*>(server_thread_)->ClosingConnCheckForBlrPop(std::dynamic_pointer_cast<net::RedisConn>(in_conn));
-          net_multiplexer_->NetDelEvent(pfe->fd, 0);
           CloseFd(in_conn);
           in_conn = nullptr;
           {
@@ -219,6 +205,50 @@ void* WorkerThread::ThreadMain() {
   return nullptr;
 }
 
+void WorkerThread::AddListener(const std::shared_ptr<ServerSocket>& listener) {
+  listeners_.push_back(listener);
+  listen_fds_.insert(listener->sockfd());
+  net_multiplexer_->NetAddEvent(listener->sockfd(), kReadable);
+}
+
+void WorkerThread::NewConn(int connfd, const std::string& ip_port) {
+  std::shared_ptr<NetConn> tc =
+      conn_factory_->NewNetConn(connfd, ip_port, server_thread_, private_data_, net_multiplexer_.get());
+  if (!tc || !tc->SetNonblock()) {
+    return;
+  }
+
+#ifdef __ENABLE_SSL
+  // Create SSL failed
+  if (server_thread_->security() && !tc->CreateSSL(server_thread_->ssl_ctx())) {
+    CloseFd(tc);
+    return;
+  }
+#endif
+
+  {
+    std::lock_guard lock(rwlock_);
+    conns_[connfd] = tc;
+  }
+  net_multiplexer_->NetAddEvent(connfd, kReadable);
+  accepted_conns_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void WorkerThread::AcceptConns(int listen_fd) {
+  int connfd = -1;
+  std::string ip_port;
+  for (int i = 0; i < kMaxAcceptsPerPoll; i++) {
+    if (!server_thread_->AcceptConn(listen_fd, &connfd, &ip_port)) {
+      break;
+    }
+    if (connfd == -1) {
+      continue;
+    }
+    DLOG(INFO) << "accept new conn " << ip_port << " fd " << connfd;
+    NewConn(connfd, ip_port);
+  }
+}
+
 void WorkerThread::DoCronTask() {
   struct timeval now;
   gettimeofday(&now, nullptr);
@@ -302,6 +332,8 @@ bool WorkerThread::TryKillConn(const std::string& ip_port) {
 }
 
 void WorkerThread::CloseFd(const std::shared_ptr<NetConn>& conn) {
+  // epoll forgets a closed fd by itself, a pending io_uring poll would keep it open
+  net_multiplexer_->NetDelEvent(conn->fd(), 0);
   close(conn->fd());
   if (auto dispatcher = dynamic_cast<DispatchThread *>(server_thread_); dispatcher != nullptr ) {
     dispatcher->RemoveWatchKeys(conn);
@@ -310,6 +342,12 @@ void WorkerThread::CloseFd(const std::shared_ptr<NetConn>& conn) {
 }
 
 void WorkerThread::Cleanup() {
+  for (int fd : listen_fds_) {
+    net_multiplexer_->NetDelEvent(fd, 0);
+  }
+  listen_fds_.clear();
+  listeners_.clear();
+
   std::map<int, std::shared_ptr<NetConn>> to_close;
   {
     std::lock_guard l(rwlock_);
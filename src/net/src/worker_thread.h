@@ -26,6 +26,7 @@ class NetItem;
 class NetFiredEvent;
 class NetConn;
 class ConnFactory;
+class ServerSocket;
 
 class WorkerThread : public Thread {
  public:
@@ -48,6 +49,11 @@ class WorkerThread : public Thread {
   NetMultiplexer* net_multiplexer() { return net_multiplexer_.get(); }
   bool TryKillConn(const std::string& ip_port);
 
+  // Accept the connections of a listening socket, called before StartThread
+  void AddListener(const std::shared_ptr<ServerSocket>& listener);
+
+  uint64_t accepted_conns() const { return accepted_conns_.load(std::memory_order_relaxed); }
+
   ServerThread* GetServerThread() { return server_thread_; }
 
   mutable pstd::RWMutex rwlock_; /* For external statistics */
@@ -67,8 +73,14 @@ class WorkerThread : public Thread {
 
   std::atomic<int> keepalive_timeout_;  // keepalive second
 
+  std::vector<std::shared_ptr<ServerSocket>> listeners_;
+  std::set<int> listen_fds_;
+  std::atomic<uint64_t> accepted_conns_{0};
+
   void* ThreadMain() override;
   void DoCronTask();
+  void NewConn(int connfd, const std::string& ip_port);
+  void AcceptConns(int listen_fd);
 
   pstd::Mutex killer_mutex_;
   std::set<std::string> deleting_conn_ipport_;
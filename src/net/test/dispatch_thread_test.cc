@@ -0,0 +1,116 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "net/include/net_stats.h"
+#include "net/include/redis_conn.h"
+#include "net/include/server_thread.h"
+
+using namespace net;
+
+extern std::unique_ptr<NetworkStatistic> g_network_statistic;
+
+namespace {
+
+class IdleConn : public RedisConn {
+ public:
+  IdleConn(int fd, const std::string& ip_port, Thread* thread) : RedisConn(fd, ip_port, thread) {}
+
+  int DealMessage(const RedisCmdArgsType& argv, std::string* response) override { return 0; }
+  const std::string& GetCurrentTable() override { return table_; }
+
+ private:
+  std::string table_ = "db0";
+};
+
+class IdleConnFactory : public ConnFactory {
+ public:
+  std::shared_ptr<NetConn> NewNetConn(int connfd, const std::string& ip_port, Thread* thread,
+                                      void* worker_specific_data, NetMultiplexer* net_mpx) const override {
+    return std::make_shared<IdleConn>(connfd, ip_port, thread);
+  }
+};
+
+// A port nobody listens on right now
+int FreePort() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+  socklen_t len = sizeof(addr);
+  getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &len);
+  close(fd);
+  return ntohs(addr.sin_port);
+}
+
+int Connect(int port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(port);
+  if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool WaitConnNum(ServerThread* st, int num) {
+  for (int i = 0; i < 500; i++) {
+    if (st->conn_num() == num) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+
+void AcceptConns(bool reuse_port) {
+  constexpr int kWorkers = 4;
+  constexpr int kConns = 64;
+  g_network_statistic = std::make_unique<NetworkStatistic>();
+  IdleConnFactory factory;
+  int port = FreePort();
+  std::unique_ptr<ServerThread> st(NewDispatchThread("127.0.0.1", port, kWorkers, &factory, 100));
+  st->SetReusePort(reuse_port);
+  ASSERT_EQ(0, st->StartThread());
+
+  std::vector<int> fds;
+  for (int i = 0; i < kConns; i++) {
+    int fd = Connect(port);
+    ASSERT_NE(-1, fd);
+    fds.push_back(fd);
+  }
+  EXPECT_TRUE(WaitConnNum(st.get(), kConns)) << st->conn_num() << " connections taken in";
+
+  std::vector<uint64_t> accepted = st->accepted_conns();
+  ASSERT_EQ(kWorkers, accepted.size());
+  EXPECT_EQ(kConns, std::accumulate(accepted.begin(), accepted.end(), uint64_t{0}));
+
+  for (int fd : fds) {
+    close(fd);
+  }
+  EXPECT_TRUE(WaitConnNum(st.get(), 0));
+  st->StopThread();
+}
+
+}  // namespace
+
+TEST(DispatchThreadTest, AcceptInDispatchThread) { AcceptConns(false); }
+
+TEST(DispatchThreadTest, AcceptInWorkersWithReusePort) { AcceptConns(true); }
@@ -0,0 +1,112 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "net/src/net_io_uring.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "net/include/net_define.h"
+#include "net/src/net_item.h"
+
+namespace {
+
+class NetIoUringTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mpx_.reset(net::NetIoUring::Create());
+    if (!mpx_) {
+      GTEST_SKIP() << "io_uring not supported";
+    }
+    mpx_->Initialize();
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds_));
+  }
+
+  void TearDown() override {
+    if (mpx_) {
+      close(fds_[0]);
+      close(fds_[1]);
+    }
+  }
+
+  // Mask fired for fd in one NetPoll round, 0 when it did not fire
+  int Poll(int fd, int timeout = 100) {
+    int nfds = mpx_->NetPoll(timeout);
+    int mask = 0;
+    for (int i = 0; i < nfds; i++) {
+      net::NetFiredEvent* pfe = mpx_->FiredEvents() + i;
+      if (pfe->fd == fd) {
+        mask |= pfe->mask;
+      }
+    }
+    return mask;
+  }
+
+  std::unique_ptr<net::NetMultiplexer> mpx_;
+  int fds_[2];
+};
+
+}  // namespace
+
+TEST_F(NetIoUringTest, LevelTriggered) {
+  ASSERT_EQ(0, mpx_->NetAddEvent(fds_[0], net::kReadable));
+  EXPECT_EQ(0, Poll(fds_[0], 0));
+
+  ASSERT_EQ(1, write(fds_[1], "x", 1));
+  EXPECT_EQ(net::kReadable, Poll(fds_[0]));
+  // Not read yet, fires again
+  EXPECT_EQ(net::kReadable, Poll(fds_[0]));
+
+  char c;
+  ASSERT_EQ(1, read(fds_[0], &c, 1));
+  EXPECT_EQ(0, Poll(fds_[0], 0));
+}
+
+TEST_F(NetIoUringTest, ModAndDel) {
+  ASSERT_EQ(0, mpx_->NetAddEvent(fds_[0], net::kReadable));
+  EXPECT_EQ(0, Poll(fds_[0], 0));
+
+  ASSERT_EQ(0, mpx_->NetModEvent(fds_[0], 0, net::kWritable));
+  EXPECT_EQ(net::kWritable, Poll(fds_[0]));
+  ASSERT_EQ(0, mpx_->NetModEvent(fds_[0], 0, net::kReadable));
+  EXPECT_EQ(0, Poll(fds_[0], 0));
+
+  ASSERT_EQ(0, mpx_->NetDelEvent(fds_[0], 0));
+  ASSERT_EQ(1, write(fds_[1], "x", 1));
+  EXPECT_EQ(0, Poll(fds_[0], 0));
+
+  ASSERT_EQ(0, mpx_->NetAddEvent(fds_[0], net::kReadable));
+  EXPECT_EQ(net::kReadable, Poll(fds_[0]));
+}
+
+TEST_F(NetIoUringTest, PeerClosed) {
+  ASSERT_EQ(0, mpx_->NetAddEvent(fds_[0], net::kReadable));
+  close(fds_[1]);
+  fds_[1] = -1;
+  EXPECT_NE(0, Poll(fds_[0]) & net::kErrorEvent);
+}
+
+TEST_F(NetIoUringTest, Notify) {
+  ASSERT_TRUE(mpx_->Register(net::NetItem(7, "item"), true));
+  EXPECT_NE(0, Poll(mpx_->NotifyReceiveFd()) & net::kReadable);
+
+  std::vector<net::NetItem> items;
+  mpx_->NotifyQueuePopAll(&items);
+  ASSERT_EQ(1, items.size());
+  EXPECT_EQ(7, items[0].fd());
+  EXPECT_EQ(0, Poll(mpx_->NotifyReceiveFd(), 0));
+}
+
+TEST(NetIoUringFallbackTest, CreateNetMultiplexer) {
+  std::unique_ptr<net::NetMultiplexer> mpx(
+      net::CreateNetMultiplexer(net::NetMultiplexer::kUnlimitedQueue, net::NetBackend::kIoUring));
+  ASSERT_NE(nullptr, mpx);
+  mpx->Initialize();
+  ASSERT_TRUE(mpx->Register(net::NetItem(1, "item"), true));
+  EXPECT_GT(mpx->NetPoll(100), 0);
+}
@@ -0,0 +1,96 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "net/src/net_multiplexer.h"
+
+#include <poll.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "net/src/net_item.h"
+
+namespace {
+
+bool Readable(int fd) {
+  struct pollfd pfd = {fd, POLLIN, 0};
+  return poll(&pfd, 1, 0) == 1;
+}
+
+}  // namespace
+
+TEST(NetMultiplexerTest, PopAllInRegisterOrder) {
+  std::unique_ptr<net::NetMultiplexer> mpx(net::CreateNetMultiplexer());
+  mpx->Initialize();
+  EXPECT_FALSE(Readable(mpx->NotifyReceiveFd()));
+
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(mpx->Register(net::NetItem(i, "item"), false));
+  }
+  EXPECT_TRUE(Readable(mpx->NotifyReceiveFd()));
+
+  std::vector<net::NetItem> items;
+  mpx->NotifyQueuePopAll(&items);
+  ASSERT_EQ(100, items.size());
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(i, items[i].fd());
+  }
+  EXPECT_FALSE(Readable(mpx->NotifyReceiveFd()));
+
+  mpx->NotifyQueuePopAll(&items);
+  EXPECT_TRUE(items.empty());
+}
+
+TEST(NetMultiplexerTest, QueueLimit) {
+  std::unique_ptr<net::NetMultiplexer> mpx(net::CreateNetMultiplexer(2));
+  mpx->Initialize();
+  EXPECT_TRUE(mpx->Register(net::NetItem(1, "item"), false));
+  EXPECT_TRUE(mpx->Register(net::NetItem(2, "item"), false));
+  EXPECT_FALSE(mpx->Register(net::NetItem(3, "item"), false));
+  EXPECT_TRUE(mpx->Register(net::NetItem(4, "item"), true));
+
+  std::vector<net::NetItem> items;
+  mpx->NotifyQueuePopAll(&items);
+  EXPECT_EQ(3, items.size());
+  EXPECT_TRUE(mpx->Register(net::NetItem(5, "item"), false));
+}
+
+TEST(NetMultiplexerTest, ConcurrentRegister) {
+  constexpr int kProducers = 4;
+  constexpr int kItems = 20000;
+  std::unique_ptr<net::NetMultiplexer> mpx(net::CreateNetMultiplexer());
+  mpx->Initialize();
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; p++) {
+    producers.emplace_back([&mpx, p] {
+      for (int i = 0; i < kItems; i++) {
+        mpx->Register(net::NetItem(p * kItems + i, "item"), true);
+      }
+    });
+  }
+
+  // Items of one producer come out in order, and every item once
+  std::vector<int> next(kProducers, 0);
+  int total = 0;
+  std::vector<net::NetItem> items;
+  while (total < kProducers * kItems) {
+    int nfds = mpx->NetPoll(1000);
+    ASSERT_GT(nfds, 0) << "notification lost with " << total << " items taken";
+    mpx->NotifyQueuePopAll(&items);
+    for (const auto& item : items) {
+      int p = item.fd() / kItems;
+      ASSERT_EQ(next[p] + p * kItems, item.fd());
+      next[p]++;
+      total++;
+    }
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  mpx->NotifyQueuePopAll(&items);
+  EXPECT_TRUE(items.empty());
+}
@@ -0,0 +1,221 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "net/include/net_pubsub.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "net/include/net_stats.h"
+#include "net/include/redis_conn.h"
+#include "net/src/pubsub_pattern_index.h"
+
+using namespace net;
+
+extern std::unique_ptr<NetworkStatistic> g_network_statistic;
+
+namespace {
+
+class SubscriberConn : public RedisConn {
+ public:
+  SubscriberConn(int fd, const std::string& ip_port) : RedisConn(fd, ip_port, nullptr) {}
+
+  int DealMessage(const RedisCmdArgsType& argv, std::string* response) override { return 0; }
+  const std::string& GetCurrentTable() override { return table_; }
+
+ private:
+  std::string table_ = "db0";
+};
+
+std::vector<std::string> MatchAll(const PatternIndex& index, const std::string& channel) {
+  std::vector<std::string> patterns;
+  index.Match(channel, [&](const std::string& pattern) { patterns.push_back(pattern); });
+  std::sort(patterns.begin(), patterns.end());
+  return patterns;
+}
+
+// Reads exactly len bytes from fd, or whatever arrived before the timeout
+std::string ReadFor(int fd, size_t len, int timeout_ms = 3000) {
+  std::string buf;
+  char tmp[4096];
+  while (buf.size() < len) {
+    struct pollfd pfd = {fd, POLLIN, 0};
+    if (poll(&pfd, 1, timeout_ms) <= 0) {
+      break;
+    }
+    ssize_t n = read(fd, tmp, std::min(sizeof(tmp), len - buf.size()));
+    if (n <= 0) {
+      break;
+    }
+    buf.append(tmp, n);
+  }
+  return buf;
+}
+
+std::string Message(const std::string& channel, const std::string& msg) {
+  return "*3\r\n$7\r\nmessage\r\n$" + std::to_string(channel.size()) + "\r\n" + channel + "\r\n$" +
+         std::to_string(msg.size()) + "\r\n" + msg + "\r\n";
+}
+
+std::string PMessage(const std::string& pattern, const std::string& channel, const std::string& msg) {
+  return "*4\r\n$8\r\npmessage\r\n$" + std::to_string(pattern.size()) + "\r\n" + pattern + "\r\n$" +
+         std::to_string(channel.size()) + "\r\n" + channel + "\r\n$" + std::to_string(msg.size()) + "\r\n" + msg +
+         "\r\n";
+}
+
+}  // namespace
+
+TEST(PatternIndexTest, MatchByPrefix) {
+  PatternIndex index;
+  index.Add("news.*");
+  index.Add("news.sport.*");
+  index.Add("*");
+  index.Add("n?ws.*");
+  index.Add("weather");
+  index.Add("news.*");
+  EXPECT_EQ(5, index.size());
+
+  EXPECT_EQ(std::vector<std::string>({"*", "n?ws.*", "news.*", "news.sport.*"}), MatchAll(index, "news.sport.1"));
+  EXPECT_EQ(std::vector<std::string>({"*", "n?ws.*", "news.*"}), MatchAll(index, "news.tech"));
+  EXPECT_EQ(std::vector<std::string>({"*", "weather"}), MatchAll(index, "weather"));
+  EXPECT_EQ(std::vector<std::string>({"*"}), MatchAll(index, "weather.today"));
+  EXPECT_EQ(std::vector<std::string>({"*"}), MatchAll(index, ""));
+}
+
+TEST(PatternIndexTest, Remove) {
+  PatternIndex index;
+  index.Add("news.*");
+  index.Add("news.sport.*");
+  index.Remove("news.sport.*");
+  index.Remove("missing.*");
+  EXPECT_EQ(1, index.size());
+  EXPECT_EQ(std::vector<std::string>({"news.*"}), MatchAll(index, "news.sport.1"));
+  index.Remove("news.*");
+  EXPECT_EQ(0, index.size());
+  EXPECT_TRUE(MatchAll(index, "news.sport.1").empty());
+}
+
+TEST(PubSubThreadTest, PublishToChannelsAndPatterns) {
+  g_network_statistic = std::make_unique<NetworkStatistic>();
+  PubSubThread pubsub;
+  ASSERT_EQ(0, pubsub.StartThread());
+
+  constexpr int kSubscribers = 3;
+  int fds[kSubscribers][2];
+  std::vector<std::shared_ptr<NetConn>> conns;
+  for (int i = 0; i < kSubscribers; i++) {
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds[i]));
+    auto conn = std::make_shared<SubscriberConn>(fds[i][0], "sub" + std::to_string(i));
+    conn->SetNonblock();
+    conns.push_back(conn);
+  }
+  std::vector<std::pair<std::string, int>> result;
+  pubsub.Subscribe(conns[0], {"news"}, false, &result);
+  pubsub.Subscribe(conns[1], {"news", "weather"}, false, &result);
+  pubsub.Subscribe(conns[2], {"ne*"}, true, &result);
+  for (const auto& conn : conns) {
+    pubsub.UpdateConnReadyState(conn->fd(), PubSubThread::ReadyState::kReady);
+  }
+
+  EXPECT_EQ(3, pubsub.Publish("news", "hello"));
+  EXPECT_EQ(1, pubsub.Publish("weather", "sunny"));
+  EXPECT_EQ(1, pubsub.Publish("netflix", "movie"));
+  EXPECT_EQ(0, pubsub.Publish("sport", "goal"));
+
+  std::string expected = Message("news", "hello");
+  EXPECT_EQ(expected, ReadFor(fds[0][1], expected.size()));
+  expected = Message("news", "hello") + Message("weather", "sunny");
+  EXPECT_EQ(expected, ReadFor(fds[1][1], expected.size()));
+  expected = PMessage("ne*", "news", "hello") + PMessage("ne*", "netflix", "movie");
+  EXPECT_EQ(expected, ReadFor(fds[2][1], expected.size()));
+
+  result.clear();
+  pubsub.UnSubscribe(conns[2], {"ne*"}, true, &result);
+  EXPECT_EQ(0, pubsub.PubSubNumPat());
+  EXPECT_EQ(2, pubsub.Publish("news", "again"));
+
+  pubsub.StopThread();
+  for (auto& fd : fds) {
+    close(fd[0]);
+    close(fd[1]);
+  }
+}
+
+TEST(PubSubThreadTest, ManyPublishesKeepOrder) {
+  g_network_statistic = std::make_unique<NetworkStatistic>();
+  PubSubThread pubsub;
+  ASSERT_EQ(0, pubsub.StartThread());
+
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  auto conn = std::make_shared<SubscriberConn>(fds[0], "sub");
+  conn->SetNonblock();
+  std::vector<std::pair<std::string, int>> result;
+  pubsub.Subscribe(conn, {"seq"}, false, &result);
+  pubsub.UpdateConnReadyState(conn->fd(), PubSubThread::ReadyState::kReady);
+
+  // More than a socket buffer, part of it waits in the subscriber queue
+  std::string expected;
+  for (int i = 0; i < 20000; i++) {
+    std::string msg = "message-" + std::to_string(i);
+    EXPECT_EQ(1, pubsub.Publish("seq", msg));
+    expected.append(Message("seq", msg));
+  }
+  EXPECT_EQ(expected, ReadFor(fds[1], expected.size()));
+
+  pubsub.StopThread();
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST(PubSubThreadTest, PublishBlocksOnFullQueue) {
+  g_network_statistic = std::make_unique<NetworkStatistic>();
+  PubSubThread pubsub;
+
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  auto conn = std::make_shared<SubscriberConn>(fds[0], "sub");
+  conn->SetNonblock();
+  std::vector<std::pair<std::string, int>> result;
+  pubsub.Subscribe(conn, {"full"}, false, &result);
+  pubsub.UpdateConnReadyState(conn->fd(), PubSubThread::ReadyState::kReady);
+
+  // Nothing is delivered before the thread starts, the publisher stops at the limit
+  constexpr size_t kMessages = PubSubThread::kMaxPendingPublish + 100;
+  std::atomic<size_t> published{0};
+  std::thread publisher([&] {
+    for (size_t i = 0; i < kMessages; i++) {
+      pubsub.Publish("full", "m");
+      published++;
+    }
+  });
+  while (published.load() < PubSubThread::kMaxPendingPublish) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(PubSubThread::kMaxPendingPublish, published.load());
+
+  ASSERT_EQ(0, pubsub.StartThread());
+  std::string expected;
+  for (size_t i = 0; i < kMessages; i++) {
+    expected.append(Message("full", "m"));
+  }
+  EXPECT_EQ(expected, ReadFor(fds[1], expected.size()));
+  publisher.join();
+  EXPECT_EQ(kMessages, published.load());
+
+  pubsub.StopThread();
+  close(fds[0]);
+  close(fds[1]);
+}
@@ -0,0 +1,200 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "net/include/thread_pool.h"
+#include "net/include/work_stealing_pool.h"
+
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct Counter {
+  std::atomic<int> done{0};
+};
+
+void Count(void* arg) { static_cast<Counter*>(arg)->done.fetch_add(1); }
+
+struct Gate {
+  std::atomic<bool> open{false};
+  std::atomic<bool> entered{false};
+};
+
+void Block(void* arg) {
+  auto gate = static_cast<Gate*>(arg);
+  gate->entered.store(true);
+  while (!gate->open.load()) {
+    usleep(100);
+  }
+}
+
+template <typename Pred>
+bool WaitFor(Pred pred, int timeout_ms = 5000) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  while (!pred()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    usleep(100);
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(ThreadPoolTest, RunAllTasks) {
+  net::ThreadPool pool(4, 1000);
+  ASSERT_EQ(net::kSuccess, pool.start_thread_pool());
+  Counter counter;
+  for (int i = 0; i < 10000; i++) {
+    pool.Schedule(&Count, &counter);
+  }
+  EXPECT_TRUE(WaitFor([&] { return counter.done.load() == 10000; }));
+  pool.stop_thread_pool();
+}
+
+TEST(TaskQueueTest, BoundedFifo) {
+  net::TaskQueue queue(3);
+  int args[4];
+  for (auto& arg : args) {
+    EXPECT_TRUE(queue.Push(net::Task(&Count, &arg)));
+  }
+  // Rounded up to 4
+  EXPECT_FALSE(queue.Push(net::Task(&Count, nullptr)));
+  EXPECT_EQ(4, queue.Size());
+
+  net::Task task;
+  for (auto& arg : args) {
+    ASSERT_TRUE(queue.Pop(&task));
+    EXPECT_EQ(&arg, task.arg);
+  }
+  EXPECT_FALSE(queue.Pop(&task));
+  EXPECT_EQ(0, queue.Size());
+}
+
+TEST(TaskQueueTest, ConcurrentPushPop) {
+  net::TaskQueue queue(64);
+  constexpr int kProducers = 4;
+  constexpr int kTasks = 100000;
+  std::atomic<int64_t> sum{0};
+  std::atomic<int> popped{0};
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < kProducers; p++) {
+    threads.emplace_back([&] {
+      for (intptr_t i = 1; i <= kTasks; i++) {
+        while (!queue.Push(net::Task(&Count, reinterpret_cast<void*>(i)))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (int c = 0; c < kProducers; c++) {
+    threads.emplace_back([&] {
+      net::Task task;
+      while (popped.load() < kProducers * kTasks) {
+        if (queue.Pop(&task)) {
+          sum.fetch_add(reinterpret_cast<intptr_t>(task.arg));
+          popped.fetch_add(1);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(static_cast<int64_t>(kProducers) * kTasks * (kTasks + 1) / 2, sum.load());
+}
+
+TEST(WorkStealingPoolTest, RunAllTasks) {
+  net::WorkStealingPool pool(4, 1000);
+  ASSERT_EQ(net::kSuccess, pool.start_thread_pool());
+  Counter counter;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < 4; p++) {
+    producers.emplace_back([&pool, &counter, p] {
+      for (int i = 0; i < 10000; i++) {
+        pool.Schedule(&Count, &counter, p * 10000 + i);
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_TRUE(WaitFor([&] { return counter.done.load() == 40000; }));
+  size_t qsize = 0;
+  pool.cur_queue_size(&qsize);
+  EXPECT_EQ(0, qsize);
+  pool.stop_thread_pool();
+}
+
+TEST(WorkStealingPoolTest, SameAffinitySameQueue) {
+  net::WorkStealingPool pool(4, 1000);
+  // Not started, so the tasks stay where they were queued
+  Counter counter;
+  for (int i = 0; i < 10; i++) {
+    pool.Schedule(&Count, &counter, 6);
+  }
+  EXPECT_EQ(std::vector<size_t>({0, 0, 10, 0}), pool.queue_depths());
+
+  ASSERT_EQ(net::kSuccess, pool.start_thread_pool());
+  EXPECT_TRUE(WaitFor([&] { return counter.done.load() == 10; }));
+  pool.stop_thread_pool();
+}
+
+TEST(WorkStealingPoolTest, IdleWorkersSteal) {
+  net::WorkStealingPool pool(4, 1000);
+  ASSERT_EQ(net::kSuccess, pool.start_thread_pool());
+
+  // Keep the home worker of affinity 0 busy, its queued tasks must be
+  // picked up by the others
+  Gate gate;
+  pool.Schedule(&Block, &gate, 0);
+  ASSERT_TRUE(WaitFor([&] { return gate.entered.load(); }));
+
+  Counter counter;
+  for (int i = 0; i < 100; i++) {
+    pool.Schedule(&Count, &counter, 0);
+  }
+  EXPECT_TRUE(WaitFor([&] { return counter.done.load() == 100; }));
+  EXPECT_GE(pool.steal_count(), 100);
+
+  gate.open.store(true);
+  pool.stop_thread_pool();
+}
+
+TEST(WorkStealingPoolTest, OverflowToOtherQueues) {
+  net::WorkStealingPool pool(2, 4);
+  Counter counter;
+  for (int i = 0; i < 4; i++) {
+    pool.Schedule(&Count, &counter, 0);
+  }
+  EXPECT_EQ(std::vector<size_t>({2, 2}), pool.queue_depths());
+
+  ASSERT_EQ(net::kSuccess, pool.start_thread_pool());
+  EXPECT_TRUE(WaitFor([&] { return counter.done.load() == 4; }));
+  pool.stop_thread_pool();
+}
+
+TEST(WorkStealingPoolTest, StopAndRestart) {
+  net::WorkStealingPool pool(2, 100);
+  ASSERT_EQ(net::kSuccess, pool.start_thread_pool());
+  EXPECT_FALSE(pool.should_stop());
+  EXPECT_EQ(0, pool.stop_thread_pool());
+  EXPECT_TRUE(pool.should_stop());
+
+  ASSERT_EQ(net::kSuccess, pool.start_thread_pool());
+  Counter counter;
+  pool.Schedule(&Count, &counter);
+  EXPECT_TRUE(WaitFor([&] { return counter.done.load() == 1; }));
+  EXPECT_EQ(0, pool.stop_thread_pool());
+}
@@ -16,6 +16,7 @@
 
 #include "include/build_version.h"
 #include "include/pika_cmd_table_manager.h"
+#include "include/pika_repl_compression.h"
 #include "include/pika_rm.h"
 #include "include/pika_server.h"
 #include "include/pika_version.h"
@@ -751,6 +752,7 @@ const std::string InfoCmd::kRocksDBSection = "rocksdb";
 const std::string InfoCmd::kDebugSection = "debug";
 const std::string InfoCmd::kCommandStatsSection = "commandstats";
 const std::string InfoCmd::kCacheSection = "cache";
+const std::string InfoCmd::kLatencyStatsSection = "latencystats";
 
 void InfoCmd::Execute() {
   std::shared_ptr<DB> db = g_pika_server->GetDB(db_name_);
@@ -832,6 +834,8 @@ void InfoCmd::DoInitial() {
     info_section_ = kInfoCommandStats;
   } else if (strcasecmp(argv_[1].data(), kCacheSection.data()) == 0) {
     info_section_ = kInfoCache;
+  } else if (strcasecmp(argv_[1].data(), kLatencyStatsSection.data()) == 0) {
+    info_section_ = kInfoLatencyStats;
   } else {
     info_section_ = kInfoErr;
   }
@@ -871,6 +875,8 @@ void InfoCmd::Do() {
       info.append("\r\n");
       InfoCommandStats(info);
       info.append("\r\n");
+      InfoLatencyStats(info);
+      info.append("\r\n");
       InfoCache(info, db_);
       info.append("\r\n");
       InfoCPU(info);
@@ -917,6 +923,9 @@ void InfoCmd::Do() {
     case kInfoCache:
       InfoCache(info, db_);
       break;
+    case kInfoLatencyStats:
+      InfoLatencyStats(info);
+      break;
     default:
       // kInfoErr is nothing
       break;
@@ -967,6 +976,18 @@ void InfoCmd::InfoClients(std::string& info) {
   info.append(tmp_stream.str());
 }
 
+// One number per worker thread, separated by commas
+static std::string JoinNumbers(const std::vector<uint64_t>& numbers) {
+  std::string result;
+  for (size_t i = 0; i < numbers.size(); i++) {
+    if (i != 0) {
+      result.append(",");
+    }
+    result.append(std::to_string(numbers[i]));
+  }
+  return result;
+}
+
 void InfoCmd::InfoStats(std::string& info) {
   std::stringstream tmp_stream;
   tmp_stream << "# Stats"
@@ -986,6 +1007,9 @@ void InfoCmd::InfoStats(std::string& info) {
   tmp_stream << "instantaneous_output_kbps:" << g_pika_server->InstantaneousOutputKbps() << "\r\n";
   tmp_stream << "instantaneous_input_repl_kbps:" << g_pika_server->InstantaneousInputReplKbps() << "\r\n";
   tmp_stream << "instantaneous_output_repl_kbps:" << g_pika_server->InstantaneousOutputReplKbps() << "\r\n";
+  tmp_stream << "worker_accepted_conns:" << JoinNumbers(g_pika_server->WorkerAcceptedConns()) << "\r\n";
+  tmp_stream << "instantaneous_worker_accepts_per_sec:" << JoinNumbers(g_pika_server->InstantaneousWorkerAccepts())
+             << "\r\n";
 
   tmp_stream << "is_bgsaving:" << (g_pika_server->IsBgSaving() ? "Yes" : "No") << "\r\n";
   tmp_stream << "is_scaning_keyspace:" << (g_pika_server->IsKeyScaning() ? "Yes" : "No") << "\r\n";
@@ -1013,6 +1037,69 @@ void InfoCmd::InfoStats(std::string& info) {
              << (is_migrating ? (current_time_s - start_migration_time) : (end_migration_time - start_migration_time))
              << "\r\n";
   tmp_stream << "slow_logs_count:" << g_pika_server->SlowlogCount() << "\r\n";
+  tmp_stream << "pipeline_write_batches:" << g_pika_server->pipeline_write_batches() << "\r\n";
+  tmp_stream << "pipeline_write_batched_cmds:" << g_pika_server->pipeline_write_batched_cmds() << "\r\n";
+  tmp_stream << "client_pool_queue_size:" << g_pika_server->ClientProcessorThreadPoolCurQueueSize() << "\r\n";
+  tmp_stream << "client_pool_max_worker_queue_size:" << g_pika_server->ClientProcessorThreadPoolMaxWorkerQueueSize()
+             << "\r\n";
+  tmp_stream << "client_pool_steals:" << g_pika_server->ClientProcessorThreadPoolStealCount() << "\r\n";
+
+  // Binlog group commit stats, accumulated over all DBs
+  Binlog::GroupCommitStats gc_stats;
+  BinlogTailCache::Stats tail_stats;
+  {
+    std::shared_lock db_rwl(g_pika_server->dbs_rw_);
+    for (const auto& db_item : g_pika_server->dbs_) {
+      std::shared_ptr<SyncMasterDB> master_db = g_pika_rm->GetSyncMasterDBByName(DBInfo(db_item.first));
+      if (!master_db) {
+        continue;
+      }
+      Binlog::GroupCommitStats stats = master_db->Logger()->group_commit_stats();
+      gc_stats.batches += stats.batches;
+      gc_stats.items += stats.items;
+      gc_stats.wait_us += stats.wait_us;
+      gc_stats.max_batch_size = std::max(gc_stats.max_batch_size, stats.max_batch_size);
+      BinlogTailCache::Stats cache_stats = master_db->Logger()->tail_cache()->stats();
+      tail_stats.hits += cache_stats.hits;
+      tail_stats.misses += cache_stats.misses;
+      tail_stats.served_records += cache_stats.served_records;
+      tail_stats.records += cache_stats.records;
+      tail_stats.bytes += cache_stats.bytes;
+    }
+  }
+  tmp_stream << "binlog_group_commit_batches:" << gc_stats.batches << "\r\n";
+  tmp_stream << "binlog_group_commit_items:" << gc_stats.items << "\r\n";
+  tmp_stream << "binlog_group_commit_avg_batch_size:" << std::setiosflags(std::ios::fixed) << std::setprecision(2)
+             << (gc_stats.batches == 0 ? 0.0 : static_cast<double>(gc_stats.items) / static_cast<double>(gc_stats.batches))
+             << "\r\n";
+  tmp_stream << "binlog_group_commit_max_batch_size:" << gc_stats.max_batch_size << "\r\n";
+  tmp_stream << "binlog_group_commit_avg_wait_us:"
+             << (gc_stats.items == 0 ? 0 : gc_stats.wait_us / gc_stats.items) << "\r\n";
+  tmp_stream << "binlog_tail_cache_records:" << tail_stats.records << "\r\n";
+  tmp_stream << "binlog_tail_cache_bytes:" << tail_stats.bytes << "\r\n";
+  tmp_stream << "binlog_tail_cache_hits:" << tail_stats.hits << "\r\n";
+  tmp_stream << "binlog_tail_cache_misses:" << tail_stats.misses << "\r\n";
+  tmp_stream << "binlog_tail_cache_hit_rate:" << std::setiosflags(std::ios::fixed) << std::setprecision(2)
+             << (tail_stats.hits + tail_stats.misses == 0
+                     ? 0.0
+                     : static_cast<double>(tail_stats.hits) / static_cast<double>(tail_stats.hits + tail_stats.misses))
+             << "\r\n";
+  tmp_stream << "binlog_tail_cache_served_records:" << tail_stats.served_records << "\r\n";
+
+  // Expired keys deleted by the reaper, accumulated over all DBs
+  uint64_t reaped_keys = 0;
+  uint64_t reclaimed_bytes = 0;
+  {
+    std::shared_lock db_rwl(g_pika_server->dbs_rw_);
+    for (const auto& db_item : g_pika_server->dbs_) {
+      db_item.second->DBLockShared();
+      reaped_keys += db_item.second->storage()->GetReapedKeys();
+      reclaimed_bytes += db_item.second->storage()->GetReclaimedBytes();
+      db_item.second->DBUnlockShared();
+    }
+  }
+  tmp_stream << "expired_keys_reaped:" << reaped_keys << "\r\n";
+  tmp_stream << "expired_bytes_reclaimed:" << reclaimed_bytes << "\r\n";
   info.append(tmp_stream.str());
 }
 
@@ -1058,6 +1145,7 @@ void InfoCmd::InfoReplication(std::string& info) {
   std::stringstream tmp_stream;
   std::stringstream out_of_sync;
   std::stringstream repl_connect_status;
+  std::stringstream full_sync_stats;
   bool all_db_sync = true;
   std::shared_lock db_rwl(g_pika_server->dbs_rw_);
   for (const auto& db_item : g_pika_server->GetDB()) {
@@ -1067,6 +1155,11 @@ void InfoCmd::InfoReplication(std::string& info) {
       out_of_sync << "(" << db_item.first << ": InternalError)";
       continue;
     }
+    rsync::RsyncClient::Stats rsync_stats = slave_db->RsyncStats();
+    full_sync_stats << db_item.first << ":reused_files=" << rsync_stats.reused_files
+                    << ",reused_bytes=" << rsync_stats.reused_bytes
+                    << ",transferred_files=" << rsync_stats.transferred_files
+                    << ",transferred_bytes=" << rsync_stats.transferred_bytes << "\r\n";
     repl_connect_status << db_item.first << ":";
     if (slave_db->State() != ReplState::kConnected) {
       all_db_sync = false;
@@ -1128,6 +1221,7 @@ void InfoCmd::InfoReplication(std::string& info) {
                  << (((g_pika_server->repl_state() == PIKA_REPL_META_SYNC_DONE) && all_db_sync) ? "up" : "down")
                  << "\r\n";
       tmp_stream << "repl_connect_status:\r\n"  << repl_connect_status.str();
+      tmp_stream << "full_sync_stats:\r\n" << full_sync_stats.str();
       tmp_stream << "slave_priority:" << g_pika_conf->slave_priority() << "\r\n";
       tmp_stream << "slave_read_only:" << g_pika_conf->slave_read_only() << "\r\n";
       if (!all_db_sync) {
@@ -1141,6 +1235,7 @@ void InfoCmd::InfoReplication(std::string& info) {
                  << (((g_pika_server->repl_state() == PIKA_REPL_META_SYNC_DONE) && all_db_sync) ? "up" : "down")
                  << "\r\n";
       tmp_stream << "repl_connect_status:\r\n"  << repl_connect_status.str();
+      tmp_stream << "full_sync_stats:\r\n" << full_sync_stats.str();
       tmp_stream << "slave_read_only:" << g_pika_conf->slave_read_only() << "\r\n";
       if (!all_db_sync) {
         tmp_stream << "db_repl_state:" << out_of_sync.str() << "\r\n";
@@ -1334,24 +1429,47 @@ void InfoCmd::InfoCommandStats(std::string& info) {
   tmp_stream.precision(2);
   tmp_stream.setf(std::ios::fixed);
   tmp_stream << "# Commandstats" << "\r\n";
-  auto cmdstat_map = g_pika_cmd_table_manager->GetCommandStatMap();
-  for (auto iter : *cmdstat_map) {
-    if (iter.second.cmd_count != 0) {
-      tmp_stream << iter.first << ":"
-                 << "calls=" << iter.second.cmd_count << ", usec="
-                 << MethodofTotalTimeCalculation(iter.second.cmd_time_consuming)
-                 << ", usec_per_call=";
-      if (!iter.second.cmd_time_consuming) {
-        tmp_stream << 0 << "\r\n";
-      } else {
-        tmp_stream << MethodofCommandStatistics(iter.second.cmd_time_consuming, iter.second.cmd_count)
-                   << "\r\n";
-      }
+  std::map<std::string, ::CommandStatistics> cmd_stats = g_pika_server->ServerCmdStats(false);
+  for (const auto& iter : cmd_stats) {
+    tmp_stream << iter.first << ":"
+               << "calls=" << iter.second.cmd_count << ", usec="
+               << MethodofTotalTimeCalculation(iter.second.cmd_time_consuming)
+               << ", usec_per_call=";
+    if (!iter.second.cmd_time_consuming) {
+      tmp_stream << 0 << "\r\n";
+    } else {
+      tmp_stream << MethodofCommandStatistics(iter.second.cmd_time_consuming, iter.second.cmd_count)
+                 << "\r\n";
     }
   }
   info.append(tmp_stream.str());
 }
 
+static void AppendLatencyPercentiles(std::stringstream& stream, const std::string& name,
+                                     const LatencyHistogram& histogram) {
+  stream << name << ":p50=" << histogram.Percentile(50) << ",p99=" << histogram.Percentile(99)
+         << ",p99.9=" << histogram.Percentile(99.9) << "\r\n";
+}
+
+void InfoCmd::InfoLatencyStats(std::string& info) {
+  std::stringstream tmp_stream;
+  tmp_stream << "# Latencystats" << "\r\n";
+  std::map<std::string, ::CommandStatistics> cmd_stats = g_pika_server->ServerCmdStats(true);
+  for (const auto& iter : cmd_stats) {
+    const CmdLatencyStatistic* latency = iter.second.latency.get();
+    if (!latency) {
+      continue;
+    }
+    AppendLatencyPercentiles(tmp_stream, "latency_percentiles_usec_" + iter.first, latency->total_time);
+    AppendLatencyPercentiles(tmp_stream, "queue_time_percentiles_usec_" + iter.first, latency->queue_time);
+    AppendLatencyPercentiles(tmp_stream, "process_time_percentiles_usec_" + iter.first, latency->process_time);
+  }
+  info.append(tmp_stream.str());
+}
+
+// Hot keys listed in INFO cache
+static constexpr size_t kInfoHotKeyNum = 10;
+
 void InfoCmd::InfoCache(std::string& info, std::shared_ptr<DB> db) {
   std::stringstream tmp_stream;
   tmp_stream << "# Cache" << "\r\n";
@@ -1372,6 +1490,22 @@ void InfoCmd::InfoCache(std::string& info, std::shared_ptr<DB> db) {
     tmp_stream << "hitratio_all:" << std::setprecision(4) << cache_info.hitratio_all << "%" << "\r\n";
     tmp_stream << "load_keys_per_sec:" << cache_info.load_keys_per_sec << "\r\n";
     tmp_stream << "waitting_load_keys_num:" << cache_info.waitting_load_keys_num << "\r\n";
+    tmp_stream << "coalesced_misses:" << cache_info.coalesced_misses << "\r\n";
+    tmp_stream << "admission_rejects:" << cache_info.admission_rejects << "\r\n";
+    tmp_stream << "db_loads:" << cache_info.loads << "\r\n";
+    tmp_stream << "db_load_avg_usec:" << (cache_info.loads ? cache_info.load_us / cache_info.loads : 0) << "\r\n";
+    // The most read keys, reads of a key are an upper bound once it replaced another one
+    for (size_t i = 0; i < cache_info.hot_keys.size() && i < kInfoHotKeyNum; i++) {
+      const CacheKeyStat& stat = cache_info.hot_keys[i];
+      tmp_stream << "hotkey_" << i << ":key=" << stat.key << ",reads=" << stat.reads << ",hits=" << stat.hits
+                 << ",misses=" << stat.misses << ",loads=" << stat.loads
+                 << ",load_avg_usec=" << (stat.loads ? stat.load_us / stat.loads : 0) << "\r\n";
+    }
+    for (size_t i = 0; i < cache_info.shards.size(); i++) {
+      const CacheShardInfo& shard = cache_info.shards[i];
+      tmp_stream << "cache_shard_" << i << ":keys=" << shard.keys_num << ",loaded_keys=" << shard.async_load_keys_num
+                 << ",waitting_load_keys=" << shard.waitting_load_keys_num << "\r\n";
+    }
   }
   info.append(tmp_stream.str());
 }
@@ -1491,6 +1625,24 @@ void ConfigCmd::ConfigGet(std::string& ret) {
     EncodeNumber(&config_body, g_pika_conf->thread_pool_size());
   }
 
+  if (pstd::stringmatch(pattern.data(), "work-stealing-pool", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "work-stealing-pool");
+    EncodeString(&config_body, g_pika_conf->work_stealing_pool() ? "yes" : "no");
+  }
+
+  if (pstd::stringmatch(pattern.data(), "io-uring", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "io-uring");
+    EncodeString(&config_body, g_pika_conf->io_uring() ? "yes" : "no");
+  }
+
+  if (pstd::stringmatch(pattern.data(), "reuse-port", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "reuse-port");
+    EncodeString(&config_body, g_pika_conf->reuse_port() ? "yes" : "no");
+  }
+
   if (pstd::stringmatch(pattern.data(), "slow-cmd-thread-pool-size", 1) != 0) {
     elements += 2;
     EncodeString(&config_body, "slow-cmd-thread-pool-size");
@@ -1614,6 +1766,12 @@ void ConfigCmd::ConfigGet(std::string& ret) {
     EncodeString(&config_body, g_pika_conf->slotmigrate() ? "yes" : "no");
   }
 
+  if (pstd::stringmatch(pattern.data(), "slot-key-prefix", 1)) {
+    elements += 2;
+    EncodeString(&config_body, "slot-key-prefix");
+    EncodeString(&config_body, g_pika_conf->slot_key_prefix() ? "yes" : "no");
+  }
+
   if (pstd::stringmatch(pattern.data(), "slow-cmd-pool", 1)) {
     elements += 2;
     EncodeString(&config_body, "slow-cmd-pool");
@@ -1686,6 +1844,18 @@ void ConfigCmd::ConfigGet(std::string& ret) {
     EncodeNumber(&config_body, g_pika_conf->small_compaction_duration_threshold());
   }
 
+  if (pstd::stringmatch(pattern.data(), "zset-rank-index-threshold", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "zset-rank-index-threshold");
+    EncodeNumber(&config_body, g_pika_conf->zset_rank_index_threshold());
+  }
+
+  if (pstd::stringmatch(pattern.data(), "reap-expired-keys-per-sec", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "reap-expired-keys-per-sec");
+    EncodeNumber(&config_body, g_pika_conf->reap_expired_keys_per_sec());
+  }
+
   if (pstd::stringmatch(pattern.data(), "max-background-flushes", 1) != 0) {
     elements += 2;
     EncodeString(&config_body, "max-background-flushes");
@@ -1782,6 +1952,12 @@ void ConfigCmd::ConfigGet(std::string& ret) {
     EncodeString(&config_body, g_pika_conf->slowlog_write_errorlog() ? "yes" : "no");
   }
 
+  if (pstd::stringmatch(pattern.data(), "pipeline-write-batch", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "pipeline-write-batch");
+    EncodeString(&config_body, g_pika_conf->pipeline_write_batch() ? "yes" : "no");
+  }
+
   if (pstd::stringmatch(pattern.data(), "slowlog-log-slower-than", 1) != 0) {
     elements += 2;
     EncodeString(&config_body, "slowlog-log-slower-than");
@@ -1918,6 +2094,42 @@ void ConfigCmd::ConfigGet(std::string& ret) {
     EncodeNumber(&config_body, g_pika_conf->sync_window_size());
   }
 
+  if (pstd::stringmatch(pattern.data(), "binlog-group-commit-max-batch", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "binlog-group-commit-max-batch");
+    EncodeNumber(&config_body, g_pika_conf->binlog_group_commit_max_batch());
+  }
+
+  if (pstd::stringmatch(pattern.data(), "binlog-group-commit-max-delay-us", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "binlog-group-commit-max-delay-us");
+    EncodeNumber(&config_body, g_pika_conf->binlog_group_commit_max_delay_us());
+  }
+
+  if (pstd::stringmatch(pattern.data(), "binlog-tail-cache-size", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "binlog-tail-cache-size");
+    EncodeNumber(&config_body, g_pika_conf->binlog_tail_cache_size());
+  }
+
+  if (pstd::stringmatch(pattern.data(), "repl-compression", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "repl-compression");
+    EncodeString(&config_body, g_pika_conf->repl_compression());
+  }
+
+  if (pstd::stringmatch(pattern.data(), "repl-batch-max-bytes", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "repl-batch-max-bytes");
+    EncodeNumber(&config_body, g_pika_conf->repl_batch_max_bytes());
+  }
+
+  if (pstd::stringmatch(pattern.data(), "repl-batch-max-delay-us", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "repl-batch-max-delay-us");
+    EncodeNumber(&config_body, g_pika_conf->repl_batch_max_delay_us());
+  }
+
   if (pstd::stringmatch(pattern.data(), "max-conn-rbuf-size", 1) != 0) {
     elements += 2;
     EncodeString(&config_body, "max-conn-rbuf-size");
@@ -2079,6 +2291,12 @@ void ConfigCmd::ConfigGet(std::string& ret) {
     EncodeNumber(&config_body, g_pika_conf->max_rsync_parallel_num());
   }
 
+  if (pstd::stringmatch(pattern.data(), "max-rsync-window-size", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "max-rsync-window-size");
+    EncodeNumber(&config_body, g_pika_conf->max_rsync_window_size());
+  }
+
   if (pstd::stringmatch(pattern.data(), "replication-id", 1) != 0) {
     elements += 2;
     EncodeString(&config_body, "replication-id");
@@ -2140,6 +2358,12 @@ void ConfigCmd::ConfigGet(std::string& ret) {
     EncodeNumber(&config_body, g_pika_conf->cache_lfu_decay_time());
   }
 
+  if (pstd::stringmatch(pattern.data(), "cache-admission", 1)) {
+    elements += 2;
+    EncodeString(&config_body, "cache-admission");
+    EncodeString(&config_body, g_pika_conf->cache_admission() ? "yes" : "no");
+  }
+
   if (pstd::stringmatch(pattern.data(), "acl-pubsub-default", 1) != 0) {
     elements += 2;
     EncodeString(&config_body, "acl-pubsub-default");
@@ -2173,12 +2397,15 @@ void ConfigCmd::ConfigSet(std::shared_ptr<DB> db) {
         "expire-logs-nums",
         "root-connection-num",
         "slowlog-write-errorlog",
+        "pipeline-write-batch",
         "slowlog-log-slower-than",
         "slowlog-max-len",
         "write-binlog",
         "max-cache-statistic-keys",
         "small-compaction-threshold",
         "small-compaction-duration-threshold",
+        "zset-rank-index-threshold",
+        "reap-expired-keys-per-sec",
         "max-client-response-size",
         "db-sync-speed",
         "compact-cron",
@@ -2186,6 +2413,12 @@ void ConfigCmd::ConfigSet(std::shared_ptr<DB> db) {
         "disable_auto_compactions",
         "slave-priority",
         "sync-window-size",
+        "binlog-group-commit-max-batch",
+        "binlog-group-commit-max-delay-us",
+        "binlog-tail-cache-size",
+        "repl-compression",
+        "repl-batch-max-bytes",
+        "repl-batch-max-delay-us",
         "slow-cmd-list",
         // Options for storage engine
         // MutableDBOptions
@@ -2203,11 +2436,13 @@ void ConfigCmd::ConfigSet(std::shared_ptr<DB> db) {
         "arena-block-size",
         "throttle-bytes-per-second",
         "max-rsync-parallel-num",
+        "max-rsync-window-size",
         "cache-model",
         "cache-type",
         "zset-cache-start-direction",
         "zset-cache-field-num-per-key",
         "cache-lfu-decay-time",
+        "cache-admission",
         "max-conn-rbuf-size",
     });
     res_.AppendStringVector(replyVt);
@@ -2309,6 +2544,18 @@ void ConfigCmd::ConfigSet(std::shared_ptr<DB> db) {
     }
     g_pika_conf->SetSlowlogWriteErrorlog(is_write_errorlog);
     res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "pipeline-write-batch") {
+    bool pipeline_write_batch;
+    if (value == "yes") {
+      pipeline_write_batch = true;
+    } else if (value == "no") {
+      pipeline_write_batch = false;
+    } else {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'pipeline-write-batch'\r\n");
+      return;
+    }
+    g_pika_conf->SetPipelineWriteBatch(pipeline_write_batch);
+    res_.AppendStringRaw("+OK\r\n");
   } else if (set_item == "slotmigrate") {
     bool slotmigrate;
     if (value == "yes") {
@@ -2373,6 +2620,21 @@ void ConfigCmd::ConfigSet(std::shared_ptr<DB> db) {
     g_pika_conf->SetSmallCompactionDurationThreshold(static_cast<int>(ival));
     g_pika_server->DBSetSmallCompactionDurationThreshold(static_cast<int>(ival));
     res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "zset-rank-index-threshold") {
+    if ((pstd::string2int(value.data(), value.size(), &ival) == 0) || ival < 0) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'zset-rank-index-threshold'\r\n");
+      return;
+    }
+    g_pika_conf->SetZSetRankIndexThreshold(static_cast<int>(ival));
+    g_pika_server->DBSetZSetRankIndexThreshold(static_cast<int>(ival));
+    res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "reap-expired-keys-per-sec") {
+    if ((pstd::string2int(value.data(), value.size(), &ival) == 0) || ival < 0) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'reap-expired-keys-per-sec'\r\n");
+      return;
+    }
+    g_pika_conf->SetReapExpiredKeysPerSec(static_cast<int>(ival));
+    res_.AppendStringRaw("+OK\r\n");
   } else if (set_item == "disable_auto_compactions") {
     if (value != "true" && value != "false") {
       res_.AppendStringRaw("-ERR invalid disable_auto_compactions (true or false)\r\n");
@@ -2525,6 +2787,65 @@ void ConfigCmd::ConfigSet(std::shared_ptr<DB> db) {
     }
     g_pika_conf->SetSyncWindowSize(static_cast<int>(ival));
     res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "binlog-group-commit-max-batch") {
+    if (pstd::string2int(value.data(), value.size(), &ival) == 0) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'binlog-group-commit-max-batch'\r\n");
+      return;
+    }
+    if (ival <= 0 || ival > kBinlogGroupCommitMaxBatch) {
+      res_.AppendStringRaw("-ERR Argument exceed range \'" + value + "\' for CONFIG SET 'binlog-group-commit-max-batch'\r\n");
+      return;
+    }
+    g_pika_conf->SetBinlogGroupCommitMaxBatch(static_cast<int>(ival));
+    res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "binlog-group-commit-max-delay-us") {
+    if (pstd::string2int(value.data(), value.size(), &ival) == 0) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'binlog-group-commit-max-delay-us'\r\n");
+      return;
+    }
+    if (ival < 0 || ival > kBinlogGroupCommitMaxDelayUs) {
+      res_.AppendStringRaw("-ERR Argument exceed range \'" + value + "\' for CONFIG SET 'binlog-group-commit-max-delay-us'\r\n");
+      return;
+    }
+    g_pika_conf->SetBinlogGroupCommitMaxDelayUs(ival);
+    res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "binlog-tail-cache-size") {
+    if ((pstd::string2int(value.data(), value.size(), &ival) == 0) || ival < 0) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'binlog-tail-cache-size'\r\n");
+      return;
+    }
+    g_pika_conf->SetBinlogTailCacheSize(ival);
+    res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "repl-compression") {
+    InnerMessage::CompressionType compression;
+    if (!ReplCompressionFromName(value, &compression)) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'repl-compression'\r\n");
+      return;
+    }
+    g_pika_conf->SetReplCompression(value);
+    res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "repl-batch-max-bytes") {
+    if ((pstd::string2int(value.data(), value.size(), &ival) == 0) || ival <= 0) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'repl-batch-max-bytes'\r\n");
+      return;
+    }
+    if (ival > PIKA_MAX_CONN_RBUF_HB) {
+      res_.AppendStringRaw("-ERR Argument exceed range \'" + value + "\' for CONFIG SET 'repl-batch-max-bytes'\r\n");
+      return;
+    }
+    g_pika_conf->SetReplBatchMaxBytes(ival);
+    res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "repl-batch-max-delay-us") {
+    if (pstd::string2int(value.data(), value.size(), &ival) == 0) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'repl-batch-max-delay-us'\r\n");
+      return;
+    }
+    if (ival < 0 || ival > kReplBatchMaxDelayUs) {
+      res_.AppendStringRaw("-ERR Argument exceed range \'" + value + "\' for CONFIG SET 'repl-batch-max-delay-us'\r\n");
+      return;
+    }
+    g_pika_conf->SetReplBatchMaxDelayUs(ival);
+    res_.AppendStringRaw("+OK\r\n");
   } else if (set_item == "slow-cmd-list") {
     g_pika_conf->SetSlowCmd(value);
     res_.AppendStringRaw("+OK\r\n");
@@ -2727,6 +3048,13 @@ void ConfigCmd::ConfigSet(std::shared_ptr<DB> db) {
     }
     g_pika_conf->SetMaxRsyncParallelNum(static_cast<int>(ival));
     res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "max-rsync-window-size") {
+    if ((pstd::string2int(value.data(), value.size(), &ival) == 0) || ival > kMaxRsyncWindowSize || ival <= 0) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'max-rsync-window-size'\r\n");
+      return;
+    }
+    g_pika_conf->SetMaxRsyncWindowSize(static_cast<int>(ival));
+    res_.AppendStringRaw("+OK\r\n");
   } else if (set_item == "cache-num") {
     if (!pstd::string2int(value.data(), value.size(), &ival) || ival < 0) {
       res_.AppendStringRaw("-ERR Invalid argument " + value + " for CONFIG SET 'cache-num'\r\n");
@@ -2827,6 +3155,18 @@ void ConfigCmd::ConfigSet(std::shared_ptr<DB> db) {
     g_pika_conf->SetCacheLFUDecayTime(cache_lfu_decay_time);
     g_pika_server->ResetCacheConfig(db);
     res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "cache-admission") {
+    bool cache_admission;
+    if (value == "yes") {
+      cache_admission = true;
+    } else if (value == "no") {
+      cache_admission = false;
+    } else {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'cache-admission'\r\n");
+      return;
+    }
+    g_pika_conf->SetCacheAdmission(cache_admission);
+    res_.AppendStringRaw("+OK\r\n");
   } else if (set_item == "acl-pubsub-default") {
     std::string v(value);
     pstd::StringToLower(v);
@@ -2911,8 +3251,9 @@ void DbsizeCmd::Do() {
       int64_t dbsize = 0;
       for (int i = 0; i < g_pika_conf->default_slot_num(); ++i){
         int32_t card = 0;
-        rocksdb::Status s = dbs->storage()->SCard(SlotKeyPrefix+std::to_string(i), &card);
-        if (s.ok() && card >= 0) {
+        rocksdb::Status s = GetSlotKeyNum(static_cast<uint32_t>(i), &card, dbs);
+        // an empty slot is NotFound in the slot prefix key layout
+        if ((s.ok() || (s.IsNotFound() && g_pika_conf->slot_key_prefix())) && card >= 0) {
           dbsize += card;
         } else {
           res_.SetRes(CmdRes::kErrOther, "Get dbsize error");
@@ -41,9 +41,14 @@ void* PikaAuxiliaryThread::ThreadMain() {
     // send to peer
     int res = g_pika_server->SendToPeer();
     if (res == 0) {
-      // sleep 100 ms
+      // sleep 100 ms, or until a write queue held back to fill up its frame is due
+      std::chrono::microseconds wait = 100ms;
+      uint64_t due_us = g_pika_rm->WriteQueueDueUs();
+      if (due_us != 0) {
+        wait = std::min(wait, std::chrono::microseconds(due_us));
+      }
       std::unique_lock lock(mu_);
-      cv_.wait_for(lock, 100ms);
+      cv_.wait_for(lock, wait);
     } else {
       // LOG_EVERY_N(INFO, 1000) << "Consume binlog number " << res;
     }
@@ -9,14 +9,17 @@
 #include <glog/logging.h>
 #include <sys/time.h>
 
+#include <algorithm>
 #include <utility>
 
 #include "include/pika_binlog_transverter.h"
-#include "pstd/include/pstd_defer.h"
+#include "include/pika_conf.h"
 #include "pstd_status.h"
 
 using pstd::Status;
 
+extern std::unique_ptr<PikaConf> g_pika_conf;
+
 std::string NewFileName(const std::string& name, const uint32_t current) {
   char buf[256];
   snprintf(buf, sizeof(buf), "%s%u", name.c_str(), current);
@@ -164,38 +167,156 @@ Status Binlog::GetProducerStatus(uint32_t* filenum, uint64_t* pro_offset, uint32
   return Status::OK();
 }
 
-// Note: mutex lock should be held
-Status Binlog::Put(const std::string& item) {
+// g_pika_conf is not set up when the binlog is used on its own, as in its tests
+int Binlog::GroupCommitMaxBatch() {
+  return g_pika_conf ? g_pika_conf->binlog_group_commit_max_batch() : kBinlogGroupCommitDefaultBatch;
+}
+
+int64_t Binlog::GroupCommitMaxDelayUs() { return g_pika_conf ? g_pika_conf->binlog_group_commit_max_delay_us() : 0; }
+
+int64_t Binlog::TailCacheSize() { return g_pika_conf ? g_pika_conf->binlog_tail_cache_size() : 0; }
+
+Status Binlog::Put(const std::string& item) { return Append(&item, 1); }
+
+Status Binlog::Put(const std::vector<std::string>& items) {
+  if (items.empty()) {
+    return Status::OK();
+  }
+  return Append(items.data(), items.size());
+}
+
+Status Binlog::Append(const std::string* items, size_t num) {
   if (!opened_.load()) {
     return Status::Busy("Binlog is not open yet");
   }
+  const size_t max_batch = static_cast<size_t>(std::max(GroupCommitMaxBatch(), 1));
+  const int64_t max_delay_us = GroupCommitMaxDelayUs();
+  const uint64_t start_us = pstd::NowMicros();
+
+  Writer w(items, num);
+  std::unique_lock lk(writers_mutex_);
+  writers_.push_back(&w);
+  if (writers_.size() >= max_batch) {
+    // The leader may be waiting for the batch to fill up
+    writers_.front()->cv.notify_one();
+  }
+  w.cv.wait(lk, [&] { return w.done || writers_.front() == &w; });
+  if (w.done) {
+    gc_wait_us_.fetch_add(pstd::NowMicros() - start_us, std::memory_order_relaxed);
+    return w.status;
+  }
+
+  // We are the leader now, give the followers a chance to join the batch
+  if (max_delay_us > 0 && writers_.size() < max_batch) {
+    w.cv.wait_for(lk, std::chrono::microseconds(max_delay_us), [&] { return writers_.size() >= max_batch; });
+  }
+  const size_t batch_size = std::min(writers_.size(), max_batch);
+  std::vector<Writer*> batch(writers_.begin(), writers_.begin() + static_cast<int64_t>(batch_size));
+  lk.unlock();
+
+  // New writers keep queueing behind this batch while it is being written
+  size_t written = 0;
+  Status s;
+  {
+    std::lock_guard l(mutex_);
+    s = WriteBatch(batch, &written);
+  }
+  if (!s.ok()) {
+    binlog_io_error_.store(true);
+  }
+
+  // The followers' writers are gone once they are told they are done
+  size_t batch_items = 0;
+  for (const auto* writer : batch) {
+    batch_items += writer->num;
+  }
+
+  lk.lock();
+  for (size_t i = 0; i < batch_size; i++) {
+    writers_.pop_front();
+  }
+  for (size_t i = 1; i < batch_size; i++) {
+    batch[i]->status = i < written ? Status::OK() : s;
+    batch[i]->done = true;
+    batch[i]->cv.notify_one();
+  }
+  if (!writers_.empty()) {
+    writers_.front()->cv.notify_one();
+  }
+  lk.unlock();
+
+  gc_batches_.fetch_add(1, std::memory_order_relaxed);
+  gc_items_.fetch_add(batch_items, std::memory_order_relaxed);
+  uint64_t max_size = gc_max_batch_size_.load(std::memory_order_relaxed);
+  while (batch_size > max_size && !gc_max_batch_size_.compare_exchange_weak(max_size, batch_size)) {
+  }
+  gc_wait_us_.fetch_add(pstd::NowMicros() - start_us, std::memory_order_relaxed);
+  return written > 0 ? Status::OK() : s;
+}
+
+// Note: mutex lock should be held
+Status Binlog::WriteBatch(const std::vector<Writer*>& batch, size_t* written) {
   uint32_t filenum = 0;
   uint32_t term = 0;
   uint64_t offset = 0;
   uint64_t logic_id = 0;
-
-  Lock();
-  DEFER {
-    Unlock();
-  };
+  *written = 0;
 
   Status s = GetProducerStatus(&filenum, &offset, &term, &logic_id);
   if (!s.ok()) {
     return s;
   }
-  logic_id++;
-  std::string data = PikaBinlogTransverter::BinlogEncode(BinlogType::TypeFirst,
-      time(nullptr), term, logic_id, filenum, offset, item, {});
+  const auto now = static_cast<uint32_t>(time(nullptr));
+  const bool cache_tail = TailCacheSize() > 0;
+  std::vector<BinlogTailCache::Record> records;
+  bool appended = false;
+  for (const auto* w : batch) {
+    for (size_t i = 0; i < w->num; i++) {
+      std::string data = PikaBinlogTransverter::BinlogEncode(BinlogType::TypeFirst,
+          now, term, logic_id + 1, pro_num_, offset, w->items[i], {});
+      BinlogOffset prev_offset(pro_num_, offset);
+      s = Put(data.c_str(), static_cast<int>(data.size()), &offset, logic_id + 1);
+      if (!s.ok()) {
+        break;
+      }
+      logic_id++;
+      appended = true;
+      if (cache_tail) {
+        LogOffset record_offset(BinlogOffset(pro_num_, offset), LogicOffset(term, logic_id));
+        records.push_back({prev_offset, record_offset, std::move(data)});
+      }
+    }
+    if (!s.ok()) {
+      break;
+    }
+    (*written)++;
+  }
 
-  s = Put(data.c_str(), static_cast<int>(data.size()));
-  if (!s.ok()) {
-    binlog_io_error_.store(true);
+  // Publish the producer status once for the whole batch
+  if (appended) {
+    std::lock_guard l(version_->rwlock_);
+    version_->pro_offset_ = offset;
+    version_->logic_id_ = logic_id;
+    version_->StableSave();
   }
+  CacheTail(&records);
   return s;
 }
 
 // Note: mutex lock should be held
-Status Binlog::Put(const char* item, int len) {
+void Binlog::CacheTail(std::vector<BinlogTailCache::Record>* records) {
+  const int64_t capacity = TailCacheSize();
+  if (capacity <= 0) {
+    tail_cache_.Clear();
+    return;
+  }
+  if (!records->empty()) {
+    tail_cache_.Append(records, static_cast<uint64_t>(capacity));
+  }
+}
+
+// Note: mutex lock should be held
+Status Binlog::Put(const char* item, int len, uint64_t* pro_offset, uint64_t logic_id) {
   Status s;
 
   /* Check to roll log file */
@@ -211,29 +332,23 @@ Status Binlog::Put(const char* item, int len) {
     queue_.reset();
     queue_ = std::move(queue);
     pro_num_++;
+    *pro_offset = 0;
 
     {
       std::lock_guard l(version_->rwlock_);
       version_->pro_offset_ = 0;
       version_->pro_num_ = pro_num_;
+      // Items before this one in the batch are already in the previous file
+      version_->logic_id_ = logic_id - 1;
       version_->StableSave();
     }
     InitLogFile();
   }
 
-  int pro_offset;
-  s = Produce(pstd::Slice(item, len), &pro_offset);
-  if (s.ok()) {
-    std::lock_guard l(version_->rwlock_);
-    version_->pro_offset_ = pro_offset;
-    version_->logic_id_++;
-    version_->StableSave();
-  }
-
-  return s;
+  return Produce(pstd::Slice(item, len), pro_offset);
 }
 
-Status Binlog::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n, int* temp_pro_offset) {
+Status Binlog::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n, uint64_t* temp_pro_offset) {
   Status s;
   assert(n <= 0xffffff);
   assert(block_offset_ + kHeaderSize + n <= kBlockSize);
@@ -262,17 +377,16 @@ Status Binlog::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n, int*
   }
   block_offset_ += static_cast<int32_t>(kHeaderSize + n);
 
-  *temp_pro_offset += static_cast<int32_t>(kHeaderSize + n);
+  *temp_pro_offset += kHeaderSize + n;
   return s;
 }
 
-Status Binlog::Produce(const pstd::Slice& item, int* temp_pro_offset) {
+Status Binlog::Produce(const pstd::Slice& item, uint64_t* temp_pro_offset) {
   Status s;
   const char* ptr = item.data();
   size_t left = item.size();
   bool begin = true;
 
-  *temp_pro_offset = static_cast<int>(version_->pro_offset_);
   do {
     const int leftover = static_cast<int>(kBlockSize) - block_offset_;
     assert(leftover >= 0);
@@ -384,6 +498,7 @@ Status Binlog::SetProducerStatus(uint32_t pro_num, uint64_t pro_offset, uint32_t
   Binlog::AppendPadding(queue_.get(), &pro_offset);
 
   pro_num_ = pro_num;
+  tail_cache_.Clear();
 
   {
     std::lock_guard l(version_->rwlock_);
@@ -411,6 +526,7 @@ Status Binlog::Truncate(uint32_t pro_num, uint64_t pro_offset, uint64_t index) {
   close(fd);
 
   pro_num_ = pro_num;
+  tail_cache_.Clear();
   {
     std::lock_guard l(version_->rwlock_);
     version_->pro_num_ = pro_num;
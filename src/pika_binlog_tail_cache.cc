@@ -0,0 +1,77 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "include/pika_binlog_tail_cache.h"
+
+#include <algorithm>
+#include <mutex>
+
+void BinlogTailCache::Append(std::vector<Record>* records, uint64_t capacity) {
+  std::lock_guard l(rwlock_);
+  if (capacity == 0) {
+    records_.clear();
+    bytes_ = 0;
+    return;
+  }
+  for (auto& record : *records) {
+    // A gap between the cached records and the new ones, drop the old ones
+    if (!records_.empty() && records_.back().offset.b_offset != record.prev_offset) {
+      records_.clear();
+      bytes_ = 0;
+    }
+    bytes_ += record.binlog.size();
+    records_.push_back(std::move(record));
+  }
+  Trim(capacity);
+}
+
+void BinlogTailCache::Clear() {
+  std::lock_guard l(rwlock_);
+  records_.clear();
+  bytes_ = 0;
+}
+
+void BinlogTailCache::Trim(uint64_t capacity) {
+  while (bytes_ > capacity && !records_.empty()) {
+    bytes_ -= records_.front().binlog.size();
+    records_.pop_front();
+  }
+}
+
+bool BinlogTailCache::Read(const BinlogOffset& offset, size_t max_num, size_t max_bytes,
+                           std::vector<Record>* records) {
+  std::shared_lock l(rwlock_);
+  if (!records_.empty() && records_.back().offset.b_offset == offset) {
+    return true;
+  }
+  auto iter = std::lower_bound(records_.begin(), records_.end(), offset,
+                               [](const Record& record, const BinlogOffset& target) {
+                                 return record.prev_offset < target;
+                               });
+  if (iter == records_.end() || iter->prev_offset != offset) {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  size_t bytes = 0;
+  size_t num = 0;
+  for (; iter != records_.end() && num < max_num && bytes <= max_bytes; ++iter, ++num) {
+    bytes += iter->binlog.size();
+    records->push_back(*iter);
+  }
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  served_records_.fetch_add(num, std::memory_order_relaxed);
+  return true;
+}
+
+BinlogTailCache::Stats BinlogTailCache::stats() {
+  Stats stats;
+  stats.hits = hits_.load(std::memory_order_relaxed);
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  stats.served_records = served_records_.load(std::memory_order_relaxed);
+  std::shared_lock l(rwlock_);
+  stats.records = records_.size();
+  stats.bytes = bytes_;
+  return stats;
+}
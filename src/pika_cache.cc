@@ -4,6 +4,7 @@
 // of patent rights can be found in the PATENTS file in the same directory.
 
 #include <glog/logging.h>
+#include <algorithm>
 #include <ctime>
 #include <unordered_set>
 #include <thread>
@@ -25,10 +26,7 @@ PikaCache::PikaCache(int zset_cache_start_direction, int zset_cache_field_num_pe
     : cache_status_(PIKA_CACHE_STATUS_NONE),
       cache_num_(0),
       zset_cache_start_direction_(zset_cache_start_direction),
-      zset_cache_field_num_per_key_(EXTEND_CACHE_SIZE(zset_cache_field_num_per_key)) {
-  cache_load_thread_ = std::make_unique<PikaCacheLoadThread> (zset_cache_start_direction_, zset_cache_field_num_per_key_);
-  cache_load_thread_->StartThread();
-}
+      zset_cache_field_num_per_key_(EXTEND_CACHE_SIZE(zset_cache_field_num_per_key)) {}
 
 PikaCache::~PikaCache() {
   {
@@ -46,14 +44,6 @@ Status PikaCache::Init(uint32_t cache_num, cache::CacheConfig *cache_cfg) {
   return InitWithoutLock(cache_num, cache_cfg);
 }
 
-void PikaCache::ProcessCronTask(void) {
-  std::lock_guard l(rwlock_);
-  for (uint32_t i = 0; i < caches_.size(); ++i) {
-    std::unique_lock lm(*cache_mutexs_[i]);
-    caches_[i]->ActiveExpireCycle();
-  }
-}
-
 Status PikaCache::Reset(uint32_t cache_num, cache::CacheConfig *cache_cfg) {
   std::lock_guard l(rwlock_);
 
@@ -67,6 +57,11 @@ void PikaCache::ResetConfig(cache::CacheConfig *cache_cfg) {
   zset_cache_field_num_per_key_ = EXTEND_CACHE_SIZE(cache_cfg->zset_cache_field_num_per_key);
   LOG(WARNING) << "zset-cache-start-direction: " << zset_cache_start_direction_ << ", zset_cache_field_num_per_key: " << zset_cache_field_num_per_key_;
   cache::RedisCache::SetConfig(cache_cfg);
+  // Follows cache-maxmemory, the frequencies start over
+  if (size_t capacity = AdmissionSketchCapacity();
+      admission_sketch_->capacity() < capacity || admission_sketch_->capacity() >= capacity * 2) {
+    admission_sketch_ = std::make_unique<pstd::FrequencySketch>(capacity);
+  }
 }
 
 void PikaCache::Destroy(void) {
@@ -87,15 +82,148 @@ void PikaCache::Info(CacheInfo &info) {
   info.status = cache_status_;
   info.cache_num = cache_num_;
   info.used_memory = cache::RedisCache::GetUsedMemory();
-  info.async_load_keys_num = cache_load_thread_->AsyncLoadKeysNum();
-  info.waitting_load_keys_num = cache_load_thread_->WaittingLoadKeysNum();
   cache::RedisCache::GetHitAndMissNum(&info.hits, &info.misses);
+  info.coalesced_misses = coalesced_misses_.load();
+  info.admission_rejects = admission_rejects_.load();
+  info.loads = loads_num_.load();
+  info.load_us = load_us_.load();
+  for (auto& stripe : hot_keys_) {
+    std::lock_guard lh(stripe.mu);
+    info.hot_keys.insert(info.hot_keys.end(), stripe.keys.begin(), stripe.keys.end());
+  }
+  std::sort(info.hot_keys.begin(), info.hot_keys.end(),
+            [](const CacheKeyStat& a, const CacheKeyStat& b) { return a.reads > b.reads; });
+  if (info.hot_keys.size() > kHotKeyNum) {
+    info.hot_keys.resize(kHotKeyNum);
+  }
+  info.shards.resize(caches_.size());
   for (uint32_t i = 0; i < caches_.size(); ++i) {
-    std::lock_guard lm(*cache_mutexs_[i]);
-    info.keys_num += caches_[i]->DbSize();
+    CacheShardInfo& shard = info.shards[i];
+    {
+      std::lock_guard lm(*cache_mutexs_[i]);
+      shard.keys_num = caches_[i]->DbSize();
+    }
+    shard.async_load_keys_num = cache_load_threads_[i]->AsyncLoadKeysNum();
+    shard.waitting_load_keys_num = cache_load_threads_[i]->WaittingLoadKeysNum();
+    info.keys_num += shard.keys_num;
+    info.async_load_keys_num += shard.async_load_keys_num;
+    info.waitting_load_keys_num += shard.waitting_load_keys_num;
+  }
+}
+
+void PikaCache::RecordRead(const std::string& key, bool hit) {
+  {
+    std::shared_lock l(rwlock_);
+    admission_sketch_->Increment(key);
+    // Hits are the common case, cold keys and contended updates are left out
+    if (hit && admission_sketch_->Frequency(key) < kHotKeyFrequency) {
+      return;
+    }
+  }
+  HotKeyStripe& stripe = HotKeyStripeOf(key);
+  if (!hit) {
+    std::lock_guard l(stripe.mu);
+    CacheKeyStat* stat = FindHotKey(&stripe.keys, key, true);
+    stat->reads++;
+    stat->misses++;
+    return;
+  }
+  std::unique_lock l(stripe.mu, std::try_to_lock);
+  if (l.owns_lock()) {
+    CacheKeyStat* stat = FindHotKey(&stripe.keys, key, true);
+    stat->reads++;
+    stat->hits++;
+  }
+}
+
+PikaCache::HotKeyStripe& PikaCache::HotKeyStripeOf(const std::string& key) {
+  return hot_keys_[std::hash<std::string>{}(key) % kHotKeyStripes];
+}
+
+size_t PikaCache::AdmissionSketchCapacity() {
+  uint64_t keys = static_cast<uint64_t>(g_pika_conf->cache_maxmemory()) / kCachedKeyBytes;
+  return std::clamp<size_t>(keys, kMinSketchCapacity, kMaxSketchCapacity);
+}
+
+CacheKeyStat* PikaCache::FindHotKey(std::vector<CacheKeyStat>* hot_keys, const std::string& key, bool insert) {
+  CacheKeyStat* min_stat = nullptr;
+  for (auto& stat : *hot_keys) {
+    if (stat.key == key) {
+      return &stat;
+    }
+    if (!min_stat || stat.reads < min_stat->reads) {
+      min_stat = &stat;
+    }
+  }
+  if (!insert) {
+    return nullptr;
+  }
+  if (hot_keys->size() < kHotKeyNum) {
+    hot_keys->push_back(CacheKeyStat{key});
+    return &hot_keys->back();
+  }
+  // Space-saving: the new key takes over the count of the least read one
+  uint64_t reads = min_stat->reads;
+  *min_stat = CacheKeyStat{key};
+  min_stat->reads = reads;
+  return min_stat;
+}
+
+bool PikaCache::BeginLoad(const std::string& key) {
+  if (loads_.Begin(key, kLoadWait)) {
+    return true;
+  }
+  coalesced_misses_++;
+  return false;
+}
+
+void PikaCache::EndLoad(const std::string& key, uint64_t load_us) {
+  loads_.End(key);
+  loads_num_++;
+  load_us_ += load_us;
+  HotKeyStripe& stripe = HotKeyStripeOf(key);
+  std::lock_guard l(stripe.mu);
+  if (CacheKeyStat* stat = FindHotKey(&stripe.keys, key, false); stat) {
+    stat->loads++;
+    stat->load_us += load_us;
   }
 }
 
+bool PikaCache::Admit(const std::string& key) {
+  if (!g_pika_conf->cache_admission()) {
+    return true;
+  }
+  // Nothing gets evicted while the cache has room
+  if (cache::RedisCache::GetUsedMemory() < static_cast<uint64_t>(g_pika_conf->cache_maxmemory()) / 10 * 9) {
+    return true;
+  }
+  // TinyLFU, the key only goes in when read more often than the key it would
+  // evict. The cache evicts among sampled keys, the coldest of a few random
+  // keys of the shard stands in for that one
+  std::shared_lock l(rwlock_);
+  int cache_index = CacheIndex(key);
+  std::vector<std::string> victims;
+  {
+    std::lock_guard lm(*cache_mutexs_[cache_index]);
+    std::string victim;
+    for (int i = 0; i < kAdmitSamples && caches_[cache_index]->RandomKey(&victim).ok(); i++) {
+      victims.push_back(victim);
+    }
+  }
+  if (victims.empty()) {
+    return true;
+  }
+  int victim_frequency = pstd::FrequencySketch::kMaxFrequency;
+  for (const auto& victim : victims) {
+    victim_frequency = std::min(victim_frequency, admission_sketch_->Frequency(victim));
+  }
+  if (admission_sketch_->Frequency(key) > victim_frequency) {
+    return true;
+  }
+  admission_rejects_++;
+  return false;
+}
+
 bool PikaCache::Exists(std::string& key) {
   int cache_index = CacheIndex(key);
   std::lock_guard lm(*cache_mutexs_[cache_index]);
@@ -1520,6 +1648,7 @@ Status PikaCache::InitWithoutLock(uint32_t cache_num, cache::CacheConfig *cache_
   if (cache_cfg != nullptr) {
     cache::RedisCache::SetConfig(cache_cfg);
   }
+  admission_sketch_ = std::make_unique<pstd::FrequencySketch>(AdmissionSketchCapacity());
 
   for (uint32_t i = 0; i < cache_num; ++i) {
     auto *cache = new cache::RedisCache();
@@ -1533,6 +1662,12 @@ Status PikaCache::InitWithoutLock(uint32_t cache_num, cache::CacheConfig *cache_
     caches_.push_back(cache);
     cache_mutexs_.push_back(std::make_shared<pstd::Mutex>());
   }
+  for (uint32_t i = 0; i < cache_num; ++i) {
+    auto load_thread = std::make_unique<PikaCacheLoadThread>(zset_cache_start_direction_, zset_cache_field_num_per_key_,
+                                                             caches_[i], cache_mutexs_[i].get());
+    load_thread->StartThread();
+    cache_load_threads_.push_back(std::move(load_thread));
+  }
   cache_status_ = PIKA_CACHE_STATUS_OK;
   return Status::OK();
 }
@@ -1541,6 +1676,8 @@ void PikaCache::DestroyWithoutLock(void)
 {
   cache_status_ = PIKA_CACHE_STATUS_DESTROY;
 
+  // Stopped first, they use the caches
+  cache_load_threads_.clear();
   for (auto iter = caches_.begin(); iter != caches_.end(); ++iter) {
     delete *iter;
   }
@@ -1619,10 +1756,23 @@ Status PikaCache::WriteZSetToCache(std::string& key, std::vector<storage::ScoreM
 }
 
 void PikaCache::PushKeyToAsyncLoadQueue(const char key_type, std::string& key, const std::shared_ptr<DB>& db) {
-  cache_load_thread_->Push(key_type, key, db);
+  // Reset and Destroy replace the shards and their loaders under the write lock
+  std::shared_lock l(rwlock_);
+  if (cache_load_threads_.empty()) {
+    return;
+  }
+  cache_load_threads_[CacheIndex(key)]->Push(key_type, key, db);
 }
 
 void PikaCache::ClearHitRatio(void) {
   std::unique_lock l(rwlock_);
   cache::RedisCache::ResetHitAndMissNum();
+  coalesced_misses_ = 0;
+  admission_rejects_ = 0;
+  loads_num_ = 0;
+  load_us_ = 0;
+  for (auto& stripe : hot_keys_) {
+    std::lock_guard lh(stripe.mu);
+    stripe.keys.clear();
+  }
 }
@@ -7,17 +7,20 @@
 #include "include/pika_cache_load_thread.h"
 #include "include/pika_server.h"
 #include "include/pika_cache.h"
-#include "pstd/include/scope_record_lock.h"
+#include "pstd/include/record_lock_mgr.h"
 
 extern PikaServer* g_pika_server;
 
-PikaCacheLoadThread::PikaCacheLoadThread(int zset_cache_start_direction, int zset_cache_field_num_per_key)
+PikaCacheLoadThread::PikaCacheLoadThread(int zset_cache_start_direction, int zset_cache_field_num_per_key,
+                                         cache::RedisCache* cache_obj, pstd::Mutex* cache_mutex)
     : should_exit_(false)
       , loadkeys_cond_()
       , async_load_keys_num_(0)
       , waitting_load_keys_num_(0)
       , zset_cache_start_direction_(zset_cache_start_direction)
       , zset_cache_field_num_per_key_(zset_cache_field_num_per_key)
+      , cache_obj_(cache_obj)
+      , cache_mutex_(cache_mutex)
 {
   set_thread_name("PikaCacheLoadThread");
 }
@@ -161,7 +164,7 @@ bool PikaCacheLoadThread::LoadZset(std::string& key, const std::shared_ptr<DB>&
 }
 
 bool PikaCacheLoadThread::LoadKey(const char key_type, std::string& key, const std::shared_ptr<DB>& db) {
-  pstd::lock::ScopeRecordLock record_lock(db->LockMgr(), key);
+  pstd::lock::RecordLockGuard record_lock(db->LockMgr(), key, pstd::lock::LockMode::kShared);
   switch (key_type) {
     case 'k':
       return LoadKV(key, db);
@@ -187,8 +190,8 @@ void *PikaCacheLoadThread::ThreadMain() {
     {
       std::unique_lock lq(loadkeys_mutex_);
       waitting_load_keys_num_ = loadkeys_queue_.size();
-      while (!should_exit_ && loadkeys_queue_.size() <= 0) {
-        loadkeys_cond_.wait(lq);
+      if (!should_exit_ && loadkeys_queue_.empty()) {
+        loadkeys_cond_.wait_for(lq, std::chrono::milliseconds(CACHE_EXPIRE_CYCLE_INTERVAL_MS));
       }
 
       if (should_exit_) {
@@ -212,7 +215,18 @@ void *PikaCacheLoadThread::ThreadMain() {
       std::unique_lock lm(loadkeys_map_mutex_);
       loadkeys_map_.erase(std::get<1>(load_key));
     }
+    ActiveExpireCycleIfNeeded();
   }
 
   return nullptr;
 }
+
+void PikaCacheLoadThread::ActiveExpireCycleIfNeeded() {
+  uint64_t now_us = pstd::NowMicros();
+  if (now_us - last_expire_cycle_us_ < CACHE_EXPIRE_CYCLE_INTERVAL_MS * 1000) {
+    return;
+  }
+  last_expire_cycle_us_ = now_us;
+  std::lock_guard lm(*cache_mutex_);
+  cache_obj_->ActiveExpireCycle();
+}
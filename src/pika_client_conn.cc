@@ -34,8 +34,8 @@ PikaClientConn::PikaClientConn(int fd, const std::string& ip_port, net::Thread*
   time_stat_.reset(new TimeStat());
 }
 
-std::shared_ptr<Cmd> PikaClientConn::DoCmd(const PikaCmdArgsType& argv, const std::string& opt,
-                                           const std::shared_ptr<std::string>& resp_ptr) {
+std::shared_ptr<Cmd> PikaClientConn::DoCmd(PikaCmdArgsType&& args, const std::string& opt,
+                                           const std::shared_ptr<std::string>& resp_ptr, bool batch_write) {
   // Get command info
   std::shared_ptr<Cmd> c_ptr = g_pika_cmd_table_manager->GetCmd(opt);
   if (!c_ptr) {
@@ -56,8 +56,9 @@ std::shared_ptr<Cmd> PikaClientConn::DoCmd(const PikaCmdArgsType& argv, const st
       return c_ptr;
     }
   }
-  // Initial
-  c_ptr->Initial(argv, current_db_);
+  // Initial, the arguments are owned by the command from here on
+  c_ptr->Initial(std::move(args), current_db_);
+  const PikaCmdArgsType& argv = c_ptr->argv();
   if (!c_ptr->res().ok()) {
     if (IsInTxn()) {
       SetTxnInitFailState(true);
@@ -129,7 +130,7 @@ std::shared_ptr<Cmd> PikaClientConn::DoCmd(const PikaCmdArgsType& argv, const st
     ProcessMonitor(argv);
   }
 
-  g_pika_server->UpdateQueryNumAndExecCountDB(current_db_, opt, c_ptr->is_write());
+  g_pika_server->UpdateQueryNumAndExecCountDB(current_db_, c_ptr->GetCmdId(), c_ptr->is_write());
 
   // PubSub connection
   // (P)SubscribeCmd will set is_pubsub_
@@ -186,12 +187,26 @@ std::shared_ptr<Cmd> PikaClientConn::DoCmd(const PikaCmdArgsType& argv, const st
     }
   }
 
+  if (batch_write && c_ptr->CanBatch()) {
+    if (!write_batch_.empty() && write_batch_.front().first->name() != c_ptr->name()) {
+      ExecWriteBatch();
+    }
+    write_batch_.emplace_back(c_ptr, resp_array.size() - 1);
+    return c_ptr;
+  }
+  // Pending writes go first to keep the order of the pipeline
+  ExecWriteBatch();
+
   // Process Command
   c_ptr->Execute();
+  FinishCmd(c_ptr);
+  return c_ptr;
+}
+
+void PikaClientConn::FinishCmd(const std::shared_ptr<Cmd>& c_ptr) {
   time_stat_->process_done_ts_ = pstd::NowMicros();
-  auto cmdstat_map = g_pika_cmd_table_manager->GetCommandStatMap();
-  (*cmdstat_map)[opt].cmd_count.fetch_add(1);
-  (*cmdstat_map)[opt].cmd_time_consuming.fetch_add(time_stat_->total_time());
+  g_pika_server->UpdateCmdTimeStat(c_ptr->GetCmdId(), time_stat_->queue_time(), time_stat_->process_time(),
+                                   time_stat_->total_time());
 
   if (c_ptr->res().ok() && c_ptr->is_write() && name() != kCmdNameExec) {
     if (c_ptr->name() == kCmdNameFlushdb) {
@@ -209,10 +224,30 @@ std::shared_ptr<Cmd> PikaClientConn::DoCmd(const PikaCmdArgsType& argv, const st
   }
 
   if (g_pika_conf->slowlog_slower_than() >= 0) {
-    ProcessSlowlog(argv, c_ptr->GetDoDuration());
+    ProcessSlowlog(c_ptr->argv(), c_ptr->GetDoDuration());
   }
+}
 
-  return c_ptr;
+void PikaClientConn::ExecWriteBatch() {
+  if (write_batch_.empty()) {
+    return;
+  }
+  if (write_batch_.size() == 1) {
+    write_batch_.front().first->Execute();
+  } else {
+    std::vector<std::shared_ptr<Cmd>> cmds;
+    cmds.reserve(write_batch_.size());
+    for (const auto& item : write_batch_) {
+      cmds.push_back(item.first);
+    }
+    Cmd::ExecuteBatch(cmds);
+    g_pika_server->incr_pipeline_write_batches(cmds.size());
+  }
+  for (const auto& [cmd_ptr, resp_index] : write_batch_) {
+    FinishCmd(cmd_ptr);
+    TakeCmdResp(cmd_ptr, resp_index);
+  }
+  write_batch_.clear();
 }
 
 void PikaClientConn::ProcessSlowlog(const PikaCmdArgsType& argv, uint64_t do_duration) {
@@ -255,12 +290,13 @@ void PikaClientConn::ProcessMonitor(const PikaCmdArgsType& argv) {
   g_pika_server->AddMonitorMessage(monitor_message);
 }
 
-void PikaClientConn::ProcessRedisCmds(const std::vector<net::RedisCmdArgsType>& argvs, bool async,
+void PikaClientConn::ProcessRedisCmds(std::vector<net::RedisCmdArgsType>&& argvs, bool async,
                                       std::string* response) {
   time_stat_->Reset();
   if (async) {
     auto arg = new BgTaskArg();
-    arg->redis_cmds = argvs;
+    std::string opt = argvs[0][0];
+    arg->redis_cmds = std::move(argvs);
     time_stat_->enqueue_ts_ = pstd::NowMicros();
     arg->conn_ptr = std::dynamic_pointer_cast<PikaClientConn>(shared_from_this());
     /**
@@ -269,14 +305,13 @@ void PikaClientConn::ProcessRedisCmds(const std::vector<net::RedisCmdArgsType>&
      * However, if using the pipeline method for Codis, it can correctly distinguish between
      * fast and slow commands, but it cannot guarantee sequential execution.
      */
-    std::string opt = argvs[0][0];
     pstd::StringToLower(opt);
     bool is_slow_cmd = g_pika_conf->is_slow_cmd(opt);
     bool is_admin_cmd = g_pika_conf->is_admin_cmd(opt);
-    g_pika_server->ScheduleClientPool(&DoBackgroundTask, arg, is_slow_cmd, is_admin_cmd);
+    g_pika_server->ScheduleClientPool(&DoBackgroundTask, arg, is_slow_cmd, is_admin_cmd, fd());
     return;
   }
-  BatchExecRedisCmd(argvs);
+  BatchExecRedisCmd(std::move(argvs));
 }
 
 void PikaClientConn::DoBackgroundTask(void* arg) {
@@ -294,16 +329,18 @@ void PikaClientConn::DoBackgroundTask(void* arg) {
     }
   }
 
-  conn_ptr->BatchExecRedisCmd(bg_arg->redis_cmds);
+  conn_ptr->BatchExecRedisCmd(std::move(bg_arg->redis_cmds));
 }
 
-void PikaClientConn::BatchExecRedisCmd(const std::vector<net::RedisCmdArgsType>& argvs) {
+void PikaClientConn::BatchExecRedisCmd(std::vector<net::RedisCmdArgsType>&& argvs) {
   resp_num.store(static_cast<int32_t>(argvs.size()));
-  for (const auto& argv : argvs) {
-    std::shared_ptr<std::string> resp_ptr = std::make_shared<std::string>();
-    resp_array.push_back(resp_ptr);
-    ExecRedisCmd(argv, resp_ptr);
+  bool batch_write = argvs.size() > 1 && g_pika_conf->pipeline_write_batch();
+  for (auto& argv : argvs) {
+    resp_array.push_back(std::make_shared<std::string>());
+    resp_chunks.emplace_back();
+    ExecRedisCmd(std::move(argv), resp_array.size() - 1, batch_write);
   }
+  ExecWriteBatch();
   time_stat_->process_done_ts_ = pstd::NowMicros();
   TryWriteResp();
 }
@@ -311,14 +348,18 @@ void PikaClientConn::BatchExecRedisCmd(const std::vector<net::RedisCmdArgsType>&
 void PikaClientConn::TryWriteResp() {
   int expected = 0;
   if (resp_num.compare_exchange_strong(expected, -1)) {
-    for (auto& resp : resp_array) {
-      WriteResp(*resp);
+    for (size_t i = 0; i < resp_array.size(); i++) {
+      for (auto& chunk : resp_chunks[i]) {
+        WriteResp(std::move(chunk));
+      }
+      WriteResp(std::move(*resp_array[i]));
     }
     if (write_completed_cb_) {
       write_completed_cb_();
       write_completed_cb_ = nullptr;
     }
     resp_array.clear();
+    resp_chunks.clear();
     NotifyEpoll(true);
   }
 }
@@ -427,7 +468,7 @@ void PikaClientConn::ExitTxn() {
   }
 }
 
-void PikaClientConn::ExecRedisCmd(const PikaCmdArgsType& argv, std::shared_ptr<std::string>& resp_ptr) {
+void PikaClientConn::ExecRedisCmd(PikaCmdArgsType&& argv, size_t resp_index, bool batch_write) {
   // get opt
   std::string opt = argv[0];
   pstd::StringToLower(opt);
@@ -438,8 +479,19 @@ void PikaClientConn::ExecRedisCmd(const PikaCmdArgsType& argv, std::shared_ptr<s
     }
   }
 
-  std::shared_ptr<Cmd> cmd_ptr = DoCmd(argv, opt, resp_ptr);
-  *resp_ptr = std::move(cmd_ptr->res().message());
+  std::shared_ptr<Cmd> cmd_ptr = DoCmd(std::move(argv), opt, resp_array[resp_index], batch_write);
+  if (!write_batch_.empty() && write_batch_.back().first == cmd_ptr) {
+    // The reply is taken once the batch is executed
+    return;
+  }
+  TakeCmdResp(cmd_ptr, resp_index);
+}
+
+void PikaClientConn::TakeCmdResp(const std::shared_ptr<Cmd>& cmd_ptr, size_t resp_index) {
+  std::vector<std::string>& chunks = resp_chunks[resp_index];
+  chunks = cmd_ptr->res().TakeChunks();
+  *resp_array[resp_index] = std::move(chunks.back());
+  chunks.pop_back();
   resp_num--;
 }
 
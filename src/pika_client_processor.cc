@@ -5,10 +5,17 @@
 
 #include "include/pika_client_processor.h"
 
+#include <algorithm>
+
 #include <glog/logging.h>
 
-PikaClientProcessor::PikaClientProcessor(size_t worker_num, size_t max_queue_size, const std::string& name_prefix) {
-  pool_ = std::make_unique<net::ThreadPool>(worker_num, max_queue_size, name_prefix + "Pool");
+PikaClientProcessor::PikaClientProcessor(size_t worker_num, size_t max_queue_size, bool work_stealing,
+                                         const std::string& name_prefix) {
+  if (work_stealing) {
+    ws_pool_ = std::make_unique<net::WorkStealingPool>(worker_num, max_queue_size, name_prefix + "Pool");
+  } else {
+    pool_ = std::make_unique<net::ThreadPool>(worker_num, max_queue_size, name_prefix + "Pool");
+  }
 }
 
 PikaClientProcessor::~PikaClientProcessor() {
@@ -16,7 +23,7 @@ PikaClientProcessor::~PikaClientProcessor() {
 }
 
 int PikaClientProcessor::Start() {
-  int res = pool_->start_thread_pool();
+  int res = ws_pool_ ? ws_pool_->start_thread_pool() : pool_->start_thread_pool();
   if (res != net::kSuccess) {
     return res;
   }
@@ -24,14 +31,26 @@ int PikaClientProcessor::Start() {
 }
 
 void PikaClientProcessor::Stop() {
-  pool_->stop_thread_pool();
+  if (ws_pool_) {
+    ws_pool_->stop_thread_pool();
+  } else {
+    pool_->stop_thread_pool();
+  }
 }
 
-void PikaClientProcessor::SchedulePool(net::TaskFunc func, void* arg) { pool_->Schedule(func, arg); }
+void PikaClientProcessor::SchedulePool(net::TaskFunc func, void* arg, uint64_t affinity) {
+  if (ws_pool_) {
+    ws_pool_->Schedule(func, arg, affinity);
+  } else {
+    pool_->Schedule(func, arg);
+  }
+}
 
 size_t PikaClientProcessor::ThreadPoolCurQueueSize() {
   size_t cur_size = 0;
-  if (pool_) {
+  if (ws_pool_) {
+    ws_pool_->cur_queue_size(&cur_size);
+  } else if (pool_) {
     pool_->cur_queue_size(&cur_size);
   }
   return cur_size;
@@ -39,8 +58,23 @@ size_t PikaClientProcessor::ThreadPoolCurQueueSize() {
 
 size_t PikaClientProcessor::ThreadPoolMaxQueueSize() {
   size_t cur_size = 0;
-  if (pool_) {
+  if (ws_pool_) {
+    cur_size = ws_pool_->max_queue_size();
+  } else if (pool_) {
     cur_size = pool_->max_queue_size();
   }
   return cur_size;
 }
+
+size_t PikaClientProcessor::ThreadPoolMaxWorkerQueueSize() {
+  if (!ws_pool_) {
+    return ThreadPoolCurQueueSize();
+  }
+  size_t max_size = 0;
+  for (size_t depth : ws_pool_->queue_depths()) {
+    max_size = std::max(max_size, depth);
+  }
+  return max_size;
+}
+
+uint64_t PikaClientProcessor::ThreadPoolStealCount() { return ws_pool_ ? ws_pool_->steal_count() : 0; }
@@ -14,6 +14,66 @@
 
 extern std::unique_ptr<PikaConf> g_pika_conf;
 
+namespace {
+
+// Released instances a thread keeps of each pooled command
+constexpr size_t kMaxPooledCmds = 16;
+
+/*
+ * Released instances of the pooled commands, indexed by command id. An
+ * instance goes back to the pool of the thread dropping its last reference,
+ * which for client commands is the worker that executed it.
+ */
+struct CmdPool {
+  ~CmdPool();
+  std::vector<std::vector<Cmd*>> free_cmds;
+};
+
+thread_local CmdPool cmd_pool;
+// Set once cmd_pool is gone, instances released after that are freed
+thread_local bool cmd_pool_destroyed = false;
+
+CmdPool::~CmdPool() {
+  cmd_pool_destroyed = true;
+  for (auto& cmds : free_cmds) {
+    for (Cmd* cmd : cmds) {
+      delete cmd;
+    }
+  }
+}
+
+void ReleaseCmd(Cmd* cmd) {
+  if (cmd_pool_destroyed) {
+    delete cmd;
+    return;
+  }
+  uint32_t id = cmd->GetCmdId();
+  if (cmd_pool.free_cmds.size() <= id) {
+    cmd_pool.free_cmds.resize(id + 1);
+  }
+  std::vector<Cmd*>& cmds = cmd_pool.free_cmds[id];
+  if (cmds.size() >= kMaxPooledCmds) {
+    delete cmd;
+    return;
+  }
+  cmd->ResetState();
+  cmds.push_back(cmd);
+}
+
+std::shared_ptr<Cmd> AcquireCmd(Cmd* proto) {
+  uint32_t id = proto->GetCmdId();
+  Cmd* cmd = nullptr;
+  if (!cmd_pool_destroyed && id < cmd_pool.free_cmds.size() && !cmd_pool.free_cmds[id].empty()) {
+    cmd = cmd_pool.free_cmds[id].back();
+    cmd_pool.free_cmds[id].pop_back();
+  } else {
+    cmd = proto->Clone();
+  }
+  return {cmd, ReleaseCmd};
+}
+
+}  // namespace
+
 PikaCmdTableManager::PikaCmdTableManager() {
   cmds_ = std::make_unique<CmdTable>();
   cmds_->reserve(300);
@@ -44,9 +104,7 @@ void PikaCmdTableManager::InitCmdTable(void) {
     }
   }
 
-  CommandStatistics statistics;
   for (auto& iter : *cmds_) {
-    cmdstat_map_.emplace(iter.first, statistics);
     iter.second->SetCmdId(cmdId_++);
   }
 }
@@ -63,10 +121,6 @@ void PikaCmdTableManager::RenameCommand(const std::string before, const std::str
   }
 }
 
-std::unordered_map<std::string, CommandStatistics>* PikaCmdTableManager::GetCommandStatMap() {
-  return &cmdstat_map_;
-}
-
 std::shared_ptr<Cmd> PikaCmdTableManager::GetCmd(const std::string& opt) {
   const std::string& internal_opt = opt;
   return NewCommand(internal_opt);
@@ -75,6 +129,9 @@ std::shared_ptr<Cmd> PikaCmdTableManager::GetCmd(const std::string& opt) {
 std::shared_ptr<Cmd> PikaCmdTableManager::NewCommand(const std::string& opt) {
   Cmd* cmd = GetCmdFromDB(opt, *cmds_);
   if (cmd) {
+    if (cmd->IsPooled()) {
+      return AcquireCmd(cmd);
+    }
     return std::shared_ptr<Cmd>(cmd->Clone());
   }
   return nullptr;
@@ -25,7 +25,7 @@
 #include "include/pika_transaction.h"
 #include "include/pika_zset.h"
 #include "pstd_defer.h"
-#include "src/pstd/include/scope_record_lock.h"
+#include "src/pstd/include/record_lock_mgr.h"
 
 using pstd::Status;
 
@@ -832,7 +832,11 @@ Cmd::Cmd(std::string name, int arity, uint32_t flag, uint32_t aclCategory)
 }
 
 void Cmd::Initial(const PikaCmdArgsType& argv, const std::string& db_name) {
-  argv_ = argv;
+  Initial(PikaCmdArgsType(argv), db_name);
+}
+
+void Cmd::Initial(PikaCmdArgsType&& argv, const std::string& db_name) {
+  argv_ = std::move(argv);
   db_name_ = db_name;
   res_.clear();  // Clear res content
   db_ = g_pika_server->GetDB(db_name_);
@@ -841,6 +845,19 @@ void Cmd::Initial(const PikaCmdArgsType& argv, const std::string& db_name) {
   DoInitial();
 };
 
+void Cmd::ResetState() {
+  argv_.clear();
+  res_.clear();
+  s_ = rocksdb::Status::OK();
+  db_.reset();
+  sync_db_.reset();
+  conn_.reset();
+  resp_.reset();
+  stage_ = kNone;
+  do_duration_ = 0;
+  Clear();
+}
+
 std::vector<std::string> Cmd::current_key() const { return {""}; }
 
 void Cmd::Execute() {
@@ -860,7 +877,7 @@ void Cmd::ProcessCommand(const HintKeys& hint_keys) {
 }
 
 void Cmd::InternalProcessCommand(const HintKeys& hint_keys) {
-  pstd::lock::MultiRecordLock record_lock(db_->LockMgr());
+  pstd::lock::RecordLockGuard record_lock(db_->LockMgr(), pstd::lock::LockMode::kExclusive);
   if (is_write()) {
     record_lock.Lock(current_key());
   }
@@ -875,9 +892,7 @@ void Cmd::InternalProcessCommand(const HintKeys& hint_keys) {
 
   DoBinlog();
 
-  if (is_write()) {
-    record_lock.Unlock(current_key());
-  }
+  record_lock.Unlock();
 }
 
 void Cmd::DoCommand(const HintKeys& hint_keys) {
@@ -892,13 +907,36 @@ void Cmd::DoCommand(const HintKeys& hint_keys) {
   if (IsNeedCacheDo()
       && PIKA_CACHE_NONE != g_pika_conf->cache_mode()
       && db_->cache()->CacheStatus() == PIKA_CACHE_STATUS_OK) {
+    std::string load_key;
+    bool load_leader = false;
     if (IsNeedReadCache()) {
       ReadCache();
+      std::vector<std::string> keys = current_key();
+      if (is_read() && keys.size() == 1) {
+        load_key = std::move(keys.front());
+        db_->cache()->RecordRead(load_key, !res().CacheMiss());
+        // One of the readers missing a key loads it, the others read the cache again then
+        if (res().CacheMiss()) {
+          load_leader = db_->cache()->BeginLoad(load_key);
+          if (!load_leader) {
+            res_.clear();
+            ReadCache();
+          }
+        }
+      }
     }
     if (is_read() && res().CacheMiss()) {
-      pstd::lock::MultiScopeRecordLock record_lock(db_->LockMgr(), current_key());
+      uint64_t start_us = pstd::NowMicros();
+      DEFER {
+        if (load_leader) {
+          db_->cache()->EndLoad(load_key, pstd::NowMicros() - start_us);
+        }
+      };
+      // Shared, cache misses of the same key fill the cache concurrently but never
+      // interleave with a write to it
+      pstd::lock::RecordLockGuard record_lock(db_->LockMgr(), current_key(), pstd::lock::LockMode::kShared);
       DoThroughDB();
-      if (IsNeedUpdateCache()) {
+      if (IsNeedUpdateCache() && (load_key.empty() || db_->cache()->Admit(load_key))) {
         DoUpdateCache();
       }
     } else if (is_write()) {
@@ -912,6 +950,61 @@ void Cmd::DoCommand(const HintKeys& hint_keys) {
   }
 }
 
+void Cmd::ExecuteBatch(const std::vector<std::shared_ptr<Cmd>>& cmds) {
+  const std::shared_ptr<Cmd>& first = cmds.front();
+  std::vector<std::string> keys;
+  for (const auto& cmd : cmds) {
+    std::vector<std::string> cur_keys = cmd->current_key();
+    keys.insert(keys.end(), cur_keys.begin(), cur_keys.end());
+  }
+  pstd::lock::RecordLockGuard record_lock(first->db_->LockMgr(), keys, pstd::lock::LockMode::kExclusive);
+  uint64_t start_us = pstd::NowMicros();
+  {
+    first->db_->DBLockShared();
+    DEFER { first->db_->DBUnlockShared(); };
+    first->DoBatch(cmds);
+    if (first->IsNeedCacheDo() && first->IsNeedUpdateCache()
+        && PIKA_CACHE_NONE != g_pika_conf->cache_mode()
+        && first->db_->cache()->CacheStatus() == PIKA_CACHE_STATUS_OK) {
+      for (const auto& cmd : cmds) {
+        cmd->DoUpdateCache();
+      }
+    }
+  }
+  // Every command is charged an equal share of the batch
+  uint64_t do_duration = (pstd::NowMicros() - start_us) / cmds.size();
+  for (const auto& cmd : cmds) {
+    cmd->do_duration_ += do_duration;
+  }
+
+  DoBinlogBatch(cmds);
+  record_lock.Unlock();
+}
+
+void Cmd::DoBinlogBatch(const std::vector<std::shared_ptr<Cmd>>& cmds) {
+  if (!g_pika_conf->write_binlog()) {
+    return;
+  }
+  std::vector<std::shared_ptr<Cmd>> succeeded;
+  for (const auto& cmd : cmds) {
+    if (cmd->res().ok()) {
+      succeeded.push_back(cmd);
+    }
+  }
+  if (succeeded.empty()) {
+    return;
+  }
+  const std::shared_ptr<SyncMasterDB>& sync_db = succeeded.front()->sync_db_;
+  Status s = sync_db->ConsensusProposeLogs(succeeded);
+  if (!s.ok()) {
+    LOG(WARNING) << sync_db->SyncDBInfo().ToString() << " Writing binlog failed, maybe no space left on device "
+                 << s.ToString();
+    for (const auto& cmd : succeeded) {
+      cmd->res().SetRes(CmdRes::kErrOther, s.ToString());
+    }
+  }
+}
+
 void Cmd::DoBinlog() {
   if (res().ok() && is_write() && g_pika_conf->write_binlog()) {
     std::shared_ptr<net::NetConn> conn_ptr = GetConn();
@@ -61,11 +61,20 @@ int PikaConf::Load() {
   GetConfStr("slowlog-write-errorlog", &swe);
   slowlog_write_errorlog_.store(swe == "yes" ? true : false);
 
+  std::string pwb;
+  GetConfStr("pipeline-write-batch", &pwb);
+  pipeline_write_batch_.store(pwb == "yes");
+
   // slot migrate
   std::string smgrt;
   GetConfStr("slotmigrate", &smgrt);
   slotmigrate_.store(smgrt == "yes" ? true : false);
 
+  // slot prefix key layout
+  std::string skp;
+  GetConfStr("slot-key-prefix", &skp);
+  slot_key_prefix_ = skp == "yes";
+
   // slow cmd thread pool
   std::string slowcmdpool;
   GetConfStr("slow-cmd-pool", &slowcmdpool);
@@ -158,6 +167,18 @@ int PikaConf::Load() {
     thread_pool_size_ = 100;
   }
 
+  std::string wsp;
+  GetConfStr("work-stealing-pool", &wsp);
+  work_stealing_pool_ = wsp == "yes";
+
+  std::string io_uring;
+  GetConfStr("io-uring", &io_uring);
+  io_uring_ = io_uring == "yes";
+
+  std::string reuse_port;
+  GetConfStr("reuse-port", &reuse_port);
+  reuse_port_ = reuse_port == "yes";
+
   GetConfInt("slow-cmd-thread-pool-size", &slow_cmd_thread_pool_size_);
   if (slow_cmd_thread_pool_size_ < 0) {
     slow_cmd_thread_pool_size_ = 8;
@@ -445,6 +466,18 @@ int PikaConf::Load() {
     small_compaction_duration_threshold_ = 1000000;
   }
 
+  zset_rank_index_threshold_ = 0;
+  GetConfInt("zset-rank-index-threshold", &zset_rank_index_threshold_);
+  if (zset_rank_index_threshold_ < 0) {
+    zset_rank_index_threshold_ = 0;
+  }
+
+  reap_expired_keys_per_sec_ = 1000;
+  GetConfInt("reap-expired-keys-per-sec", &reap_expired_keys_per_sec_);
+  if (reap_expired_keys_per_sec_ < 0) {
+    reap_expired_keys_per_sec_ = 0;
+  }
+
   // max-background-flushes and max-background-compactions should both be -1 or both not
   GetConfInt("max-background-flushes", &max_background_flushes_);
   if (max_background_flushes_ <= 0 && max_background_flushes_ != -1) {
@@ -638,6 +671,10 @@ int PikaConf::Load() {
   int cache_lfu_decay_time = 1;
   GetConfInt("cache-lfu-decay-time", &cache_lfu_decay_time);
   cache_lfu_decay_time_ = (0 > cache_lfu_decay_time) ? 1 : cache_lfu_decay_time;
+
+  std::string cache_admission = "yes";
+  GetConfStr("cache-admission", &cache_admission);
+  cache_admission_ = cache_admission == "yes";
   // sync window size
   int tmp_sync_window_size = kBinlogReadWinDefaultSize;
   GetConfInt("sync-window-size", &tmp_sync_window_size);
@@ -649,6 +686,49 @@ int PikaConf::Load() {
     sync_window_size_.store(tmp_sync_window_size);
   }
 
+  // binlog group commit
+  int tmp_group_commit_max_batch = kBinlogGroupCommitDefaultBatch;
+  GetConfInt("binlog-group-commit-max-batch", &tmp_group_commit_max_batch);
+  if (tmp_group_commit_max_batch <= 0) {
+    binlog_group_commit_max_batch_.store(kBinlogGroupCommitDefaultBatch);
+  } else if (tmp_group_commit_max_batch > kBinlogGroupCommitMaxBatch) {
+    binlog_group_commit_max_batch_.store(kBinlogGroupCommitMaxBatch);
+  } else {
+    binlog_group_commit_max_batch_.store(tmp_group_commit_max_batch);
+  }
+  int64_t tmp_group_commit_max_delay_us = 0;
+  GetConfInt64("binlog-group-commit-max-delay-us", &tmp_group_commit_max_delay_us);
+  if (tmp_group_commit_max_delay_us < 0) {
+    binlog_group_commit_max_delay_us_.store(0);
+  } else if (tmp_group_commit_max_delay_us > kBinlogGroupCommitMaxDelayUs) {
+    binlog_group_commit_max_delay_us_.store(kBinlogGroupCommitMaxDelayUs);
+  } else {
+    binlog_group_commit_max_delay_us_.store(tmp_group_commit_max_delay_us);
+  }
+
+  // binlog tail cache
+  int64_t tmp_binlog_tail_cache_size = kBinlogTailCacheDefaultSize;
+  GetConfInt64Human("binlog-tail-cache-size", &tmp_binlog_tail_cache_size);
+  binlog_tail_cache_size_.store(std::max<int64_t>(tmp_binlog_tail_cache_size, 0));
+
+  // replication frames
+  GetConfStr("repl-compression", &repl_compression_);
+  if (repl_compression_ != "lz4" && repl_compression_ != "zstd") {
+    repl_compression_ = "none";
+  }
+  int64_t tmp_repl_batch_max_bytes = kReplBatchDefaultMaxBytes;
+  GetConfInt64Human("repl-batch-max-bytes", &tmp_repl_batch_max_bytes);
+  if (tmp_repl_batch_max_bytes <= 0) {
+    repl_batch_max_bytes_.store(kReplBatchDefaultMaxBytes);
+  } else if (tmp_repl_batch_max_bytes > PIKA_MAX_CONN_RBUF_HB) {
+    repl_batch_max_bytes_.store(PIKA_MAX_CONN_RBUF_HB);
+  } else {
+    repl_batch_max_bytes_.store(tmp_repl_batch_max_bytes);
+  }
+  int64_t tmp_repl_batch_max_delay_us = 0;
+  GetConfInt64("repl-batch-max-delay-us", &tmp_repl_batch_max_delay_us);
+  repl_batch_max_delay_us_.store(std::clamp<int64_t>(tmp_repl_batch_max_delay_us, 0, kReplBatchMaxDelayUs));
+
   // max conn rbuf size
   int tmp_max_conn_rbuf_size = PIKA_MAX_CONN_RBUF;
   GetConfIntHuman("max-conn-rbuf-size", &tmp_max_conn_rbuf_size);
@@ -694,6 +774,13 @@ int PikaConf::Load() {
     max_rsync_parallel_num_ = kMaxRsyncParallelNum;
   }
 
+  int tmp_max_rsync_window_size = kDefaultRsyncWindowSize;
+  GetConfInt("max-rsync-window-size", &tmp_max_rsync_window_size);
+  if (tmp_max_rsync_window_size <= 0 || tmp_max_rsync_window_size > kMaxRsyncWindowSize) {
+    tmp_max_rsync_window_size = kDefaultRsyncWindowSize;
+  }
+  max_rsync_window_size_.store(tmp_max_rsync_window_size);
+
   int64_t tmp_rsync_timeout_ms = -1;
   GetConfInt64("rsync-timeout-ms", &tmp_rsync_timeout_ms);
   if(tmp_rsync_timeout_ms <= 0){
@@ -755,6 +842,7 @@ int PikaConf::ConfigRewrite() {
   SetConfInt("expire-logs-nums", expire_logs_nums_);
   SetConfInt("root-connection-num", root_connection_num_);
   SetConfStr("slowlog-write-errorlog", slowlog_write_errorlog_.load() ? "yes" : "no");
+  SetConfStr("pipeline-write-batch", pipeline_write_batch_.load() ? "yes" : "no");
   SetConfInt("slowlog-log-slower-than", slowlog_log_slower_than_.load());
   SetConfInt("slowlog-max-len", slowlog_max_len_);
   SetConfStr("write-binlog", write_binlog_ ? "yes" : "no");
@@ -763,6 +851,8 @@ int PikaConf::ConfigRewrite() {
   SetConfInt("max-cache-statistic-keys", max_cache_statistic_keys_);
   SetConfInt("small-compaction-threshold", small_compaction_threshold_);
   SetConfInt("small-compaction-duration-threshold", small_compaction_duration_threshold_);
+  SetConfInt("zset-rank-index-threshold", zset_rank_index_threshold_);
+  SetConfInt("reap-expired-keys-per-sec", reap_expired_keys_per_sec_);
   SetConfInt("max-client-response-size", static_cast<int32_t>(max_client_response_size_));
   SetConfInt("db-sync-speed", db_sync_speed_);
   SetConfStr("compact-cron", compact_cron_);
@@ -775,7 +865,14 @@ int PikaConf::ConfigRewrite() {
   SetConfInt("slave-priority", slave_priority_);
   SetConfInt("throttle-bytes-per-second", throttle_bytes_per_second_);
   SetConfInt("max-rsync-parallel-num", max_rsync_parallel_num_);
+  SetConfInt("max-rsync-window-size", max_rsync_window_size_.load());
   SetConfInt("sync-window-size", sync_window_size_.load());
+  SetConfInt("binlog-group-commit-max-batch", binlog_group_commit_max_batch_.load());
+  SetConfInt64("binlog-group-commit-max-delay-us", binlog_group_commit_max_delay_us_.load());
+  SetConfInt64("binlog-tail-cache-size", binlog_tail_cache_size_.load());
+  SetConfStr("repl-compression", repl_compression_);
+  SetConfInt64("repl-batch-max-bytes", repl_batch_max_bytes_.load());
+  SetConfInt64("repl-batch-max-delay-us", repl_batch_max_delay_us_.load());
   SetConfInt("consensus-level", consensus_level_.load());
   SetConfInt("replication-num", replication_num_.load());
   SetConfStr("slow-cmd-list", pstd::Set2String(slow_cmd_set_, ','));
@@ -795,6 +892,7 @@ int PikaConf::ConfigRewrite() {
   SetConfInt("level0-file-num-compaction-trigger", level0_file_num_compaction_trigger_);
   SetConfInt64("arena-block-size", arena_block_size_);
   SetConfStr("slotmigrate", slotmigrate_.load() ? "yes" : "no");
+  SetConfStr("slot-key-prefix", slot_key_prefix_ ? "yes" : "no");
   SetConfInt64("slotmigrate-thread-num", slotmigrate_thread_num_);
   SetConfInt64("thread-migrate-keys-num", thread_migrate_keys_num_);
   // slaveof config item is special
@@ -333,6 +333,26 @@ Status ConsensusCoordinator::ProposeLog(const std::shared_ptr<Cmd>& cmd_ptr) {
   return Status::OK();
 }
 
+Status ConsensusCoordinator::ProposeLogs(const std::vector<std::shared_ptr<Cmd>>& cmds) {
+  std::vector<std::string> contents;
+  contents.reserve(cmds.size());
+  for (const auto& cmd_ptr : cmds) {
+    contents.push_back(cmd_ptr->ToRedisProtocol());
+  }
+  Status s = stable_logger_->Logger()->Put(contents);
+  if (!s.ok()) {
+    std::string db_name = cmds.front()->db_name().empty() ? g_pika_conf->default_db() : cmds.front()->db_name();
+    std::shared_ptr<DB> db = g_pika_server->GetDB(db_name);
+    if (db) {
+      db->SetBinlogIoError();
+    }
+    return s;
+  }
+
+  g_pika_server->SignalAuxiliary();
+  return Status::OK();
+}
+
 Status ConsensusCoordinator::InternalAppendLog(const std::shared_ptr<Cmd>& cmd_ptr) {
   return InternalAppendBinlog(cmd_ptr);
 }
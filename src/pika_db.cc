@@ -11,7 +11,7 @@
 #include "include/pika_cmd_table_manager.h"
 #include "include/pika_rm.h"
 #include "include/pika_server.h"
-#include "mutex_impl.h"
+#include "include/rsync_sst_identity.h"
 
 using pstd::Status;
 extern PikaServer* g_pika_server;
@@ -42,7 +42,7 @@ DB::DB(std::string db_name, const std::string& db_path,
   rocksdb::Status s = storage_->Open(g_pika_server->storage_options(), db_path_);
   pstd::CreatePath(db_path_);
   pstd::CreatePath(log_path_);
-  lock_mgr_ = std::make_shared<pstd::lock::LockMgr>(1000, 0, std::make_shared<pstd::lock::MutexFactoryImpl>());
+  lock_mgr_ = std::make_shared<pstd::lock::RecordLockMgr>();
   binlog_io_error_.store(false);
   opened_ = s.ok();
   assert(storage_);
@@ -71,7 +71,7 @@ void DB::BgSaveDB() {
 void DB::SetBinlogIoError() { return binlog_io_error_.store(true); }
 void DB::SetBinlogIoErrorrelieve() { return binlog_io_error_.store(false); }
 bool DB::IsBinlogIoError() { return binlog_io_error_.load(); }
-std::shared_ptr<pstd::lock::LockMgr> DB::LockMgr() { return lock_mgr_; }
+std::shared_ptr<pstd::lock::RecordLockMgr> DB::LockMgr() { return lock_mgr_; }
 std::shared_ptr<PikaCache> DB::cache() const { return cache_; }
 std::shared_ptr<storage::Storage> DB::storage() const { return storage_; }
 
@@ -266,6 +266,12 @@ bool DB::RunBgsaveEngine() {
   }
   LOG(INFO) << db_name_ << " create new backup finished.";
 
+  // Lets the slaves holding some of the SST files already skip them
+  pstd::Status ps = rsync::WriteDumpSstIdentities(storage().get(), g_pika_conf->db_instance_num(), info.path);
+  if (!ps.ok()) {
+    LOG(WARNING) << db_name_ << " write sst identities failed: " << ps.ToString();
+  }
+
   return true;
 }
 
@@ -547,6 +553,12 @@ void DB::UpdateCacheInfo(CacheInfo& cache_info) {
   cache_info_.keys_num = cache_info.keys_num;
   cache_info_.used_memory = cache_info.used_memory;
   cache_info_.waitting_load_keys_num = cache_info.waitting_load_keys_num;
+  cache_info_.coalesced_misses = cache_info.coalesced_misses;
+  cache_info_.admission_rejects = cache_info.admission_rejects;
+  cache_info_.loads = cache_info.loads;
+  cache_info_.load_us = cache_info.load_us;
+  cache_info_.hot_keys = std::move(cache_info.hot_keys);
+  cache_info_.shards = std::move(cache_info.shards);
   cache_usage_ = cache_info.used_memory;
 
   uint64_t all_cmds = cache_info.hits + cache_info.misses;
@@ -585,5 +597,11 @@ void DB::ResetDisplayCacheInfo(int status) {
   cache_info_.hitratio_all = 0.0;
   cache_info_.load_keys_per_sec = 0;
   cache_info_.waitting_load_keys_num = 0;
+  cache_info_.coalesced_misses = 0;
+  cache_info_.admission_rejects = 0;
+  cache_info_.loads = 0;
+  cache_info_.load_us = 0;
+  cache_info_.hot_keys.clear();
+  cache_info_.shards.clear();
   cache_usage_ = 0;
 }
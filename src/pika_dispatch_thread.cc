@@ -19,6 +19,7 @@ PikaDispatchThread::PikaDispatchThread(std::set<std::string>& ips, int port, int
     : conn_factory_(max_conn_rbuf_size), handles_(this) {
   thread_rep_ = net::NewDispatchThread(ips, port, work_num, &conn_factory_, cron_interval, queue_limit, &handles_);
   thread_rep_->set_thread_name("Dispatcher");
+  thread_rep_->SetReusePort(g_pika_conf->reuse_port());
 }
 
 PikaDispatchThread::~PikaDispatchThread() {
@@ -438,10 +438,9 @@ void HMgetCmd::Do() {
   s_ = db_->storage()->HMGet(key_, fields_, &vss);
   if (s_.ok() || s_.IsNotFound()) {
     res_.AppendArrayLenUint64(vss.size());
-    for (const auto& vs : vss) {
+    for (auto& vs : vss) {
       if (vs.status.ok()) {
-        res_.AppendStringLenUint64(vs.value.size());
-        res_.AppendContent(vs.value);
+        res_.AppendString(std::move(vs.value));
       } else {
         res_.AppendContent("$-1");
       }
@@ -105,6 +105,26 @@ void SetCmd::DoThroughDB() {
   Do();
 }
 
+void SetCmd::DoBatch(const std::vector<std::shared_ptr<Cmd>>& cmds) {
+  std::vector<storage::KeyValue> kvs;
+  kvs.reserve(cmds.size());
+  for (const auto& cmd : cmds) {
+    auto set_cmd = std::static_pointer_cast<SetCmd>(cmd);
+    kvs.push_back({set_cmd->key_, set_cmd->value_});
+  }
+  rocksdb::Status s = db_->storage()->MSet(kvs);
+  for (const auto& cmd : cmds) {
+    auto set_cmd = std::static_pointer_cast<SetCmd>(cmd);
+    set_cmd->s_ = s;
+    if (s.ok()) {
+      set_cmd->res_.SetRes(CmdRes::kOk);
+      AddSlotKey("k", set_cmd->key_, db_);
+    } else {
+      set_cmd->res_.SetRes(CmdRes::kErrOther, s.ToString());
+    }
+  }
+}
+
 void SetCmd::DoUpdateCache() {
   if (SetCmd::kNX == condition_) {
     return;
@@ -666,23 +686,25 @@ void KeysCmd::DoInitial() {
 
 void KeysCmd::Do() {
   int64_t total_key = 0;
-  int64_t cursor = 0;
   size_t raw_limit = g_pika_conf->max_client_response_size();
   std::string raw;
-  std::vector<std::string> keys;
-  do {
-    keys.clear();
-    cursor = db_->storage()->Scan(type_, cursor, pattern_, PIKA_SCAN_STEP_LENGTH, &keys);
-    for (const auto& key : keys) {
-      RedisAppendLenUint64(raw, key.size(), "$");
-      RedisAppendContent(raw, key);
-    }
-    if (raw.size() >= raw_limit) {
-      res_.SetRes(CmdRes::kErrOther, "Response exceeds the max-client-response-size limit");
-      return;
-    }
-    total_key += static_cast<int64_t>(keys.size());
-  } while (cursor != 0);
+  bool exceeded = false;
+  // Keys are encoded as they come, the scan stops once the response is too large
+  rocksdb::Status s = db_->storage()->ScanKeys(type_, pattern_, [&](const std::string& key) {
+    RedisAppendLenUint64(raw, key.size(), "$");
+    RedisAppendContent(raw, key);
+    total_key++;
+    exceeded = raw.size() >= raw_limit;
+    return !exceeded;
+  });
+  if (exceeded) {
+    res_.SetRes(CmdRes::kErrOther, "Response exceeds the max-client-response-size limit");
+    return;
+  }
+  if (!s.ok()) {
+    res_.SetRes(CmdRes::kErrOther, s.ToString());
+    return;
+  }
 
   res_.AppendArrayLen(total_key);
   res_.AppendStringRaw(raw);
@@ -11,7 +11,7 @@
 #include "include/pika_server.h"
 #include "include/pika_slot_command.h"
 #include "pstd/include/pstd_string.h"
-#include "scope_record_lock.h"
+#include "pstd/include/record_lock_mgr.h"
 
 extern PikaServer* g_pika_server;
 extern std::unique_ptr<PikaReplicaManager> g_pika_rm;
@@ -183,7 +183,7 @@ void BlockingBaseCmd::ServeAndUnblockConns(void* args) {
   auto& key_to_conns_ = dispatchThread->GetMapFromKeyToConns();
   net::BlockKey blrPop_key{db->GetDBName(), key};
 
-  pstd::lock::ScopeRecordLock record_lock(db->LockMgr(), key);//It's a RAII Lock
+  pstd::lock::RecordLockGuard record_lock(db->LockMgr(), key, pstd::lock::LockMode::kExclusive);//It's a RAII Lock
   std::unique_lock map_lock(dispatchThread->GetBlockMtx());// do not change the sequence of these two lock, or deadlock will happen
   auto it = key_to_conns_.find(blrPop_key);
   if (it == key_to_conns_.end()) {
@@ -507,8 +507,8 @@ void LRangeCmd::Do() {
   s_ = db_->storage()->LRange(key_, left_, right_, &values);
   if (s_.ok()) {
     res_.AppendArrayLenUint64(values.size());
-    for (const auto& value : values) {
-      res_.AppendString(value);
+    for (auto& value : values) {
+      res_.AppendString(std::move(value));
     }
   } else if (s_.IsInvalidArgument()) {
     res_.SetRes(CmdRes::kMultiKey);
@@ -524,8 +524,8 @@ void LRangeCmd::ReadCache() {
   auto s = db_->cache()->LRange(key_, left_, right_, &values);
   if (s.ok()) {
     res_.AppendArrayLen(values.size());
-    for (const auto& value : values) {
-      res_.AppendString(value);
+    for (auto& value : values) {
+      res_.AppendString(std::move(value));
     }
   } else if (s.IsNotFound()) {
     res_.SetRes(CmdRes::kCacheMiss);
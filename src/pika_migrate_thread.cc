@@ -708,9 +708,8 @@ void PikaMigrateThread::GetMigrateStatus(std::string *ip, int64_t* port, int64_t
   *slot = slot_id_;
   std::unique_lock lq(mgrtkeys_queue_mutex_);
   int64_t migrating_keys_num = static_cast<int32_t>(mgrtkeys_queue_.size());
-  std::string slotKey = GetSlotKey(static_cast<int32_t>(slot_id_));
   int32_t slot_size = 0;
-  rocksdb::Status s = db_->storage()->SCard(slotKey, &slot_size);
+  rocksdb::Status s = GetSlotKeyNum(static_cast<uint32_t>(slot_id_), &slot_size, db_);
   if (s.ok()) {
     *remained = slot_size + migrating_keys_num;
   } else {
@@ -806,10 +805,14 @@ void PikaMigrateThread::ReadSlotKeys(const std::string &slotKey, int64_t need_re
   int32_t is_member = 0;
   std::vector<std::string> members;
 
-  rocksdb::Status s = db_->storage()->SScan(slotKey, cursor_, "*", need_read_num, &members, &cursor_);
+  rocksdb::Status s = ScanSlotKeys(static_cast<uint32_t>(slot_id_), cursor_, "*", need_read_num, &members, &cursor_, db_);
   if (s.ok() && 0 < members.size()) {
     for (const auto &member : members) {
-      db_->storage()->SIsmember(slotKey, member, &is_member);
+      if (g_pika_conf->slot_key_prefix()) {
+        is_member = 1;
+      } else {
+        db_->storage()->SIsmember(slotKey, member, &is_member);
+      }
       if (is_member) {
         key = member;
         key_type = key.at(0);
@@ -883,7 +886,7 @@ void *PikaMigrateThread::ThreadMain() {
 
   std::string slotKey = GetSlotKey(static_cast<int32_t>(slot_id_));
   int32_t slot_size = 0;
-  db_->storage()->SCard(slotKey, &slot_size);
+  GetSlotKeyNum(static_cast<uint32_t>(slot_id_), &slot_size, db_);
 
   while (!should_exit_) {
     // Waiting migrate task
@@ -907,6 +910,10 @@ void *PikaMigrateThread::ThreadMain() {
     int32_t is_finish = 0;
     send_num_ = 0;
     response_num_ = 0;
+    // migrated keys are gone from the slot range, so the offset restarts every round
+    if (g_pika_conf->slot_key_prefix()) {
+      cursor_ = 0;
+    }
     do {
       std::unique_lock lq(mgrtkeys_queue_mutex_);
       std::unique_lock lo(mgrtone_queue_mutex_);
@@ -962,7 +969,7 @@ void *PikaMigrateThread::ThreadMain() {
 
     // check slot migrate finish
     int32_t slot_remained_keys = 0;
-    db_->storage()->SCard(slotKey, &slot_remained_keys);
+    GetSlotKeyNum(static_cast<uint32_t>(slot_id_), &slot_remained_keys, db_);
     if (0 == slot_remained_keys) {
       LOG(INFO) << "PikaMigrateThread::ThreadMain slot_size:" << slot_size << " moved_num:" << moved_num_;
       if (slot_size != moved_num_) {
@@ -10,7 +10,7 @@
 #include "include/pika_rm.h"
 #include "include/pika_server.h"
 #include "pstd/include/pstd_defer.h"
-#include "src/pstd/include/scope_record_lock.h"
+#include "src/pstd/include/record_lock_mgr.h"
 #include "include/pika_conf.h"
 
 extern PikaServer* g_pika_server;
@@ -192,7 +192,7 @@ int PikaReplBgWorker::HandleWriteBinlog(net::RedisParser* parser, const net::Red
     return -1;
   }
 
-  g_pika_server->UpdateQueryNumAndExecCountDB(worker->db_name_, opt, c_ptr->is_write());
+  g_pika_server->UpdateQueryNumAndExecCountDB(worker->db_name_, c_ptr->GetCmdId(), c_ptr->is_write());
 
   std::shared_ptr<SyncMasterDB> db =
       g_pika_rm->GetSyncMasterDBByName(DBInfo(worker->db_name_));
@@ -216,8 +216,8 @@ void PikaReplBgWorker::HandleBGWorkerWriteDB(void* arg) {
     start_us = pstd::NowMicros();
   }
   // Add read lock for no suspend command
-  pstd::lock::MultiRecordLock record_lock(c_ptr->GetDB()->LockMgr());
-  record_lock.Lock(c_ptr->current_key());
+  pstd::lock::RecordLockGuard record_lock(c_ptr->GetDB()->LockMgr(), c_ptr->current_key(),
+                                         pstd::lock::LockMode::kExclusive);
   if (!c_ptr->IsSuspend()) {
     c_ptr->GetDB()->DBLockShared();
   }
@@ -256,7 +256,7 @@ void PikaReplBgWorker::HandleBGWorkerWriteDB(void* arg) {
     }
   }
 
-  record_lock.Unlock(c_ptr->current_key());
+  record_lock.Unlock();
   if (g_pika_conf->slowlog_slower_than() >= 0) {
     auto start_time = static_cast<int32_t>(start_us / 1000000);
     auto duration = static_cast<int64_t>(pstd::NowMicros() - start_us);
@@ -163,6 +163,8 @@ Status PikaReplClient::SendMetaSync() {
   if (!masterauth.empty()) {
     meta_sync->set_auth(masterauth);
   }
+  meta_sync->add_compression(InnerMessage::kLZ4Compression);
+  meta_sync->add_compression(InnerMessage::kZSTDCompression);
 
   std::string to_send;
   std::string master_ip = g_pika_server->master_ip();
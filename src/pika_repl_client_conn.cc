@@ -9,6 +9,7 @@
 #include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 #include <sys/time.h>
 
+#include "include/pika_repl_compression.h"
 #include "include/pika_rm.h"
 #include "include/pika_server.h"
 #include "pstd/include/pstd_string.h"
@@ -49,6 +50,17 @@ int PikaReplClientConn::DealMessage() {
     g_pika_server->SyncError();
     return -1;
   }
+  if (response->has_compressed_frame()) {
+    // A compressed BinlogSync frame, its binlog_sync are in the InnerResponse it holds
+    std::shared_ptr<InnerMessage::InnerResponse> frame = std::make_shared<InnerMessage::InnerResponse>();
+    if (!ReplDecompressFrame(*response, g_pika_conf->max_conn_rbuf_size(), frame.get())) {
+      LOG(WARNING) << "Decompress " << ReplCompressionName(response->compression())
+                   << " BinlogSync frame FAILED! msg_len: " << header_len_;
+      g_pika_server->SyncError();
+      return -1;
+    }
+    response = frame;
+  }
   switch (response->type()) {
     case InnerMessage::kMetaSync: {
       auto task_arg =
@@ -109,6 +121,7 @@ void PikaReplClientConn::HandleMetaSyncResponse(void* arg) {
   }
 
   const InnerMessage::InnerResponse_MetaSync meta_sync = response->meta_sync();
+  LOG(INFO) << "Master sends binlog with " << ReplCompressionName(meta_sync.compression()) << " compression";
 
   std::vector<DBStruct> master_db_structs;
   for (int idx = 0; idx < meta_sync.dbs_info_size(); ++idx) {
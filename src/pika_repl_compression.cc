@@ -0,0 +1,117 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "include/pika_repl_compression.h"
+
+#include <lz4.h>
+#include <zstd.h>
+
+#include <cstdint>
+
+// Replication favours speed, frames are compressed on the sending thread
+static constexpr int kReplZstdLevel = 1;
+
+const char* ReplCompressionName(InnerMessage::CompressionType type) {
+  switch (type) {
+    case InnerMessage::kLZ4Compression:
+      return "lz4";
+    case InnerMessage::kZSTDCompression:
+      return "zstd";
+    default:
+      return "none";
+  }
+}
+
+bool ReplCompressionFromName(const std::string& name, InnerMessage::CompressionType* type) {
+  if (name == "none") {
+    *type = InnerMessage::kNoCompression;
+  } else if (name == "lz4") {
+    *type = InnerMessage::kLZ4Compression;
+  } else if (name == "zstd") {
+    *type = InnerMessage::kZSTDCompression;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool ReplCompress(InnerMessage::CompressionType type, const std::string& raw, std::string* compressed) {
+  switch (type) {
+    case InnerMessage::kLZ4Compression: {
+      if (raw.size() > LZ4_MAX_INPUT_SIZE) {
+        return false;
+      }
+      compressed->resize(LZ4_compressBound(static_cast<int>(raw.size())));
+      int size = LZ4_compress_default(raw.data(), compressed->data(), static_cast<int>(raw.size()),
+                                      static_cast<int>(compressed->size()));
+      if (size <= 0) {
+        return false;
+      }
+      compressed->resize(size);
+      return true;
+    }
+    case InnerMessage::kZSTDCompression: {
+      compressed->resize(ZSTD_compressBound(raw.size()));
+      size_t size = ZSTD_compress(compressed->data(), compressed->size(), raw.data(), raw.size(), kReplZstdLevel);
+      if (ZSTD_isError(size) != 0U) {
+        return false;
+      }
+      compressed->resize(size);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+bool ReplDecompress(InnerMessage::CompressionType type, const std::string& compressed, size_t raw_size,
+                    std::string* raw) {
+  raw->resize(raw_size);
+  switch (type) {
+    case InnerMessage::kLZ4Compression: {
+      if (raw_size > LZ4_MAX_INPUT_SIZE) {
+        return false;
+      }
+      int size = LZ4_decompress_safe(compressed.data(), raw->data(), static_cast<int>(compressed.size()),
+                                     static_cast<int>(raw_size));
+      return size >= 0 && static_cast<size_t>(size) == raw_size;
+    }
+    case InnerMessage::kZSTDCompression: {
+      size_t size = ZSTD_decompress(raw->data(), raw_size, compressed.data(), compressed.size());
+      return ZSTD_isError(size) == 0U && size == raw_size;
+    }
+    default:
+      return false;
+  }
+}
+
+bool ReplCompressFrame(InnerMessage::CompressionType type, const std::string& frame, std::string* wire) {
+  if (frame.size() < kReplCompressMinBytes || frame.size() > UINT32_MAX) {
+    return false;
+  }
+  std::string compressed;
+  // Not worth it, the slave takes uncompressed frames as well
+  if (!ReplCompress(type, frame, &compressed) || compressed.size() >= frame.size()) {
+    return false;
+  }
+  InnerMessage::InnerResponse response;
+  response.set_code(InnerMessage::kOk);
+  response.set_type(InnerMessage::Type::kBinlogSync);
+  response.set_compression(type);
+  response.set_compressed_frame(std::move(compressed));
+  response.set_raw_frame_size(static_cast<uint32_t>(frame.size()));
+  return response.SerializeToString(wire);
+}
+
+bool ReplDecompressFrame(const InnerMessage::InnerResponse& response, size_t max_raw_size,
+                         InnerMessage::InnerResponse* frame) {
+  // Checked before the buffer of the frame is allocated
+  if (response.raw_frame_size() > max_raw_size) {
+    return false;
+  }
+  std::string raw;
+  return ReplDecompress(response.compression(), response.compressed_frame(), response.raw_frame_size(), &raw) &&
+         frame->ParseFromString(raw);
+}
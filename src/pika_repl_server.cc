@@ -8,6 +8,7 @@
 #include <glog/logging.h>
 
 #include "include/pika_conf.h"
+#include "include/pika_repl_compression.h"
 #include "include/pika_rm.h"
 #include "include/pika_server.h"
 
@@ -70,14 +71,26 @@ pstd::Status PikaReplServer::SendSlaveBinlogChips(const std::string& ip, int por
       if (!response.SerializeToString(&binlog_chip_pb)) {
         return Status::Corruption("Serialized Failed");
       }
-      pstd::Status s = Write(ip, port, binlog_chip_pb);
+      pstd::Status s = WriteBinlogFrame(ip, port, binlog_chip_pb);
       if (!s.ok()) {
         return s;
       }
     }
     return pstd::Status::OK();
   }
-  return Write(ip, port, binlog_chip_pb);
+  return WriteBinlogFrame(ip, port, binlog_chip_pb);
+}
+
+pstd::Status PikaReplServer::WriteBinlogFrame(const std::string& ip, int port, const std::string& frame) {
+  const std::string ip_port = pstd::IpPortString(ip, port);
+  InnerMessage::CompressionType compression = g_pika_rm->SlaveCompression(ip_port);
+  std::string compressed_pb;
+  if (compression == InnerMessage::kNoCompression || !ReplCompressFrame(compression, frame, &compressed_pb)) {
+    g_pika_rm->AddSlaveFrame(ip_port, frame.size(), frame.size());
+    return Write(ip, port, frame);
+  }
+  g_pika_rm->AddSlaveFrame(ip_port, frame.size(), compressed_pb.size());
+  return Write(ip, port, compressed_pb);
 }
 
 void PikaReplServer::BuildBinlogOffset(const LogOffset& offset, InnerMessage::BinlogOffset* boffset) {
@@ -135,14 +148,22 @@ void PikaReplServer::UpdateClientConnMap(const std::string& ip_port, int fd) {
 }
 
 void PikaReplServer::RemoveClientConn(int fd) {
-  std::lock_guard l(client_conn_rwlock_);
-  auto iter = client_conn_map_.begin();
-  while (iter != client_conn_map_.end()) {
-    if (iter->second == fd) {
-      iter = client_conn_map_.erase(iter);
-      break;
+  std::string ip_port;
+  {
+    std::lock_guard l(client_conn_rwlock_);
+    auto iter = client_conn_map_.begin();
+    while (iter != client_conn_map_.end()) {
+      if (iter->second == fd) {
+        ip_port = iter->first;
+        iter = client_conn_map_.erase(iter);
+        break;
+      }
+      iter++;
     }
-    iter++;
+  }
+  // The slave negotiates its compression again when it reconnects
+  if (!ip_port.empty()) {
+    g_pika_rm->RemoveSlaveFrames(ip_port);
   }
 }
 
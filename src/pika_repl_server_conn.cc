@@ -7,6 +7,7 @@
 
 #include <glog/logging.h>
 
+#include "include/pika_repl_compression.h"
 #include "include/pika_rm.h"
 #include "include/pika_server.h"
 
@@ -55,6 +56,20 @@ void PikaReplServerConn::HandleMetaSyncRequest(void* arg) {
       meta_sync->set_classic_mode(g_pika_conf->classic_mode());
       meta_sync->set_run_id(g_pika_conf->run_id());
       meta_sync->set_replication_id(g_pika_conf->replication_id());
+      // Compress the binlog if the slave supports the codec we use
+      InnerMessage::CompressionType compression = InnerMessage::kNoCompression;
+      InnerMessage::CompressionType wanted = InnerMessage::kNoCompression;
+      ReplCompressionFromName(g_pika_conf->repl_compression(), &wanted);
+      for (int idx = 0; idx < meta_sync_request.compression_size(); ++idx) {
+        if (meta_sync_request.compression(idx) == wanted) {
+          compression = wanted;
+        }
+      }
+      g_pika_rm->SetSlaveCompression(ip_port, compression);
+      if (compression != InnerMessage::kNoCompression) {
+        meta_sync->set_compression(compression);
+      }
+      LOG(INFO) << "Slave " << ip_port << " replicates with " << ReplCompressionName(compression) << " compression";
       for (const auto& db_struct : db_structs) {
         InnerMessage::InnerResponse_MetaSync_DBInfo* db_info = meta_sync->add_dbs_info();
         db_info->set_db_name(db_struct.db_name);
@@ -140,6 +140,28 @@ Status SyncMasterDB::ActivateSlaveDbSync(const std::string& ip, int port) {
   return Status::OK();
 }
 
+bool SyncMasterDB::ReadBinlogTailToWq(const std::shared_ptr<SlaveNode>& slave_ptr, int cnt,
+                                      std::vector<WriteTask>* tasks) {
+  const size_t max_bytes = PIKA_MAX_CONN_RBUF_HB * 2;
+  size_t win_bytes = slave_ptr->sync_win.GetTotalBinlogSize();
+  if (win_bytes > max_bytes) {
+    LOG(INFO) << slave_ptr->ToString() << " total binlog size in sync window is :" << win_bytes;
+    return true;
+  }
+  std::vector<BinlogTailCache::Record> records;
+  if (!Logger()->tail_cache()->Read(slave_ptr->sent_offset.b_offset, cnt, max_bytes - win_bytes, &records)) {
+    return false;
+  }
+  RmNode rm_node(slave_ptr->Ip(), slave_ptr->Port(), slave_ptr->DBName(), slave_ptr->SessionId());
+  for (auto& record : records) {
+    slave_ptr->sync_win.Push(SyncWinItem(record.offset, record.binlog.size()));
+    slave_ptr->SetLastSendTime(pstd::NowMicros());
+    tasks->emplace_back(rm_node, BinlogChip(record.offset, std::move(record.binlog)), slave_ptr->sent_offset);
+    slave_ptr->sent_offset = record.offset;
+  }
+  return true;
+}
+
 Status SyncMasterDB::ReadBinlogFileToWq(const std::shared_ptr<SlaveNode>& slave_ptr) {
   int cnt = slave_ptr->sync_win.Remaining();
   std::shared_ptr<PikaBinlogReader> reader = slave_ptr->binlog_reader;
@@ -147,6 +169,23 @@ Status SyncMasterDB::ReadBinlogFileToWq(const std::shared_ptr<SlaveNode>& slave_
     return Status::OK();
   }
   std::vector<WriteTask> tasks;
+  if (ReadBinlogTailToWq(slave_ptr, cnt, &tasks)) {
+    if (!tasks.empty()) {
+      g_pika_rm->ProduceWriteQueue(slave_ptr->Ip(), slave_ptr->Port(), db_info_.db_name_, tasks);
+    }
+    return Status::OK();
+  }
+
+  // The reader stays where it was while records are sent from the tail cache
+  uint32_t reader_filenum = 0;
+  uint64_t reader_offset = 0;
+  reader->GetReaderStatus(&reader_filenum, &reader_offset);
+  if (BinlogOffset(reader_filenum, reader_offset) != slave_ptr->sent_offset.b_offset) {
+    const BinlogOffset& sent_b_offset = slave_ptr->sent_offset.b_offset;
+    if (reader->Seek(Logger(), sent_b_offset.filenum, sent_b_offset.offset) != 0) {
+      return Status::Corruption(slave_ptr->ToString() + " binlog reader seek failed");
+    }
+  }
   for (int i = 0; i < cnt; ++i) {
     std::string msg;
     uint32_t filenum;
@@ -384,6 +423,10 @@ Status SyncMasterDB::ConsensusProposeLog(const std::shared_ptr<Cmd>& cmd_ptr) {
   return coordinator_.ProposeLog(cmd_ptr);
 }
 
+Status SyncMasterDB::ConsensusProposeLogs(const std::vector<std::shared_ptr<Cmd>>& cmds) {
+  return coordinator_.ProposeLogs(cmds);
+}
+
 Status SyncMasterDB::ConsensusProcessLeaderLog(const std::shared_ptr<Cmd>& cmd_ptr, const BinlogItem& attribute) {
   return coordinator_.ProcessLeaderLog(cmd_ptr, attribute);
 }
@@ -581,39 +624,62 @@ void PikaReplicaManager::InitDB() {
 
 void PikaReplicaManager::ProduceWriteQueue(const std::string& ip, int port, std::string db_name,
                                            const std::vector<WriteTask>& tasks) {
+  const uint64_t now = pstd::NowMicros();
   std::lock_guard l(write_queue_mu_);
   std::string index = ip + ":" + std::to_string(port);
+  WriteQueue& queue = write_queues_[index][db_name];
   for (auto& task : tasks) {
-    write_queues_[index][db_name].push(task);
+    queue.tasks.push(task);
+    queue.tasks.back().enqueue_us_ = now;
+    queue.bytes += task.binlog_chip_.binlog_.size();
   }
 }
 
 int PikaReplicaManager::ConsumeWriteQueue() {
   std::unordered_map<std::string, std::vector<std::vector<WriteTask>>> to_send_map;
   int counter = 0;
+  const uint64_t now = pstd::NowMicros();
+  const auto max_delay_us = static_cast<uint64_t>(g_pika_conf->repl_batch_max_delay_us());
+  const auto compressed_batch_bytes = static_cast<size_t>(g_pika_conf->repl_batch_max_bytes());
+  uint64_t due_us = 0;
   {
     std::lock_guard l(write_queue_mu_);
     for (auto& iter : write_queues_) {
       const std::string& ip_port = iter.first;
-      std::unordered_map<std::string, std::queue<WriteTask>>& p_map = iter.second;
+      // Frames to a slave using compression pack records by bytes, the more
+      // records in a frame the better it compresses
+      const bool compressed = SlaveCompression(ip_port) != InnerMessage::kNoCompression;
+      const size_t max_batch_num = compressed ? kBinlogSendCompressedBatchNum : kBinlogSendBatchNum;
+      // make sure SerializeToString will not over 2G
+      const size_t max_batch_bytes = compressed ? compressed_batch_bytes : PIKA_MAX_CONN_RBUF_HB;
+      std::unordered_map<std::string, WriteQueue>& p_map = iter.second;
       for (auto& db_queue : p_map) {
-        std::queue<WriteTask>& queue = db_queue.second;
+        WriteQueue& queue = db_queue.second;
         for (int i = 0; i < kBinlogSendPacketNum; ++i) {
-          if (queue.empty()) {
+          if (queue.tasks.empty()) {
             break;
           }
-          size_t batch_index = queue.size() > kBinlogSendBatchNum ? kBinlogSendBatchNum : queue.size();
+          // Hold back a frame that is not full yet until its first record is due
+          if (compressed && max_delay_us > 0 && queue.bytes < max_batch_bytes) {
+            uint64_t waited_us = now - std::min(now, queue.tasks.front().enqueue_us_);
+            if (waited_us < max_delay_us) {
+              uint64_t wait_us = max_delay_us - waited_us;
+              due_us = due_us == 0 ? wait_us : std::min(due_us, wait_us);
+              break;
+            }
+          }
+          size_t batch_index = std::min(queue.tasks.size(), max_batch_num);
           std::vector<WriteTask> to_send;
           size_t batch_size = 0;
           for (size_t i = 0; i < batch_index; ++i) {
-            WriteTask& task = queue.front();
+            WriteTask& task = queue.tasks.front();
             batch_size += task.binlog_chip_.binlog_.size();
-            // make sure SerializeToString will not over 2G
-            if (batch_size > PIKA_MAX_CONN_RBUF_HB) {
+            if (batch_size > max_batch_bytes && !to_send.empty()) {
               break;
             }
-            to_send.push_back(task);
-            queue.pop();
+            queue.bytes -= task.binlog_chip_.binlog_.size();
+            to_send.push_back(std::move(task));
+            queue.tasks.pop();
             counter++;
           }
           if (!to_send.empty()) {
@@ -623,6 +689,7 @@ int PikaReplicaManager::ConsumeWriteQueue() {
       }
     }
   }
+  write_queue_due_us_.store(due_us, std::memory_order_relaxed);
 
   std::vector<std::string> to_delete;
   for (auto& iter : to_send_map) {
@@ -665,6 +732,38 @@ void PikaReplicaManager::DropItemInWriteQueue(const std::string& ip, int port) {
   write_queues_.erase(index);
 }
 
+void PikaReplicaManager::SetSlaveCompression(const std::string& ip_port, InnerMessage::CompressionType compression) {
+  std::lock_guard l(slave_frames_mu_);
+  SlaveFrameStats& stats = slave_frames_[ip_port];
+  stats = SlaveFrameStats();
+  stats.compression = compression;
+}
+
+InnerMessage::CompressionType PikaReplicaManager::SlaveCompression(const std::string& ip_port) {
+  std::lock_guard l(slave_frames_mu_);
+  auto iter = slave_frames_.find(ip_port);
+  return iter == slave_frames_.end() ? InnerMessage::kNoCompression : iter->second.compression;
+}
+
+void PikaReplicaManager::AddSlaveFrame(const std::string& ip_port, uint64_t raw_bytes, uint64_t wire_bytes) {
+  std::lock_guard l(slave_frames_mu_);
+  SlaveFrameStats& stats = slave_frames_[ip_port];
+  stats.frames++;
+  stats.raw_bytes += raw_bytes;
+  stats.wire_bytes += wire_bytes;
+}
+
+PikaReplicaManager::SlaveFrameStats PikaReplicaManager::GetSlaveFrameStats(const std::string& ip_port) {
+  std::lock_guard l(slave_frames_mu_);
+  auto iter = slave_frames_.find(ip_port);
+  return iter == slave_frames_.end() ? SlaveFrameStats() : iter->second;
+}
+
+void PikaReplicaManager::RemoveSlaveFrames(const std::string& ip_port) {
+  std::lock_guard l(slave_frames_mu_);
+  slave_frames_.erase(ip_port);
+}
+
 void PikaReplicaManager::ScheduleReplServerBGTask(net::TaskFunc func, void* arg) {
   pika_repl_server_->Schedule(func, arg);
 }
@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <ctime>
 #include <fstream>
+#include <iomanip>
 #include <memory>
 #include <utility>
 #include "net/include/net_cli.h"
@@ -18,13 +19,16 @@
 #include "pstd/include/env.h"
 #include "pstd/include/rsync.h"
 #include "pstd/include/pika_codis_slot.h"
+#include "rocksdb/file_checksum.h"
 
 #include "include/pika_cmd_table_manager.h"
 #include "include/pika_dispatch_thread.h"
 #include "include/pika_instant.h"
 #include "include/pika_monotonic_time.h"
+#include "include/pika_repl_compression.h"
 #include "include/pika_rm.h"
 #include "include/pika_server.h"
+#include "include/rsync_sst_identity.h"
 
 using pstd::Status;
 extern PikaServer* g_pika_server;
@@ -41,11 +45,65 @@ void DoPurgeDir(void* arg) {
   LOG(INFO) << "Delete dir: " << *path << " done";
 }
 
+// Serves the last bgsave of each DB to the rsync clients of the slaves
+class PikaRsyncDumpProvider : public rsync::RsyncDumpProvider {
+ public:
+  explicit PikaRsyncDumpProvider(PikaServer* server) : server_(server) {}
+
+  Status GetDumpMeta(const std::string& db_name, std::string* snapshot_uuid,
+                     RsyncService::MetaResponse* meta) override {
+    std::shared_ptr<DB> db = server_->GetDB(db_name);
+    if (!db) {
+      return Status::NotFound("db " + db_name + " not found");
+    }
+    if (db->IsBgSaving()) {
+      return Status::Busy("db " + db_name + " is doing bgsave");
+    }
+    std::vector<std::string> filenames;
+    Status s = server_->GetDumpMeta(db_name, &filenames, snapshot_uuid);
+    if (!s.ok()) {
+      return s;
+    }
+    for (const auto& filename : filenames) {
+      meta->add_filenames(filename);
+    }
+    rsync::SstIdentityMap ssts;
+    if (rsync::ReadDumpSstIdentities(db->bgsave_info().path, &ssts).ok()) {
+      for (const auto& sst : ssts) {
+        RsyncService::FileMeta* file_meta = meta->add_sst_files();
+        file_meta->set_filename(sst.first);
+        file_meta->set_size(sst.second.size);
+        file_meta->set_checksum_func(sst.second.checksum_func);
+        file_meta->set_checksum(sst.second.checksum);
+        file_meta->set_unique_id(sst.second.unique_id);
+      }
+    }
+    return Status::OK();
+  }
+
+  Status GetDumpPath(const std::string& db_name, std::string* snapshot_uuid, std::string* dump_path) override {
+    Status s = server_->GetDumpUUID(db_name, snapshot_uuid);
+    if (!s.ok()) {
+      return s;
+    }
+    std::shared_ptr<DB> db = server_->GetDB(db_name);
+    if (!db) {
+      return Status::NotFound("db " + db_name + " not found");
+    }
+    *dump_path = db->bgsave_info().path;
+    return Status::OK();
+  }
+
+ private:
+  PikaServer* server_ = nullptr;
+};
+
 PikaServer::PikaServer()
     : exit_(false),
       slow_cmd_thread_pool_flag_(g_pika_conf->slow_cmd_pool()),
       last_check_compact_time_({0, 0}),
       last_check_resume_time_({0, 0}),
+      last_reap_time_(0),
       repl_state_(PIKA_REPL_NO_CONNECT),
       role_(PIKA_ROLE_SINGLE) {
   // Init server ip host
@@ -69,18 +127,21 @@ PikaServer::PikaServer()
   int worker_queue_limit = g_pika_conf->maxclients() / worker_num_ + 100;
   LOG(INFO) << "Worker queue limit is " << worker_queue_limit;
   for_each(ips.begin(), ips.end(), [](auto& ip) { LOG(WARNING) << ip; });
+  net::SetNetBackend(g_pika_conf->io_uring() ? net::NetBackend::kIoUring : net::NetBackend::kEpoll);
   pika_dispatch_thread_ = std::make_unique<PikaDispatchThread>(ips, port_, worker_num_, 3000, worker_queue_limit,
                                                                g_pika_conf->max_conn_rbuf_size());
   pika_rsync_service_ =
       std::make_unique<PikaRsyncService>(g_pika_conf->db_sync_path(), g_pika_conf->port() + kPortShiftRSync);
   // TODO: remove pika_rsync_service_，reuse pika_rsync_service_ port
-  rsync_server_ = std::make_unique<rsync::RsyncServer>(ips, port_ + kPortShiftRsync2);
+  rsync_server_ = std::make_unique<rsync::RsyncServer>(ips, port_ + kPortShiftRsync2,
+                                                       std::make_unique<PikaRsyncDumpProvider>(this));
   pika_pubsub_thread_ = std::make_unique<net::PubSubThread>();
   pika_auxiliary_thread_ = std::make_unique<PikaAuxiliaryThread>();
   pika_migrate_ = std::make_unique<PikaMigrate>();
   pika_migrate_thread_ = std::make_unique<PikaMigrateThread>();
 
-  pika_client_processor_ = std::make_unique<PikaClientProcessor>(g_pika_conf->thread_pool_size(), 100000);
+  pika_client_processor_ = std::make_unique<PikaClientProcessor>(g_pika_conf->thread_pool_size(), 100000,
+                                                                 g_pika_conf->work_stealing_pool());
   pika_slow_cmd_thread_pool_ = std::make_unique<net::ThreadPool>(g_pika_conf->slow_cmd_thread_pool_size(), 100000);
   pika_admin_cmd_thread_pool_ = std::make_unique<net::ThreadPool>(g_pika_conf->admin_thread_pool_size(), 100000);
   instant_ = std::make_unique<Instant>();
@@ -472,6 +533,15 @@ void PikaServer::DBSetSmallCompactionDurationThreshold(uint32_t small_compaction
   }
 }
 
+void PikaServer::DBSetZSetRankIndexThreshold(uint32_t zset_rank_index_threshold) {
+  std::shared_lock rwl(dbs_rw_);
+  for (const auto& db_item : dbs_) {
+    db_item.second->DBLockShared();
+    db_item.second->storage()->SetZSetsRankIndexThreshold(zset_rank_index_threshold);
+    db_item.second->DBUnlockShared();
+  }
+}
+
 bool PikaServer::GetDBBinlogOffset(const std::string& db_name, BinlogOffset* const boffset) {
   std::shared_ptr<SyncMasterDB> db = g_pika_rm->GetSyncMasterDBByName(DBInfo(db_name));
   if (!db) {
@@ -584,7 +654,16 @@ int32_t PikaServer::GetSlaveListString(std::string& slave_list_str) {
   std::lock_guard l(slave_mutex_);
   std::shared_ptr<SyncMasterDB> master_db = nullptr;
   for (const auto& slave : slaves_) {
+    PikaReplicaManager::SlaveFrameStats frame_stats =
+        g_pika_rm->GetSlaveFrameStats(slave.ip_port);
     tmp_stream << "slave" << index++ << ":ip=" << slave.ip << ",port=" << slave.port << ",conn_fd=" << slave.conn_fd
+               << ",repl_compression=" << ReplCompressionName(frame_stats.compression)
+               << ",repl_frames=" << frame_stats.frames << ",repl_raw_bytes=" << frame_stats.raw_bytes
+               << ",repl_wire_bytes=" << frame_stats.wire_bytes << ",repl_compression_ratio=" << std::fixed
+               << std::setprecision(2)
+               << (frame_stats.wire_bytes == 0
+                       ? 1.0
+                       : static_cast<double>(frame_stats.raw_bytes) / static_cast<double>(frame_stats.wire_bytes))
                << ",lag=";
     for (const auto& ts : slave.db_structs) {
       std::shared_ptr<SyncMasterDB> db = g_pika_rm->GetSyncMasterDBByName(DBInfo(ts.db_name));
@@ -735,7 +814,8 @@ void PikaServer::SetFirstMetaSync(bool v) {
   first_meta_sync_ = v;
 }
 
-void PikaServer::ScheduleClientPool(net::TaskFunc func, void* arg, bool is_slow_cmd, bool is_admin_cmd) {
+void PikaServer::ScheduleClientPool(net::TaskFunc func, void* arg, bool is_slow_cmd, bool is_admin_cmd,
+                                    uint64_t affinity) {
   if (is_slow_cmd && g_pika_conf->slow_cmd_pool()) {
     pika_slow_cmd_thread_pool_->Schedule(func, arg);
     return;
@@ -744,7 +824,7 @@ void PikaServer::ScheduleClientPool(net::TaskFunc func, void* arg, bool is_slow_
     pika_admin_cmd_thread_pool_->Schedule(func, arg);
     return;
   }
-  pika_client_processor_->SchedulePool(func, arg);
+  pika_client_processor_->SchedulePool(func, arg, affinity);
 }
 
 size_t PikaServer::ClientProcessorThreadPoolCurQueueSize() {
@@ -761,6 +841,24 @@ size_t PikaServer::ClientProcessorThreadPoolMaxQueueSize() {
   return pika_client_processor_->ThreadPoolMaxQueueSize();
 }
 
+size_t PikaServer::ClientProcessorThreadPoolMaxWorkerQueueSize() {
+  if (!pika_client_processor_) {
+    return 0;
+  }
+  return pika_client_processor_->ThreadPoolMaxWorkerQueueSize();
+}
+
+uint64_t PikaServer::ClientProcessorThreadPoolStealCount() {
+  if (!pika_client_processor_) {
+    return 0;
+  }
+  return pika_client_processor_->ThreadPoolStealCount();
+}
+
+bool PikaServer::ClientProcessorWorkStealing() {
+  return pika_client_processor_ && pika_client_processor_->IsWorkStealing();
+}
+
 size_t PikaServer::SlowCmdThreadPoolCurQueueSize() {
   if (!pika_slow_cmd_thread_pool_) {
     return 0;
@@ -974,11 +1072,12 @@ uint64_t PikaServer::SlowlogCount() {
 
 void PikaServer::ResetStat() {
   statistic_.server_stat.accumulative_connections.store(0);
-  statistic_.server_stat.qps.querynum.store(0);
-  statistic_.server_stat.qps.last_querynum.store(0);
+  statistic_.server_stat.pipeline_write_batches.store(0);
+  statistic_.server_stat.pipeline_write_batched_cmds.store(0);
+  statistic_.ResetQueryNum();
 }
 
-uint64_t PikaServer::ServerQueryNum() { return statistic_.server_stat.qps.querynum.load(); }
+uint64_t PikaServer::ServerQueryNum() { return statistic_.QueryNum(); }
 
 uint64_t PikaServer::ServerCurrentQps() { return statistic_.server_stat.qps.last_sec_querynum.load(); }
 
@@ -986,17 +1085,28 @@ uint64_t PikaServer::accumulative_connections() { return statistic_.server_stat.
 
 void PikaServer::incr_accumulative_connections() { ++(statistic_.server_stat.accumulative_connections); }
 
+uint64_t PikaServer::pipeline_write_batches() { return statistic_.server_stat.pipeline_write_batches.load(); }
+
+uint64_t PikaServer::pipeline_write_batched_cmds() {
+  return statistic_.server_stat.pipeline_write_batched_cmds.load();
+}
+
+void PikaServer::incr_pipeline_write_batches(uint64_t cmds) {
+  statistic_.server_stat.pipeline_write_batches.fetch_add(1, std::memory_order_relaxed);
+  statistic_.server_stat.pipeline_write_batched_cmds.fetch_add(cmds, std::memory_order_relaxed);
+}
+
 // only one thread invoke this right now
 void PikaServer::ResetLastSecQuerynum() {
-  statistic_.server_stat.qps.ResetLastSecQuerynum();
-  statistic_.ResetDBLastSecQuerynum();
+  statistic_.ResetLastSecQuerynum();
+}
+
+void PikaServer::UpdateQueryNumAndExecCountDB(const std::string& db_name, uint32_t cmd_id, bool is_write) {
+  statistic_.UpdateDBQps(db_name, cmd_id, is_write);
 }
 
-void PikaServer::UpdateQueryNumAndExecCountDB(const std::string& db_name, const std::string& command, bool is_write) {
-  std::string cmd(command);
-  statistic_.server_stat.qps.querynum++;
-  statistic_.server_stat.exec_count_db[pstd::StringToUpper(cmd)]++;
-  statistic_.UpdateDBQps(db_name, command, is_write);
+void PikaServer::UpdateCmdTimeStat(uint32_t cmd_id, uint64_t queue_time, uint64_t process_time, uint64_t total_time) {
+  statistic_.UpdateCmdTimeStat(cmd_id, queue_time, process_time, total_time);
 }
 
 size_t PikaServer::NetInputBytes() { return g_network_statistic->NetInputBytes(); }
@@ -1025,12 +1135,23 @@ float PikaServer::InstantaneousOutputReplKbps() {
          1024.0f;
 }
 
-std::unordered_map<std::string, uint64_t> PikaServer::ServerExecCountDB() {
-  std::unordered_map<std::string, uint64_t> res;
-  for (auto& cmd : statistic_.server_stat.exec_count_db) {
-    res[cmd.first] = cmd.second.load();
+std::vector<uint64_t> PikaServer::WorkerAcceptedConns() {
+  return pika_dispatch_thread_->server_thread()->accepted_conns();
+}
+
+std::vector<uint64_t> PikaServer::InstantaneousWorkerAccepts() {
+  std::vector<uint64_t> accepts(WorkerAcceptedConns().size());
+  for (size_t i = 0; i < accepts.size(); i++) {
+    accepts[i] =
+        static_cast<uint64_t>(instant_->getInstantaneousMetric(STATS_METRIC_WORKER_ACCEPTS + std::to_string(i)));
   }
-  return res;
+  return accepts;
+}
+
+std::unordered_map<std::string, uint64_t> PikaServer::ServerExecCountDB() { return statistic_.ExecCount(); }
+
+std::map<std::string, CommandStatistics> PikaServer::ServerCmdStats(bool with_latency) {
+  return statistic_.CmdStats(with_latency);
 }
 
 std::unordered_map<std::string, QpsStatistic> PikaServer::ServerAllDBStat() { return statistic_.AllDBStat(); }
@@ -1085,6 +1206,8 @@ int PikaServer::ClientPubSubChannelPatternSize(const std::shared_ptr<NetConn>& c
 void PikaServer::DoTimingTask() {
   // Maybe schedule compactrange
   AutoCompactRange();
+  // Reap the keys expired since the last time
+  AutoReapExpiredKeys();
   // Purge log
   AutoPurge();
   // Delete expired dump
@@ -1096,7 +1219,6 @@ void PikaServer::DoTimingTask() {
   ResetLastSecQuerynum();
   // Auto update network instantaneous metric
   AutoUpdateNetworkMetric();
-  ProcessCronTask();
   UpdateCacheInfo();
   // Print the queue status periodically
   PrintThreadPoolQueueStatus();
@@ -1115,6 +1237,23 @@ void PikaServer::StatDiskUsage() {
   disk_statistic_.log_size_.store(pstd::Du(g_pika_conf->log_path()));
 }
 
+void PikaServer::AutoReapExpiredKeys() {
+  auto current_time = pstd::NowMicros();
+  uint64_t elapsed_us = last_reap_time_ == 0 ? 0 : current_time - last_reap_time_;
+  last_reap_time_ = current_time;
+  int64_t max_keys = static_cast<int64_t>(g_pika_conf->reap_expired_keys_per_sec() * elapsed_us / 1000000);
+  if (max_keys <= 0) {
+    return;
+  }
+
+  std::shared_lock db_rwl(dbs_rw_);
+  for (const auto& db_item : dbs_) {
+    db_item.second->DBLockShared();
+    db_item.second->storage()->ReapExpiredKeys(max_keys);
+    db_item.second->DBUnlockShared();
+  }
+}
+
 void PikaServer::AutoCompactRange() {
   struct statfs disk_info;
   int ret = statfs(g_pika_conf->db_path().c_str(), &disk_info);
@@ -1299,6 +1438,13 @@ void PikaServer::AutoUpdateNetworkMetric() {
                                      current_time, factor);
   instant_->trackInstantaneousMetric(STATS_METRIC_NET_OUTPUT_REPLICATION, g_pika_server->NetReplOutputBytes(),
                                      current_time, factor);
+
+  std::vector<uint64_t> accepted = WorkerAcceptedConns();
+  for (size_t i = 0; i < accepted.size(); i++) {
+    // per second
+    instant_->trackInstantaneousMetric(STATS_METRIC_WORKER_ACCEPTS + std::to_string(i), accepted[i], current_time,
+                                       1000000);
+  }
 }
 
 void PikaServer::PrintThreadPoolQueueStatus() {
@@ -1349,6 +1495,9 @@ void PikaServer::InitStorageOptions() {
   // avoid blocking io on scan
   // see https://github.com/facebook/rocksdb/wiki/IO#avoid-blocking-io
   storage_options_.options.avoid_unnecessary_blocking_io = true;
+  // Record a checksum of each SST file in the MANIFEST, a slave doing a full
+  // sync keeps the SST files it holds already when they match the master's
+  storage_options_.options.file_checksum_gen_factory = rocksdb::GetFileChecksumGenCrc32cFactory();
 
   // default l0 l1 noCompression l2 and more use `compression` option
   if (storage_options_.options.compression_per_level.empty() &&
@@ -1385,6 +1534,8 @@ void PikaServer::InitStorageOptions() {
   // For Storage small compaction
   storage_options_.statistics_max_size = g_pika_conf->max_cache_statistic_keys();
   storage_options_.small_compaction_threshold = g_pika_conf->small_compaction_threshold();
+  storage_options_.zset_rank_index_threshold = g_pika_conf->zset_rank_index_threshold();
+  storage_options_.slot_key_prefix = g_pika_conf->slot_key_prefix();
 
   // rocksdb blob
   if (g_pika_conf->enable_blob_files()) {
@@ -1445,6 +1596,11 @@ void PikaServer::ServerStatus(std::string* info) {
   std::stringstream tmp_stream;
   size_t q_size = ClientProcessorThreadPoolCurQueueSize();
   tmp_stream << "Client Processor thread-pool queue size: " << q_size << "\r\n";
+  if (ClientProcessorWorkStealing()) {
+    tmp_stream << "Client Processor thread-pool max worker queue size: "
+               << ClientProcessorThreadPoolMaxWorkerQueueSize() << "\r\n";
+    tmp_stream << "Client Processor thread-pool steals: " << ClientProcessorThreadPoolStealCount() << "\r\n";
+  }
   info->append(tmp_stream.str());
 }
 
@@ -1466,6 +1622,12 @@ bool PikaServer::SlotsMigrateAsyncCancel() {
 }
 
 void PikaServer::Bgslotsreload(const std::shared_ptr<DB>& db) {
+  // Keys are already grouped by slot on disk, there are no slot keys to rebuild
+  if (g_pika_conf->slot_key_prefix()) {
+    LOG(INFO) << "Skip slot reloading in the slot prefix key layout";
+    return;
+  }
+
   // Only one thread can go through
   {
     std::lock_guard ml(bgslots_protector_);
@@ -1618,6 +1780,32 @@ void DoBgslotscleanup(void* arg) {
   std::vector<std::string> keys;
   int64_t cursor_ret = -1;
   std::vector<int> cleanupSlots(cleanup.cleanup_slots);
+  if (g_pika_conf->slot_key_prefix()) {
+    // Evict the keys from cache first, then drop the whole slot ranges at once
+    std::shared_ptr<DB> db = g_pika_server->bgslots_cleanup_.db;
+    std::vector<uint32_t> slots(cleanupSlots.begin(), cleanupSlots.end());
+    if (PIKA_CACHE_NONE != g_pika_conf->cache_mode() && PIKA_CACHE_STATUS_OK == db->cache()->CacheStatus()) {
+      for (uint32_t slot : slots) {
+        int64_t cursor = 0;
+        do {
+          keys.clear();
+          if (!ScanSlotKeys(slot, cursor, "*", cleanup.count, &keys, &cursor, db).ok()) {
+            break;
+          }
+          for (auto& key : keys) {
+            key.erase(key.begin());
+          }
+          db->cache()->Del(keys);
+        } while (cursor != 0);
+      }
+      keys.clear();
+    }
+    rocksdb::Status s = db->storage()->DeleteSlots(slots);
+    if (!s.ok()) {
+      LOG(WARNING) << "slots clean delete slot ranges error: " << s.ToString();
+    }
+    cursor_ret = 0;
+  }
   while (cursor_ret != 0 && p->GetSlotscleaningup()){
     cursor_ret = g_pika_server->bgslots_cleanup_.db->storage()->Scan(storage::DataType::kAll, cleanup.cursor, cleanup.pattern, cleanup.count, &keys);
 
@@ -1762,13 +1950,6 @@ void PikaServer::ClearCacheDbAsyncV2(std::shared_ptr<DB> db) {
   common_bg_thread_.Schedule(&DoCacheBGTask, static_cast<void*>(arg));
 }
 
-void PikaServer::ProcessCronTask() {
-  for (auto& dbs : dbs_) {
-    auto cache = dbs.second->cache();
-    cache->ProcessCronTask();
-  }
-}
-
 double PikaServer::HitRatio(void) {
   std::unique_lock l(mu_);
   int64_t hits = 0;
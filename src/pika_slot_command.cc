@@ -625,6 +625,9 @@ static int SlotsMgrtOne(const std::string &host, const int port, int timeout, co
 }
 
 void RemSlotKeyByType(const std::string& type, const std::string& key, const std::shared_ptr<DB>& db) {
+  if (g_pika_conf->slot_key_prefix()) {
+    return;
+  }
   uint32_t crc;
   int hastag;
   uint32_t slotNum = GetSlotsID(g_pika_conf->default_slot_num(), key, &crc, &hastag);
@@ -673,7 +676,12 @@ static int SlotsMgrtTag(const std::string& host, const int port, int timeout, co
   std::vector<std::string> members;
 
   // get all keys that have the same crc
-  rocksdb::Status s = db->storage()->SMembers(tag_key, &members);
+  rocksdb::Status s;
+  if (g_pika_conf->slot_key_prefix()) {
+    s = GetSlotTagKeys(GetSlotID(g_pika_conf->default_slot_num(), key), crc, &members, db);
+  } else {
+    s = db->storage()->SMembers(tag_key, &members);
+  }
   if (!s.ok()) {
     return -1;
   }
@@ -706,9 +714,53 @@ std::string GetSlotKey(uint32_t slot) {
   return SlotKeyPrefix + std::to_string(slot);
 }
 
+rocksdb::Status GetSlotKeyNum(uint32_t slot, int32_t* len, const std::shared_ptr<DB>& db) {
+  if (!g_pika_conf->slot_key_prefix()) {
+    return db->storage()->SCard(GetSlotKey(slot), len);
+  }
+  int64_t num = 0;
+  rocksdb::Status s = db->storage()->SlotKeyNum(slot, &num);
+  *len = static_cast<int32_t>(num);
+  // keep the same result as SCard on an empty slot key
+  if (s.ok() && num == 0) {
+    return rocksdb::Status::NotFound();
+  }
+  return s;
+}
+
+rocksdb::Status ScanSlotKeys(uint32_t slot, int64_t cursor, const std::string& pattern, int64_t count,
+                             std::vector<std::string>* members, int64_t* next_cursor, const std::shared_ptr<DB>& db) {
+  if (!g_pika_conf->slot_key_prefix()) {
+    return db->storage()->SScan(GetSlotKey(slot), cursor, pattern, count, members, next_cursor);
+  }
+  return db->storage()->ScanSlot(slot, cursor, pattern, count, members, next_cursor);
+}
+
+rocksdb::Status GetSlotTagKeys(uint32_t slot, uint32_t crc, std::vector<std::string>* members,
+                               const std::shared_ptr<DB>& db) {
+  int64_t cursor = 0;
+  uint32_t key_crc = 0;
+  int hastag = 0;
+  std::vector<std::string> keys;
+  do {
+    keys.clear();
+    rocksdb::Status s = db->storage()->ScanSlot(slot, cursor, "*", 1000, &keys, &cursor);
+    if (!s.ok()) {
+      return s;
+    }
+    for (auto& member : keys) {
+      GetSlotsID(g_pika_conf->default_slot_num(), member.substr(1), &key_crc, &hastag);
+      if (hastag && key_crc == crc) {
+        members->push_back(std::move(member));
+      }
+    }
+  } while (cursor != 0);
+  return rocksdb::Status::OK();
+}
+
 // add key to slotkey
 void AddSlotKey(const std::string& type, const std::string& key, const std::shared_ptr<DB>& db) {
-  if (g_pika_conf->slotmigrate() != true) {
+  if (g_pika_conf->slotmigrate() != true || g_pika_conf->slot_key_prefix()) {
     return;
   }
 
@@ -740,7 +792,7 @@ void AddSlotKey(const std::string& type, const std::string& key, const std::shar
 
 // del key from slotkey
 void RemSlotKey(const std::string& key, const std::shared_ptr<DB>& db) {
-  if (g_pika_conf->slotmigrate() != true) {
+  if (g_pika_conf->slotmigrate() != true || g_pika_conf->slot_key_prefix()) {
     return;
   }
   std::string type;
@@ -789,7 +841,10 @@ int DeleteKey(const std::string& key, const char key_type, const std::shared_ptr
   // delete slotkey
   std::vector<std::string> members;
   members.emplace_back(key_type + key);
-  rocksdb::Status s = db->storage()->SRem(slotKey, members, &res);
+  rocksdb::Status s;
+  if (!g_pika_conf->slot_key_prefix()) {
+    s = db->storage()->SRem(slotKey, members, &res);
+  }
   if (!s.ok()) {
     if (s.IsNotFound()) {
       LOG(INFO) << "Del key Srem key " << key << " not found";
@@ -882,10 +937,8 @@ void SlotsMgrtTagSlotCmd::Do() {
   int32_t len = 0;
   int ret = 0;
   std::string detail;
-  std::string slot_key = GetSlotKey(static_cast<int32_t>(slot_id_));
-
   // first, get the count of slot_key, prevent to sscan key very slowly when the key is not found
-  rocksdb::Status s = db_->storage()->SCard(slot_key, &len);
+  rocksdb::Status s = GetSlotKeyNum(static_cast<uint32_t>(slot_id_), &len, db_);
   if (len < 0) {
     detail = "Get the len of slot Error";
   }
@@ -894,7 +947,7 @@ void SlotsMgrtTagSlotCmd::Do() {
     g_pika_server->pika_migrate_->CleanMigrateClient();
     int64_t next_cursor = 0;
     std::vector<std::string> members;
-    rocksdb::Status s = db_->storage()->SScan(slot_key, 0, "*", 1, &members, &next_cursor);
+    rocksdb::Status s = ScanSlotKeys(static_cast<uint32_t>(slot_id_), 0, "*", 1, &members, &next_cursor, db_);
     if (s.ok()) {
       for (const auto &member : members) {
         std::string key = member;
@@ -1031,7 +1084,13 @@ void SlotsMgrtTagOneCmd::Do() {
   } else {
     // key is tag_key, check the number of the tag_key
     std::string tag_key = GetSlotsTagKey(crc);
-    s = db_->storage()->SCard(tag_key, &len);
+    if (g_pika_conf->slot_key_prefix()) {
+      std::vector<std::string> members;
+      s = GetSlotTagKeys(GetSlotID(g_pika_conf->default_slot_num(), key_), crc, &members, db_);
+      len = static_cast<int32_t>(members.size());
+    } else {
+      s = db_->storage()->SCard(tag_key, &len);
+    }
     if (s.IsNotFound()) {
       res_.AppendInteger(0);
       return;
@@ -1144,12 +1203,10 @@ void SlotsInfoCmd::Do() {
   memset(slots_size, 0, slotNum);
   int n = 0;
   int32_t len = 0;
-  std::string slot_key;
 
   for (auto i = static_cast<int32_t>(begin_); i < end_; i++) {
-    slot_key = GetSlotKey(i);
     len = 0;
-    rocksdb::Status s = db_->storage()->SCard(slot_key, &len);
+    rocksdb::Status s = GetSlotKeyNum(static_cast<uint32_t>(i), &len, db_);
     if (!s.ok() || len == 0) {
       continue;
     }
@@ -1230,8 +1287,7 @@ void SlotsMgrtTagSlotAsyncCmd::Do() {
   }
 
   int32_t remained = 0;
-  std::string slotKey = GetSlotKey(static_cast<int32_t>(slot_id_));
-  storage::Status status = db_->storage()->SCard(slotKey, &remained);
+  storage::Status status = GetSlotKeyNum(static_cast<uint32_t>(slot_id_), &remained, db_);
   if (status.IsNotFound()) {
     LOG(INFO) << "find no record in slot " << slot_id_;
     res_.AppendArrayLen(2);
@@ -1367,6 +1423,7 @@ void SlotsScanCmd::DoInitial() {
     res_.SetRes(CmdRes::kWrongNum, kCmdNameSlotsScan);
     return;
   }
+  slot_ = std::stoll(argv_[1].data());
   if (!pstd::string2int(argv_[2].data(), argv_[2].size(), &cursor_)) {
     res_.SetRes(CmdRes::kWrongNum, kCmdNameSlotsScan);
     return;
@@ -1401,7 +1458,7 @@ void SlotsScanCmd::DoInitial() {
 
 void SlotsScanCmd::Do() {
   std::vector<std::string> members;
-  rocksdb::Status s = db_->storage()->SScan(key_, cursor_, pattern_, count_, &members, &cursor_);
+  rocksdb::Status s = ScanSlotKeys(static_cast<uint32_t>(slot_), cursor_, pattern_, count_, &members, &cursor_, db_);
 
   if (members.size() <= 0) {
     cursor_ = 0;
@@ -5,9 +5,87 @@
 
 #include "include/pika_statistic.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "pstd/include/env.h"
 
-#include "include/pika_command.h"
+#include "pstd/include/pstd_string.h"
+
+/* LatencyHistogram */
+
+LatencyHistogram::LatencyHistogram() {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+LatencyHistogram::LatencyHistogram(const LatencyHistogram& other) {
+  for (int i = 0; i < kBucketNum; i++) {
+    buckets_[i].store(other.buckets_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+}
+
+int LatencyHistogram::BucketIndex(uint64_t value) {
+  if (value < kSubBucketNum) {
+    return static_cast<int>(value);
+  }
+  int msb = 63 - __builtin_clzll(value);
+  if (msb >= kMaxValueBits) {
+    return kBucketNum - 1;
+  }
+  int shift = msb - kSubBucketBits;
+  return (shift + 1) * kSubBucketNum + static_cast<int>((value >> shift) - kSubBucketNum);
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(int index) {
+  if (index < kSubBucketNum) {
+    return index;
+  }
+  int shift = index / kSubBucketNum - 1;
+  uint64_t lower = static_cast<uint64_t>(kSubBucketNum + index % kSubBucketNum) << shift;
+  return lower + (1ULL << shift) - 1;
+}
+
+void LatencyHistogram::Add(uint64_t value) {
+  // Single writer, a plain load and store is enough and avoids a locked instruction
+  auto& bucket = buckets_[BucketIndex(value)];
+  bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+  for (int i = 0; i < kBucketNum; i++) {
+    uint64_t count = other.buckets_[i].load(std::memory_order_relaxed);
+    if (count != 0) {
+      buckets_[i].fetch_add(count, std::memory_order_relaxed);
+    }
+  }
+}
+
+uint64_t LatencyHistogram::Count() const {
+  uint64_t count = 0;
+  for (const auto& bucket : buckets_) {
+    count += bucket.load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+uint64_t LatencyHistogram::Percentile(double p) const {
+  uint64_t total = Count();
+  if (total == 0) {
+    return 0;
+  }
+  auto target = static_cast<uint64_t>(std::ceil(p / 100.0 * static_cast<double>(total)));
+  target = std::clamp<uint64_t>(target, 1, total);
+  uint64_t seen = 0;
+  for (int i = 0; i < kBucketNum; i++) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen >= target) {
+      return BucketUpperBound(i);
+    }
+  }
+  return BucketUpperBound(kBucketNum - 1);
+}
 
 /* QpsStatistic */
 
@@ -71,6 +149,29 @@ Statistic::Statistic() {
   pthread_rwlockattr_init(&db_stat_rw_attr);
 }
 
+void Statistic::Init(const std::vector<std::string>& cmd_names, const std::vector<std::string>& db_names) {
+  cmd_names_ = cmd_names;
+  db_names_ = db_names;
+  std::lock_guard l(db_stat_rw);
+  for (size_t i = 0; i < db_names_.size(); i++) {
+    db_index_[db_names_[i]] = i;
+    db_stat[db_names_[i]];
+  }
+}
+
+StatisticShard* Statistic::LocalShard() {
+  thread_local const Statistic* owner = nullptr;
+  thread_local StatisticShard* shard = nullptr;
+  if (owner != this) {
+    auto new_shard = std::make_unique<StatisticShard>(cmd_names_.size(), db_names_.size());
+    shard = new_shard.get();
+    owner = this;
+    std::lock_guard l(shards_mu_);
+    shards_.push_back(std::move(new_shard));
+  }
+  return shard;
+}
+
 QpsStatistic Statistic::DBStat(const std::string& db_name) {
   std::shared_lock l(db_stat_rw);
   return db_stat[db_name];
@@ -81,31 +182,147 @@ std::unordered_map<std::string, QpsStatistic> Statistic::AllDBStat() {
   return db_stat;
 }
 
-void Statistic::UpdateDBQps(const std::string& db_name, const std::string& command, bool is_write) {
-  bool db_exist = true;
-  std::unordered_map<std::string, QpsStatistic>::iterator iter;
+void Statistic::UpdateDBQps(const std::string& db_name, uint32_t cmd_id, bool is_write) {
+  StatisticShard* shard = LocalShard();
+  shard->querynum.store(shard->querynum.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  if (cmd_id < shard->cmd_slots.size()) {
+    auto& exec_count = shard->cmd_slots[cmd_id].exec_count;
+    exec_count.store(exec_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+  auto iter = db_index_.find(db_name);
+  if (iter == db_index_.end()) {
+    return;
+  }
+  StatisticShard::DBSlot& slot = shard->db_slots[iter->second];
+  slot.querynum.store(slot.querynum.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  if (is_write) {
+    slot.write_querynum.store(slot.write_querynum.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+}
+
+void Statistic::UpdateCmdTimeStat(uint32_t cmd_id, uint64_t queue_time, uint64_t process_time, uint64_t total_time) {
+  StatisticShard* shard = LocalShard();
+  if (cmd_id >= shard->cmd_slots.size()) {
+    return;
+  }
+  StatisticShard::CmdSlot& slot = shard->cmd_slots[cmd_id];
+  slot.cmd_count.store(slot.cmd_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  slot.cmd_time_consuming.store(slot.cmd_time_consuming.load(std::memory_order_relaxed) + total_time,
+                                std::memory_order_relaxed);
+  CmdLatencyStatistic* latency = slot.latency.load(std::memory_order_relaxed);
+  if (!latency) {
+    latency = new CmdLatencyStatistic();
+    slot.latency.store(latency, std::memory_order_release);
+  }
+  latency->queue_time.Add(queue_time);
+  latency->process_time.Add(process_time);
+  latency->total_time.Add(total_time);
+}
+
+void Statistic::ResetLastSecQuerynum() {
+  uint64_t querynum = 0;
+  std::vector<uint64_t> db_querynum(db_names_.size(), 0);
+  std::vector<uint64_t> db_write_querynum(db_names_.size(), 0);
   {
-    std::shared_lock l(db_stat_rw);
-    auto search = db_stat.find(db_name);
-    if (search == db_stat.end()) {
-      db_exist = false;
-    } else {
-      iter = search;
+    std::lock_guard l(shards_mu_);
+    for (const auto& shard : shards_) {
+      querynum += shard->querynum.load(std::memory_order_relaxed);
+      for (size_t i = 0; i < db_names_.size(); i++) {
+        db_querynum[i] += shard->db_slots[i].querynum.load(std::memory_order_relaxed);
+        db_write_querynum[i] += shard->db_slots[i].write_querynum.load(std::memory_order_relaxed);
+      }
     }
   }
-  if (db_exist) {
-    iter->second.IncreaseQueryNum(is_write);
-  } else {
-    {
-      std::lock_guard l(db_stat_rw);
-      db_stat[db_name].IncreaseQueryNum(is_write);
+  uint64_t base = querynum_base_.load();
+  server_stat.qps.querynum.store(querynum > base ? querynum - base : 0);
+  server_stat.qps.ResetLastSecQuerynum();
+
+  std::shared_lock l(db_stat_rw);
+  for (size_t i = 0; i < db_names_.size(); i++) {
+    auto iter = db_stat.find(db_names_[i]);
+    if (iter == db_stat.end()) {
+      continue;
     }
+    iter->second.querynum.store(db_querynum[i]);
+    iter->second.write_querynum.store(db_write_querynum[i]);
+    iter->second.ResetLastSecQuerynum();
   }
 }
 
-void Statistic::ResetDBLastSecQuerynum() {
-  std::shared_lock l(db_stat_rw);
-  for (auto& stat : db_stat) {
-    stat.second.ResetLastSecQuerynum();
+void Statistic::ResetQueryNum() {
+  uint64_t querynum = 0;
+  {
+    std::lock_guard l(shards_mu_);
+    for (const auto& shard : shards_) {
+      querynum += shard->querynum.load(std::memory_order_relaxed);
+    }
+  }
+  querynum_base_.store(querynum);
+  server_stat.qps.querynum.store(0);
+  server_stat.qps.last_querynum.store(0);
+}
+
+uint64_t Statistic::QueryNum() {
+  uint64_t querynum = 0;
+  {
+    std::lock_guard l(shards_mu_);
+    for (const auto& shard : shards_) {
+      querynum += shard->querynum.load(std::memory_order_relaxed);
+    }
+  }
+  uint64_t base = querynum_base_.load();
+  return querynum > base ? querynum - base : 0;
+}
+
+std::unordered_map<std::string, uint64_t> Statistic::ExecCount() {
+  std::vector<uint64_t> exec_count(cmd_names_.size(), 0);
+  {
+    std::lock_guard l(shards_mu_);
+    for (const auto& shard : shards_) {
+      for (size_t i = 0; i < cmd_names_.size(); i++) {
+        exec_count[i] += shard->cmd_slots[i].exec_count.load(std::memory_order_relaxed);
+      }
+    }
+  }
+  std::unordered_map<std::string, uint64_t> res;
+  for (size_t i = 0; i < cmd_names_.size(); i++) {
+    if (cmd_names_[i].empty()) {
+      continue;
+    }
+    std::string cmd_name = cmd_names_[i];
+    res[pstd::StringToUpper(cmd_name)] = exec_count[i];
+  }
+  return res;
+}
+
+std::map<std::string, CommandStatistics> Statistic::CmdStats(bool with_latency) {
+  std::vector<CommandStatistics> stats(cmd_names_.size());
+  {
+    std::lock_guard l(shards_mu_);
+    for (const auto& shard : shards_) {
+      for (size_t i = 0; i < cmd_names_.size(); i++) {
+        const StatisticShard::CmdSlot& slot = shard->cmd_slots[i];
+        stats[i].exec_count += slot.exec_count.load(std::memory_order_relaxed);
+        stats[i].cmd_count += slot.cmd_count.load(std::memory_order_relaxed);
+        stats[i].cmd_time_consuming += slot.cmd_time_consuming.load(std::memory_order_relaxed);
+        CmdLatencyStatistic* latency = slot.latency.load(std::memory_order_acquire);
+        if (with_latency && latency) {
+          if (!stats[i].latency) {
+            stats[i].latency = std::make_unique<CmdLatencyStatistic>();
+          }
+          stats[i].latency->queue_time.Merge(latency->queue_time);
+          stats[i].latency->process_time.Merge(latency->process_time);
+          stats[i].latency->total_time.Merge(latency->total_time);
+        }
+      }
+    }
+  }
+  std::map<std::string, CommandStatistics> res;
+  for (size_t i = 0; i < cmd_names_.size(); i++) {
+    if (cmd_names_[i].empty() || stats[i].cmd_count == 0) {
+      continue;
+    }
+    res.emplace(cmd_names_[i], std::move(stats[i]));
   }
+  return res;
 }
@@ -12,7 +12,7 @@
 #include "include/pika_list.h"
 #include "include/pika_rm.h"
 #include "include/pika_server.h"
-#include "src/pstd/include/scope_record_lock.h"
+#include "src/pstd/include/record_lock_mgr.h"
 
 extern std::unique_ptr<PikaServer> g_pika_server;
 extern std::unique_ptr<PikaReplicaManager> g_pika_rm;
@@ -148,8 +148,7 @@ void ExecCmd::Lock() {
 
   std::for_each(r_lock_dbs_.begin(), r_lock_dbs_.end(), [this](auto& need_lock_db) {
     if (lock_db_keys_.count(need_lock_db) != 0) {
-      pstd::lock::MultiRecordLock record_lock(need_lock_db->LockMgr());
-      record_lock.Lock(lock_db_keys_[need_lock_db]);
+      need_lock_db->LockMgr()->Lock(lock_db_keys_[need_lock_db], pstd::lock::LockMode::kExclusive);
     }
     need_lock_db->DBLockShared();
   });
@@ -158,8 +157,7 @@ void ExecCmd::Lock() {
 void ExecCmd::Unlock() {
   std::for_each(r_lock_dbs_.begin(), r_lock_dbs_.end(), [this](auto& need_lock_db) {
     if (lock_db_keys_.count(need_lock_db) != 0) {
-      pstd::lock::MultiRecordLock record_lock(need_lock_db->LockMgr());
-      record_lock.Unlock(lock_db_keys_[need_lock_db]);
+      need_lock_db->LockMgr()->Unlock(lock_db_keys_[need_lock_db], pstd::lock::LockMode::kExclusive);
     }
     need_lock_db->DBUnlockShared();
   });
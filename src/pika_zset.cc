@@ -228,18 +228,16 @@ void ZRangeCmd::Do() {
       char buf[32];
       int64_t len = 0;
       res_.AppendArrayLenUint64(score_members.size() * 2);
-      for (const auto& sm : score_members) {
-        res_.AppendStringLenUint64(sm.member.size());
-        res_.AppendContent(sm.member);
+      for (auto& sm : score_members) {
+        res_.AppendString(std::move(sm.member));
         len = pstd::d2string(buf, sizeof(buf), sm.score);
         res_.AppendStringLen(len);
         res_.AppendContent(buf);
       }
     } else {
       res_.AppendArrayLenUint64(score_members.size());
-      for (const auto& sm : score_members) {
-        res_.AppendStringLenUint64(sm.member.size());
-        res_.AppendContent(sm.member);
+      for (auto& sm : score_members) {
+        res_.AppendString(std::move(sm.member));
       }
     }
   } else if (s_.IsInvalidArgument()) {
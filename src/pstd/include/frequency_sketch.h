@@ -0,0 +1,56 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef __PSTD_FREQUENCY_SKETCH_H__
+#define __PSTD_FREQUENCY_SKETCH_H__
+
+#include <atomic>
+#include <memory>
+#include <string_view>
+
+#include "pstd/include/noncopyable.h"
+
+namespace pstd {
+
+/*
+ * Count-min sketch of 4-bit counters estimating how often a key was seen
+ * recently, as used by TinyLFU admission. Each key has one counter in each
+ * of kDepth rows and its frequency is the smallest of them, saturating at
+ * kMaxFrequency. After ten increments per key of capacity all the counters
+ * are halved, so keys that stopped being accessed fade out.
+ *
+ * Lock free, concurrent increments may occasionally be lost, which only
+ * makes the estimate a little lower.
+ */
+class FrequencySketch : public pstd::noncopyable {
+ public:
+  static constexpr int kMaxFrequency = 15;
+
+  // Sized for about capacity distinct keys, rounded up to a power of two
+  explicit FrequencySketch(size_t capacity = 1 << 16);
+  ~FrequencySketch() = default;
+
+  void Increment(std::string_view key);
+  int Frequency(std::string_view key) const;
+  void Clear();
+
+  size_t capacity() const { return mask_ + 1; }
+
+ private:
+  static constexpr int kDepth = 4;
+  static constexpr int kCountersPerWord = 16;
+
+  size_t CounterIndex(uint64_t hash, int row) const;
+  void Age();
+
+  size_t mask_ = 0;
+  size_t sample_size_ = 0;
+  std::unique_ptr<std::atomic<uint64_t>[]> table_;
+  std::atomic<size_t> increments_{0};
+};
+
+}  // namespace pstd
+
+#endif  // __PSTD_FREQUENCY_SKETCH_H__
@@ -17,6 +17,7 @@ CRCU32 GetSlotsID(int slot_num, const std::string& str, CRCU32* pcrc, int* phast
 
 // get slot number of the key
 CRCU32 GetSlotID(int slot_num, const std::string& str);
+CRCU32 GetSlotID(int slot_num, const char* data, size_t len);
 
 #endif
 
@@ -0,0 +1,112 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef __PSTD_RECORD_LOCK_MGR_H__
+#define __PSTD_RECORD_LOCK_MGR_H__
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pstd/include/noncopyable.h"
+
+namespace pstd::lock {
+
+enum class LockMode { kShared, kExclusive };
+
+/*
+ * Record locks kept in a fixed table of lock words indexed by the hash of
+ * the key, nothing is allocated to lock a key. A lock word is either held
+ * by one writer or by any number of readers. Waiters spin for a while and
+ * then park on a condition variable shared by a stripe of lock words.
+ *
+ * A writer that parks marks the lock word, new readers then wait behind it
+ * instead of keeping it shared forever. Readers already holding the word
+ * are not affected, so a thread must not take the shared lock of a word it
+ * already holds shared, a writer parking in between would deadlock it.
+ *
+ * Keys landing in the same lock word share its lock, which is safe as long
+ * as the lock words of a multi-key operation are taken in ascending order
+ * and only once, see RecordLockGuard.
+ */
+class RecordLockMgr : public pstd::noncopyable {
+ public:
+  // num_slots is rounded up to a power of two
+  explicit RecordLockMgr(size_t num_slots = 1 << 16);
+  ~RecordLockMgr() = default;
+
+  uint32_t SlotOf(std::string_view key) const;
+  size_t num_slots() const { return mask_ + 1; }
+
+  void LockSlot(uint32_t slot, LockMode mode);
+  bool TryLockSlot(uint32_t slot, LockMode mode);
+  void UnlockSlot(uint32_t slot, LockMode mode);
+
+  // Sorts the key set once and locks its distinct slots in order
+  void Lock(const std::vector<std::string>& keys, LockMode mode);
+  void Unlock(const std::vector<std::string>& keys, LockMode mode);
+
+ private:
+  static constexpr uint32_t kWriter = 1U << 31;
+  static constexpr uint32_t kWriterWaiting = 1U << 30;
+  static constexpr size_t kParkStripes = 64;
+
+  struct alignas(64) ParkStripe {
+    std::mutex mu;
+    std::condition_variable cv;
+    std::atomic<int> waiters{0};
+  };
+
+  void WakeUp(uint32_t slot);
+
+  // 0 free, kWriter held by a writer, otherwise the number of readers,
+  // plus kWriterWaiting while a writer is parked on it
+  std::unique_ptr<std::atomic<uint32_t>[]> slots_;
+  uint32_t mask_ = 0;
+  std::array<ParkStripe, kParkStripes> parks_;
+};
+
+/*
+ * Holds the record locks of a set of keys, released on destruction.
+ * Up to kInlineSlots distinct slots are kept without allocating.
+ */
+class RecordLockGuard : public pstd::noncopyable {
+ public:
+  // The lock manager must outlive the guard
+  RecordLockGuard(const std::shared_ptr<RecordLockMgr>& lock_mgr, LockMode mode)
+      : lock_mgr_(lock_mgr.get()), mode_(mode) {}
+  RecordLockGuard(const std::shared_ptr<RecordLockMgr>& lock_mgr, std::string_view key, LockMode mode)
+      : RecordLockGuard(lock_mgr, mode) {
+    Lock(key);
+  }
+  RecordLockGuard(const std::shared_ptr<RecordLockMgr>& lock_mgr, const std::vector<std::string>& keys, LockMode mode)
+      : RecordLockGuard(lock_mgr, mode) {
+    Lock(keys);
+  }
+  ~RecordLockGuard() { Unlock(); }
+
+  void Lock(std::string_view key);
+  void Lock(const std::vector<std::string>& keys);
+  void Unlock();
+
+ private:
+  static constexpr size_t kInlineSlots = 8;
+
+  uint32_t* slots() { return heap_slots_.empty() ? inline_slots_.data() : heap_slots_.data(); }
+
+  RecordLockMgr* const lock_mgr_;
+  const LockMode mode_;
+  size_t num_slots_ = 0;
+  std::array<uint32_t, kInlineSlots> inline_slots_;
+  std::vector<uint32_t> heap_slots_;
+};
+
+}  // namespace pstd::lock
+#endif  // __PSTD_RECORD_LOCK_MGR_H__
@@ -0,0 +1,63 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef __PSTD_SINGLE_FLIGHT_H__
+#define __PSTD_SINGLE_FLIGHT_H__
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "pstd/include/noncopyable.h"
+
+namespace pstd {
+
+/*
+ * Lets one caller at a time load a key while the others wait for it,
+ * e.g. a single reader fills a cache entry that many readers missed.
+ *
+ *   if (flight.Begin(key, wait)) {
+ *     ... load key ...
+ *     flight.End(key);
+ *   } else {
+ *     ... the load of another caller has ended or wait elapsed ...
+ *   }
+ */
+class SingleFlight : public pstd::noncopyable {
+ public:
+  SingleFlight() = default;
+  ~SingleFlight() = default;
+
+  /*
+   * Returns true when the caller leads the load of key and has to call
+   * End(key). Otherwise it waited up to wait for the leader to end.
+   */
+  bool Begin(const std::string& key, std::chrono::milliseconds wait);
+  void End(const std::string& key);
+
+ private:
+  static constexpr size_t kStripes = 64;
+
+  struct Flight {
+    bool done = false;
+    std::condition_variable cv;
+  };
+  struct Stripe {
+    std::mutex mu;
+    std::unordered_map<std::string, std::shared_ptr<Flight>> flights;
+  };
+
+  Stripe& StripeOf(const std::string& key);
+
+  std::array<Stripe, kStripes> stripes_;
+};
+
+}  // namespace pstd
+
+#endif  // __PSTD_SINGLE_FLIGHT_H__
@@ -0,0 +1,88 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "pstd/include/frequency_sketch.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace pstd {
+
+static constexpr uint64_t kRowSeeds[] = {0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL, 0x9ae16a3b2f90404fULL,
+                                         0xcbf29ce484222325ULL};
+// Halves every 4-bit counter of a word at once
+static constexpr uint64_t kHalfMask = 0x7777777777777777ULL;
+
+static uint64_t Mix(uint64_t hash, uint64_t seed) {
+  hash = (hash ^ seed) * 0xff51afd7ed558ccdULL;
+  return hash ^ (hash >> 32);
+}
+
+FrequencySketch::FrequencySketch(size_t capacity) {
+  // A word of sixteen counters per key
+  size_t words = 1;
+  while (words < capacity) {
+    words <<= 1;
+  }
+  mask_ = words - 1;
+  // The sample of ten accesses per key TinyLFU suggests
+  sample_size_ = words * 10;
+  table_ = std::make_unique<std::atomic<uint64_t>[]>(words);
+  Clear();
+}
+
+size_t FrequencySketch::CounterIndex(uint64_t hash, int row) const {
+  uint64_t h = Mix(hash, kRowSeeds[row]);
+  // The word, then one of its counters
+  return ((h & mask_) * kCountersPerWord) + ((h >> 58) & (kCountersPerWord - 1));
+}
+
+void FrequencySketch::Increment(std::string_view key) {
+  uint64_t hash = std::hash<std::string_view>{}(key);
+  for (int row = 0; row < kDepth; row++) {
+    size_t index = CounterIndex(hash, row);
+    std::atomic<uint64_t>& word = table_[index / kCountersPerWord];
+    int shift = static_cast<int>(index % kCountersPerWord) * 4;
+    uint64_t old_word = word.load(std::memory_order_relaxed);
+    while (((old_word >> shift) & 0xf) != kMaxFrequency) {
+      if (word.compare_exchange_weak(old_word, old_word + (1ULL << shift), std::memory_order_relaxed)) {
+        break;
+      }
+    }
+  }
+  if (increments_.fetch_add(1, std::memory_order_relaxed) + 1 == sample_size_) {
+    Age();
+  }
+}
+
+int FrequencySketch::Frequency(std::string_view key) const {
+  uint64_t hash = std::hash<std::string_view>{}(key);
+  int frequency = kMaxFrequency;
+  for (int row = 0; row < kDepth; row++) {
+    size_t index = CounterIndex(hash, row);
+    uint64_t word = table_[index / kCountersPerWord].load(std::memory_order_relaxed);
+    int shift = static_cast<int>(index % kCountersPerWord) * 4;
+    frequency = std::min(frequency, static_cast<int>((word >> shift) & 0xf));
+  }
+  return frequency;
+}
+
+void FrequencySketch::Age() {
+  for (size_t i = 0; i <= mask_; i++) {
+    uint64_t old_word = table_[i].load(std::memory_order_relaxed);
+    while (!table_[i].compare_exchange_weak(old_word, (old_word >> 1) & kHalfMask, std::memory_order_relaxed)) {
+    }
+  }
+  increments_.store(sample_size_ / 2, std::memory_order_relaxed);
+}
+
+void FrequencySketch::Clear() {
+  for (size_t i = 0; i <= mask_; i++) {
+    table_[i].store(0, std::memory_order_relaxed);
+  }
+  increments_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace pstd
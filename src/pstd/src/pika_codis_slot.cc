@@ -8,9 +8,8 @@
 #include "pstd/include/pika_codis_slot.h"
 
 // get slot tag
-static const char *GetSlotsTag(const std::string &str, int *plen) {
-  const char *s = str.data();
-  int i, j, n = static_cast<int32_t>(str.length());
+static const char *GetSlotsTag(const char *s, int n, int *plen) {
+  int i, j;
   for (i = 0; i < n && s[i] != '{'; i++) {
   }
   if (i == n) {
@@ -31,11 +30,20 @@ static const char *GetSlotsTag(const std::string &str, int *plen) {
 // get slot number of the key
 CRCU32 GetSlotID(int slot_num, const std::string &str) { return GetSlotsID(slot_num, str, nullptr, nullptr); }
 
+CRCU32 GetSlotID(int slot_num, const char *data, size_t len) {
+  int taglen;
+  const char *tag = GetSlotsTag(data, static_cast<int32_t>(len), &taglen);
+  if (tag == nullptr) {
+    tag = data, taglen = static_cast<int32_t>(len);
+  }
+  return static_cast<CRCU32>(crc32(0L, (const Bytef*)tag, taglen)) % slot_num;
+}
+
 // get the slot number by key
 CRCU32 GetSlotsID(int slot_num, const std::string &str, CRCU32 *pcrc, int *phastag) {
   const char *s = str.data();
   int taglen; int hastag = 0;
-  const char *tag = GetSlotsTag(str, &taglen);
+  const char *tag = GetSlotsTag(s, static_cast<int32_t>(str.length()), &taglen);
   if (tag == nullptr) {
     tag = s, taglen = static_cast<int32_t>(str.length());
   } else {
@@ -0,0 +1,151 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "pstd/include/record_lock_mgr.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <thread>
+
+namespace pstd::lock {
+
+// Attempts on a busy slot before yielding, then before parking
+static constexpr int kSpinRounds = 32;
+static constexpr int kYieldRounds = 8;
+
+// Fills slots with the sorted, distinct slots of keys, returns their number
+static size_t SortedSlots(const RecordLockMgr& lock_mgr, const std::vector<std::string>& keys, uint32_t* slots) {
+  for (size_t i = 0; i < keys.size(); i++) {
+    slots[i] = lock_mgr.SlotOf(keys[i]);
+  }
+  std::sort(slots, slots + keys.size());
+  return std::unique(slots, slots + keys.size()) - slots;
+}
+
+RecordLockMgr::RecordLockMgr(size_t num_slots) {
+  size_t size = 1;
+  while (size < num_slots) {
+    size <<= 1;
+  }
+  slots_ = std::make_unique<std::atomic<uint32_t>[]>(size);
+  for (size_t i = 0; i < size; i++) {
+    slots_[i].store(0, std::memory_order_relaxed);
+  }
+  mask_ = static_cast<uint32_t>(size - 1);
+}
+
+uint32_t RecordLockMgr::SlotOf(std::string_view key) const {
+  return static_cast<uint32_t>(std::hash<std::string_view>{}(key)) & mask_;
+}
+
+bool RecordLockMgr::TryLockSlot(uint32_t slot, LockMode mode) {
+  std::atomic<uint32_t>& state = slots_[slot];
+  uint32_t cur = state.load();
+  if (mode == LockMode::kExclusive) {
+    // Taking the lock clears the mark of the parked writers, they set it
+    // again if they lose the race for the lock
+    return (cur == 0 || cur == kWriterWaiting) && state.compare_exchange_strong(cur, kWriter);
+  }
+  while ((cur & (kWriter | kWriterWaiting)) == 0) {
+    if (state.compare_exchange_weak(cur, cur + 1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void RecordLockMgr::LockSlot(uint32_t slot, LockMode mode) {
+  for (int i = 0; i < kSpinRounds + kYieldRounds; i++) {
+    if (TryLockSlot(slot, mode)) {
+      return;
+    }
+    if (i >= kSpinRounds) {
+      std::this_thread::yield();
+    }
+  }
+
+  ParkStripe& park = parks_[slot % kParkStripes];
+  std::unique_lock l(park.mu);
+  // Announced before looking at the slot again, so the holder either sees
+  // the waiter when it unlocks or the waiter sees the slot unlocked
+  park.waiters.fetch_add(1);
+  while (!TryLockSlot(slot, mode)) {
+    if (mode == LockMode::kExclusive) {
+      // Holds off new readers, if the slot was freed meanwhile its holder
+      // is blocked on park.mu until we wait and then wakes us up
+      slots_[slot].fetch_or(kWriterWaiting);
+    }
+    park.cv.wait(l);
+  }
+  park.waiters.fetch_sub(1);
+}
+
+void RecordLockMgr::UnlockSlot(uint32_t slot, LockMode mode) {
+  if (mode == LockMode::kExclusive) {
+    assert(slots_[slot].load() & kWriter);
+    slots_[slot].store(0);
+    WakeUp(slot);
+  } else {
+    assert((slots_[slot].load() & ~kWriterWaiting) != 0 && (slots_[slot].load() & kWriter) == 0);
+    // Readers parked behind a waiting writer are woken up with it
+    if ((slots_[slot].fetch_sub(1) & ~kWriterWaiting) == 1) {
+      WakeUp(slot);
+    }
+  }
+}
+
+void RecordLockMgr::WakeUp(uint32_t slot) {
+  ParkStripe& park = parks_[slot % kParkStripes];
+  if (park.waiters.load() > 0) {
+    std::lock_guard l(park.mu);
+    park.cv.notify_all();
+  }
+}
+
+void RecordLockMgr::Lock(const std::vector<std::string>& keys, LockMode mode) {
+  std::vector<uint32_t> slots(keys.size());
+  size_t num = SortedSlots(*this, keys, slots.data());
+  for (size_t i = 0; i < num; i++) {
+    LockSlot(slots[i], mode);
+  }
+}
+
+void RecordLockMgr::Unlock(const std::vector<std::string>& keys, LockMode mode) {
+  std::vector<uint32_t> slots(keys.size());
+  size_t num = SortedSlots(*this, keys, slots.data());
+  for (size_t i = num; i > 0; i--) {
+    UnlockSlot(slots[i - 1], mode);
+  }
+}
+
+void RecordLockGuard::Lock(std::string_view key) {
+  assert(num_slots_ == 0);
+  heap_slots_.clear();
+  inline_slots_[0] = lock_mgr_->SlotOf(key);
+  num_slots_ = 1;
+  lock_mgr_->LockSlot(inline_slots_[0], mode_);
+}
+
+void RecordLockGuard::Lock(const std::vector<std::string>& keys) {
+  assert(num_slots_ == 0);
+  heap_slots_.clear();
+  if (keys.size() > kInlineSlots) {
+    heap_slots_.resize(keys.size());
+  }
+  num_slots_ = SortedSlots(*lock_mgr_, keys, slots());
+  for (size_t i = 0; i < num_slots_; i++) {
+    lock_mgr_->LockSlot(slots()[i], mode_);
+  }
+}
+
+void RecordLockGuard::Unlock() {
+  for (size_t i = num_slots_; i > 0; i--) {
+    lock_mgr_->UnlockSlot(slots()[i - 1], mode_);
+  }
+  num_slots_ = 0;
+}
+
+}  // namespace pstd::lock
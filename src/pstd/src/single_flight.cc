@@ -0,0 +1,42 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "pstd/include/single_flight.h"
+
+#include <functional>
+
+namespace pstd {
+
+SingleFlight::Stripe& SingleFlight::StripeOf(const std::string& key) {
+  return stripes_[std::hash<std::string>{}(key) % kStripes];
+}
+
+bool SingleFlight::Begin(const std::string& key, std::chrono::milliseconds wait) {
+  Stripe& stripe = StripeOf(key);
+  std::unique_lock l(stripe.mu);
+  auto iter = stripe.flights.find(key);
+  if (iter == stripe.flights.end()) {
+    stripe.flights.emplace(key, std::make_shared<Flight>());
+    return true;
+  }
+  // Keeps the flight alive after the leader erased it
+  std::shared_ptr<Flight> flight = iter->second;
+  flight->cv.wait_for(l, wait, [&flight] { return flight->done; });
+  return false;
+}
+
+void SingleFlight::End(const std::string& key) {
+  Stripe& stripe = StripeOf(key);
+  std::lock_guard l(stripe.mu);
+  auto iter = stripe.flights.find(key);
+  if (iter == stripe.flights.end()) {
+    return;
+  }
+  iter->second->done = true;
+  iter->second->cv.notify_all();
+  stripe.flights.erase(iter);
+}
+
+}  // namespace pstd
@@ -0,0 +1,63 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "pstd/include/frequency_sketch.h"
+
+namespace pstd {
+
+TEST(FrequencySketchTest, CountsAndSaturates) {
+  FrequencySketch sketch(1000);
+  ASSERT_EQ(sketch.capacity(), 1024);
+  EXPECT_EQ(sketch.Frequency("key"), 0);
+  for (int i = 0; i < 5; i++) {
+    sketch.Increment("key");
+  }
+  EXPECT_EQ(sketch.Frequency("key"), 5);
+  for (int i = 0; i < 100; i++) {
+    sketch.Increment("key");
+  }
+  EXPECT_EQ(sketch.Frequency("key"), FrequencySketch::kMaxFrequency);
+
+  sketch.Clear();
+  EXPECT_EQ(sketch.Frequency("key"), 0);
+}
+
+TEST(FrequencySketchTest, HotKeysStandOut) {
+  FrequencySketch sketch(2048);
+  for (int i = 0; i < 2000; i++) {
+    sketch.Increment("one-hit:" + std::to_string(i));
+    if (i % 100 == 0) {
+      for (int j = 0; j < 5; j++) {
+        sketch.Increment("hot");
+      }
+    }
+  }
+  EXPECT_GE(sketch.Frequency("hot"), 10);
+  int above_one = 0;
+  for (int i = 0; i < 2000; i++) {
+    above_one += sketch.Frequency("one-hit:" + std::to_string(i)) > 1 ? 1 : 0;
+  }
+  // Colliding in every row is rare with sixteen counters per key
+  EXPECT_LT(above_one, 40);
+}
+
+TEST(FrequencySketchTest, AgingHalves) {
+  FrequencySketch sketch(64);
+  for (int i = 0; i < 8; i++) {
+    sketch.Increment("hot");
+  }
+  EXPECT_EQ(sketch.Frequency("hot"), 8);
+  // Ten increments per key make a sample, then every counter is halved
+  for (int i = 0; i < 640 - 8; i++) {
+    sketch.Increment("filler:" + std::to_string(i));
+  }
+  EXPECT_LE(sketch.Frequency("hot"), 4);
+}
+
+}  // namespace pstd
@@ -0,0 +1,140 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "pstd/include/record_lock_mgr.h"
+
+namespace pstd::lock {
+
+class RecordLockMgrTest : public ::testing::Test {
+ protected:
+  std::shared_ptr<RecordLockMgr> lock_mgr_ = std::make_shared<RecordLockMgr>(1024);
+};
+
+TEST_F(RecordLockMgrTest, SlotsRoundedUp) {
+  RecordLockMgr lock_mgr(1000);
+  ASSERT_EQ(lock_mgr.num_slots(), 1024);
+  ASSERT_LT(lock_mgr.SlotOf("key"), 1024);
+  ASSERT_EQ(lock_mgr.SlotOf("key"), lock_mgr.SlotOf(std::string("key")));
+}
+
+TEST_F(RecordLockMgrTest, SharedAndExclusive) {
+  uint32_t slot = lock_mgr_->SlotOf("key");
+  {
+    RecordLockGuard reader(lock_mgr_, "key", LockMode::kShared);
+    ASSERT_TRUE(lock_mgr_->TryLockSlot(slot, LockMode::kShared));
+    ASSERT_FALSE(lock_mgr_->TryLockSlot(slot, LockMode::kExclusive));
+    lock_mgr_->UnlockSlot(slot, LockMode::kShared);
+  }
+  {
+    RecordLockGuard writer(lock_mgr_, "key", LockMode::kExclusive);
+    ASSERT_FALSE(lock_mgr_->TryLockSlot(slot, LockMode::kShared));
+    ASSERT_FALSE(lock_mgr_->TryLockSlot(slot, LockMode::kExclusive));
+  }
+  ASSERT_TRUE(lock_mgr_->TryLockSlot(slot, LockMode::kExclusive));
+  lock_mgr_->UnlockSlot(slot, LockMode::kExclusive);
+}
+
+TEST_F(RecordLockMgrTest, DuplicateKeys) {
+  std::vector<std::string> keys = {"a", "b", "a", "", "", "b"};
+  for (int i = 0; i < 20; i++) {
+    keys.push_back("key" + std::to_string(i));
+  }
+  {
+    RecordLockGuard guard(lock_mgr_, keys, LockMode::kExclusive);
+    for (const auto& key : keys) {
+      ASSERT_FALSE(lock_mgr_->TryLockSlot(lock_mgr_->SlotOf(key), LockMode::kShared));
+    }
+  }
+  lock_mgr_->Lock(keys, LockMode::kShared);
+  lock_mgr_->Lock(keys, LockMode::kShared);
+  lock_mgr_->Unlock(keys, LockMode::kShared);
+  lock_mgr_->Unlock(keys, LockMode::kShared);
+  for (const auto& key : keys) {
+    ASSERT_TRUE(lock_mgr_->TryLockSlot(lock_mgr_->SlotOf(key), LockMode::kExclusive));
+    lock_mgr_->UnlockSlot(lock_mgr_->SlotOf(key), LockMode::kExclusive);
+  }
+}
+
+TEST_F(RecordLockMgrTest, ParkedWaiterWakesUp) {
+  RecordLockGuard writer(lock_mgr_, "key", LockMode::kExclusive);
+  std::atomic<bool> locked = false;
+  std::thread waiter([&] {
+    RecordLockGuard guard(lock_mgr_, "key", LockMode::kExclusive);
+    locked = true;
+  });
+  // Long enough for the waiter to park
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  ASSERT_FALSE(locked);
+  writer.Unlock();
+  waiter.join();
+  ASSERT_TRUE(locked);
+}
+
+TEST_F(RecordLockMgrTest, WaitingWriterHoldsOffReaders) {
+  uint32_t slot = lock_mgr_->SlotOf("key");
+  RecordLockGuard reader(lock_mgr_, "key", LockMode::kShared);
+  std::atomic<bool> locked = false;
+  std::thread writer([&] {
+    RecordLockGuard guard(lock_mgr_, "key", LockMode::kExclusive);
+    locked = true;
+  });
+  // Long enough for the writer to park
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  ASSERT_FALSE(locked);
+  ASSERT_FALSE(lock_mgr_->TryLockSlot(slot, LockMode::kShared));
+  reader.Unlock();
+  writer.join();
+  ASSERT_TRUE(locked);
+  ASSERT_TRUE(lock_mgr_->TryLockSlot(slot, LockMode::kShared));
+  lock_mgr_->UnlockSlot(slot, LockMode::kShared);
+  ASSERT_TRUE(lock_mgr_->TryLockSlot(slot, LockMode::kExclusive));
+  lock_mgr_->UnlockSlot(slot, LockMode::kExclusive);
+}
+
+TEST_F(RecordLockMgrTest, MutualExclusion) {
+  constexpr int kThreads = 8;
+  constexpr int kRounds = 20000;
+  // Counters protected by the record locks of their keys
+  std::vector<int64_t> counters(16, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t] {
+      std::mt19937 rand(t);
+      for (int i = 0; i < kRounds; i++) {
+        // Random multi-key sets in random order must not deadlock
+        std::vector<std::string> keys;
+        std::vector<size_t> indexes;
+        for (int k = 0; k < 3; k++) {
+          size_t index = rand() % counters.size();
+          indexes.push_back(index);
+          keys.push_back("counter" + std::to_string(index));
+        }
+        RecordLockGuard guard(lock_mgr_, keys, LockMode::kExclusive);
+        for (size_t index : indexes) {
+          counters[index]++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  int64_t total = 0;
+  for (int64_t counter : counters) {
+    total += counter;
+  }
+  ASSERT_EQ(total, static_cast<int64_t>(kThreads) * kRounds * 3);
+}
+
+}  // namespace pstd::lock
@@ -0,0 +1,106 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "pstd/include/single_flight.h"
+
+namespace pstd {
+
+// The wait of the cache readers, see PikaCache::kLoadWait
+static constexpr std::chrono::milliseconds kLoadWait{100};
+
+TEST(SingleFlightTest, LeaderHandsOffToWaiters) {
+  SingleFlight flight;
+  ASSERT_TRUE(flight.Begin("key", kLoadWait));
+  // Other keys are independent
+  ASSERT_TRUE(flight.Begin("other", kLoadWait));
+  flight.End("other");
+
+  std::atomic<int> leaders = 0;
+  std::atomic<bool> loaded = false;
+  std::atomic<int> saw_loaded = 0;
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 8; i++) {
+    readers.emplace_back([&] {
+      if (flight.Begin("key", std::chrono::seconds(10))) {
+        leaders++;
+        flight.End("key");
+      } else if (loaded.load()) {
+        saw_loaded++;
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  loaded.store(true);
+  flight.End("key");
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  // Every reader waited for the leader and none of them loaded again
+  EXPECT_EQ(leaders, 0);
+  EXPECT_EQ(saw_loaded, 8);
+
+  // Ended, the next caller leads again
+  ASSERT_TRUE(flight.Begin("key", kLoadWait));
+  flight.End("key");
+}
+
+TEST(SingleFlightTest, WaiterTimesOut) {
+  SingleFlight flight;
+  ASSERT_TRUE(flight.Begin("key", kLoadWait));
+
+  // The leader takes too long, the waiter gives up after the wait
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_FALSE(flight.Begin("key", kLoadWait));
+  auto waited = std::chrono::steady_clock::now() - start;
+  EXPECT_GE(waited, kLoadWait);
+  EXPECT_LT(waited, std::chrono::seconds(5));
+
+  // Giving up does not take over the load, the leader still owns it
+  ASSERT_FALSE(flight.Begin("key", std::chrono::milliseconds(1)));
+  flight.End("key");
+  ASSERT_TRUE(flight.Begin("key", kLoadWait));
+  flight.End("key");
+}
+
+TEST(SingleFlightTest, FailingLeader) {
+  SingleFlight flight;
+  ASSERT_TRUE(flight.Begin("key", kLoadWait));
+
+  std::atomic<int> woken = 0;
+  std::vector<std::thread> waiters;
+  for (int i = 0; i < 4; i++) {
+    waiters.emplace_back([&] {
+      if (!flight.Begin("key", std::chrono::seconds(10))) {
+        woken++;
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  // The load failed, the leader ends without filling anything in
+  auto start = std::chrono::steady_clock::now();
+  flight.End("key");
+  for (auto& waiter : waiters) {
+    waiter.join();
+  }
+  // The waiters are released at once rather than after their wait
+  EXPECT_EQ(woken, 4);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+
+  // A waiter retrying finds no load in flight and leads the next one
+  ASSERT_TRUE(flight.Begin("key", kLoadWait));
+  flight.End("key");
+  // Ending a key without a flight does nothing
+  flight.End("key");
+  flight.End("missing");
+}
+
+}  // namespace pstd
@@ -4,6 +4,8 @@
 // of patent rights can be found in the PATENTS file in the same directory.
 
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 #include <fstream>
 
 #include "rocksdb/env.h"
@@ -18,8 +20,6 @@ using namespace RsyncService;
 extern PikaServer* g_pika_server;
 
 const int kFlushIntervalUs = 10 * 1000 * 1000;
-const int kBytesPerRequest = 4 << 20;
-const int kThrottleCheckCycle = 10;
 
 namespace rsync {
 RsyncClient::RsyncClient(const std::string& dir, const std::string& db_name)
@@ -29,21 +29,34 @@ RsyncClient::RsyncClient(const std::string& dir, const std::string& db_name)
   wo_mgr_.reset(new WaitObjectManager());
   client_thread_ = std::make_unique<RsyncClientThread>(3000, 60, wo_mgr_.get());
   client_thread_->set_thread_name("RsyncClientThread");
+  fetcher_ = std::make_unique<RsyncFetcher>(dir_, db_name_, client_thread_.get(), wo_mgr_.get(),
+                                            &Throttle::GetInstance());
+  fetcher_->SetRunning([this] { return state_.load() == RUNNING; });
+  fetcher_->SetTimeout([] { return static_cast<int64_t>(g_pika_conf->rsync_timeout_ms()); });
   work_threads_.resize(GetParallelNum());
   finished_work_cnt_.store(0);
 }
 
 void RsyncClient::Copy(const std::set<std::string>& file_set, int index) {
   Status s = Status::OK();
+  // The window carries over from one file to the next one of the worker
+  RsyncWindow window(g_pika_conf->max_rsync_window_size());
   for (const auto& file : file_set) {
     while (state_.load() == RUNNING) {
       LOG(INFO) << "copy remote file, filename: " << file;
-      s = CopyRemoteFile(file, index);
-      if (!s.ok()) {
-        LOG(WARNING) << "copy remote file failed, msg: " << s.ToString();
-        continue;
+      s = fetcher_->CopyRemoteFile(file, index, &window);
+      if (s.ok()) {
+        transferred_files_.fetch_add(1);
+        std::lock_guard<std::mutex> guard(mu_);
+        meta_table_[file] = "";
+        break;
+      }
+      LOG(WARNING) << "copy remote file failed, msg: " << s.ToString();
+      if (s.IsIncomplete()) {
+        // Stopped, or the master serves a newer dump, which takes a new full sync
+        state_.store(STOP);
+        break;
       }
-      break;
     }
     if (state_.load() != RUNNING) {
       break;
@@ -62,6 +75,10 @@ bool RsyncClient::Init() {
   master_ip_ = g_pika_server->master_ip();
   master_port_ = g_pika_server->master_port() + kPortShiftRsync2;
   file_set_.clear();
+  reused_files_.store(0);
+  reused_bytes_.store(0);
+  transferred_files_.store(0);
+  fetcher_->ResetStats();
   client_thread_->StartThread();
   bool ret = ComparisonUpdate();
   if (!ret) {
@@ -70,6 +87,7 @@ bool RsyncClient::Init() {
     state_.store(IDLE);
     return false;
   }
+  fetcher_->SetSource(master_ip_, master_port_, snapshot_uuid_);
   finished_work_cnt_.store(0);
   LOG(INFO) << "RsyncClient recover success";
   return true;
@@ -148,103 +166,6 @@ void* RsyncClient::ThreadMain() {
   return nullptr;
 }
 
-Status RsyncClient::CopyRemoteFile(const std::string& filename, int index) {
-    const std::string filepath = dir_ + "/" + filename;
-    std::unique_ptr<RsyncWriter> writer(new RsyncWriter(filepath));
-    Status s = Status::OK();
-    size_t offset = 0;
-    int retries = 0;
-
-    DEFER {
-      if (writer) {
-        writer->Close();
-        writer.reset();
-      }
-      if (!s.ok()) {
-        DeleteFile(filepath);
-      }
-    };
-
-    while (retries < max_retries_) {
-      if (state_.load() != RUNNING) {
-        break;
-      }
-      size_t copy_file_begin_time = pstd::NowMicros();
-      size_t count = Throttle::GetInstance().ThrottledByThroughput(kBytesPerRequest);
-      if (count == 0) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000 / kThrottleCheckCycle));
-        continue;
-      }
-      RsyncRequest request;
-      request.set_reader_index(index);
-      request.set_type(kRsyncFile);
-      request.set_db_name(db_name_);
-      /*
-       * Since the slot field is written in protobuffer,
-       * slot_id is set to the default value 0 for compatibility
-       * with older versions, but slot_id is not used
-       */
-      request.set_slot_id(0);
-      FileRequest* file_req = request.mutable_file_req();
-      file_req->set_filename(filename);
-      file_req->set_offset(offset);
-      file_req->set_count(count);
-
-      std::string to_send;
-      request.SerializeToString(&to_send);
-      WaitObject* wo = wo_mgr_->UpdateWaitObject(index, filename, kRsyncFile, offset);
-      s = client_thread_->Write(master_ip_, master_port_, to_send);
-      if (!s.ok()) {
-        LOG(WARNING) << "send rsync request failed";
-        continue;
-      }
-
-      std::shared_ptr<RsyncResponse> resp = nullptr;
-      s = wo->Wait(resp);
-      if (s.IsTimeout() || resp == nullptr) {
-        LOG(WARNING) << s.ToString();
-        retries++;
-        continue;
-      }
-
-      if (resp->code() != RsyncService::kOk) {
-        return Status::IOError("kRsyncFile request failed, master response error code");
-      }
-
-      size_t ret_count = resp->file_resp().count();
-      size_t elaspe_time_us = pstd::NowMicros() - copy_file_begin_time;
-      Throttle::GetInstance().ReturnUnusedThroughput(count, ret_count, elaspe_time_us);
-
-      if (resp->snapshot_uuid() != snapshot_uuid_) {
-        LOG(WARNING) << "receive newer dump, reset state to STOP, local_snapshot_uuid:"
-                     << snapshot_uuid_ << "remote snapshot uuid: " << resp->snapshot_uuid();
-        state_.store(STOP);
-        return s;
-      }
-
-      s = writer->Write((uint64_t)offset, ret_count, resp->file_resp().data().c_str());
-      if (!s.ok()) {
-        LOG(WARNING) << "rsync client write file error";
-        break;
-      }
-
-      offset += resp->file_resp().count();
-      if (resp->file_resp().eof()) {
-        s = writer->Fsync();
-        if (!s.ok()) {
-            return s;
-        } 
-        mu_.lock();
-        meta_table_[filename] = "";
-        mu_.unlock();
-        break;
-      }
-      retries = 0;
-    }
-
-  return s;
-}
-
 Status RsyncClient::Start() {
   StartThread();
   return Status::OK();
@@ -271,8 +192,9 @@ bool RsyncClient::ComparisonUpdate() {
   std::set<std::string> local_file_set;
   std::set<std::string> remote_file_set;
   std::map<std::string, std::string> local_file_map;
+  SstIdentityMap remote_ssts;
 
-  Status s = PullRemoteMeta(&remote_snapshot_uuid, &remote_file_set);
+  Status s = PullRemoteMeta(&remote_snapshot_uuid, &remote_file_set, &remote_ssts);
   if (!s.ok()) {
     LOG(WARNING) << "copy remote meta failed! error:" << s.ToString();
     return false;
@@ -313,6 +235,7 @@ bool RsyncClient::ComparisonUpdate() {
     LOG(WARNING) << "update local meta failed";
     return false;
   }
+  ReuseLocalSstFiles(remote_ssts);
 
   state_ = RUNNING;
   LOG(INFO) << "copy meta data done, db name: " << db_name_
@@ -323,13 +246,16 @@ bool RsyncClient::ComparisonUpdate() {
             << " remote file count: " << remote_file_set.size()
             << " remote snapshot_uuid: " << remote_snapshot_uuid
             << " local snapshot_uuid: " << local_snapshot_uuid
-            << " file_set_: " << file_set_.size();
+            << " file_set_: " << file_set_.size()
+            << " reused sst file count: " << reused_files_.load()
+            << " reused sst bytes: " << reused_bytes_.load();
   for_each(file_set_.begin(), file_set_.end(),
            [](auto& file) {LOG(WARNING) << "file_set: " << file;});
   return true;
 }
 
-Status RsyncClient::PullRemoteMeta(std::string* snapshot_uuid, std::set<std::string>* file_set) {
+Status RsyncClient::PullRemoteMeta(std::string* snapshot_uuid, std::set<std::string>* file_set,
+                                   SstIdentityMap* remote_ssts) {
   Status s;
   int retries = 0;
   RsyncRequest request;
@@ -345,13 +271,14 @@ Status RsyncClient::PullRemoteMeta(std::string* snapshot_uuid, std::set<std::str
   std::string to_send;
   request.SerializeToString(&to_send);
   while (retries < max_retries_) {
-    WaitObject* wo = wo_mgr_->UpdateWaitObject(0, "", kRsyncMeta, kInvalidOffset);
+    WaitObject* wo = wo_mgr_->UpdateWaitObject(0, "", kRsyncMeta);
+    wo->Expect(kInvalidOffset);
     s = client_thread_->Write(master_ip_, master_port_, to_send);
     if (!s.ok()) {
       retries++;
     }
     std::shared_ptr<RsyncResponse> resp;
-    s = wo->Wait(resp);
+    s = wo->Wait(kInvalidOffset, g_pika_conf->rsync_timeout_ms(), resp);
     if (s.IsTimeout()) {
       LOG(WARNING) << "rsync PullRemoteMeta request timeout, "
                    << "retry times: " << retries;
@@ -371,6 +298,13 @@ Status RsyncClient::PullRemoteMeta(std::string* snapshot_uuid, std::set<std::str
     for (std::string item : resp->meta_resp().filenames()) {
       file_set->insert(item);
     }
+    for (const auto& file_meta : resp->meta_resp().sst_files()) {
+      SstIdentity& sst = (*remote_ssts)[file_meta.filename()];
+      sst.size = file_meta.size();
+      sst.checksum_func = file_meta.checksum_func();
+      sst.checksum = file_meta.checksum();
+      sst.unique_id = file_meta.unique_id();
+    }
 
     *snapshot_uuid = resp->snapshot_uuid();
     s = Status::OK();
@@ -495,6 +429,60 @@ Status RsyncClient::UpdateLocalMeta(const std::string& snapshot_uuid, const std:
   return Status::OK();
 }
 
+/*
+ * Links the SST files of the local DB that the dump holds as well into the
+ * rsync directory, and takes them off the files to pull. SST files are never
+ * modified, the links keep them around when the local DB drops them.
+ */
+void RsyncClient::ReuseLocalSstFiles(const SstIdentityMap& remote_ssts) {
+  if (remote_ssts.empty()) {
+    return;
+  }
+  std::shared_ptr<DB> db = g_pika_server->GetDB(db_name_);
+  if (!db) {
+    return;
+  }
+  SstIdentityMap local_ssts;
+  GetLiveSstIdentities(db->storage().get(), g_pika_conf->db_instance_num(), &local_ssts);
+  // A file keeps its unique id under whatever name the slave gave it
+  std::map<std::string, const SstIdentity*> local_by_id;
+  for (const auto& local : local_ssts) {
+    local_by_id[local.second.unique_id] = &local.second;
+  }
+
+  std::string db_path = dir_ + (dir_.back() == '/' ? "" : "/");
+  for (const auto& remote : remote_ssts) {
+    auto local = local_by_id.find(remote.second.unique_id);
+    if (file_set_.find(remote.first) == file_set_.end() || local == local_by_id.end() ||
+        !local->second->SameContent(remote.second)) {
+      continue;
+    }
+    const std::string filepath = db_path + remote.first;
+    DeleteFile(filepath);
+    if (link(local->second->path.c_str(), filepath.c_str()) != 0) {
+      LOG(WARNING) << "link " << local->second->path << " to " << filepath
+                   << " failed, pull it from master instead, error: " << strerror(errno);
+      continue;
+    }
+    file_set_.erase(remote.first);
+    {
+      std::lock_guard<std::mutex> guard(mu_);
+      meta_table_[remote.first] = "";
+    }
+    reused_files_.fetch_add(1);
+    reused_bytes_.fetch_add(remote.second.size);
+  }
+}
+
+RsyncClient::Stats RsyncClient::GetStats() {
+  Stats stats;
+  stats.reused_files = reused_files_.load();
+  stats.reused_bytes = reused_bytes_.load();
+  stats.transferred_files = transferred_files_.load();
+  stats.transferred_bytes = fetcher_->transferred_bytes();
+  return stats;
+}
+
 std::string RsyncClient::GetLocalMetaFilePath() {
   std::string db_path = dir_ + (dir_.back() == '/' ? "" : "/");
   return db_path + kDumpMetaFileName;
@@ -4,7 +4,7 @@
 // of patent rights can be found in the PATENTS file in the same directory.
 
 #include "include/rsync_client_thread.h"
-#include "include/rsync_client.h"
+#include "include/rsync_fetcher.h"
 #include "include/pika_define.h"
 
 using namespace pstd;
@@ -12,7 +12,6 @@ using namespace net;
 using namespace RsyncService;
 
 namespace rsync {
-class RsyncClient;
 RsyncClientConn::RsyncClientConn(int fd, const std::string& ip_port,
     net::Thread* thread, void* worker_specific_data, NetMultiplexer* mpx)
     : PbConn(fd, ip_port, thread, mpx), cb_handler_(worker_specific_data) {}
@@ -0,0 +1,189 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "include/rsync_fetcher.h"
+
+#include <thread>
+
+#include "pstd/include/env.h"
+#include "pstd/include/pstd_defer.h"
+
+using namespace RsyncService;
+
+const int kThrottleCheckCycle = 10;
+
+namespace rsync {
+
+RsyncFetcher::RsyncFetcher(const std::string& dir, const std::string& db_name, RsyncClientThread* client_thread,
+                           WaitObjectManager* wo_mgr, Throttle* throttle)
+    : dir_(dir), db_name_(db_name), client_thread_(client_thread), wo_mgr_(wo_mgr), throttle_(throttle) {}
+
+void RsyncFetcher::SetSource(const std::string& ip, int port, const std::string& snapshot_uuid) {
+  master_ip_ = ip;
+  master_port_ = port;
+  snapshot_uuid_ = snapshot_uuid;
+}
+
+Status RsyncFetcher::CopyRemoteFile(const std::string& filename, int index, RsyncWindow* window) {
+  struct InFlight {
+    size_t count;
+    uint64_t send_time_us;
+  };
+
+  const std::string filepath = dir_ + "/" + filename;
+  std::unique_ptr<RsyncWriter> writer(new RsyncWriter(filepath));
+  Status s = Status::OK();
+  // Bytes written to the local file so far, chunks are written in order
+  size_t offset = 0;
+  // Where the next request starts, the chunks in between are in flight
+  size_t request_offset = 0;
+  // Unknown until the first response, and for masters that do not report
+  // it, in which case the chunks are requested one at a time
+  size_t file_size = 0;
+  bool file_size_known = false;
+  std::map<size_t, InFlight> in_flight;
+  int retries = 0;
+
+  WaitObject* wo = wo_mgr_->UpdateWaitObject(index, filename, kRsyncFile);
+  // Drops the requests in flight, their responses are ignored from now on,
+  // so the throttle gets their bytes back
+  auto drop_in_flight = [&]() {
+    uint64_t now_us = pstd::NowMicros();
+    for (const auto& [request, flight] : in_flight) {
+      throttle_->ReturnUnusedThroughput(flight.count, 0, now_us - flight.send_time_us);
+    }
+    wo->Reset(filename, kRsyncFile);
+    in_flight.clear();
+  };
+
+  DEFER {
+    drop_in_flight();
+    if (writer) {
+      writer->Close();
+      writer.reset();
+    }
+    if (!s.ok()) {
+      pstd::DeleteFile(filepath);
+    }
+  };
+
+  while (retries < max_retries_) {
+    if (!running_()) {
+      s = Status::Incomplete("rsync stopped");
+      return s;
+    }
+
+    size_t window_size = file_size_known ? window->Size() : 1;
+    while (in_flight.size() < window_size && (!file_size_known || request_offset < file_size)) {
+      size_t count = throttle_->ThrottledByThroughput(chunk_size_);
+      if (count == 0) {
+        break;
+      }
+      wo->Expect(request_offset);
+      s = SendFileRequest(filename, index, request_offset, count);
+      if (!s.ok()) {
+        throttle_->ReturnUnusedThroughput(count, 0, 0);
+        break;
+      }
+      in_flight[request_offset] = {count, pstd::NowMicros()};
+      request_offset += count;
+    }
+    if (!s.ok()) {
+      LOG(WARNING) << "send rsync request failed";
+      // The next requests start from the first byte missing
+      drop_in_flight();
+      request_offset = offset;
+      retries++;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1000 / kThrottleCheckCycle));
+      continue;
+    }
+    if (in_flight.empty()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1000 / kThrottleCheckCycle));
+      continue;
+    }
+
+    auto head = in_flight.begin();
+    std::shared_ptr<RsyncResponse> resp = nullptr;
+    s = wo->Wait(head->first, timeout_ms_(), resp);
+    if (s.IsTimeout() || resp == nullptr) {
+      LOG(WARNING) << s.ToString();
+      retries++;
+      window->OnTimeout();
+      drop_in_flight();
+      request_offset = offset;
+      continue;
+    }
+
+    if (resp->code() != RsyncService::kOk) {
+      s = Status::IOError("kRsyncFile request failed, master response error code");
+      return s;
+    }
+
+    // Off the requests in flight before its bytes go back to the throttle
+    InFlight flight = head->second;
+    in_flight.erase(head);
+    size_t ret_count = resp->file_resp().count();
+    throttle_->ReturnUnusedThroughput(flight.count, ret_count, pstd::NowMicros() - flight.send_time_us);
+
+    if (resp->snapshot_uuid() != snapshot_uuid_) {
+      LOG(WARNING) << "receive newer dump, local_snapshot_uuid:" << snapshot_uuid_
+                   << "remote snapshot uuid: " << resp->snapshot_uuid();
+      s = Status::Incomplete("master serves a newer dump");
+      return s;
+    }
+
+    s = writer->Write((uint64_t)offset, ret_count, resp->file_resp().data().c_str());
+    if (!s.ok()) {
+      LOG(WARNING) << "rsync client write file error";
+      return s;
+    }
+
+    offset += ret_count;
+    transferred_bytes_.fetch_add(ret_count);
+    window->OnChunk(ret_count);
+    if (resp->file_resp().eof()) {
+      s = writer->Fsync();
+      return s;
+    }
+    if (resp->file_resp().has_file_size()) {
+      file_size = resp->file_resp().file_size();
+      file_size_known = true;
+    }
+    // A short chunk leaves a hole before the requests that follow it
+    if (ret_count != flight.count) {
+      drop_in_flight();
+      request_offset = offset;
+    }
+    retries = 0;
+  }
+
+  if (s.ok()) {
+    s = Status::Timeout("rsync copy remote file", "retries exhausted");
+  }
+  return s;
+}
+
+Status RsyncFetcher::SendFileRequest(const std::string& filename, int index, size_t offset, size_t count) {
+  RsyncRequest request;
+  request.set_reader_index(index);
+  request.set_type(kRsyncFile);
+  request.set_db_name(db_name_);
+  /*
+   * Since the slot field is written in protobuffer,
+   * slot_id is set to the default value 0 for compatibility
+   * with older versions, but slot_id is not used
+   */
+  request.set_slot_id(0);
+  FileRequest* file_req = request.mutable_file_req();
+  file_req->set_filename(filename);
+  file_req->set_offset(offset);
+  file_req->set_count(count);
+
+  std::string to_send;
+  request.SerializeToString(&to_send);
+  return client_thread_->Write(master_ip_, master_port_, to_send);
+}
+
+}  // namespace rsync
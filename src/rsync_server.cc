@@ -9,11 +9,9 @@
 #include <google/protobuf/map.h>
 
 #include "pstd_hash.h"
-#include "include/pika_server.h"
 #include "include/rsync_server.h"
 #include "pstd/include/pstd_defer.h"
 
-extern PikaServer* g_pika_server;
 namespace rsync {
 
 using namespace net;
@@ -30,8 +28,11 @@ void RsyncWriteResp(RsyncService::RsyncResponse& response, std::shared_ptr<net::
   conn->NotifyWrite();
 }
 
-RsyncServer::RsyncServer(const std::set<std::string>& ips, const int port) {
-  work_thread_ = std::make_unique<net::ThreadPool>(2, 100000, "RsyncServerWork");
+RsyncServer::RsyncServer(const std::set<std::string>& ips, const int port,
+                         std::unique_ptr<RsyncDumpProvider> provider, int work_num)
+    : provider_(std::move(provider)) {
+  // One thread per rsync worker of a slave, the chunks of different files are read in parallel
+  work_thread_ = std::make_unique<net::ThreadPool>(work_num, 100000, "RsyncServerWork");
   rsync_server_thread_ = std::make_unique<RsyncServerThread>(ips, port, 1 * 1000, this);
 }
 
@@ -114,9 +115,9 @@ int RsyncServerConn::DealMessage() {
 void RsyncServerConn::HandleMetaRsyncRequest(void* arg) {
   std::unique_ptr<RsyncServerTaskArg> task_arg(static_cast<RsyncServerTaskArg*>(arg));
   const std::shared_ptr<RsyncService::RsyncRequest> req = task_arg->req;
-  std::shared_ptr<net::PbConn> conn = task_arg->conn;
+  std::shared_ptr<RsyncServerConn> conn = task_arg->conn;
   std::string db_name = req->db_name();
-  std::shared_ptr<DB> db = g_pika_server->GetDB(db_name);
+  RsyncDumpProvider* provider = static_cast<RsyncServer*>(conn->data_)->provider();
 
   RsyncService::RsyncResponse response;
   response.set_reader_index(req->reader_index());
@@ -131,28 +132,23 @@ void RsyncServerConn::HandleMetaRsyncRequest(void* arg) {
   response.set_slot_id(0);
 
   std::string snapshot_uuid;
-  if (!db || db->IsBgSaving()) {
-    LOG(WARNING) << "waiting bgsave done...";
-    response.set_snapshot_uuid(snapshot_uuid);
+  RsyncService::MetaResponse* meta_resp = response.mutable_meta_resp();
+  Status s = provider->GetDumpMeta(db_name, &snapshot_uuid, meta_resp);
+  if (!s.ok()) {
+    LOG(WARNING) << "waiting bgsave done... " << s.ToString();
+    response.clear_meta_resp();
+    response.set_snapshot_uuid("");
     response.set_code(RsyncService::kErr);
     RsyncWriteResp(response, conn);
     return;
   }
-
-  std::vector<std::string> filenames;
-  g_pika_server->GetDumpMeta(db_name, &filenames, &snapshot_uuid);
   response.set_snapshot_uuid(snapshot_uuid);
 
   LOG(INFO) << "Rsync Meta request, snapshot_uuid: " << snapshot_uuid
-            << " files count: " << filenames.size() << " file list: ";
-  std::for_each(filenames.begin(), filenames.end(), [](auto& file) {
+            << " files count: " << meta_resp->filenames_size() << " file list: ";
+  std::for_each(meta_resp->filenames().begin(), meta_resp->filenames().end(), [](auto& file) {
     LOG(INFO) << "rsync snapshot file: " << file;
   });
-
-  RsyncService::MetaResponse* meta_resp = response.mutable_meta_resp();
-  for (const auto& filename : filenames) {
-        meta_resp->add_filenames(filename);
-  }
   RsyncWriteResp(response, conn);
 }
 
@@ -179,47 +175,34 @@ void RsyncServerConn::HandleFileRsyncRequest(void* arg) {
   response.set_slot_id(0);
 
   std::string snapshot_uuid;
-  Status s = g_pika_server->GetDumpUUID(db_name, &snapshot_uuid);
+  std::string dump_path;
+  RsyncDumpProvider* provider = static_cast<RsyncServer*>(conn->data_)->provider();
+  Status s = provider->GetDumpPath(db_name, &snapshot_uuid, &dump_path);
   response.set_snapshot_uuid(snapshot_uuid);
   if (!s.ok()) {
-    LOG(WARNING) << "rsyncserver get snapshotUUID failed";
+    LOG(WARNING) << "rsyncserver get dump of db " << db_name << " failed: " << s.ToString();
     response.set_code(RsyncService::kErr);
     RsyncWriteResp(response, conn);
     return;
   }
 
-  std::shared_ptr<DB> db = g_pika_server->GetDB(db_name);
-  if (!db) {
-   LOG(WARNING) << "cannot find db for db_name: " << db_name;
-   response.set_code(RsyncService::kErr);
-   RsyncWriteResp(response, conn);
-  }
+  const std::string filepath = dump_path + "/" + filename;
+  RsyncService::FileResponse* file_resp = response.mutable_file_resp();
+  file_resp->set_checksum("");
+  file_resp->set_filename(filename);
 
-  const std::string filepath = db->bgsave_info().path + "/" + filename;
-  char* buffer = new char[req->file_req().count() + 1];
-  size_t bytes_read{0};
-  std::string checksum = "";
-  bool is_eof = false;
+  std::string frame;
   std::shared_ptr<RsyncReader> reader = conn->readers_[req->reader_index()];
-  s = reader->Read(filepath, offset, count, buffer,
-                   &bytes_read, &checksum, &is_eof);
+  s = reader->ReadFrame(filepath, offset, count, &response, &frame);
   if (!s.ok()) {
+    response.clear_file_resp();
     response.set_code(RsyncService::kErr);
     RsyncWriteResp(response, conn);
-    delete []buffer;
     return;
   }
 
-  RsyncService::FileResponse* file_resp = response.mutable_file_resp();
-  file_resp->set_data(buffer, bytes_read);
-  file_resp->set_eof(is_eof);
-  file_resp->set_checksum(checksum);
-  file_resp->set_filename(filename);
-  file_resp->set_count(bytes_read);
-  file_resp->set_offset(offset);
-
-  RsyncWriteResp(response, conn);
-  delete []buffer;
+  conn->WriteResp(std::move(frame));
+  conn->NotifyWrite();
 }
 
 RsyncServerThread::RsyncServerThread(const std::set<std::string>& ips, int port, int cron_interval, RsyncServer* arg)
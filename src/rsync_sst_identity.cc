@@ -0,0 +1,122 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "include/rsync_sst_identity.h"
+
+#include <sys/stat.h>
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "include/pika_define.h"
+#include "rocksdb/db.h"
+#include "rocksdb/metadata.h"
+#include "rocksdb/unique_id.h"
+
+namespace rsync {
+
+static std::string HexEncode(const std::string& raw) {
+  static const char kHexDigits[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(raw.size() * 2);
+  for (unsigned char c : raw) {
+    hex.push_back(kHexDigits[c >> 4]);
+    hex.push_back(kHexDigits[c & 0xf]);
+  }
+  return hex;
+}
+
+void GetLiveSstIdentities(storage::Storage* storage, int instance_num, SstIdentityMap* ssts) {
+  for (int index = 0; index < instance_num; index++) {
+    rocksdb::DB* db = storage->GetDBByIndex(index);
+    if (db == nullptr) {
+      continue;
+    }
+    rocksdb::TablePropertiesCollection props;
+    rocksdb::Status s = storage->GetPropertiesOfAllTables(index, &props);
+    if (!s.ok()) {
+      LOG(WARNING) << "get table properties of db " << index << " failed, " << s.ToString();
+      continue;
+    }
+    // The properties are keyed by the path the file was opened with
+    std::map<std::string, const rocksdb::TableProperties*> props_by_name;
+    for (const auto& prop : props) {
+      props_by_name[prop.first.substr(prop.first.rfind('/') + 1)] = prop.second.get();
+    }
+
+    std::vector<rocksdb::LiveFileMetaData> files;
+    db->GetLiveFilesMetaData(&files);
+    for (const auto& file : files) {
+      if (file.file_checksum.empty()) {
+        continue;
+      }
+      auto prop = props_by_name.find(file.relative_filename.substr(file.relative_filename.rfind('/') + 1));
+      std::string unique_id;
+      if (prop == props_by_name.end() || !rocksdb::GetUniqueIdFromTableProperties(*prop->second, &unique_id).ok()) {
+        // Written before RocksDB recorded the session in the properties
+        continue;
+      }
+      SstIdentity& sst = (*ssts)[std::to_string(index) + "/" + file.relative_filename];
+      sst.size = file.size;
+      sst.checksum_func = file.file_checksum_func_name;
+      sst.checksum = HexEncode(file.file_checksum);
+      sst.unique_id = HexEncode(unique_id);
+      sst.path = file.directory + "/" + file.relative_filename;
+    }
+  }
+}
+
+pstd::Status WriteDumpSstIdentities(storage::Storage* storage, int instance_num, const std::string& dump_path) {
+  SstIdentityMap ssts;
+  GetLiveSstIdentities(storage, instance_num, &ssts);
+
+  std::string dir = dump_path + ((dump_path.back() != '/') ? "/" : "");
+  std::stringstream content;
+  for (const auto& sst : ssts) {
+    struct stat buf;
+    if (stat((dir + sst.first).c_str(), &buf) != 0 || static_cast<uint64_t>(buf.st_size) != sst.second.size) {
+      continue;
+    }
+    content << sst.first << " " << sst.second.size << " " << sst.second.checksum_func << " " << sst.second.checksum
+            << " " << sst.second.unique_id << "\n";
+  }
+
+  std::ofstream out(dir + kBgsaveSstMetaFile, std::ios::out | std::ios::trunc);
+  if (!out.is_open()) {
+    return pstd::Status::IOError("open sst meta file failed", dir + kBgsaveSstMetaFile);
+  }
+  out << content.rdbuf();
+  out.close();
+  return out.fail() ? pstd::Status::IOError("write sst meta file failed", dir + kBgsaveSstMetaFile)
+                    : pstd::Status::OK();
+}
+
+pstd::Status ReadDumpSstIdentities(const std::string& dump_path, SstIdentityMap* ssts) {
+  std::string path = dump_path + ((dump_path.back() != '/') ? "/" : "") + kBgsaveSstMetaFile;
+  std::ifstream in(path);
+  if (!in.is_open()) {
+    // Dumps taken before the identities were recorded
+    return pstd::Status::NotFound(path);
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string filename;
+    SstIdentity sst;
+    if (!(fields >> filename >> sst.size >> sst.checksum_func >> sst.checksum)) {
+      LOG(WARNING) << "invalid line in " << path << ": " << line;
+      continue;
+    }
+    // Left empty by older dumps, their files are never reused
+    fields >> sst.unique_id;
+    (*ssts)[filename] = std::move(sst);
+  }
+  return pstd::Status::OK();
+}
+
+}  // namespace rsync
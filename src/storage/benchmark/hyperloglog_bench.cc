@@ -0,0 +1,172 @@
+//  Copyright (c) 2017-present The storage Authors.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/redis_hyperloglog.h"
+#include "storage/storage.h"
+
+using namespace storage;
+using namespace std::chrono;
+
+// Defined in src/storage_murmur3.h and linked from the storage library
+extern "C" void MurmurHash3_x86_32(const void* key, int len, uint32_t seed, void* out);
+
+const int32_t HLL_HASH_SEED = 313;
+const int PFADD_BATCH = 10;
+
+// The dense one byte per register layout used before the sparse encoding,
+// every PFADD element copies the whole register array like the old code did
+class LegacyHyperLogLog {
+ public:
+  LegacyHyperLogLog(uint8_t precision, const std::string& origin_register)
+      : b_(precision), m_(1 << precision), register_(std::make_unique<char[]>(m_)) {
+    for (uint32_t i = 0; i < m_; ++i) {
+      register_[i] = origin_register.empty() ? 0 : origin_register[i];
+    }
+  }
+
+  std::string Add(const char* value, uint32_t len) {
+    uint32_t hash_value;
+    MurmurHash3_x86_32(value, static_cast<int32_t>(len), HLL_HASH_SEED, static_cast<void*>(&hash_value));
+    uint32_t index = hash_value & ((1 << b_) - 1);
+    uint8_t rank = static_cast<uint8_t>(std::min(32 - b_, ::__builtin_ctz(hash_value >> b_))) + 1;
+    if (rank > register_[index]) {
+      register_[index] = static_cast<char>(rank);
+    }
+    return std::string(register_.get(), m_);
+  }
+
+  double Estimate() const {
+    double sum = 0.0;
+    uint32_t zeros = 0;
+    for (uint32_t i = 0; i < m_; i++) {
+      sum += 1.0 / (1 << register_[i]);
+      zeros += register_[i] == 0 ? 1 : 0;
+    }
+    double estimate = (0.7213 / (1 + 1.079 / m_)) * m_ * m_ / sum;
+    if (estimate <= 2.5 * m_ && zeros != 0) {
+      estimate = m_ * log(static_cast<double>(m_) / zeros);
+    }
+    return estimate;
+  }
+
+ private:
+  int b_;
+  uint32_t m_;
+  std::unique_ptr<char[]> register_;
+};
+
+// Simulates PFADD of `elements` values in batches of PFADD_BATCH, each command
+// decodes the stored value, adds its batch and writes the value back
+void BenchLegacy(int elements, int rounds) {
+  std::string stored;
+  size_t bytes = 0;
+  auto start = system_clock::now();
+  for (int r = 0; r < rounds; ++r) {
+    stored.clear();
+    for (int i = 0; i < elements; i += PFADD_BATCH) {
+      LegacyHyperLogLog log(Storage::kPrecision, stored);
+      std::string result;
+      for (int j = i; j < std::min(elements, i + PFADD_BATCH); ++j) {
+        std::string value = "member" + std::to_string(j);
+        result = log.Add(value.data(), value.size());
+      }
+      // PfAdd re-estimated the updated value with a second object
+      LegacyHyperLogLog update_log(Storage::kPrecision, result);
+      update_log.Estimate();
+      stored = std::move(result);
+    }
+    bytes = stored.size();
+  }
+  auto add_cost = duration_cast<microseconds>(system_clock::now() - start).count();
+
+  double estimate = 0;
+  start = system_clock::now();
+  for (int r = 0; r < rounds; ++r) {
+    LegacyHyperLogLog log(Storage::kPrecision, stored);
+    estimate = log.Estimate();
+  }
+  auto count_cost = duration_cast<microseconds>(system_clock::now() - start).count();
+  std::cout << "  legacy  size: " << bytes << " bytes, estimate: " << static_cast<int64_t>(estimate)
+            << ", pfadd: " << add_cost / rounds << "us, pfcount: " << count_cost / rounds << "us" << std::endl;
+}
+
+void BenchEncoded(int elements, int rounds) {
+  std::string stored;
+  size_t bytes = 0;
+  bool sparse = false;
+  auto start = system_clock::now();
+  for (int r = 0; r < rounds; ++r) {
+    stored.clear();
+    for (int i = 0; i < elements; i += PFADD_BATCH) {
+      HyperLogLog log(Storage::kPrecision, stored);
+      bool update = false;
+      for (int j = i; j < std::min(elements, i + PFADD_BATCH); ++j) {
+        std::string value = "member" + std::to_string(j);
+        update |= log.Add(value.data(), value.size());
+      }
+      if (update || stored.empty()) {
+        stored = log.Encode();
+      }
+    }
+    bytes = stored.size();
+  }
+  auto add_cost = duration_cast<microseconds>(system_clock::now() - start).count();
+
+  double estimate = 0;
+  start = system_clock::now();
+  for (int r = 0; r < rounds; ++r) {
+    HyperLogLog log(Storage::kPrecision, stored);
+    estimate = log.Estimate();
+    sparse = log.IsSparse();
+  }
+  auto count_cost = duration_cast<microseconds>(system_clock::now() - start).count();
+  std::cout << "  " << (sparse ? "sparse" : "dense ") << "  size: " << bytes
+            << " bytes, estimate: " << static_cast<int64_t>(estimate) << ", pfadd: " << add_cost / rounds
+            << "us, pfcount: " << count_cost / rounds << "us" << std::endl;
+}
+
+void BenchMerge(int rounds) {
+  std::vector<std::string> values;
+  for (int k = 0; k < 8; ++k) {
+    HyperLogLog log(Storage::kPrecision, "");
+    for (int i = 0; i < 100000; ++i) {
+      std::string value = std::to_string(k) + "member" + std::to_string(i);
+      log.Add(value.data(), value.size());
+    }
+    values.push_back(log.Encode());
+  }
+  double estimate = 0;
+  auto start = system_clock::now();
+  for (int r = 0; r < rounds; ++r) {
+    HyperLogLog first_log(Storage::kPrecision, values[0]);
+    for (size_t k = 1; k < values.size(); ++k) {
+      HyperLogLog log(Storage::kPrecision, values[k]);
+      first_log.Merge(log);
+    }
+    estimate = first_log.Estimate();
+  }
+  auto cost = duration_cast<microseconds>(system_clock::now() - start).count();
+  std::cout << "  pfcount of " << values.size() << " dense keys, estimate: " << static_cast<int64_t>(estimate)
+            << ", cost: " << cost / rounds << "us" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  std::vector<std::pair<int, int>> cases{{10, 100}, {50, 100}, {500, 20}, {5000, 5}, {200000, 1}};
+  for (const auto& c : cases) {
+    std::cout << "====== PfAdd " << c.first << " elements ======" << std::endl;
+    BenchLegacy(c.first, c.second);
+    BenchEncoded(c.first, c.second);
+  }
+  std::cout << "====== PfCount merge ======" << std::endl;
+  BenchMerge(10);
+}
@@ -226,6 +226,113 @@ void BenchScan() {
   std::cout << "Test case 3, Scan " << kv_num << " Cost: " << cost << "s" << std::endl;
 }
 
+// MGET and HMGET fan-out, the batched lookups against one Get per key
+void BenchMGet() {
+  printf("====== MGet ======\n");
+  storage::StorageOptions storage_options;
+  storage_options.options.create_if_missing = true;
+  storage::Storage db;
+  storage::Status s = db.Open(storage_options, "./db_mget");
+
+  if (!s.ok()) {
+    printf("Open db failed, error: %s\n", s.ToString().c_str());
+    return;
+  }
+
+  const size_t kv_num = 1000000;
+  const size_t round_num = 1000;
+  const std::string small_value(100, 'a');
+  std::vector<FieldValue> fvs;
+  for (size_t i = 0; i < kv_num; ++i) {
+    db.Set("mget_key_" + std::to_string(i), small_value);
+    if (i < 1000) {
+      fvs.push_back({"field_" + std::to_string(i), small_value});
+    }
+  }
+  db.HMSet("hmget_key", fvs);
+
+  std::vector<size_t> fan_outs{10, 50, 200};
+  for (const auto fan_out : fan_outs) {
+    std::vector<std::vector<std::string>> rounds(round_num);
+    for (size_t i = 0; i < round_num; ++i) {
+      for (size_t j = 0; j < fan_out; ++j) {
+        rounds[i].push_back("mget_key_" + std::to_string((i * 7919 + j * 104729) % kv_num));
+      }
+    }
+
+    std::string get_value;
+    auto start = system_clock::now();
+    for (const auto& keys : rounds) {
+      for (const auto& mget_key : keys) {
+        db.Get(mget_key, &get_value);
+      }
+    }
+    auto get_cost = duration_cast<microseconds>(system_clock::now() - start).count();
+
+    std::vector<ValueStatus> vss;
+    start = system_clock::now();
+    for (const auto& keys : rounds) {
+      db.MGet(keys, &vss);
+    }
+    auto mget_cost = duration_cast<microseconds>(system_clock::now() - start).count();
+
+    std::vector<std::string> fields;
+    for (size_t j = 0; j < fan_out; ++j) {
+      fields.push_back("field_" + std::to_string(j * 13 % fvs.size()));
+    }
+    start = system_clock::now();
+    for (size_t i = 0; i < round_num; ++i) {
+      db.HMGet("hmget_key", fields, &vss);
+    }
+    auto hmget_cost = duration_cast<microseconds>(system_clock::now() - start).count();
+
+    std::cout << "Fan-out " << fan_out << ", Get loop: " << get_cost / round_num
+              << "us, MGet: " << mget_cost / round_num << "us, HMGet: " << hmget_cost / round_num
+              << "us per command" << std::endl;
+  }
+}
+
+void BenchBitmap() {
+  printf("====== Bitmap ======\n");
+  storage::StorageOptions storage_options;
+  storage_options.options.create_if_missing = true;
+  storage::Storage db;
+  storage::Status s = db.Open(storage_options, "./db_bitmap");
+
+  if (!s.ok()) {
+    printf("Open db failed, error: %s\n", s.ToString().c_str());
+    return;
+  }
+
+  // 128M bits, a 16MB bitmap
+  const int64_t bit_range = 1LL << 27;
+  const size_t setbit_num = 100000;
+  const size_t round_num = 100;
+  int32_t ret;
+
+  auto start = system_clock::now();
+  for (size_t i = 0; i < setbit_num; ++i) {
+    db.SetBit("bitmap_key", static_cast<int64_t>(i * 104729) % bit_range, 1, &ret);
+  }
+  auto setbit_cost = duration_cast<microseconds>(system_clock::now() - start).count();
+
+  start = system_clock::now();
+  for (size_t i = 0; i < round_num; ++i) {
+    db.BitCount("bitmap_key", 0, -1, &ret, false);
+  }
+  auto bitcount_cost = duration_cast<microseconds>(system_clock::now() - start).count();
+
+  int64_t pos;
+  start = system_clock::now();
+  for (size_t i = 0; i < round_num; ++i) {
+    db.BitPos("bitmap_key", 1, static_cast<int64_t>(i * 7919), &pos);
+  }
+  auto bitpos_cost = duration_cast<microseconds>(system_clock::now() - start).count();
+
+  std::cout << "SetBit: " << setbit_cost / setbit_num << "us, BitCount: " << bitcount_cost / round_num
+            << "us, BitPos: " << bitpos_cost / round_num << "us per command" << std::endl;
+}
+
 int main(int argc, char** argv) {
   // keys
   BenchSet();
@@ -235,4 +342,10 @@ int main(int argc, char** argv) {
 
   // Iterator
   BenchScan();
+
+  // multi-key reads
+  BenchMGet();
+
+  // bitmaps
+  BenchBitmap();
 }
@@ -0,0 +1,88 @@
+//  Copyright (c) 2017-present The storage Authors.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "pstd/include/env.h"
+#include "storage/storage.h"
+
+using namespace storage;
+using namespace std::chrono;
+
+const int ZADD_BATCH = 1000;
+const int LOOKUP_NUM = 1000;
+
+// Reports the average ZRANK, ZREVRANK and ZRANGE tail page latency of a zset
+// with `cardinality` members, with and without the rank index
+void BenchZRank(int32_t cardinality, uint64_t rank_index_threshold) {
+  std::string path = "./db/zsets_bench";
+  pstd::DeleteDirIfExist(path);
+  pstd::CreatePath(path);
+
+  StorageOptions storage_options;
+  storage_options.options.create_if_missing = true;
+  storage_options.zset_rank_index_threshold = rank_index_threshold;
+  Storage db;
+  Status s = db.Open(storage_options, path);
+  if (!s.ok()) {
+    printf("Open db failed, error: %s\n", s.ToString().c_str());
+    return;
+  }
+
+  int32_t ret = 0;
+  std::vector<ScoreMember> score_members;
+  for (int32_t i = 0; i < cardinality; ++i) {
+    score_members.push_back({static_cast<double>(i), "member" + std::to_string(i)});
+    if (score_members.size() == ZADD_BATCH || i == cardinality - 1) {
+      db.ZAdd("zset_bench_key", score_members, &ret);
+      score_members.clear();
+    }
+  }
+
+  // The first lookup builds the index
+  int32_t rank = 0;
+  auto start = system_clock::now();
+  db.ZRank("zset_bench_key", "member0", &rank);
+  auto build_cost = duration_cast<microseconds>(system_clock::now() - start).count();
+
+  std::mt19937 rng(cardinality);
+  std::uniform_int_distribution<int32_t> dist(0, cardinality - 1);
+  start = system_clock::now();
+  for (int i = 0; i < LOOKUP_NUM; ++i) {
+    db.ZRank("zset_bench_key", "member" + std::to_string(dist(rng)), &rank);
+  }
+  auto rank_cost = duration_cast<microseconds>(system_clock::now() - start).count();
+
+  start = system_clock::now();
+  for (int i = 0; i < LOOKUP_NUM; ++i) {
+    db.ZRevrank("zset_bench_key", "member" + std::to_string(dist(rng)), &rank);
+  }
+  auto revrank_cost = duration_cast<microseconds>(system_clock::now() - start).count();
+
+  std::vector<ScoreMember> page;
+  start = system_clock::now();
+  for (int i = 0; i < LOOKUP_NUM; ++i) {
+    int32_t offset = cardinality - 10 - i % 100;
+    db.ZRange("zset_bench_key", offset, offset + 9, &page);
+  }
+  auto range_cost = duration_cast<microseconds>(system_clock::now() - start).count();
+
+  std::cout << "  " << (rank_index_threshold != 0 ? "index   " : "no index") << " first: " << build_cost
+            << "us, zrank: " << rank_cost / LOOKUP_NUM << "us, zrevrank: " << revrank_cost / LOOKUP_NUM
+            << "us, zrange tail page: " << range_cost / LOOKUP_NUM << "us" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  std::vector<int32_t> cardinalities{1000, 10000, 100000, 1000000};
+  for (const auto cardinality : cardinalities) {
+    std::cout << "====== ZRank " << cardinality << " members ======" << std::endl;
+    BenchZRank(cardinality, 0);
+    BenchZRank(cardinality, 128);
+  }
+}
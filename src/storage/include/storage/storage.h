@@ -7,6 +7,7 @@
 #define INCLUDE_STORAGE_STORAGE_H_
 
 #include <unistd.h>
+#include <functional>
 #include <list>
 #include <map>
 #include <queue>
@@ -21,6 +22,7 @@
 #include "rocksdb/slice.h"
 #include "rocksdb/status.h"
 #include "rocksdb/table.h"
+#include "rocksdb/threadpool.h"
 
 #include "slot_indexer.h"
 #include "pstd/include/pstd_mutex.h"
@@ -71,6 +73,10 @@ struct StorageOptions {
   size_t statistics_max_size = 0;
   size_t small_compaction_threshold = 5000;
   size_t small_compaction_duration_threshold = 10000;
+  // zsets with at least this many members get an in-memory rank index, 0 means disabled
+  size_t zset_rank_index_threshold = 0;
+  // store the slot of every key in its reserved prefix, see storage_define.h
+  bool slot_key_prefix = false;
   Status ResetOptions(const OptionType& option_type, const std::unordered_map<std::string, std::string>& options_map);
 };
 
@@ -153,7 +159,8 @@ enum BitOpType { kBitOpAnd = 1, kBitOpOr, kBitOpXor, kBitOpNot, kBitOpDefault };
 enum Operation {
   kNone = 0,
   kCleanAll,
-  kCompactRange
+  kCompactRange,
+  kReapExpiredKeys
 };
 
 struct BGTask {
@@ -174,6 +181,10 @@ class Storage {
 
   Status Open(const StorageOptions& storage_options, const std::string& db_path);
 
+  // The slot num encoded in the reserve1 of every key, see storage_define.h,
+  // 0 unless the storage is opened with slot_key_prefix
+  int SlotKeyPrefixNum() const { return slot_key_prefix_num_; }
+
   Status LoadCursorStartKey(const DataType& dtype, int64_t cursor, char* type, std::string* start_key);
 
   Status StoreCursorStartKey(const DataType& dtype, int64_t cursor, char type, const std::string& next_key);
@@ -182,6 +193,11 @@ class Storage {
 
   std::unique_ptr<Redis>& GetDBInstance(const std::string& key);
 
+  // Splits keys by db instance, positions records where each key came from
+  // so the per instance results can be merged back in order
+  void GroupKeysByInstance(const std::vector<std::string>& keys, std::vector<std::vector<std::string>>* inst_keys,
+                           std::vector<std::vector<size_t>>* positions);
+
   // Strings Commands
 
   // Set key to hold the string value. if key
@@ -1035,6 +1051,12 @@ class Storage {
 
   Status Keys(const DataType& data_type, const std::string& pattern, std::vector<std::string>* keys);
 
+  // Calls visit with the keys of data_type matching pattern until it returns
+  // false. The db instances are scanned in parallel, the keys come in order
+  // and are not buffered, so the caller may stop at any point
+  Status ScanKeys(const DataType& data_type, const std::string& pattern,
+                  const std::function<bool(const std::string& key)>& visit);
+
   // Dynamic switch WAL
   void DisableWal(const bool is_wal_disable);
 
@@ -1070,9 +1092,31 @@ class Storage {
   Status DoCompactRange(const DataType& type, const std::string& start, const std::string& end);
   Status DoCompactSpecificKey(const DataType& type, const std::string& key);
 
+  // Delete up to max_keys already expired keys of every db instance, oldest
+  // expire time first. Only one such task is queued at a time
+  Status ReapExpiredKeys(int64_t max_keys, bool sync = false);
+  Status DoReapExpiredKeys(int64_t max_keys);
+  uint64_t GetReapedKeys() const { return reaped_keys_.load(); }
+  uint64_t GetReclaimedBytes() const { return reclaimed_bytes_.load(); }
+
   Status SetMaxCacheStatisticKeys(uint32_t max_cache_statistic_keys);
   Status SetSmallCompactionThreshold(uint32_t small_compaction_threshold);
   Status SetSmallCompactionDurationThreshold(uint32_t small_compaction_duration_threshold);
+  Status SetZSetsRankIndexThreshold(uint32_t zset_rank_index_threshold);
+
+  // Slot Commands, only supported in the slot prefix layout
+
+  // Returns the type tag followed by the key of up to count live keys of the
+  // slot which match pattern, resuming where the scan that returned cursor
+  // stopped. next_cursor is 0 once the slot is exhausted
+  Status ScanSlot(uint32_t slot, int64_t cursor, const std::string& pattern, int64_t count,
+                  std::vector<std::string>* keys, int64_t* next_cursor);
+  Status SlotKeyNum(uint32_t slot, int64_t* num);
+  // Drop every key of the slots with a range deletion
+  Status DeleteSlots(const std::vector<uint32_t>& slots);
+  // Copy every key into target, which must be opened with slot_key_prefix and
+  // the same number of db instances, used by the offline converter
+  Status ConvertToSlotKeyPrefix(Storage* target, int64_t* converted);
 
   std::string GetCurrentTaskType();
   Status GetUsage(const std::string& property, uint64_t* result);
@@ -1083,6 +1127,8 @@ class Storage {
   Status StopScanKeyNum();
 
   rocksdb::DB* GetDBByIndex(int index);
+  // The table properties of the live SST files of the db instance, keyed by file path
+  Status GetPropertiesOfAllTables(int index, rocksdb::TablePropertiesCollection* props);
 
   Status SetOptions(const OptionType& option_type, const std::string& db_type,
                     const std::unordered_map<std::string, std::string>& options);
@@ -1099,9 +1145,12 @@ class Storage {
   std::atomic<bool> is_opened_ = {false};
   int db_instance_num_ = 3;
   int slot_num_ = 1024;
+  int slot_key_prefix_num_ = 0;
   bool is_classic_mode_ = true;
 
   std::unique_ptr<LRUCache<std::string, std::string>> cursors_store_;
+  // Reads ahead for the parallel scans of KEYS
+  std::unique_ptr<rocksdb::ThreadPool> scan_pool_;
 
   // Storage start the background thread for compaction task
   pthread_t bg_tasks_thread_id_ = 0;
@@ -1112,6 +1161,10 @@ class Storage {
   std::atomic<int> current_task_type_ = {kNone};
   std::atomic<bool> bg_tasks_should_exit_ = {false};
 
+  std::atomic<bool> reap_task_queued_ = {false};
+  std::atomic<uint64_t> reaped_keys_ = {0};
+  std::atomic<uint64_t> reclaimed_bytes_ = {0};
+
   // For scan keys in data base
   std::atomic<bool> scan_keynum_exit_ = {false};
   Status MGetWithTTL(const Slice& key, std::string* value, int64_t* ttl);
@@ -44,6 +44,10 @@ enum ColumnFamilyIndex {
   kZsetsDataCF = 4,
   kZsetsScoreCF = 5,
   kStreamsDataCF = 6,
+  // (etime, key) of the keys with a ttl, see expire_index_key_format.h
+  kExpireIndexCF = 7,
+  // Segments of the bitmaps kept apart from their string, see bitmap_segments.h
+  kBitmapsDataCF = 8,
 };
 
 const static char kNeedTransformCharacter = '\u0000';
@@ -119,6 +123,18 @@ inline const char* DecodeUserKey(const char* ptr, int length, std::string* user_
   return ret_ptr;
 }
 
+/*
+ * With the slot prefix layout (StorageOptions::slot_key_prefix) the first two
+ * bytes of reserve1 hold the big endian codis slot of the user key, so every
+ * slot is one contiguous range of each column family. The layout belongs to
+ * a Storage, see Storage::SlotKeyPrefixNum(), slot num 0 means the classic
+ * layout with an all zero reserve1.
+ */
+// Write the kPrefixReserveLength bytes reserve1 of user_key into dst
+void EncodeKeyPrefix(int slot_num, const Slice& user_key, char* dst);
+// Write the kPrefixReserveLength bytes reserve1 shared by all keys of slot into dst
+void EncodeSlotPrefix(uint32_t slot, char* dst);
+
 inline const char* SeekUserkeyDelim(const char* ptr, int length) {
     bool zero_ahead = false;
     for (int i = 0; i < length; i++) {
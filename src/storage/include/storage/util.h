@@ -24,7 +24,7 @@ int do_mkdir(const char* path, mode_t mode);
 int mkpath(const char* path, mode_t mode);
 int delete_dir(const char* dirname);
 int is_dir(const char* filename);
-int CalculateStartAndEndKey(const std::string& key, std::string* start_key, std::string* end_key);
+int CalculateStartAndEndKey(const std::string& key, int slot_num, std::string* start_key, std::string* end_key);
 bool isTailWildcard(const std::string& pattern);
 void GetFilepath(const char* path, const char* filename, char* filepath);
 bool DeleteFiles(const char* path);
@@ -20,8 +20,8 @@ using Slice = rocksdb::Slice;
 class BaseDataKey {
  public:
   BaseDataKey(const Slice& key,
-             uint64_t version, const Slice& data)
-      : key_(key), version_(version), data_(data) {}
+             uint64_t version, const Slice& data, int slot_num)
+      : key_(key), version_(version), data_(data), slot_num_(slot_num) {}
 
   ~BaseDataKey() {
     if (start_ != space_) {
@@ -49,7 +49,7 @@ class BaseDataKey {
 
     start_ = dst;
     // reserve1: 8 byte
-    memcpy(dst, reserve1_, sizeof(reserve1_));
+    EncodeKeyPrefix(slot_num_, key_, dst);
     dst += sizeof(reserve1_);
     // key
     dst = EncodeUserKey(key_, dst, nzero);
@@ -82,7 +82,7 @@ class BaseDataKey {
 
     start_ = dst;
     // reserve1: 8 byte
-    memcpy(dst, reserve1_, sizeof(reserve1_));
+    EncodeKeyPrefix(slot_num_, key_, dst);
     dst += sizeof(reserve1_);
     // key
     dst = EncodeUserKey(key_, dst, nzero);
@@ -105,6 +105,8 @@ class BaseDataKey {
   Slice key_;
   uint64_t version_ = uint64_t(-1);
   Slice data_;
+  // SlotKeyPrefixNum() of the storage
+  int slot_num_ = 0;
   char reserve2_[16] = {0};
 };
 
@@ -164,6 +164,16 @@ class BaseDataFilter : public rocksdb::CompactionFilter {
           meta_not_found_ = false;
           cur_meta_version_ = parsed_base_meta_value.Version();
           cur_meta_etime_ = parsed_base_meta_value.Etime();
+        } else if (type == DataType::kStrings) {
+          // Only a bitmap keeps data of a string, the segments of a string
+          // written over since are dropped
+          ParsedStringsValue parsed_strings_value(&meta_value);
+          if (!parsed_strings_value.IsBitmap()) {
+            return true;
+          }
+          meta_not_found_ = false;
+          cur_meta_version_ = parsed_strings_value.BitmapVersion();
+          cur_meta_etime_ = parsed_strings_value.Etime();
         } else {
           return true;
         }
@@ -13,11 +13,12 @@ namespace storage {
 * used for string data key or hash/zset/set/list's meta key. format:
 * | reserve1 | key | reserve2 |
 * |    8B    |     |   16B    |
+* reserve1 starts with the slot of the key in the slot prefix layout
 */
 
 class BaseKey {
  public:
-  BaseKey(const Slice& key) : key_(key) {}
+  BaseKey(const Slice& key, int slot_num) : key_(key), slot_num_(slot_num) {}
 
   ~BaseKey() {
     if (start_ != space_) {
@@ -44,7 +45,7 @@ class BaseKey {
 
     start_ = dst;
     // reserve1: 8 byte
-    memcpy(dst, reserve1_, sizeof(reserve1_));
+    EncodeKeyPrefix(slot_num_, key_, dst);
     dst += sizeof(reserve1_);
     // key
     dst = EncodeUserKey(key_, dst, nzero);
@@ -59,6 +60,8 @@ class BaseKey {
   char space_[200];
   char reserve1_[8] = {0};
   Slice key_;
+  // SlotKeyPrefixNum() of the storage
+  int slot_num_ = 0;
   char reserve2_[16] = {0};
 };
 
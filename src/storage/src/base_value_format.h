@@ -50,6 +50,7 @@ public:
     }
   }
   void SetEtime(uint64_t etime = 0) { etime_ = etime; }
+  uint64_t Etime() const { return etime_; }
   void setCtime(uint64_t ctime) { ctime_ = ctime; }
   rocksdb::Status SetRelativeTimestamp(int64_t ttl) {
     int64_t unix_time;
@@ -0,0 +1,195 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "src/bitmap_ops.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace storage {
+
+namespace {
+
+inline uint64_t LoadWord(const unsigned char* ptr) {
+  uint64_t word;
+  memcpy(&word, ptr, sizeof(word));
+  return word;
+}
+
+template <typename T>
+inline T Operate(BitOpType op, T dst, T src) {
+  switch (op) {
+    case kBitOpAnd:
+      return dst & src;
+    case kBitOpOr:
+      return dst | src;
+    case kBitOpXor:
+      return dst ^ src;
+    case kBitOpNot:
+      return static_cast<T>(~src);
+    default:
+      return dst;
+  }
+}
+
+inline uint64_t CountWords(const unsigned char* bytes, size_t len) {
+  uint64_t count = 0;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+    count += __builtin_popcountll(LoadWord(bytes + i));
+  }
+  for (; i < len; i++) {
+    count += __builtin_popcount(bytes[i]);
+  }
+  return count;
+}
+
+uint64_t CountGeneric(const unsigned char* bytes, size_t len) { return CountWords(bytes, len); }
+
+size_t FindByteGeneric(const unsigned char* bytes, size_t len, unsigned char skip) {
+  const uint64_t skip_word = 0x0101010101010101ULL * skip;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+    if (LoadWord(bytes + i) != skip_word) {
+      break;
+    }
+  }
+  for (; i < len; i++) {
+    if (bytes[i] != skip) {
+      return i;
+    }
+  }
+  return len;
+}
+
+void OperateGeneric(BitOpType op, unsigned char* dst, const unsigned char* src, size_t len) {
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+    uint64_t word = Operate(op, LoadWord(dst + i), LoadWord(src + i));
+    memcpy(dst + i, &word, sizeof(word));
+  }
+  for (; i < len; i++) {
+    dst[i] = Operate(op, dst[i], src[i]);
+  }
+}
+
+#if defined(__x86_64__)
+__attribute__((target("popcnt"))) uint64_t CountPopcnt(const unsigned char* bytes, size_t len) {
+  return CountWords(bytes, len);
+}
+
+// Looks up the bits set in each nibble and sums the bytes of every 32 with sad
+__attribute__((target("avx2,popcnt"))) uint64_t CountAvx2(const unsigned char* bytes, size_t len) {
+  const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                          0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_mask = _mm256_set1_epi8(0x0f);
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i total = zero;
+  size_t i = 0;
+  for (; i + sizeof(__m256i) <= len; i += sizeof(__m256i)) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+    __m256i lo = _mm256_and_si256(v, low_mask);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+    total = _mm256_add_epi64(total, _mm256_sad_epu8(counts, zero));
+  }
+  uint64_t count = static_cast<uint64_t>(_mm256_extract_epi64(total, 0)) +
+                   static_cast<uint64_t>(_mm256_extract_epi64(total, 1)) +
+                   static_cast<uint64_t>(_mm256_extract_epi64(total, 2)) +
+                   static_cast<uint64_t>(_mm256_extract_epi64(total, 3));
+  return count + CountWords(bytes + i, len - i);
+}
+
+__attribute__((target("avx2"))) size_t FindByteAvx2(const unsigned char* bytes, size_t len, unsigned char skip) {
+  const __m256i skip_vec = _mm256_set1_epi8(static_cast<char>(skip));
+  size_t i = 0;
+  for (; i + sizeof(__m256i) <= len; i += sizeof(__m256i)) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+    auto equal = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, skip_vec)));
+    if (equal != 0xffffffff) {
+      return i + __builtin_ctz(~equal);
+    }
+  }
+  return i + FindByteGeneric(bytes + i, len - i, skip);
+}
+
+__attribute__((target("avx2"))) void OperateAvx2(BitOpType op, unsigned char* dst, const unsigned char* src,
+                                                 size_t len) {
+  const __m256i ones = _mm256_set1_epi8(-1);
+  size_t i = 0;
+  for (; i + sizeof(__m256i) <= len; i += sizeof(__m256i)) {
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    switch (op) {
+      case kBitOpAnd:
+        d = _mm256_and_si256(d, s);
+        break;
+      case kBitOpOr:
+        d = _mm256_or_si256(d, s);
+        break;
+      case kBitOpXor:
+        d = _mm256_xor_si256(d, s);
+        break;
+      case kBitOpNot:
+        d = _mm256_xor_si256(s, ones);
+        break;
+      default:
+        break;
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), d);
+  }
+  OperateGeneric(op, dst + i, src + i, len - i);
+}
+#endif
+
+struct Kernels {
+  uint64_t (*count)(const unsigned char*, size_t) = CountGeneric;
+  size_t (*find_byte)(const unsigned char*, size_t, unsigned char) = FindByteGeneric;
+  void (*operate)(BitOpType, unsigned char*, const unsigned char*, size_t) = OperateGeneric;
+};
+
+const Kernels& GetKernels() {
+  static const Kernels kernels = [] {
+    Kernels k;
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx2")) {
+      k.count = CountAvx2;
+      k.find_byte = FindByteAvx2;
+      k.operate = OperateAvx2;
+    } else if (__builtin_cpu_supports("popcnt")) {
+      k.count = CountPopcnt;
+    }
+#endif
+    return k;
+  }();
+  return kernels;
+}
+
+}  // namespace
+
+uint64_t BitmapCount(const unsigned char* bytes, size_t len) { return GetKernels().count(bytes, len); }
+
+size_t BitmapFindByte(const unsigned char* bytes, size_t len, unsigned char skip) {
+  return GetKernels().find_byte(bytes, len, skip);
+}
+
+int64_t BitmapFindBit(const unsigned char* bytes, size_t len, int bit) {
+  size_t pos = BitmapFindByte(bytes, len, bit != 0 ? 0 : 0xff);
+  if (pos == len) {
+    return -1;
+  }
+  auto byte = static_cast<unsigned int>(bit != 0 ? bytes[pos] : static_cast<unsigned char>(~bytes[pos]));
+  // The byte is not zero, its leading zeros within 8 bits tell the bit
+  return static_cast<int64_t>(8 * pos) + __builtin_clz(byte) - 24;
+}
+
+void BitmapOperate(BitOpType op, unsigned char* dst, const unsigned char* src, size_t len) {
+  GetKernels().operate(op, dst, src, len);
+}
+
+}  //  namespace storage
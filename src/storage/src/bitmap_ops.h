@@ -0,0 +1,36 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef SRC_BITMAP_OPS_H_
+#define SRC_BITMAP_OPS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "storage/storage.h"
+
+namespace storage {
+
+/*
+ * Kernels of BITCOUNT, BITPOS and BITOP. On x86-64 they run with AVX2 when
+ * the cpu has it, which is checked once at runtime since the build does not
+ * enable it, and fall back to 64 bit words with popcnt otherwise.
+ */
+
+// Number of bits set in the len bytes
+uint64_t BitmapCount(const unsigned char* bytes, size_t len);
+
+// Position of the first byte that is not skip, len if there is none
+size_t BitmapFindByte(const unsigned char* bytes, size_t len, unsigned char skip);
+
+// Position of the first bit equal to bit, most significant bit of a byte
+// first, -1 if there is none
+int64_t BitmapFindBit(const unsigned char* bytes, size_t len, int bit);
+
+// dst = dst op src over len bytes, and dst = ~src for kBitOpNot
+void BitmapOperate(BitOpType op, unsigned char* dst, const unsigned char* src, size_t len);
+
+}  //  namespace storage
+#endif  // SRC_BITMAP_OPS_H_
@@ -0,0 +1,121 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "src/bitmap_segments.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "src/base_data_key_format.h"
+#include "src/base_data_value_format.h"
+#include "src/bitmap_ops.h"
+
+namespace storage {
+
+namespace {
+
+void EncodeSegment(uint64_t segment, char* dst) {
+  for (size_t i = 0; i < sizeof(uint64_t); i++) {
+    dst[i] = static_cast<char>(segment >> (8 * (sizeof(uint64_t) - 1 - i)));
+  }
+}
+
+uint64_t DecodeSegment(const char* ptr) {
+  uint64_t segment = 0;
+  for (size_t i = 0; i < sizeof(uint64_t); i++) {
+    segment = (segment << 8) | static_cast<unsigned char>(ptr[i]);
+  }
+  return segment;
+}
+
+}  // namespace
+
+BitmapSegments::BitmapSegments(rocksdb::DB* db, rocksdb::ColumnFamilyHandle* handle,
+                               const rocksdb::ReadOptions& read_options, const Slice& key, uint64_t version,
+                               int slot_num)
+    : db_(db), handle_(handle), read_options_(read_options), key_(key.ToString()), version_(version),
+      slot_num_(slot_num) {}
+
+std::string BitmapSegments::SegmentKey(uint64_t segment) {
+  char data[sizeof(uint64_t)];
+  EncodeSegment(segment, data);
+  BaseDataKey segment_key(key_, version_, Slice(data, sizeof(data)), slot_num_);
+  return segment_key.Encode().ToString();
+}
+
+Status BitmapSegments::Read(uint64_t segment, std::string* bytes) {
+  bytes->clear();
+  std::string value;
+  Status s = db_->Get(read_options_, handle_, SegmentKey(segment), &value);
+  if (s.IsNotFound()) {
+    return Status::OK();
+  } else if (!s.ok()) {
+    return s;
+  }
+  ParsedBaseDataValue parsed_value(&value);
+  parsed_value.StripSuffix();
+  *bytes = std::move(value);
+  return Status::OK();
+}
+
+Status BitmapSegments::Scan(uint64_t first, uint64_t last,
+                            const std::function<bool(uint64_t offset, const Slice& bytes)>& visit) {
+  BaseDataKey prefix_key(key_, version_, Slice(), slot_num_);
+  std::string prefix = prefix_key.EncodeSeekKey().ToString();
+  std::unique_ptr<rocksdb::Iterator> iter(db_->NewIterator(read_options_, handle_));
+  for (iter->Seek(SegmentKey(SegmentOf(first))); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
+    uint64_t start = SegmentStart(DecodeSegment(iter->key().data() + prefix.size()));
+    if (start > last) {
+      break;
+    }
+    ParsedBaseDataValue parsed_value(iter->value());
+    Slice bytes = parsed_value.UserValue();
+    uint64_t begin = std::max(first, start);
+    uint64_t end = std::min(last + 1, start + bytes.size());
+    if (begin >= end) {
+      continue;
+    }
+    if (!visit(begin, Slice(bytes.data() + (begin - start), end - begin))) {
+      break;
+    }
+  }
+  return iter->status();
+}
+
+Status BitmapSegments::Assemble(uint64_t length, std::string* value) {
+  value->assign(length, '\0');
+  if (length == 0) {
+    return Status::OK();
+  }
+  return Scan(0, length - 1, [value](uint64_t offset, const Slice& bytes) {
+    memcpy(value->data() + offset, bytes.data(), bytes.size());
+    return true;
+  });
+}
+
+void BitmapSegments::Write(uint64_t segment, const Slice& bytes, rocksdb::WriteBatch* batch) {
+  auto data = reinterpret_cast<const unsigned char*>(bytes.data());
+  if (BitmapFindByte(data, bytes.size(), 0) == bytes.size()) {
+    batch->Delete(handle_, SegmentKey(segment));
+  } else {
+    BaseDataValue segment_value(bytes);
+    batch->Put(handle_, SegmentKey(segment), segment_value.Encode());
+  }
+}
+
+void BitmapSegments::WriteAll(const Slice& value, rocksdb::WriteBatch* batch) {
+  auto data = reinterpret_cast<const unsigned char*>(value.data());
+  for (uint64_t start = 0; start < value.size(); start += kBitmapSegmentSize) {
+    uint64_t len = std::min<uint64_t>(kBitmapSegmentSize, value.size() - start);
+    if (BitmapFindByte(data + start, len, 0) == len) {
+      continue;
+    }
+    BaseDataValue segment_value(Slice(value.data() + start, len));
+    batch->Put(handle_, SegmentKey(SegmentOf(start)), segment_value.Encode());
+  }
+}
+
+}  //  namespace storage
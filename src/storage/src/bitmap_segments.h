@@ -0,0 +1,74 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef SRC_BITMAP_SEGMENTS_H_
+#define SRC_BITMAP_SEGMENTS_H_
+
+#include <functional>
+#include <string>
+
+#include "rocksdb/db.h"
+#include "rocksdb/status.h"
+#include "rocksdb/write_batch.h"
+
+#include "storage/storage_define.h"
+
+namespace storage {
+
+using Status = rocksdb::Status;
+
+/*
+ * A string that SETBIT grows past kBitmapSegmentSize bytes becomes a bitmap:
+ * its value is replaced by a BitmapMetaValue and its bytes are cut into
+ * segments of kBitmapSegmentSize, each one a kBitmapsDataCF row whose
+ * BaseDataKey holds the big endian segment number as data, so the segments
+ * of a bitmap are in order. A segment without any bit set is not stored and
+ * a stored one may be shorter than kBitmapSegmentSize, the bytes missing
+ * from it up to the length of the bitmap are zero.
+ */
+constexpr uint64_t kBitmapSegmentShift = 13;
+constexpr uint64_t kBitmapSegmentSize = 1ULL << kBitmapSegmentShift;
+
+/*
+ * Reads and writes the segments of one version of a bitmap, offsets are
+ * byte offsets into the whole bitmap.
+ */
+class BitmapSegments {
+ public:
+  BitmapSegments(rocksdb::DB* db, rocksdb::ColumnFamilyHandle* handle, const rocksdb::ReadOptions& read_options,
+                 const Slice& key, uint64_t version, int slot_num);
+
+  static uint64_t SegmentOf(uint64_t offset) { return offset >> kBitmapSegmentShift; }
+  static uint64_t SegmentStart(uint64_t segment) { return segment << kBitmapSegmentShift; }
+
+  // The stored bytes of segment, empty if it is not stored
+  Status Read(uint64_t segment, std::string* bytes);
+  /*
+   * Calls visit with the offset and the stored bytes of every segment
+   * between the offsets first and last, both included, in order, until it
+   * returns false. Whatever is not passed to visit is zero.
+   */
+  Status Scan(uint64_t first, uint64_t last, const std::function<bool(uint64_t offset, const Slice& bytes)>& visit);
+  // The whole bitmap of length bytes
+  Status Assemble(uint64_t length, std::string* value);
+
+  // Puts bytes as segment, or deletes the segment when no bit is set
+  void Write(uint64_t segment, const Slice& bytes, rocksdb::WriteBatch* batch);
+  // Puts the segments of value that have some bit set
+  void WriteAll(const Slice& value, rocksdb::WriteBatch* batch);
+
+ private:
+  std::string SegmentKey(uint64_t segment);
+
+  rocksdb::DB* db_ = nullptr;
+  rocksdb::ColumnFamilyHandle* handle_ = nullptr;
+  rocksdb::ReadOptions read_options_;
+  std::string key_;
+  uint64_t version_ = 0;
+  int slot_num_ = 0;
+};
+
+}  //  namespace storage
+#endif  // SRC_BITMAP_SEGMENTS_H_
@@ -101,13 +101,19 @@ class ZSetsScoreKeyComparatorImpl : public rocksdb::Comparator {
     auto a_size = static_cast<int32_t>(a.size());
     auto b_size = static_cast<int32_t>(b.size());
 
+    // reserve1 is all zero unless the slot prefix layout is used,
+    // then keys of the same slot must stay together
+    int ret = memcmp(ptr_a, ptr_b, kPrefixReserveLength);
+    if (ret != 0) {
+      return ret;
+    }
     ptr_a += kPrefixReserveLength;
     ptr_b += kPrefixReserveLength;
     const char* p_a = SeekUserkeyDelim(ptr_a, a_size - kPrefixReserveLength);
     const char* p_b = SeekUserkeyDelim(ptr_b, b_size - kPrefixReserveLength);
     rocksdb::Slice p_a_prefix = Slice(ptr_a, std::distance(ptr_a, p_a));
     rocksdb::Slice p_b_prefix = Slice(ptr_b, std::distance(ptr_b, p_b));
-    int ret = p_a_prefix.compare(p_b_prefix);
+    ret = p_a_prefix.compare(p_b_prefix);
     if (ret != 0) {
       return ret;
     }
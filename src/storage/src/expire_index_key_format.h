@@ -0,0 +1,66 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef SRC_EXPIRE_INDEX_KEY_FORMAT_H_
+#define SRC_EXPIRE_INDEX_KEY_FORMAT_H_
+
+#include <string>
+
+#include "storage/storage_define.h"
+
+namespace storage {
+/*
+* used for the keys of kExpireIndexCF, the value is empty. format:
+* | etime | key |
+* |  8B   |     |
+* etime is big endian, so the index is ordered by expire time
+*/
+class ExpireIndexKey {
+ public:
+  ExpireIndexKey(uint64_t etime, const Slice& key) : etime_(etime), key_(key) {}
+
+  // The index keys of all the keys expiring before etime are less than this
+  static std::string EncodeEtime(uint64_t etime) {
+    std::string dst(kTimestampLength, '\0');
+    for (int i = kTimestampLength - 1; i >= 0; i--) {
+      dst[i] = static_cast<char>(etime & 0xff);
+      etime >>= 8;
+    }
+    return dst;
+  }
+
+  std::string Encode() const {
+    std::string dst = EncodeEtime(etime_);
+    dst.append(key_.data(), key_.size());
+    return dst;
+  }
+
+ private:
+  uint64_t etime_;
+  Slice key_;
+};
+
+class ParsedExpireIndexKey {
+ public:
+  explicit ParsedExpireIndexKey(const Slice& index_key) {
+    if (index_key.size() < kTimestampLength) {
+      return;
+    }
+    for (int i = 0; i < kTimestampLength; i++) {
+      etime_ = (etime_ << 8) | static_cast<uint8_t>(index_key[i]);
+    }
+    key_ = Slice(index_key.data() + kTimestampLength, index_key.size() - kTimestampLength);
+  }
+
+  uint64_t Etime() const { return etime_; }
+  Slice Key() const { return key_; }
+
+ private:
+  uint64_t etime_ = 0;
+  Slice key_;
+};
+
+}  //  namespace storage
+#endif  // SRC_EXPIRE_INDEX_KEY_FORMAT_H_
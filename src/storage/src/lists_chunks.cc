@@ -0,0 +1,440 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "src/lists_chunks.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "src/base_data_value_format.h"
+#include "src/coding.h"
+#include "src/lists_data_key_format.h"
+
+namespace storage {
+
+void EncodeListsChunk(const ListsChunkElements& elements, std::string* dst) {
+  size_t needed = sizeof(uint32_t) * (elements.size() + 1);
+  for (const auto& entry : elements) {
+    needed += entry.spill != 0 ? sizeof(uint64_t) : entry.element.size();
+  }
+  dst->resize(needed);
+  char* ptr = dst->data();
+  EncodeFixed32(ptr, static_cast<uint32_t>(elements.size()));
+  ptr += sizeof(uint32_t);
+  for (const auto& entry : elements) {
+    if (entry.spill != 0) {
+      EncodeFixed32(ptr, kListsChunkSpilled | entry.size);
+      ptr += sizeof(uint32_t);
+      EncodeFixed64(ptr, entry.spill);
+      ptr += sizeof(uint64_t);
+    } else {
+      EncodeFixed32(ptr, static_cast<uint32_t>(entry.element.size()));
+      ptr += sizeof(uint32_t);
+      memcpy(ptr, entry.element.data(), entry.element.size());
+      ptr += entry.element.size();
+    }
+  }
+}
+
+bool DecodeListsChunk(const Slice& chunk, ListsChunkElements* elements) {
+  elements->clear();
+  if (chunk.size() < sizeof(uint32_t)) {
+    return false;
+  }
+  const char* ptr = chunk.data();
+  const char* end_ptr = chunk.data() + chunk.size();
+  uint32_t count = DecodeFixed32(ptr);
+  ptr += sizeof(uint32_t);
+  for (uint32_t i = 0; i < count; i++) {
+    if (end_ptr - ptr < static_cast<int64_t>(sizeof(uint32_t))) {
+      return false;
+    }
+    uint32_t len = DecodeFixed32(ptr);
+    ptr += sizeof(uint32_t);
+    ListsChunkEntry& entry = elements->emplace_back();
+    if ((len & kListsChunkSpilled) != 0) {
+      if (end_ptr - ptr < static_cast<int64_t>(sizeof(uint64_t))) {
+        return false;
+      }
+      entry.spill = DecodeFixed64(ptr);
+      entry.size = len & ~kListsChunkSpilled;
+      ptr += sizeof(uint64_t);
+      continue;
+    }
+    if (end_ptr - ptr < static_cast<int64_t>(len)) {
+      return false;
+    }
+    entry.element.assign(ptr, len);
+    ptr += len;
+  }
+  return ptr == end_ptr;
+}
+
+ListsChunks::ListsChunks(rocksdb::DB* db, rocksdb::ColumnFamilyHandle* handle, const rocksdb::ReadOptions& read_options,
+                         const Slice& key, ParsedListsMetaValue* meta, int slot_num)
+    : db_(db), handle_(handle), read_options_(read_options), key_(key.ToString()), meta_(meta),
+      version_(meta->Version()), slot_num_(slot_num) {}
+
+uint64_t ListsChunks::Offset(uint64_t index) {
+  return index - std::max(ChunkStart(ChunkOf(index)), meta_->LeftIndex() + 1);
+}
+
+Status ListsChunks::Read(uint64_t chunk, ListsChunkElements* elements) {
+  elements->clear();
+  std::string value;
+  ListsDataKey lists_data_key(key_, version_, chunk, slot_num_);
+  Status s = db_->Get(read_options_, handle_, lists_data_key.Encode(), &value);
+  if (s.IsNotFound()) {
+    return Status::OK();
+  } else if (!s.ok()) {
+    return s;
+  }
+  ParsedBaseDataValue parsed_value(&value);
+  if (!DecodeListsChunk(parsed_value.UserValue(), elements)) {
+    return Status::Corruption("invalid list chunk");
+  }
+  return Status::OK();
+}
+
+Status ListsChunks::Load(uint64_t chunk, ListsChunkElements** elements) {
+  auto iter = chunks_.find(chunk);
+  if (iter == chunks_.end()) {
+    ListsChunkElements loaded;
+    Status s = Read(chunk, &loaded);
+    if (!s.ok()) {
+      return s;
+    }
+    iter = chunks_.emplace(chunk, std::move(loaded)).first;
+  }
+  *elements = &iter->second;
+  return Status::OK();
+}
+
+Status ListsChunks::Clear(uint64_t chunk) {
+  auto iter = chunks_.find(chunk);
+  if (iter == chunks_.end()) {
+    ListsChunkElements read;
+    Status s = Read(chunk, &read);
+    if (!s.ok()) {
+      return s;
+    }
+    for (const auto& entry : read) {
+      DropEntry(entry);
+    }
+    chunks_[chunk];
+    return Status::OK();
+  }
+  for (const auto& entry : iter->second) {
+    DropEntry(entry);
+  }
+  iter->second.clear();
+  return Status::OK();
+}
+
+ListsChunkEntry ListsChunks::MakeEntry(const std::string& element) {
+  ListsChunkEntry entry;
+  if (element.size() <= kListsChunkInlineSize) {
+    entry.element = element;
+    return entry;
+  }
+  entry.spill = kListsSpillBase + meta_->NextSpillNumber();
+  entry.size = static_cast<uint32_t>(element.size());
+  spill_puts_[entry.spill] = element;
+  return entry;
+}
+
+Status ListsChunks::EntryElement(const ListsChunkEntry& entry, std::string* element) {
+  if (entry.spill == 0) {
+    *element = entry.element;
+    return Status::OK();
+  }
+  auto iter = spill_puts_.find(entry.spill);
+  if (iter != spill_puts_.end()) {
+    *element = iter->second;
+    return Status::OK();
+  }
+  std::string value;
+  ListsDataKey lists_data_key(key_, version_, entry.spill, slot_num_);
+  Status s = db_->Get(read_options_, handle_, lists_data_key.Encode(), &value);
+  if (s.IsNotFound()) {
+    return Status::Corruption("list misses a spilled element");
+  } else if (!s.ok()) {
+    return s;
+  }
+  ParsedBaseDataValue parsed_value(&value);
+  *element = parsed_value.UserValue().ToString();
+  return Status::OK();
+}
+
+void ListsChunks::DropEntry(const ListsChunkEntry& entry) {
+  if (entry.spill != 0 && spill_puts_.erase(entry.spill) == 0) {
+    spill_deletes_.push_back(entry.spill);
+  }
+}
+
+Status ListsChunks::Index(uint64_t index, std::string* element) {
+  ListsChunkElements read;
+  ListsChunkElements* elements = &read;
+  auto iter = chunks_.find(ChunkOf(index));
+  if (iter != chunks_.end()) {
+    elements = &iter->second;
+  } else {
+    Status s = Read(ChunkOf(index), &read);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  uint64_t offset = Offset(index);
+  if (offset >= elements->size()) {
+    return Status::Corruption("list chunk misses an element");
+  }
+  return EntryElement((*elements)[offset], element);
+}
+
+Status ListsChunks::Range(uint64_t first, uint64_t last, std::vector<std::string>* elements) {
+  std::unique_ptr<rocksdb::Iterator> iter(db_->NewIterator(read_options_, handle_));
+  ListsDataKey start_data_key(key_, version_, ChunkOf(first), slot_num_);
+  iter->Seek(start_data_key.Encode());
+  ListsChunkElements chunk_elements;
+  for (uint64_t chunk = ChunkOf(first); chunk <= ChunkOf(last); chunk++, iter->Next()) {
+    if (!iter->Valid()) {
+      return iter->status().ok() ? Status::Corruption("list chunk missing") : iter->status();
+    }
+    ParsedListsDataKey parsed_lists_data_key(iter->key());
+    if (parsed_lists_data_key.Version() != version_ || parsed_lists_data_key.index() != chunk) {
+      return Status::Corruption("list chunk missing");
+    }
+    ParsedBaseDataValue parsed_value(iter->value());
+    if (!DecodeListsChunk(parsed_value.UserValue(), &chunk_elements)) {
+      return Status::Corruption("invalid list chunk");
+    }
+    uint64_t chunk_first = std::max(ChunkStart(chunk), meta_->LeftIndex() + 1);
+    uint64_t begin = first > chunk_first ? first - chunk_first : 0;
+    uint64_t end = std::min<uint64_t>(last - chunk_first + 1, chunk_elements.size());
+    for (uint64_t i = begin; i < end; i++) {
+      if (chunk_elements[i].spill == 0) {
+        elements->push_back(std::move(chunk_elements[i].element));
+        continue;
+      }
+      Status s = EntryElement(chunk_elements[i], &elements->emplace_back());
+      if (!s.ok()) {
+        return s;
+      }
+    }
+  }
+  return Status::OK();
+}
+
+Status ListsChunks::Find(const Slice& element, uint64_t* index) {
+  uint64_t first = meta_->LeftIndex() + 1;
+  uint64_t last = meta_->RightIndex() - 1;
+  std::unique_ptr<rocksdb::Iterator> iter(db_->NewIterator(read_options_, handle_));
+  ListsDataKey start_data_key(key_, version_, ChunkOf(first), slot_num_);
+  iter->Seek(start_data_key.Encode());
+  ListsChunkElements chunk_elements;
+  for (uint64_t chunk = ChunkOf(first); chunk <= ChunkOf(last); chunk++, iter->Next()) {
+    if (!iter->Valid()) {
+      return iter->status().ok() ? Status::Corruption("list chunk missing") : iter->status();
+    }
+    ParsedListsDataKey parsed_lists_data_key(iter->key());
+    if (parsed_lists_data_key.Version() != version_ || parsed_lists_data_key.index() != chunk) {
+      return Status::Corruption("list chunk missing");
+    }
+    ParsedBaseDataValue parsed_value(iter->value());
+    if (!DecodeListsChunk(parsed_value.UserValue(), &chunk_elements)) {
+      return Status::Corruption("invalid list chunk");
+    }
+    uint64_t chunk_first = std::max(ChunkStart(chunk), first);
+    for (uint64_t i = 0; i < chunk_elements.size(); i++) {
+      const ListsChunkEntry& entry = chunk_elements[i];
+      if (entry.spill != 0) {
+        // Spilled elements are only read when their size matches
+        if (entry.size != element.size()) {
+          continue;
+        }
+        std::string spilled;
+        Status s = EntryElement(entry, &spilled);
+        if (!s.ok()) {
+          return s;
+        }
+        if (element.compare(spilled) == 0) {
+          *index = chunk_first + i;
+          return Status::OK();
+        }
+      } else if (element.compare(entry.element) == 0) {
+        *index = chunk_first + i;
+        return Status::OK();
+      }
+    }
+  }
+  return Status::NotFound();
+}
+
+Status ListsChunks::Set(uint64_t index, const std::string& element) {
+  ListsChunkElements* elements;
+  Status s = Load(ChunkOf(index), &elements);
+  if (!s.ok()) {
+    return s;
+  }
+  uint64_t offset = Offset(index);
+  if (offset >= elements->size()) {
+    return Status::Corruption("list chunk misses an element");
+  }
+  DropEntry((*elements)[offset]);
+  (*elements)[offset] = MakeEntry(element);
+  return Status::OK();
+}
+
+Status ListsChunks::PushFront(const std::string& element) {
+  // The chunk of the new index either starts with the current first element
+  // or has no elements yet
+  ListsChunkElements* elements;
+  Status s = Load(ChunkOf(meta_->LeftIndex()), &elements);
+  if (!s.ok()) {
+    return s;
+  }
+  elements->push_front(MakeEntry(element));
+  meta_->ModifyLeftIndex(1);
+  meta_->ModifyCount(1);
+  return Status::OK();
+}
+
+Status ListsChunks::PushBack(const std::string& element) {
+  ListsChunkElements* elements;
+  Status s = Load(ChunkOf(meta_->RightIndex()), &elements);
+  if (!s.ok()) {
+    return s;
+  }
+  elements->push_back(MakeEntry(element));
+  meta_->ModifyRightIndex(1);
+  meta_->ModifyCount(1);
+  return Status::OK();
+}
+
+Status ListsChunks::PopFront(std::string* element) {
+  ListsChunkElements* elements;
+  Status s = Load(ChunkOf(meta_->LeftIndex() + 1), &elements);
+  if (!s.ok()) {
+    return s;
+  }
+  if (elements->empty()) {
+    return Status::Corruption("list chunk misses an element");
+  }
+  s = EntryElement(elements->front(), element);
+  if (!s.ok()) {
+    return s;
+  }
+  DropEntry(elements->front());
+  elements->pop_front();
+  meta_->ModifyLeftIndex(-1);
+  meta_->ModifyCount(-1);
+  return Status::OK();
+}
+
+Status ListsChunks::PopBack(std::string* element) {
+  ListsChunkElements* elements;
+  Status s = Load(ChunkOf(meta_->RightIndex() - 1), &elements);
+  if (!s.ok()) {
+    return s;
+  }
+  if (elements->empty()) {
+    return Status::Corruption("list chunk misses an element");
+  }
+  s = EntryElement(elements->back(), element);
+  if (!s.ok()) {
+    return s;
+  }
+  DropEntry(elements->back());
+  elements->pop_back();
+  meta_->ModifyRightIndex(-1);
+  meta_->ModifyCount(-1);
+  return Status::OK();
+}
+
+Status ListsChunks::TrimFront(uint64_t count) {
+  if (count == 0) {
+    return Status::OK();
+  }
+  uint64_t first = meta_->LeftIndex() + 1;
+  uint64_t last = first + count - 1;
+  Status s;
+  for (uint64_t chunk = ChunkOf(first); chunk < ChunkOf(last); chunk++) {
+    s = Clear(chunk);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  // The chunk of the last removed element may keep some
+  ListsChunkElements* elements;
+  s = Load(ChunkOf(last), &elements);
+  if (!s.ok()) {
+    return s;
+  }
+  uint64_t removed = std::min<uint64_t>(Offset(last) + 1, elements->size());
+  for (uint64_t i = 0; i < removed; i++) {
+    DropEntry((*elements)[i]);
+  }
+  elements->erase(elements->begin(), elements->begin() + static_cast<int64_t>(removed));
+  meta_->ModifyLeftIndex(-count);
+  meta_->ModifyCount(-count);
+  return Status::OK();
+}
+
+Status ListsChunks::TrimBack(uint64_t count) {
+  if (count == 0) {
+    return Status::OK();
+  }
+  uint64_t last = meta_->RightIndex() - 1;
+  uint64_t first = last - count + 1;
+  Status s;
+  for (uint64_t chunk = ChunkOf(first) + 1; chunk <= ChunkOf(last); chunk++) {
+    s = Clear(chunk);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  ListsChunkElements* elements;
+  s = Load(ChunkOf(first), &elements);
+  if (!s.ok()) {
+    return s;
+  }
+  uint64_t kept = std::min<uint64_t>(Offset(first), elements->size());
+  for (uint64_t i = kept; i < elements->size(); i++) {
+    DropEntry((*elements)[i]);
+  }
+  elements->resize(kept);
+  meta_->ModifyRightIndex(-count);
+  meta_->ModifyCount(-count);
+  return Status::OK();
+}
+
+void ListsChunks::Flush(rocksdb::WriteBatch* batch) {
+  std::string chunk_value;
+  for (const auto& [chunk, elements] : chunks_) {
+    ListsDataKey lists_data_key(key_, version_, chunk, slot_num_);
+    if (elements.empty()) {
+      batch->Delete(handle_, lists_data_key.Encode());
+    } else {
+      EncodeListsChunk(elements, &chunk_value);
+      BaseDataValue i_val(chunk_value);
+      batch->Put(handle_, lists_data_key.Encode(), i_val.Encode());
+    }
+  }
+  chunks_.clear();
+  for (const auto& [spill, element] : spill_puts_) {
+    ListsDataKey lists_data_key(key_, version_, spill, slot_num_);
+    BaseDataValue i_val(element);
+    batch->Put(handle_, lists_data_key.Encode(), i_val.Encode());
+  }
+  spill_puts_.clear();
+  for (uint64_t spill : spill_deletes_) {
+    ListsDataKey lists_data_key(key_, version_, spill, slot_num_);
+    batch->Delete(handle_, lists_data_key.Encode());
+  }
+  spill_deletes_.clear();
+}
+
+}  //  namespace storage
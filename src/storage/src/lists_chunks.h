@@ -0,0 +1,131 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef SRC_LISTS_CHUNKS_H_
+#define SRC_LISTS_CHUNKS_H_
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "rocksdb/db.h"
+#include "rocksdb/status.h"
+#include "rocksdb/write_batch.h"
+
+#include "src/lists_meta_value_format.h"
+#include "storage/storage_define.h"
+
+namespace storage {
+
+using Status = rocksdb::Status;
+
+/*
+ * Lists whose meta is kListsEncodingChunked keep their elements in chunks.
+ * The elements whose index >> kListsChunkShift is the same share one
+ * kListsDataCF row, whose ListsDataKey holds that chunk number in place of
+ * the index. A chunk holds the elements of its index range that are in the
+ * list, in order, so the left and right index of the meta tell the index of
+ * its first one, and a chunk left without elements is deleted.
+ *
+ * chunk value, followed by the data value suffix:
+ * | count | len | element | ... | len | element |
+ * |  4B   | 4B  |         |     | 4B  |         |
+ *
+ * An element longer than kListsChunkInlineSize is spilled to a row of its
+ * own, keyed by kListsSpillBase plus a number the meta hands out, and its
+ * len has kListsChunkSpilled set and is followed by that 8B key instead.
+ * No entry then takes more than kListsChunkMaxBytes / kListsChunkSize,
+ * which caps the size of a chunk whatever the elements are.
+ */
+constexpr uint64_t kListsChunkShift = 7;
+constexpr uint64_t kListsChunkSize = 1ULL << kListsChunkShift;
+constexpr uint64_t kListsChunkMaxBytes = 64 << 10;
+constexpr uint64_t kListsChunkInlineSize = kListsChunkMaxBytes / kListsChunkSize - sizeof(uint32_t);
+constexpr uint32_t kListsChunkSpilled = 1U << 31;
+// Above every chunk number
+constexpr uint64_t kListsSpillBase = 1ULL << 62;
+
+// Elements moved into chunks per batch when a list kept one row per element
+// is upgraded, a multiple of kListsChunkSize so every batch ends on a full chunk
+constexpr uint64_t kListsUpgradeBatchSize = 64 * kListsChunkSize;
+
+struct ListsChunkEntry {
+  // Empty for a spilled element
+  std::string element;
+  // The key of the row of a spilled element, 0 for one kept in the chunk
+  uint64_t spill = 0;
+  // The size of a spilled element
+  uint32_t size = 0;
+};
+
+using ListsChunkElements = std::deque<ListsChunkEntry>;
+
+void EncodeListsChunk(const ListsChunkElements& elements, std::string* dst);
+bool DecodeListsChunk(const Slice& chunk, ListsChunkElements* elements);
+
+/*
+ * Reads and changes the chunks of the current version of one list. Changes
+ * update the meta right away and keep the chunks, and the spilled elements
+ * to write or delete, in memory until Flush puts them into the batch, so one
+ * command may change the same chunk several times. Writing the meta is left
+ * to the caller.
+ */
+class ListsChunks {
+ public:
+  ListsChunks(rocksdb::DB* db, rocksdb::ColumnFamilyHandle* handle, const rocksdb::ReadOptions& read_options,
+              const Slice& key, ParsedListsMetaValue* meta, int slot_num);
+
+  static uint64_t ChunkOf(uint64_t index) { return index >> kListsChunkShift; }
+  static uint64_t ChunkStart(uint64_t chunk) { return chunk << kListsChunkShift; }
+
+  // Indexes are the ones between the left and right index of the meta
+  Status Index(uint64_t index, std::string* element);
+  // Appends the elements from first to last, both included
+  Status Range(uint64_t first, uint64_t last, std::vector<std::string>* elements);
+  // The index of the first element equal to element, NotFound if none is
+  Status Find(const Slice& element, uint64_t* index);
+
+  Status Set(uint64_t index, const std::string& element);
+  Status PushFront(const std::string& element);
+  Status PushBack(const std::string& element);
+  Status PopFront(std::string* element);
+  Status PopBack(std::string* element);
+  // Removes the first or last count elements, the chunks they fill are only
+  // read to find the spilled elements to delete
+  Status TrimFront(uint64_t count);
+  Status TrimBack(uint64_t count);
+
+  void Flush(rocksdb::WriteBatch* batch);
+
+ private:
+  // Position of index among the elements of its chunk
+  uint64_t Offset(uint64_t index);
+  // The cached elements of chunk, read first if needed
+  Status Load(uint64_t chunk, ListsChunkElements** elements);
+  Status Read(uint64_t chunk, ListsChunkElements* elements);
+  // Removes every element of chunk
+  Status Clear(uint64_t chunk);
+  // The entry keeping element, which is spilled when it is long
+  ListsChunkEntry MakeEntry(const std::string& element);
+  Status EntryElement(const ListsChunkEntry& entry, std::string* element);
+  // Deletes the row of entry when it is spilled
+  void DropEntry(const ListsChunkEntry& entry);
+
+  rocksdb::DB* db_ = nullptr;
+  rocksdb::ColumnFamilyHandle* handle_ = nullptr;
+  rocksdb::ReadOptions read_options_;
+  std::string key_;
+  ParsedListsMetaValue* meta_ = nullptr;
+  uint64_t version_ = 0;
+  int slot_num_ = 0;
+  // Every chunk in here was changed and is written by Flush
+  std::map<uint64_t, ListsChunkElements> chunks_;
+  std::map<uint64_t, std::string> spill_puts_;
+  std::vector<uint64_t> spill_deletes_;
+};
+
+}  //  namespace storage
+#endif  // SRC_LISTS_CHUNKS_H_
@@ -17,8 +17,8 @@ namespace storage {
 */
 class ListsDataKey {
 public:
-  ListsDataKey(const Slice& key, uint64_t version, uint64_t index)
-      : key_(key), version_(version), index_(index) {}
+  ListsDataKey(const Slice& key, uint64_t version, uint64_t index, int slot_num)
+      : key_(key), version_(version), index_(index), slot_num_(slot_num) {}
 
   ~ListsDataKey() {
     if (start_ != space_) {
@@ -46,7 +46,7 @@ public:
 
     start_ = dst;
     // reserve1: 8 byte
-    memcpy(dst, reserve1_, sizeof(reserve1_));
+    EncodeKeyPrefix(slot_num_, key_, dst);
     dst += sizeof(reserve1_);
     dst = EncodeUserKey(key_, dst, nzero);
     // version 8 byte
@@ -68,6 +68,8 @@ private:
   Slice key_;
   uint64_t version_ = uint64_t(-1);
   uint64_t index_ = 0;
+  // SlotKeyPrefixNum() of the storage
+  int slot_num_ = 0;
   char reserve2_[16] = {0};
 };
 
@@ -16,6 +16,16 @@ namespace storage {
 const uint64_t InitalLeftIndex = 9223372036854775807;
 const uint64_t InitalRightIndex = 9223372036854775808U;
 
+/*
+ * The first byte of the meta reserve, how the elements are kept in
+ * kListsDataCF. Lists written before chunks existed have one row per
+ * element, see lists_chunks.h for the chunked ones.
+ */
+enum ListsEncoding : char {
+  kListsEncodingElement = 0,
+  kListsEncodingChunked = 1,
+};
+
 /*
 *| type | list_size | version | left index | right index | reserve |  cdate | timestamp |
 *|  1B  |     8B    |    8B   |     8B     |      8B     |   16B   |    8B  |     8B    |
@@ -23,7 +33,9 @@ const uint64_t InitalRightIndex = 9223372036854775808U;
 class ListsMetaValue : public InternalValue {
  public:
   explicit ListsMetaValue(const rocksdb::Slice& user_value)
-      : InternalValue(DataType::kLists, user_value), left_index_(InitalLeftIndex), right_index_(InitalRightIndex) {}
+      : InternalValue(DataType::kLists, user_value), left_index_(InitalLeftIndex), right_index_(InitalRightIndex) {
+    reserve_[0] = kListsEncodingChunked;
+  }
 
   rocksdb::Slice Encode() override {
     size_t usize = user_value_.size();
@@ -172,9 +184,30 @@ class ParsedListsMetaValue : public ParsedInternalValue {
     this->set_right_index(InitalRightIndex);
     this->SetEtime(0);
     this->SetCtime(0);
+    this->SetEncoding(kListsEncodingChunked);
     return this->UpdateVersion();
   }
 
+  bool IsChunked() { return reserve_[0] == kListsEncodingChunked; }
+
+  void SetEncoding(ListsEncoding encoding) {
+    reserve_[0] = encoding;
+    if (value_) {
+      *ReserveToValue() = encoding;
+    }
+  }
+
+  // Numbers the rows of the elements a chunked list keeps out of its chunks,
+  // the counter is the last 8 bytes of the reserve
+  uint64_t NextSpillNumber() {
+    uint64_t number = DecodeFixed64(reserve_ + kListsSpillNumberOffset);
+    EncodeFixed64(reserve_ + kListsSpillNumberOffset, number + 1);
+    if (value_) {
+      EncodeFixed64(ReserveToValue() + kListsSpillNumberOffset, number + 1);
+    }
+    return number;
+  }
+
   bool IsValid() override {
     return !IsStale() && Count() != 0;
   }
@@ -247,8 +280,13 @@ class ParsedListsMetaValue : public ParsedInternalValue {
 
 private:
   const size_t kListsMetaValueSuffixLength = kVersionLength + 2 * kListValueIndexLength + kSuffixReserveLength + 2 * kTimestampLength;
+  static constexpr size_t kListsSpillNumberOffset = 8;
+
+  char* ReserveToValue() {
+    return const_cast<char*>(value_->data()) + value_->size() - kListsMetaValueSuffixLength + kVersionLength +
+           2 * kListValueIndexLength;
+  }
 
- private:
   uint64_t count_ = 0;
   uint64_t left_index_ = 0;
   uint64_t right_index_ = 0;
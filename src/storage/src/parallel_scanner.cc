@@ -0,0 +1,144 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "src/parallel_scanner.h"
+
+#include <queue>
+
+namespace storage {
+
+ParallelScanner::ParallelScanner(std::vector<IterSptr> iters, rocksdb::ThreadPool* pool) : pool_(pool) {
+  for (auto& iter : iters) {
+    auto source = std::make_unique<Source>();
+    source->iter = std::move(iter);
+    sources_.push_back(std::move(source));
+  }
+}
+
+ParallelScanner::~ParallelScanner() { Stop(); }
+
+void ParallelScanner::ReadBatch(Source* source, std::unique_lock<std::mutex>* l) {
+  source->reading = true;
+  l->unlock();
+  TypeIterator* iter = source->iter.get();
+  if (!source->sought) {
+    if (start_key_) {
+      iter->Seek(*start_key_);
+    } else {
+      iter->SeekToFirst();
+    }
+    source->sought = true;
+  }
+  std::vector<Entry> batch;
+  batch.reserve(kBatchSize);
+  while (batch.size() < kBatchSize && !stop_.load(std::memory_order_relaxed) && iter->Valid()) {
+    batch.push_back({iter->RawKey().ToString(), iter->Key()});
+    iter->Next();
+  }
+  bool done = stop_.load(std::memory_order_relaxed) || !iter->Valid();
+  Status status = done ? iter->status() : Status::OK();
+  l->lock();
+
+  source->reading = false;
+  if (!batch.empty()) {
+    source->batches.push_back(std::move(batch));
+  }
+  if (done) {
+    source->status = status;
+    source->done = true;
+  }
+  source->cv.notify_all();
+}
+
+void ParallelScanner::ReadAhead(Source* source) {
+  std::unique_lock l(source->mu);
+  while (!stop_.load() && !source->done && !source->reading && source->batches.size() < kPrefetchBatches) {
+    ReadBatch(source, &l);
+  }
+  source->scheduled = false;
+  source->cv.notify_all();
+}
+
+void ParallelScanner::ScheduleReadAhead(Source* source) {
+  if (!pool_ || source->scheduled || source->done || stop_.load()) {
+    return;
+  }
+  source->scheduled = true;
+  pool_->SubmitJob([this, source] { ReadAhead(source); });
+}
+
+bool ParallelScanner::Advance(Source* source) {
+  source->pos++;
+  if (source->pos < source->current.size()) {
+    return true;
+  }
+  std::unique_lock l(source->mu);
+  while (source->batches.empty() && !source->done) {
+    if (source->reading) {
+      source->cv.wait(l);
+    } else {
+      // The job has not got to it, read here rather than wait behind other scans
+      ReadBatch(source, &l);
+    }
+  }
+  if (source->batches.empty()) {
+    return false;
+  }
+  source->current = std::move(source->batches.front());
+  source->batches.pop_front();
+  source->pos = 0;
+  // Room to read ahead again
+  ScheduleReadAhead(source);
+  return true;
+}
+
+Status ParallelScanner::Scan(const std::string* start_key, const std::function<bool(const std::string& key)>& visit) {
+  start_key_ = start_key;
+  for (auto& source : sources_) {
+    std::lock_guard l(source->mu);
+    ScheduleReadAhead(source.get());
+  }
+
+  auto greater = [](const Source* a, const Source* b) {
+    return a->current[a->pos].raw_key > b->current[b->pos].raw_key;
+  };
+  std::priority_queue<Source*, std::vector<Source*>, decltype(greater)> heap(greater);
+  for (auto& source : sources_) {
+    // pos starts one before the empty current batch, this fetches the first one
+    source->pos = static_cast<size_t>(-1);
+    if (Advance(source.get())) {
+      heap.push(source.get());
+    }
+  }
+  while (!heap.empty()) {
+    Source* source = heap.top();
+    heap.pop();
+    if (!visit(source->current[source->pos].key)) {
+      break;
+    }
+    if (Advance(source)) {
+      heap.push(source);
+    }
+  }
+  Stop();
+
+  for (auto& source : sources_) {
+    if (!source->status.ok()) {
+      return source->status;
+    }
+  }
+  return Status::OK();
+}
+
+void ParallelScanner::Stop() {
+  stop_ = true;
+  // A job submitted but not yet run still gets to run, it returns at once
+  for (auto& source : sources_) {
+    std::unique_lock l(source->mu);
+    source->cv.wait(l, [&source] { return !source->scheduled && !source->reading; });
+  }
+}
+
+}  // namespace storage
@@ -0,0 +1,90 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef SRC_PARALLEL_SCANNER_H_
+#define SRC_PARALLEL_SCANNER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rocksdb/threadpool.h"
+
+#include "src/type_iterator.h"
+
+namespace storage {
+
+/*
+ * Runs the iterators of the db instances on a shared pool and merges what
+ * they find in key order on the calling thread, like MergingIterator does
+ * serially. A pool job reads at most kPrefetchBatches batches ahead of the
+ * merge and then returns its thread, so memory stays bounded however many
+ * keys match, and the jobs stop as soon as the visitor does. When the job
+ * of an instance has not run yet, because the pool is busy with other
+ * scans, the merge reads the batch it waits for itself.
+ */
+class ParallelScanner {
+ public:
+  static constexpr size_t kBatchSize = 512;
+  static constexpr size_t kPrefetchBatches = 4;
+
+  // Without a pool every batch is read by the merge
+  ParallelScanner(std::vector<IterSptr> iters, rocksdb::ThreadPool* pool);
+  ~ParallelScanner();
+
+  /*
+   * Calls visit with every key from start_key on, or from the first key
+   * when start_key is null, in the order of the encoded keys, until it
+   * returns false.
+   */
+  Status Scan(const std::string* start_key, const std::function<bool(const std::string& key)>& visit);
+
+ private:
+  struct Entry {
+    std::string raw_key;
+    std::string key;
+  };
+  struct Source {
+    IterSptr iter;
+    std::mutex mu;
+    std::condition_variable cv;
+    std::deque<std::vector<Entry>> batches;
+    // A read ahead job of the source is submitted to the pool
+    bool scheduled = false;
+    // The iterator is being read, by the job or by the merge
+    bool reading = false;
+    bool sought = false;
+    bool done = false;
+    Status status;
+    // Read by the merge only
+    std::vector<Entry> current;
+    size_t pos = 0;
+  };
+
+  // REQUIRES: l holds the lock of source and the source is not being read,
+  // it is released while reading
+  void ReadBatch(Source* source, std::unique_lock<std::mutex>* l);
+  // The pool job, reads until kPrefetchBatches batches are queued
+  void ReadAhead(Source* source);
+  // REQUIRES: the lock of source is held
+  void ScheduleReadAhead(Source* source);
+  // Moves source to its next key, false when it has no more
+  bool Advance(Source* source);
+  // Stops the jobs and waits for them to return
+  void Stop();
+
+  std::vector<std::unique_ptr<Source>> sources_;
+  rocksdb::ThreadPool* pool_ = nullptr;
+  const std::string* start_key_ = nullptr;
+  std::atomic<bool> stop_ = false;
+};
+
+}  // namespace storage
+#endif  // SRC_PARALLEL_SCANNER_H_
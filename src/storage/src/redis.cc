@@ -5,12 +5,22 @@
 
 #include <sstream>
 
+#include <glog/logging.h>
+
+#include "rocksdb/convenience.h"
 #include "rocksdb/env.h"
 
+#include "pstd/include/pika_codis_slot.h"
+
 #include "src/redis.h"
 #include "src/lists_filter.h"
 #include "src/base_filter.h"
 #include "src/zsets_filter.h"
+#include "src/base_data_key_format.h"
+#include "src/expire_index_key_format.h"
+#include "src/scope_record_lock.h"
+#include "src/scope_snapshot.h"
+#include "storage/util.h"
 
 namespace storage {
 
@@ -30,14 +40,18 @@ Redis::Redis(Storage* const s, int32_t index)
     : storage_(s), index_(index),
       lock_mgr_(std::make_shared<LockMgr>(1000, 0, std::make_shared<MutexFactoryImpl>())),
       small_compaction_threshold_(5000),
-      small_compaction_duration_threshold_(10000) {
+      small_compaction_duration_threshold_(10000),
+      zset_rank_index_threshold_(0) {
   statistics_store_ = std::make_unique<LRUCache<std::string, KeyStatistics>>();
+  zset_rank_index_store_ = std::make_unique<LRUCache<std::string, std::shared_ptr<ZSetsRankIndex>>>();
   scan_cursors_store_ = std::make_unique<LRUCache<std::string, std::string>>();
   spop_counts_store_ = std::make_unique<LRUCache<std::string, size_t>>();
   default_compact_range_options_.exclusive_manual_compaction = false;
   default_compact_range_options_.change_level = true;
   spop_counts_store_->SetCapacity(1000);
   scan_cursors_store_->SetCapacity(5000);
+  // charged by buckets, about 64MB for 256 bytes score keys
+  zset_rank_index_store_->SetCapacity(1 << 18);
   //env_ = rocksdb::Env::Instance();
   handles_.clear();
 }
@@ -60,6 +74,8 @@ Redis::~Redis() {
 Status Redis::Open(const StorageOptions& storage_options, const std::string& db_path) {
   statistics_store_->SetCapacity(storage_options.statistics_max_size);
   small_compaction_threshold_ = storage_options.small_compaction_threshold;
+  zset_rank_index_threshold_ = storage_options.zset_rank_index_threshold;
+  slot_key_prefix_num_ = storage_->SlotKeyPrefixNum();
 
   rocksdb::BlockBasedTableOptions table_ops(storage_options.table_options);
   table_ops.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10, true));
@@ -138,6 +154,18 @@ Status Redis::Open(const StorageOptions& storage_options, const std::string& db_
   }
   stream_data_cf_ops.table_factory.reset(rocksdb::NewBlockBasedTableFactory(stream_data_cf_table_ops));
 
+  // expire index column-family options
+  rocksdb::ColumnFamilyOptions expire_index_cf_ops(storage_options.options);
+
+  // bitmap column-family options
+  rocksdb::ColumnFamilyOptions bitmap_data_cf_ops(storage_options.options);
+  bitmap_data_cf_ops.compaction_filter_factory = std::make_shared<BaseDataFilterFactory>(&db_, &handles_, DataType::kStrings);
+  rocksdb::BlockBasedTableOptions bitmap_data_cf_table_ops(table_ops);
+  if (!storage_options.share_block_cache && storage_options.block_cache_size > 0) {
+    bitmap_data_cf_table_ops.block_cache = rocksdb::NewLRUCache(storage_options.block_cache_size);
+  }
+  bitmap_data_cf_ops.table_factory.reset(rocksdb::NewBlockBasedTableFactory(bitmap_data_cf_table_ops));
+
   std::vector<rocksdb::ColumnFamilyDescriptor> column_families;
   // meta & string cf
   column_families.emplace_back(rocksdb::kDefaultColumnFamilyName, meta_cf_ops);
@@ -152,6 +180,10 @@ Status Redis::Open(const StorageOptions& storage_options, const std::string& db_
   column_families.emplace_back("zset_score_cf", zset_score_cf_ops);
   // stream CF
   column_families.emplace_back("stream_data_cf", stream_data_cf_ops);
+  // expire index CF
+  column_families.emplace_back("expire_index_cf", expire_index_cf_ops);
+  // bitmap CF
+  column_families.emplace_back("bitmap_data_cf", bitmap_data_cf_ops);
   return rocksdb::DB::Open(db_ops, db_path, column_families, &handles_, &db_);
 }
 
@@ -196,6 +228,7 @@ Status Redis::CompactRange(const rocksdb::Slice* begin, const rocksdb::Slice* en
   db_->CompactRange(default_compact_range_options_, handles_[kZsetsDataCF], begin, end);
   db_->CompactRange(default_compact_range_options_, handles_[kZsetsScoreCF], begin, end);
   db_->CompactRange(default_compact_range_options_, handles_[kStreamsDataCF], begin, end);
+  db_->CompactRange(default_compact_range_options_, handles_[kBitmapsDataCF], begin, end);
   return Status::OK();
 }
 
@@ -209,6 +242,14 @@ Status Redis::SetSmallCompactionDurationThreshold(uint64_t small_compaction_dura
   return Status::OK();
 }
 
+Status Redis::SetZSetsRankIndexThreshold(uint64_t zset_rank_index_threshold) {
+  zset_rank_index_threshold_ = zset_rank_index_threshold;
+  if (zset_rank_index_threshold == 0) {
+    zset_rank_index_store_->Clear();
+  }
+  return Status::OK();
+}
+
 Status Redis::UpdateSpecificKeyStatistics(const DataType& dtype, const std::string& key, uint64_t count) {
   if ((statistics_store_->Capacity() != 0U) && (count != 0U) && (small_compaction_threshold_ != 0U)) {
     KeyStatistics data;
@@ -395,6 +436,389 @@ Status Redis::ScanKeyNum(std::vector<KeyInfo>* key_infos) {
   return Status::OK();
 }
 
+void Redis::MultiGet(const rocksdb::ReadOptions& read_options, rocksdb::ColumnFamilyHandle* handle,
+                     const std::vector<std::string>& encoded_keys, std::vector<std::string>* values,
+                     std::vector<Status>* statuses) {
+  size_t num = encoded_keys.size();
+  std::vector<rocksdb::Slice> key_slices(encoded_keys.begin(), encoded_keys.end());
+  std::vector<rocksdb::PinnableSlice> pinnable_values(num);
+  statuses->assign(num, Status::OK());
+  values->assign(num, std::string());
+  if (num == 0) {
+    return;
+  }
+  db_->MultiGet(read_options, handle, num, key_slices.data(), pinnable_values.data(), statuses->data());
+  for (size_t idx = 0; idx < num; ++idx) {
+    if ((*statuses)[idx].ok()) {
+      (*values)[idx].assign(pinnable_values[idx].data(), pinnable_values[idx].size());
+    }
+  }
+}
+
+void Redis::MultiGetMeta(const rocksdb::ReadOptions& read_options, const std::vector<std::string>& keys,
+                         std::vector<std::string>* values, std::vector<Status>* statuses) {
+  std::vector<std::string> encoded_keys;
+  encoded_keys.reserve(keys.size());
+  for (const auto& key : keys) {
+    BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
+    encoded_keys.push_back(base_meta_key.Encode().ToString());
+  }
+  MultiGet(read_options, handles_[kMetaCF], encoded_keys, values, statuses);
+}
+
+// The lower bound of every key of slot, its reserve1 followed by nothing
+static std::string SlotPrefixKey(uint32_t slot) {
+  std::string key(kPrefixReserveLength, '\0');
+  EncodeSlotPrefix(slot, key.data());
+  return key;
+}
+
+// ZSetsScoreKeyComparator parses the version and score after the user key,
+// so the bound in kZsetsScoreCF is an empty user key with version 0
+static std::string SlotScorePrefixKey(uint32_t slot) {
+  std::string key(kPrefixReserveLength + kEncodedKeyDelimSize + kVersionLength + kScoreLength, '\0');
+  EncodeSlotPrefix(slot, key.data());
+  return key;
+}
+
+Status Redis::ScanSlot(uint32_t slot, int64_t cursor, const std::string& pattern, int64_t count,
+                       std::vector<std::string>* keys, int64_t* next_cursor) {
+  rocksdb::ReadOptions iterator_options;
+  const rocksdb::Snapshot* snapshot;
+  ScopeSnapshot ss(db_, &snapshot);
+  iterator_options.snapshot = snapshot;
+  iterator_options.fill_cache = false;
+  std::string start_key = SlotPrefixKey(slot);
+  std::string end_key = SlotPrefixKey(slot + 1);
+  rocksdb::Slice upper_bound(end_key);
+  iterator_options.iterate_upper_bound = &upper_bound;
+
+  // The cursor stands for the meta key the previous page stopped at, a
+  // cursor that is unknown or evicted starts over from the slot beginning
+  std::string start_point;
+  Status s = GetScanStartPoint(DataType::kAll, start_key, pattern, cursor, &start_point);
+  if (!s.ok()) {
+    cursor = 0;
+    start_point = start_key;
+  }
+
+  int64_t step_length = count;
+  std::string meta_value;
+  rocksdb::Iterator* iter = db_->NewIterator(iterator_options, handles_[kMetaCF]);
+  for (iter->Seek(start_point); iter->Valid() && count > 0; iter->Next()) {
+    meta_value = iter->value().ToString();
+    if (ExpectedStale(meta_value)) {
+      continue;
+    }
+    // same as the members of the slot key set, type tag followed by the key
+    ParsedBaseMetaKey parsed_meta_key(iter->key());
+    std::string member = DataTypeToTag(GetMetaValueType(meta_value)) + parsed_meta_key.Key().ToString();
+    if (StringMatch(pattern.data(), pattern.size(), member.data(), member.size(), 0) == 0) {
+      continue;
+    }
+    keys->push_back(std::move(member));
+    count--;
+  }
+  if (iter->Valid()) {
+    *next_cursor = cursor + step_length;
+    StoreScanNextPoint(DataType::kAll, start_key, pattern, *next_cursor, iter->key().ToString());
+  } else {
+    *next_cursor = 0;
+  }
+  s = iter->status();
+  delete iter;
+  return s;
+}
+
+Status Redis::SlotKeyNum(uint32_t slot, int64_t* num) {
+  rocksdb::ReadOptions iterator_options;
+  const rocksdb::Snapshot* snapshot;
+  ScopeSnapshot ss(db_, &snapshot);
+  iterator_options.snapshot = snapshot;
+  iterator_options.fill_cache = false;
+  std::string start_key = SlotPrefixKey(slot);
+  std::string end_key = SlotPrefixKey(slot + 1);
+  rocksdb::Slice upper_bound(end_key);
+  iterator_options.iterate_upper_bound = &upper_bound;
+
+  *num = 0;
+  rocksdb::Iterator* iter = db_->NewIterator(iterator_options, handles_[kMetaCF]);
+  for (iter->Seek(start_key); iter->Valid(); iter->Next()) {
+    if (!ExpectedStale(iter->value().ToString())) {
+      (*num)++;
+    }
+  }
+  Status s = iter->status();
+  delete iter;
+  return s;
+}
+
+Status Redis::DeleteSlot(uint32_t slot) {
+  rocksdb::WriteBatch batch;
+  // The expire index is not ordered by slot, its entries of the slot are dropped by the reaper
+  for (size_t idx = 0; idx < handles_.size(); ++idx) {
+    if (idx == kExpireIndexCF) {
+      continue;
+    }
+    if (idx == kZsetsScoreCF) {
+      batch.DeleteRange(handles_[idx], SlotScorePrefixKey(slot), SlotScorePrefixKey(slot + 1));
+    } else {
+      batch.DeleteRange(handles_[idx], SlotPrefixKey(slot), SlotPrefixKey(slot + 1));
+    }
+  }
+  return db_->Write(default_write_options_, &batch);
+}
+
+Status Redis::ConvertToSlotKeyPrefix(Redis* target, int slot_num, int64_t* converted) {
+  rocksdb::ReadOptions iterator_options;
+  const rocksdb::Snapshot* snapshot;
+  ScopeSnapshot ss(db_, &snapshot);
+  iterator_options.snapshot = snapshot;
+  iterator_options.fill_cache = false;
+  rocksdb::WriteOptions write_options;
+  write_options.disableWAL = true;
+
+  Status s;
+  std::string key;
+  std::string user_key;
+  rocksdb::WriteBatch batch;
+  for (size_t idx = 0; idx < handles_.size() && s.ok(); ++idx) {
+    rocksdb::Iterator* iter = db_->NewIterator(iterator_options, handles_[idx]);
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      key = iter->key().ToString();
+      // The expire index holds the raw user keys, it is copied as it is
+      if (idx == kExpireIndexCF) {
+        batch.Put(target->handles_[idx], key, iter->value());
+        continue;
+      }
+      const char* ptr = key.data() + kPrefixReserveLength;
+      const char* end_ptr = SeekUserkeyDelim(ptr, static_cast<int>(key.size()) - kPrefixReserveLength);
+      DecodeUserKey(ptr, static_cast<int>(std::distance(ptr, end_ptr)), &user_key);
+      EncodeSlotPrefix(GetSlotID(slot_num, user_key), key.data());
+      batch.Put(target->handles_[idx], key, iter->value());
+      (*converted)++;
+      if (batch.Count() >= 1000) {
+        s = target->db_->Write(write_options, &batch);
+        batch.Clear();
+        if (!s.ok()) {
+          break;
+        }
+      }
+    }
+    if (s.ok()) {
+      s = iter->status();
+    }
+    delete iter;
+  }
+  if (s.ok() && batch.Count() != 0) {
+    s = target->db_->Write(write_options, &batch);
+  }
+  if (s.ok()) {
+    s = target->db_->Flush(rocksdb::FlushOptions(), target->handles_);
+  }
+  return s;
+}
+
+Status Redis::GetPropertiesOfAllTables(rocksdb::TablePropertiesCollection* props) {
+  for (auto handle : handles_) {
+    rocksdb::TablePropertiesCollection cf_props;
+    Status s = db_->GetPropertiesOfAllTables(handle, &cf_props);
+    if (!s.ok()) {
+      return s;
+    }
+    props->insert(cf_props.begin(), cf_props.end());
+  }
+  return Status::OK();
+}
+
+uint64_t Redis::MetaValueEtime(const std::string& meta_value) {
+  if (meta_value.empty()) {
+    return 0;
+  }
+  switch (GetMetaValueType(meta_value)) {
+    case DataType::kStrings:
+      return ParsedStringsValue(meta_value).Etime();
+    case DataType::kLists:
+      return ParsedListsMetaValue(meta_value).Etime();
+    case DataType::kHashes:
+    case DataType::kSets:
+    case DataType::kZSets:
+      return ParsedBaseMetaValue(meta_value).Etime();
+    default:
+      return 0;
+  }
+}
+
+Status Redis::PutWithExpireIndex(const Slice& key, const Slice& meta_key, const Slice& meta_value, uint64_t etime,
+                                 uint64_t old_etime) {
+  if (etime == 0 && old_etime == 0) {
+    return db_->Put(default_write_options_, handles_[kMetaCF], meta_key, meta_value);
+  }
+  // A key keeps the index row of its current etime only
+  rocksdb::WriteBatch batch;
+  batch.Put(handles_[kMetaCF], meta_key, meta_value);
+  if (old_etime != 0 && old_etime != etime) {
+    batch.Delete(handles_[kExpireIndexCF], ExpireIndexKey(old_etime, key).Encode());
+  }
+  if (etime != 0) {
+    batch.Put(handles_[kExpireIndexCF], ExpireIndexKey(etime, key).Encode(), Slice());
+  }
+  return db_->Write(default_write_options_, &batch);
+}
+
+Status Redis::ReapExpiredKey(const Slice& key, uint64_t etime, int64_t now, rocksdb::WriteBatch* batch,
+                             uint64_t* reclaimed_bytes, std::vector<DeadDataRange>* dead_ranges) {
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
+  std::string meta_value;
+  Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
+  if (s.IsNotFound()) {
+    // Deleted or overwritten since it was indexed, only the index entry is left
+    return Status::OK();
+  } else if (!s.ok()) {
+    return s;
+  }
+
+  // The key got another ttl, or none, after this entry was indexed
+  uint64_t meta_etime = MetaValueEtime(meta_value);
+  if (meta_etime == 0 || meta_etime != etime || static_cast<int64_t>(meta_etime) >= now) {
+    return Status::OK();
+  }
+
+  batch->Delete(handles_[kMetaCF], base_meta_key.Encode());
+  *reclaimed_bytes += base_meta_key.Encode().size() + meta_value.size();
+
+  // The data of lists and the scores of large zsets are left to their
+  // compaction filters, which drop them once the meta is gone, their column
+  // families are not in bytewise order so a range can not be computed here
+  auto type = GetMetaValueType(meta_value);
+  int data_cf = -1;
+  if (type == DataType::kHashes) {
+    data_cf = kHashesDataCF;
+  } else if (type == DataType::kSets) {
+    data_cf = kSetsDataCF;
+  } else if (type == DataType::kZSets) {
+    data_cf = kZsetsDataCF;
+  }
+  if (data_cf == -1) {
+    return Status::OK();
+  }
+  ParsedBaseMetaValue parsed_meta_value(meta_value);
+  uint64_t version = parsed_meta_value.Version();
+  BaseDataKey data_prefix(key, version, Slice(), slot_key_prefix_num_);
+  std::string start = data_prefix.EncodeSeekKey().ToString();
+  // Every data key of this version starts with start, end is the first key after them
+  std::string end = start;
+  while (!end.empty() && static_cast<uint8_t>(end.back()) == 0xff) {
+    end.pop_back();
+  }
+  if (end.empty()) {
+    return Status::OK();
+  }
+  end.back() = static_cast<char>(static_cast<uint8_t>(end.back()) + 1);
+
+  if (parsed_meta_value.Count() > kReapPointDeleteLimit) {
+    // A range tombstone costs less than reading the rows of a large
+    // collection, the files holding only its rows are dropped once the
+    // batch is written, the rest goes with the next compaction
+    rocksdb::Range range(start, end);
+    uint64_t size = 0;
+    rocksdb::SizeApproximationOptions options;
+    options.include_memtables = true;
+    options.include_files = true;
+    db_->GetApproximateSizes(options, handles_[data_cf], &range, 1, &size);
+    *reclaimed_bytes += size;
+    batch->DeleteRange(handles_[data_cf], start, end);
+    dead_ranges->push_back({data_cf, std::move(start), std::move(end)});
+    return Status::OK();
+  }
+
+  // Range tombstones slow down every read of the column family until they
+  // are compacted away, small collections are deleted row by row instead
+  Slice upper_bound(end);
+  rocksdb::ReadOptions iterator_options;
+  iterator_options.fill_cache = false;
+  iterator_options.iterate_upper_bound = &upper_bound;
+  std::unique_ptr<rocksdb::Iterator> iter(db_->NewIterator(iterator_options, handles_[data_cf]));
+  for (iter->Seek(start); iter->Valid(); iter->Next()) {
+    batch->Delete(handles_[data_cf], iter->key());
+    *reclaimed_bytes += iter->key().size() + iter->value().size();
+    if (type == DataType::kZSets) {
+      ParsedZSetsMemberKey parsed_zsets_member_key(iter->key());
+      uint64_t tmp = DecodeFixed64(iter->value().data());
+      const void* ptr_tmp = reinterpret_cast<const void*>(&tmp);
+      double score = *reinterpret_cast<const double*>(ptr_tmp);
+      ZSetsScoreKey zsets_score_key(key, version, score, parsed_zsets_member_key.member(), slot_key_prefix_num_);
+      batch->Delete(handles_[kZsetsScoreCF], zsets_score_key.Encode());
+    }
+  }
+  return iter->status();
+}
+
+Status Redis::ReapExpiredKeys(int64_t max_keys, int64_t* reaped_keys, uint64_t* reclaimed_bytes) {
+  *reaped_keys = 0;
+  *reclaimed_bytes = 0;
+  int64_t now;
+  rocksdb::Env::Default()->GetCurrentTime(&now);
+
+  // Only the entries of the keys that expired already
+  std::string upper_bound = ExpireIndexKey::EncodeEtime(static_cast<uint64_t>(now));
+  Slice upper_bound_slice(upper_bound);
+  rocksdb::ReadOptions iterator_options;
+  iterator_options.fill_cache = false;
+  iterator_options.iterate_upper_bound = &upper_bound_slice;
+  std::unique_ptr<rocksdb::Iterator> iter(db_->NewIterator(iterator_options, handles_[kExpireIndexCF]));
+
+  Status s;
+  int64_t visited = 0;
+  std::vector<DeadDataRange> dead_ranges;
+  for (iter->SeekToFirst(); iter->Valid() && visited < max_keys; iter->Next(), visited++) {
+    ParsedExpireIndexKey index_key(iter->key());
+    std::string key = index_key.Key().ToString();
+
+    ScopeRecordLock l(lock_mgr_, key);
+    rocksdb::WriteBatch batch;
+    uint64_t bytes = 0;
+    s = ReapExpiredKey(key, index_key.Etime(), now, &batch, &bytes, &dead_ranges);
+    if (!s.ok()) {
+      break;
+    }
+    bool reaped = batch.Count() != 0;
+    batch.Delete(handles_[kExpireIndexCF], iter->key());
+    s = db_->Write(default_write_options_, &batch);
+    if (!s.ok()) {
+      break;
+    }
+    if (reaped) {
+      (*reaped_keys)++;
+      *reclaimed_bytes += bytes;
+    }
+  }
+  if (s.ok()) {
+    s = iter->status();
+  }
+
+  // The range tombstones are written, whatever lies in the ranges is dead
+  for (int cf : {kHashesDataCF, kSetsDataCF, kZsetsDataCF}) {
+    std::vector<Slice> bounds;
+    std::vector<rocksdb::RangePtr> ranges;
+    bounds.reserve(dead_ranges.size() * 2);
+    for (const auto& dead_range : dead_ranges) {
+      if (dead_range.cf == cf) {
+        bounds.emplace_back(dead_range.start);
+        bounds.emplace_back(dead_range.end);
+        ranges.emplace_back(&bounds[bounds.size() - 2], &bounds.back());
+      }
+    }
+    if (!ranges.empty()) {
+      Status ds = rocksdb::DeleteFilesInRanges(db_, handles_[cf], ranges.data(), ranges.size(), false);
+      if (!ds.ok()) {
+        LOG(WARNING) << "delete files of reaped keys failed, " << ds.ToString();
+      }
+    }
+  }
+  return s;
+}
+
 void Redis::ScanDatabase() {
   ScanStrings();
   ScanHashes();
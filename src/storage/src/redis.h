@@ -19,6 +19,7 @@
 #include "src/lru_cache.h"
 #include "src/mutex_impl.h"
 #include "src/type_iterator.h"
+#include "src/zsets_rank_index.h"
 #include "src/custom_comparator.h"
 #include "storage/storage.h"
 #include "storage/storage_define.h"
@@ -39,6 +40,8 @@ class Redis {
   virtual ~Redis();
 
   rocksdb::DB* GetDB() { return db_; }
+  // The table properties of the live SST files of all column families, keyed by file path
+  Status GetPropertiesOfAllTables(rocksdb::TablePropertiesCollection* props);
 
   struct KeyStatistics {
     size_t window_size;
@@ -116,6 +119,16 @@ class Redis {
   Status ScanSetsKeyNum(KeyInfo* key_info);
   Status ScanStreamsKeyNum(KeyInfo* key_info);
 
+  // Slot Commands, only for the slot prefix layout
+  Status ScanSlot(uint32_t slot, int64_t cursor, const std::string& pattern, int64_t count,
+                  std::vector<std::string>* keys, int64_t* next_cursor);
+  Status SlotKeyNum(uint32_t slot, int64_t* num);
+  Status DeleteSlot(uint32_t slot);
+  Status ConvertToSlotKeyPrefix(Redis* target, int slot_num, int64_t* converted);
+
+  // Deletes up to max_keys expired keys in expire time order, see kExpireIndexCF
+  Status ReapExpiredKeys(int64_t max_keys, int64_t* reaped_keys, uint64_t* reclaimed_bytes);
+
   // Keys Commands
   virtual Status StringsExpire(const Slice& key, int64_t ttl, std::string&& prefetch_meta = {});
   virtual Status HashesExpire(const Slice& key, int64_t ttl, std::string&& prefetch_meta = {});
@@ -152,12 +165,17 @@ class Redis {
   Status Append(const Slice& key, const Slice& value, int32_t* ret);
   Status BitCount(const Slice& key, int64_t start_offset, int64_t end_offset, int32_t* ret, bool have_range);
   Status BitOp(BitOpType op, const std::string& dest_key, const std::vector<std::string>& src_keys, std::string &value_to_dest, int64_t* ret);
+  // Folds the bits of key into dest_value, the first source is copied into it
+  Status BitOpApply(const rocksdb::ReadOptions& read_options, BitOpType op, const Slice& key, bool first,
+                    std::string* dest_value);
   Status Decrby(const Slice& key, int64_t value, int64_t* ret);
   Status Get(const Slice& key, std::string* value);
   Status HyperloglogGet(const Slice& key, std::string* value);
   Status MGet(const Slice& key, std::string* value);
+  Status MGet(const std::vector<std::string>& keys, std::vector<ValueStatus>* vss);
   Status GetWithTTL(const Slice& key, std::string* value, int64_t* ttl);
   Status MGetWithTTL(const Slice& key, std::string* value, int64_t* ttl);
+  Status MGetWithTTL(const std::vector<std::string>& keys, std::vector<ValueStatus>* vss);
   Status GetBit(const Slice& key, int64_t offset, int32_t* ret);
   Status Getrange(const Slice& key, int64_t start_offset, int64_t end_offset, std::string* ret);
   Status GetrangeWithValue(const Slice& key, int64_t start_offset, int64_t end_offset,
@@ -184,7 +202,9 @@ class Redis {
   Status PKSetexAt(const Slice& key, const Slice& value, int64_t timestamp);
 
   Status Exists(const Slice& key);
+  Status Exists(const std::vector<std::string>& keys, int64_t* count);
   Status Del(const Slice& key);
+  Status Del(const std::vector<std::string>& keys, int64_t* count);
   Status Expire(const Slice& key, int64_t timestamp);
   Status Expireat(const Slice& key, int64_t timestamp);
   Status Persist(const Slice& key);
@@ -221,9 +241,10 @@ class Redis {
   Status SetMaxCacheStatisticKeys(size_t max_cache_statistic_keys);
   Status SetSmallCompactionThreshold(uint64_t small_compaction_threshold);
   Status SetSmallCompactionDurationThreshold(uint64_t small_compaction_duration_threshold);
+  Status SetZSetsRankIndexThreshold(uint64_t zset_rank_index_threshold);
 
 
-  std::vector<rocksdb::ColumnFamilyHandle*> GetStringCFHandles() { return {handles_[kMetaCF]}; }
+  std::vector<rocksdb::ColumnFamilyHandle*> GetStringCFHandles() { return {handles_[kMetaCF], handles_[kBitmapsDataCF]}; }
 
   std::vector<rocksdb::ColumnFamilyHandle*> GetHashCFHandles() {
     return {handles_.begin() + kMetaCF, handles_.begin() + kHashesDataCF + 1};
@@ -242,7 +263,7 @@ class Redis {
   }
 
   std::vector<rocksdb::ColumnFamilyHandle*> GetStreamCFHandles() {
-    return {handles_.begin() + kMetaCF, handles_.end()};
+    return {handles_.begin() + kMetaCF, handles_.begin() + kStreamsDataCF + 1};
   }
   void GetRocksDBInfo(std::string &info, const char *prefix);
 
@@ -254,6 +275,7 @@ class Redis {
   Status SInter(const std::vector<std::string>& keys, std::vector<std::string>* members);
   Status SInterstore(const Slice& destination, const std::vector<std::string>& keys, std::vector<std::string>& value_to_dest, int32_t* ret);
   Status SIsmember(const Slice& key, const Slice& member, int32_t* ret);
+  Status SMIsmember(const Slice& key, const std::vector<std::string>& members, std::vector<int32_t>* rets);
   Status SMembers(const Slice& key, std::vector<std::string>* members);
   Status SMembersWithTTL(const Slice& key, std::vector<std::string>* members, int64_t* ttl);
   Status SMove(const Slice& source, const Slice& destination, const Slice& member, int32_t* ret);
@@ -290,18 +312,23 @@ class Redis {
   Status ZCard(const Slice& key, int32_t* card, std::string&& prefetch_meta = {});
   Status ZCount(const Slice& key, double min, double max, bool left_close, bool right_close, int32_t* ret);
   Status ZIncrby(const Slice& key, const Slice& member, double increment, double* ret);
-  Status ZRange(const Slice& key, int32_t start, int32_t stop, std::vector<ScoreMember>* score_members);
-  Status ZRangeWithTTL(const Slice& key, int32_t start, int32_t stop, std::vector<ScoreMember>* score_members, int64_t* ttl);
+  // The rank readers build the rank index of a large zset when it has none and
+  // start over once to use it, build_rank_index is false on that second pass
+  Status ZRange(const Slice& key, int32_t start, int32_t stop, std::vector<ScoreMember>* score_members,
+                bool build_rank_index = true);
+  Status ZRangeWithTTL(const Slice& key, int32_t start, int32_t stop, std::vector<ScoreMember>* score_members, int64_t* ttl,
+                       bool build_rank_index = true);
   Status ZRangebyscore(const Slice& key, double min, double max, bool left_close, bool right_close, int64_t count,
-                       int64_t offset, std::vector<ScoreMember>* score_members);
-  Status ZRank(const Slice& key, const Slice& member, int32_t* rank);
+                       int64_t offset, std::vector<ScoreMember>* score_members, bool build_rank_index = true);
+  Status ZRank(const Slice& key, const Slice& member, int32_t* rank, bool build_rank_index = true);
   Status ZRem(const Slice& key, const std::vector<std::string>& members, int32_t* ret);
   Status ZRemrangebyrank(const Slice& key, int32_t start, int32_t stop, int32_t* ret);
   Status ZRemrangebyscore(const Slice& key, double min, double max, bool left_close, bool right_close, int32_t* ret);
-  Status ZRevrange(const Slice& key, int32_t start, int32_t stop, std::vector<ScoreMember>* score_members);
+  Status ZRevrange(const Slice& key, int32_t start, int32_t stop, std::vector<ScoreMember>* score_members,
+                   bool build_rank_index = true);
   Status ZRevrangebyscore(const Slice& key, double min, double max, bool left_close, bool right_close, int64_t count,
                           int64_t offset, std::vector<ScoreMember>* score_members);
-  Status ZRevrank(const Slice& key, const Slice& member, int32_t* rank);
+  Status ZRevrank(const Slice& key, const Slice& member, int32_t* rank, bool build_rank_index = true);
   Status ZScore(const Slice& key, const Slice& member, double* score);
   Status ZGetAll(const Slice& key, double weight, std::map<std::string, double>* value_to_dest);
   Status ZUnionstore(const Slice& destination, const std::vector<std::string>& keys, const std::vector<double>& weights,
@@ -366,7 +393,8 @@ class Redis {
     options.iterate_upper_bound = upper_bound;
     switch (type) {
       case 'k':
-        return new StringsIterator(options, db_, handles_[kMetaCF], pattern);
+        return new StringsIterator(options, db_, handles_[kMetaCF], handles_[kBitmapsDataCF], pattern,
+                                   slot_key_prefix_num_);
         break;
       case 'h':
         return new HashesIterator(options, db_, handles_[kMetaCF], pattern);
@@ -433,6 +461,44 @@ class Redis {
   }
 
 private:
+  // Batched point lookups, one MultiGet for all keys of a column family
+  void MultiGet(const rocksdb::ReadOptions& read_options, rocksdb::ColumnFamilyHandle* handle,
+                const std::vector<std::string>& encoded_keys, std::vector<std::string>* values,
+                std::vector<Status>* statuses);
+  void MultiGetMeta(const rocksdb::ReadOptions& read_options, const std::vector<std::string>& keys,
+                    std::vector<std::string>* values, std::vector<Status>* statuses);
+  Status SetsMembersExist(const rocksdb::ReadOptions& read_options, const Slice& key, uint64_t version,
+                          const std::vector<std::string>& members, std::vector<int32_t>* rets);
+  Status ExistsWithMeta(const Slice& key, std::string&& meta_value);
+  Status DelWithMeta(const Slice& key, std::string&& meta_value);
+  // The etime of a meta or string value, 0 for the types that do not expire
+  uint64_t MetaValueEtime(const std::string& meta_value);
+  // Puts a meta or string value and, when it expires, its entry in the expire
+  // index, old_etime is the etime of the value it replaces, whose entry goes
+  Status PutWithExpireIndex(const Slice& key, const Slice& meta_key, const Slice& meta_value, uint64_t etime,
+                            uint64_t old_etime);
+  // The data rows of a reaped collection, see ReapExpiredKeys
+  struct DeadDataRange {
+    int cf;
+    std::string start;
+    std::string end;
+  };
+  // Collections with up to this many rows are reaped with point deletes
+  static constexpr int32_t kReapPointDeleteLimit = 256;
+  Status ReapExpiredKey(const Slice& key, uint64_t etime, int64_t now, rocksdb::WriteBatch* batch,
+                        uint64_t* reclaimed_bytes, std::vector<DeadDataRange>* dead_ranges);
+  // Moves a list kept one row per element into chunks, see lists_chunks.h
+  Status ListsUpgradeEncoding(const Slice& key, std::string* meta_value);
+  // Bitmaps, see bitmap_segments.h
+  Status BitmapSetBit(const Slice& key, ParsedStringsValue* parsed_strings_value, int64_t offset, int32_t on,
+                      int32_t* ret);
+  // The first bit equal to bit among bytes bytes from start_offset, like GetBitPos
+  Status BitmapBitPos(const rocksdb::ReadOptions& read_options, const Slice& key, uint64_t version,
+                      int64_t start_offset, int64_t bytes, int32_t bit, int64_t* pos);
+  // Makes the string value read for key hold all the bytes when it is a bitmap,
+  // the bitmap is read again from a snapshot along with its segments
+  Status ExpandBitmap(const Slice& key, std::string* value);
+
   Status GenerateStreamID(const StreamMetaValue& stream_meta, StreamAddTrimArgs& args);
 
   Status StreamScanRange(const Slice& key, const uint64_t version, const Slice& id_start, const std::string& id_end,
@@ -468,6 +534,8 @@ private:
 private:
   int32_t index_ = 0;
   Storage* const storage_;
+  // Storage::SlotKeyPrefixNum(), passed to every key this instance encodes
+  int slot_key_prefix_num_ = 0;
   std::shared_ptr<LockMgr> lock_mgr_;
   rocksdb::DB* db_ = nullptr;
   //TODO(wangshaoyi): seperate env for each rocksdb instance
@@ -493,6 +561,28 @@ private:
   Status UpdateSpecificKeyStatistics(const DataType& dtype, const std::string& key, uint64_t count);
   Status UpdateSpecificKeyDuration(const DataType& dtype, const std::string& key, uint64_t duration);
   Status AddCompactKeyTaskIfNeeded(const DataType& dtype, const std::string& key, uint64_t count, uint64_t duration);
+
+  // For ZSets rank index
+  std::atomic_uint64_t zset_rank_index_threshold_;
+  std::unique_ptr<LRUCache<std::string, std::shared_ptr<ZSetsRankIndex>>> zset_rank_index_store_;
+
+  std::shared_ptr<ZSetsRankIndex> LookupZSetsRankIndex(const Slice& key);
+  // Return false and drop the index if it does not match the zset
+  bool CheckZSetsRankIndex(const std::shared_ptr<ZSetsRankIndex>& index, const Slice& key, uint64_t version,
+                           int32_t count);
+  // Return true if the zset has a rank index after the call
+  bool BuildZSetsRankIndex(const Slice& key, int32_t count);
+  // Write the batch and apply the changed score keys to the index, if any
+  Status WriteZSetsBatch(const Slice& key, const std::shared_ptr<ZSetsRankIndex>& index, rocksdb::WriteBatch* batch,
+                         const std::vector<std::string>& erased, const std::vector<std::string>& inserted);
+  // Position iter at the first score key not less than score_key, return its rank
+  int64_t SeekZSetsScoreKey(ZSetsRankIndex* index, rocksdb::Iterator* iter, const Slice& key, uint64_t version,
+                            const Slice& score_key);
+  // Position iter at the rank-th score key, return the rank reached
+  int64_t SeekZSetsRank(ZSetsRankIndex* index, rocksdb::Iterator* iter, const Slice& key, uint64_t version,
+                        int64_t rank);
+  Status ZRankByIndex(ZSetsRankIndex* index, const rocksdb::ReadOptions& read_options, const Slice& key,
+                      uint64_t version, const Slice& member, int32_t* rank);
 };
 
 }  //  namespace storage
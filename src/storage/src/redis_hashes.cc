@@ -82,7 +82,7 @@ Status Redis::HDel(const Slice& key, const std::vector<std::string>& fields, int
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kHashes, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -103,7 +103,7 @@ Status Redis::HDel(const Slice& key, const std::vector<std::string>& fields, int
       std::string data_value;
       version = parsed_hashes_meta_value.Version();
       for (const auto& field : filtered_fields) {
-        HashesDataKey hashes_data_key(key, version, field);
+        HashesDataKey hashes_data_key(key, version, field, slot_key_prefix_num_);
         s = db_->Get(read_options, handles_[kHashesDataCF], hashes_data_key.Encode(), &data_value);
         if (s.ok()) {
           del_cnt++;
@@ -146,7 +146,7 @@ Status Redis::HGet(const Slice& key, const Slice& field, std::string* value) {
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kHashes, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -166,7 +166,7 @@ Status Redis::HGet(const Slice& key, const Slice& field, std::string* value) {
       return Status::NotFound();
     } else {
       version = parsed_hashes_meta_value.Version();
-      HashesDataKey data_key(key, version, field);
+      HashesDataKey data_key(key, version, field, slot_key_prefix_num_);
       s = db_->Get(read_options, handles_[kHashesDataCF], data_key.Encode(), value);
       if (s.ok()) {
         ParsedBaseDataValue parsed_internal_value(value);
@@ -186,7 +186,7 @@ Status Redis::HGetall(const Slice& key, std::vector<FieldValue>* fvs) {
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kHashes, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -206,7 +206,7 @@ Status Redis::HGetall(const Slice& key, std::vector<FieldValue>* fvs) {
       return Status::NotFound();
     } else {
       version = parsed_hashes_meta_value.Version();
-      HashesDataKey hashes_data_key(key, version, "");
+      HashesDataKey hashes_data_key(key, version, "", slot_key_prefix_num_);
       Slice prefix = hashes_data_key.EncodeSeekKey();
       KeyStatisticsDurationGuard guard(this, DataType::kHashes, key.ToString());
       auto iter = db_->NewIterator(read_options, handles_[kHashesDataCF]);
@@ -229,7 +229,7 @@ Status Redis::HGetallWithTTL(const Slice& key, std::vector<FieldValue>* fvs, int
   uint64_t version = 0;
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kHashes, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -259,7 +259,7 @@ Status Redis::HGetallWithTTL(const Slice& key, std::vector<FieldValue>* fvs, int
       }
 
       version = parsed_hashes_meta_value.Version();
-      HashesDataKey hashes_data_key(key, version, "");
+      HashesDataKey hashes_data_key(key, version, "", slot_key_prefix_num_);
       Slice prefix = hashes_data_key.EncodeSeekKey();
       KeyStatisticsDurationGuard guard(this, DataType::kHashes, key.ToString());
       auto iter = db_->NewIterator(read_options, handles_[kHashesDataCF]);
@@ -285,7 +285,7 @@ Status Redis::HIncrby(const Slice& key, const Slice& field, int64_t value, int64
   std::string meta_value;
 
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   char value_buf[32] = {0};
   char meta_value_buf[4] = {0};
@@ -306,13 +306,13 @@ Status Redis::HIncrby(const Slice& key, const Slice& field, int64_t value, int64
       parsed_hashes_meta_value.SetCount(1);
       parsed_hashes_meta_value.SetEtime(0);
       batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
-      HashesDataKey hashes_data_key(key, version, field);
+      HashesDataKey hashes_data_key(key, version, field, slot_key_prefix_num_);
       Int64ToStr(value_buf, 32, value);
       batch.Put(handles_[kHashesDataCF], hashes_data_key.Encode(), value_buf);
       *ret = value;
     } else {
       version = parsed_hashes_meta_value.Version();
-      HashesDataKey hashes_data_key(key, version, field);
+      HashesDataKey hashes_data_key(key, version, field, slot_key_prefix_num_);
       s = db_->Get(default_read_options_, handles_[kHashesDataCF], hashes_data_key.Encode(), &old_value);
       if (s.ok()) {
         ParsedBaseDataValue parsed_internal_value(&old_value);
@@ -348,7 +348,7 @@ Status Redis::HIncrby(const Slice& key, const Slice& field, int64_t value, int64
     HashesMetaValue hashes_meta_value(DataType::kHashes, Slice(meta_value_buf, 4));
     version = hashes_meta_value.UpdateVersion();
     batch.Put(handles_[kMetaCF], base_meta_key.Encode(), hashes_meta_value.Encode());
-    HashesDataKey hashes_data_key(key, version, field);
+    HashesDataKey hashes_data_key(key, version, field, slot_key_prefix_num_);
 
     Int64ToStr(value_buf, 32, value);
     BaseDataValue internal_value(value_buf);
@@ -378,7 +378,7 @@ Status Redis::HIncrbyfloat(const Slice& key, const Slice& field, const Slice& by
   }
 
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   char meta_value_buf[4] = {0};
   if (s.ok() && !ExpectedMetaValue(DataType::kHashes, meta_value)) {
@@ -398,14 +398,14 @@ Status Redis::HIncrbyfloat(const Slice& key, const Slice& field, const Slice& by
       parsed_hashes_meta_value.SetCount(1);
       parsed_hashes_meta_value.SetEtime(0);
       batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
-      HashesDataKey hashes_data_key(key, version, field);
+      HashesDataKey hashes_data_key(key, version, field, slot_key_prefix_num_);
 
       LongDoubleToStr(long_double_by, new_value);
       BaseDataValue inter_value(*new_value);
       batch.Put(handles_[kHashesDataCF], hashes_data_key.Encode(), inter_value.Encode());
     } else {
       version = parsed_hashes_meta_value.Version();
-      HashesDataKey hashes_data_key(key, version, field);
+      HashesDataKey hashes_data_key(key, version, field, slot_key_prefix_num_);
       s = db_->Get(default_read_options_, handles_[kHashesDataCF], hashes_data_key.Encode(), &old_value_str);
       if (s.ok()) {
         long double total;
@@ -442,7 +442,7 @@ Status Redis::HIncrbyfloat(const Slice& key, const Slice& field, const Slice& by
     version = hashes_meta_value.UpdateVersion();
     batch.Put(handles_[kMetaCF], base_meta_key.Encode(), hashes_meta_value.Encode());
 
-    HashesDataKey hashes_data_key(key, version, field);
+    HashesDataKey hashes_data_key(key, version, field, slot_key_prefix_num_);
     LongDoubleToStr(long_double_by, new_value);
     BaseDataValue internal_value(*new_value);
     batch.Put(handles_[kHashesDataCF], hashes_data_key.Encode(), internal_value.Encode());
@@ -463,7 +463,7 @@ Status Redis::HKeys(const Slice& key, std::vector<std::string>* fields) {
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kHashes, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -483,7 +483,7 @@ Status Redis::HKeys(const Slice& key, std::vector<std::string>* fields) {
       return Status::NotFound();
     } else {
       version = parsed_hashes_meta_value.Version();
-      HashesDataKey hashes_data_key(key, version, "");
+      HashesDataKey hashes_data_key(key, version, "", slot_key_prefix_num_);
       Slice prefix = hashes_data_key.EncodeSeekKey();
       KeyStatisticsDurationGuard guard(this, DataType::kHashes, key.ToString());
       auto iter = db_->NewIterator(read_options, handles_[kHashesDataCF]);
@@ -505,7 +505,7 @@ Status Redis::HLen(const Slice& key, int32_t* ret, std::string&& prefetch_meta)
   // meta_value is empty means no meta value get before,
   // we should get meta first
   if (meta_value.empty()) {
-    BaseMetaKey base_meta_key(key);
+    BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
     s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
     if (s.ok() && !ExpectedMetaValue(DataType::kHashes, meta_value)) {
       if (ExpectedStale(meta_value)) {
@@ -539,13 +539,12 @@ Status Redis::HMGet(const Slice& key, const std::vector<std::string>& fields, st
 
   uint64_t version = 0;
   bool is_stale = false;
-  std::string value;
   std::string meta_value;
   rocksdb::ReadOptions read_options;
   const rocksdb::Snapshot* snapshot;
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kHashes, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -566,13 +565,21 @@ Status Redis::HMGet(const Slice& key, const std::vector<std::string>& fields, st
       return Status::NotFound(is_stale ? "Stale" : "");
     } else {
       version = parsed_hashes_meta_value.Version();
+      std::vector<std::string> data_keys;
+      data_keys.reserve(fields.size());
       for (const auto& field : fields) {
-        HashesDataKey hashes_data_key(key, version, field);
-        s = db_->Get(read_options, handles_[kHashesDataCF], hashes_data_key.Encode(), &value);
+        HashesDataKey hashes_data_key(key, version, field, slot_key_prefix_num_);
+        data_keys.push_back(hashes_data_key.Encode().ToString());
+      }
+      std::vector<std::string> values;
+      std::vector<Status> statuses;
+      MultiGet(read_options, handles_[kHashesDataCF], data_keys, &values, &statuses);
+      for (size_t idx = 0; idx < fields.size(); ++idx) {
+        s = statuses[idx];
         if (s.ok()) {
-          ParsedBaseDataValue parsed_internal_value(&value);
+          ParsedBaseDataValue parsed_internal_value(&values[idx]);
           parsed_internal_value.StripSuffix();
-          vss->push_back({value, Status::OK()});
+          vss->push_back({std::move(values[idx]), Status::OK()});
         } else if (s.IsNotFound()) {
           vss->push_back({std::string(), Status::NotFound()});
         } else {
@@ -608,7 +615,7 @@ Status Redis::HMSet(const Slice& key, const std::vector<FieldValue>& fvs) {
   uint64_t version = 0;
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   char meta_value_buf[4] = {0};
   if (s.ok() && !ExpectedMetaValue(DataType::kHashes, meta_value)) {
@@ -631,7 +638,7 @@ Status Redis::HMSet(const Slice& key, const std::vector<FieldValue>& fvs) {
       parsed_hashes_meta_value.SetCount(static_cast<int32_t>(filtered_fvs.size()));
       batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
       for (const auto& fv : filtered_fvs) {
-        HashesDataKey hashes_data_key(key, version, fv.field);
+        HashesDataKey hashes_data_key(key, version, fv.field, slot_key_prefix_num_);
         BaseDataValue inter_value(fv.value);
         batch.Put(handles_[kHashesDataCF], hashes_data_key.Encode(), inter_value.Encode());
       }
@@ -640,7 +647,7 @@ Status Redis::HMSet(const Slice& key, const std::vector<FieldValue>& fvs) {
       std::string data_value;
       version = parsed_hashes_meta_value.Version();
       for (const auto& fv : filtered_fvs) {
-        HashesDataKey hashes_data_key(key, version, fv.field);
+        HashesDataKey hashes_data_key(key, version, fv.field, slot_key_prefix_num_);
         BaseDataValue inter_value(fv.value);
         s = db_->Get(default_read_options_, handles_[kHashesDataCF], hashes_data_key.Encode(), &data_value);
         if (s.ok()) {
@@ -665,7 +672,7 @@ Status Redis::HMSet(const Slice& key, const std::vector<FieldValue>& fvs) {
     version = hashes_meta_value.UpdateVersion();
     batch.Put(handles_[kMetaCF], base_meta_key.Encode(), hashes_meta_value.Encode());
     for (const auto& fv : filtered_fvs) {
-      HashesDataKey hashes_data_key(key, version, fv.field);
+      HashesDataKey hashes_data_key(key, version, fv.field, slot_key_prefix_num_);
       BaseDataValue inter_value(fv.value);
       batch.Put(handles_[kHashesDataCF], hashes_data_key.Encode(), inter_value.Encode());
     }
@@ -683,7 +690,7 @@ Status Redis::HSet(const Slice& key, const Slice& field, const Slice& value, int
   uint32_t statistic = 0;
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   char meta_value_buf[4] = {0};
   if (s.ok() && !ExpectedMetaValue(DataType::kHashes, meta_value)) {
@@ -702,14 +709,14 @@ Status Redis::HSet(const Slice& key, const Slice& field, const Slice& value, int
       version = parsed_hashes_meta_value.InitialMetaValue();
       parsed_hashes_meta_value.SetCount(1);
       batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
-      HashesDataKey data_key(key, version, field);
+      HashesDataKey data_key(key, version, field, slot_key_prefix_num_);
       BaseDataValue internal_value(value);
       batch.Put(handles_[kHashesDataCF], data_key.Encode(), internal_value.Encode());
       *res = 1;
     } else {
       version = parsed_hashes_meta_value.Version();
       std::string data_value;
-      HashesDataKey hashes_data_key(key, version, field);
+      HashesDataKey hashes_data_key(key, version, field, slot_key_prefix_num_);
       s = db_->Get(default_read_options_, handles_[kHashesDataCF], hashes_data_key.Encode(), &data_value);
       if (s.ok()) {
         *res = 0;
@@ -738,7 +745,7 @@ Status Redis::HSet(const Slice& key, const Slice& field, const Slice& value, int
     HashesMetaValue hashes_meta_value(DataType::kHashes, Slice(meta_value_buf, 4));
     version = hashes_meta_value.UpdateVersion();
     batch.Put(handles_[kMetaCF], base_meta_key.Encode(), hashes_meta_value.Encode());
-    HashesDataKey data_key(key, version, field);
+    HashesDataKey data_key(key, version, field, slot_key_prefix_num_);
     BaseDataValue internal_value(value);
     batch.Put(handles_[kHashesDataCF], data_key.Encode(), internal_value.Encode());
     *res = 1;
@@ -757,7 +764,7 @@ Status Redis::HSetnx(const Slice& key, const Slice& field, const Slice& value, i
   uint64_t version = 0;
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   BaseDataValue internal_value(value);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   char meta_value_buf[4] = {0};
@@ -777,12 +784,12 @@ Status Redis::HSetnx(const Slice& key, const Slice& field, const Slice& value, i
       version = parsed_hashes_meta_value.InitialMetaValue();
       parsed_hashes_meta_value.SetCount(1);
       batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
-      HashesDataKey hashes_data_key(key, version, field);
+      HashesDataKey hashes_data_key(key, version, field, slot_key_prefix_num_);
       batch.Put(handles_[kHashesDataCF], hashes_data_key.Encode(), internal_value.Encode());
       *ret = 1;
     } else {
       version = parsed_hashes_meta_value.Version();
-      HashesDataKey hashes_data_key(key, version, field);
+      HashesDataKey hashes_data_key(key, version, field, slot_key_prefix_num_);
       std::string data_value;
       s = db_->Get(default_read_options_, handles_[kHashesDataCF], hashes_data_key.Encode(), &data_value);
       if (s.ok()) {
@@ -804,7 +811,7 @@ Status Redis::HSetnx(const Slice& key, const Slice& field, const Slice& value, i
     HashesMetaValue hashes_meta_value(DataType::kHashes, Slice(meta_value_buf, 4));
     version = hashes_meta_value.UpdateVersion();
     batch.Put(handles_[kMetaCF], base_meta_key.Encode(), hashes_meta_value.Encode());
-    HashesDataKey hashes_data_key(key, version, field);
+    HashesDataKey hashes_data_key(key, version, field, slot_key_prefix_num_);
     batch.Put(handles_[kHashesDataCF], hashes_data_key.Encode(), internal_value.Encode());
     *ret = 1;
   } else {
@@ -822,7 +829,7 @@ Status Redis::HVals(const Slice& key, std::vector<std::string>* values) {
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kHashes, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -842,7 +849,7 @@ Status Redis::HVals(const Slice& key, std::vector<std::string>* values) {
       return Status::NotFound();
     } else {
       version = parsed_hashes_meta_value.Version();
-      HashesDataKey hashes_data_key(key, version, "");
+      HashesDataKey hashes_data_key(key, version, "", slot_key_prefix_num_);
       Slice prefix = hashes_data_key.EncodeSeekKey();
       KeyStatisticsDurationGuard guard(this, DataType::kHashes, key.ToString());
       auto iter = db_->NewIterator(read_options, handles_[kHashesDataCF]);
@@ -885,7 +892,7 @@ Status Redis::HScan(const Slice& key, int64_t cursor, const std::string& pattern
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kHashes, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -917,8 +924,8 @@ Status Redis::HScan(const Slice& key, int64_t cursor, const std::string& pattern
         sub_field = pattern.substr(0, pattern.size() - 1);
       }
 
-      HashesDataKey hashes_data_prefix(key, version, sub_field);
-      HashesDataKey hashes_start_data_key(key, version, start_point);
+      HashesDataKey hashes_data_prefix(key, version, sub_field, slot_key_prefix_num_);
+      HashesDataKey hashes_start_data_key(key, version, start_point, slot_key_prefix_num_);
       std::string prefix = hashes_data_prefix.EncodeSeekKey().ToString();
       KeyStatisticsDurationGuard guard(this, DataType::kHashes, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kHashesDataCF]);
@@ -962,7 +969,7 @@ Status Redis::HScanx(const Slice& key, const std::string& start_field, const std
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kHashes, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -981,8 +988,8 @@ Status Redis::HScanx(const Slice& key, const std::string& start_field, const std
       return Status::NotFound();
     } else {
       uint64_t version = parsed_hashes_meta_value.Version();
-      HashesDataKey hashes_data_prefix(key, version, Slice());
-      HashesDataKey hashes_start_data_key(key, version, start_field);
+      HashesDataKey hashes_data_prefix(key, version, Slice(), slot_key_prefix_num_);
+      HashesDataKey hashes_start_data_key(key, version, start_field, slot_key_prefix_num_);
       std::string prefix = hashes_data_prefix.EncodeSeekKey().ToString();
       KeyStatisticsDurationGuard guard(this, DataType::kHashes, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kHashesDataCF]);
@@ -1032,7 +1039,7 @@ Status Redis::PKHScanRange(const Slice& key, const Slice& field_start, const std
     return Status::InvalidArgument("error in given range");
   }
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kHashes, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1050,8 +1057,8 @@ Status Redis::PKHScanRange(const Slice& key, const Slice& field_start, const std
       return Status::NotFound();
     } else {
       uint64_t version = parsed_hashes_meta_value.Version();
-      HashesDataKey hashes_data_prefix(key, version, Slice());
-      HashesDataKey hashes_start_data_key(key, version, field_start);
+      HashesDataKey hashes_data_prefix(key, version, Slice(), slot_key_prefix_num_);
+      HashesDataKey hashes_start_data_key(key, version, field_start, slot_key_prefix_num_);
       std::string prefix = hashes_data_prefix.EncodeSeekKey().ToString();
       KeyStatisticsDurationGuard guard(this, DataType::kHashes, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kHashesDataCF]);
@@ -1103,7 +1110,7 @@ Status Redis::PKHRScanRange(const Slice& key, const Slice& field_start, const st
     return Status::InvalidArgument("error in given range");
   }
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kHashes, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1123,8 +1130,8 @@ Status Redis::PKHRScanRange(const Slice& key, const Slice& field_start, const st
       uint64_t version = parsed_hashes_meta_value.Version();
       int32_t start_key_version = start_no_limit ? version + 1 : version;
       std::string start_key_field = start_no_limit ? "" : field_start.ToString();
-      HashesDataKey hashes_data_prefix(key, version, Slice());
-      HashesDataKey hashes_start_data_key(key, start_key_version, start_key_field);
+      HashesDataKey hashes_data_prefix(key, version, Slice(), slot_key_prefix_num_);
+      HashesDataKey hashes_start_data_key(key, start_key_version, start_key_field, slot_key_prefix_num_);
       std::string prefix = hashes_data_prefix.EncodeSeekKey().ToString();
       KeyStatisticsDurationGuard guard(this, DataType::kHashes, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kHashesDataCF]);
@@ -1159,7 +1166,7 @@ Status Redis::PKHRScanRange(const Slice& key, const Slice& field_start, const st
 Status Redis::HashesExpire(const Slice& key, int64_t ttl, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s;
 
   // meta_value is empty means no meta value get before,
@@ -1186,8 +1193,9 @@ Status Redis::HashesExpire(const Slice& key, int64_t ttl, std::string&& prefetch
     }
 
     if (ttl > 0) {
+      uint64_t old_etime = parsed_hashes_meta_value.Etime();
       parsed_hashes_meta_value.SetRelativeTimestamp(ttl);
-      s = db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      s = PutWithExpireIndex(key, base_meta_key.Encode(), meta_value, parsed_hashes_meta_value.Etime(), old_etime);
     } else {
       parsed_hashes_meta_value.InitialMetaValue();
       s = db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
@@ -1199,7 +1207,7 @@ Status Redis::HashesExpire(const Slice& key, int64_t ttl, std::string&& prefetch
 Status Redis::HashesDel(const Slice& key, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s;
 
   // meta_value is empty means no meta value get before,
@@ -1236,7 +1244,7 @@ Status Redis::HashesDel(const Slice& key, std::string&& prefetch_meta) {
 Status Redis::HashesExpireat(const Slice& key, int64_t timestamp, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s;
 
   // meta_value is empty means no meta value get before,
@@ -1261,12 +1269,13 @@ Status Redis::HashesExpireat(const Slice& key, int64_t timestamp, std::string&&
     } else if (parsed_hashes_meta_value.Count() == 0) {
       return Status::NotFound();
     } else {
+      uint64_t old_etime = parsed_hashes_meta_value.Etime();
       if (timestamp > 0) {
         parsed_hashes_meta_value.SetEtime(static_cast<uint64_t>(timestamp));
       } else {
         parsed_hashes_meta_value.InitialMetaValue();
       }
-      s = db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      s = PutWithExpireIndex(key, base_meta_key.Encode(), meta_value, parsed_hashes_meta_value.Etime(), old_etime);
     }
   }
   return s;
@@ -1275,7 +1284,7 @@ Status Redis::HashesExpireat(const Slice& key, int64_t timestamp, std::string&&
 Status Redis::HashesPersist(const Slice& key, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s;
 
   // meta_value is empty means no meta value get before,
@@ -1305,7 +1314,7 @@ Status Redis::HashesPersist(const Slice& key, std::string&& prefetch_meta) {
         return Status::NotFound("Not have an associated timeout");
       } else {
         parsed_hashes_meta_value.SetEtime(0);
-        s = db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+        s = PutWithExpireIndex(key, base_meta_key.Encode(), meta_value, 0, timestamp);
       }
     }
   }
@@ -1315,7 +1324,7 @@ Status Redis::HashesPersist(const Slice& key, std::string&& prefetch_meta) {
 Status Redis::HashesTTL(const Slice& key, int64_t* timestamp, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
   Status s;
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
 
   // meta_value is empty means no meta value get before,
   // we should get meta first
@@ -8,6 +8,9 @@
 #include <cmath>
 #include <string>
 #include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "src/storage_murmur3.h"
 #include "storage/storage_define.h"
@@ -20,35 +23,171 @@ namespace storage {
 
 const int32_t HLL_HASH_SEED = 313;
 
-HyperLogLog::HyperLogLog(uint8_t precision, std::string origin_register) {
+HyperLogLog::HyperLogLog(uint8_t precision, const std::string& origin_register) {
   b_ = precision;
   m_ = 1 << precision;
   alpha_ = Alpha();
-  register_ = std::make_unique<char[]>(m_);
-  for (uint32_t i = 0; i < m_; ++i) {
-    register_[i] = 0;
-  }
-  if (!origin_register.empty()) {
-    for (uint32_t i = 0; i < m_; ++i) {
-      register_[i] = origin_register[i];
+  register_ = std::make_unique<uint8_t[]>(m_);
+  memset(register_.get(), 0, m_);
+  if (origin_register.size() >= kHllHeaderSize && memcmp(origin_register.data(), kHllMagic, 4) == 0) {
+    const char* data = origin_register.data() + kHllHeaderSize;
+    size_t len = origin_register.size() - kHllHeaderSize;
+    if (origin_register[4] == kHllSparse) {
+      DecodeSparse(data, len);
+    } else {
+      DecodeDense(data, len);
     }
+  } else if (!origin_register.empty()) {
+    // legacy layout, one byte per register
+    memcpy(register_.get(), origin_register.data(), std::min<size_t>(m_, origin_register.size()));
   }
 }
 
 HyperLogLog::~HyperLogLog() = default;
 
-std::string HyperLogLog::Add(const char* value, uint32_t len) {
+void HyperLogLog::DecodeDense(const char* data, size_t len) {
+  const auto* p = reinterpret_cast<const uint8_t*>(data);
+  // Every 3 bytes hold 4 registers
+  for (uint32_t i = 0; i < m_ && (i / 4) * 3 + 3 <= len; i += 4) {
+    const uint8_t* group = p + (i / 4) * 3;
+    uint32_t bits = group[0] | (group[1] << 8) | (group[2] << 16);
+    register_[i] = bits & 0x3f;
+    register_[i + 1] = (bits >> 6) & 0x3f;
+    register_[i + 2] = (bits >> 12) & 0x3f;
+    register_[i + 3] = (bits >> 18) & 0x3f;
+  }
+}
+
+std::string HyperLogLog::EncodeDense() const {
+  std::string result(kHllHeaderSize + m_ / 4 * 3, 0);
+  memcpy(result.data(), kHllMagic, 4);
+  result[4] = static_cast<char>(kHllDense);
+  auto* p = reinterpret_cast<uint8_t*>(result.data() + kHllHeaderSize);
+  for (uint32_t i = 0; i < m_; i += 4) {
+    uint32_t bits = register_[i] | (register_[i + 1] << 6) | (register_[i + 2] << 12) | (register_[i + 3] << 18);
+    *p++ = bits & 0xff;
+    *p++ = (bits >> 8) & 0xff;
+    *p++ = (bits >> 16) & 0xff;
+  }
+  return result;
+}
+
+void HyperLogLog::DecodeSparse(const char* data, size_t len) {
+  const auto* p = reinterpret_cast<const uint8_t*>(data);
+  const uint8_t* end = p + len;
+  uint32_t index = 0;
+  while (p < end && index < m_) {
+    uint32_t run = 0;
+    if ((*p & 0xc0) == 0) {
+      // ZERO
+      run = (*p & 0x3f) + 1;
+      p++;
+    } else if ((*p & 0xc0) == 0x40) {
+      // XZERO
+      if (p + 1 >= end) {
+        break;
+      }
+      run = (((*p & 0x3f) << 8) | p[1]) + 1;
+      p += 2;
+    } else {
+      // VAL
+      uint8_t value = ((*p >> 2) & 0x1f) + 1;
+      run = (*p & 0x3) + 1;
+      p++;
+      for (uint32_t i = 0; i < run && index + i < m_; i++) {
+        register_[index + i] = value;
+      }
+    }
+    index += run;
+  }
+}
+
+bool HyperLogLog::EncodeSparse(std::string* result) const {
+  std::string opcodes;
+  uint32_t index = 0;
+  while (index < m_) {
+    uint32_t run = 1;
+    uint8_t value = register_[index];
+    while (index + run < m_ && register_[index + run] == value) {
+      run++;
+    }
+    index += run;
+    if (value == 0) {
+      while (run > 0) {
+        uint32_t len = std::min<uint32_t>(run, 16384);
+        if (len <= 64) {
+          opcodes.push_back(static_cast<char>(len - 1));
+        } else {
+          opcodes.push_back(static_cast<char>(0x40 | ((len - 1) >> 8)));
+          opcodes.push_back(static_cast<char>((len - 1) & 0xff));
+        }
+        run -= len;
+      }
+    } else {
+      if (value > kHllSparseValMax) {
+        return false;
+      }
+      while (run > 0) {
+        uint32_t len = std::min<uint32_t>(run, 4);
+        opcodes.push_back(static_cast<char>(0x80 | ((value - 1) << 2) | (len - 1)));
+        run -= len;
+      }
+    }
+    if (opcodes.size() > kHllSparseMaxBytes) {
+      return false;
+    }
+  }
+  if (result) {
+    result->assign(kHllHeaderSize, 0);
+    memcpy(result->data(), kHllMagic, 4);
+    (*result)[4] = static_cast<char>(kHllSparse);
+    result->append(opcodes);
+  }
+  return true;
+}
+
+std::string HyperLogLog::Encode() const {
+  std::string result;
+  if (!EncodeSparse(&result)) {
+    result = EncodeDense();
+  }
+  return result;
+}
+
+bool HyperLogLog::Add(const char* value, uint32_t len) {
   uint32_t hash_value;
   MurmurHash3_x86_32(value, static_cast<int32_t>(len), HLL_HASH_SEED, static_cast<void*>(&hash_value));
   uint32_t index = hash_value & ((1 << b_) - 1);
   uint8_t rank = Nctz((hash_value >> b_), static_cast<int32_t>(32 - b_));
-  if (rank > register_[index]) { register_[index] = static_cast<char>(rank);
+  if (rank > register_[index]) {
+    register_[index] = rank;
+    return true;
+  }
+  return false;
 }
-  std::string result(m_, 0);
-  for (uint32_t i = 0; i < m_; ++i) {
-    result[i] = register_[i];
+
+/*
+ * The kernels below scan 16 registers at a time, an all-zero block is
+ * detected with a single compare, which is the common case for small sets.
+ */
+void HyperLogLog::RegisterHistogram(uint32_t* histogram) const {
+  uint32_t i = 0;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= m_; i += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(register_.get() + i));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(block, zero)) == 0xffff) {
+      histogram[0] += 16;
+      continue;
+    }
+    for (uint32_t j = i; j < i + 16; j++) {
+      histogram[register_[j] & 0x3f]++;
+    }
+  }
+#endif
+  for (; i < m_; i++) {
+    histogram[register_[i] & 0x3f]++;
   }
-  return result;
 }
 
 double HyperLogLog::Estimate() const {
@@ -65,14 +204,13 @@ double HyperLogLog::Estimate() const {
 }
 
 double HyperLogLog::FirstEstimate() const {
-  double estimate;
+  uint32_t histogram[64] = {0};
+  RegisterHistogram(histogram);
   double sum = 0.0;
-  for (uint32_t i = 0; i < m_; i++) {
-    sum += 1.0 / (1 << register_[i]);
+  for (int r = 63; r >= 0; r--) {
+    sum += histogram[r] * ldexp(1.0, -r);
   }
-
-  estimate = alpha_ * m_ * m_ / sum;
-  return estimate;
+  return alpha_ * m_ * m_ / sum;
 }
 
 double HyperLogLog::Alpha() const {
@@ -90,7 +228,15 @@ double HyperLogLog::Alpha() const {
 
 uint32_t HyperLogLog::CountZero() const {
   uint32_t count = 0;
-  for (uint32_t i = 0; i < m_; i++) {
+  uint32_t i = 0;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= m_; i += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(register_.get() + i));
+    count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(block, zero)));
+  }
+#endif
+  for (; i < m_; i++) {
     if (register_[i] == 0) {
       count++;
     }
@@ -98,21 +244,22 @@ uint32_t HyperLogLog::CountZero() const {
   return count;
 }
 
-std::string HyperLogLog::Merge(const HyperLogLog& hll) {
+void HyperLogLog::Merge(const HyperLogLog& hll) {
   if (m_ != hll.m_) {
     // TODO(shq) the number of registers doesn't match
+    return;
   }
-  for (uint32_t r = 0; r < m_; r++) {
-    if (register_[r] < hll.register_[r]) {
-      register_[r] = static_cast<char>(register_[r] | hll.register_[r]);
-    }
+  uint32_t r = 0;
+#if defined(__SSE2__)
+  for (; r + 16 <= m_; r += 16) {
+    auto* dst = reinterpret_cast<__m128i*>(register_.get() + r);
+    __m128i src = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hll.register_.get() + r));
+    _mm_storeu_si128(dst, _mm_max_epu8(_mm_loadu_si128(dst), src));
   }
-
-  std::string result(m_, 0);
-  for (uint32_t i = 0; i < m_; ++i) {
-    result[i] = register_[i];
+#endif
+  for (; r < m_; r++) {
+    register_[r] = std::max(register_[r], hll.register_[r]);
   }
-  return result;
 }
 
 // ::__builtin_ctz(x): return the first number of '0' after the first '1' from the right
@@ -132,7 +279,7 @@ bool IsHyperloglogObj(const std::string* internal_value_str) {
 Status Redis::HyperloglogGet(const Slice &key, std::string* value) {
     value->clear();
 
-    BaseKey base_key(key);
+    BaseKey base_key(key, slot_key_prefix_num_);
     Status s = db_->Get(default_read_options_, base_key.Encode(), value);
     std::string meta_value = *value;
     if (!s.ok()) {
@@ -166,7 +313,7 @@ Status Redis::HyperloglogSet(const Slice &key, const Slice &value) {
     HyperloglogValue hyperloglog_value(value);
     ScopeRecordLock l(lock_mgr_, key);
 
-    BaseKey base_key(key);
+    BaseKey base_key(key, slot_key_prefix_num_);
     return db_->Put(default_write_options_, base_key.Encode(), hyperloglog_value.Encode());
 }
 
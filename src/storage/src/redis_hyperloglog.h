@@ -13,9 +13,31 @@
 
 namespace storage {
 
+/*
+ * Serialized layout of a hyperloglog value:
+ *
+ * legacy: m one-byte registers, no header
+ * dense:  | "HYLL" | kHllDense  | 3 bytes unused | 8 bytes unused | m 6-bit registers, packed LSB first |
+ * sparse: | "HYLL" | kHllSparse | 3 bytes unused | 8 bytes unused | opcodes |
+ *
+ * The sparse opcodes follow redis:
+ * ZERO:  00xxxxxx          xxxxxx + 1 registers are zero, 1-64
+ * XZERO: 01xxxxxx yyyyyyyy xxxxxxyyyyyyyy + 1 registers are zero, 1-16384
+ * VAL:   1vvvvvxx          xx + 1 registers are set to vvvvv + 1, 1-4 registers and value 1-32
+ *
+ * The legacy layout is still readable, values are always written with the
+ * sparse layout while it is smaller than kHllSparseMaxBytes, otherwise dense.
+ */
+constexpr char kHllMagic[] = "HYLL";
+constexpr size_t kHllHeaderSize = 16;
+constexpr uint8_t kHllDense = 0;
+constexpr uint8_t kHllSparse = 1;
+constexpr size_t kHllSparseMaxBytes = 3000;
+constexpr uint8_t kHllSparseValMax = 32;
+
 class HyperLogLog {
  public:
-  HyperLogLog(uint8_t precision, std::string origin_register);
+  HyperLogLog(uint8_t precision, const std::string& origin_register);
   ~HyperLogLog();
 
   double Estimate() const;
@@ -24,14 +46,25 @@ class HyperLogLog {
   double Alpha() const;
   uint8_t Nctz(uint32_t x, int b);
 
-  std::string Add(const char* value, uint32_t len);
-  std::string Merge(const HyperLogLog& hll);
+  // Return true if any register is changed
+  bool Add(const char* value, uint32_t len);
+  void Merge(const HyperLogLog& hll);
+  std::string Encode() const;
+
+  bool IsSparse() const { return EncodeSparse(nullptr); }
 
  protected:
-  uint32_t m_ = 0;  // register bit width
-  uint32_t b_ = 0;  // regieter size
+  void DecodeDense(const char* data, size_t len);
+  void DecodeSparse(const char* data, size_t len);
+  std::string EncodeDense() const;
+  // Return false if the registers can not be kept in sparse encoding
+  bool EncodeSparse(std::string* result) const;
+  void RegisterHistogram(uint32_t* histogram) const;
+
+  uint32_t m_ = 0;  // register size
+  uint32_t b_ = 0;  // register bit width
   double alpha_ = 0;
-  std::unique_ptr<char[]> register_;
+  std::unique_ptr<uint8_t[]> register_;
 };
 
 }  // namespace storage
@@ -3,6 +3,7 @@
 //  LICENSE file in the root directory of this source tree. An additional grant
 //  of patent rights can be found in the PATENTS file in the same directory.
 
+#include <algorithm>
 #include <memory>
 
 #include <fmt/core.h>
@@ -10,6 +11,7 @@
 
 #include "pstd/include/pika_codis_slot.h"
 #include "src/base_data_value_format.h"
+#include "src/lists_chunks.h"
 #include "src/lists_filter.h"
 #include "src/redis.h"
 #include "src/scope_record_lock.h"
@@ -66,7 +68,7 @@ Status Redis::LIndex(const Slice& key, int64_t index, std::string* element) {
   read_options.snapshot = snapshot;
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kLists, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -89,7 +91,12 @@ Status Redis::LIndex(const Slice& key, int64_t index, std::string* element) {
       uint64_t target_index =
           index >= 0 ? parsed_lists_meta_value.LeftIndex() + index + 1 : parsed_lists_meta_value.RightIndex() + index;
       if (parsed_lists_meta_value.LeftIndex() < target_index && target_index < parsed_lists_meta_value.RightIndex()) {
-        ListsDataKey lists_data_key(key, version, target_index);
+        if (parsed_lists_meta_value.IsChunked()) {
+          ListsChunks chunks(db_, handles_[kListsDataCF], read_options, key, &parsed_lists_meta_value,
+                             slot_key_prefix_num_);
+          return chunks.Index(target_index, element);
+        }
+        ListsDataKey lists_data_key(key, version, target_index, slot_key_prefix_num_);
         s = db_->Get(read_options, handles_[kListsDataCF], lists_data_key.Encode(), element);
         if (s.ok()) {
           ParsedBaseDataValue parsed_value(element);
@@ -110,7 +117,7 @@ Status Redis::LInsert(const Slice& key, const BeforeOrAfter& before_or_after, co
   ScopeRecordLock l(lock_mgr_, key);
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kLists, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -122,6 +129,9 @@ Status Redis::LInsert(const Slice& key, const BeforeOrAfter& before_or_after, co
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.ok()) {
+    s = ListsUpgradeEncoding(key, &meta_value);
+  }
   if (s.ok()) {
     ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
     if (parsed_lists_meta_value.IsStale()) {
@@ -129,87 +139,51 @@ Status Redis::LInsert(const Slice& key, const BeforeOrAfter& before_or_after, co
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
     } else {
-      bool find_pivot = false;
       uint64_t pivot_index = 0;
-      uint64_t version = parsed_lists_meta_value.Version();
-      uint64_t current_index = parsed_lists_meta_value.LeftIndex() + 1;
-      rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kListsDataCF]);
-      ListsDataKey start_data_key(key, version, current_index);
-      for (iter->Seek(start_data_key.Encode()); iter->Valid() && current_index < parsed_lists_meta_value.RightIndex();
-           iter->Next(), current_index++) {
-        ParsedBaseDataValue parsed_value(iter->value());
-        if (pivot.compare(parsed_value.UserValue().ToString()) == 0) {
-          find_pivot = true;
-          pivot_index = current_index;
-          break;
-        }
-      }
-      delete iter;
-      if (!find_pivot) {
+      ListsChunks chunks(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                         slot_key_prefix_num_);
+      s = chunks.Find(pivot, &pivot_index);
+      if (s.IsNotFound()) {
         *ret = -1;
-        return Status::NotFound();
-      } else {
-        uint64_t target_index;
-        std::vector<std::string> list_nodes;
-        uint64_t mid_index = parsed_lists_meta_value.LeftIndex() +
-                             (parsed_lists_meta_value.RightIndex() - parsed_lists_meta_value.LeftIndex()) / 2;
-        if (pivot_index <= mid_index) {
-          target_index = (before_or_after == Before) ? pivot_index - 1 : pivot_index;
-          current_index = parsed_lists_meta_value.LeftIndex() + 1;
-          rocksdb::Iterator* first_half_iter = db_->NewIterator(default_read_options_, handles_[kListsDataCF]);
-          ListsDataKey start_data_key(key, version, current_index);
-          for (first_half_iter->Seek(start_data_key.Encode()); first_half_iter->Valid() && current_index <= pivot_index;
-               first_half_iter->Next(), current_index++) {
-            ParsedBaseDataValue parsed_value(first_half_iter->value());
-            if (current_index == pivot_index) {
-              if (before_or_after == After) {
-                list_nodes.push_back(parsed_value.UserValue().ToString());
-              }
-              break;
-            }
-            list_nodes.push_back(parsed_value.UserValue().ToString());
-          }
-          delete first_half_iter;
-
-          current_index = parsed_lists_meta_value.LeftIndex();
-          for (const auto& node : list_nodes) {
-            ListsDataKey lists_data_key(key, version, current_index++);
-            BaseDataValue i_val(node);
-            batch.Put(handles_[kListsDataCF], lists_data_key.Encode(), i_val.Encode());
-          }
-          parsed_lists_meta_value.ModifyLeftIndex(1);
-        } else {
-          target_index = (before_or_after == Before) ? pivot_index : pivot_index + 1;
-          current_index = pivot_index;
-          rocksdb::Iterator* after_half_iter = db_->NewIterator(default_read_options_, handles_[kListsDataCF]);
-          ListsDataKey start_data_key(key, version, current_index);
-          for (after_half_iter->Seek(start_data_key.Encode());
-               after_half_iter->Valid() && current_index < parsed_lists_meta_value.RightIndex();
-               after_half_iter->Next(), current_index++) {
-            if (current_index == pivot_index && before_or_after == BeforeOrAfter::After) {
-              continue;
-            }
-            ParsedBaseDataValue parsed_value(after_half_iter->value());
-            list_nodes.push_back(parsed_value.UserValue().ToString());
+        return s;
+      } else if (!s.ok()) {
+        return s;
+      }
+      // Takes the elements on the shorter side of the new one off the list
+      // and pushes them back once it is in place
+      uint64_t front_len = pivot_index - parsed_lists_meta_value.LeftIndex() - (before_or_after == Before ? 1 : 0);
+      uint64_t back_len = parsed_lists_meta_value.Count() - front_len;
+      std::vector<std::string> list_nodes(std::min(front_len, back_len));
+      if (front_len <= back_len) {
+        for (auto& node : list_nodes) {
+          s = chunks.PopFront(&node);
+          if (!s.ok()) {
+            return s;
           }
-          delete after_half_iter;
-
-          current_index = target_index + 1;
-          for (const auto& node : list_nodes) {
-            ListsDataKey lists_data_key(key, version, current_index++);
-            BaseDataValue i_val(node);
-            batch.Put(handles_[kListsDataCF], lists_data_key.Encode(), i_val.Encode());
+        }
+        s = chunks.PushFront(value);
+        for (auto iter = list_nodes.rbegin(); s.ok() && iter != list_nodes.rend(); ++iter) {
+          s = chunks.PushFront(*iter);
+        }
+      } else {
+        for (auto& node : list_nodes) {
+          s = chunks.PopBack(&node);
+          if (!s.ok()) {
+            return s;
           }
-          parsed_lists_meta_value.ModifyRightIndex(1);
         }
-        parsed_lists_meta_value.ModifyCount(1);
-        batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
-        ListsDataKey lists_target_key(key, version, target_index);
-        BaseDataValue i_val(value);
-        batch.Put(handles_[kListsDataCF], lists_target_key.Encode(), i_val.Encode());
-        *ret = static_cast<int32_t>(parsed_lists_meta_value.Count());
-        return db_->Write(default_write_options_, &batch);
+        s = chunks.PushBack(value);
+        for (auto iter = list_nodes.rbegin(); s.ok() && iter != list_nodes.rend(); ++iter) {
+          s = chunks.PushBack(*iter);
+        }
+      }
+      if (!s.ok()) {
+        return s;
       }
+      chunks.Flush(&batch);
+      batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      *ret = static_cast<int32_t>(parsed_lists_meta_value.Count());
+      return db_->Write(default_write_options_, &batch);
     }
   } else if (s.IsNotFound()) {
     *ret = 0;
@@ -225,7 +199,7 @@ Status Redis::LLen(const Slice& key, uint64_t* len, std::string&& prefetch_meta)
   // we should get meta first
   std::string meta_value(std::move(prefetch_meta));
   if (meta_value.empty()) {
-    BaseMetaKey base_meta_key(key);
+    BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
     s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
     if (s.ok() && !ExpectedMetaValue(DataType::kLists, meta_value)) {
       if (ExpectedStale(meta_value)) {
@@ -261,7 +235,7 @@ Status Redis::LPop(const Slice& key, int64_t count, std::vector<std::string>* el
 
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kLists, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -273,6 +247,9 @@ Status Redis::LPop(const Slice& key, int64_t count, std::vector<std::string>* el
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.ok()) {
+    s = ListsUpgradeEncoding(key, &meta_value);
+  }
   if (s.ok()) {
     ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
     if (parsed_lists_meta_value.IsStale()) {
@@ -281,23 +258,20 @@ Status Redis::LPop(const Slice& key, int64_t count, std::vector<std::string>* el
       return Status::NotFound();
     } else {
       auto size = static_cast<int64_t>(parsed_lists_meta_value.Count());
-      uint64_t version = parsed_lists_meta_value.Version();
-      int32_t start_index = 0;
-      auto stop_index = static_cast<int32_t>(count<=size?count-1:size-1);
-      int32_t cur_index = 0;
-      ListsDataKey lists_data_key(key, version, parsed_lists_meta_value.LeftIndex()+1);
-      rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kListsDataCF]);
-      for (iter->Seek(lists_data_key.Encode()); iter->Valid() && cur_index <= stop_index; iter->Next(), ++cur_index) {
+      int64_t pop_count = count <= size ? count : size;
+      ListsChunks chunks(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                         slot_key_prefix_num_);
+      for (int64_t idx = 0; idx < pop_count; ++idx) {
+        std::string element;
+        s = chunks.PopFront(&element);
+        if (!s.ok()) {
+          return s;
+        }
         statistic++;
-        ParsedBaseDataValue parsed_base_data_value(iter->value());
-        elements->push_back(parsed_base_data_value.UserValue().ToString());
-        batch.Delete(handles_[kListsDataCF],iter->key());
-
-        parsed_lists_meta_value.ModifyCount(-1);
-        parsed_lists_meta_value.ModifyLeftIndex(-1);
+        elements->push_back(std::move(element));
       }
+      chunks.Flush(&batch);
       batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
-      delete iter;
     }
   }
   if (batch.Count() != 0U) {
@@ -315,11 +289,9 @@ Status Redis::LPush(const Slice& key, const std::vector<std::string>& values, ui
   rocksdb::WriteBatch batch;
   ScopeRecordLock l(lock_mgr_, key);
 
-  uint64_t index = 0;
-  uint64_t version = 0;
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kLists, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -332,39 +304,35 @@ Status Redis::LPush(const Slice& key, const std::vector<std::string>& values, ui
     }
   }
   if (s.ok()) {
+    s = ListsUpgradeEncoding(key, &meta_value);
+    if (!s.ok()) {
+      return s;
+    }
     ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
     if (parsed_lists_meta_value.IsStale() || parsed_lists_meta_value.Count() == 0) {
-      version = parsed_lists_meta_value.InitialMetaValue();
-    } else {
-      version = parsed_lists_meta_value.Version();
-    }
-    for (const auto& value : values) {
-      index = parsed_lists_meta_value.LeftIndex();
-      parsed_lists_meta_value.ModifyLeftIndex(1);
-      parsed_lists_meta_value.ModifyCount(1);
-      ListsDataKey lists_data_key(key, version, index);
-      BaseDataValue i_val(value);
-      batch.Put(handles_[kListsDataCF], lists_data_key.Encode(), i_val.Encode());
+      parsed_lists_meta_value.InitialMetaValue();
     }
-    batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
-    *ret = parsed_lists_meta_value.Count();
   } else if (s.IsNotFound()) {
     char str[8];
-    EncodeFixed64(str, values.size());
+    EncodeFixed64(str, 0);
     ListsMetaValue lists_meta_value(Slice(str, sizeof(uint64_t)));
-    version = lists_meta_value.UpdateVersion();
-    for (const auto& value : values) {
-      index = lists_meta_value.LeftIndex();
-      lists_meta_value.ModifyLeftIndex(1);
-      ListsDataKey lists_data_key(key, version, index);
-      BaseDataValue i_val(value);
-      batch.Put(handles_[kListsDataCF], lists_data_key.Encode(), i_val.Encode());
-    }
-    batch.Put(handles_[kMetaCF], base_meta_key.Encode(), lists_meta_value.Encode());
-    *ret = lists_meta_value.RightIndex() - lists_meta_value.LeftIndex() - 1;
+    lists_meta_value.UpdateVersion();
+    meta_value = lists_meta_value.Encode().ToString();
   } else {
     return s;
   }
+  ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
+  ListsChunks chunks(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                     slot_key_prefix_num_);
+  for (const auto& value : values) {
+    s = chunks.PushFront(value);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  chunks.Flush(&batch);
+  batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+  *ret = parsed_lists_meta_value.Count();
   return db_->Write(default_write_options_, &batch);
 }
 
@@ -375,7 +343,7 @@ Status Redis::LPushx(const Slice& key, const std::vector<std::string>& values, u
 
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kLists, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -387,6 +355,9 @@ Status Redis::LPushx(const Slice& key, const std::vector<std::string>& values, u
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.ok()) {
+    s = ListsUpgradeEncoding(key, &meta_value);
+  }
   if (s.ok()) {
     ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
     if (parsed_lists_meta_value.IsStale()) {
@@ -394,15 +365,15 @@ Status Redis::LPushx(const Slice& key, const std::vector<std::string>& values, u
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
     } else {
-      uint64_t version = parsed_lists_meta_value.Version();
+      ListsChunks chunks(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                         slot_key_prefix_num_);
       for (const auto& value : values) {
-        uint64_t index = parsed_lists_meta_value.LeftIndex();
-        parsed_lists_meta_value.ModifyCount(1);
-        parsed_lists_meta_value.ModifyLeftIndex(1);
-        ListsDataKey lists_data_key(key, version, index);
-        BaseDataValue i_val(value);
-        batch.Put(handles_[kListsDataCF], lists_data_key.Encode(), i_val.Encode());
+        s = chunks.PushFront(value);
+        if (!s.ok()) {
+          return s;
+        }
       }
+      chunks.Flush(&batch);
       batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
       *len = parsed_lists_meta_value.Count();
       return db_->Write(default_write_options_, &batch);
@@ -419,7 +390,7 @@ Status Redis::LRange(const Slice& key, int64_t start, int64_t stop, std::vector<
   read_options.snapshot = snapshot;
 
   std::string meta_value;
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kLists, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -454,9 +425,14 @@ Status Redis::LRange(const Slice& key, int64_t start, int64_t stop, std::vector<
         if (sublist_right_index > origin_right_index) {
           sublist_right_index = origin_right_index;
         }
+        if (parsed_lists_meta_value.IsChunked()) {
+          ListsChunks chunks(db_, handles_[kListsDataCF], read_options, key, &parsed_lists_meta_value,
+                             slot_key_prefix_num_);
+          return chunks.Range(sublist_left_index, sublist_right_index, ret);
+        }
         rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kListsDataCF]);
         uint64_t current_index = sublist_left_index;
-        ListsDataKey start_data_key(key, version, current_index);
+        ListsDataKey start_data_key(key, version, current_index, slot_key_prefix_num_);
         for (iter->Seek(start_data_key.Encode()); iter->Valid() && current_index <= sublist_right_index;
              iter->Next(), current_index++) {
           ParsedBaseDataValue parsed_value(iter->value());
@@ -479,7 +455,7 @@ Status Redis::LRangeWithTTL(const Slice& key, int64_t start, int64_t stop, std::
   read_options.snapshot = snapshot;
 
   std::string meta_value;
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kLists, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -525,9 +501,14 @@ Status Redis::LRangeWithTTL(const Slice& key, int64_t start, int64_t stop, std::
         if (sublist_right_index > origin_right_index) {
           sublist_right_index = origin_right_index;
         }
+        if (parsed_lists_meta_value.IsChunked()) {
+          ListsChunks chunks(db_, handles_[kListsDataCF], read_options, key, &parsed_lists_meta_value,
+                             slot_key_prefix_num_);
+          return chunks.Range(sublist_left_index, sublist_right_index, ret);
+        }
         rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kListsDataCF]);
         uint64_t current_index = sublist_left_index;
-        ListsDataKey start_data_key(key, version, current_index);
+        ListsDataKey start_data_key(key, version, current_index, slot_key_prefix_num_);
         for (iter->Seek(start_data_key.Encode());
              iter->Valid() && current_index <= sublist_right_index;
              iter->Next(), current_index++) {
@@ -549,7 +530,7 @@ Status Redis::LRem(const Slice& key, int64_t count, const Slice& value, uint64_t
   ScopeRecordLock l(lock_mgr_, key);
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kLists, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -561,6 +542,9 @@ Status Redis::LRem(const Slice& key, int64_t count, const Slice& value, uint64_t
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.ok()) {
+    s = ListsUpgradeEncoding(key, &meta_value);
+  }
   if (s.ok()) {
     ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
     if (parsed_lists_meta_value.IsStale()) {
@@ -568,107 +552,71 @@ Status Redis::LRem(const Slice& key, int64_t count, const Slice& value, uint64_t
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
     } else {
-      uint64_t current_index;
-      std::vector<uint64_t> target_index;
-      std::vector<uint64_t> delete_index;
+      std::vector<std::string> list_nodes;
+      ListsChunks chunks(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                         slot_key_prefix_num_);
+      s = chunks.Range(parsed_lists_meta_value.LeftIndex() + 1, parsed_lists_meta_value.RightIndex() - 1, &list_nodes);
+      if (!s.ok()) {
+        return s;
+      }
+      // Positions in list_nodes of the elements to remove
+      std::vector<uint64_t> target_pos;
       uint64_t rest = (count < 0) ? -count : count;
-      uint64_t version = parsed_lists_meta_value.Version();
-      uint64_t start_index = parsed_lists_meta_value.LeftIndex() + 1;
-      uint64_t stop_index = parsed_lists_meta_value.RightIndex() - 1;
-      ListsDataKey start_data_key(key, version, start_index);
-      ListsDataKey stop_data_key(key, version, stop_index);
       if (count >= 0) {
-        current_index = start_index;
-        rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kListsDataCF]);
-        for (iter->Seek(start_data_key.Encode());
-             iter->Valid() && current_index <= stop_index && ((count == 0) || rest != 0);
-             iter->Next(), current_index++) {
-          ParsedBaseDataValue parsed_value(iter->value());
-          if (value.compare(parsed_value.UserValue()) == 0) {
-            target_index.push_back(current_index);
+        for (uint64_t pos = 0; pos < list_nodes.size() && ((count == 0) || rest != 0); pos++) {
+          if (value.compare(list_nodes[pos]) == 0) {
+            target_pos.push_back(pos);
             if (count != 0) {
               rest--;
             }
           }
         }
-        delete iter;
       } else {
-        current_index = stop_index;
-        rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kListsDataCF]);
-        for (iter->Seek(stop_data_key.Encode());
-             iter->Valid() && current_index >= start_index && ((count == 0) || rest != 0);
-             iter->Prev(), current_index--) {
-          ParsedBaseDataValue parsed_value(iter->value());
-          if (value.compare(parsed_value.UserValue()) == 0) {
-            target_index.push_back(current_index);
-            if (count != 0) {
-              rest--;
-            }
+        for (uint64_t pos = list_nodes.size(); pos > 0 && rest != 0; pos--) {
+          if (value.compare(list_nodes[pos - 1]) == 0) {
+            target_pos.push_back(pos - 1);
+            rest--;
           }
         }
-        delete iter;
+        std::reverse(target_pos.begin(), target_pos.end());
       }
-      if (target_index.empty()) {
+      if (target_pos.empty()) {
         *ret = 0;
         return Status::NotFound();
-      } else {
-        rest = target_index.size();
-        uint64_t sublist_left_index = (count >= 0) ? target_index[0] : target_index[target_index.size() - 1];
-        uint64_t sublist_right_index = (count >= 0) ? target_index[target_index.size() - 1] : target_index[0];
-        uint64_t left_part_len = sublist_right_index - start_index;
-        uint64_t right_part_len = stop_index - sublist_left_index;
-        if (left_part_len <= right_part_len) {
-          uint64_t left = sublist_right_index;
-          current_index = sublist_right_index;
-          ListsDataKey sublist_right_key(key, version, sublist_right_index);
-          rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kListsDataCF]);
-          for (iter->Seek(sublist_right_key.Encode()); iter->Valid() && current_index >= start_index;
-               iter->Prev(), current_index--) {
-            ParsedBaseDataValue parsed_value(iter->value());
-            if (value.compare(parsed_value.UserValue()) == 0 && rest > 0) {
-              rest--;
-            } else {
-              ListsDataKey lists_data_key(key, version, left--);
-              batch.Put(handles_[kListsDataCF], lists_data_key.Encode(), iter->value());
-            }
-          }
-          delete iter;
-          uint64_t left_index = parsed_lists_meta_value.LeftIndex();
-          for (uint64_t idx = 0; idx < target_index.size(); ++idx) {
-            delete_index.push_back(left_index + idx + 1);
-          }
-          parsed_lists_meta_value.ModifyLeftIndex(-target_index.size());
-        } else {
-          uint64_t right = sublist_left_index;
-          current_index = sublist_left_index;
-          ListsDataKey sublist_left_key(key, version, sublist_left_index);
-          rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kListsDataCF]);
-          for (iter->Seek(sublist_left_key.Encode()); iter->Valid() && current_index <= stop_index;
-               iter->Next(), current_index++) {
-            ParsedBaseDataValue parsed_value(iter->value());
-            if ((value.compare(parsed_value.UserValue()) == 0) && rest > 0) {
-              rest--;
-            } else {
-              ListsDataKey lists_data_key(key, version, right++);
-              batch.Put(handles_[kListsDataCF], lists_data_key.Encode(), iter->value());
-            }
-          }
-          delete iter;
-          uint64_t right_index = parsed_lists_meta_value.RightIndex();
-          for (uint64_t idx = 0; idx < target_index.size(); ++idx) {
-            delete_index.push_back(right_index - idx - 1);
+      }
+
+      // Rewrites the shorter of the parts from either end of the list to
+      // the farthest removed element
+      uint64_t left_part_len = target_pos.back() + 1;
+      uint64_t right_part_len = list_nodes.size() - target_pos.front();
+      if (left_part_len <= right_part_len) {
+        s = chunks.TrimFront(left_part_len);
+        auto target = target_pos.rbegin();
+        for (uint64_t pos = left_part_len; s.ok() && pos > 0; pos--) {
+          if (target != target_pos.rend() && *target == pos - 1) {
+            ++target;
+          } else {
+            s = chunks.PushFront(list_nodes[pos - 1]);
           }
-          parsed_lists_meta_value.ModifyRightIndex(-target_index.size());
         }
-        parsed_lists_meta_value.ModifyCount(-target_index.size());
-        batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
-        for (const auto& idx : delete_index) {
-          ListsDataKey lists_data_key(key, version, idx);
-          batch.Delete(handles_[kListsDataCF], lists_data_key.Encode());
+      } else {
+        s = chunks.TrimBack(right_part_len);
+        auto target = target_pos.begin();
+        for (uint64_t pos = target_pos.front(); s.ok() && pos < list_nodes.size(); pos++) {
+          if (target != target_pos.end() && *target == pos) {
+            ++target;
+          } else {
+            s = chunks.PushBack(list_nodes[pos]);
+          }
         }
-        *ret = target_index.size();
-        return db_->Write(default_write_options_, &batch);
       }
+      if (!s.ok()) {
+        return s;
+      }
+      chunks.Flush(&batch);
+      batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      *ret = target_pos.size();
+      return db_->Write(default_write_options_, &batch);
     }
   } else if (s.IsNotFound()) {
     *ret = 0;
@@ -681,7 +629,7 @@ Status Redis::LSet(const Slice& key, int64_t index, const Slice& value) {
   ScopeRecordLock l(lock_mgr_, key);
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kLists, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -693,6 +641,9 @@ Status Redis::LSet(const Slice& key, int64_t index, const Slice& value) {
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.ok()) {
+    s = ListsUpgradeEncoding(key, &meta_value);
+  }
   if (s.ok()) {
     ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
     if (parsed_lists_meta_value.IsStale()) {
@@ -700,16 +651,21 @@ Status Redis::LSet(const Slice& key, int64_t index, const Slice& value) {
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
     } else {
-      uint64_t version = parsed_lists_meta_value.Version();
       uint64_t target_index =
           index >= 0 ? parsed_lists_meta_value.LeftIndex() + index + 1 : parsed_lists_meta_value.RightIndex() + index;
       if (target_index <= parsed_lists_meta_value.LeftIndex() ||
           target_index >= parsed_lists_meta_value.RightIndex()) {
         return Status::Corruption("index out of range");
       }
-      ListsDataKey lists_data_key(key, version, target_index);
-      BaseDataValue i_val(value);
-      s = db_->Put(default_write_options_, handles_[kListsDataCF], lists_data_key.Encode(), i_val.Encode());
+      rocksdb::WriteBatch batch;
+      ListsChunks chunks(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                         slot_key_prefix_num_);
+      s = chunks.Set(target_index, value.ToString());
+      if (!s.ok()) {
+        return s;
+      }
+      chunks.Flush(&batch);
+      s = db_->Write(default_write_options_, &batch);
       statistic++;
       UpdateSpecificKeyStatistics(DataType::kLists, key.ToString(), statistic);
       return s;
@@ -725,7 +681,7 @@ Status Redis::LTrim(const Slice& key, int64_t start, int64_t stop) {
   uint32_t statistic = 0;
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kLists, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -737,9 +693,11 @@ Status Redis::LTrim(const Slice& key, int64_t start, int64_t stop) {
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.ok()) {
+    s = ListsUpgradeEncoding(key, &meta_value);
+  }
   if (s.ok()) {
     ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
-    uint64_t version = parsed_lists_meta_value.Version();
     if (parsed_lists_meta_value.IsStale()) {
       return Status::NotFound("Stale");
     } else if (parsed_lists_meta_value.Count() == 0) {
@@ -763,22 +721,18 @@ Status Redis::LTrim(const Slice& key, int64_t start, int64_t stop) {
           sublist_right_index = origin_right_index;
         }
 
-        uint64_t delete_node_num =
-            (sublist_left_index - origin_left_index) + (origin_right_index - sublist_right_index);
-        parsed_lists_meta_value.ModifyLeftIndex(-(sublist_left_index - origin_left_index));
-        parsed_lists_meta_value.ModifyRightIndex(-(origin_right_index - sublist_right_index));
-        parsed_lists_meta_value.ModifyCount(-delete_node_num);
-        batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
-        for (uint64_t idx = origin_left_index; idx < sublist_left_index; ++idx) {
-          statistic++;
-          ListsDataKey lists_data_key(key, version, idx);
-          batch.Delete(handles_[kListsDataCF], lists_data_key.Encode());
+        ListsChunks chunks(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                           slot_key_prefix_num_);
+        s = chunks.TrimFront(sublist_left_index - origin_left_index);
+        if (s.ok()) {
+          s = chunks.TrimBack(origin_right_index - sublist_right_index);
         }
-        for (uint64_t idx = origin_right_index; idx > sublist_right_index; --idx) {
-          statistic++;
-          ListsDataKey lists_data_key(key, version, idx);
-          batch.Delete(handles_[kListsDataCF], lists_data_key.Encode());
+        if (!s.ok()) {
+          return s;
         }
+        statistic += (sublist_left_index - origin_left_index) + (origin_right_index - sublist_right_index);
+        chunks.Flush(&batch);
+        batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
       }
     }
   } else {
@@ -798,7 +752,7 @@ Status Redis::RPop(const Slice& key, int64_t count, std::vector<std::string>* el
 
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kLists, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -810,6 +764,9 @@ Status Redis::RPop(const Slice& key, int64_t count, std::vector<std::string>* el
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.ok()) {
+    s = ListsUpgradeEncoding(key, &meta_value);
+  }
   if (s.ok()) {
     ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
     if (parsed_lists_meta_value.IsStale()) {
@@ -818,23 +775,20 @@ Status Redis::RPop(const Slice& key, int64_t count, std::vector<std::string>* el
       return Status::NotFound();
     } else {
       auto size = static_cast<int64_t>(parsed_lists_meta_value.Count());
-      uint64_t version = parsed_lists_meta_value.Version();
-      int32_t start_index = 0;
-      auto stop_index = static_cast<int32_t>(count<=size?count-1:size-1);
-      int32_t cur_index = 0;
-      ListsDataKey lists_data_key(key, version, parsed_lists_meta_value.RightIndex()-1);
-      rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kListsDataCF]);
-      for (iter->SeekForPrev(lists_data_key.Encode()); iter->Valid() && cur_index <= stop_index; iter->Prev(), ++cur_index) {
+      int64_t pop_count = count <= size ? count : size;
+      ListsChunks chunks(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                         slot_key_prefix_num_);
+      for (int64_t idx = 0; idx < pop_count; ++idx) {
+        std::string element;
+        s = chunks.PopBack(&element);
+        if (!s.ok()) {
+          return s;
+        }
         statistic++;
-        ParsedBaseDataValue parsed_value(iter->value());
-        elements->push_back(parsed_value.UserValue().ToString());
-        batch.Delete(handles_[kListsDataCF],iter->key());
-
-        parsed_lists_meta_value.ModifyCount(-1);
-        parsed_lists_meta_value.ModifyRightIndex(-1);
+        elements->push_back(std::move(element));
       }
+      chunks.Flush(&batch);
       batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
-      delete iter;
     }
   }
   if (batch.Count() != 0U) {
@@ -855,7 +809,7 @@ Status Redis::RPoplpush(const Slice& source, const Slice& destination, std::stri
   MultiScopeRecordLock l(lock_mgr_, {source.ToString(), destination.ToString()});
   if (source.compare(destination) == 0) {
     std::string meta_value;
-    BaseMetaKey base_source(source);
+    BaseMetaKey base_source(source, slot_key_prefix_num_);
     s = db_->Get(default_read_options_, handles_[kMetaCF], base_source.Encode(), &meta_value);
     if (s.ok() && !ExpectedMetaValue(DataType::kLists, meta_value)) {
       if (ExpectedStale(meta_value)) {
@@ -867,6 +821,9 @@ Status Redis::RPoplpush(const Slice& source, const Slice& destination, std::stri
           DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
       }
     }
+    if (s.ok()) {
+      s = ListsUpgradeEncoding(source, &meta_value);
+    }
     if (s.ok()) {
       ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
       if (parsed_lists_meta_value.IsStale()) {
@@ -874,43 +831,37 @@ Status Redis::RPoplpush(const Slice& source, const Slice& destination, std::stri
       } else if (parsed_lists_meta_value.Count() == 0) {
         return Status::NotFound();
       } else {
+        ListsChunks chunks(db_, handles_[kListsDataCF], default_read_options_, source, &parsed_lists_meta_value,
+                           slot_key_prefix_num_);
+        if (parsed_lists_meta_value.Count() == 1) {
+          return chunks.Index(parsed_lists_meta_value.RightIndex() - 1, element);
+        }
         std::string target;
-        uint64_t version = parsed_lists_meta_value.Version();
-        uint64_t last_node_index = parsed_lists_meta_value.RightIndex() - 1;
-        ListsDataKey lists_data_key(source, version, last_node_index);
-        s = db_->Get(default_read_options_, handles_[kListsDataCF], lists_data_key.Encode(), &target);
+        s = chunks.PopBack(&target);
         if (s.ok()) {
-          *element = target;
-          ParsedBaseDataValue parsed_value(element);
-          parsed_value.StripSuffix();
-          if (parsed_lists_meta_value.Count() == 1) {
-            return Status::OK();
-          } else {
-            uint64_t target_index = parsed_lists_meta_value.LeftIndex();
-            ListsDataKey lists_target_key(source, version, target_index);
-            batch.Delete(handles_[kListsDataCF], lists_data_key.Encode());
-            batch.Put(handles_[kListsDataCF], lists_target_key.Encode(), target);
-            statistic++;
-            parsed_lists_meta_value.ModifyRightIndex(-1);
-            parsed_lists_meta_value.ModifyLeftIndex(1);
-            batch.Put(handles_[kMetaCF], base_source.Encode(), meta_value);
-            s = db_->Write(default_write_options_, &batch);
-            UpdateSpecificKeyStatistics(DataType::kLists, source.ToString(), statistic);
-            return s;
-          }
-        } else {
+          s = chunks.PushFront(target);
+        }
+        if (!s.ok()) {
           return s;
         }
+        chunks.Flush(&batch);
+        statistic++;
+        batch.Put(handles_[kMetaCF], base_source.Encode(), meta_value);
+        s = db_->Write(default_write_options_, &batch);
+        UpdateSpecificKeyStatistics(DataType::kLists, source.ToString(), statistic);
+        if (s.ok()) {
+          *element = std::move(target);
+        }
+        return s;
       }
     } else {
       return s;
     }
   }
 
-  uint64_t version;
   std::string target;
   std::string source_meta_value;
-  BaseMetaKey base_source(source);
+  BaseMetaKey base_source(source, slot_key_prefix_num_);
   s = db_->Get(default_read_options_, handles_[kMetaCF], base_source.Encode(), &source_meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kLists, source_meta_value)) {
     if (ExpectedStale(source_meta_value)) {
@@ -922,6 +873,9 @@ Status Redis::RPoplpush(const Slice& source, const Slice& destination, std::stri
         DataTypeStrings[static_cast<int>(GetMetaValueType(source_meta_value))]);
     }
   }
+  if (s.ok()) {
+    s = ListsUpgradeEncoding(source, &source_meta_value);
+  }
   if (s.ok()) {
     ParsedListsMetaValue parsed_lists_meta_value(&source_meta_value);
     if (parsed_lists_meta_value.IsStale()) {
@@ -929,26 +883,22 @@ Status Redis::RPoplpush(const Slice& source, const Slice& destination, std::stri
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
     } else {
-      version = parsed_lists_meta_value.Version();
-      uint64_t last_node_index = parsed_lists_meta_value.RightIndex() - 1;
-      ListsDataKey lists_data_key(source, version, last_node_index);
-      s = db_->Get(default_read_options_, handles_[kListsDataCF], lists_data_key.Encode(), &target);
-      if (s.ok()) {
-        batch.Delete(handles_[kListsDataCF], lists_data_key.Encode());
-        statistic++;
-        parsed_lists_meta_value.ModifyCount(-1);
-        parsed_lists_meta_value.ModifyRightIndex(-1);
-        batch.Put(handles_[kMetaCF], base_source.Encode(), source_meta_value);
-      } else {
+      ListsChunks chunks(db_, handles_[kListsDataCF], default_read_options_, source, &parsed_lists_meta_value,
+                         slot_key_prefix_num_);
+      s = chunks.PopBack(&target);
+      if (!s.ok()) {
         return s;
       }
+      chunks.Flush(&batch);
+      statistic++;
+      batch.Put(handles_[kMetaCF], base_source.Encode(), source_meta_value);
     }
   } else {
     return s;
   }
 
   std::string destination_meta_value;
-  BaseMetaKey base_destination(destination);
+  BaseMetaKey base_destination(destination, slot_key_prefix_num_);
   s = db_->Get(default_read_options_, handles_[kMetaCF], base_destination.Encode(), &destination_meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kLists, destination_meta_value)) {
     if (ExpectedStale(destination_meta_value)) {
@@ -961,38 +911,37 @@ Status Redis::RPoplpush(const Slice& source, const Slice& destination, std::stri
     }
   }
   if (s.ok()) {
+    s = ListsUpgradeEncoding(destination, &destination_meta_value);
+    if (!s.ok()) {
+      return s;
+    }
     ParsedListsMetaValue parsed_lists_meta_value(&destination_meta_value);
     if (parsed_lists_meta_value.IsStale() || parsed_lists_meta_value.Count() == 0) {
-      version = parsed_lists_meta_value.InitialMetaValue();
-    } else {
-      version = parsed_lists_meta_value.Version();
+      parsed_lists_meta_value.InitialMetaValue();
     }
-    uint64_t target_index = parsed_lists_meta_value.LeftIndex();
-    ListsDataKey lists_data_key(destination, version, target_index);
-    batch.Put(handles_[kListsDataCF], lists_data_key.Encode(), target);
-    parsed_lists_meta_value.ModifyCount(1);
-    parsed_lists_meta_value.ModifyLeftIndex(1);
-    batch.Put(handles_[kMetaCF], base_destination.Encode(), destination_meta_value);
   } else if (s.IsNotFound()) {
     char str[8];
-    EncodeFixed64(str, 1);
+    EncodeFixed64(str, 0);
     ListsMetaValue lists_meta_value(Slice(str, sizeof(uint64_t)));
-    version = lists_meta_value.UpdateVersion();
-    uint64_t target_index = lists_meta_value.LeftIndex();
-    ListsDataKey lists_data_key(destination, version, target_index);
-    batch.Put(handles_[kListsDataCF], lists_data_key.Encode(), target);
-    lists_meta_value.ModifyLeftIndex(1);
-    batch.Put(handles_[kMetaCF], base_destination.Encode(), lists_meta_value.Encode());
+    lists_meta_value.UpdateVersion();
+    destination_meta_value = lists_meta_value.Encode().ToString();
   } else {
     return s;
   }
+  ParsedListsMetaValue parsed_lists_meta_value(&destination_meta_value);
+  ListsChunks chunks(db_, handles_[kListsDataCF], default_read_options_, destination, &parsed_lists_meta_value,
+                     slot_key_prefix_num_);
+  s = chunks.PushFront(target);
+  if (!s.ok()) {
+    return s;
+  }
+  chunks.Flush(&batch);
+  batch.Put(handles_[kMetaCF], base_destination.Encode(), destination_meta_value);
 
   s = db_->Write(default_write_options_, &batch);
   UpdateSpecificKeyStatistics(DataType::kLists, source.ToString(), statistic);
   if (s.ok()) {
-    ParsedBaseDataValue parsed_value(&target);
-    parsed_value.StripSuffix();
-    *element = target;
+    *element = std::move(target);
   }
   return s;
 }
@@ -1000,12 +949,11 @@ Status Redis::RPoplpush(const Slice& source, const Slice& destination, std::stri
 Status Redis::RPush(const Slice& key, const std::vector<std::string>& values, uint64_t* ret) {
   *ret = 0;
   rocksdb::WriteBatch batch;
+  ScopeRecordLock l(lock_mgr_, key);
 
-  uint64_t index = 0;
-  uint64_t version = 0;
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kLists, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1018,39 +966,35 @@ Status Redis::RPush(const Slice& key, const std::vector<std::string>& values, ui
     }
   }
   if (s.ok()) {
+    s = ListsUpgradeEncoding(key, &meta_value);
+    if (!s.ok()) {
+      return s;
+    }
     ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
     if (parsed_lists_meta_value.IsStale() || parsed_lists_meta_value.Count() == 0) {
-      version = parsed_lists_meta_value.InitialMetaValue();
-    } else {
-      version = parsed_lists_meta_value.Version();
-    }
-    for (const auto& value : values) {
-      index = parsed_lists_meta_value.RightIndex();
-      parsed_lists_meta_value.ModifyRightIndex(1);
-      parsed_lists_meta_value.ModifyCount(1);
-      ListsDataKey lists_data_key(key, version, index);
-      BaseDataValue i_val(value);
-      batch.Put(handles_[kListsDataCF], lists_data_key.Encode(), i_val.Encode());
+      parsed_lists_meta_value.InitialMetaValue();
     }
-    batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
-    *ret = parsed_lists_meta_value.Count();
   } else if (s.IsNotFound()) {
     char str[8];
-    EncodeFixed64(str, values.size());
+    EncodeFixed64(str, 0);
     ListsMetaValue lists_meta_value(Slice(str, sizeof(uint64_t)));
-    version = lists_meta_value.UpdateVersion();
-    for (const auto& value : values) {
-      index = lists_meta_value.RightIndex();
-      lists_meta_value.ModifyRightIndex(1);
-      ListsDataKey lists_data_key(key, version, index);
-      BaseDataValue i_val(value);
-      batch.Put(handles_[kListsDataCF], lists_data_key.Encode(), i_val.Encode());
-    }
-    batch.Put(handles_[kMetaCF], base_meta_key.Encode(), lists_meta_value.Encode());
-    *ret = lists_meta_value.RightIndex() - lists_meta_value.LeftIndex() - 1;
+    lists_meta_value.UpdateVersion();
+    meta_value = lists_meta_value.Encode().ToString();
   } else {
     return s;
   }
+  ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
+  ListsChunks chunks(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                     slot_key_prefix_num_);
+  for (const auto& value : values) {
+    s = chunks.PushBack(value);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  chunks.Flush(&batch);
+  batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+  *ret = parsed_lists_meta_value.Count();
   return db_->Write(default_write_options_, &batch);
 }
 
@@ -1061,7 +1005,7 @@ Status Redis::RPushx(const Slice& key, const std::vector<std::string>& values, u
   ScopeRecordLock l(lock_mgr_, key);
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kLists, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1073,6 +1017,9 @@ Status Redis::RPushx(const Slice& key, const std::vector<std::string>& values, u
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.ok()) {
+    s = ListsUpgradeEncoding(key, &meta_value);
+  }
   if (s.ok()) {
     ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
     if (parsed_lists_meta_value.IsStale()) {
@@ -1080,15 +1027,15 @@ Status Redis::RPushx(const Slice& key, const std::vector<std::string>& values, u
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
     } else {
-      uint64_t version = parsed_lists_meta_value.Version();
+      ListsChunks chunks(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                         slot_key_prefix_num_);
       for (const auto& value : values) {
-        uint64_t index = parsed_lists_meta_value.RightIndex();
-        parsed_lists_meta_value.ModifyCount(1);
-        parsed_lists_meta_value.ModifyRightIndex(1);
-        ListsDataKey lists_data_key(key, version, index);
-        BaseDataValue i_val(value);
-        batch.Put(handles_[kListsDataCF], lists_data_key.Encode(), i_val.Encode());
+        s = chunks.PushBack(value);
+        if (!s.ok()) {
+          return s;
+        }
       }
+      chunks.Flush(&batch);
       batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
       *len = parsed_lists_meta_value.Count();
       return db_->Write(default_write_options_, &batch);
@@ -1097,10 +1044,66 @@ Status Redis::RPushx(const Slice& key, const std::vector<std::string>& values, u
   return s;
 }
 
+Status Redis::ListsUpgradeEncoding(const Slice& key, std::string* meta_value) {
+  ParsedListsMetaValue parsed_lists_meta_value(meta_value);
+  if (parsed_lists_meta_value.IsChunked() || parsed_lists_meta_value.IsStale() ||
+      parsed_lists_meta_value.Count() == 0) {
+    return Status::OK();
+  }
+  uint64_t version = parsed_lists_meta_value.Version();
+  uint64_t count = parsed_lists_meta_value.Count();
+  uint64_t current_index = parsed_lists_meta_value.LeftIndex() + 1;
+  uint64_t right_index = parsed_lists_meta_value.RightIndex();
+
+  // The chunks go under a new version, the lists data filter drops the rows
+  // of the old one. They are written kListsUpgradeBatchSize elements at a
+  // time so a long list is never held in one batch, and none of them is
+  // reachable before the meta is written last. The record lock is held all
+  // along, writes to the list wait for the upgrade but reads do not.
+  parsed_lists_meta_value.UpdateVersion();
+  parsed_lists_meta_value.set_left_index(InitalLeftIndex);
+  parsed_lists_meta_value.set_right_index(InitalRightIndex);
+  parsed_lists_meta_value.SetCount(0);
+  parsed_lists_meta_value.SetEncoding(kListsEncodingChunked);
+  rocksdb::WriteBatch batch;
+  ListsChunks chunks(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                     slot_key_prefix_num_);
+  Status s;
+  std::unique_ptr<rocksdb::Iterator> iter(db_->NewIterator(default_read_options_, handles_[kListsDataCF]));
+  ListsDataKey start_data_key(key, version, current_index, slot_key_prefix_num_);
+  for (iter->Seek(start_data_key.Encode()); iter->Valid() && current_index < right_index;
+       iter->Next(), current_index++) {
+    ParsedBaseDataValue parsed_value(iter->value());
+    s = chunks.PushBack(parsed_value.UserValue().ToString());
+    if (!s.ok()) {
+      return s;
+    }
+    if (parsed_lists_meta_value.Count() % kListsUpgradeBatchSize == 0) {
+      chunks.Flush(&batch);
+      s = db_->Write(default_write_options_, &batch);
+      if (!s.ok()) {
+        return s;
+      }
+      batch.Clear();
+    }
+  }
+  s = iter->status();
+  if (!s.ok()) {
+    return s;
+  }
+  if (parsed_lists_meta_value.Count() != count) {
+    return Status::Corruption("list misses elements");
+  }
+  chunks.Flush(&batch);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
+  batch.Put(handles_[kMetaCF], base_meta_key.Encode(), *meta_value);
+  return db_->Write(default_write_options_, &batch);
+}
+
 Status Redis::ListsExpire(const Slice& key, int64_t ttl, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s;
 
   // meta_value is empty means no meta value get before,
@@ -1127,8 +1130,9 @@ Status Redis::ListsExpire(const Slice& key, int64_t ttl, std::string&& prefetch_
     }
 
     if (ttl > 0) {
+      uint64_t old_etime = parsed_lists_meta_value.Etime();
       parsed_lists_meta_value.SetRelativeTimestamp(ttl);
-      s = db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      s = PutWithExpireIndex(key, base_meta_key.Encode(), meta_value, parsed_lists_meta_value.Etime(), old_etime);
     } else {
       parsed_lists_meta_value.InitialMetaValue();
       s = db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
@@ -1140,7 +1144,7 @@ Status Redis::ListsExpire(const Slice& key, int64_t ttl, std::string&& prefetch_
 Status Redis::ListsDel(const Slice& key, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s;
 
   // meta_value is empty means no meta value get before,
@@ -1177,7 +1181,7 @@ Status Redis::ListsDel(const Slice& key, std::string&& prefetch_meta) {
 Status Redis::ListsExpireat(const Slice& key, int64_t timestamp, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s;
 
   // meta_value is empty means no meta value get before,
@@ -1202,12 +1206,13 @@ Status Redis::ListsExpireat(const Slice& key, int64_t timestamp, std::string&& p
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
     } else {
+      uint64_t old_etime = parsed_lists_meta_value.Etime();
       if (timestamp > 0) {
         parsed_lists_meta_value.SetEtime(static_cast<uint64_t>(timestamp));
       } else {
         parsed_lists_meta_value.InitialMetaValue();
       }
-      return db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      return PutWithExpireIndex(key, base_meta_key.Encode(), meta_value, parsed_lists_meta_value.Etime(), old_etime);
     }
   }
   return s;
@@ -1216,7 +1221,7 @@ Status Redis::ListsExpireat(const Slice& key, int64_t timestamp, std::string&& p
 Status Redis::ListsPersist(const Slice& key, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s;
 
   // meta_value is empty means no meta value get before,
@@ -1245,8 +1250,9 @@ Status Redis::ListsPersist(const Slice& key, std::string&& prefetch_meta) {
       if (parsed_lists_meta_value.Etime() == 0) {
         return Status::NotFound("Not have an associated timeout");
       } else {
+        uint64_t old_etime = parsed_lists_meta_value.Etime();
         parsed_lists_meta_value.SetEtime(0);
-        return db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+        return PutWithExpireIndex(key, base_meta_key.Encode(), meta_value, 0, old_etime);
       }
     }
   }
@@ -1255,7 +1261,7 @@ Status Redis::ListsPersist(const Slice& key, std::string&& prefetch_meta) {
 
 Status Redis::ListsTTL(const Slice& key, int64_t* timestamp, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s;
 
   // meta_value is empty means no meta value get before,
@@ -6,6 +6,7 @@
 #include "src/redis.h"
 
 #include <algorithm>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <random>
@@ -22,6 +23,10 @@
 #include "storage/util.h"
 
 namespace storage {
+
+// members of the first set probed against the others with one MultiGet
+const size_t kSetsProbeBatchSize = 128;
+
 rocksdb::Status Redis::ScanSetsKeyNum(KeyInfo* key_info) {
   uint64_t keys = 0;
   uint64_t expires = 0;
@@ -77,7 +82,7 @@ rocksdb::Status Redis::SAdd(const Slice& key, const std::vector<std::string>& me
   uint64_t version = 0;
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -99,7 +104,7 @@ rocksdb::Status Redis::SAdd(const Slice& key, const std::vector<std::string>& me
       parsed_sets_meta_value.SetCount(static_cast<int32_t>(filtered_members.size()));
       batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
       for (const auto& member : filtered_members) {
-        SetsMemberKey sets_member_key(key, version, member);
+        SetsMemberKey sets_member_key(key, version, member, slot_key_prefix_num_);
         BaseDataValue iter_value(Slice{});
         batch.Put(handles_[kSetsDataCF], sets_member_key.Encode(), iter_value.Encode());
       }
@@ -109,7 +114,7 @@ rocksdb::Status Redis::SAdd(const Slice& key, const std::vector<std::string>& me
       std::string member_value;
       version = parsed_sets_meta_value.Version();
       for (const auto& member : filtered_members) {
-        SetsMemberKey sets_member_key(key, version, member);
+        SetsMemberKey sets_member_key(key, version, member, slot_key_prefix_num_);
         s = db_->Get(default_read_options_, handles_[kSetsDataCF], sets_member_key.Encode(), &member_value);
         if (s.ok()) {
         } else if (s.IsNotFound()) {
@@ -138,7 +143,7 @@ rocksdb::Status Redis::SAdd(const Slice& key, const std::vector<std::string>& me
     version = sets_meta_value.UpdateVersion();
     batch.Put(handles_[kMetaCF], base_meta_key.Encode(), sets_meta_value.Encode());
     for (const auto& member : filtered_members) {
-      SetsMemberKey sets_member_key(key, version, member);
+      SetsMemberKey sets_member_key(key, version, member, slot_key_prefix_num_);
       BaseDataValue i_val(Slice{});
       batch.Put(handles_[kSetsDataCF], sets_member_key.Encode(), i_val.Encode());
     }
@@ -154,7 +159,7 @@ rocksdb::Status Redis::SCard(const Slice& key, int32_t* ret, std::string&& meta)
   std::string meta_value(std::move(meta));
   rocksdb::Status s;
   if (meta_value.empty()) {
-    BaseMetaKey base_meta_key(key);
+    BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
     s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
     if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
       if (ExpectedStale(meta_value)) {
@@ -198,7 +203,7 @@ rocksdb::Status Redis::SDiff(const std::vector<std::string>& keys, std::vector<s
   rocksdb::Status s;
 
   for (uint32_t idx = 1; idx < keys.size(); ++idx) {
-    BaseMetaKey base_meta_key(keys[idx]);
+    BaseMetaKey base_meta_key(keys[idx], slot_key_prefix_num_);
     s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
     if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
       if (ExpectedStale(meta_value)) {
@@ -220,7 +225,7 @@ rocksdb::Status Redis::SDiff(const std::vector<std::string>& keys, std::vector<s
     }
   }
 
-  BaseMetaKey base_meta_key0(keys[0]);
+  BaseMetaKey base_meta_key0(keys[0], slot_key_prefix_num_);
   s = db_->Get(read_options, handles_[kMetaCF], base_meta_key0.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -235,33 +240,38 @@ rocksdb::Status Redis::SDiff(const std::vector<std::string>& keys, std::vector<s
   if (s.ok()) {
     ParsedSetsMetaValue parsed_sets_meta_value(&meta_value);
     if (!parsed_sets_meta_value.IsStale() && parsed_sets_meta_value.Count() != 0) {
-      bool found;
       Slice prefix;
-      std::string member_value;
+      std::vector<std::string> candidates;
+      std::vector<int32_t> rets;
       version = parsed_sets_meta_value.Version();
-      SetsMemberKey sets_member_key(keys[0], version, Slice());
+      SetsMemberKey sets_member_key(keys[0], version, Slice(), slot_key_prefix_num_);
       prefix = sets_member_key.EncodeSeekKey();
       KeyStatisticsDurationGuard guard(this, DataType::kSets, keys[0]);
       auto iter = db_->NewIterator(read_options, handles_[kSetsDataCF]);
-      for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
-        ParsedSetsMemberKey parsed_sets_member_key(iter->key());
-        Slice member = parsed_sets_member_key.member();
-
-        found = false;
+      iter->Seek(prefix);
+      while (iter->Valid() && iter->key().starts_with(prefix)) {
+        // probe the other sets a batch of members at a time
+        candidates.clear();
+        for (; iter->Valid() && iter->key().starts_with(prefix) && candidates.size() < kSetsProbeBatchSize;
+             iter->Next()) {
+          ParsedSetsMemberKey parsed_sets_member_key(iter->key());
+          candidates.push_back(parsed_sets_member_key.member().ToString());
+        }
         for (const auto& key_version : vaild_sets) {
-          SetsMemberKey sets_member_key(key_version.key, key_version.version, member);
-          s = db_->Get(read_options, handles_[kSetsDataCF], sets_member_key.Encode(), &member_value);
-          if (s.ok()) {
-            found = true;
-            break;
-          } else if (!s.IsNotFound()) {
+          s = SetsMembersExist(read_options, key_version.key, key_version.version, candidates, &rets);
+          if (!s.ok()) {
             delete iter;
             return s;
           }
+          size_t remained = 0;
+          for (size_t idx = 0; idx < candidates.size(); ++idx) {
+            if (rets[idx] == 0) {
+              candidates[remained++] = std::move(candidates[idx]);
+            }
+          }
+          candidates.resize(remained);
         }
-        if (!found) {
-          members->push_back(member.ToString());
-        }
+        std::move(candidates.begin(), candidates.end(), std::back_inserter(*members));
       }
       delete iter;
     }
@@ -289,7 +299,7 @@ rocksdb::Status Redis::SDiffstore(const Slice& destination, const std::vector<st
   rocksdb::Status s;
 
   for (uint32_t idx = 1; idx < keys.size(); ++idx) {
-    BaseMetaKey base_meta_key(keys[idx]);
+    BaseMetaKey base_meta_key(keys[idx], slot_key_prefix_num_);
     s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
     if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
       if (ExpectedStale(meta_value)) {
@@ -312,7 +322,7 @@ rocksdb::Status Redis::SDiffstore(const Slice& destination, const std::vector<st
   }
 
   std::vector<std::string> members;
-  BaseMetaKey base_meta_key0(keys[0]);
+  BaseMetaKey base_meta_key0(keys[0], slot_key_prefix_num_);
   s = db_->Get(read_options, handles_[kMetaCF], base_meta_key0.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -330,7 +340,7 @@ rocksdb::Status Redis::SDiffstore(const Slice& destination, const std::vector<st
       bool found;
       std::string member_value;
       version = parsed_sets_meta_value.Version();
-      SetsMemberKey sets_member_key(keys[0], version, Slice());
+      SetsMemberKey sets_member_key(keys[0], version, Slice(), slot_key_prefix_num_);
       Slice prefix = sets_member_key.EncodeSeekKey();
       KeyStatisticsDurationGuard guard(this, DataType::kSets, keys[0]);
       auto iter = db_->NewIterator(read_options, handles_[kSetsDataCF]);
@@ -340,7 +350,7 @@ rocksdb::Status Redis::SDiffstore(const Slice& destination, const std::vector<st
 
         found = false;
         for (const auto& key_version : vaild_sets) {
-          SetsMemberKey sets_member_key(key_version.key, key_version.version, member);
+          SetsMemberKey sets_member_key(key_version.key, key_version.version, member, slot_key_prefix_num_);
           s = db_->Get(read_options, handles_[kSetsDataCF], sets_member_key.Encode(), &member_value);
           if (s.ok()) {
             found = true;
@@ -361,7 +371,7 @@ rocksdb::Status Redis::SDiffstore(const Slice& destination, const std::vector<st
   }
 
   uint32_t statistic = 0;
-  BaseMetaKey base_destination(destination);
+  BaseMetaKey base_destination(destination, slot_key_prefix_num_);
   s = db_->Get(read_options, handles_[kMetaCF], base_destination.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -392,7 +402,7 @@ rocksdb::Status Redis::SDiffstore(const Slice& destination, const std::vector<st
     return s;
   }
   for (const auto& member : members) {
-    SetsMemberKey sets_member_key(destination, version, member);
+    SetsMemberKey sets_member_key(destination, version, member, slot_key_prefix_num_);
     BaseDataValue iter_value(Slice{});
     batch.Put(handles_[kSetsDataCF], sets_member_key.Encode(), iter_value.Encode());
   }
@@ -419,7 +429,7 @@ rocksdb::Status Redis::SInter(const std::vector<std::string>& keys, std::vector<
   rocksdb::Status s;
 
   for (uint32_t idx = 1; idx < keys.size(); ++idx) {
-    BaseMetaKey base_meta_key(keys[idx]);
+    BaseMetaKey base_meta_key(keys[idx], slot_key_prefix_num_);
     s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
     if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
       if (ExpectedStale(meta_value)) {
@@ -445,7 +455,7 @@ rocksdb::Status Redis::SInter(const std::vector<std::string>& keys, std::vector<
     }
   }
 
-  BaseMetaKey base_meta_key0(keys[0]);
+  BaseMetaKey base_meta_key0(keys[0], slot_key_prefix_num_);
   s = db_->Get(read_options, handles_[kMetaCF], base_meta_key0.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -462,34 +472,37 @@ rocksdb::Status Redis::SInter(const std::vector<std::string>& keys, std::vector<
     if (parsed_sets_meta_value.IsStale() || parsed_sets_meta_value.Count() == 0) {
       return rocksdb::Status::OK();
     } else {
-      bool reliable;
-      std::string member_value;
+      std::vector<std::string> candidates;
+      std::vector<int32_t> rets;
       version = parsed_sets_meta_value.Version();
-      SetsMemberKey sets_member_key(keys[0], version, Slice());
+      SetsMemberKey sets_member_key(keys[0], version, Slice(), slot_key_prefix_num_);
       KeyStatisticsDurationGuard guard(this, DataType::kSets, keys[0]);
       Slice prefix = sets_member_key.EncodeSeekKey();
       auto iter = db_->NewIterator(read_options, handles_[kSetsDataCF]);
-      for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
-        ParsedSetsMemberKey parsed_sets_member_key(iter->key());
-        Slice member = parsed_sets_member_key.member();
-
-        reliable = true;
+      iter->Seek(prefix);
+      while (iter->Valid() && iter->key().starts_with(prefix)) {
+        // probe the other sets a batch of members at a time
+        candidates.clear();
+        for (; iter->Valid() && iter->key().starts_with(prefix) && candidates.size() < kSetsProbeBatchSize;
+             iter->Next()) {
+          ParsedSetsMemberKey parsed_sets_member_key(iter->key());
+          candidates.push_back(parsed_sets_member_key.member().ToString());
+        }
         for (const auto& key_version : vaild_sets) {
-          SetsMemberKey sets_member_key(key_version.key, key_version.version, member);
-          s = db_->Get(read_options, handles_[kSetsDataCF], sets_member_key.Encode(), &member_value);
-          if (s.ok()) {
-            continue;
-          } else if (s.IsNotFound()) {
-            reliable = false;
-            break;
-          } else {
+          s = SetsMembersExist(read_options, key_version.key, key_version.version, candidates, &rets);
+          if (!s.ok()) {
             delete iter;
             return s;
           }
+          size_t remained = 0;
+          for (size_t idx = 0; idx < candidates.size(); ++idx) {
+            if (rets[idx] != 0) {
+              candidates[remained++] = std::move(candidates[idx]);
+            }
+          }
+          candidates.resize(remained);
         }
-        if (reliable) {
-          members->push_back(member.ToString());
-        }
+        std::move(candidates.begin(), candidates.end(), std::back_inserter(*members));
       }
       delete iter;
     }
@@ -520,7 +533,7 @@ rocksdb::Status Redis::SInterstore(const Slice& destination, const std::vector<s
   rocksdb::Status s;
 
   for (uint32_t idx = 1; idx < keys.size(); ++idx) {
-    BaseMetaKey base_meta_key(keys[idx]);
+    BaseMetaKey base_meta_key(keys[idx], slot_key_prefix_num_);
     s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
     if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
       if (ExpectedStale(meta_value)) {
@@ -550,7 +563,7 @@ rocksdb::Status Redis::SInterstore(const Slice& destination, const std::vector<s
 
   std::vector<std::string> members;
   if (!have_invalid_sets) {
-    BaseMetaKey base_meta_key0(keys[0]);
+    BaseMetaKey base_meta_key0(keys[0], slot_key_prefix_num_);
     s = db_->Get(read_options, handles_[kMetaCF], base_meta_key0.Encode(), &meta_value);
     if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
       if (ExpectedStale(meta_value)) {
@@ -570,7 +583,7 @@ rocksdb::Status Redis::SInterstore(const Slice& destination, const std::vector<s
         bool reliable;
         std::string member_value;
         version = parsed_sets_meta_value.Version();
-        SetsMemberKey sets_member_key(keys[0], version, Slice());
+        SetsMemberKey sets_member_key(keys[0], version, Slice(), slot_key_prefix_num_);
         Slice prefix = sets_member_key.EncodeSeekKey();
         KeyStatisticsDurationGuard guard(this, DataType::kSets, keys[0]);
         auto iter = db_->NewIterator(read_options, handles_[kSetsDataCF]);
@@ -580,7 +593,7 @@ rocksdb::Status Redis::SInterstore(const Slice& destination, const std::vector<s
 
           reliable = true;
           for (const auto& key_version : vaild_sets) {
-            SetsMemberKey sets_member_key(key_version.key, key_version.version, member);
+            SetsMemberKey sets_member_key(key_version.key, key_version.version, member, slot_key_prefix_num_);
             s = db_->Get(read_options, handles_[kSetsDataCF], sets_member_key.Encode(), &member_value);
             if (s.ok()) {
               continue;
@@ -605,7 +618,7 @@ rocksdb::Status Redis::SInterstore(const Slice& destination, const std::vector<s
   }
 
   uint32_t statistic = 0;
-  BaseMetaKey base_destination(destination);
+  BaseMetaKey base_destination(destination, slot_key_prefix_num_);
   s = db_->Get(read_options, handles_[kMetaCF], base_destination.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -636,7 +649,7 @@ rocksdb::Status Redis::SInterstore(const Slice& destination, const std::vector<s
     return s;
   }
   for (const auto& member : members) {
-    SetsMemberKey sets_member_key(destination, version, member);
+    SetsMemberKey sets_member_key(destination, version, member, slot_key_prefix_num_);
     BaseDataValue iter_value(Slice{});
     batch.Put(handles_[kSetsDataCF], sets_member_key.Encode(), iter_value.Encode());
   }
@@ -657,7 +670,7 @@ rocksdb::Status Redis::SIsmember(const Slice& key, const Slice& member, int32_t*
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -678,7 +691,7 @@ rocksdb::Status Redis::SIsmember(const Slice& key, const Slice& member, int32_t*
     } else {
       std::string member_value;
       version = parsed_sets_meta_value.Version();
-      SetsMemberKey sets_member_key(key, version, member);
+      SetsMemberKey sets_member_key(key, version, member, slot_key_prefix_num_);
       s = db_->Get(read_options, handles_[kSetsDataCF], sets_member_key.Encode(), &member_value);
       *ret = s.ok() ? 1 : 0;
     }
@@ -688,6 +701,62 @@ rocksdb::Status Redis::SIsmember(const Slice& key, const Slice& member, int32_t*
   return s;
 }
 
+rocksdb::Status Redis::SMIsmember(const Slice& key, const std::vector<std::string>& members,
+                                  std::vector<int32_t>* rets) {
+  rets->assign(members.size(), 0);
+  rocksdb::ReadOptions read_options;
+  const rocksdb::Snapshot* snapshot;
+
+  std::string meta_value;
+  ScopeSnapshot ss(db_, &snapshot);
+  read_options.snapshot = snapshot;
+
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
+  rocksdb::Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
+  if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
+    if (ExpectedStale(meta_value)) {
+      s = Status::NotFound();
+    } else {
+      return Status::InvalidArgument(
+        "WRONGTYPE, key: " + key.ToString() + ", expect type: " +
+        DataTypeStrings[static_cast<int>(DataType::kSets)] + ", get type: " +
+        DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
+    }
+  }
+  if (s.ok()) {
+    ParsedSetsMetaValue parsed_sets_meta_value(&meta_value);
+    if (parsed_sets_meta_value.IsStale()) {
+      return rocksdb::Status::NotFound("Stale");
+    } else if (parsed_sets_meta_value.Count() == 0) {
+      return rocksdb::Status::NotFound();
+    }
+    return SetsMembersExist(read_options, key, parsed_sets_meta_value.Version(), members, rets);
+  }
+  return s;
+}
+
+rocksdb::Status Redis::SetsMembersExist(const rocksdb::ReadOptions& read_options, const Slice& key, uint64_t version,
+                                        const std::vector<std::string>& members, std::vector<int32_t>* rets) {
+  std::vector<std::string> member_keys;
+  member_keys.reserve(members.size());
+  for (const auto& member : members) {
+    SetsMemberKey sets_member_key(key, version, member, slot_key_prefix_num_);
+    member_keys.push_back(sets_member_key.Encode().ToString());
+  }
+  std::vector<std::string> values;
+  std::vector<Status> statuses;
+  MultiGet(read_options, handles_[kSetsDataCF], member_keys, &values, &statuses);
+  rets->assign(members.size(), 0);
+  for (size_t idx = 0; idx < members.size(); ++idx) {
+    if (statuses[idx].ok()) {
+      (*rets)[idx] = 1;
+    } else if (!statuses[idx].IsNotFound()) {
+      return statuses[idx];
+    }
+  }
+  return rocksdb::Status::OK();
+}
+
 rocksdb::Status Redis::SMembers(const Slice& key, std::vector<std::string>* members) {
   rocksdb::ReadOptions read_options;
   const rocksdb::Snapshot* snapshot;
@@ -697,7 +766,7 @@ rocksdb::Status Redis::SMembers(const Slice& key, std::vector<std::string>* memb
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -727,7 +796,7 @@ rocksdb::Status Redis::SMembers(const Slice& key, std::vector<std::string>* memb
       return rocksdb::Status::NotFound();
     } else {
       version = parsed_sets_meta_value.Version();
-      SetsMemberKey sets_member_key(key, version, Slice());
+      SetsMemberKey sets_member_key(key, version, Slice(), slot_key_prefix_num_);
       Slice prefix = sets_member_key.EncodeSeekKey();
       KeyStatisticsDurationGuard guard(this, DataType::kSets, key.ToString());
       auto iter = db_->NewIterator(read_options, handles_[kSetsDataCF]);
@@ -751,7 +820,7 @@ Status Redis::SMembersWithTTL(const Slice& key,
   uint64_t version = 0;
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -781,7 +850,7 @@ Status Redis::SMembersWithTTL(const Slice& key,
       }
 
       version = parsed_sets_meta_value.Version();
-      SetsMemberKey sets_member_key(key, version, Slice());
+      SetsMemberKey sets_member_key(key, version, Slice(), slot_key_prefix_num_);
       Slice prefix = sets_member_key.EncodeSeekKey();
       KeyStatisticsDurationGuard guard(this, DataType::kSets, key.ToString());
       auto iter = db_->NewIterator(read_options, handles_[kSetsDataCF]);
@@ -813,7 +882,7 @@ rocksdb::Status Redis::SMove(const Slice& source, const Slice& destination, cons
     return rocksdb::Status::OK();
   }
 
-  BaseMetaKey base_source(source);
+  BaseMetaKey base_source(source, slot_key_prefix_num_);
   rocksdb::Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_source.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -834,7 +903,7 @@ rocksdb::Status Redis::SMove(const Slice& source, const Slice& destination, cons
     } else {
       std::string member_value;
       version = parsed_sets_meta_value.Version();
-      SetsMemberKey sets_member_key(source, version, member);
+      SetsMemberKey sets_member_key(source, version, member, slot_key_prefix_num_);
       s = db_->Get(default_read_options_, handles_[kSetsDataCF], sets_member_key.Encode(), &member_value);
       if (s.ok()) {
         *ret = 1;
@@ -859,7 +928,7 @@ rocksdb::Status Redis::SMove(const Slice& source, const Slice& destination, cons
     return s;
   }
 
-  BaseMetaKey base_destination(destination);
+  BaseMetaKey base_destination(destination, slot_key_prefix_num_);
   s = db_->Get(default_read_options_, handles_[kMetaCF], base_destination.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -877,13 +946,13 @@ rocksdb::Status Redis::SMove(const Slice& source, const Slice& destination, cons
       version = parsed_sets_meta_value.InitialMetaValue();
       parsed_sets_meta_value.SetCount(1);
       batch.Put(handles_[kMetaCF], base_destination.Encode(), meta_value);
-      SetsMemberKey sets_member_key(destination, version, member);
+      SetsMemberKey sets_member_key(destination, version, member, slot_key_prefix_num_);
       BaseDataValue i_val(Slice{});
       batch.Put(handles_[kSetsDataCF], sets_member_key.Encode(), i_val.Encode());
     } else {
       std::string member_value;
       version = parsed_sets_meta_value.Version();
-      SetsMemberKey sets_member_key(destination, version, member);
+      SetsMemberKey sets_member_key(destination, version, member, slot_key_prefix_num_);
       s = db_->Get(default_read_options_, handles_[kSetsDataCF], sets_member_key.Encode(), &member_value);
       if (s.IsNotFound()) {
         if (!parsed_sets_meta_value.CheckModifyCount(1)){
@@ -903,7 +972,7 @@ rocksdb::Status Redis::SMove(const Slice& source, const Slice& destination, cons
     SetsMetaValue sets_meta_value(DataType::kSets, Slice(str, 4));
     version = sets_meta_value.UpdateVersion();
     batch.Put(handles_[kMetaCF], base_destination.Encode(), sets_meta_value.Encode());
-    SetsMemberKey sets_member_key(destination, version, member);
+    SetsMemberKey sets_member_key(destination, version, member, slot_key_prefix_num_);
     BaseDataValue iter_value(Slice{});
     batch.Put(handles_[kSetsDataCF], sets_member_key.Encode(), iter_value.Encode());
   } else {
@@ -923,7 +992,7 @@ rocksdb::Status Redis::SPop(const Slice& key, std::vector<std::string>* members,
 
   uint64_t start_us = pstd::NowMicros();
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -947,7 +1016,7 @@ rocksdb::Status Redis::SPop(const Slice& key, std::vector<std::string>* members,
         int32_t size = parsed_sets_meta_value.Count();
         int32_t cur_index = 0;
         uint64_t version = parsed_sets_meta_value.Version();
-        SetsMemberKey sets_member_key(key, version, Slice());
+        SetsMemberKey sets_member_key(key, version, Slice(), slot_key_prefix_num_);
         auto iter = db_->NewIterator(default_read_options_, handles_[kSetsDataCF]);
         for (iter->Seek(sets_member_key.EncodeSeekKey());
             iter->Valid() && cur_index < size;
@@ -982,7 +1051,7 @@ rocksdb::Status Redis::SPop(const Slice& key, std::vector<std::string>* members,
           sets_index.insert(target_index);
         }
 
-        SetsMemberKey sets_member_key(key, version, Slice());
+        SetsMemberKey sets_member_key(key, version, Slice(), slot_key_prefix_num_);
         int64_t del_count = 0;
         KeyStatisticsDurationGuard guard(this, DataType::kSets, key.ToString());
         auto iter = db_->NewIterator(default_read_options_, handles_[kSetsDataCF]);
@@ -1040,7 +1109,7 @@ rocksdb::Status Redis::SRandmember(const Slice& key, int32_t count, std::vector<
   std::unordered_set<int32_t> unique;
 
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1084,7 +1153,7 @@ rocksdb::Status Redis::SRandmember(const Slice& key, int32_t count, std::vector<
 
       int32_t cur_index = 0;
       int32_t idx = 0;
-      SetsMemberKey sets_member_key(key, version, Slice());
+      SetsMemberKey sets_member_key(key, version, Slice(), slot_key_prefix_num_);
       KeyStatisticsDurationGuard guard(this, DataType::kSets, key.ToString());
       auto iter = db_->NewIterator(default_read_options_, handles_[kSetsDataCF]);
       for (iter->Seek(sets_member_key.EncodeSeekKey()); iter->Valid() && cur_index < size; iter->Next(), cur_index++) {
@@ -1114,7 +1183,7 @@ rocksdb::Status Redis::SRem(const Slice& key, const std::vector<std::string>& me
   uint32_t statistic = 0;
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1137,7 +1206,7 @@ rocksdb::Status Redis::SRem(const Slice& key, const std::vector<std::string>& me
       std::string member_value;
       version = parsed_sets_meta_value.Version();
       for (const auto& member : members) {
-        SetsMemberKey sets_member_key(key, version, member);
+        SetsMemberKey sets_member_key(key, version, member, slot_key_prefix_num_);
         s = db_->Get(default_read_options_, handles_[kSetsDataCF], sets_member_key.Encode(), &member_value);
         if (s.ok()) {
           cnt++;
@@ -1181,7 +1250,7 @@ rocksdb::Status Redis::SUnion(const std::vector<std::string>& keys, std::vector<
   rocksdb::Status s;
 
   for (const auto & key : keys) {
-    BaseMetaKey base_meta_key(key);
+    BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
     s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
     if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
       if (ExpectedStale(meta_value)) {
@@ -1206,7 +1275,7 @@ rocksdb::Status Redis::SUnion(const std::vector<std::string>& keys, std::vector<
   Slice prefix;
   std::map<std::string, bool> result_flag;
   for (const auto& key_version : vaild_sets) {
-    SetsMemberKey sets_member_key(key_version.key, key_version.version, Slice());
+    SetsMemberKey sets_member_key(key_version.key, key_version.version, Slice(), slot_key_prefix_num_);
     prefix = sets_member_key.EncodeSeekKey();
     KeyStatisticsDurationGuard guard(this, DataType::kSets, key_version.key);
     auto iter = db_->NewIterator(read_options, handles_[kSetsDataCF]);
@@ -1241,7 +1310,7 @@ rocksdb::Status Redis::SUnionstore(const Slice& destination, const std::vector<s
   rocksdb::Status s;
 
   for (const auto & key : keys) {
-    BaseMetaKey base_meta_key(key);
+    BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
     s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
     if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
       if (ExpectedStale(meta_value)) {
@@ -1267,7 +1336,7 @@ rocksdb::Status Redis::SUnionstore(const Slice& destination, const std::vector<s
   std::vector<std::string> members;
   std::map<std::string, bool> result_flag;
   for (const auto& key_version : vaild_sets) {
-    SetsMemberKey sets_member_key(key_version.key, key_version.version, Slice());
+    SetsMemberKey sets_member_key(key_version.key, key_version.version, Slice(), slot_key_prefix_num_);
     prefix = sets_member_key.EncodeSeekKey();
     KeyStatisticsDurationGuard guard(this, DataType::kSets, key_version.key);
     auto iter = db_->NewIterator(read_options, handles_[kSetsDataCF]);
@@ -1283,7 +1352,7 @@ rocksdb::Status Redis::SUnionstore(const Slice& destination, const std::vector<s
   }
 
   uint32_t statistic = 0;
-  BaseMetaKey base_destination(destination);
+  BaseMetaKey base_destination(destination, slot_key_prefix_num_);
   s = db_->Get(read_options, handles_[kMetaCF], base_destination.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1314,7 +1383,7 @@ rocksdb::Status Redis::SUnionstore(const Slice& destination, const std::vector<s
     return s;
   }
   for (const auto& member : members) {
-    SetsMemberKey sets_member_key(destination, version, member);
+    SetsMemberKey sets_member_key(destination, version, member, slot_key_prefix_num_);
     BaseDataValue i_val(Slice{});
     batch.Put(handles_[kSetsDataCF], sets_member_key.Encode(), i_val.Encode());
   }
@@ -1343,7 +1412,7 @@ rocksdb::Status Redis::SScan(const Slice& key, int64_t cursor, const std::string
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1375,8 +1444,8 @@ rocksdb::Status Redis::SScan(const Slice& key, int64_t cursor, const std::string
         sub_member = pattern.substr(0, pattern.size() - 1);
       }
 
-      SetsMemberKey sets_member_prefix(key, version, sub_member);
-      SetsMemberKey sets_member_key(key, version, start_point);
+      SetsMemberKey sets_member_prefix(key, version, sub_member, slot_key_prefix_num_);
+      SetsMemberKey sets_member_key(key, version, start_point, slot_key_prefix_num_);
       std::string prefix = sets_member_prefix.EncodeSeekKey().ToString();
       KeyStatisticsDurationGuard guard(this, DataType::kSets, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kSetsDataCF]);
@@ -1410,7 +1479,7 @@ rocksdb::Status Redis::SScan(const Slice& key, int64_t cursor, const std::string
 rocksdb::Status Redis::SetsExpire(const Slice& key, int64_t ttl, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s;
 
   // meta_value is empty means no meta value get before,
@@ -1437,8 +1506,9 @@ rocksdb::Status Redis::SetsExpire(const Slice& key, int64_t ttl, std::string&& p
     }
 
     if (ttl > 0) {
+      uint64_t old_etime = parsed_sets_meta_value.Etime();
       parsed_sets_meta_value.SetRelativeTimestamp(ttl);
-      s = db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      s = PutWithExpireIndex(key, base_meta_key.Encode(), meta_value, parsed_sets_meta_value.Etime(), old_etime);
     } else {
       parsed_sets_meta_value.InitialMetaValue();
       s = db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
@@ -1451,7 +1521,7 @@ rocksdb::Status Redis::SetsDel(const Slice& key, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
   rocksdb::Status s;
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
 
   // meta_value is empty means no meta value get before,
   // we should get meta first
@@ -1487,7 +1557,7 @@ rocksdb::Status Redis::SetsDel(const Slice& key, std::string&& prefetch_meta) {
 rocksdb::Status Redis::SetsExpireat(const Slice& key, int64_t timestamp, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s;
 
   // meta_value is empty means no meta value get before,
@@ -1512,12 +1582,13 @@ rocksdb::Status Redis::SetsExpireat(const Slice& key, int64_t timestamp, std::st
     } else if (parsed_sets_meta_value.Count() == 0) {
       return rocksdb::Status::NotFound();
     } else {
+      uint64_t old_etime = parsed_sets_meta_value.Etime();
       if (timestamp > 0) {
         parsed_sets_meta_value.SetEtime(static_cast<uint64_t>(timestamp));
       } else {
         parsed_sets_meta_value.InitialMetaValue();
       }
-      return db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      return PutWithExpireIndex(key, base_meta_key.Encode(), meta_value, parsed_sets_meta_value.Etime(), old_etime);
     }
   }
   return s;
@@ -1526,7 +1597,7 @@ rocksdb::Status Redis::SetsExpireat(const Slice& key, int64_t timestamp, std::st
 rocksdb::Status Redis::SetsPersist(const Slice& key, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s;
 
   // meta_value is empty means no meta value get before,
@@ -1556,7 +1627,7 @@ rocksdb::Status Redis::SetsPersist(const Slice& key, std::string&& prefetch_meta
         return rocksdb::Status::NotFound("Not have an associated timeout");
       } else {
         parsed_sets_meta_value.SetEtime(0);
-        return db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+        return PutWithExpireIndex(key, base_meta_key.Encode(), meta_value, 0, timestamp);
       }
     }
   }
@@ -1565,7 +1636,7 @@ rocksdb::Status Redis::SetsPersist(const Slice& key, std::string&& prefetch_meta
 
 rocksdb::Status Redis::SetsTTL(const Slice& key, int64_t* timestamp, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s;
 
   // meta_value is empty means no meta value get before,
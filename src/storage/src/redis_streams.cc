@@ -66,7 +66,7 @@ Status Redis::XAdd(const Slice& key, const std::string& serialized_message, Stre
   assert(current_id > serialized_last_id);
 #endif
 
-  StreamDataKey stream_data_key(key, stream_meta.version(), args.id.Serialize());
+  StreamDataKey stream_data_key(key, stream_meta.version(), args.id.Serialize(), slot_key_prefix_num_);
   s = db_->Put(default_write_options_, handles_[kStreamsDataCF], stream_data_key.Encode(), serialized_message);
   if (!s.ok()) {
     return Status::Corruption("error from XADD, insert stream message failed 1: " + s.ToString());
@@ -90,7 +90,7 @@ Status Redis::XAdd(const Slice& key, const std::string& serialized_message, Stre
   }
 
   // 5 update stream meta
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   s = db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), stream_meta.value());
   if (!s.ok()) {
     return s;
@@ -117,7 +117,7 @@ Status Redis::XTrim(const Slice& key, StreamAddTrimArgs& args, int32_t& count) {
   }
 
   // 3 update stream meta
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   s = db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), stream_meta.value());
   if (!s.ok()) {
     return s;
@@ -142,7 +142,7 @@ Status Redis::XDel(const Slice& key, const std::vector<streamID>& ids, int32_t&
   count = static_cast<int32_t>(ids.size());
   std::string unused;
   for (auto id : ids) {
-    StreamDataKey stream_data_key(key, stream_meta.version(), id.Serialize());
+    StreamDataKey stream_data_key(key, stream_meta.version(), id.Serialize(), slot_key_prefix_num_);
     s = db_->Get(default_read_options_, handles_[kStreamsDataCF], stream_data_key.Encode(), &unused);
     if (s.IsNotFound()) {
       --count;
@@ -172,7 +172,8 @@ Status Redis::XDel(const Slice& key, const std::vector<streamID>& ids, int32_t&
     }
   }
 
-  return db_->Put(default_write_options_, handles_[kMetaCF], BaseMetaKey(key).Encode(), stream_meta.value());
+  return db_->Put(default_write_options_, handles_[kMetaCF], BaseMetaKey(key, slot_key_prefix_num_).Encode(),
+                  stream_meta.value());
 }
 
 Status Redis::XRange(const Slice& key, const StreamScanArgs& args, std::vector<IdMessage>& field_values, std::string&& prefetch_meta) {
@@ -362,7 +363,7 @@ Status Redis::ScanStreamsKeyNum(KeyInfo* key_info) {
 
 Status Redis::StreamsDel(const Slice& key, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s;
 
   // value is empty means no meta value get before,
@@ -398,7 +399,7 @@ Status Redis::StreamsDel(const Slice& key, std::string&& prefetch_meta) {
 Status Redis::GetStreamMeta(StreamMetaValue& stream_meta, const rocksdb::Slice& key,
                             rocksdb::ReadOptions& read_options, std::string&& prefetch_meta) {
   std::string value(std::move(prefetch_meta));
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s;
 
   // value is empty means no meta value get before,
@@ -667,8 +668,8 @@ Status Redis::StreamScanRange(const Slice& key, const uint64_t version, const Sl
     return Status::InvalidArgument("error in given range");
   }
 
-  StreamDataKey streams_data_prefix(key, version, Slice());
-  StreamDataKey streams_start_data_key(key, version, id_start);
+  StreamDataKey streams_data_prefix(key, version, Slice(), slot_key_prefix_num_);
+  StreamDataKey streams_start_data_key(key, version, id_start, slot_key_prefix_num_);
   std::string prefix = streams_data_prefix.EncodeSeekKey().ToString();
   rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kStreamsDataCF]);
   for (iter->Seek(start_no_limit ? prefix : streams_start_data_key.Encode());
@@ -714,8 +715,8 @@ Status Redis::StreamReScanRange(const Slice& key, const uint64_t version, const
 
   uint64_t start_key_version = start_no_limit ? version + 1 : version;
   std::string start_key_id = start_no_limit ? "" : id_start.ToString();
-  StreamDataKey streams_data_prefix(key, version, Slice());
-  StreamDataKey streams_start_data_key(key, start_key_version, start_key_id);
+  StreamDataKey streams_data_prefix(key, version, Slice(), slot_key_prefix_num_);
+  StreamDataKey streams_start_data_key(key, start_key_version, start_key_id, slot_key_prefix_num_);
   std::string prefix = streams_data_prefix.EncodeSeekKey().ToString();
   rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kStreamsDataCF]);
   for (iter->SeekForPrev(streams_start_data_key.Encode().ToString());
@@ -757,7 +758,7 @@ Status Redis::DeleteStreamMessages(const rocksdb::Slice& key, const StreamMetaVa
                                    rocksdb::ReadOptions& read_options) {
   rocksdb::WriteBatch batch;
   for (auto& sid : serialized_ids) {
-    StreamDataKey stream_data_key(key, stream_meta.version(), sid);
+    StreamDataKey stream_data_key(key, stream_meta.version(), sid, slot_key_prefix_num_);
     batch.Delete(handles_[kStreamsDataCF], stream_data_key.Encode());
   }
   return db_->Write(default_write_options_, &batch);
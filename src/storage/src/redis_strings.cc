@@ -6,14 +6,18 @@
 #include <iostream>
 #include <algorithm>
 #include <climits>
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <unordered_set>
 
 #include <fmt/core.h>
 #include <glog/logging.h>
 
 #include "pstd/include/pika_codis_slot.h"
 #include "src/base_key_format.h"
+#include "src/bitmap_ops.h"
+#include "src/bitmap_segments.h"
 #include "src/scope_record_lock.h"
 #include "src/scope_snapshot.h"
 #include "src/strings_filter.h"
@@ -68,7 +72,7 @@ Status Redis::Append(const Slice& key, const Slice& value, int32_t* ret) {
   *ret = 0;
   ScopeRecordLock l(lock_mgr_, key);
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, base_key.Encode(), &old_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, old_value)) {
     if (ExpectedStale(old_value)) {
@@ -80,6 +84,9 @@ Status Redis::Append(const Slice& key, const Slice& value, int32_t* ret) {
         DataTypeStrings[static_cast<int>(GetMetaValueType(old_value))]);
     }
   }
+  if (s.ok()) {
+    s = ExpandBitmap(key, &old_value);
+  }
   if (s.ok()) {
     ParsedStringsValue parsed_strings_value(&old_value);
     if (parsed_strings_value.IsStale()) {
@@ -103,29 +110,18 @@ Status Redis::Append(const Slice& key, const Slice& value, int32_t* ret) {
   return s;
 }
 
-int GetBitCount(const unsigned char* value, int64_t bytes) {
-  int bit_num = 0;
-  static const unsigned char bitsinbyte[256] = {
-      0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 1, 2, 2, 3, 2,
-      3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3,
-      3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5,
-      6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4,
-      3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4,
-      5, 5, 6, 5, 6, 6, 7, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6,
-      6, 7, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7, 4, 5, 5, 6, 5, 6, 6, 7, 5, 6, 6, 7, 6, 7, 7, 8};
-  for (int i = 0; i < bytes; i++) {
-    bit_num += bitsinbyte[static_cast<unsigned int>(value[i])];
-  }
-  return bit_num;
-}
-
 Status Redis::BitCount(const Slice& key, int64_t start_offset, int64_t end_offset, int32_t* ret,
                           bool have_range) {
   *ret = 0;
   std::string value;
+  // The meta and the segments of a bitmap are read from the same snapshot
+  rocksdb::ReadOptions read_options;
+  const rocksdb::Snapshot* snapshot;
+  ScopeSnapshot ss(db_, &snapshot);
+  read_options.snapshot = snapshot;
 
-  BaseKey base_key(key);
-  Status s = db_->Get(default_read_options_, base_key.Encode(), &value);
+  BaseKey base_key(key, slot_key_prefix_num_);
+  Status s = db_->Get(read_options, base_key.Encode(), &value);
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, value)) {
     if (ExpectedStale(value)) {
       s = Status::NotFound();
@@ -141,9 +137,12 @@ Status Redis::BitCount(const Slice& key, int64_t start_offset, int64_t end_offse
     if (parsed_strings_value.IsStale()) {
       return Status::NotFound("Stale");
     } else {
+      bool is_bitmap = parsed_strings_value.IsBitmap();
+      uint64_t version = is_bitmap ? parsed_strings_value.BitmapVersion() : 0;
+      auto value_length = static_cast<int64_t>(is_bitmap ? parsed_strings_value.BitmapLength()
+                                                         : parsed_strings_value.UserValue().size());
       parsed_strings_value.StripSuffix();
       const auto bit_value = reinterpret_cast<const unsigned char*>(value.data());
-      auto value_length = static_cast<int64_t>(value.length());
       if (have_range) {
         if (start_offset < 0) {
           start_offset = start_offset + value_length;
@@ -168,7 +167,21 @@ Status Redis::BitCount(const Slice& key, int64_t start_offset, int64_t end_offse
         start_offset = 0;
         end_offset = std::max(value_length - 1, static_cast<int64_t>(0));
       }
-      *ret = GetBitCount(bit_value + start_offset, end_offset - start_offset + 1);
+      if (!is_bitmap) {
+        *ret = static_cast<int32_t>(BitmapCount(bit_value + start_offset, end_offset - start_offset + 1));
+      } else if (value_length > 0) {
+        // Segments that are not stored have no bit set
+        uint64_t count = 0;
+        BitmapSegments segments(db_, handles_[kBitmapsDataCF], read_options, key, version, slot_key_prefix_num_);
+        s = segments.Scan(start_offset, end_offset, [&count](uint64_t, const Slice& bytes) {
+          count += BitmapCount(reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size());
+          return true;
+        });
+        if (!s.ok()) {
+          return s;
+        }
+        *ret = static_cast<int32_t>(count);
+      }
     }
   } else {
     return s;
@@ -176,45 +189,71 @@ Status Redis::BitCount(const Slice& key, int64_t start_offset, int64_t end_offse
   return Status::OK();
 }
 
-std::string BitOpOperate(BitOpType op, const std::vector<std::string>& src_values, int64_t max_len) {
-  char byte;
-  char output;
-  auto dest_value = std::make_unique<char[]>(max_len);
-  for (int64_t j = 0; j < max_len; j++) {
-    if (j < static_cast<int64_t>(src_values[0].size())) {
-      output = src_values[0][j];
+Status Redis::BitOpApply(const rocksdb::ReadOptions& read_options, BitOpType op, const Slice& key, bool first,
+                         std::string* dest_value) {
+  std::string value;
+  BaseKey base_key(key, slot_key_prefix_num_);
+  Status s = db_->Get(read_options, base_key.Encode(), &value);
+  if (s.ok() && !ExpectedMetaValue(DataType::kStrings, value)) {
+    if (ExpectedStale(value)) {
+      s = Status::NotFound();
     } else {
-      output = 0;
+      return Status::InvalidArgument(
+        "WRONGTYPE, key: " + key.ToString() + ", expect type: " +
+        DataTypeStrings[static_cast<int>(DataType::kStrings)] + ", get type: " +
+        DataTypeStrings[static_cast<int>(GetMetaValueType(value))]);
     }
-    if (op == kBitOpNot) {
-      output = static_cast<char>(~output);
+  }
+  bool is_bitmap = false;
+  uint64_t version = 0;
+  uint64_t value_length = 0;
+  if (s.ok()) {
+    ParsedStringsValue parsed_strings_value(&value);
+    if (!parsed_strings_value.IsStale()) {
+      is_bitmap = parsed_strings_value.IsBitmap();
+      version = is_bitmap ? parsed_strings_value.BitmapVersion() : 0;
+      value_length = is_bitmap ? parsed_strings_value.BitmapLength() : parsed_strings_value.UserValue().size();
+      parsed_strings_value.StripSuffix();
     }
-    for (size_t i = 1; i < src_values.size(); i++) {
-      if (static_cast<int64_t>(src_values[i].size()) - 1 >= j) {
-        byte = src_values[i][j];
-      } else {
-        byte = 0;
-      }
-      switch (op) {
-        case kBitOpNot:
-          break;
-        case kBitOpAnd:
-          output = static_cast<char>(output & byte);
-          break;
-        case kBitOpOr:
-          output = static_cast<char>(output | byte);
-          break;
-        case kBitOpXor:
-          output = static_cast<char>(output ^ byte);
-          break;
-        case kBitOpDefault:
-          break;
+  } else if (!s.IsNotFound()) {
+    return s;
+  }
+
+  // Every source is zero past its length, so is what the sources before
+  // this one make of it
+  if (first) {
+    dest_value->assign(value_length, '\0');
+  } else if (value_length > dest_value->size()) {
+    dest_value->resize(value_length, '\0');
+  }
+  auto dest = reinterpret_cast<unsigned char*>(dest_value->data());
+  BitOpType value_op = first ? kBitOpOr : op;
+  uint64_t next = 0;
+  if (!is_bitmap) {
+    BitmapOperate(value_op, dest, reinterpret_cast<const unsigned char*>(value.data()), value_length);
+    next = value_length;
+  } else if (value_length > 0) {
+    // Only the stored segments are read, the ones missing are zero
+    BitmapSegments segments(db_, handles_[kBitmapsDataCF], read_options, key, version, slot_key_prefix_num_);
+    s = segments.Scan(0, value_length - 1, [&](uint64_t offset, const Slice& bytes) {
+      if (value_op == kBitOpAnd) {
+        memset(dest + next, 0, offset - next);
       }
+      BitmapOperate(value_op, dest + offset, reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size());
+      next = offset + bytes.size();
+      return true;
+    });
+    if (!s.ok()) {
+      return s;
     }
-    dest_value[j] = output;
   }
-  std::string dest_str(dest_value.get(), max_len);
-  return dest_str;
+  if (value_op == kBitOpAnd) {
+    memset(dest + next, 0, dest_value->size() - next);
+  }
+  if (first && op == kBitOpNot) {
+    BitmapOperate(kBitOpNot, dest, dest, dest_value->size());
+  }
+  return Status::OK();
 }
 
 Status Redis::BitOp(BitOpType op, const std::string& dest_key, const std::vector<std::string>& src_keys, std::string& value_to_dest, int64_t* ret) {
@@ -225,49 +264,24 @@ Status Redis::BitOp(BitOpType op, const std::string& dest_key, const std::vector
     return Status::InvalidArgument("the number of source keys is not right");
   }
 
-  int64_t max_len = 0;
-  int64_t value_len = 0;
-  std::vector<std::string> src_values;
-  for (const auto & src_key : src_keys) {
-    std::string value;
-    BaseKey base_key(src_key);
-    s = db_->Get(default_read_options_, base_key.Encode(), &value);
-    if (s.ok() && !ExpectedMetaValue(DataType::kStrings, value)) {
-      if (ExpectedStale(value)) {
-        s = Status::NotFound();
-      } else {
-        return Status::InvalidArgument(
-          "WRONGTYPE, key: " + dest_key + ", expect type: " +
-          DataTypeStrings[static_cast<int>(DataType::kStrings)] + ", get type: " +
-          DataTypeStrings[static_cast<int>(GetMetaValueType(value))]);
-      }
-    }
-    if (s.ok()) {
-      ParsedStringsValue parsed_strings_value(&value);
-      if (parsed_strings_value.IsStale()) {
-        src_values.emplace_back("");
-        value_len = 0;
-      } else {
-        parsed_strings_value.StripSuffix();
-        src_values.push_back(value);
-        value_len = static_cast<int64_t>(value.size());
-      }
-    } else if (s.IsNotFound()) {
-      src_values.emplace_back("");
-      value_len = 0;
-    } else {
+  // All the sources are read from one snapshot
+  rocksdb::ReadOptions read_options;
+  const rocksdb::Snapshot* snapshot;
+  ScopeSnapshot ss(db_, &snapshot);
+  read_options.snapshot = snapshot;
+  std::string dest_value;
+  for (size_t i = 0; i < src_keys.size(); i++) {
+    s = BitOpApply(read_options, op, src_keys[i], i == 0, &dest_value);
+    if (!s.ok()) {
       return s;
     }
-    max_len = std::max(max_len, value_len);
   }
-
-  std::string dest_value = BitOpOperate(op, src_values, max_len);
   value_to_dest = dest_value;
   *ret = static_cast<int64_t>(dest_value.size());
 
-  StringsValue strings_value(Slice(dest_value.c_str(), max_len));
+  StringsValue strings_value(dest_value);
   ScopeRecordLock l(lock_mgr_, dest_key);
-  BaseKey base_dest_key(dest_key);
+  BaseKey base_dest_key(dest_key, slot_key_prefix_num_);
   return db_->Put(default_write_options_, base_dest_key.Encode(), strings_value.Encode());
 }
 
@@ -276,7 +290,7 @@ Status Redis::Decrby(const Slice& key, int64_t value, int64_t* ret) {
   std::string new_value;
   ScopeRecordLock l(lock_mgr_, key);
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, base_key.Encode(), &old_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, old_value)) {
     if (ExpectedStale(old_value)) {
@@ -288,6 +302,9 @@ Status Redis::Decrby(const Slice& key, int64_t value, int64_t* ret) {
         DataTypeStrings[static_cast<int>(GetMetaValueType(old_value))]);
     }
   }
+  if (s.ok()) {
+    s = ExpandBitmap(key, &old_value);
+  }
   if (s.ok()) {
     ParsedStringsValue parsed_strings_value(&old_value);
     if (parsed_strings_value.IsStale()) {
@@ -326,7 +343,7 @@ Status Redis::Decrby(const Slice& key, int64_t value, int64_t* ret) {
 Status Redis::Get(const Slice& key, std::string* value) {
   value->clear();
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, base_key.Encode(), value);
   std::string meta_value = *value;
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, meta_value)) {
@@ -339,6 +356,9 @@ Status Redis::Get(const Slice& key, std::string* value) {
           DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.ok()) {
+    s = ExpandBitmap(key, value);
+  }
   if (s.ok()) {
     ParsedStringsValue parsed_strings_value(value);
     if (parsed_strings_value.IsStale()) {
@@ -354,12 +374,15 @@ Status Redis::Get(const Slice& key, std::string* value) {
 Status Redis::MGet(const Slice& key, std::string* value) {
   value->clear();
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, base_key.Encode(), value);
   std::string meta_value = *value;
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, meta_value)) {
     return Status::NotFound();
   }
+  if (s.ok()) {
+    s = ExpandBitmap(key, value);
+  }
   if (s.ok()) {
     ParsedStringsValue parsed_strings_value(value);
     if (parsed_strings_value.IsStale()) {
@@ -372,6 +395,38 @@ Status Redis::MGet(const Slice& key, std::string* value) {
   return s;
 }
 
+Status Redis::MGet(const std::vector<std::string>& keys, std::vector<ValueStatus>* vss) {
+  vss->clear();
+
+  std::vector<std::string> values;
+  std::vector<Status> statuses;
+  MultiGetMeta(default_read_options_, keys, &values, &statuses);
+  for (size_t idx = 0; idx < keys.size(); ++idx) {
+    Status& s = statuses[idx];
+    if (s.ok() && !ExpectedMetaValue(DataType::kStrings, values[idx])) {
+      s = Status::NotFound();
+    }
+    if (s.ok()) {
+      s = ExpandBitmap(keys[idx], &values[idx]);
+    }
+    if (s.ok()) {
+      ParsedStringsValue parsed_strings_value(&values[idx]);
+      if (parsed_strings_value.IsStale()) {
+        vss->push_back({std::string(), Status::NotFound()});
+      } else {
+        parsed_strings_value.StripSuffix();
+        vss->push_back({std::move(values[idx]), Status::OK()});
+      }
+    } else if (s.IsNotFound()) {
+      vss->push_back({std::string(), Status::NotFound()});
+    } else {
+      vss->clear();
+      return s;
+    }
+  }
+  return Status::OK();
+}
+
 void ClearValueAndSetTTL(std::string* value, int64_t* ttl, int64_t ttl_value) {
   value->clear();
   *ttl = ttl_value;
@@ -397,7 +452,7 @@ Status HandleParsedStringsValue(ParsedStringsValue& parsed_strings_value, std::s
 
 Status Redis::GetWithTTL(const Slice& key, std::string* value, int64_t* ttl) {
   value->clear();
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, base_key.Encode(), value);
   std::string meta_value = *value;
 
@@ -412,6 +467,9 @@ Status Redis::GetWithTTL(const Slice& key, std::string* value, int64_t* ttl) {
     }
   }
 
+  if (s.ok()) {
+    s = ExpandBitmap(key, value);
+  }
   if (s.ok()) {
     ParsedStringsValue parsed_strings_value(value);
     return HandleParsedStringsValue(parsed_strings_value, value, ttl);
@@ -424,7 +482,7 @@ Status Redis::GetWithTTL(const Slice& key, std::string* value, int64_t* ttl) {
 
 Status Redis::MGetWithTTL(const Slice& key, std::string* value, int64_t* ttl) {
   value->clear();
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, base_key.Encode(), value);
   std::string meta_value = *value;
 
@@ -432,6 +490,9 @@ Status Redis::MGetWithTTL(const Slice& key, std::string* value, int64_t* ttl) {
     s = Status::NotFound();
   }
 
+  if (s.ok()) {
+    s = ExpandBitmap(key, value);
+  }
   if (s.ok()) {
     ParsedStringsValue parsed_strings_value(value);
     return HandleParsedStringsValue(parsed_strings_value, value, ttl);
@@ -442,10 +503,43 @@ Status Redis::MGetWithTTL(const Slice& key, std::string* value, int64_t* ttl) {
   return s;
 }
 
+Status Redis::MGetWithTTL(const std::vector<std::string>& keys, std::vector<ValueStatus>* vss) {
+  vss->clear();
+
+  int64_t ttl = -2;
+  std::vector<std::string> values;
+  std::vector<Status> statuses;
+  MultiGetMeta(default_read_options_, keys, &values, &statuses);
+  for (size_t idx = 0; idx < keys.size(); ++idx) {
+    Status& s = statuses[idx];
+    if (s.ok() && !ExpectedMetaValue(DataType::kStrings, values[idx])) {
+      s = Status::NotFound();
+    }
+    if (s.ok()) {
+      s = ExpandBitmap(keys[idx], &values[idx]);
+    }
+    if (s.ok()) {
+      ParsedStringsValue parsed_strings_value(&values[idx]);
+      s = HandleParsedStringsValue(parsed_strings_value, &values[idx], &ttl);
+    } else if (s.IsNotFound()) {
+      ClearValueAndSetTTL(&values[idx], &ttl, -2);
+    }
+    if (s.ok()) {
+      vss->push_back({std::move(values[idx]), Status::OK(), ttl});
+    } else if (s.IsNotFound()) {
+      vss->push_back({std::string(), Status::NotFound(), ttl});
+    } else {
+      vss->clear();
+      return s;
+    }
+  }
+  return Status::OK();
+}
+
 Status Redis::GetBit(const Slice& key, int64_t offset, int32_t* ret) {
   std::string meta_value;
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, base_key.Encode(), &meta_value);
   if (s.ok() || s.IsNotFound()) {
     std::string data_value;
@@ -459,17 +553,31 @@ Status Redis::GetBit(const Slice& key, int64_t offset, int32_t* ret) {
           DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
       }
     }
+    size_t byte = offset >> 3;
+    size_t bit = 7 - (offset & 0x7);
     if (s.ok()) {
       ParsedStringsValue parsed_strings_value(&meta_value);
       if (parsed_strings_value.IsStale()) {
         *ret = 0;
         return Status::OK();
+      } else if (parsed_strings_value.IsBitmap()) {
+        if (byte + 1 > parsed_strings_value.BitmapLength()) {
+          *ret = 0;
+          return Status::OK();
+        }
+        // Only the segment of the bit is read
+        uint64_t segment = BitmapSegments::SegmentOf(byte);
+        BitmapSegments segments(db_, handles_[kBitmapsDataCF], default_read_options_, key,
+                                parsed_strings_value.BitmapVersion(), slot_key_prefix_num_);
+        s = segments.Read(segment, &data_value);
+        if (!s.ok()) {
+          return s;
+        }
+        byte -= BitmapSegments::SegmentStart(segment);
       } else {
         data_value = parsed_strings_value.UserValue().ToString();
       }
     }
-    size_t byte = offset >> 3;
-    size_t bit = 7 - (offset & 0x7);
     if (byte + 1 > data_value.length()) {
       *ret = 0;
     } else {
@@ -485,7 +593,7 @@ Status Redis::Getrange(const Slice& key, int64_t start_offset, int64_t end_offse
   *ret = "";
   std::string value;
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, base_key.Encode(), &value);
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, value)) {
     if (ExpectedStale(value)) {
@@ -497,6 +605,9 @@ Status Redis::Getrange(const Slice& key, int64_t start_offset, int64_t end_offse
         DataTypeStrings[static_cast<int>(GetMetaValueType(value))]);
     }
   }
+  if (s.ok()) {
+    s = ExpandBitmap(key, &value);
+  }
   if (s.ok()) {
     ParsedStringsValue parsed_strings_value(&value);
     if (parsed_strings_value.IsStale()) {
@@ -529,7 +640,7 @@ Status Redis::Getrange(const Slice& key, int64_t start_offset, int64_t end_offse
 Status Redis::GetrangeWithValue(const Slice& key, int64_t start_offset, int64_t end_offset,
                                 std::string* ret, std::string* value, int64_t* ttl) {
   *ret = "";
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, base_key.Encode(), value);
   std::string meta_value = *value;
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, meta_value)) {
@@ -542,6 +653,9 @@ Status Redis::GetrangeWithValue(const Slice& key, int64_t start_offset, int64_t
           DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.ok()) {
+    s = ExpandBitmap(key, value);
+  }
   if (s.ok()) {
     ParsedStringsValue parsed_strings_value(value);
     if (parsed_strings_value.IsStale()) {
@@ -591,7 +705,7 @@ Status Redis::GetrangeWithValue(const Slice& key, int64_t start_offset, int64_t
 Status Redis::GetSet(const Slice& key, const Slice& value, std::string* old_value) {
   ScopeRecordLock l(lock_mgr_, key);
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, base_key.Encode(), old_value);
   std::string meta_value = *old_value;
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, meta_value)) {
@@ -604,6 +718,9 @@ Status Redis::GetSet(const Slice& key, const Slice& value, std::string* old_valu
           DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.ok()) {
+    s = ExpandBitmap(key, old_value);
+  }
   if (s.ok()) {
     ParsedStringsValue parsed_strings_value(old_value);
     if (parsed_strings_value.IsStale()) {
@@ -623,7 +740,7 @@ Status Redis::Incrby(const Slice& key, int64_t value, int64_t* ret) {
   std::string new_value;
   ScopeRecordLock l(lock_mgr_, key);
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, base_key.Encode(), &old_value);
   char buf[32] = {0};
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, old_value)) {
@@ -636,6 +753,9 @@ Status Redis::Incrby(const Slice& key, int64_t value, int64_t* ret) {
         DataTypeStrings[static_cast<int>(GetMetaValueType(old_value))]);
     }
   }
+  if (s.ok()) {
+    s = ExpandBitmap(key, &old_value);
+  }
   if (s.ok()) {
     ParsedStringsValue parsed_strings_value(&old_value);
     if (parsed_strings_value.IsStale()) {
@@ -678,7 +798,7 @@ Status Redis::Incrbyfloat(const Slice& key, const Slice& value, std::string* ret
     return Status::Corruption("Value is not a vaild float");
   }
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   ScopeRecordLock l(lock_mgr_, key);
   Status s = db_->Get(default_read_options_, base_key.Encode(), &old_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, old_value)) {
@@ -691,6 +811,9 @@ Status Redis::Incrbyfloat(const Slice& key, const Slice& value, std::string* ret
         DataTypeStrings[static_cast<int>(GetMetaValueType(old_value))]);
     }
   }
+  if (s.ok()) {
+    s = ExpandBitmap(key, &old_value);
+  }
   if (s.ok()) {
     ParsedStringsValue parsed_strings_value(&old_value);
     if (parsed_strings_value.IsStale()) {
@@ -735,7 +858,7 @@ Status Redis::MSet(const std::vector<KeyValue>& kvs) {
   MultiScopeRecordLock ml(lock_mgr_, keys);
   rocksdb::WriteBatch batch;
   for (const auto& kv : kvs) {
-    BaseKey base_key(kv.key);
+    BaseKey base_key(kv.key, slot_key_prefix_num_);
     StringsValue strings_value(kv.value);
     batch.Put(base_key.Encode(), strings_value.Encode());
   }
@@ -748,7 +871,7 @@ Status Redis::MSetnx(const std::vector<KeyValue>& kvs, int32_t* ret) {
   *ret = 0;
   std::string value;
   for (const auto & kv : kvs) {
-    BaseKey base_key(kv.key);
+    BaseKey base_key(kv.key, slot_key_prefix_num_);
     s = db_->Get(default_read_options_, base_key.Encode(), &value);
     if (!s.ok() && !s.IsNotFound()) {
       return s;
@@ -772,7 +895,7 @@ Status Redis::Set(const Slice& key, const Slice& value) {
   StringsValue strings_value(value);
   ScopeRecordLock l(lock_mgr_, key);
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   return db_->Put(default_write_options_, base_key.Encode(), strings_value.Encode());
 }
 
@@ -781,7 +904,7 @@ Status Redis::Setxx(const Slice& key, const Slice& value, int32_t* ret, int64_t
   std::string old_value;
   StringsValue strings_value(value);
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   ScopeRecordLock l(lock_mgr_, key);
   Status s = db_->Get(default_read_options_, base_key.Encode(), &old_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, old_value)) {
@@ -811,7 +934,8 @@ Status Redis::Setxx(const Slice& key, const Slice& value, int32_t* ret, int64_t
     if (ttl > 0) {
       strings_value.SetRelativeTimestamp(ttl);
     }
-    return db_->Put(default_write_options_, base_key.Encode(), strings_value.Encode());
+    return PutWithExpireIndex(key, base_key.Encode(), strings_value.Encode(), strings_value.Etime(),
+                              MetaValueEtime(old_value));
   }
 }
 
@@ -821,7 +945,7 @@ Status Redis::SetBit(const Slice& key, int64_t offset, int32_t on, int32_t* ret)
     return Status::InvalidArgument("offset < 0");
   }
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   ScopeRecordLock l(lock_mgr_, key);
   Status s = db_->Get(default_read_options_, base_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, meta_value)) {
@@ -840,6 +964,9 @@ Status Redis::SetBit(const Slice& key, int64_t offset, int32_t on, int32_t* ret)
     if (s.ok()) {
       ParsedStringsValue parsed_strings_value(&meta_value);
       if (!parsed_strings_value.IsStale()) {
+        if (parsed_strings_value.IsBitmap()) {
+          return BitmapSetBit(key, &parsed_strings_value, offset, on, ret);
+        }
         data_value = parsed_strings_value.UserValue().ToString();
         timestamp = parsed_strings_value.Etime();
       }
@@ -860,6 +987,28 @@ Status Redis::SetBit(const Slice& key, int64_t offset, int32_t on, int32_t* ret)
     }
     byte_val = static_cast<char>(byte_val & (~(1 << bit)));
     byte_val = static_cast<char>(byte_val | ((on & 0x1) << bit));
+    if (std::max(byte + 1, value_lenth) > kBitmapSegmentSize) {
+      // Past one segment the string becomes a bitmap, see bitmap_segments.h
+      rocksdb::WriteBatch batch;
+      uint64_t version = pstd::NowMicros();
+      BitmapSegments segments(db_, handles_[kBitmapsDataCF], default_read_options_, key, version, slot_key_prefix_num_);
+      uint64_t segment = BitmapSegments::SegmentOf(byte);
+      uint64_t segment_start = BitmapSegments::SegmentStart(segment);
+      if (segment_start < value_lenth) {
+        data_value.resize(std::max(byte + 1, value_lenth), '\0');
+        data_value[byte] = byte_val;
+        segments.WriteAll(data_value, &batch);
+      } else {
+        segments.WriteAll(data_value, &batch);
+        std::string bytes(byte - segment_start + 1, '\0');
+        bytes.back() = byte_val;
+        segments.Write(segment, bytes, &batch);
+      }
+      BitmapMetaValue bitmap_meta(std::max(byte + 1, value_lenth), version);
+      bitmap_meta.SetEtime(timestamp);
+      batch.Put(handles_[kMetaCF], base_key.Encode(), bitmap_meta.Encode());
+      return db_->Write(default_write_options_, &batch);
+    }
     if (byte + 1 <= value_lenth) {
       data_value.replace(byte, 1, &byte_val, 1);
     } else {
@@ -874,6 +1023,80 @@ Status Redis::SetBit(const Slice& key, int64_t offset, int32_t on, int32_t* ret)
   }
 }
 
+Status Redis::BitmapSetBit(const Slice& key, ParsedStringsValue* parsed_strings_value, int64_t offset, int32_t on,
+                           int32_t* ret) {
+  uint64_t length = parsed_strings_value->BitmapLength();
+  uint64_t version = parsed_strings_value->BitmapVersion();
+  uint64_t byte = offset >> 3;
+  size_t bit = 7 - (offset & 0x7);
+  uint64_t segment = BitmapSegments::SegmentOf(byte);
+  size_t pos = byte - BitmapSegments::SegmentStart(segment);
+
+  std::string bytes;
+  BitmapSegments segments(db_, handles_[kBitmapsDataCF], default_read_options_, key, version, slot_key_prefix_num_);
+  Status s = segments.Read(segment, &bytes);
+  if (!s.ok()) {
+    return s;
+  }
+  *ret = pos < bytes.size() ? ((bytes[pos] & (1 << bit)) >> bit) : 0;
+  if (*ret == on) {
+    return Status::OK();
+  }
+  if (pos >= bytes.size()) {
+    bytes.resize(pos + 1, '\0');
+  }
+  bytes[pos] = static_cast<char>(bytes[pos] & (~(1 << bit)));
+  bytes[pos] = static_cast<char>(bytes[pos] | ((on & 0x1) << bit));
+
+  rocksdb::WriteBatch batch;
+  segments.Write(segment, bytes, &batch);
+  if (byte + 1 > length) {
+    BaseKey base_key(key, slot_key_prefix_num_);
+    BitmapMetaValue bitmap_meta(byte + 1, version);
+    bitmap_meta.SetEtime(parsed_strings_value->Etime());
+    batch.Put(handles_[kMetaCF], base_key.Encode(), bitmap_meta.Encode());
+  }
+  return db_->Write(default_write_options_, &batch);
+}
+
+Status Redis::ExpandBitmap(const Slice& key, std::string* value) {
+  ParsedStringsValue parsed_strings_value(value);
+  if (!parsed_strings_value.IsBitmap() || parsed_strings_value.IsStale()) {
+    return Status::OK();
+  }
+  // The value was read without a snapshot, read the meta again along with
+  // the segments so that a concurrent SETBIT cannot tear the bitmap
+  rocksdb::ReadOptions read_options;
+  const rocksdb::Snapshot* snapshot;
+  ScopeSnapshot ss(db_, &snapshot);
+  read_options.snapshot = snapshot;
+  std::string meta_value;
+  BaseKey base_key(key, slot_key_prefix_num_);
+  Status s = db_->Get(read_options, base_key.Encode(), &meta_value);
+  if (!s.ok()) {
+    return s;
+  }
+  if (!ExpectedMetaValue(DataType::kStrings, meta_value)) {
+    return Status::NotFound();
+  }
+  ParsedStringsValue parsed_meta_value(&meta_value);
+  if (!parsed_meta_value.IsBitmap() || parsed_meta_value.IsStale()) {
+    *value = std::move(meta_value);
+    return Status::OK();
+  }
+  std::string bytes;
+  BitmapSegments segments(db_, handles_[kBitmapsDataCF], read_options, key, parsed_meta_value.BitmapVersion(),
+                          slot_key_prefix_num_);
+  s = segments.Assemble(parsed_meta_value.BitmapLength(), &bytes);
+  if (!s.ok()) {
+    return s;
+  }
+  StringsValue strings_value(bytes);
+  strings_value.SetEtime(parsed_meta_value.Etime());
+  *value = strings_value.Encode().ToString();
+  return Status::OK();
+}
+
 Status Redis::Setex(const Slice& key, const Slice& value, int64_t ttl) {
   if (ttl <= 0) {
     return Status::InvalidArgument("invalid expire time");
@@ -884,16 +1107,22 @@ Status Redis::Setex(const Slice& key, const Slice& value, int64_t ttl) {
     return s;
   }
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   ScopeRecordLock l(lock_mgr_, key);
-  return db_->Put(default_write_options_, base_key.Encode(), strings_value.Encode());
+  std::string old_value;
+  s = db_->Get(default_read_options_, base_key.Encode(), &old_value);
+  if (!s.ok() && !s.IsNotFound()) {
+    return s;
+  }
+  return PutWithExpireIndex(key, base_key.Encode(), strings_value.Encode(), strings_value.Etime(),
+                            MetaValueEtime(old_value));
 }
 
 Status Redis::Setnx(const Slice& key, const Slice& value, int32_t* ret, int64_t ttl) {
   *ret = 0;
   std::string old_value;
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   ScopeRecordLock l(lock_mgr_, key);
   Status s = db_->Get(default_read_options_, base_key.Encode(), &old_value);
   if (!s.ok() && !s.IsNotFound()) {
@@ -909,7 +1138,8 @@ Status Redis::Setnx(const Slice& key, const Slice& value, int32_t* ret, int64_t
   if (ttl > 0) {
     strings_value.SetRelativeTimestamp(ttl);
   }
-  s = db_->Put(default_write_options_, base_key.Encode(), strings_value.Encode());
+  s = PutWithExpireIndex(key, base_key.Encode(), strings_value.Encode(), strings_value.Etime(),
+                         MetaValueEtime(old_value));
   if (s.ok()) {
     *ret = 1;
   }
@@ -921,7 +1151,7 @@ Status Redis::Setvx(const Slice& key, const Slice& value, const Slice& new_value
   *ret = 0;
   std::string old_value;
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   ScopeRecordLock l(lock_mgr_, key);
   Status s = db_->Get(default_read_options_, base_key.Encode(), &old_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, old_value)) {
@@ -934,6 +1164,9 @@ Status Redis::Setvx(const Slice& key, const Slice& value, const Slice& new_value
         DataTypeStrings[static_cast<int>(GetMetaValueType(old_value))]);
     }
   }
+  if (s.ok()) {
+    s = ExpandBitmap(key, &old_value);
+  }
   if (s.ok()) {
     ParsedStringsValue parsed_strings_value(&old_value);
     if (parsed_strings_value.IsStale()) {
@@ -944,7 +1177,8 @@ Status Redis::Setvx(const Slice& key, const Slice& value, const Slice& new_value
         if (ttl > 0) {
           strings_value.SetRelativeTimestamp(ttl);
         }
-        s = db_->Put(default_write_options_, base_key.Encode(), strings_value.Encode());
+        s = PutWithExpireIndex(key, base_key.Encode(), strings_value.Encode(), strings_value.Etime(),
+                               parsed_strings_value.Etime());
         if (!s.ok()) {
           return s;
         }
@@ -965,7 +1199,7 @@ Status Redis::Delvx(const Slice& key, const Slice& value, int32_t* ret) {
   *ret = 0;
   std::string old_value;
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   ScopeRecordLock l(lock_mgr_, key);
   Status s = db_->Get(default_read_options_, base_key.Encode(), &old_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, old_value)) {
@@ -978,6 +1212,9 @@ Status Redis::Delvx(const Slice& key, const Slice& value, int32_t* ret) {
         DataTypeStrings[static_cast<int>(GetMetaValueType(old_value))]);
     }
   }
+  if (s.ok()) {
+    s = ExpandBitmap(key, &old_value);
+  }
   if (s.ok()) {
     ParsedStringsValue parsed_strings_value(&old_value);
     if (parsed_strings_value.IsStale()) {
@@ -1005,7 +1242,7 @@ Status Redis::Setrange(const Slice& key, int64_t start_offset, const Slice& valu
   }
   ScopeRecordLock l(lock_mgr_, key);
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, base_key.Encode(), &old_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, old_value)) {
     if (ExpectedStale(old_value)) {
@@ -1017,6 +1254,9 @@ Status Redis::Setrange(const Slice& key, int64_t start_offset, const Slice& valu
         DataTypeStrings[static_cast<int>(GetMetaValueType(old_value))]);
     }
   }
+  if (s.ok()) {
+    s = ExpandBitmap(key, &old_value);
+  }
   if (s.ok()) {
     uint64_t timestamp = 0;
     ParsedStringsValue parsed_strings_value(&old_value);
@@ -1054,68 +1294,84 @@ Status Redis::Setrange(const Slice& key, int64_t start_offset, const Slice& valu
 }
 
 Status Redis::Strlen(const Slice& key, int32_t* len) {
+  *len = 0;
   std::string value;
-  Status s = Get(key, &value);
+
+  BaseKey base_key(key, slot_key_prefix_num_);
+  Status s = db_->Get(default_read_options_, base_key.Encode(), &value);
+  if (s.ok() && !ExpectedMetaValue(DataType::kStrings, value)) {
+    if (ExpectedStale(value)) {
+      s = Status::NotFound();
+    } else {
+      return Status::InvalidArgument(
+        "WRONGTYPE, key: " + key.ToString() + ", expect type: " +
+        DataTypeStrings[static_cast<int>(DataType::kStrings)] + ", get type: " +
+        DataTypeStrings[static_cast<int>(GetMetaValueType(value))]);
+    }
+  }
   if (s.ok()) {
-    *len = static_cast<int32_t>(value.size());
-  } else {
-    *len = 0;
+    ParsedStringsValue parsed_strings_value(&value);
+    if (parsed_strings_value.IsStale()) {
+      return Status::NotFound("Stale");
+    }
+    // No segment is read for a bitmap, its meta has the length
+    *len = static_cast<int32_t>(parsed_strings_value.IsBitmap() ? parsed_strings_value.BitmapLength()
+                                                                : parsed_strings_value.UserValue().size());
   }
   return s;
 }
 
-int32_t GetBitPos(const unsigned char* s, unsigned int bytes, int bit) {
-  uint64_t word = 0;
-  uint64_t skip_val = 0;
-  auto value = const_cast<unsigned char*>(s);
-  auto l = reinterpret_cast<uint64_t*>(value);
-  int pos = 0;
-  if (bit == 0) {
-    skip_val = std::numeric_limits<uint64_t>::max();
-  } else {
-    skip_val = 0;
+// Like BitmapFindBit, but 8 * bytes when there is no bit 0
+int64_t GetBitPos(const unsigned char* s, int64_t bytes, int bit) {
+  int64_t pos = BitmapFindBit(s, bytes, bit);
+  if (pos == -1 && bit == 0) {
+    return 8 * bytes;
   }
-  // skip 8 bytes at one time, find the first int64 that should not be skipped
-  while (bytes >= sizeof(*l)) {
-    if (*l != skip_val) {
-      break;
-    }
-    l++;
-    bytes = bytes - sizeof(*l);
-    pos += static_cast<int32_t>(8 * sizeof(*l));
-  }
-  auto c = reinterpret_cast<unsigned char*>(l);
-  for (size_t j = 0; j < sizeof(*l); j++) {
-    word = word << 8;
-    if (bytes != 0U) {
-      word = word | *c;
-      c++;
-      bytes--;
-    }
-  }
-  if (bit == 1 && word == 0) {
-    return -1;
+  return pos;
+}
+
+Status Redis::BitmapBitPos(const rocksdb::ReadOptions& read_options, const Slice& key, uint64_t version,
+                           int64_t start_offset, int64_t bytes, int32_t bit, int64_t* pos) {
+  auto first = static_cast<uint64_t>(start_offset);
+  uint64_t last = first + bytes - 1;
+  // Every bit before next is not bit
+  uint64_t next = first;
+  int64_t found = -1;
+  BitmapSegments segments(db_, handles_[kBitmapsDataCF], read_options, key, version, slot_key_prefix_num_);
+  Status s = segments.Scan(first, last, [&](uint64_t offset, const Slice& data) {
+    if (bit == 0 && offset > next) {
+      found = static_cast<int64_t>(8 * (next - first));
+      return false;
+    }
+    int64_t data_pos = BitmapFindBit(reinterpret_cast<const unsigned char*>(data.data()), data.size(), bit);
+    if (data_pos != -1) {
+      found = static_cast<int64_t>(8 * (offset - first)) + data_pos;
+      return false;
+    }
+    next = offset + data.size();
+    return true;
+  });
+  if (!s.ok()) {
+    return s;
   }
-  // set each bit of mask to 0 except msb
-  uint64_t mask = std::numeric_limits<uint64_t>::max();
-  mask = mask >> 1;
-  mask = ~(mask);
-  while (mask != 0U) {
-    if (static_cast<int>((word & mask) != 0) == bit) {
-      return pos;
-    }
-    pos++;
-    mask = mask >> 1;
+  if (found == -1 && bit == 0) {
+    // The bytes after the last stored one are zero
+    found = static_cast<int64_t>(8 * (next - first));
   }
-  return pos;
+  *pos = found;
+  return Status::OK();
 }
 
 Status Redis::BitPos(const Slice& key, int32_t bit, int64_t* ret) {
   Status s;
   std::string value;
+  rocksdb::ReadOptions read_options;
+  const rocksdb::Snapshot* snapshot;
+  ScopeSnapshot ss(db_, &snapshot);
+  read_options.snapshot = snapshot;
 
-  BaseKey base_key(key);
-  s = db_->Get(default_read_options_, base_key.Encode(), &value);
+  BaseKey base_key(key, slot_key_prefix_num_);
+  s = db_->Get(read_options, base_key.Encode(), &value);
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, value)) {
     if (ExpectedStale(value)) {
       s = Status::NotFound();
@@ -1136,13 +1392,24 @@ Status Redis::BitPos(const Slice& key, int32_t bit, int64_t* ret) {
       }
       return Status::NotFound("Stale");
     } else {
+      bool is_bitmap = parsed_strings_value.IsBitmap();
+      uint64_t version = is_bitmap ? parsed_strings_value.BitmapVersion() : 0;
+      auto value_length = static_cast<int64_t>(is_bitmap ? parsed_strings_value.BitmapLength()
+                                                         : parsed_strings_value.UserValue().size());
       parsed_strings_value.StripSuffix();
       const auto bit_value = reinterpret_cast<const unsigned char*>(value.data());
-      auto value_length = static_cast<int64_t>(value.length());
       int64_t start_offset = 0;
       int64_t end_offset = std::max(value_length - 1, static_cast<int64_t>(0));
       int64_t bytes = end_offset - start_offset + 1;
-      int64_t pos = GetBitPos(bit_value + start_offset, bytes, bit);
+      int64_t pos = 0;
+      if (is_bitmap) {
+        s = BitmapBitPos(read_options, key, version, start_offset, bytes, bit, &pos);
+        if (!s.ok()) {
+          return s;
+        }
+      } else {
+        pos = GetBitPos(bit_value + start_offset, bytes, bit);
+      }
       if (pos == (8 * bytes) && bit == 0) {
         pos = -1;
       }
@@ -1160,9 +1427,13 @@ Status Redis::BitPos(const Slice& key, int32_t bit, int64_t* ret) {
 Status Redis::BitPos(const Slice& key, int32_t bit, int64_t start_offset, int64_t* ret) {
   Status s;
   std::string value;
+  rocksdb::ReadOptions read_options;
+  const rocksdb::Snapshot* snapshot;
+  ScopeSnapshot ss(db_, &snapshot);
+  read_options.snapshot = snapshot;
 
-  BaseKey base_key(key);
-  s = db_->Get(default_read_options_, base_key.Encode(), &value);
+  BaseKey base_key(key, slot_key_prefix_num_);
+  s = db_->Get(read_options, base_key.Encode(), &value);
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, value)) {
     if (ExpectedStale(value)) {
       s = Status::NotFound();
@@ -1183,9 +1454,12 @@ Status Redis::BitPos(const Slice& key, int32_t bit, int64_t start_offset, int64_
       }
       return Status::NotFound("Stale");
     } else {
+      bool is_bitmap = parsed_strings_value.IsBitmap();
+      uint64_t version = is_bitmap ? parsed_strings_value.BitmapVersion() : 0;
+      auto value_length = static_cast<int64_t>(is_bitmap ? parsed_strings_value.BitmapLength()
+                                                         : parsed_strings_value.UserValue().size());
       parsed_strings_value.StripSuffix();
       const auto bit_value = reinterpret_cast<const unsigned char*>(value.data());
-      auto value_length = static_cast<int64_t>(value.length());
       int64_t end_offset = std::max(value_length - 1, static_cast<int64_t>(0));
       if (start_offset < 0) {
         start_offset = start_offset + value_length;
@@ -1202,7 +1476,15 @@ Status Redis::BitPos(const Slice& key, int32_t bit, int64_t start_offset, int64_
         return Status::OK();
       }
       int64_t bytes = end_offset - start_offset + 1;
-      int64_t pos = GetBitPos(bit_value + start_offset, bytes, bit);
+      int64_t pos = 0;
+      if (is_bitmap) {
+        s = BitmapBitPos(read_options, key, version, start_offset, bytes, bit, &pos);
+        if (!s.ok()) {
+          return s;
+        }
+      } else {
+        pos = GetBitPos(bit_value + start_offset, bytes, bit);
+      }
       if (pos == (8 * bytes) && bit == 0) {
         pos = -1;
       }
@@ -1220,9 +1502,13 @@ Status Redis::BitPos(const Slice& key, int32_t bit, int64_t start_offset, int64_
 Status Redis::BitPos(const Slice& key, int32_t bit, int64_t start_offset, int64_t end_offset, int64_t* ret) {
   Status s;
   std::string value;
+  rocksdb::ReadOptions read_options;
+  const rocksdb::Snapshot* snapshot;
+  ScopeSnapshot ss(db_, &snapshot);
+  read_options.snapshot = snapshot;
 
-  BaseKey base_key(key);
-  s = db_->Get(default_read_options_, base_key.Encode(), &value);
+  BaseKey base_key(key, slot_key_prefix_num_);
+  s = db_->Get(read_options, base_key.Encode(), &value);
   if (s.ok() && !ExpectedMetaValue(DataType::kStrings, value)) {
     if (ExpectedStale(value)) {
       s = Status::NotFound();
@@ -1243,9 +1529,12 @@ Status Redis::BitPos(const Slice& key, int32_t bit, int64_t start_offset, int64_
       }
       return Status::NotFound("Stale");
     } else {
+      bool is_bitmap = parsed_strings_value.IsBitmap();
+      uint64_t version = is_bitmap ? parsed_strings_value.BitmapVersion() : 0;
+      auto value_length = static_cast<int64_t>(is_bitmap ? parsed_strings_value.BitmapLength()
+                                                         : parsed_strings_value.UserValue().size());
       parsed_strings_value.StripSuffix();
       const auto bit_value = reinterpret_cast<const unsigned char*>(value.data());
-      auto value_length = static_cast<int64_t>(value.length());
       if (start_offset < 0) {
         start_offset = start_offset + value_length;
       }
@@ -1255,8 +1544,7 @@ Status Redis::BitPos(const Slice& key, int32_t bit, int64_t start_offset, int64_
       if (end_offset < 0) {
         end_offset = end_offset + value_length;
       }
-      // converting to int64_t just avoid warning
-      if (end_offset > static_cast<int64_t>(value.length()) - 1) {
+      if (end_offset > value_length - 1) {
         end_offset = value_length - 1;
       }
       if (end_offset < 0) {
@@ -1271,7 +1559,15 @@ Status Redis::BitPos(const Slice& key, int32_t bit, int64_t start_offset, int64_
         return Status::OK();
       }
       int64_t bytes = end_offset - start_offset + 1;
-      int64_t pos = GetBitPos(bit_value + start_offset, bytes, bit);
+      int64_t pos = 0;
+      if (is_bitmap) {
+        s = BitmapBitPos(read_options, key, version, start_offset, bytes, bit, &pos);
+        if (!s.ok()) {
+          return s;
+        }
+      } else {
+        pos = GetBitPos(bit_value + start_offset, bytes, bit);
+      }
       if (pos == (8 * bytes) && bit == 0) {
         pos = -1;
       }
@@ -1290,16 +1586,22 @@ Status Redis::BitPos(const Slice& key, int32_t bit, int64_t start_offset, int64_
 Status Redis::PKSetexAt(const Slice& key, const Slice& value, int64_t timestamp) {
   StringsValue strings_value(value);
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   ScopeRecordLock l(lock_mgr_, key);
+  std::string old_value;
+  Status s = db_->Get(default_read_options_, base_key.Encode(), &old_value);
+  if (!s.ok() && !s.IsNotFound()) {
+    return s;
+  }
   strings_value.SetEtime(uint64_t(timestamp));
-  return db_->Put(default_write_options_, base_key.Encode(), strings_value.Encode());
+  return PutWithExpireIndex(key, base_key.Encode(), strings_value.Encode(), strings_value.Etime(),
+                            MetaValueEtime(old_value));
 }
 
 Status Redis::StringsExpire(const Slice& key, int64_t ttl, std::string&& prefetch_meta) {
   std::string value(std::move(prefetch_meta));
 
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   ScopeRecordLock l(lock_mgr_, key);
   Status s;
   // value is empty means no meta value get before,
@@ -1323,8 +1625,9 @@ Status Redis::StringsExpire(const Slice& key, int64_t ttl, std::string&& prefetc
       return Status::NotFound("Stale");
     }
     if (ttl > 0) {
+      uint64_t old_etime = parsed_strings_value.Etime();
       parsed_strings_value.SetRelativeTimestamp(ttl);
-      return db_->Put(default_write_options_, base_key.Encode(), value);
+      return PutWithExpireIndex(key, base_key.Encode(), value, parsed_strings_value.Etime(), old_etime);
     } else {
       return db_->Delete(default_write_options_, base_key.Encode());
     }
@@ -1335,7 +1638,7 @@ Status Redis::StringsExpire(const Slice& key, int64_t ttl, std::string&& prefetc
 Status Redis::StringsDel(const Slice& key, std::string&& prefetch_meta) {
   std::string value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   Status s;
 
   // value is empty means no meta value get before,
@@ -1366,7 +1669,7 @@ Status Redis::StringsDel(const Slice& key, std::string&& prefetch_meta) {
 Status Redis::StringsExpireat(const Slice& key, int64_t timestamp, std::string&& prefetch_meta) {
   std::string value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   Status s;
 
   // value is empty means no meta value get before,
@@ -1390,8 +1693,9 @@ Status Redis::StringsExpireat(const Slice& key, int64_t timestamp, std::string&&
       return Status::NotFound("Stale");
     } else {
       if (timestamp > 0) {
+        uint64_t old_etime = parsed_strings_value.Etime();
         parsed_strings_value.SetEtime(static_cast<uint64_t>(timestamp));
-        return db_->Put(default_write_options_, base_key.Encode(), value);
+        return PutWithExpireIndex(key, base_key.Encode(), value, parsed_strings_value.Etime(), old_etime);
       } else {
         return db_->Delete(default_write_options_, base_key.Encode());
       }
@@ -1403,7 +1707,7 @@ Status Redis::StringsExpireat(const Slice& key, int64_t timestamp, std::string&&
 Status Redis::StringsPersist(const Slice& key, std::string&& prefetch_meta) {
   std::string value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   Status s;
 
   // value is empty means no meta value get before,
@@ -1431,7 +1735,7 @@ Status Redis::StringsPersist(const Slice& key, std::string&& prefetch_meta) {
         return Status::NotFound("Not have an associated timeout");
       } else {
         parsed_strings_value.SetEtime(0);
-        return db_->Put(default_write_options_, base_key.Encode(), value);
+        return PutWithExpireIndex(key, base_key.Encode(), value, 0, timestamp);
       }
     }
   }
@@ -1441,7 +1745,7 @@ Status Redis::StringsPersist(const Slice& key, std::string&& prefetch_meta) {
 Status Redis::StringsTTL(const Slice& key, int64_t* timestamp, std::string&& prefetch_meta) {
   std::string value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseKey base_key(key);
+  BaseKey base_key(key, slot_key_prefix_num_);
   Status s;
 
   // value is empty means no meta value get before,
@@ -1511,65 +1815,114 @@ void Redis::ScanStrings() {
 
 rocksdb::Status Redis::Exists(const Slice& key) {
   std::string meta_value;
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
+  rocksdb::Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
+  if (s.ok()) {
+    return ExistsWithMeta(key, std::move(meta_value));
+  }
+  return rocksdb::Status::NotFound();
+}
+
+rocksdb::Status Redis::Exists(const std::vector<std::string>& keys, int64_t* count) {
+  *count = 0;
+  std::vector<std::string> meta_values;
+  std::vector<Status> statuses;
+  MultiGetMeta(default_read_options_, keys, &meta_values, &statuses);
+  for (size_t idx = 0; idx < keys.size(); ++idx) {
+    if (!statuses[idx].ok()) {
+      continue;
+    }
+    rocksdb::Status s = ExistsWithMeta(keys[idx], std::move(meta_values[idx]));
+    if (s.ok()) {
+      (*count)++;
+    } else if (!s.IsNotFound()) {
+      return s;
+    }
+  }
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status Redis::ExistsWithMeta(const Slice& key, std::string&& meta_value) {
   uint64_t llen = 0;
   int32_t ret = 0;
-  BaseMetaKey base_meta_key(key);
   std::vector<storage::IdMessage> id_messages;
   storage::StreamScanArgs arg;
   storage::StreamUtils::StreamParseIntervalId("-", arg.start_sid, &arg.start_ex, 0);
   storage::StreamUtils::StreamParseIntervalId("+", arg.end_sid, &arg.end_ex, UINT64_MAX);
-  rocksdb::Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
-  if (s.ok()) {
-    auto type = static_cast<DataType>(static_cast<uint8_t>(meta_value[0]));
-    switch (type) {
-      case DataType::kSets:
-        return SCard(key, &ret, std::move(meta_value));
-      case DataType::kZSets:
-        return ZCard(key, &ret, std::move(meta_value));
-      case DataType::kHashes:
-        return HLen(key, &ret, std::move(meta_value));
-      case DataType::kLists:
-        return LLen(key, &llen, std::move(meta_value));
-      case DataType::kStreams:
-        return XRange(key, arg, id_messages, std::move(meta_value));
-      case DataType::kStrings:
-        return ExpectedStale(meta_value) ? rocksdb::Status::NotFound() : rocksdb::Status::OK();
-      default:
-        return rocksdb::Status::NotFound();
-    }
+  auto type = static_cast<DataType>(static_cast<uint8_t>(meta_value[0]));
+  switch (type) {
+    case DataType::kSets:
+      return SCard(key, &ret, std::move(meta_value));
+    case DataType::kZSets:
+      return ZCard(key, &ret, std::move(meta_value));
+    case DataType::kHashes:
+      return HLen(key, &ret, std::move(meta_value));
+    case DataType::kLists:
+      return LLen(key, &llen, std::move(meta_value));
+    case DataType::kStreams:
+      return XRange(key, arg, id_messages, std::move(meta_value));
+    case DataType::kStrings:
+      return ExpectedStale(meta_value) ? rocksdb::Status::NotFound() : rocksdb::Status::OK();
+    default:
+      return rocksdb::Status::NotFound();
   }
-  return rocksdb::Status::NotFound();
 }
 
 rocksdb::Status Redis::Del(const Slice& key) {
   std::string meta_value;
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok()) {
-    auto type = static_cast<DataType>(static_cast<uint8_t>(meta_value[0]));
-    switch (type) {
-      case DataType::kSets:
-        return SetsDel(key, std::move(meta_value));
-      case DataType::kZSets:
-        return ZsetsDel(key, std::move(meta_value));
-      case DataType::kHashes:
-        return HashesDel(key, std::move(meta_value));
-      case DataType::kLists:
-        return ListsDel(key, std::move(meta_value));
-      case DataType::kStrings:
-        return StringsDel(key, std::move(meta_value));
-      case DataType::kStreams:
-        return StreamsDel(key, std::move(meta_value));
-      default:
-        return rocksdb::Status::NotFound();
-    }
+    return DelWithMeta(key, std::move(meta_value));
   }
   return rocksdb::Status::NotFound();
 }
 
+rocksdb::Status Redis::Del(const std::vector<std::string>& keys, int64_t* count) {
+  *count = 0;
+  // a prefetched meta value is trusted by DelWithMeta, so a repeated key
+  // would be deleted and counted twice
+  std::vector<std::string> unique_keys;
+  std::unordered_set<std::string> seen;
+  for (const auto& key : keys) {
+    if (seen.insert(key).second) {
+      unique_keys.push_back(key);
+    }
+  }
+  std::vector<std::string> meta_values;
+  std::vector<Status> statuses;
+  MultiGetMeta(default_read_options_, unique_keys, &meta_values, &statuses);
+  for (size_t idx = 0; idx < unique_keys.size(); ++idx) {
+    if (statuses[idx].ok() && DelWithMeta(unique_keys[idx], std::move(meta_values[idx])).ok()) {
+      (*count)++;
+    }
+  }
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status Redis::DelWithMeta(const Slice& key, std::string&& meta_value) {
+  auto type = static_cast<DataType>(static_cast<uint8_t>(meta_value[0]));
+  switch (type) {
+    case DataType::kSets:
+      return SetsDel(key, std::move(meta_value));
+    case DataType::kZSets:
+      return ZsetsDel(key, std::move(meta_value));
+    case DataType::kHashes:
+      return HashesDel(key, std::move(meta_value));
+    case DataType::kLists:
+      return ListsDel(key, std::move(meta_value));
+    case DataType::kStrings:
+      return StringsDel(key, std::move(meta_value));
+    case DataType::kStreams:
+      return StreamsDel(key, std::move(meta_value));
+    default:
+      return rocksdb::Status::NotFound();
+  }
+}
+
 rocksdb::Status Redis::Expire(const Slice& key, int64_t ttl) {
   std::string meta_value;
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok()) {
     auto type = static_cast<DataType>(static_cast<uint8_t>(meta_value[0]));
@@ -1593,7 +1946,7 @@ rocksdb::Status Redis::Expire(const Slice& key, int64_t ttl) {
 
 rocksdb::Status Redis::Expireat(const Slice& key, int64_t ttl) {
   std::string meta_value;
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok()) {
     auto type = static_cast<DataType>(static_cast<uint8_t>(meta_value[0]));
@@ -1617,7 +1970,7 @@ rocksdb::Status Redis::Expireat(const Slice& key, int64_t ttl) {
 
 rocksdb::Status Redis::Persist(const Slice& key) {
   std::string meta_value;
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok()) {
     auto type = static_cast<DataType>(static_cast<uint8_t>(meta_value[0]));
@@ -1641,7 +1994,7 @@ rocksdb::Status Redis::Persist(const Slice& key) {
 
 rocksdb::Status Redis::TTL(const Slice& key, int64_t* timestamp) {
   std::string meta_value;
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok()) {
     auto type = static_cast<DataType>(static_cast<uint8_t>(meta_value[0]));
@@ -1665,7 +2018,7 @@ rocksdb::Status Redis::TTL(const Slice& key, int64_t* timestamp) {
 
 rocksdb::Status Redis::GetType(const storage::Slice& key, enum DataType& type) {
   std::string meta_value;
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok()) {
     type = static_cast<enum DataType>(static_cast<uint8_t>(meta_value[0]));
@@ -1675,7 +2028,7 @@ rocksdb::Status Redis::GetType(const storage::Slice& key, enum DataType& type) {
 
 rocksdb::Status Redis::IsExist(const storage::Slice& key) {
   std::string meta_value;
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   rocksdb::Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok()) {
     if (ExpectedStale(meta_value)) {
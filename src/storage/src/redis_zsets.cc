@@ -10,6 +10,7 @@
 #include <map>
 #include <memory>
 #include <iostream>
+#include <mutex>
 
 #include <glog/logging.h>
 #include <fmt/core.h>
@@ -71,7 +72,7 @@ Status Redis::ZPopMax(const Slice& key, const int64_t count, std::vector<ScoreMe
   ScopeRecordLock l(lock_mgr_, key);
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -93,7 +94,14 @@ Status Redis::ZPopMax(const Slice& key, const int64_t count, std::vector<ScoreMe
       int64_t num = parsed_zsets_meta_value.Count();
       num = num <= count ? num : count;
       uint64_t version = parsed_zsets_meta_value.Version();
-      ZSetsScoreKey zsets_score_key(key, version, std::numeric_limits<double>::max(), Slice());
+      std::shared_ptr<ZSetsRankIndex> rank_index = LookupZSetsRankIndex(key);
+      if (!CheckZSetsRankIndex(rank_index, key, version, parsed_zsets_meta_value.Count())) {
+        rank_index.reset();
+      }
+      std::vector<std::string> erased_score_keys;
+      // The last score key of version, whatever its score and member, is right before the first one of version + 1
+      ZSetsScoreKey zsets_score_key(key, version + 1, -std::numeric_limits<double>::infinity(), Slice(),
+                                    slot_key_prefix_num_);
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kZsetsScoreCF]);
       int32_t del_cnt = 0;
@@ -101,11 +109,14 @@ Status Redis::ZPopMax(const Slice& key, const int64_t count, std::vector<ScoreMe
         ParsedZSetsScoreKey parsed_zsets_score_key(iter->key());
         score_members->emplace_back(
             ScoreMember{parsed_zsets_score_key.score(), parsed_zsets_score_key.member().ToString()});
-        ZSetsMemberKey zsets_member_key(key, version, parsed_zsets_score_key.member());
+        ZSetsMemberKey zsets_member_key(key, version, parsed_zsets_score_key.member(), slot_key_prefix_num_);
         ++statistic;
         ++del_cnt;
         batch.Delete(handles_[kZsetsDataCF], zsets_member_key.Encode());
         batch.Delete(handles_[kZsetsScoreCF], iter->key());
+        if (rank_index != nullptr) {
+          erased_score_keys.push_back(iter->key().ToString());
+        }
       }
       delete iter;
       if (!parsed_zsets_meta_value.CheckModifyCount(-del_cnt)){
@@ -113,7 +124,7 @@ Status Redis::ZPopMax(const Slice& key, const int64_t count, std::vector<ScoreMe
       }
       parsed_zsets_meta_value.ModifyCount(-del_cnt);
       batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
-      s = db_->Write(default_write_options_, &batch);
+      s = WriteZSetsBatch(key, rank_index, &batch, erased_score_keys, {});
       UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
       return s;
     }
@@ -129,7 +140,7 @@ Status Redis::ZPopMin(const Slice& key, const int64_t count, std::vector<ScoreMe
   ScopeRecordLock l(lock_mgr_, key);
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -151,7 +162,13 @@ Status Redis::ZPopMin(const Slice& key, const int64_t count, std::vector<ScoreMe
       int64_t num = parsed_zsets_meta_value.Count();
       num = num <= count ? num : count;
       uint64_t version = parsed_zsets_meta_value.Version();
-      ZSetsScoreKey zsets_score_key(key, version, std::numeric_limits<double>::lowest(), Slice());
+      std::shared_ptr<ZSetsRankIndex> rank_index = LookupZSetsRankIndex(key);
+      if (!CheckZSetsRankIndex(rank_index, key, version, parsed_zsets_meta_value.Count())) {
+        rank_index.reset();
+      }
+      std::vector<std::string> erased_score_keys;
+      ZSetsScoreKey zsets_score_key(key, version, -std::numeric_limits<double>::infinity(), Slice(),
+                                    slot_key_prefix_num_);
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kZsetsScoreCF]);
       int32_t del_cnt = 0;
@@ -159,11 +176,14 @@ Status Redis::ZPopMin(const Slice& key, const int64_t count, std::vector<ScoreMe
         ParsedZSetsScoreKey parsed_zsets_score_key(iter->key());
         score_members->emplace_back(
             ScoreMember{parsed_zsets_score_key.score(), parsed_zsets_score_key.member().ToString()});
-        ZSetsMemberKey zsets_member_key(key, version, parsed_zsets_score_key.member());
+        ZSetsMemberKey zsets_member_key(key, version, parsed_zsets_score_key.member(), slot_key_prefix_num_);
         ++statistic;
         ++del_cnt;
         batch.Delete(handles_[kZsetsDataCF], zsets_member_key.Encode());
         batch.Delete(handles_[kZsetsScoreCF], iter->key());
+        if (rank_index != nullptr) {
+          erased_score_keys.push_back(iter->key().ToString());
+        }
       }
       delete iter;
       if (!parsed_zsets_meta_value.CheckModifyCount(-del_cnt)){
@@ -171,7 +191,7 @@ Status Redis::ZPopMin(const Slice& key, const int64_t count, std::vector<ScoreMe
       }
       parsed_zsets_meta_value.ModifyCount(-del_cnt);
       batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
-      s = db_->Write(default_write_options_, &batch);
+      s = WriteZSetsBatch(key, rank_index, &batch, erased_score_keys, {});
       UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
       return s;
     }
@@ -196,9 +216,12 @@ Status Redis::ZAdd(const Slice& key, const std::vector<ScoreMember>& score_membe
   uint64_t version = 0;
   std::string meta_value;
   rocksdb::WriteBatch batch;
+  std::shared_ptr<ZSetsRankIndex> rank_index;
+  std::vector<std::string> erased_score_keys;
+  std::vector<std::string> inserted_score_keys;
   ScopeRecordLock l(lock_mgr_, key);
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -220,12 +243,16 @@ Status Redis::ZAdd(const Slice& key, const std::vector<ScoreMember>& score_membe
       vaild = true;
       version = parsed_zsets_meta_value.Version();
     }
+    rank_index = LookupZSetsRankIndex(key);
+    if (!CheckZSetsRankIndex(rank_index, key, version, parsed_zsets_meta_value.Count())) {
+      rank_index.reset();
+    }
 
     int32_t cnt = 0;
     std::string data_value;
     for (const auto& sm : filtered_score_members) {
       bool not_found = true;
-      ZSetsMemberKey zsets_member_key(key, version, sm.member);
+      ZSetsMemberKey zsets_member_key(key, version, sm.member, slot_key_prefix_num_);
       if (vaild) {
         s = db_->Get(default_read_options_, handles_[kZsetsDataCF], zsets_member_key.Encode(), &data_value);
         if (s.ok()) {
@@ -238,8 +265,11 @@ Status Redis::ZAdd(const Slice& key, const std::vector<ScoreMember>& score_membe
           if (old_score == sm.score) {
             continue;
           } else {
-            ZSetsScoreKey zsets_score_key(key, version, old_score, sm.member);
+            ZSetsScoreKey zsets_score_key(key, version, old_score, sm.member, slot_key_prefix_num_);
             batch.Delete(handles_[kZsetsScoreCF], zsets_score_key.Encode());
+            if (rank_index != nullptr) {
+              erased_score_keys.push_back(zsets_score_key.Encode().ToString());
+            }
             // delete old zsets_score_key and overwirte zsets_member_key
             // but in different column_families so we accumulative 1
             statistic++;
@@ -254,9 +284,12 @@ Status Redis::ZAdd(const Slice& key, const std::vector<ScoreMember>& score_membe
       BaseDataValue zsets_member_i_val(Slice(score_buf, sizeof(uint64_t)));
       batch.Put(handles_[kZsetsDataCF], zsets_member_key.Encode(), zsets_member_i_val.Encode());
 
-      ZSetsScoreKey zsets_score_key(key, version, sm.score, sm.member);
+      ZSetsScoreKey zsets_score_key(key, version, sm.score, sm.member, slot_key_prefix_num_);
       BaseDataValue zsets_score_i_val(Slice{});
       batch.Put(handles_[kZsetsScoreCF], zsets_score_key.Encode(), zsets_score_i_val.Encode());
+      if (rank_index != nullptr) {
+        inserted_score_keys.push_back(zsets_score_key.Encode().ToString());
+      }
       if (not_found) {
         cnt++;
       }
@@ -273,22 +306,29 @@ Status Redis::ZAdd(const Slice& key, const std::vector<ScoreMember>& score_membe
     ZSetsMetaValue zsets_meta_value(DataType::kZSets, Slice(buf, 4));
     version = zsets_meta_value.UpdateVersion();
     batch.Put(handles_[kMetaCF], base_meta_key.Encode(), zsets_meta_value.Encode());
+    rank_index = LookupZSetsRankIndex(key);
+    if (!CheckZSetsRankIndex(rank_index, key, version, 0)) {
+      rank_index.reset();
+    }
     for (const auto& sm : filtered_score_members) {
-      ZSetsMemberKey zsets_member_key(key, version, sm.member);
+      ZSetsMemberKey zsets_member_key(key, version, sm.member, slot_key_prefix_num_);
       const void* ptr_score = reinterpret_cast<const void*>(&sm.score);
       EncodeFixed64(score_buf, *reinterpret_cast<const uint64_t*>(ptr_score));
       BaseDataValue zsets_member_i_val(Slice(score_buf, sizeof(uint64_t)));
       batch.Put(handles_[kZsetsDataCF], zsets_member_key.Encode(), zsets_member_i_val.Encode());
 
-      ZSetsScoreKey zsets_score_key(key, version, sm.score, sm.member);
+      ZSetsScoreKey zsets_score_key(key, version, sm.score, sm.member, slot_key_prefix_num_);
       BaseDataValue zsets_score_i_val(Slice{});
       batch.Put(handles_[kZsetsScoreCF], zsets_score_key.Encode(), zsets_score_i_val.Encode());
+      if (rank_index != nullptr) {
+        inserted_score_keys.push_back(zsets_score_key.Encode().ToString());
+      }
     }
     *ret = static_cast<int32_t>(filtered_score_members.size());
   } else {
     return s;
   }
-  s = db_->Write(default_write_options_, &batch);
+  s = WriteZSetsBatch(key, rank_index, &batch, erased_score_keys, inserted_score_keys);
   UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
   return s;
 }
@@ -301,7 +341,7 @@ Status Redis::ZCard(const Slice& key, int32_t* card, std::string&& prefetch_meta
   // we should get meta first
   std::string meta_value(std::move(prefetch_meta));
   if (meta_value.empty()) {
-    BaseMetaKey base_meta_key(key);
+    BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
     s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
     if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
       if (ExpectedStale(meta_value)) {
@@ -340,7 +380,7 @@ Status Redis::ZCount(const Slice& key, double min, double max, bool left_close,
   read_options.snapshot = snapshot;
 
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -364,7 +404,7 @@ Status Redis::ZCount(const Slice& key, double min, double max, bool left_close,
       int32_t cur_index = 0;
       int32_t stop_index = parsed_zsets_meta_value.Count() - 1;
       ScoreMember score_member;
-      ZSetsScoreKey zsets_score_key(key, version, min, Slice());
+      ZSetsScoreKey zsets_score_key(key, version, min, Slice(), slot_key_prefix_num_);
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsScoreCF]);
       for (iter->Seek(zsets_score_key.Encode()); iter->Valid() && cur_index <= stop_index; iter->Next(), ++cur_index) {
@@ -406,9 +446,11 @@ Status Redis::ZIncrby(const Slice& key, const Slice& member, double increment, d
   uint64_t version = 0;
   std::string meta_value;
   rocksdb::WriteBatch batch;
+  std::shared_ptr<ZSetsRankIndex> rank_index;
+  std::vector<std::string> erased_score_keys;
   ScopeRecordLock l(lock_mgr_, key);
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -427,8 +469,12 @@ Status Redis::ZIncrby(const Slice& key, const Slice& member, double increment, d
     } else {
       version = parsed_zsets_meta_value.Version();
     }
+    rank_index = LookupZSetsRankIndex(key);
+    if (!CheckZSetsRankIndex(rank_index, key, version, parsed_zsets_meta_value.Count())) {
+      rank_index.reset();
+    }
     std::string data_value;
-    ZSetsMemberKey zsets_member_key(key, version, member);
+    ZSetsMemberKey zsets_member_key(key, version, member, slot_key_prefix_num_);
     s = db_->Get(default_read_options_, handles_[kZsetsDataCF], zsets_member_key.Encode(), &data_value);
     if (s.ok()) {
       ParsedBaseDataValue parsed_value(&data_value);
@@ -437,8 +483,11 @@ Status Redis::ZIncrby(const Slice& key, const Slice& member, double increment, d
       const void* ptr_tmp = reinterpret_cast<const void*>(&tmp);
       double old_score = *reinterpret_cast<const double*>(ptr_tmp);
       score = old_score + increment;
-      ZSetsScoreKey zsets_score_key(key, version, old_score, member);
+      ZSetsScoreKey zsets_score_key(key, version, old_score, member, slot_key_prefix_num_);
       batch.Delete(handles_[kZsetsScoreCF], zsets_score_key.Encode());
+      if (rank_index != nullptr) {
+        erased_score_keys.push_back(zsets_score_key.Encode().ToString());
+      }
       // delete old zsets_score_key and overwirte zsets_member_key
       // but in different column_families so we accumulative 1
       statistic++;
@@ -458,36 +507,46 @@ Status Redis::ZIncrby(const Slice& key, const Slice& member, double increment, d
     ZSetsMetaValue zsets_meta_value(DataType::kZSets, Slice(buf, 4));
     version = zsets_meta_value.UpdateVersion();
     batch.Put(handles_[kMetaCF], base_meta_key.Encode(), zsets_meta_value.Encode());
+    rank_index = LookupZSetsRankIndex(key);
+    if (!CheckZSetsRankIndex(rank_index, key, version, 0)) {
+      rank_index.reset();
+    }
     score = increment;
   } else {
     return s;
   }
-  ZSetsMemberKey zsets_member_key(key, version, member);
+  ZSetsMemberKey zsets_member_key(key, version, member, slot_key_prefix_num_);
   const void* ptr_score = reinterpret_cast<const void*>(&score);
   EncodeFixed64(score_buf, *reinterpret_cast<const uint64_t*>(ptr_score));
   BaseDataValue zsets_member_i_val(Slice(score_buf, sizeof(uint64_t)));
   batch.Put(handles_[kZsetsDataCF], zsets_member_key.Encode(), zsets_member_i_val.Encode());
 
-  ZSetsScoreKey zsets_score_key(key, version, score, member);
+  ZSetsScoreKey zsets_score_key(key, version, score, member, slot_key_prefix_num_);
   BaseDataValue zsets_score_i_val(Slice{});
   batch.Put(handles_[kZsetsScoreCF], zsets_score_key.Encode(), zsets_score_i_val.Encode());
   *ret = score;
-  s = db_->Write(default_write_options_, &batch);
+  std::vector<std::string> inserted_score_keys;
+  if (rank_index != nullptr) {
+    inserted_score_keys.push_back(zsets_score_key.Encode().ToString());
+  }
+  s = WriteZSetsBatch(key, rank_index, &batch, erased_score_keys, inserted_score_keys);
   UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
   return s;
 }
 
-Status Redis::ZRange(const Slice& key, int32_t start, int32_t stop, std::vector<ScoreMember>* score_members) {
+Status Redis::ZRange(const Slice& key, int32_t start, int32_t stop, std::vector<ScoreMember>* score_members,
+                     bool build_rank_index) {
   score_members->clear();
   rocksdb::ReadOptions read_options;
   const rocksdb::Snapshot* snapshot = nullptr;
 
   std::string meta_value;
+  ScopeZSetsRankIndex rank_index(LookupZSetsRankIndex(key));
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -515,12 +574,22 @@ Status Redis::ZRange(const Slice& key, int32_t start, int32_t stop, std::vector<
       if (start_index > stop_index || start_index >= count || stop_index < 0) {
         return s;
       }
+      if (build_rank_index && rank_index.get() == nullptr && BuildZSetsRankIndex(key, count)) {
+        return ZRange(key, start, stop, score_members, false);
+      }
+      bool use_rank_index = CheckZSetsRankIndex(rank_index.index(), key, version, count);
       int32_t cur_index = 0;
       ScoreMember score_member;
-      ZSetsScoreKey zsets_score_key(key, version, std::numeric_limits<double>::lowest(), Slice());
+      ZSetsScoreKey zsets_score_key(key, version, -std::numeric_limits<double>::infinity(), Slice(),
+                                    slot_key_prefix_num_);
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsScoreCF]);
-      for (iter->Seek(zsets_score_key.Encode()); iter->Valid() && cur_index <= stop_index; iter->Next(), ++cur_index) {
+      if (use_rank_index) {
+        cur_index = static_cast<int32_t>(SeekZSetsRank(rank_index.get(), iter, key, version, start_index));
+      } else {
+        iter->Seek(zsets_score_key.Encode());
+      }
+      for (; iter->Valid() && cur_index <= stop_index; iter->Next(), ++cur_index) {
         if (cur_index >= start_index) {
           ParsedZSetsScoreKey parsed_zsets_score_key(iter->key());
           score_member.score = parsed_zsets_score_key.score();
@@ -535,16 +604,17 @@ Status Redis::ZRange(const Slice& key, int32_t start, int32_t stop, std::vector<
 }
 
 Status Redis::ZRangeWithTTL(const Slice& key, int32_t start, int32_t stop, std::vector<ScoreMember>* score_members,
-                                 int64_t* ttl) {
+                                 int64_t* ttl, bool build_rank_index) {
   score_members->clear();
   rocksdb::ReadOptions read_options;
   const rocksdb::Snapshot* snapshot = nullptr;
 
   std::string meta_value;
+  ScopeZSetsRankIndex rank_index(LookupZSetsRankIndex(key));
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -584,13 +654,22 @@ Status Redis::ZRangeWithTTL(const Slice& key, int32_t start, int32_t stop, std::
           || stop_index < 0) {
         return s;
       }
+      if (build_rank_index && rank_index.get() == nullptr && BuildZSetsRankIndex(key, count)) {
+        return ZRangeWithTTL(key, start, stop, score_members, ttl, false);
+      }
+      bool use_rank_index = CheckZSetsRankIndex(rank_index.index(), key, version, count);
       int32_t cur_index = 0;
       ScoreMember score_member;
       ZSetsScoreKey zsets_score_key(key, version,
-                                    std::numeric_limits<double>::lowest(), Slice());
+                                    -std::numeric_limits<double>::infinity(), Slice(), slot_key_prefix_num_);
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsScoreCF]);
-      for (iter->Seek(zsets_score_key.Encode());
+      if (use_rank_index) {
+        cur_index = static_cast<int32_t>(SeekZSetsRank(rank_index.get(), iter, key, version, start_index));
+      } else {
+        iter->Seek(zsets_score_key.Encode());
+      }
+      for (;
            iter->Valid() && cur_index <= stop_index;
            iter->Next(), ++cur_index) {
         if (cur_index >= start_index) {
@@ -607,16 +686,18 @@ Status Redis::ZRangeWithTTL(const Slice& key, int32_t start, int32_t stop, std::
 }
 
 Status Redis::ZRangebyscore(const Slice& key, double min, double max, bool left_close, bool right_close,
-                                 int64_t count, int64_t offset, std::vector<ScoreMember>* score_members) {
+                                 int64_t count, int64_t offset, std::vector<ScoreMember>* score_members,
+                                 bool build_rank_index) {
   score_members->clear();
   rocksdb::ReadOptions read_options;
   const rocksdb::Snapshot* snapshot = nullptr;
 
   std::string meta_value;
+  ScopeZSetsRankIndex rank_index(LookupZSetsRankIndex(key));
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -639,11 +720,34 @@ Status Redis::ZRangebyscore(const Slice& key, double min, double max, bool left_
       int32_t index = 0;
       int32_t stop_index = parsed_zsets_meta_value.Count() - 1;
       int64_t skipped = 0;
+      bool use_rank_index = false;
+      if (offset > 0) {
+        if (build_rank_index && rank_index.get() == nullptr &&
+            BuildZSetsRankIndex(key, parsed_zsets_meta_value.Count())) {
+          return ZRangebyscore(key, min, max, left_close, right_close, count, offset, score_members, false);
+        }
+        use_rank_index = CheckZSetsRankIndex(rank_index.index(), key, version, parsed_zsets_meta_value.Count());
+      }
       ScoreMember score_member;
-      ZSetsScoreKey zsets_score_key(key, version, min, Slice());
+      ZSetsScoreKey zsets_score_key(key, version, min, Slice(), slot_key_prefix_num_);
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsScoreCF]);
-      for (iter->Seek(zsets_score_key.Encode()); iter->Valid() && index <= stop_index; iter->Next(), ++index) {
+      if (use_rank_index) {
+        // Every member from the lower bound on passes the left check,
+        // so the first offset of them are skipped by rank
+        double lower = left_close ? min : std::nextafter(min, std::numeric_limits<double>::infinity());
+        ZSetsScoreKey lower_score_key(key, version, lower, Slice(), slot_key_prefix_num_);
+        int64_t first = SeekZSetsScoreKey(rank_index.get(), iter, key, version, lower_score_key.Encode());
+        if (first + offset <= stop_index) {
+          index = static_cast<int32_t>(SeekZSetsRank(rank_index.get(), iter, key, version, first + offset));
+          skipped = offset;
+        } else {
+          index = stop_index + 1;
+        }
+      } else {
+        iter->Seek(zsets_score_key.Encode());
+      }
+      for (; iter->Valid() && index <= stop_index; iter->Next(), ++index) {
         bool left_pass = false;
         bool right_pass = false;
         ParsedZSetsScoreKey parsed_zsets_score_key(iter->key());
@@ -684,16 +788,17 @@ Status Redis::ZRangebyscore(const Slice& key, double min, double max, bool left_
   return s;
 }
 
-Status Redis::ZRank(const Slice& key, const Slice& member, int32_t* rank) {
+Status Redis::ZRank(const Slice& key, const Slice& member, int32_t* rank, bool build_rank_index) {
   *rank = -1;
   rocksdb::ReadOptions read_options;
   const rocksdb::Snapshot* snapshot = nullptr;
 
   std::string meta_value;
+  ScopeZSetsRankIndex rank_index(LookupZSetsRankIndex(key));
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -716,8 +821,17 @@ Status Redis::ZRank(const Slice& key, const Slice& member, int32_t* rank) {
       uint64_t version = parsed_zsets_meta_value.Version();
       int32_t index = 0;
       int32_t stop_index = parsed_zsets_meta_value.Count() - 1;
+      if (build_rank_index && rank_index.get() == nullptr &&
+          BuildZSetsRankIndex(key, parsed_zsets_meta_value.Count())) {
+        return ZRank(key, member, rank, false);
+      }
+      if (CheckZSetsRankIndex(rank_index.index(), key, version, parsed_zsets_meta_value.Count())) {
+        KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
+        return ZRankByIndex(rank_index.get(), read_options, key, version, member, rank);
+      }
       ScoreMember score_member;
-      ZSetsScoreKey zsets_score_key(key, version, std::numeric_limits<double>::lowest(), Slice());
+      ZSetsScoreKey zsets_score_key(key, version, -std::numeric_limits<double>::infinity(), Slice(),
+                                    slot_key_prefix_num_);
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsScoreCF]);
       for (iter->Seek(zsets_score_key.Encode()); iter->Valid() && index <= stop_index; iter->Next(), ++index) {
@@ -753,9 +867,11 @@ Status Redis::ZRem(const Slice& key, const std::vector<std::string>& members, in
 
   std::string meta_value;
   rocksdb::WriteBatch batch;
+  std::shared_ptr<ZSetsRankIndex> rank_index;
+  std::vector<std::string> erased_score_keys;
   ScopeRecordLock l(lock_mgr_, key);
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -777,8 +893,12 @@ Status Redis::ZRem(const Slice& key, const std::vector<std::string>& members, in
       int32_t del_cnt = 0;
       std::string data_value;
       uint64_t version = parsed_zsets_meta_value.Version();
+      rank_index = LookupZSetsRankIndex(key);
+      if (!CheckZSetsRankIndex(rank_index, key, version, parsed_zsets_meta_value.Count())) {
+        rank_index.reset();
+      }
       for (const auto& member : filtered_members) {
-        ZSetsMemberKey zsets_member_key(key, version, member);
+        ZSetsMemberKey zsets_member_key(key, version, member, slot_key_prefix_num_);
         s = db_->Get(default_read_options_, handles_[kZsetsDataCF], zsets_member_key.Encode(), &data_value);
         if (s.ok()) {
           del_cnt++;
@@ -790,8 +910,11 @@ Status Redis::ZRem(const Slice& key, const std::vector<std::string>& members, in
           double score = *reinterpret_cast<const double*>(ptr_tmp);
           batch.Delete(handles_[kZsetsDataCF], zsets_member_key.Encode());
 
-          ZSetsScoreKey zsets_score_key(key, version, score, member);
+          ZSetsScoreKey zsets_score_key(key, version, score, member, slot_key_prefix_num_);
           batch.Delete(handles_[kZsetsScoreCF], zsets_score_key.Encode());
+          if (rank_index != nullptr) {
+            erased_score_keys.push_back(zsets_score_key.Encode().ToString());
+          }
         } else if (!s.IsNotFound()) {
           return s;
         }
@@ -806,7 +929,7 @@ Status Redis::ZRem(const Slice& key, const std::vector<std::string>& members, in
   } else {
     return s;
   }
-  s = db_->Write(default_write_options_, &batch);
+  s = WriteZSetsBatch(key, rank_index, &batch, erased_score_keys, {});
   UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
   return s;
 }
@@ -816,9 +939,11 @@ Status Redis::ZRemrangebyrank(const Slice& key, int32_t start, int32_t stop, int
   uint32_t statistic = 0;
   std::string meta_value;
   rocksdb::WriteBatch batch;
+  std::shared_ptr<ZSetsRankIndex> rank_index;
+  std::vector<std::string> erased_score_keys;
   ScopeRecordLock l(lock_mgr_, key);
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -842,6 +967,10 @@ Status Redis::ZRemrangebyrank(const Slice& key, int32_t start, int32_t stop, int
       int32_t cur_index = 0;
       int32_t count = parsed_zsets_meta_value.Count();
       uint64_t version = parsed_zsets_meta_value.Version();
+      rank_index = LookupZSetsRankIndex(key);
+      if (!CheckZSetsRankIndex(rank_index, key, version, parsed_zsets_meta_value.Count())) {
+        rank_index.reset();
+      }
       int32_t start_index = start >= 0 ? start : count + start;
       int32_t stop_index = stop >= 0 ? stop : count + stop;
       start_index = start_index <= 0 ? 0 : start_index;
@@ -849,15 +978,25 @@ Status Redis::ZRemrangebyrank(const Slice& key, int32_t start, int32_t stop, int
       if (start_index > stop_index || start_index >= count) {
         return s;
       }
-      ZSetsScoreKey zsets_score_key(key, version, std::numeric_limits<double>::lowest(), Slice());
+      ZSetsScoreKey zsets_score_key(key, version, -std::numeric_limits<double>::infinity(), Slice(),
+                                    slot_key_prefix_num_);
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kZsetsScoreCF]);
-      for (iter->Seek(zsets_score_key.Encode()); iter->Valid() && cur_index <= stop_index; iter->Next(), ++cur_index) {
+      if (rank_index != nullptr) {
+        // Only writers modify the index and we hold the record lock
+        cur_index = static_cast<int32_t>(SeekZSetsRank(rank_index.get(), iter, key, version, start_index));
+      } else {
+        iter->Seek(zsets_score_key.Encode());
+      }
+      for (; iter->Valid() && cur_index <= stop_index; iter->Next(), ++cur_index) {
         if (cur_index >= start_index) {
           ParsedZSetsScoreKey parsed_zsets_score_key(iter->key());
-          ZSetsMemberKey zsets_member_key(key, version, parsed_zsets_score_key.member());
+          ZSetsMemberKey zsets_member_key(key, version, parsed_zsets_score_key.member(), slot_key_prefix_num_);
           batch.Delete(handles_[kZsetsDataCF], zsets_member_key.Encode());
           batch.Delete(handles_[kZsetsScoreCF], iter->key());
+          if (rank_index != nullptr) {
+            erased_score_keys.push_back(iter->key().ToString());
+          }
           del_cnt++;
           statistic++;
         }
@@ -873,7 +1012,7 @@ Status Redis::ZRemrangebyrank(const Slice& key, int32_t start, int32_t stop, int
   } else {
     return s;
   }
-  s = db_->Write(default_write_options_, &batch);
+  s = WriteZSetsBatch(key, rank_index, &batch, erased_score_keys, {});
   UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
   return s;
 }
@@ -884,9 +1023,11 @@ Status Redis::ZRemrangebyscore(const Slice& key, double min, double max, bool le
   uint32_t statistic = 0;
   std::string meta_value;
   rocksdb::WriteBatch batch;
+  std::shared_ptr<ZSetsRankIndex> rank_index;
+  std::vector<std::string> erased_score_keys;
   ScopeRecordLock l(lock_mgr_, key);
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -910,7 +1051,11 @@ Status Redis::ZRemrangebyscore(const Slice& key, double min, double max, bool le
       int32_t cur_index = 0;
       int32_t stop_index = parsed_zsets_meta_value.Count() - 1;
       uint64_t version = parsed_zsets_meta_value.Version();
-      ZSetsScoreKey zsets_score_key(key, version, min, Slice());
+      rank_index = LookupZSetsRankIndex(key);
+      if (!CheckZSetsRankIndex(rank_index, key, version, parsed_zsets_meta_value.Count())) {
+        rank_index.reset();
+      }
+      ZSetsScoreKey zsets_score_key(key, version, min, Slice(), slot_key_prefix_num_);
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kZsetsScoreCF]);
       for (iter->Seek(zsets_score_key.Encode()); iter->Valid() && cur_index <= stop_index; iter->Next(), ++cur_index) {
@@ -932,9 +1077,12 @@ Status Redis::ZRemrangebyscore(const Slice& key, double min, double max, bool le
           right_pass = true;
         }
         if (left_pass && right_pass) {
-          ZSetsMemberKey zsets_member_key(key, version, parsed_zsets_score_key.member());
+          ZSetsMemberKey zsets_member_key(key, version, parsed_zsets_score_key.member(), slot_key_prefix_num_);
           batch.Delete(handles_[kZsetsDataCF], zsets_member_key.Encode());
           batch.Delete(handles_[kZsetsScoreCF], iter->key());
+          if (rank_index != nullptr) {
+            erased_score_keys.push_back(iter->key().ToString());
+          }
           del_cnt++;
           statistic++;
         }
@@ -953,22 +1101,24 @@ Status Redis::ZRemrangebyscore(const Slice& key, double min, double max, bool le
   } else {
     return s;
   }
-  s = db_->Write(default_write_options_, &batch);
+  s = WriteZSetsBatch(key, rank_index, &batch, erased_score_keys, {});
   UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
   return s;
 }
 
-Status Redis::ZRevrange(const Slice& key, int32_t start, int32_t stop, std::vector<ScoreMember>* score_members) {
+Status Redis::ZRevrange(const Slice& key, int32_t start, int32_t stop, std::vector<ScoreMember>* score_members,
+                        bool build_rank_index) {
   score_members->clear();
   rocksdb::ReadOptions read_options;
   const rocksdb::Snapshot* snapshot = nullptr;
 
   std::string meta_value;
+  ScopeZSetsRankIndex rank_index(LookupZSetsRankIndex(key));
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -996,13 +1146,23 @@ Status Redis::ZRevrange(const Slice& key, int32_t start, int32_t stop, std::vect
       if (start_index > stop_index || start_index >= count || stop_index < 0) {
         return s;
       }
+      if (build_rank_index && rank_index.get() == nullptr && BuildZSetsRankIndex(key, count)) {
+        return ZRevrange(key, start, stop, score_members, false);
+      }
+      bool use_rank_index = CheckZSetsRankIndex(rank_index.index(), key, version, count);
       int32_t cur_index = count - 1;
       ScoreMember score_member;
-      ZSetsScoreKey zsets_score_key(key, version, std::numeric_limits<double>::max(), Slice());
+      // SeekForPrev lands on the last score key of version
+      ZSetsScoreKey zsets_score_key(key, version + 1, -std::numeric_limits<double>::infinity(), Slice(),
+                                    slot_key_prefix_num_);
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsScoreCF]);
-      for (iter->SeekForPrev(zsets_score_key.Encode()); iter->Valid() && cur_index >= start_index;
-           iter->Prev(), --cur_index) {
+      if (use_rank_index) {
+        cur_index = static_cast<int32_t>(SeekZSetsRank(rank_index.get(), iter, key, version, stop_index));
+      } else {
+        iter->SeekForPrev(zsets_score_key.Encode());
+      }
+      for (; iter->Valid() && cur_index >= start_index; iter->Prev(), --cur_index) {
         if (cur_index <= stop_index) {
           ParsedZSetsScoreKey parsed_zsets_score_key(iter->key());
           score_member.score = parsed_zsets_score_key.score();
@@ -1026,7 +1186,7 @@ Status Redis::ZRevrangebyscore(const Slice& key, double min, double max, bool le
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1049,7 +1209,8 @@ Status Redis::ZRevrangebyscore(const Slice& key, double min, double max, bool le
       int32_t left = parsed_zsets_meta_value.Count();
       int64_t skipped = 0;
       ScoreMember score_member;
-      ZSetsScoreKey zsets_score_key(key, version, std::nextafter(max, std::numeric_limits<double>::max()), Slice());
+      ZSetsScoreKey zsets_score_key(key, version, std::nextafter(max, std::numeric_limits<double>::max()), Slice(),
+                                    slot_key_prefix_num_);
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsScoreCF]);
       for (iter->SeekForPrev(zsets_score_key.Encode()); iter->Valid() && left > 0; iter->Prev(), --left) {
@@ -1093,17 +1254,18 @@ Status Redis::ZRevrangebyscore(const Slice& key, double min, double max, bool le
   return s;
 }
 
-Status Redis::ZRevrank(const Slice& key, const Slice& member, int32_t* rank) {
+Status Redis::ZRevrank(const Slice& key, const Slice& member, int32_t* rank, bool build_rank_index) {
   *rank = -1;
   rocksdb::ReadOptions read_options;
   const rocksdb::Snapshot* snapshot = nullptr;
 
   std::string meta_value;
+  ScopeZSetsRankIndex rank_index(LookupZSetsRankIndex(key));
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1126,7 +1288,20 @@ Status Redis::ZRevrank(const Slice& key, const Slice& member, int32_t* rank) {
       int32_t rev_index = 0;
       int32_t left = parsed_zsets_meta_value.Count();
       uint64_t version = parsed_zsets_meta_value.Version();
-      ZSetsScoreKey zsets_score_key(key, version, std::numeric_limits<double>::max(), Slice());
+      if (build_rank_index && rank_index.get() == nullptr && BuildZSetsRankIndex(key, left)) {
+        return ZRevrank(key, member, rank, false);
+      }
+      if (CheckZSetsRankIndex(rank_index.index(), key, version, left)) {
+        KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
+        s = ZRankByIndex(rank_index.get(), read_options, key, version, member, rank);
+        if (s.ok()) {
+          *rank = left - 1 - *rank;
+        }
+        return s;
+      }
+      // SeekForPrev lands on the last score key of version
+      ZSetsScoreKey zsets_score_key(key, version + 1, -std::numeric_limits<double>::infinity(), Slice(),
+                                    slot_key_prefix_num_);
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsScoreCF]);
       for (iter->SeekForPrev(zsets_score_key.Encode()); iter->Valid() && left > 0; iter->Prev(), --left, ++rev_index) {
@@ -1157,7 +1332,7 @@ Status Redis::ZScore(const Slice& key, const Slice& member, double* score) {
   read_options.snapshot = snapshot;
 
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value) && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1178,7 +1353,7 @@ Status Redis::ZScore(const Slice& key, const Slice& member, double* score) {
       return Status::NotFound();
     } else {
       std::string data_value;
-      ZSetsMemberKey zsets_member_key(key, version, member);
+      ZSetsMemberKey zsets_member_key(key, version, member, slot_key_prefix_num_);
       s = db_->Get(read_options, handles_[kZsetsDataCF], zsets_member_key.Encode(), &data_value);
       if (s.ok()) {
         ParsedBaseDataValue parsed_value(&data_value);
@@ -1206,7 +1381,7 @@ Status Redis::ZGetAll(const Slice& key, double weight, std::map<std::string, dou
   read_options.snapshot = snapshot;
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value) && !ExpectedMetaValue(DataType::kSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1225,7 +1400,8 @@ Status Redis::ZGetAll(const Slice& key, double weight, std::map<std::string, dou
       int32_t stop_index = parsed_zsets_meta_value.Count() - 1;
       double score = 0.0;
       uint64_t version = parsed_zsets_meta_value.Version();
-      ZSetsScoreKey zsets_score_key(key.ToString(), version, std::numeric_limits<double>::lowest(), Slice());
+      ZSetsScoreKey zsets_score_key(key.ToString(), version, -std::numeric_limits<double>::infinity(), Slice(),
+                                    slot_key_prefix_num_);
       Slice seek_key = zsets_score_key.Encode();
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsScoreCF]);
       for (iter->Seek(seek_key); iter->Valid() && cur_index <= stop_index; iter->Next(), ++cur_index) {
@@ -1258,7 +1434,7 @@ Status Redis::ZUnionstore(const Slice& destination, const std::vector<std::strin
 
   Status s;
   for (size_t idx = 0; idx < keys.size(); ++idx) {
-    BaseMetaKey base_meta_key(keys[idx]);
+    BaseMetaKey base_meta_key(keys[idx], slot_key_prefix_num_);
     s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
     if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
       if (ExpectedStale(meta_value)) {
@@ -1278,7 +1454,8 @@ Status Redis::ZUnionstore(const Slice& destination, const std::vector<std::strin
         double score = 0;
         double weight = idx < weights.size() ? weights[idx] : 1;
         version = parsed_zsets_meta_value.Version();
-        ZSetsScoreKey zsets_score_key(keys[idx], version, std::numeric_limits<double>::lowest(), Slice());
+        ZSetsScoreKey zsets_score_key(keys[idx], version, -std::numeric_limits<double>::infinity(), Slice(),
+                                      slot_key_prefix_num_);
         KeyStatisticsDurationGuard guard(this, DataType::kZSets, keys[idx]);
         rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsScoreCF]);
         for (iter->Seek(zsets_score_key.Encode()); iter->Valid() && cur_index <= stop_index;
@@ -1312,7 +1489,7 @@ Status Redis::ZUnionstore(const Slice& destination, const std::vector<std::strin
     }
   }
 
-  BaseMetaKey base_destination(destination);
+  BaseMetaKey base_destination(destination, slot_key_prefix_num_);
   s = db_->Get(read_options, handles_[kMetaCF], base_destination.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1343,18 +1520,20 @@ Status Redis::ZUnionstore(const Slice& destination, const std::vector<std::strin
 
   char score_buf[8];
   for (const auto& sm : member_score_map) {
-    ZSetsMemberKey zsets_member_key(destination, version, sm.first);
+    ZSetsMemberKey zsets_member_key(destination, version, sm.first, slot_key_prefix_num_);
 
     const void* ptr_score = reinterpret_cast<const void*>(&sm.second);
     EncodeFixed64(score_buf, *reinterpret_cast<const uint64_t*>(ptr_score));
     BaseDataValue member_i_val(Slice(score_buf, sizeof(uint64_t)));
     batch.Put(handles_[kZsetsDataCF], zsets_member_key.Encode(), member_i_val.Encode());
 
-    ZSetsScoreKey zsets_score_key(destination, version, sm.second, sm.first);
+    ZSetsScoreKey zsets_score_key(destination, version, sm.second, sm.first, slot_key_prefix_num_);
     BaseDataValue score_i_val(Slice{});
     batch.Put(handles_[kZsetsScoreCF], zsets_score_key.Encode(), score_i_val.Encode());
   }
   *ret = static_cast<int32_t>(member_score_map.size());
+  // destination is rewritten with a new version
+  zset_rank_index_store_->Remove(destination.ToString());
   s = db_->Write(default_write_options_, &batch);
   UpdateSpecificKeyStatistics(DataType::kZSets, destination.ToString(), statistic);
   value_to_dest = std::move(member_score_map);
@@ -1388,7 +1567,7 @@ Status Redis::ZInterstore(const Slice& destination, const std::vector<std::strin
   int32_t cur_index = 0;
   int32_t stop_index = 0;
   for (size_t idx = 0; idx < keys.size(); ++idx) {
-    BaseMetaKey base_meta_key(keys[idx]);
+    BaseMetaKey base_meta_key(keys[idx], slot_key_prefix_num_);
     s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
     if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
       if (ExpectedStale(meta_value)) {
@@ -1418,7 +1597,8 @@ Status Redis::ZInterstore(const Slice& destination, const std::vector<std::strin
   }
 
   if (!have_invalid_zsets) {
-    ZSetsScoreKey zsets_score_key(valid_zsets[0].key, valid_zsets[0].version, std::numeric_limits<double>::lowest(), Slice());
+    ZSetsScoreKey zsets_score_key(valid_zsets[0].key, valid_zsets[0].version, -std::numeric_limits<double>::infinity(),
+                                  Slice(), slot_key_prefix_num_);
     KeyStatisticsDurationGuard guard(this, DataType::kZSets, valid_zsets[0].key);
     rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsScoreCF]);
     for (iter->Seek(zsets_score_key.Encode()); iter->Valid() && cur_index <= stop_index; iter->Next(), ++cur_index) {
@@ -1436,7 +1616,8 @@ Status Redis::ZInterstore(const Slice& destination, const std::vector<std::strin
       item.score = sm.score * (!weights.empty() ? weights[0] : 1);
       for (size_t idx = 1; idx < valid_zsets.size(); ++idx) {
         double weight = idx < weights.size() ? weights[idx] : 1;
-        ZSetsMemberKey zsets_member_key(valid_zsets[idx].key, valid_zsets[idx].version, item.member);
+        ZSetsMemberKey zsets_member_key(valid_zsets[idx].key, valid_zsets[idx].version, item.member,
+                                        slot_key_prefix_num_);
         s = db_->Get(read_options, handles_[kZsetsDataCF], zsets_member_key.Encode(), &data_value);
         if (s.ok()) {
           ParsedBaseDataValue parsed_value(&data_value);
@@ -1468,7 +1649,7 @@ Status Redis::ZInterstore(const Slice& destination, const std::vector<std::strin
     }
   }
 
-  BaseMetaKey base_destination(destination);
+  BaseMetaKey base_destination(destination, slot_key_prefix_num_);
   s = db_->Get(read_options, handles_[kMetaCF], base_destination.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1498,18 +1679,20 @@ Status Redis::ZInterstore(const Slice& destination, const std::vector<std::strin
   }
   char score_buf[8];
   for (const auto& sm : final_score_members) {
-    ZSetsMemberKey zsets_member_key(destination, version, sm.member);
+    ZSetsMemberKey zsets_member_key(destination, version, sm.member, slot_key_prefix_num_);
 
     const void* ptr_score = reinterpret_cast<const void*>(&sm.score);
     EncodeFixed64(score_buf, *reinterpret_cast<const uint64_t*>(ptr_score));
     BaseDataValue member_i_val(Slice(score_buf, sizeof(uint64_t)));
     batch.Put(handles_[kZsetsDataCF], zsets_member_key.Encode(), member_i_val.Encode());
 
-    ZSetsScoreKey zsets_score_key(destination, version, sm.score, sm.member);
+    ZSetsScoreKey zsets_score_key(destination, version, sm.score, sm.member, slot_key_prefix_num_);
     BaseDataValue zsets_score_i_val(Slice{});
     batch.Put(handles_[kZsetsScoreCF], zsets_score_key.Encode(), zsets_score_i_val.Encode());
   }
   *ret = static_cast<int32_t>(final_score_members.size());
+  // destination is rewritten with a new version
+  zset_rank_index_store_->Remove(destination.ToString());
   s = db_->Write(default_write_options_, &batch);
   UpdateSpecificKeyStatistics(DataType::kZSets, destination.ToString(), statistic);
   value_to_dest = std::move(final_score_members);
@@ -1530,7 +1713,7 @@ Status Redis::ZRangebylex(const Slice& key, const Slice& min, const Slice& max,
   bool right_not_limit = max.compare("+") == 0;
 
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1550,7 +1733,7 @@ Status Redis::ZRangebylex(const Slice& key, const Slice& min, const Slice& max,
       uint64_t version = parsed_zsets_meta_value.Version();
       int32_t cur_index = 0;
       int32_t stop_index = parsed_zsets_meta_value.Count() - 1;
-      ZSetsMemberKey zsets_member_key(key, version, Slice());
+      ZSetsMemberKey zsets_member_key(key, version, Slice(), slot_key_prefix_num_);
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsDataCF]);
       for (iter->Seek(zsets_member_key.Encode()); iter->Valid() && cur_index <= stop_index; iter->Next(), ++cur_index) {
@@ -1590,6 +1773,8 @@ Status Redis::ZRemrangebylex(const Slice& key, const Slice& min, const Slice& ma
   *ret = 0;
   uint32_t statistic = 0;
   rocksdb::WriteBatch batch;
+  std::shared_ptr<ZSetsRankIndex> rank_index;
+  std::vector<std::string> erased_score_keys;
   rocksdb::ReadOptions read_options;
   const rocksdb::Snapshot* snapshot = nullptr;
 
@@ -1603,7 +1788,7 @@ Status Redis::ZRemrangebylex(const Slice& key, const Slice& min, const Slice& ma
   int32_t del_cnt = 0;
   std::string meta_value;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1621,9 +1806,13 @@ Status Redis::ZRemrangebylex(const Slice& key, const Slice& min, const Slice& ma
       return Status::NotFound();
     } else {
       uint64_t version = parsed_zsets_meta_value.Version();
+      rank_index = LookupZSetsRankIndex(key);
+      if (!CheckZSetsRankIndex(rank_index, key, version, parsed_zsets_meta_value.Count())) {
+        rank_index.reset();
+      }
       int32_t cur_index = 0;
       int32_t stop_index = parsed_zsets_meta_value.Count() - 1;
-      ZSetsMemberKey zsets_member_key(key, version, Slice());
+      ZSetsMemberKey zsets_member_key(key, version, Slice(), slot_key_prefix_num_);
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsDataCF]);
       for (iter->Seek(zsets_member_key.Encode()); iter->Valid() && cur_index <= stop_index; iter->Next(), ++cur_index) {
@@ -1644,8 +1833,11 @@ Status Redis::ZRemrangebylex(const Slice& key, const Slice& min, const Slice& ma
           uint64_t tmp = DecodeFixed64(parsed_value.UserValue().data());
           const void* ptr_tmp = reinterpret_cast<const void*>(&tmp);
           double score = *reinterpret_cast<const double*>(ptr_tmp);
-          ZSetsScoreKey zsets_score_key(key, version, score, member);
+          ZSetsScoreKey zsets_score_key(key, version, score, member, slot_key_prefix_num_);
           batch.Delete(handles_[kZsetsScoreCF], zsets_score_key.Encode());
+          if (rank_index != nullptr) {
+            erased_score_keys.push_back(zsets_score_key.Encode().ToString());
+          }
           del_cnt++;
           statistic++;
         }
@@ -1666,7 +1858,7 @@ Status Redis::ZRemrangebylex(const Slice& key, const Slice& min, const Slice& ma
   } else {
     return s;
   }
-  s = db_->Write(default_write_options_, &batch);
+  s = WriteZSetsBatch(key, rank_index, &batch, erased_score_keys, {});
   UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
   return s;
 }
@@ -1674,7 +1866,7 @@ Status Redis::ZRemrangebylex(const Slice& key, const Slice& min, const Slice& ma
 Status Redis::ZsetsExpire(const Slice& key, int64_t ttl, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s;
 
   // meta_value is empty means no meta value get before,
@@ -1700,12 +1892,13 @@ Status Redis::ZsetsExpire(const Slice& key, int64_t ttl, std::string&& prefetch_
       return Status::NotFound();
     }
 
+    uint64_t old_etime = parsed_zsets_meta_value.Etime();
     if (ttl > 0) {
       parsed_zsets_meta_value.SetRelativeTimestamp(ttl);
     } else {
       parsed_zsets_meta_value.InitialMetaValue();
     }
-    s = db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+    s = PutWithExpireIndex(key, base_meta_key.Encode(), meta_value, parsed_zsets_meta_value.Etime(), old_etime);
   }
   return s;
 }
@@ -1713,7 +1906,7 @@ Status Redis::ZsetsExpire(const Slice& key, int64_t ttl, std::string&& prefetch_
 Status Redis::ZsetsDel(const Slice& key, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s;
 
   // meta_value is empty means no meta value get before,
@@ -1740,6 +1933,7 @@ Status Redis::ZsetsDel(const Slice& key, std::string&& prefetch_meta) {
     } else {
       uint32_t statistic = parsed_zsets_meta_value.Count();
       parsed_zsets_meta_value.InitialMetaValue();
+      zset_rank_index_store_->Remove(key.ToString());
       s = db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
       UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
     }
@@ -1750,7 +1944,7 @@ Status Redis::ZsetsDel(const Slice& key, std::string&& prefetch_meta) {
 Status Redis::ZsetsExpireat(const Slice& key, int64_t timestamp, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
   ScopeRecordLock l(lock_mgr_, key);
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s;
 
   // meta_value is empty means no meta value get before,
@@ -1775,12 +1969,13 @@ Status Redis::ZsetsExpireat(const Slice& key, int64_t timestamp, std::string&& p
     } else if (parsed_zsets_meta_value.Count() == 0) {
       return Status::NotFound();
     } else {
+      uint64_t old_etime = parsed_zsets_meta_value.Etime();
       if (timestamp > 0) {
         parsed_zsets_meta_value.SetEtime(uint64_t(timestamp));
       } else {
         parsed_zsets_meta_value.InitialMetaValue();
       }
-      return db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      return PutWithExpireIndex(key, base_meta_key.Encode(), meta_value, parsed_zsets_meta_value.Etime(), old_etime);
     }
   }
   return s;
@@ -1804,7 +1999,7 @@ Status Redis::ZScan(const Slice& key, int64_t cursor, const std::string& pattern
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
 
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
   if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
     if (ExpectedStale(meta_value)) {
@@ -1836,8 +2031,8 @@ Status Redis::ZScan(const Slice& key, int64_t cursor, const std::string& pattern
         sub_member = pattern.substr(0, pattern.size() - 1);
       }
 
-      ZSetsMemberKey zsets_member_prefix(key, version, sub_member);
-      ZSetsMemberKey zsets_member_key(key, version, start_point);
+      ZSetsMemberKey zsets_member_prefix(key, version, sub_member, slot_key_prefix_num_);
+      ZSetsMemberKey zsets_member_key(key, version, start_point, slot_key_prefix_num_);
       std::string prefix = zsets_member_prefix.EncodeSeekKey().ToString();
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsDataCF]);
@@ -1874,7 +2069,7 @@ Status Redis::ZScan(const Slice& key, int64_t cursor, const std::string& pattern
 
 Status Redis::ZsetsPersist(const Slice& key, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   ScopeRecordLock l(lock_mgr_, key);
   Status s;
 
@@ -1905,7 +2100,7 @@ Status Redis::ZsetsPersist(const Slice& key, std::string&& prefetch_meta) {
         return Status::NotFound("Not have an associated timeout");
       } else {
         parsed_zsets_meta_value.SetEtime(0);
-        return db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+        return PutWithExpireIndex(key, base_meta_key.Encode(), meta_value, 0, timestamp);
       }
     }
   }
@@ -1914,7 +2109,7 @@ Status Redis::ZsetsPersist(const Slice& key, std::string&& prefetch_meta) {
 
 Status Redis::ZsetsTTL(const Slice& key, int64_t* timestamp, std::string&& prefetch_meta) {
   std::string meta_value(std::move(prefetch_meta));
-  BaseMetaKey base_meta_key(key);
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
   Status s;
 
   // meta_value is empty means no meta value get before,
@@ -2013,4 +2208,172 @@ void Redis::ScanZsets() {
   delete score_iter;
 }
 
+std::shared_ptr<ZSetsRankIndex> Redis::LookupZSetsRankIndex(const Slice& key) {
+  std::shared_ptr<ZSetsRankIndex> index;
+  if (zset_rank_index_threshold_ != 0) {
+    zset_rank_index_store_->Lookup(key.ToString(), &index);
+  }
+  return index;
+}
+
+bool Redis::CheckZSetsRankIndex(const std::shared_ptr<ZSetsRankIndex>& index, const Slice& key, uint64_t version,
+                                int32_t count) {
+  if (index == nullptr) {
+    return false;
+  }
+  // The index may have been evicted or rebuilt, writers only maintain the one in the store
+  std::shared_ptr<ZSetsRankIndex> current;
+  Status s = zset_rank_index_store_->Lookup(key.ToString(), &current);
+  if (!s.ok() || current != index) {
+    return false;
+  }
+  if (index->Version() != version || index->Count() != count) {
+    zset_rank_index_store_->Remove(key.ToString());
+    return false;
+  }
+  return true;
+}
+
+bool Redis::BuildZSetsRankIndex(const Slice& key, int32_t count) {
+  uint64_t threshold = zset_rank_index_threshold_;
+  if (threshold == 0 || static_cast<uint64_t>(count) < threshold) {
+    return false;
+  }
+
+  // Writers update the index under the record lock, so no write can be missed
+  ScopeRecordLock l(lock_mgr_, key);
+  if (LookupZSetsRankIndex(key) != nullptr) {
+    return true;
+  }
+  std::string meta_value;
+  BaseMetaKey base_meta_key(key, slot_key_prefix_num_);
+  Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
+  if (!s.ok() || !ExpectedMetaValue(DataType::kZSets, meta_value)) {
+    return false;
+  }
+  ParsedZSetsMetaValue parsed_zsets_meta_value(&meta_value);
+  if (parsed_zsets_meta_value.IsStale() || static_cast<uint64_t>(parsed_zsets_meta_value.Count()) < threshold) {
+    return false;
+  }
+
+  count = parsed_zsets_meta_value.Count();
+  uint64_t version = parsed_zsets_meta_value.Version();
+  auto index = std::make_shared<ZSetsRankIndex>(version, handles_[kZsetsScoreCF]->GetComparator());
+  int32_t cur_index = 0;
+  ZSetsScoreKey zsets_score_key(key, version, -std::numeric_limits<double>::infinity(), Slice(), slot_key_prefix_num_);
+  rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kZsetsScoreCF]);
+  for (iter->Seek(zsets_score_key.Encode()); iter->Valid() && cur_index < count; iter->Next(), ++cur_index) {
+    ParsedZSetsScoreKey parsed_zsets_score_key(iter->key());
+    if (parsed_zsets_score_key.key() != key || parsed_zsets_score_key.Version() != version) {
+      break;
+    }
+    index->Append(iter->key());
+  }
+  delete iter;
+  index->FinishBuild();
+  if (index->Count() != count || index->BucketNum() > zset_rank_index_store_->Capacity()) {
+    return false;
+  }
+  return zset_rank_index_store_->Insert(key.ToString(), index, index->BucketNum()).ok();
+}
+
+static void SeekZSetsRankIndexBucket(rocksdb::Iterator* iter, const Slice& key, uint64_t version,
+                                     const std::string& bound, int slot_num) {
+  if (bound.empty()) {
+    ZSetsScoreKey zsets_score_key(key, version, -std::numeric_limits<double>::infinity(), Slice(), slot_num);
+    iter->Seek(zsets_score_key.Encode());
+  } else {
+    iter->Seek(bound);
+  }
+}
+
+Status Redis::WriteZSetsBatch(const Slice& key, const std::shared_ptr<ZSetsRankIndex>& index,
+                              rocksdb::WriteBatch* batch, const std::vector<std::string>& erased,
+                              const std::vector<std::string>& inserted) {
+  if (index == nullptr) {
+    return db_->Write(default_write_options_, batch);
+  }
+
+  // Readers take their snapshot after locking the index shared,
+  // so they never see the write without the index update
+  std::lock_guard<std::shared_mutex> lock(index->mu);
+  Status s = db_->Write(default_write_options_, batch);
+  bool valid = s.ok();
+  for (size_t i = 0; valid && i < erased.size(); ++i) {
+    valid = index->Erase(erased[i]);
+  }
+  for (size_t i = 0; valid && i < inserted.size(); ++i) {
+    int64_t bucket = index->Insert(inserted[i]);
+    if (bucket < 0) {
+      continue;
+    }
+    int64_t offset = index->BucketCount(bucket) / 2;
+    rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kZsetsScoreCF]);
+    SeekZSetsRankIndexBucket(iter, key, index->Version(), index->BucketBound(bucket), slot_key_prefix_num_);
+    for (int64_t skipped = 0; iter->Valid() && skipped < offset; ++skipped) {
+      iter->Next();
+    }
+    valid = iter->Valid();
+    if (valid) {
+      index->Split(bucket, offset, iter->key());
+    }
+    delete iter;
+  }
+  if (!valid) {
+    zset_rank_index_store_->Remove(key.ToString());
+  }
+  return s;
+}
+
+int64_t Redis::SeekZSetsScoreKey(ZSetsRankIndex* index, rocksdb::Iterator* iter, const Slice& key, uint64_t version,
+                                 const Slice& score_key) {
+  std::string bound;
+  int64_t rank = index->Seek(score_key, &bound);
+  SeekZSetsRankIndexBucket(iter, key, version, bound, slot_key_prefix_num_);
+  const rocksdb::Comparator* comparator = handles_[kZsetsScoreCF]->GetComparator();
+  while (iter->Valid() && rank < index->Count() && comparator->Compare(iter->key(), score_key) < 0) {
+    iter->Next();
+    ++rank;
+  }
+  return rank;
+}
+
+int64_t Redis::SeekZSetsRank(ZSetsRankIndex* index, rocksdb::Iterator* iter, const Slice& key, uint64_t version,
+                             int64_t rank) {
+  std::string bound;
+  int64_t cur_index = index->SeekRank(rank, &bound);
+  SeekZSetsRankIndexBucket(iter, key, version, bound, slot_key_prefix_num_);
+  for (; iter->Valid() && cur_index < rank; iter->Next(), ++cur_index) {
+  }
+  return cur_index;
+}
+
+Status Redis::ZRankByIndex(ZSetsRankIndex* index, const rocksdb::ReadOptions& read_options, const Slice& key,
+                           uint64_t version, const Slice& member, int32_t* rank) {
+  std::string data_value;
+  ZSetsMemberKey zsets_member_key(key, version, member, slot_key_prefix_num_);
+  Status s = db_->Get(read_options, handles_[kZsetsDataCF], zsets_member_key.Encode(), &data_value);
+  if (!s.ok()) {
+    return s;
+  }
+  ParsedBaseDataValue parsed_value(&data_value);
+  parsed_value.StripSuffix();
+  uint64_t tmp = DecodeFixed64(data_value.data());
+  const void* ptr_tmp = reinterpret_cast<const void*>(&tmp);
+  double score = *reinterpret_cast<const double*>(ptr_tmp);
+
+  ZSetsScoreKey zsets_score_key(key, version, score, member, slot_key_prefix_num_);
+  Slice score_key = zsets_score_key.Encode();
+  rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsScoreCF]);
+  int64_t cur_index = SeekZSetsScoreKey(index, iter, key, version, score_key);
+  bool found = iter->Valid() && cur_index < index->Count() &&
+               handles_[kZsetsScoreCF]->GetComparator()->Compare(iter->key(), score_key) == 0;
+  delete iter;
+  if (!found) {
+    return Status::NotFound();
+  }
+  *rank = static_cast<int32_t>(cur_index);
+  return Status::OK();
+}
+
 }  // namespace storage
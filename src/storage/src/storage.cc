@@ -5,6 +5,7 @@
 
 #include <utility>
 #include <algorithm>
+#include <thread>
 
 #include <glog/logging.h>
 
@@ -15,13 +16,13 @@
 #include "src/mutex_impl.h"
 #include "src/options_helper.h"
 #include "src/redis_hyperloglog.h"
+#include "src/parallel_scanner.h"
 #include "src/type_iterator.h"
 #include "src/redis.h"
 #include "include/pika_conf.h"
 #include "pstd/include/pika_codis_slot.h"
 
 namespace storage {
-extern std::string BitOpOperate(BitOpType op, const std::vector<std::string>& src_values, int64_t max_len);
 class Redis;
 Status StorageOptions::ResetOptions(const OptionType& option_type,
                                     const std::unordered_map<std::string, std::string>& options_map) {
@@ -75,6 +76,7 @@ Storage::~Storage() {
     if ((ret = pthread_join(bg_tasks_thread_id_, nullptr)) != 0) {
       LOG(ERROR) << "pthread_join failed with bgtask thread error " << ret;
     }
+    scan_pool_->JoinAllThreads();
     for (auto& inst : insts_) {
       inst.reset();
     }
@@ -91,6 +93,7 @@ static std::string AppendSubDirectory(const std::string& db_path, int index) {
 
 Status Storage::Open(const StorageOptions& storage_options, const std::string& db_path) {
   mkpath(db_path.c_str(), 0755);
+  slot_key_prefix_num_ = storage_options.slot_key_prefix ? slot_num_ : 0;
 
   int inst_count = db_instance_num_;
   for (int index = 0; index < inst_count; index++) {
@@ -101,6 +104,10 @@ Status Storage::Open(const StorageOptions& storage_options, const std::string& d
     }
   }
 
+  // One reader per instance is enough to keep a scan busy, concurrent
+  // scans share it and read the rest themselves
+  scan_pool_.reset(rocksdb::NewThreadPool(inst_count));
+
   is_opened_.store(true);
   return Status::OK();
 }
@@ -134,6 +141,18 @@ std::unique_ptr<Redis>& Storage::GetDBInstance(const std::string& key) {
   return insts_[inst_index];
 }
 
+void Storage::GroupKeysByInstance(const std::vector<std::string>& keys,
+                                  std::vector<std::vector<std::string>>* inst_keys,
+                                  std::vector<std::vector<size_t>>* positions) {
+  inst_keys->assign(insts_.size(), {});
+  positions->assign(insts_.size(), {});
+  for (size_t idx = 0; idx < keys.size(); ++idx) {
+    auto inst_index = slot_indexer_->GetInstanceID(GetSlotID(slot_num_, keys[idx]));
+    (*inst_keys)[inst_index].push_back(keys[idx]);
+    (*positions)[inst_index].push_back(idx);
+  }
+}
+
 // Strings Commands
 Status Storage::Set(const Slice& key, const Slice& value) {
   auto& inst = GetDBInstance(key);
@@ -176,10 +195,27 @@ Status Storage::GetBit(const Slice& key, int64_t offset, int32_t* ret) {
 }
 
 Status Storage::MSet(const std::vector<KeyValue>& kvs) {
-  Status s;
+  std::vector<std::string> keys;
+  keys.reserve(kvs.size());
   for (const auto& kv : kvs) {
-    auto& inst = GetDBInstance(kv.key);
-    s = inst->Set(Slice(kv.key), Slice(kv.value));
+    keys.push_back(kv.key);
+  }
+  std::vector<std::vector<std::string>> inst_keys;
+  std::vector<std::vector<size_t>> positions;
+  GroupKeysByInstance(keys, &inst_keys, &positions);
+
+  // One WriteBatch per instance
+  Status s;
+  std::vector<KeyValue> inst_kvs;
+  for (size_t inst_index = 0; inst_index < insts_.size(); ++inst_index) {
+    if (positions[inst_index].empty()) {
+      continue;
+    }
+    inst_kvs.clear();
+    for (auto pos : positions[inst_index]) {
+      inst_kvs.push_back(kvs[pos]);
+    }
+    s = insts_[inst_index]->MSet(inst_kvs);
     if (!s.ok()) {
       return s;
     }
@@ -189,39 +225,50 @@ Status Storage::MSet(const std::vector<KeyValue>& kvs) {
 
 Status Storage::MGet(const std::vector<std::string>& keys, std::vector<ValueStatus>* vss) {
   vss->clear();
+  std::vector<std::vector<std::string>> inst_keys;
+  std::vector<std::vector<size_t>> positions;
+  GroupKeysByInstance(keys, &inst_keys, &positions);
+
   Status s;
-  for(const auto& key : keys) {
-    auto& inst = GetDBInstance(key);
-    std::string value;
-    s = inst->MGet(key, &value);
-    if (s.ok()) {
-      vss->push_back({value, Status::OK()});
-    } else if(s.IsNotFound()) {
-      vss->push_back({std::string(), Status::NotFound()});
-    } else {
+  std::vector<ValueStatus> inst_vss;
+  vss->resize(keys.size());
+  for (size_t inst_index = 0; inst_index < insts_.size(); ++inst_index) {
+    if (inst_keys[inst_index].empty()) {
+      continue;
+    }
+    s = insts_[inst_index]->MGet(inst_keys[inst_index], &inst_vss);
+    if (!s.ok()) {
       vss->clear();
       return s;
     }
+    for (size_t idx = 0; idx < inst_vss.size(); ++idx) {
+      (*vss)[positions[inst_index][idx]] = std::move(inst_vss[idx]);
+    }
   }
   return Status::OK();
 }
 
 Status Storage::MGetWithTTL(const std::vector<std::string>& keys, std::vector<ValueStatus>* vss) {
   vss->clear();
+  std::vector<std::vector<std::string>> inst_keys;
+  std::vector<std::vector<size_t>> positions;
+  GroupKeysByInstance(keys, &inst_keys, &positions);
+
   Status s;
-  for(const auto& key : keys) {
-    auto& inst = GetDBInstance(key);
-    std::string value;
-    int64_t ttl;
-    s = inst->MGetWithTTL(key, &value, &ttl);
-    if (s.ok()) {
-      vss->push_back({value, Status::OK(), ttl});
-    } else if (s.IsNotFound()) {
-      vss->push_back({std::string(), Status::NotFound(), ttl});
-    } else {
+  std::vector<ValueStatus> inst_vss;
+  vss->resize(keys.size());
+  for (size_t inst_index = 0; inst_index < insts_.size(); ++inst_index) {
+    if (inst_keys[inst_index].empty()) {
+      continue;
+    }
+    s = insts_[inst_index]->MGetWithTTL(inst_keys[inst_index], &inst_vss);
+    if (!s.ok()) {
       vss->clear();
       return s;
     }
+    for (size_t idx = 0; idx < inst_vss.size(); ++idx) {
+      (*vss)[positions[inst_index][idx]] = std::move(inst_vss[idx]);
+    }
   }
   return Status::OK();
 }
@@ -299,27 +346,16 @@ Status Storage::BitOp(BitOpType op, const std::string& dest_key, const std::vect
   assert(is_classic_mode_);
   if (op == storage::BitOpType::kBitOpNot && src_keys.size() >= 2) { return Status::InvalidArgument(); }
   Status s;
-  int64_t max_len = 0;
-  int64_t value_len = 0;
-  std::vector<std::string> src_values;
-  for (const auto& src_key : src_keys) {
-    auto& inst = GetDBInstance(src_key);
-    std::string value;
-    s = inst->Get(Slice(src_key), &value);
-    if (s.ok()) {
-      src_values.push_back(value);
-      value_len = value.size();
-    } else {
-      if (!s.IsNotFound()) {
-        return s;
-      }
-      src_values.push_back("");
-      value_len = 0;
+  // The sources are folded in one by one, so only one segment of a bitmap
+  // source is read at a time
+  std::string dest_value;
+  for (size_t i = 0; i < src_keys.size(); i++) {
+    auto& inst = GetDBInstance(src_keys[i]);
+    s = inst->BitOpApply(op, Slice(src_keys[i]), i == 0, &dest_value);
+    if (!s.ok()) {
+      return s;
     }
-    max_len = std::max(max_len, value_len);
   }
-
-  std::string dest_value = BitOpOperate(op, src_values, max_len);
   value_to_dest = dest_value;
   *ret = dest_value.size();
 
@@ -506,21 +542,26 @@ Status Storage::SDiff(const std::vector<std::string>& keys, std::vector<std::str
     return s;
   }
 
-  for (const auto& member : keys0_members) {
-    int32_t exist = 0;
-    for (int idx = 1; idx < keys.size(); idx++) {
-      Slice pkey = Slice(keys[idx]);
-      auto& inst = GetDBInstance(pkey);
-      s = inst->SIsmember(pkey, Slice(member), &exist);
-      if (!s.ok() && !s.IsNotFound()) {
-        return s;
-      }
-      if (exist) break;
+  // every other set removes the members it holds from the candidates
+  std::vector<int32_t> exists;
+  for (size_t idx = 1; idx < keys.size() && !keys0_members.empty(); idx++) {
+    auto& inst = GetDBInstance(keys[idx]);
+    s = inst->SMIsmember(keys[idx], keys0_members, &exists);
+    if (s.IsNotFound()) {
+      continue;
     }
-    if (!exist) {
-      members->push_back(member);
+    if (!s.ok()) {
+      return s;
     }
+    size_t remained = 0;
+    for (size_t pos = 0; pos < keys0_members.size(); ++pos) {
+      if (exists[pos] == 0) {
+        keys0_members[remained++] = std::move(keys0_members[pos]);
+      }
+    }
+    keys0_members.resize(remained);
   }
+  members->swap(keys0_members);
   return Status::OK();
 }
 
@@ -570,24 +611,26 @@ Status Storage::SInter(const std::vector<std::string>& keys, std::vector<std::st
     return s;
   }
 
-  for (const auto member : key0_members) {
-    int32_t exist = 1;
-    for (int idx = 1; idx < keys.size(); idx++) {
-      Slice pkey(keys[idx]);
-      auto& inst = GetDBInstance(keys[idx]);
-      s = inst->SIsmember(keys[idx], member, &exist);
-      if (s.ok() && exist > 0) {
-        continue;
-      } else if (!s.IsNotFound()) {
-        return s;
-      } else {
-        break;
-      }
+  // every other set keeps only the candidates it holds
+  std::vector<int32_t> exists;
+  for (size_t idx = 1; idx < keys.size() && !key0_members.empty(); idx++) {
+    auto& inst = GetDBInstance(keys[idx]);
+    s = inst->SMIsmember(keys[idx], key0_members, &exists);
+    if (s.IsNotFound()) {
+      return Status::OK();
+    }
+    if (!s.ok()) {
+      return s;
     }
-    if (exist > 0) {
-      members->push_back(member);
+    size_t remained = 0;
+    for (size_t pos = 0; pos < key0_members.size(); ++pos) {
+      if (exists[pos] != 0) {
+        key0_members[remained++] = std::move(key0_members[pos]);
+      }
     }
+    key0_members.resize(remained);
   }
+  members->swap(key0_members);
   return Status::OK();
 }
 
@@ -1004,7 +1047,7 @@ Status Storage::ZUnionstore(const Slice& destination, const std::vector<std::str
     }
   }
 
-  BaseMetaKey base_destination(destination);
+  BaseMetaKey base_destination(destination, slot_key_prefix_num_);
   auto& inst = GetDBInstance(destination);
   s = inst->ZsetsDel(destination);
   if (!s.ok() && !s.IsNotFound()) {
@@ -1075,7 +1118,7 @@ Status Storage::ZInterstore(const Slice& destination, const std::vector<std::str
     }
   }
 
-  BaseMetaKey base_destination(destination);
+  BaseMetaKey base_destination(destination, slot_key_prefix_num_);
   auto& ninst = GetDBInstance(destination);
 
   s = ninst->ZsetsDel(destination);
@@ -1184,33 +1227,68 @@ int32_t Storage::Expire(const Slice& key, int64_t ttl) {
 
 
 int64_t Storage::Del(const std::vector<std::string>& keys) {
-  Status s;
+  std::vector<std::vector<std::string>> inst_keys;
+  std::vector<std::vector<size_t>> positions;
+  GroupKeysByInstance(keys, &inst_keys, &positions);
+
   int64_t count = 0;
-  for (const auto& key : keys) {
-    auto& inst = GetDBInstance(key);
-    s = inst->Del(key);
-    if (s.ok()) {
-      count++;
+  for (size_t inst_index = 0; inst_index < insts_.size(); ++inst_index) {
+    if (inst_keys[inst_index].empty()) {
+      continue;
     }
+    int64_t inst_count = 0;
+    insts_[inst_index]->Del(inst_keys[inst_index], &inst_count);
+    count += inst_count;
   }
   return count;
 }
 
 int64_t Storage::Exists(const std::vector<std::string>& keys) {
+  std::vector<std::vector<std::string>> inst_keys;
+  std::vector<std::vector<size_t>> positions;
+  GroupKeysByInstance(keys, &inst_keys, &positions);
+
   int64_t count = 0;
-  Status s;
-  for (const auto& key : keys) {
-    auto& inst = GetDBInstance(key);
-    s = inst->Exists(key);
-    if (s.ok()) {
-      count++;
-    } else if (!s.IsNotFound()) {
+  for (size_t inst_index = 0; inst_index < insts_.size(); ++inst_index) {
+    if (inst_keys[inst_index].empty()) {
+      continue;
+    }
+    int64_t inst_count = 0;
+    Status s = insts_[inst_index]->Exists(inst_keys[inst_index], &inst_count);
+    if (!s.ok()) {
       return -1;
     }
+    count += inst_count;
   }
   return count;
 }
 
+/*
+ * The encoded meta keys of all the keys starting with the literal prefix of
+ * a tail wildcard pattern lie in [lower, upper), upper is empty when there
+ * is no bound above. Returns false when the pattern has no literal prefix or
+ * keys are ordered by slot first.
+ */
+static bool PatternKeyBounds(const std::string& pattern, bool slot_key_prefix, std::string* lower,
+                             std::string* upper) {
+  if (slot_key_prefix || !isTailWildcard(pattern) || pattern.find('\\') != std::string::npos) {
+    return false;
+  }
+  // Only reached in the classic layout, whose reserve1 is all zero
+  BaseMetaKey prefix_key(pattern.substr(0, pattern.size() - 1), 0);
+  Slice encoded = prefix_key.Encode();
+  // Without the delimiter and reserve2, the encoded prefix of every such key
+  lower->assign(encoded.data(), encoded.size() - kEncodedKeyDelimSize - kSuffixReserveLength);
+  *upper = *lower;
+  while (!upper->empty() && static_cast<uint8_t>(upper->back()) == 0xff) {
+    upper->pop_back();
+  }
+  if (!upper->empty()) {
+    upper->back() = static_cast<char>(static_cast<uint8_t>(upper->back()) + 1);
+  }
+  return true;
+}
+
 int64_t Storage::Scan(const DataType& dtype, int64_t cursor, const std::string& pattern, int64_t count,
                       std::vector<std::string>* keys) {
   assert(is_classic_mode_);
@@ -1231,7 +1309,11 @@ int64_t Storage::Scan(const DataType& dtype, int64_t cursor, const std::string&
 
   // get seek by corsor
   prefix = isTailWildcard(pattern) ? pattern.substr(0, pattern.size() - 1) : "";
+  // keys are ordered by slot first in the slot prefix layout, so the
+  // pattern prefix can neither narrow where the scan starts nor ends
+  bool slot_key_prefix = slot_key_prefix_num_ != 0;
   Status s = LoadCursorStartKey(dtype, cursor, &key_type, &start_key);
+  bool from_beginning = !s.ok();
   if (!s.ok()) {
     // If want to scan all the databases, we start with the strings database
     key_type = dtype == DataType::kAll ? DataTypeTag[static_cast<int>(DataType::kStrings)] : DataTypeTag[static_cast<int>(dtype)];
@@ -1257,18 +1339,27 @@ int64_t Storage::Scan(const DataType& dtype, int64_t cursor, const std::string&
     types.push_back(DataTypeTag[static_cast<int>(dtype)]);
   }
 
+  std::string lower_bound;
+  std::string upper_bound;
+  bool bounded = PatternKeyBounds(pattern, slot_key_prefix, &lower_bound, &upper_bound);
+  Slice lower_slice(lower_bound);
+  Slice upper_slice(upper_bound);
   for (const auto& type : types) {
     std::vector<IterSptr> inst_iters;
     for (const auto& inst : insts_) {
       IterSptr iter_sptr;
-      iter_sptr.reset(inst->CreateIterator(type, pattern,
-          nullptr/*lower_bound*/, nullptr/*upper_bound*/));
+      iter_sptr.reset(inst->CreateIterator(type, pattern, bounded ? &lower_slice : nullptr,
+                                           bounded && !upper_bound.empty() ? &upper_slice : nullptr));
       inst_iters.push_back(iter_sptr);
     }
 
-    BaseMetaKey base_start_key(start_key);
+    BaseMetaKey base_start_key(start_key, slot_key_prefix_num_);
     MergingIterator miter(inst_iters);
-    miter.Seek(base_start_key.Encode().ToString());
+    if (slot_key_prefix && from_beginning) {
+      miter.SeekToFirst();
+    } else {
+      miter.Seek(base_start_key.Encode().ToString());
+    }
     while (miter.Valid() && count > 0) {
       keys->push_back(miter.Key());
       miter.Next();
@@ -1277,7 +1368,7 @@ int64_t Storage::Scan(const DataType& dtype, int64_t cursor, const std::string&
 
     bool is_finish = !miter.Valid();
     if (miter.Valid() &&
-      (miter.Key().compare(prefix) <= 0 ||
+      (slot_key_prefix || miter.Key().compare(prefix) <= 0 ||
        miter.Key().substr(0, prefix.size()) == prefix)) {
       is_finish = false;
     }
@@ -1298,6 +1389,7 @@ int64_t Storage::Scan(const DataType& dtype, int64_t cursor, const std::string&
 
     // for all type scan, move to next type, reset start_key
     start_key = prefix;
+    from_beginning = true;
   }
   return cursor_ret;
 }
@@ -1306,11 +1398,14 @@ Status Storage::PKScanRange(const DataType& data_type, const Slice& key_start, c
                             const Slice& pattern, int32_t limit, std::vector<std::string>* keys,
                             std::vector<KeyValue>* kvs, std::string* next_key) {
   next_key->clear();
+  if (slot_key_prefix_num_ != 0) {
+    return Status::NotSupported("keys are not ordered by name in the slot prefix layout");
+  }
   std::string key;
   std::string value;
 
-  BaseMetaKey base_key_start(key_start);
-  BaseMetaKey base_key_end(key_end);
+  BaseMetaKey base_key_start(key_start, slot_key_prefix_num_);
+  BaseMetaKey base_key_end(key_end, slot_key_prefix_num_);
   Slice base_key_end_slice(base_key_end.Encode());
 
   bool start_no_limit = key_start.empty();
@@ -1356,9 +1451,12 @@ Status Storage::PKRScanRange(const DataType& data_type, const Slice& key_start,
                              const Slice& pattern, int32_t limit, std::vector<std::string>* keys,
                              std::vector<KeyValue>* kvs, std::string* next_key) {
   next_key->clear();
+  if (slot_key_prefix_num_ != 0) {
+    return Status::NotSupported("keys are not ordered by name in the slot prefix layout");
+  }
   std::string key, value;
-  BaseMetaKey base_key_start(key_start);
-  BaseMetaKey base_key_end(key_end);
+  BaseMetaKey base_key_start(key_start, slot_key_prefix_num_);
+  BaseMetaKey base_key_end(key_end, slot_key_prefix_num_);
   Slice base_key_start_slice = Slice(base_key_start.Encode());
 
   bool start_no_limit = key_start.empty();
@@ -1419,17 +1517,27 @@ Status Storage::Scanx(const DataType& data_type, const std::string& start_key, c
   keys->clear();
   next_key->clear();
 
+  bool slot_key_prefix = slot_key_prefix_num_ != 0;
+  std::string lower_bound;
+  std::string upper_bound;
+  bool bounded = PatternKeyBounds(pattern, slot_key_prefix, &lower_bound, &upper_bound);
+  Slice lower_slice(lower_bound);
+  Slice upper_slice(upper_bound);
   std::vector<IterSptr> inst_iters;
   for (const auto& inst : insts_) {
     IterSptr iter_sptr;
-    iter_sptr.reset(inst->CreateIterator(data_type, pattern,
-        nullptr/*lower_bound*/, nullptr/*upper_bound*/));
+    iter_sptr.reset(inst->CreateIterator(data_type, pattern, bounded ? &lower_slice : nullptr,
+                                         bounded && !upper_bound.empty() ? &upper_slice : nullptr));
     inst_iters.push_back(iter_sptr);
   }
 
-  BaseMetaKey base_start_key(start_key);
+  BaseMetaKey base_start_key(start_key, slot_key_prefix_num_);
   MergingIterator miter(inst_iters);
-  miter.Seek(base_start_key.Encode().ToString());
+  if (slot_key_prefix && start_key.empty()) {
+    miter.SeekToFirst();
+  } else {
+    miter.Seek(base_start_key.Encode().ToString());
+  }
   while (miter.Valid() && count > 0) {
     keys->push_back(miter.Key());
     miter.Next();
@@ -1437,7 +1545,8 @@ Status Storage::Scanx(const DataType& data_type, const std::string& start_key, c
   }
 
   std::string prefix = isTailWildcard(pattern) ? pattern.substr(0, pattern.size() - 1) : "";
-  if (miter.Valid() && (miter.Key().compare(prefix) <= 0 || miter.Key().substr(0, prefix.size()) == prefix)) {
+  if (miter.Valid() && (slot_key_prefix || miter.Key().compare(prefix) <= 0 ||
+                        miter.Key().substr(0, prefix.size()) == prefix)) {
     *next_key = miter.Key();
   } else {
     *next_key = "";
@@ -1490,26 +1599,29 @@ Status Storage::GetType(const std::string& key, enum DataType& type) {
 
 Status Storage::Keys(const DataType& data_type, const std::string& pattern, std::vector<std::string>* keys) {
   keys->clear();
-  std::vector<DataType> types;
-  types.push_back(data_type);
-
-  for (const auto& type : types) {
-    std::vector<IterSptr> inst_iters;
-    for (const auto& inst : insts_) {
-      IterSptr inst_iter;
-      inst_iter.reset(inst->CreateIterator(type, pattern, nullptr /*lower_bound*/, nullptr /*upper_bound*/));
-      inst_iters.push_back(inst_iter);
-    }
-
-    MergingIterator miter(inst_iters);
-    miter.SeekToFirst();
-    while (miter.Valid()) {
-      keys->push_back(miter.Key());
-      miter.Next();
-    }
+  return ScanKeys(data_type, pattern, [keys](const std::string& key) {
+    keys->push_back(key);
+    return true;
+  });
+}
+
+Status Storage::ScanKeys(const DataType& data_type, const std::string& pattern,
+                         const std::function<bool(const std::string& key)>& visit) {
+  std::string lower_bound;
+  std::string upper_bound;
+  bool bounded = PatternKeyBounds(pattern, slot_key_prefix_num_ != 0, &lower_bound, &upper_bound);
+  Slice lower_slice(lower_bound);
+  Slice upper_slice(upper_bound);
+  std::vector<IterSptr> inst_iters;
+  for (const auto& inst : insts_) {
+    IterSptr inst_iter;
+    inst_iter.reset(inst->CreateIterator(data_type, pattern, bounded ? &lower_slice : nullptr,
+                                         bounded && !upper_bound.empty() ? &upper_slice : nullptr));
+    inst_iters.push_back(inst_iter);
   }
 
-  return Status::OK();
+  ParallelScanner scanner(std::move(inst_iters), scan_pool_.get());
+  return scanner.Scan(nullptr, visit);
 }
 
 void Storage::ScanDatabase(const DataType& type) {
@@ -1563,16 +1675,20 @@ Status Storage::PfAdd(const Slice& key, const std::vector<std::string>& values,
   } else {
     return s;
   }
+  // Registers are decoded once and re-encoded once per command
   HyperLogLog log(kPrecision, registers);
-  auto previous = static_cast<int32_t>(log.Estimate());
   for (const auto& value : values) {
-    result = log.Add(value.data(), value.size());
+    if (log.Add(value.data(), value.size())) {
+      *update = true;
+    }
   }
-  HyperLogLog update_log(kPrecision, result);
-  auto now = static_cast<int32_t>(update_log.Estimate());
-  if (previous != now || (s.IsNotFound() && values.empty())) {
+  if (s.IsNotFound()) {
     *update = true;
   }
+  if (!*update) {
+    return Status::OK();
+  }
+  result = log.Encode();
   s = inst->HyperloglogSet(key, result);
   return s;
 }
@@ -1630,7 +1746,6 @@ Status Storage::PfMerge(const std::vector<std::string>& keys, std::string& value
     first_registers = "";
   }
 
-  result = first_registers;
   HyperLogLog first_log(kPrecision, first_registers);
   for (size_t i = 1; i < keys.size(); ++i) {
     std::string value;
@@ -1645,8 +1760,9 @@ Status Storage::PfMerge(const std::vector<std::string>& keys, std::string& value
       return s;
     }
     HyperLogLog log(kPrecision, registers);
-    result = first_log.Merge(log);
+    first_log.Merge(log);
   }
+  result = first_log.Encode();
   auto& ninst = GetDBInstance(keys[0]);
   s = ninst->HyperloglogSet(keys[0], result);
   value_to_dest = std::move(result);
@@ -1708,6 +1824,9 @@ Status Storage::RunBGTask() {
       if (task.argv.size() == 2) {
         DoCompactRange(task.type, task.argv.front(), task.argv.back());
       }
+    } else if (task.operation == kReapExpiredKeys) {
+      reap_task_queued_ = false;
+      DoReapExpiredKeys(std::stoll(task.argv.front()));
     }
   }
   return Status::OK();
@@ -1729,8 +1848,11 @@ Status Storage::DoCompactRange(const DataType& type, const std::string& start, c
   }
 
   std::string start_key, end_key;
-  CalculateStartAndEndKey(start, &start_key, nullptr);
-  CalculateStartAndEndKey(end, nullptr, &end_key);
+  // a key range spans every slot in the slot prefix layout
+  if (slot_key_prefix_num_ == 0) {
+    CalculateStartAndEndKey(start, slot_key_prefix_num_, &start_key, nullptr);
+    CalculateStartAndEndKey(end, slot_key_prefix_num_, nullptr, &end_key);
+  }
   Slice slice_start_key(start_key);
   Slice slice_end_key(end_key);
   Slice* start_ptr = slice_start_key.empty() ? nullptr : &slice_start_key;
@@ -1760,13 +1882,40 @@ Status Storage::DoCompactSpecificKey(const DataType& type, const std::string& ke
 
   std::string start_key;
   std::string end_key;
-  CalculateStartAndEndKey(key, &start_key, &end_key);
+  CalculateStartAndEndKey(key, slot_key_prefix_num_, &start_key, &end_key);
   Slice slice_begin(start_key);
   Slice slice_end(end_key);
   s = inst->CompactRange(&slice_begin, &slice_end);
   return s;
 }
 
+Status Storage::ReapExpiredKeys(int64_t max_keys, bool sync) {
+  if (sync) {
+    return DoReapExpiredKeys(max_keys);
+  }
+  // kNones keeps the queued compactions, a kAll task would drop them
+  if (!reap_task_queued_.exchange(true)) {
+    AddBGTask({DataType::kNones, kReapExpiredKeys, {std::to_string(max_keys)}});
+  }
+  return Status::OK();
+}
+
+Status Storage::DoReapExpiredKeys(int64_t max_keys) {
+  Status s;
+  for (const auto& inst : insts_) {
+    int64_t reaped = 0;
+    uint64_t reclaimed = 0;
+    s = inst->ReapExpiredKeys(max_keys, &reaped, &reclaimed);
+    reaped_keys_ += reaped;
+    reclaimed_bytes_ += reclaimed;
+    if (!s.ok()) {
+      LOG(WARNING) << "reap expired keys of db " << inst->GetIndex() << " failed: " << s.ToString();
+      break;
+    }
+  }
+  return s;
+}
+
 Status Storage::SetMaxCacheStatisticKeys(uint32_t max_cache_statistic_keys) {
   for (const auto& inst : insts_) {
     inst->SetMaxCacheStatisticKeys(max_cache_statistic_keys);
@@ -1788,6 +1937,74 @@ Status Storage::SetSmallCompactionDurationThreshold(uint32_t small_compaction_du
   return Status::OK();
 }
 
+Status Storage::SetZSetsRankIndexThreshold(uint32_t zset_rank_index_threshold) {
+  for (const auto& inst : insts_) {
+    inst->SetZSetsRankIndexThreshold(zset_rank_index_threshold);
+  }
+  return Status::OK();
+}
+
+Status Storage::ScanSlot(uint32_t slot, int64_t cursor, const std::string& pattern, int64_t count,
+                         std::vector<std::string>* keys, int64_t* next_cursor) {
+  keys->clear();
+  *next_cursor = 0;
+  if (slot_key_prefix_num_ == 0) {
+    return Status::NotSupported("slot prefix layout is not enabled");
+  }
+  if (slot >= static_cast<uint32_t>(slot_num_) || cursor < 0) {
+    return Status::InvalidArgument("invalid slot or cursor");
+  }
+  auto& inst = insts_[slot_indexer_->GetInstanceID(slot)];
+  return inst->ScanSlot(slot, cursor, pattern, count, keys, next_cursor);
+}
+
+Status Storage::SlotKeyNum(uint32_t slot, int64_t* num) {
+  *num = 0;
+  if (slot_key_prefix_num_ == 0) {
+    return Status::NotSupported("slot prefix layout is not enabled");
+  }
+  if (slot >= static_cast<uint32_t>(slot_num_)) {
+    return Status::InvalidArgument("invalid slot");
+  }
+  auto& inst = insts_[slot_indexer_->GetInstanceID(slot)];
+  return inst->SlotKeyNum(slot, num);
+}
+
+Status Storage::DeleteSlots(const std::vector<uint32_t>& slots) {
+  if (slot_key_prefix_num_ == 0) {
+    return Status::NotSupported("slot prefix layout is not enabled");
+  }
+  Status s;
+  for (const auto slot : slots) {
+    if (slot >= static_cast<uint32_t>(slot_num_)) {
+      return Status::InvalidArgument("invalid slot");
+    }
+    s = insts_[slot_indexer_->GetInstanceID(slot)]->DeleteSlot(slot);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  return s;
+}
+
+Status Storage::ConvertToSlotKeyPrefix(Storage* target, int64_t* converted) {
+  *converted = 0;
+  if (target->insts_.size() != insts_.size() || target->slot_num_ != slot_num_ ||
+      target->slot_key_prefix_num_ == 0) {
+    return Status::InvalidArgument("target has a different db instance or slot number");
+  }
+  Status s;
+  for (size_t index = 0; index < insts_.size(); ++index) {
+    int64_t inst_converted = 0;
+    s = insts_[index]->ConvertToSlotKeyPrefix(target->insts_[index].get(), slot_num_, &inst_converted);
+    *converted += inst_converted;
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  return s;
+}
+
 std::string Storage::GetCurrentTaskType() {
   int type = current_task_type_;
   switch (type) {
@@ -1830,19 +2047,30 @@ uint64_t Storage::GetProperty(const std::string& property) {
 }
 
 Status Storage::GetKeyNum(std::vector<KeyInfo>* key_infos) {
-  KeyInfo key_info;
   key_infos->resize(DataTypeNum);
-  for (const auto& db : insts_) {
-    std::vector<KeyInfo> db_key_infos;
-    // check the scanner was stopped or not, before scanning the next db
-    if (scan_keynum_exit_) {
-      break;
+  // The instances are counted in parallel
+  std::vector<std::vector<KeyInfo>> inst_key_infos(insts_.size());
+  std::vector<Status> inst_status(insts_.size());
+  std::vector<std::thread> scanners;
+  for (size_t i = 0; i < insts_.size(); i++) {
+    scanners.emplace_back([this, i, &inst_key_infos, &inst_status] {
+      // check the scanner was stopped or not, before scanning the db
+      if (!scan_keynum_exit_) {
+        inst_status[i] = insts_[i]->ScanKeyNum(&inst_key_infos[i]);
+      }
+    });
+  }
+  for (auto& scanner : scanners) {
+    scanner.join();
+  }
+  for (size_t i = 0; i < insts_.size(); i++) {
+    if (!inst_status[i].ok()) {
+      return inst_status[i];
     }
-    auto s = db->ScanKeyNum(&db_key_infos);
-    if (!s.ok()) {
-      return s;
+    if (inst_key_infos[i].empty()) {
+      continue;
     }
-    std::transform(db_key_infos.begin(), db_key_infos.end(),
+    std::transform(inst_key_infos[i].begin(), inst_key_infos[i].end(),
         key_infos->begin(), key_infos->begin(), std::plus<>{});
   }
   if (scan_keynum_exit_) {
@@ -1866,6 +2094,13 @@ rocksdb::DB* Storage::GetDBByIndex(int index) {
   return insts_[index]->GetDB();
 }
 
+Status Storage::GetPropertiesOfAllTables(int index, rocksdb::TablePropertiesCollection* props) {
+  if (index < 0 || index >= db_instance_num_) {
+    return Status::InvalidArgument("invalid db index " + std::to_string(index));
+  }
+  return insts_[index]->GetPropertiesOfAllTables(props);
+}
+
 Status Storage::SetOptions(const OptionType& option_type, const std::string& db_type,
     const std::unordered_map<std::string, std::string>& options) {
   Status s;
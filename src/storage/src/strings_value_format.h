@@ -17,9 +17,12 @@ namespace storage {
 * | type | value | reserve | cdate | timestamp |
 * |  1B  |       |   16B   |   8B  |     8B    |
 *  The first bit in reservse field is used to isolate string and hyperloglog  
+*  The second bit marks the meta of a segmented bitmap, see BitmapMetaValue
 */
  // 80H = 1000000B
 constexpr uint8_t hyperloglog_reserve_flag = 0x80;
+ // 40H = 0100000B
+constexpr uint8_t bitmap_reserve_flag = 0x40;
 class StringsValue : public InternalValue {
  public:
   explicit StringsValue(const rocksdb::Slice& user_value) : InternalValue(DataType::kStrings, user_value) {}
@@ -65,6 +68,41 @@ class HyperloglogValue : public InternalValue {
   }
 };
 
+/*
+ * A bitmap longer than one segment keeps its bytes in kBitmapsDataCF and
+ * only this in place of the value of the string:
+ * | length | version |
+ * |   8B   |    8B   |
+ */
+class BitmapMetaValue : public InternalValue {
+ public:
+  BitmapMetaValue(uint64_t length, uint64_t version) : InternalValue(DataType::kStrings, rocksdb::Slice()) {
+    EncodeFixed64(bitmap_, length);
+    EncodeFixed64(bitmap_ + sizeof(uint64_t), version);
+    user_value_ = rocksdb::Slice(bitmap_, sizeof(bitmap_));
+  }
+  virtual rocksdb::Slice Encode() override {
+    size_t usize = user_value_.size();
+    size_t needed = usize + kSuffixReserveLength + 2 * kTimestampLength + kTypeLength;
+    char* dst = ReAllocIfNeeded(needed);
+    memcpy(dst, &type_, sizeof(type_));
+    dst += sizeof(type_);
+
+    memcpy(dst, user_value_.data(), usize);
+    dst += usize;
+    reserve_[0] |= bitmap_reserve_flag;
+    memcpy(dst, reserve_, kSuffixReserveLength);
+    dst += kSuffixReserveLength;
+    EncodeFixed64(dst, ctime_);
+    dst += kTimestampLength;
+    EncodeFixed64(dst, etime_);
+    return {start_, needed};
+  }
+
+ private:
+  char bitmap_[2 * sizeof(uint64_t)];
+};
+
 class ParsedStringsValue : public ParsedInternalValue {
  public:
   // Use this constructor after rocksdb::DB::Get();
@@ -107,6 +145,13 @@ class ParsedStringsValue : public ParsedInternalValue {
     }
   }
 
+  bool IsBitmap() {
+    return (static_cast<uint8_t>(reserve_[0]) & bitmap_reserve_flag) != 0 && user_value_.size() == kBitmapMetaLength;
+  }
+  // The length and version of a bitmap, only valid when IsBitmap()
+  uint64_t BitmapLength() { return DecodeFixed64(user_value_.data()); }
+  uint64_t BitmapVersion() { return DecodeFixed64(user_value_.data() + sizeof(uint64_t)); }
+
   // Strings type do not have version field;
   void SetVersionToValue() override {}
 
@@ -129,6 +174,7 @@ class ParsedStringsValue : public ParsedInternalValue {
 private:
  const static size_t kStringsValueSuffixLength = 2 * kTimestampLength + kSuffixReserveLength;
  const static size_t kStringsValueMinLength = kStringsValueSuffixLength + kTypeLength;
+ const static size_t kBitmapMetaLength = 2 * sizeof(uint64_t);
 };
 
 }  //  namespace storage
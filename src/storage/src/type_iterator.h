@@ -23,6 +23,7 @@
 #include "src/base_data_key_format.h"
 #include "src/base_key_format.h"
 #include "src/base_meta_value_format.h"
+#include "src/bitmap_segments.h"
 #include "src/strings_value_format.h"
 #include "src/lists_meta_value_format.h"
 #include "src/pika_stream_meta_value.h"
@@ -89,6 +90,8 @@ public:
 
   virtual std::string Key() const { return user_key_; }
 
+  Slice RawKey() const { return raw_iter_->key(); }
+
   virtual std::string Value() const {return user_value_; }
 
   virtual bool Valid() { return raw_iter_->Valid(); }
@@ -112,11 +115,30 @@ protected:
 class StringsIterator : public TypeIterator {
 public:
   StringsIterator(const rocksdb::ReadOptions& options, rocksdb::DB* db,
-                  ColumnFamilyHandle* handle,
-                  const std::string& pattern)
-      : TypeIterator(options, db, handle), pattern_(pattern) {}
+                  ColumnFamilyHandle* handle, ColumnFamilyHandle* bitmap_handle,
+                  const std::string& pattern, int slot_num)
+      : TypeIterator(options, db, handle), db_(db), bitmap_handle_(bitmap_handle), pattern_(pattern),
+        slot_num_(slot_num) {
+    // The bounds are meta keys, they do not apply to the segments
+    bitmap_options_.snapshot = options.snapshot;
+    bitmap_options_.fill_cache = false;
+  }
   ~StringsIterator() {}
 
+  // The bytes of a bitmap are only read when its value is asked for
+  std::string Value() const override {
+    if (!is_bitmap_) {
+      return user_value_;
+    }
+    std::string value;
+    BitmapSegments segments(db_, bitmap_handle_, bitmap_options_, user_key_, bitmap_version_, slot_num_);
+    Status s = segments.Assemble(bitmap_length_, &value);
+    if (!s.ok()) {
+      LOG(WARNING) << "read bitmap " << user_key_ << " failed: " << s.ToString();
+    }
+    return value;
+  }
+
   bool ShouldSkip() override {
     auto type = static_cast<DataType>(static_cast<uint8_t>(raw_iter_->value()[0]));
     if (type != DataType::kStrings) {
@@ -134,11 +156,25 @@ public:
     }
 
     user_key_ = parsed_key.Key().ToString();
-    user_value_ = parsed_value.UserValue().ToString();
+    is_bitmap_ = parsed_value.IsBitmap();
+    if (is_bitmap_) {
+      bitmap_length_ = parsed_value.BitmapLength();
+      bitmap_version_ = parsed_value.BitmapVersion();
+      user_value_.clear();
+    } else {
+      user_value_ = parsed_value.UserValue().ToString();
+    }
     return false;
   }
 private:
+  rocksdb::DB* db_ = nullptr;
+  ColumnFamilyHandle* bitmap_handle_ = nullptr;
+  rocksdb::ReadOptions bitmap_options_;
+  bool is_bitmap_ = false;
+  uint64_t bitmap_length_ = 0;
+  uint64_t bitmap_version_ = 0;
   std::string pattern_;
+  int slot_num_ = 0;
 };
 
 class HashesIterator : public TypeIterator {
@@ -360,11 +396,10 @@ using IterSptr = std::shared_ptr<TypeIterator>;
 class MinMergeComparator {
 public:
   MinMergeComparator() = default;
+  // Compare the encoded keys, which follow the order of the user keys
+  // except in the slot prefix layout, where they are ordered by slot first
   bool operator() (IterSptr a, IterSptr b) {
-
-    int a_len = a->Key().size();
-    int b_len = b->Key().size();
-    return a->Key().compare(b->Key()) > 0;
+    return a->RawKey().compare(b->RawKey()) > 0;
   }
 };
 
@@ -372,9 +407,7 @@ class MaxMergeComparator {
 public:
   MaxMergeComparator() = default;
   bool operator() (IterSptr a, IterSptr b) {
-    int a_len = a->Key().size();
-    int b_len = b->Key().size();
-    return a->Key().compare(b->Key()) < 0;
+    return a->RawKey().compare(b->RawKey()) < 0;
   }
 };
 
@@ -4,6 +4,7 @@
 //  of patent rights can be found in the PATENTS file in the same directory.
 
 #include <unistd.h>
+#include <atomic>
 #include <cctype>
 #include <climits>
 #include <cstdint>
@@ -20,6 +21,20 @@
 
 namespace storage {
 
+void EncodeSlotPrefix(uint32_t slot, char* dst) {
+  memset(dst, 0, kPrefixReserveLength);
+  dst[0] = static_cast<char>((slot >> 8) & 0xff);
+  dst[1] = static_cast<char>(slot & 0xff);
+}
+
+void EncodeKeyPrefix(int slot_num, const Slice& user_key, char* dst) {
+  if (slot_num == 0) {
+    memset(dst, 0, kPrefixReserveLength);
+    return;
+  }
+  EncodeSlotPrefix(GetSlotID(slot_num, user_key.data(), user_key.size()), dst);
+}
+
 /* Convert a long long into a string. Returns the number of
  * characters needed to represent the number.
  * If the buffer is not big enough to store the string, 0 is returned.
@@ -208,7 +223,7 @@ int is_dir(const char* filename) {
   return -1;
 }
 
-int CalculateStartAndEndKey(const std::string& key, std::string* start_key, std::string* end_key) {
+int CalculateStartAndEndKey(const std::string& key, int slot_num, std::string* start_key, std::string* end_key) {
   if (key.empty()) {
     return 0;
   }
@@ -217,7 +232,7 @@ int CalculateStartAndEndKey(const std::string& key, std::string* start_key, std:
   usize += nzero;
   auto dst = std::make_unique<char[]>(usize);
   char* ptr = dst.get();
-  memset(ptr, kNeedTransformCharacter, kPrefixReserveLength);
+  EncodeKeyPrefix(slot_num, Slice(key), ptr);
   ptr += kPrefixReserveLength;
   ptr = storage::EncodeUserKey(Slice(key), ptr, nzero);
   if (start_key) {
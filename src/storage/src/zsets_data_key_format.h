@@ -18,9 +18,9 @@ namespace storage {
 class ZSetsScoreKey {
  public:
   ZSetsScoreKey(const Slice& key, uint64_t version,
-                double score, const Slice& member)
+                double score, const Slice& member, int slot_num)
       : key_(key), version_(version),
-        score_(score), member_(member) {}
+        score_(score), member_(member), slot_num_(slot_num) {}
 
   ~ZSetsScoreKey() {
     if (start_ != space_) {
@@ -48,7 +48,7 @@ class ZSetsScoreKey {
 
     start_ = dst;
     // reserve1: 8 byte
-    memcpy(dst, reserve1_, sizeof(reserve1_));
+    EncodeKeyPrefix(slot_num_, key_, dst);
     dst += sizeof(reserve1_);
     // key
     dst = EncodeUserKey(key_, dst, nzero);
@@ -75,6 +75,8 @@ class ZSetsScoreKey {
   uint64_t version_ = uint64_t(-1);
   double score_ = 0.0;
   Slice member_;
+  // SlotKeyPrefixNum() of the storage
+  int slot_num_ = 0;
   char reserve2_[16] = {0};
 };
 
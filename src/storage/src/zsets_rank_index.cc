@@ -0,0 +1,125 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "src/zsets_rank_index.h"
+
+#include <algorithm>
+
+namespace storage {
+
+ZSetsRankIndex::ZSetsRankIndex(uint64_t version, const rocksdb::Comparator* comparator)
+    : version_(version), comparator_(comparator), bounds_(1), counts_(1, 0) {
+  Rebuild();
+}
+
+void ZSetsRankIndex::Append(const Slice& score_key) {
+  if (counts_.back() >= kBucketSize) {
+    bounds_.emplace_back(score_key.data(), score_key.size());
+    counts_.push_back(0);
+  }
+  counts_.back()++;
+  total_++;
+}
+
+void ZSetsRankIndex::FinishBuild() { Rebuild(); }
+
+int64_t ZSetsRankIndex::Insert(const Slice& score_key) {
+  size_t bucket = BucketOf(score_key);
+  counts_[bucket]++;
+  total_++;
+  TreeAdd(bucket, 1);
+  return counts_[bucket] > 2 * kBucketSize ? static_cast<int64_t>(bucket) : -1;
+}
+
+bool ZSetsRankIndex::Erase(const Slice& score_key) {
+  size_t bucket = BucketOf(score_key);
+  if (counts_[bucket] == 0) {
+    return false;
+  }
+  counts_[bucket]--;
+  total_--;
+  if (counts_[bucket] != 0 || bounds_.size() == 1) {
+    TreeAdd(bucket, -1);
+    return true;
+  }
+  // The first bucket always starts from the beginning of the zset,
+  // so it takes over the second bucket instead of being removed
+  if (bucket == 0) {
+    counts_[0] = counts_[1];
+    bucket = 1;
+  }
+  bounds_.erase(bounds_.begin() + static_cast<int64_t>(bucket));
+  counts_.erase(counts_.begin() + static_cast<int64_t>(bucket));
+  Rebuild();
+  return true;
+}
+
+void ZSetsRankIndex::Split(size_t bucket, int64_t offset, const Slice& split_key) {
+  int64_t moved = counts_[bucket] - offset;
+  counts_[bucket] = offset;
+  bounds_.emplace(bounds_.begin() + static_cast<int64_t>(bucket) + 1, split_key.data(), split_key.size());
+  counts_.insert(counts_.begin() + static_cast<int64_t>(bucket) + 1, moved);
+  Rebuild();
+}
+
+int64_t ZSetsRankIndex::Seek(const Slice& score_key, std::string* bound) const {
+  size_t bucket = BucketOf(score_key);
+  *bound = bounds_[bucket];
+  return Prefix(bucket);
+}
+
+int64_t ZSetsRankIndex::SeekRank(int64_t rank, std::string* bound) const {
+  size_t n = counts_.size();
+  size_t pos = 0;
+  int64_t rest = rank;
+  size_t step = 1;
+  while ((step << 1) <= n) {
+    step <<= 1;
+  }
+  for (; step > 0; step >>= 1) {
+    if (pos + step <= n && tree_[pos + step] <= rest) {
+      pos += step;
+      rest -= tree_[pos];
+    }
+  }
+  pos = std::min(pos, n - 1);
+  *bound = bounds_[pos];
+  return Prefix(pos);
+}
+
+size_t ZSetsRankIndex::BucketOf(const Slice& score_key) const {
+  auto iter = std::upper_bound(bounds_.begin() + 1, bounds_.end(), score_key,
+                               [this](const Slice& key, const std::string& bound) {
+                                 return comparator_->Compare(key, bound) < 0;
+                               });
+  return std::distance(bounds_.begin(), iter) - 1;
+}
+
+int64_t ZSetsRankIndex::Prefix(size_t bucket) const {
+  int64_t sum = 0;
+  for (size_t i = bucket; i > 0; i -= i & (~i + 1)) {
+    sum += tree_[i];
+  }
+  return sum;
+}
+
+void ZSetsRankIndex::TreeAdd(size_t bucket, int64_t delta) {
+  for (size_t i = bucket + 1; i < tree_.size(); i += i & (~i + 1)) {
+    tree_[i] += delta;
+  }
+}
+
+void ZSetsRankIndex::Rebuild() {
+  tree_.assign(counts_.size() + 1, 0);
+  for (size_t i = 1; i < tree_.size(); ++i) {
+    tree_[i] += counts_[i - 1];
+    size_t parent = i + (i & (~i + 1));
+    if (parent < tree_.size()) {
+      tree_[parent] += tree_[i];
+    }
+  }
+}
+
+}  // namespace storage
@@ -0,0 +1,106 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef SRC_ZSETS_RANK_INDEX_H_
+#define SRC_ZSETS_RANK_INDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "rocksdb/comparator.h"
+#include "rocksdb/slice.h"
+
+#include "pstd/include/noncopyable.h"
+
+namespace storage {
+
+using Slice = rocksdb::Slice;
+
+/*
+ * In-memory order statistic index over the score keys of one zset version.
+ *
+ * The score keys are cut into buckets, each bucket is identified by the
+ * encoded score key it starts from (the first bucket starts from the
+ * beginning of the zset) and only keeps its member count. A fenwick tree
+ * over the bucket counts gives the rank of a bucket in O(log n), so a rank
+ * lookup is a binary search plus a scan of at most two buckets in
+ * kZsetsScoreCF instead of a scan from the beginning of the zset.
+ *
+ * Buckets are split by the caller when they grow over 2 * kBucketSize and
+ * dropped when they become empty. The index must be modified while holding
+ * mu exclusively, readers hold mu shared while they read rocksdb.
+ */
+class ZSetsRankIndex {
+ public:
+  static constexpr int64_t kBucketSize = 256;
+
+  ZSetsRankIndex(uint64_t version, const rocksdb::Comparator* comparator);
+
+  uint64_t Version() const { return version_; }
+  int64_t Count() const { return total_; }
+  size_t BucketNum() const { return bounds_.size(); }
+
+  // Only used while building, score keys must be appended in order
+  void Append(const Slice& score_key);
+  void FinishBuild();
+
+  // Return the bucket which needs to be split, or -1
+  int64_t Insert(const Slice& score_key);
+  // Return false if the index does not match the data anymore
+  bool Erase(const Slice& score_key);
+  int64_t BucketCount(size_t bucket) const { return counts_[bucket]; }
+  // Empty bound means the beginning of the zset
+  const std::string& BucketBound(size_t bucket) const { return bounds_[bucket]; }
+  // Starts a new bucket from split_key, which is the offset-th key of bucket
+  void Split(size_t bucket, int64_t offset, const Slice& split_key);
+
+  // Locate the bucket which may hold score_key, return the rank of its first key
+  int64_t Seek(const Slice& score_key, std::string* bound) const;
+  // Locate the bucket holding the rank-th key, return the rank of its first key
+  int64_t SeekRank(int64_t rank, std::string* bound) const;
+
+  std::shared_mutex mu;
+
+ private:
+  size_t BucketOf(const Slice& score_key) const;
+  int64_t Prefix(size_t bucket) const;
+  void TreeAdd(size_t bucket, int64_t delta);
+  void Rebuild();
+
+  uint64_t version_ = 0;
+  int64_t total_ = 0;
+  const rocksdb::Comparator* comparator_ = nullptr;
+  std::vector<std::string> bounds_;
+  std::vector<int64_t> counts_;
+  // fenwick tree over counts_, 1-based
+  std::vector<int64_t> tree_;
+};
+
+// Keeps the rank index of a key locked shared while a reader uses it
+class ScopeZSetsRankIndex : public pstd::noncopyable {
+ public:
+  explicit ScopeZSetsRankIndex(std::shared_ptr<ZSetsRankIndex> index) : index_(std::move(index)) {
+    if (index_) {
+      index_->mu.lock_shared();
+    }
+  }
+  ~ScopeZSetsRankIndex() {
+    if (index_) {
+      index_->mu.unlock_shared();
+    }
+  }
+
+  ZSetsRankIndex* get() const { return index_.get(); }
+  const std::shared_ptr<ZSetsRankIndex>& index() const { return index_; }
+
+ private:
+  std::shared_ptr<ZSetsRankIndex> index_;
+};
+
+}  // namespace storage
+#endif  // SRC_ZSETS_RANK_INDEX_H_
@@ -19,8 +19,8 @@ TEST(ZSetScoreKeyComparator, FindShortestSeparatorTest) {
   ZSetsScoreKeyComparatorImpl impl;
 
   // ***************** Group 1 Test *****************
-  ZSetsScoreKey zsets_score_key_start_1("Axlgrep", 1557212501, 3.1415, "abc");
-  ZSetsScoreKey zsets_score_key_limit_1("Axlgreq", 1557212501, 3.1415, "abc");
+  ZSetsScoreKey zsets_score_key_start_1("Axlgrep", 1557212501, 3.1415, "abc", 0);
+  ZSetsScoreKey zsets_score_key_limit_1("Axlgreq", 1557212501, 3.1415, "abc", 0);
   std::string start_1 = zsets_score_key_start_1.Encode().ToString();
   std::string limit_1 = zsets_score_key_limit_1.Encode().ToString();
   std::string change_start_1 = start_1;
@@ -33,8 +33,8 @@ TEST(ZSetScoreKeyComparator, FindShortestSeparatorTest) {
   ASSERT_TRUE(impl.Compare(change_start_1, limit_1) < 0);
 
   // ***************** Group 2 Test *****************
-  ZSetsScoreKey zsets_score_key_start_2("Axlgrep", 1557212501, 3.1314, "abc");
-  ZSetsScoreKey zsets_score_key_limit_2("Axlgrep", 1557212502, 3.1314, "abc");
+  ZSetsScoreKey zsets_score_key_start_2("Axlgrep", 1557212501, 3.1314, "abc", 0);
+  ZSetsScoreKey zsets_score_key_limit_2("Axlgrep", 1557212502, 3.1314, "abc", 0);
   std::string start_2 = zsets_score_key_start_2.Encode().ToString();
   std::string limit_2 = zsets_score_key_limit_2.Encode().ToString();
   std::string change_start_2 = start_2;
@@ -47,8 +47,8 @@ TEST(ZSetScoreKeyComparator, FindShortestSeparatorTest) {
   ASSERT_TRUE(impl.Compare(change_start_2, limit_2) < 0);
 
   // ***************** Group 3 Test *****************
-  ZSetsScoreKey zsets_score_key_start_3("Axlgrep", 1557212501, 3.1415, "abc");
-  ZSetsScoreKey zsets_score_key_limit_3("Axlgrep", 1557212501, 4.1415, "abc");
+  ZSetsScoreKey zsets_score_key_start_3("Axlgrep", 1557212501, 3.1415, "abc", 0);
+  ZSetsScoreKey zsets_score_key_limit_3("Axlgrep", 1557212501, 4.1415, "abc", 0);
   std::string start_3 = zsets_score_key_start_3.Encode().ToString();
   std::string limit_3 = zsets_score_key_limit_3.Encode().ToString();
   std::string change_start_3 = start_3;
@@ -61,8 +61,8 @@ TEST(ZSetScoreKeyComparator, FindShortestSeparatorTest) {
   ASSERT_TRUE(impl.Compare(change_start_3, limit_3) < 0);
 
   // ***************** Group 4 Test *****************
-  ZSetsScoreKey zsets_score_key_start_4("Axlgrep", 1557212501, 3.1415, "abc");
-  ZSetsScoreKey zsets_score_key_limit_4("Axlgrep", 1557212501, 5.1415, "abc");
+  ZSetsScoreKey zsets_score_key_start_4("Axlgrep", 1557212501, 3.1415, "abc", 0);
+  ZSetsScoreKey zsets_score_key_limit_4("Axlgrep", 1557212501, 5.1415, "abc", 0);
   std::string start_4 = zsets_score_key_start_4.Encode().ToString();
   std::string limit_4 = zsets_score_key_limit_4.Encode().ToString();
   std::string change_start_4 = start_4;
@@ -75,8 +75,8 @@ TEST(ZSetScoreKeyComparator, FindShortestSeparatorTest) {
   ASSERT_TRUE(impl.Compare(change_start_4, limit_4) < 0);
 
   // ***************** Group 5 Test *****************
-  ZSetsScoreKey zsets_score_key_start_5("Axlgrep", 1557212501, 3.1415, "abc");
-  ZSetsScoreKey zsets_score_key_limit_5("Axlgrep", 1557212501, 3.1415, "abd");
+  ZSetsScoreKey zsets_score_key_start_5("Axlgrep", 1557212501, 3.1415, "abc", 0);
+  ZSetsScoreKey zsets_score_key_limit_5("Axlgrep", 1557212501, 3.1415, "abd", 0);
   std::string start_5 = zsets_score_key_start_5.Encode().ToString();
   std::string limit_5 = zsets_score_key_limit_5.Encode().ToString();
   std::string change_start_5 = start_5;
@@ -89,8 +89,8 @@ TEST(ZSetScoreKeyComparator, FindShortestSeparatorTest) {
   ASSERT_TRUE(impl.Compare(change_start_5, limit_5) < 0);
 
   // ***************** Group 6 Test *****************
-  ZSetsScoreKey zsets_score_key_start_6("Axlgrep", 1557212501, 3.1415, "abccccccc");
-  ZSetsScoreKey zsets_score_key_limit_6("Axlgrep", 1557212501, 3.1415, "abd");
+  ZSetsScoreKey zsets_score_key_start_6("Axlgrep", 1557212501, 3.1415, "abccccccc", 0);
+  ZSetsScoreKey zsets_score_key_limit_6("Axlgrep", 1557212501, 3.1415, "abd", 0);
   std::string start_6 = zsets_score_key_start_6.Encode().ToString();
   std::string limit_6 = zsets_score_key_limit_6.Encode().ToString();
   std::string change_start_6 = start_6;
@@ -103,8 +103,8 @@ TEST(ZSetScoreKeyComparator, FindShortestSeparatorTest) {
   ASSERT_TRUE(impl.Compare(change_start_6, limit_6) < 0);
 
   // ***************** Group 7 Test *****************
-  ZSetsScoreKey zsets_score_key_start_7("Axlgrep", 1557212501, 3.1415, "abcccaccc");
-  ZSetsScoreKey zsets_score_key_limit_7("Axlgrep", 1557212501, 3.1415, "abccccccc");
+  ZSetsScoreKey zsets_score_key_start_7("Axlgrep", 1557212501, 3.1415, "abcccaccc", 0);
+  ZSetsScoreKey zsets_score_key_limit_7("Axlgrep", 1557212501, 3.1415, "abccccccc", 0);
   std::string start_7 = zsets_score_key_start_7.Encode().ToString();
   std::string limit_7 = zsets_score_key_limit_7.Encode().ToString();
   std::string change_start_7 = start_7;
@@ -117,8 +117,8 @@ TEST(ZSetScoreKeyComparator, FindShortestSeparatorTest) {
   ASSERT_TRUE(impl.Compare(change_start_7, limit_7) < 0);
 
   // ***************** Group 8 Test *****************
-  ZSetsScoreKey zsets_score_key_start_8("Axlgrep", 1557212501, 3.1415, "");
-  ZSetsScoreKey zsets_score_key_limit_8("Axlgrep", 1557212501, 3.1415, "abccccccc");
+  ZSetsScoreKey zsets_score_key_start_8("Axlgrep", 1557212501, 3.1415, "", 0);
+  ZSetsScoreKey zsets_score_key_limit_8("Axlgrep", 1557212501, 3.1415, "abccccccc", 0);
   std::string start_8 = zsets_score_key_start_8.Encode().ToString();
   std::string limit_8 = zsets_score_key_limit_8.Encode().ToString();
   std::string change_start_8 = start_8;
@@ -131,8 +131,8 @@ TEST(ZSetScoreKeyComparator, FindShortestSeparatorTest) {
   ASSERT_TRUE(impl.Compare(change_start_8, limit_8) < 0);
 
   // ***************** Group 9 Test *****************
-  ZSetsScoreKey zsets_score_key_start_9("Axlgrep", 1557212501, 3.1415, "aaaa");
-  ZSetsScoreKey zsets_score_key_limit_9("Axlgrep", 1557212501, 4.1415, "");
+  ZSetsScoreKey zsets_score_key_start_9("Axlgrep", 1557212501, 3.1415, "aaaa", 0);
+  ZSetsScoreKey zsets_score_key_limit_9("Axlgrep", 1557212501, 4.1415, "", 0);
   std::string start_9 = zsets_score_key_start_9.Encode().ToString();
   std::string limit_9 = zsets_score_key_limit_9.Encode().ToString();
   std::string change_start_9 = start_9;
@@ -145,8 +145,8 @@ TEST(ZSetScoreKeyComparator, FindShortestSeparatorTest) {
   ASSERT_TRUE(impl.Compare(change_start_9, limit_9) < 0);
 
   // ***************** Group 10 Test *****************
-  ZSetsScoreKey zsets_score_key_start_10("Axlgrep", 1557212502, 3.1415, "abc");
-  ZSetsScoreKey zsets_score_key_limit_10("Axlgrep", 1557212752, 3.1415, "abc");
+  ZSetsScoreKey zsets_score_key_start_10("Axlgrep", 1557212502, 3.1415, "abc", 0);
+  ZSetsScoreKey zsets_score_key_limit_10("Axlgrep", 1557212752, 3.1415, "abc", 0);
   std::string start_10 = zsets_score_key_start_10.Encode().ToString();
   std::string limit_10 = zsets_score_key_limit_10.Encode().ToString();
   ASSERT_TRUE(impl.Compare(start_10, limit_10) < 0);
@@ -7,6 +7,7 @@
 #include <iostream>
 #include <thread>
 
+#include "src/redis_hyperloglog.h"
 #include "storage/storage.h"
 #include "storage/util.h"
 
@@ -182,6 +183,93 @@ TEST_F(HyperLogLogTest, MultipleKeysTest) {
   ASSERT_LT(ratio_nums, static_cast<double>(result / 100) * 5);
 }
 
+TEST_F(HyperLogLogTest, SparseEncodingTest) {
+  // Small cardinalities stay in the sparse encoding
+  HyperLogLog log(Storage::kPrecision, "");
+  ASSERT_TRUE(log.IsSparse());
+  for (int32_t i = 0; i < 50; i++) {
+    std::string value = "FOO" + std::to_string(i);
+    log.Add(value.data(), value.size());
+  }
+  ASSERT_TRUE(log.IsSparse());
+  std::string encoded = log.Encode();
+  ASSERT_LT(encoded.size(), kHllSparseMaxBytes);
+  ASSERT_EQ(encoded.compare(0, 4, kHllMagic), 0);
+  ASSERT_EQ(static_cast<uint8_t>(encoded[4]), kHllSparse);
+  ASSERT_LT(abs(50 - static_cast<int32_t>(log.Estimate())), 3);
+
+  // Adding an existing element changes nothing
+  std::string value = "FOO0";
+  ASSERT_FALSE(log.Add(value.data(), value.size()));
+
+  // Decoding gives back the same registers
+  HyperLogLog decoded(Storage::kPrecision, encoded);
+  ASSERT_EQ(decoded.Encode(), encoded);
+  ASSERT_EQ(decoded.Estimate(), log.Estimate());
+}
+
+TEST_F(HyperLogLogTest, DenseEncodingTest) {
+  // Large cardinalities are promoted to the packed dense encoding
+  HyperLogLog log(Storage::kPrecision, "");
+  for (int32_t i = 0; i < 100000; i++) {
+    std::string value = "BAR" + std::to_string(i);
+    log.Add(value.data(), value.size());
+  }
+  ASSERT_FALSE(log.IsSparse());
+  std::string encoded = log.Encode();
+  ASSERT_EQ(encoded.size(), kHllHeaderSize + ((1 << Storage::kPrecision) * 6 + 7) / 8);
+  ASSERT_EQ(static_cast<uint8_t>(encoded[4]), kHllDense);
+  int32_t result = static_cast<int32_t>(log.Estimate());
+  ASSERT_LT(abs(100000 - result), 100000 / 100 * 2);
+
+  HyperLogLog decoded(Storage::kPrecision, encoded);
+  ASSERT_EQ(decoded.Encode(), encoded);
+  ASSERT_EQ(decoded.Estimate(), log.Estimate());
+}
+
+TEST_F(HyperLogLogTest, LegacyEncodingTest) {
+  // Values written with one byte per register are still readable
+  std::string legacy((1 << Storage::kPrecision), 0);
+  legacy[5] = 3;
+  legacy[100] = 1;
+  legacy[(1 << Storage::kPrecision) - 1] = 20;
+  HyperLogLog from_legacy(Storage::kPrecision, legacy);
+  ASSERT_TRUE(from_legacy.IsSparse());
+  ASSERT_EQ(from_legacy.CountZero(), (1 << Storage::kPrecision) - 3);
+  ASSERT_EQ(static_cast<int32_t>(from_legacy.Estimate()), 3);
+
+  // Re-encoding keeps the registers
+  HyperLogLog decoded(Storage::kPrecision, from_legacy.Encode());
+  ASSERT_EQ(decoded.Encode(), from_legacy.Encode());
+
+  // Merge takes the max of every register
+  HyperLogLog log(Storage::kPrecision, "");
+  for (int32_t i = 0; i < 1000; i++) {
+    std::string value = "ZAP" + std::to_string(i);
+    log.Add(value.data(), value.size());
+  }
+  HyperLogLog merged(Storage::kPrecision, log.Encode());
+  merged.Merge(from_legacy);
+  merged.Merge(from_legacy);
+  HyperLogLog merged_reverse(Storage::kPrecision, legacy);
+  merged_reverse.Merge(log);
+  ASSERT_EQ(merged.Encode(), merged_reverse.Encode());
+  ASSERT_GE(merged.Estimate(), log.Estimate());
+
+  // PFADD reports no update when no register changes
+  bool update;
+  std::vector<std::string> values{"A", "B", "C"};
+  s = db.PfAdd("HLL", values, &update);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(update);
+  s = db.PfAdd("HLL", values, &update);
+  ASSERT_TRUE(s.ok());
+  ASSERT_FALSE(update);
+  std::vector<std::string> keys{"HLL"};
+  int64_t nums = db.Del(keys);
+  ASSERT_EQ(nums, 1);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
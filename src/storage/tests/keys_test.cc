@@ -4,6 +4,7 @@
 //  of patent rights can be found in the PATENTS file in the same directory.
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <iostream>
 #include <thread>
 
@@ -5085,6 +5086,24 @@ TEST_F(KeysTest, DelTest) {
   // Strings
   s = db.Get("DEL_KEY", &value);
   ASSERT_TRUE(s.IsNotFound());
+
+  // Keys of every type spread over the db instances, a repeated key is counted once
+  uint64_t llen;
+  std::vector<std::string> multi_keys;
+  for (int i = 0; i < 20; i++) {
+    std::string index = std::to_string(i);
+    db.Set("DEL_MULTI_STRING_KEY" + index, "VALUE");
+    db.HSet("DEL_MULTI_HASH_KEY" + index, "FIELD", "VALUE", &ret);
+    db.RPush("DEL_MULTI_LIST_KEY" + index, {"NODE"}, &llen);
+    multi_keys.push_back("DEL_MULTI_STRING_KEY" + index);
+    multi_keys.push_back("DEL_MULTI_HASH_KEY" + index);
+    multi_keys.push_back("DEL_MULTI_LIST_KEY" + index);
+  }
+  multi_keys.push_back("DEL_MULTI_STRING_KEY0");
+  multi_keys.push_back("DEL_MULTI_NOT_EXIST_KEY");
+  ASSERT_EQ(db.Del(multi_keys), 60);
+  ASSERT_EQ(db.Exists(multi_keys), 0);
+  ASSERT_EQ(db.Del(multi_keys), 0);
 }
 
 // Exists
@@ -5099,6 +5118,25 @@ TEST_F(KeysTest, ExistsTest) {
   ASSERT_TRUE(s.ok());
   ret = db.Exists(keys);
   ASSERT_EQ(ret, 1);
+
+  // Keys of every type spread over the db instances, a repeated key is counted twice
+  std::vector<std::string> multi_keys;
+  for (int i = 0; i < 20; i++) {
+    std::string index = std::to_string(i);
+    db.Set("EXISTS_MULTI_STRING_KEY" + index, "VALUE");
+    db.HSet("EXISTS_MULTI_HASH_KEY" + index, "FIELD", "VALUE", &ret);
+    db.RPush("EXISTS_MULTI_LIST_KEY" + index, {"NODE"}, &llen);
+    multi_keys.push_back("EXISTS_MULTI_STRING_KEY" + index);
+    multi_keys.push_back("EXISTS_MULTI_HASH_KEY" + index);
+    multi_keys.push_back("EXISTS_MULTI_LIST_KEY" + index);
+  }
+  multi_keys.push_back("EXISTS_MULTI_STRING_KEY0");
+  multi_keys.push_back("EXISTS_MULTI_NOT_EXIST_KEY");
+  ASSERT_EQ(db.Exists(multi_keys), 61);
+
+  std::vector<std::string> del_keys{"EXISTS_MULTI_HASH_KEY3"};
+  ASSERT_EQ(db.Del(del_keys), 1);
+  ASSERT_EQ(db.Exists(multi_keys), 60);
 }
 
 // Expireat
@@ -5185,6 +5223,113 @@ TEST_F(KeysTest, TTLTest) {
 }
 
 
+// ScanKeys
+TEST_F(KeysTest, ScanKeysTest) {
+  std::vector<std::string> expect_keys;
+  for (int i = 0; i < 2000; i++) {
+    std::string key = "SCANKEYS_" + std::to_string(10000 + i);
+    db.Set(key, "VALUE");
+    expect_keys.push_back(key);
+  }
+  db.Set("SCANKEYS", "VALUE");
+  db.Set("SCANKEYT_KEY", "VALUE");
+  std::string zero_key("SCANKEYS_\0KEY", 13);
+  db.Set(zero_key, "VALUE");
+  expect_keys.insert(expect_keys.begin(), zero_key);
+
+  // The keys of all the instances come in order, the prefix bounds the scan
+  std::vector<std::string> keys;
+  s = db.ScanKeys(DataType::kStrings, "SCANKEYS_*", [&keys](const std::string& key) {
+    keys.push_back(key);
+    return true;
+  });
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(key_match(keys, expect_keys));
+
+  keys.clear();
+  s = db.ScanKeys(DataType::kAll, "SCANKEYS_1000*", [&keys](const std::string& key) {
+    keys.push_back(key);
+    return true;
+  });
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(key_match(keys, {"SCANKEYS_10000", "SCANKEYS_10001", "SCANKEYS_10002", "SCANKEYS_10003",
+                               "SCANKEYS_10004", "SCANKEYS_10005", "SCANKEYS_10006", "SCANKEYS_10007",
+                               "SCANKEYS_10008", "SCANKEYS_10009"}));
+
+  // Stops when the visitor does
+  keys.clear();
+  s = db.ScanKeys(DataType::kStrings, "*", [&keys](const std::string& key) {
+    keys.push_back(key);
+    return keys.size() < 1500;
+  });
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(keys.size(), 1500);
+  ASSERT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+
+  keys.clear();
+  s = db.Keys(DataType::kStrings, "SCANKEY?", &keys);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(key_match(keys, {"SCANKEYS"}));
+}
+
+// ReapExpiredKeys
+TEST_F(KeysTest, ReapExpiredKeysTest) {
+  int32_t ret;
+  s = db.Setex("REAP_STRING_KEY", "VALUE", 1);
+  ASSERT_TRUE(s.ok());
+  s = db.HSet("REAP_HASH_KEY", "FIELD", "VALUE", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(db.Expire("REAP_HASH_KEY", 1), 1);
+  // Persisted after it was indexed, the index entry is stale
+  s = db.SAdd("REAP_SET_KEY", {"MEMBER"}, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(db.Expire("REAP_SET_KEY", 1), 1);
+  ASSERT_EQ(db.Persist("REAP_SET_KEY"), 1);
+  // Its expire time moved on, only the later entry is left
+  s = db.Setex("REAP_LATER_KEY", "VALUE", 1);
+  ASSERT_TRUE(s.ok());
+  s = db.Setex("REAP_LATER_KEY", "VALUE", 100);
+  ASSERT_TRUE(s.ok());
+  // Small zsets are reaped row by row, large hashes with a range delete
+  s = db.ZAdd("REAP_ZSET_KEY", {{1, "MEMBER"}}, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(db.Expire("REAP_ZSET_KEY", 1), 1);
+  std::vector<storage::FieldValue> fvs;
+  for (int i = 0; i < 1000; i++) {
+    fvs.push_back({"FIELD_" + std::to_string(i), "VALUE"});
+  }
+  s = db.HMSet("REAP_BIG_HASH_KEY", fvs);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(db.Expire("REAP_BIG_HASH_KEY", 1), 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+  s = db.ReapExpiredKeys(100, true);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(db.GetReapedKeys(), 4);
+  ASSERT_GT(db.GetReclaimedBytes(), 0);
+  ASSERT_EQ(db.Exists({"REAP_SET_KEY", "REAP_LATER_KEY"}), 2);
+
+  // Nothing left to reap
+  s = db.ReapExpiredKeys(100, true);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(db.GetReapedKeys(), 4);
+
+  // Reaped keys can be written again
+  s = db.HSet("REAP_HASH_KEY", "FIELD", "NEW_VALUE", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1);
+  s = db.ZAdd("REAP_ZSET_KEY", {{2, "NEW_MEMBER"}}, &ret);
+  ASSERT_TRUE(s.ok());
+  std::vector<storage::ScoreMember> score_members;
+  s = db.ZRangebyscore("REAP_ZSET_KEY", -100, 100, true, true, &score_members);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(score_members.size(), 1);
+  ASSERT_EQ(score_members[0].member, "NEW_MEMBER");
+  int32_t len = 0;
+  s = db.HLen("REAP_BIG_HASH_KEY", &len);
+  ASSERT_EQ(len, 0);
+}
+
 int main(int argc, char** argv) {
   if (!pstd::FileExists("./log")) {
     pstd::CreatePath("./log");
@@ -14,6 +14,7 @@
 #include "src/base_key_format.h"
 #include "src/base_data_key_format.h"
 #include "src/zsets_data_key_format.h"
+#include "src/lists_chunks.h"
 #include "src/lists_data_key_format.h"
 #include "storage/storage_define.h"
 
@@ -21,7 +22,7 @@ using namespace storage;
 
 TEST(KVFormatTest, BaseKeyFormat) {
   rocksdb::Slice slice_key("\u0000\u0001abc\u0000", 6);
-  BaseKey bk(slice_key);
+  BaseKey bk(slice_key, 0);
 
   rocksdb::Slice slice_enc = bk.Encode();
   std::string expect_enc(8, '\0');
@@ -38,7 +39,7 @@ TEST(KVFormatTest, BaseDataKeyFormat) {
   rocksdb::Slice slice_data("\u0000\u0001data\u0000", 7);
   uint64_t version = 1701848429;
 
-  BaseDataKey bdk(slice_key, version, slice_data);
+  BaseDataKey bdk(slice_key, version, slice_data, 0);
   rocksdb::Slice seek_key_enc = bdk.EncodeSeekKey();
   std::string expect_enc(8, '\0');
   expect_enc.append("\u0000\u0001\u0001base_data_key\u0000\u0001\u0000\u0000", 20);
@@ -64,7 +65,7 @@ TEST(KVFormatTest, ZsetsScoreKeyFormat) {
   uint64_t version = 1701848429;
   double score = -3.5;
 
-  ZSetsScoreKey zsk(slice_key, version, score, slice_data);
+  ZSetsScoreKey zsk(slice_key, version, score, slice_data, 0);
   // reserve
   std::string expect_enc(8, '\0');
   // user_key
@@ -96,7 +97,7 @@ TEST(KVFormatTest, ListDataKeyFormat) {
   uint64_t version = 1701848429;
   uint64_t index = 10;
 
-  ListsDataKey ldk(slice_key, version, index);
+  ListsDataKey ldk(slice_key, version, index, 0);
   rocksdb::Slice key_enc = ldk.Encode();
   std::string expect_enc(8, '\0');
   expect_enc.append("\u0000\u0001\u0001list_data_key\u0000\u0001\u0000\u0000", 20);
@@ -114,6 +115,40 @@ TEST(KVFormatTest, ListDataKeyFormat) {
   ASSERT_EQ(pldk.Version(), version);
 }
 
+TEST(KVFormatTest, ListsChunkFormat) {
+  ListsChunkElements elements(5);
+  elements[0].element = "a";
+  elements[1].element = std::string("\u0000b\u0000", 3);
+  elements[3].element = std::string(300, 'c');
+  elements[4].spill = kListsSpillBase + 7;
+  elements[4].size = 1000;
+  std::string chunk;
+  EncodeListsChunk(elements, &chunk);
+  ASSERT_EQ(chunk.size(), 4 + 5 * 4 + 1 + 3 + 0 + 300 + 8);
+
+  ListsChunkElements decoded;
+  ASSERT_TRUE(DecodeListsChunk(chunk, &decoded));
+  ASSERT_EQ(decoded.size(), elements.size());
+  for (size_t idx = 0; idx < elements.size(); idx++) {
+    ASSERT_EQ(decoded[idx].element, elements[idx].element);
+    ASSERT_EQ(decoded[idx].spill, elements[idx].spill);
+    ASSERT_EQ(decoded[idx].size, elements[idx].size);
+  }
+
+  ASSERT_FALSE(DecodeListsChunk(Slice(chunk.data(), chunk.size() - 1), &decoded));
+  ASSERT_FALSE(DecodeListsChunk(chunk + "x", &decoded));
+
+  EncodeListsChunk({}, &chunk);
+  ASSERT_TRUE(DecodeListsChunk(chunk, &decoded));
+  ASSERT_TRUE(decoded.empty());
+
+  ASSERT_EQ(ListsChunks::ChunkOf(ListsChunks::ChunkStart(5) + kListsChunkSize - 1), 5);
+  ASSERT_EQ(ListsChunks::ChunkOf(ListsChunks::ChunkStart(5) + kListsChunkSize), 6);
+  ASSERT_GT(kListsSpillBase, ListsChunks::ChunkOf(UINT64_MAX));
+  ASSERT_LE(sizeof(uint32_t) + kListsChunkSize * (sizeof(uint32_t) + kListsChunkInlineSize),
+            sizeof(uint32_t) + kListsChunkMaxBytes);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
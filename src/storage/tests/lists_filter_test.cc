@@ -84,11 +84,11 @@ TEST_F(ListsFilterTest, DataFilterTest) {
   version = lists_meta_value1.UpdateVersion();
 
   std::string user_key = "FILTER_TEST_KEY";
-  BaseMetaKey bmk(user_key);
+  BaseMetaKey bmk(user_key, 0);
   s = meta_db->Put(rocksdb::WriteOptions(), handles[0], bmk.Encode(), lists_meta_value1.Encode());
   ASSERT_TRUE(s.ok());
 
-  ListsDataKey lists_data_key1(user_key, version, 1);
+  ListsDataKey lists_data_key1(user_key, version, 1, 0);
   filter_result =
       lists_data_filter1->Filter(0, lists_data_key1.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
   ASSERT_EQ(filter_result, false);
@@ -105,7 +105,7 @@ TEST_F(ListsFilterTest, DataFilterTest) {
   lists_meta_value2.SetRelativeTimestamp(1);
   s = meta_db->Put(rocksdb::WriteOptions(), handles[0], bmk.Encode(), lists_meta_value2.Encode());
   ASSERT_TRUE(s.ok());
-  ListsDataKey lists_data_key2("FILTER_TEST_KEY", version, 1);
+  ListsDataKey lists_data_key2("FILTER_TEST_KEY", version, 1, 0);
   filter_result =
       lists_data_filter2->Filter(0, lists_data_key2.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
   ASSERT_EQ(filter_result, false);
@@ -123,7 +123,7 @@ TEST_F(ListsFilterTest, DataFilterTest) {
   s = meta_db->Put(rocksdb::WriteOptions(), handles[0], bmk.Encode(), lists_meta_value3.Encode());
   ASSERT_TRUE(s.ok());
   std::this_thread::sleep_for(std::chrono::milliseconds(2000));
-  ListsDataKey lists_data_key3("FILTER_TEST_KEY", version, 1);
+  ListsDataKey lists_data_key3("FILTER_TEST_KEY", version, 1, 0);
   filter_result =
       lists_data_filter3->Filter(0, lists_data_key3.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
   ASSERT_EQ(filter_result, true);
@@ -139,7 +139,7 @@ TEST_F(ListsFilterTest, DataFilterTest) {
   version = lists_meta_value4.UpdateVersion();
   s = meta_db->Put(rocksdb::WriteOptions(), handles[0], bmk.Encode(), lists_meta_value4.Encode());
   ASSERT_TRUE(s.ok());
-  ListsDataKey lists_data_key4("FILTER_TEST_KEY", version, 1);
+  ListsDataKey lists_data_key4("FILTER_TEST_KEY", version, 1, 0);
   version = lists_meta_value4.UpdateVersion();
   s = meta_db->Put(rocksdb::WriteOptions(), handles[0], bmk.Encode(), lists_meta_value4.Encode());
   ASSERT_TRUE(s.ok());
@@ -158,7 +158,7 @@ TEST_F(ListsFilterTest, DataFilterTest) {
   version = lists_meta_value5.UpdateVersion();
   s = meta_db->Put(rocksdb::WriteOptions(), handles[0], bmk.Encode(), lists_meta_value5.Encode());
   ASSERT_TRUE(s.ok());
-  ListsDataKey lists_data_value5("FILTER_TEST_KEY", version, 1);
+  ListsDataKey lists_data_value5("FILTER_TEST_KEY", version, 1, 0);
   s = meta_db->Delete(rocksdb::WriteOptions(), handles[0], bmk.Encode());
   ASSERT_TRUE(s.ok());
   filter_result =
@@ -168,7 +168,7 @@ TEST_F(ListsFilterTest, DataFilterTest) {
   /*
    * The types of keys conflict with each other and trigger compaction, zset filter
    */
-  BaseMetaKey meta_key(user_key);
+  BaseMetaKey meta_key(user_key, 0);
   auto zset_filter = std::make_unique<ZSetsScoreFilter>(meta_db, &handles, DataType::kZSets);
   ASSERT_TRUE(zset_filter != nullptr);
 
@@ -184,7 +184,7 @@ TEST_F(ListsFilterTest, DataFilterTest) {
   s = meta_db->Put(rocksdb::WriteOptions(), meta_key.Encode(), strings_value.Encode());
 
   // zset-filter was used for elimination detection
-  ZSetsScoreKey base_key(user_key, version, 1, "FILTER_TEST_KEY");
+  ZSetsScoreKey base_key(user_key, version, 1, "FILTER_TEST_KEY", 0);
   filter_result = zset_filter->Filter(0, base_key.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
   ASSERT_EQ(filter_result, true);
   s = meta_db->Delete(rocksdb::WriteOptions(), handles[0], "FILTER_TEST_KEY");
@@ -211,7 +211,7 @@ TEST_F(ListsFilterTest, DataFilterTest) {
   ASSERT_TRUE(s.ok());
 
   // list-filter was used for elimination detection
-  ListsDataKey lists_data_key(user_key, version, 1);
+  ListsDataKey lists_data_key(user_key, version, 1, 0);
   filter_result = lists_data_filter->Filter(0, lists_data_key.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
   ASSERT_EQ(filter_result, true);
   s = meta_db->Delete(rocksdb::WriteOptions(), handles[0], "FILTER_TEST_KEY");
@@ -238,7 +238,7 @@ TEST_F(ListsFilterTest, DataFilterTest) {
   ASSERT_TRUE(s.ok());
 
   // base-filter was used for elimination detection
-  ListsDataKey lists_data_key6(user_key, version, 1);
+  ListsDataKey lists_data_key6(user_key, version, 1, 0);
   filter_result = base_filter->Filter(0, lists_data_key6.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
   ASSERT_EQ(filter_result, true);
   s = meta_db->Delete(rocksdb::WriteOptions(), handles[0], "FILTER_TEST_KEY");
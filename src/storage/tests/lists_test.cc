@@ -11,6 +11,12 @@
 
 #include "pstd/include/pika_codis_slot.h"
 #include "pstd/include/env.h"
+#include "src/base_data_value_format.h"
+#include "src/base_key_format.h"
+#include "src/lists_chunks.h"
+#include "src/lists_data_key_format.h"
+#include "src/lists_meta_value_format.h"
+#include "src/redis.h"
 #include "storage/storage.h"
 #include "storage/util.h"
 
@@ -64,6 +70,71 @@ static bool len_match(storage::Storage* const db, const Slice& key, uint64_t exp
   return len == expect_len;
 }
 
+// Writes nodes the way lists were kept before chunks, one row per element
+static uint64_t put_element_encoded_list(storage::Storage* const db, const std::string& key,
+                                         const std::vector<std::string>& nodes) {
+  auto& inst = db->GetDBInstance(key);
+  std::vector<rocksdb::ColumnFamilyHandle*> handles = inst->GetListCFHandles();
+  char str[8];
+  EncodeFixed64(str, nodes.size());
+  ListsMetaValue lists_meta_value(Slice(str, sizeof(uint64_t)));
+  uint64_t version = lists_meta_value.UpdateVersion();
+  lists_meta_value.ModifyRightIndex(nodes.size());
+  std::string meta_value = lists_meta_value.Encode().ToString();
+  ParsedListsMetaValue(&meta_value).SetEncoding(kListsEncodingElement);
+
+  rocksdb::WriteBatch batch;
+  for (uint64_t idx = 0; idx < nodes.size(); idx++) {
+    ListsDataKey lists_data_key(key, version, InitalRightIndex + idx, 0);
+    BaseDataValue i_val(nodes[idx]);
+    batch.Put(handles.back(), lists_data_key.Encode(), i_val.Encode());
+  }
+  BaseMetaKey base_meta_key(key, 0);
+  batch.Put(handles.front(), base_meta_key.Encode(), meta_value);
+  Status s = inst->GetDB()->Write(rocksdb::WriteOptions(), &batch);
+  return s.ok() ? version : 0;
+}
+
+static bool is_chunked(storage::Storage* const db, const std::string& key, uint64_t* version) {
+  auto& inst = db->GetDBInstance(key);
+  std::string meta_value;
+  BaseMetaKey base_meta_key(key, 0);
+  Status s = inst->GetDB()->Get(rocksdb::ReadOptions(), inst->GetListCFHandles().front(), base_meta_key.Encode(),
+                                &meta_value);
+  if (!s.ok()) {
+    return false;
+  }
+  ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
+  *version = parsed_lists_meta_value.Version();
+  return parsed_lists_meta_value.IsChunked();
+}
+
+// The rows of the current version of key, chunks and spilled elements apart
+static void count_list_rows(storage::Storage* const db, const std::string& key, uint64_t* chunks,
+                            uint64_t* spilled) {
+  *chunks = 0;
+  *spilled = 0;
+  uint64_t version;
+  if (!is_chunked(db, key, &version)) {
+    return;
+  }
+  auto& inst = db->GetDBInstance(key);
+  std::unique_ptr<rocksdb::Iterator> iter(
+      inst->GetDB()->NewIterator(rocksdb::ReadOptions(), inst->GetListCFHandles().back()));
+  ListsDataKey start_data_key(key, version, 0, 0);
+  for (iter->Seek(start_data_key.Encode()); iter->Valid(); iter->Next()) {
+    ParsedListsDataKey parsed_lists_data_key(iter->key());
+    if (parsed_lists_data_key.key() != key || parsed_lists_data_key.Version() != version) {
+      break;
+    }
+    if (parsed_lists_data_key.index() >= kListsSpillBase) {
+      (*spilled)++;
+    } else {
+      (*chunks)++;
+    }
+  }
+}
+
 static bool make_expired(storage::Storage* const db, const Slice& key) {
   std::map<storage::DataType, rocksdb::Status> type_status;
   int ret = db->Expire(key, 1);
@@ -2705,6 +2776,232 @@ TEST_F(ListsTest, RPushxTest) {  // NOLINT
   ASSERT_TRUE(s.ok());
 }
 
+// Lists spanning several chunks
+TEST_F(ListsTest, ChunkedListTest) {  // NOLINT
+  int64_t ret;
+  uint64_t num;
+  std::string element;
+  std::vector<std::string> elements;
+  std::vector<std::string> nodes;
+  for (int idx = 0; idx < 300; idx++) {
+    nodes.push_back("node_" + std::to_string(idx));
+  }
+
+  std::vector<std::string> back_nodes(nodes.begin() + 150, nodes.end());
+  s = db.RPush("CHUNKED_LIST_KEY", back_nodes, &num);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(num, 150);
+  std::vector<std::string> front_nodes(nodes.rend() - 150, nodes.rend());
+  s = db.LPush("CHUNKED_LIST_KEY", front_nodes, &num);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(num, 300);
+  ASSERT_TRUE(len_match(&db, "CHUNKED_LIST_KEY", nodes.size()));
+  ASSERT_TRUE(elements_match(&db, "CHUNKED_LIST_KEY", nodes));
+
+  for (int idx : {0, 127, 128, 149, 150, 151, 255, 256, 299}) {
+    s = db.LIndex("CHUNKED_LIST_KEY", idx, &element);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(element, nodes[idx]);
+    s = db.LIndex("CHUNKED_LIST_KEY", idx - 300, &element);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(element, nodes[idx]);
+  }
+
+  elements.clear();
+  s = db.LRange("CHUNKED_LIST_KEY", 100, 200, &elements);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(elements_match(elements, std::vector<std::string>(nodes.begin() + 100, nodes.begin() + 201)));
+
+  s = db.LSet("CHUNKED_LIST_KEY", 200, "set");
+  ASSERT_TRUE(s.ok());
+  nodes[200] = "set";
+
+  s = db.LInsert("CHUNKED_LIST_KEY", storage::Before, "node_20", "front", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 301);
+  nodes.insert(nodes.begin() + 20, "front");
+  s = db.LInsert("CHUNKED_LIST_KEY", storage::After, "node_280", "back", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 302);
+  nodes.insert(nodes.begin() + 282, "back");
+  ASSERT_TRUE(elements_match(&db, "CHUNKED_LIST_KEY", nodes));
+
+  s = db.LRem("CHUNKED_LIST_KEY", 0, "front", &num);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(num, 1);
+  nodes.erase(nodes.begin() + 20);
+  ASSERT_TRUE(elements_match(&db, "CHUNKED_LIST_KEY", nodes));
+
+  elements.clear();
+  s = db.LPop("CHUNKED_LIST_KEY", 130, &elements);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(elements_match(elements, std::vector<std::string>(nodes.begin(), nodes.begin() + 130)));
+  nodes.erase(nodes.begin(), nodes.begin() + 130);
+  elements.clear();
+  s = db.RPop("CHUNKED_LIST_KEY", 2, &elements);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(elements_match(elements, {nodes[nodes.size() - 1], nodes[nodes.size() - 2]}));
+  nodes.resize(nodes.size() - 2);
+  ASSERT_TRUE(elements_match(&db, "CHUNKED_LIST_KEY", nodes));
+
+  s = db.LTrim("CHUNKED_LIST_KEY", 5, -6);
+  ASSERT_TRUE(s.ok());
+  nodes = std::vector<std::string>(nodes.begin() + 5, nodes.end() - 5);
+  ASSERT_TRUE(len_match(&db, "CHUNKED_LIST_KEY", nodes.size()));
+  ASSERT_TRUE(elements_match(&db, "CHUNKED_LIST_KEY", nodes));
+
+  s = db.RPoplpush("CHUNKED_LIST_KEY", "CHUNKED_LIST_KEY", &element);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(element, nodes.back());
+  nodes.insert(nodes.begin(), nodes.back());
+  nodes.pop_back();
+  ASSERT_TRUE(elements_match(&db, "CHUNKED_LIST_KEY", nodes));
+}
+
+// Lists written one row per element are read as they are and rewritten
+// into chunks by the first write
+TEST_F(ListsTest, ChunkedListUpgradeTest) {  // NOLINT
+  uint64_t num;
+  uint64_t version;
+  std::string element;
+  std::vector<std::string> elements;
+  std::vector<std::string> nodes;
+  for (int idx = 0; idx < 300; idx++) {
+    nodes.push_back("node_" + std::to_string(idx));
+  }
+
+  uint64_t old_version = put_element_encoded_list(&db, "UPGRADE_LIST_KEY", nodes);
+  ASSERT_NE(old_version, 0);
+  ASSERT_FALSE(is_chunked(&db, "UPGRADE_LIST_KEY", &version));
+  ASSERT_EQ(version, old_version);
+
+  ASSERT_TRUE(len_match(&db, "UPGRADE_LIST_KEY", nodes.size()));
+  ASSERT_TRUE(elements_match(&db, "UPGRADE_LIST_KEY", nodes));
+  elements.clear();
+  s = db.LRange("UPGRADE_LIST_KEY", 120, 140, &elements);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(elements_match(elements, std::vector<std::string>(nodes.begin() + 120, nodes.begin() + 141)));
+  for (int idx : {0, 127, 128, 299}) {
+    s = db.LIndex("UPGRADE_LIST_KEY", idx, &element);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(element, nodes[idx]);
+  }
+  // Reads leave the rows as they are
+  ASSERT_FALSE(is_chunked(&db, "UPGRADE_LIST_KEY", &version));
+
+  s = db.RPush("UPGRADE_LIST_KEY", {"tail"}, &num);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(num, 301);
+  nodes.emplace_back("tail");
+  s = db.LPush("UPGRADE_LIST_KEY", {"head"}, &num);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(num, 302);
+  nodes.insert(nodes.begin(), "head");
+
+  ASSERT_TRUE(is_chunked(&db, "UPGRADE_LIST_KEY", &version));
+  ASSERT_GT(version, old_version);
+  auto& inst = db.GetDBInstance(std::string("UPGRADE_LIST_KEY"));
+  std::string chunk_value;
+  ListsDataKey first_chunk_key("UPGRADE_LIST_KEY", version, ListsChunks::ChunkOf(InitalLeftIndex), 0);
+  s = inst->GetDB()->Get(rocksdb::ReadOptions(), inst->GetListCFHandles().back(), first_chunk_key.Encode(),
+                         &chunk_value);
+  ASSERT_TRUE(s.ok());
+  ListsChunkElements chunk_elements;
+  ASSERT_TRUE(DecodeListsChunk(ParsedBaseDataValue(&chunk_value).UserValue(), &chunk_elements));
+  ASSERT_EQ(chunk_elements.size(), 1);
+
+  ASSERT_TRUE(len_match(&db, "UPGRADE_LIST_KEY", nodes.size()));
+  ASSERT_TRUE(elements_match(&db, "UPGRADE_LIST_KEY", nodes));
+  for (int idx : {0, 1, 128, 129, 300, 301}) {
+    s = db.LIndex("UPGRADE_LIST_KEY", idx, &element);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(element, nodes[idx]);
+  }
+}
+
+// Elements too long to stay in a chunk are kept in rows of their own
+TEST_F(ListsTest, ChunkedListSpillTest) {  // NOLINT
+  int64_t ret;
+  uint64_t num;
+  uint64_t chunks;
+  uint64_t spilled;
+  std::string element;
+  std::vector<std::string> elements;
+  std::vector<std::string> nodes;
+  for (int idx = 0; idx < 300; idx++) {
+    std::string node = "node_" + std::to_string(idx);
+    if (idx % 3 == 0) {
+      node.append(kListsChunkInlineSize, static_cast<char>('a' + idx % 26));
+    }
+    nodes.push_back(node);
+  }
+
+  s = db.RPush("SPILL_LIST_KEY", nodes, &num);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(num, 300);
+  ASSERT_TRUE(elements_match(&db, "SPILL_LIST_KEY", nodes));
+  count_list_rows(&db, "SPILL_LIST_KEY", &chunks, &spilled);
+  ASSERT_EQ(chunks, 3);
+  ASSERT_EQ(spilled, 100);
+
+  for (int idx : {0, 1, 3, 129, 299}) {
+    s = db.LIndex("SPILL_LIST_KEY", idx, &element);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(element, nodes[idx]);
+  }
+
+  // A spilled element set to a short one, and a short one to a long one
+  s = db.LSet("SPILL_LIST_KEY", 3, "short");
+  ASSERT_TRUE(s.ok());
+  nodes[3] = "short";
+  std::string long_node(kListsChunkInlineSize + 1, 'z');
+  s = db.LSet("SPILL_LIST_KEY", 4, long_node);
+  ASSERT_TRUE(s.ok());
+  nodes[4] = long_node;
+  count_list_rows(&db, "SPILL_LIST_KEY", &chunks, &spilled);
+  ASSERT_EQ(spilled, 100);
+
+  s = db.LInsert("SPILL_LIST_KEY", storage::Before, nodes[6], "front", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 301);
+  nodes.insert(nodes.begin() + 6, "front");
+  ASSERT_TRUE(elements_match(&db, "SPILL_LIST_KEY", nodes));
+
+  s = db.LRem("SPILL_LIST_KEY", 0, long_node, &num);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(num, 1);
+  nodes.erase(nodes.begin() + 4);
+  ASSERT_TRUE(elements_match(&db, "SPILL_LIST_KEY", nodes));
+  count_list_rows(&db, "SPILL_LIST_KEY", &chunks, &spilled);
+  ASSERT_EQ(spilled, 99);
+
+  elements.clear();
+  s = db.LPop("SPILL_LIST_KEY", 2, &elements);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(elements_match(elements, {nodes[0], nodes[1]}));
+  nodes.erase(nodes.begin(), nodes.begin() + 2);
+  elements.clear();
+  s = db.RPop("SPILL_LIST_KEY", 1, &elements);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(elements_match(elements, {nodes.back()}));
+  nodes.pop_back();
+  ASSERT_TRUE(elements_match(&db, "SPILL_LIST_KEY", nodes));
+  count_list_rows(&db, "SPILL_LIST_KEY", &chunks, &spilled);
+  ASSERT_EQ(spilled, 98);
+
+  // Trimming deletes the spilled elements of the chunks it drops
+  s = db.LTrim("SPILL_LIST_KEY", 140, 150);
+  ASSERT_TRUE(s.ok());
+  nodes = std::vector<std::string>(nodes.begin() + 140, nodes.begin() + 151);
+  ASSERT_TRUE(elements_match(&db, "SPILL_LIST_KEY", nodes));
+  uint64_t expect_spilled = 0;
+  for (const auto& node : nodes) {
+    expect_spilled += node.size() > kListsChunkInlineSize ? 1 : 0;
+  }
+  count_list_rows(&db, "SPILL_LIST_KEY", &chunks, &spilled);
+  ASSERT_EQ(spilled, expect_spilled);
+}
+
 int main(int argc, char** argv) {
   if (!pstd::FileExists("./log")) {
     pstd::CreatePath("./log");
@@ -3,12 +3,88 @@
 //  LICENSE file in the root directory of this source tree. An additional grant
 //  of patent rights can be found in the PATENTS file in the same directory.
 
+#include <sys/time.h>
+#include <cstdlib>
+#include <random>
 #include <thread>
+#include <vector>
 
+#include "pstd/include/record_lock_mgr.h"
+#include "pstd/include/scope_record_lock.h"
 #include "src/lock_mgr.h"
 #include "src/mutex_impl.h"
 
 using namespace storage;
+using pstd::lock::LockMode;
+using pstd::lock::MultiRecordLock;
+using pstd::lock::RecordLockGuard;
+using pstd::lock::RecordLockMgr;
+
+static uint64_t NowMicros() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+// Every operation locks keys_per_op random keys out of key_space
+static std::vector<std::vector<std::string>> GenKeySets(int ops, int keys_per_op, int key_space, int seed) {
+  std::mt19937 rand(seed);
+  std::vector<std::vector<std::string>> key_sets(ops);
+  for (auto& keys : key_sets) {
+    for (int i = 0; i < keys_per_op; i++) {
+      keys.push_back("key_" + std::to_string(rand() % key_space));
+    }
+  }
+  return key_sets;
+}
+
+template <typename LockFunc>
+static void RunBench(const char* name, int threads, int keys_per_op, int key_space, LockFunc lock_func) {
+  constexpr int kOpsPerThread = 50000;
+  std::vector<std::vector<std::vector<std::string>>> key_sets;
+  for (int t = 0; t < threads; t++) {
+    key_sets.push_back(GenKeySets(kOpsPerThread, keys_per_op, key_space, t));
+  }
+  std::vector<std::thread> workers;
+  uint64_t start = NowMicros();
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      for (const auto& keys : key_sets[t]) {
+        lock_func(keys);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  uint64_t cost = NowMicros() - start;
+  printf("%-22s threads %2d keys/op %2d key_space %6d: %10.0f ops/s\n", name, threads, keys_per_op, key_space,
+         static_cast<double>(threads) * kOpsPerThread * 1000000 / (cost ? cost : 1));
+}
+
+// Lock throughput of the striped LockMgr against the RecordLockMgr under contention
+static void Bench() {
+  auto lock_mgr = std::make_shared<LockMgr>(1000, 0, std::make_shared<MutexFactoryImpl>());
+  auto record_lock_mgr = std::make_shared<RecordLockMgr>();
+  const std::vector<std::vector<int>> cases = {{1, 1, 1},    {8, 1, 1},   {8, 1, 1000},
+                                               {8, 1, 100000}, {8, 10, 1000}, {32, 3, 1000}};
+  for (const auto& c : cases) {
+    int threads = c[0];
+    int keys_per_op = c[1];
+    int key_space = c[2];
+    RunBench("LockMgr", threads, keys_per_op, key_space, [&](const std::vector<std::string>& keys) {
+      MultiRecordLock record_lock(lock_mgr);
+      record_lock.Lock(keys);
+      record_lock.Unlock(keys);
+    });
+    RunBench("RecordLockMgr", threads, keys_per_op, key_space, [&](const std::vector<std::string>& keys) {
+      RecordLockGuard record_lock(record_lock_mgr, keys, LockMode::kExclusive);
+    });
+    RunBench("RecordLockMgr(shared)", threads, keys_per_op, key_space, [&](const std::vector<std::string>& keys) {
+      RecordLockGuard record_lock(record_lock_mgr, keys, LockMode::kShared);
+    });
+  }
+}
 
 void Func(LockMgr* mgr, int id, const std::string& key) {
   mgr->TryLock(key);
@@ -40,5 +116,10 @@ int main() {
   t2.join();
   t3.join();
   t4.join();
+
+  // The benchmark takes a while, run it only when asked to
+  if (getenv("LOCK_MGR_BENCH") != nullptr) {
+    Bench();
+  }
   return 0;
 }
@@ -0,0 +1,313 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <set>
+
+#include "glog/logging.h"
+
+#include "pstd/include/env.h"
+#include "pstd/include/pika_codis_slot.h"
+#include "storage/storage.h"
+#include "storage/util.h"
+
+using storage::DataType;
+using storage::Slice;
+using storage::Status;
+
+const int kSlotNum = 1024;
+
+class SlotKeyPrefixTest : public ::testing::Test {
+ public:
+  SlotKeyPrefixTest() = default;
+  ~SlotKeyPrefixTest() override = default;
+
+  void SetUp() override {
+    std::string path = "./db/slot_key_prefix";
+    pstd::DeleteDirIfExist(path);
+    mkdir(path.c_str(), 0755);
+    storage_options.options.create_if_missing = true;
+    storage_options.slot_key_prefix = true;
+    s = db.Open(storage_options, path);
+  }
+
+  void TearDown() override {
+    std::string path = "./db/slot_key_prefix";
+    storage::DeleteFiles(path.c_str());
+  }
+
+  static void SetUpTestSuite() {}
+  static void TearDownTestSuite() {}
+
+  storage::StorageOptions storage_options;
+  storage::Storage db;
+  storage::Status s;
+};
+
+// Writes one key of every type for each index, returns type tag + key by slot
+static std::map<uint32_t, std::set<std::string>> WriteKeys(storage::Storage* db, int num) {
+  std::map<uint32_t, std::set<std::string>> slot_keys;
+  int32_t ret = 0;
+  uint64_t len = 0;
+  for (int i = 0; i < num; i++) {
+    std::string index = std::to_string(i);
+    db->Set("STRING_KEY_" + index, "value");
+    db->HSet("HASH_KEY_" + index, "field", "value", &ret);
+    db->SAdd("SET_KEY_" + index, {"member"}, &ret);
+    db->RPush("LIST_KEY_" + index, {"a", "b"}, &len);
+    db->ZAdd("ZSET_KEY_" + index, {{1, "a"}, {2, "b"}}, &ret);
+    slot_keys[GetSlotID(kSlotNum, "STRING_KEY_" + index)].insert("kSTRING_KEY_" + index);
+    slot_keys[GetSlotID(kSlotNum, "HASH_KEY_" + index)].insert("hHASH_KEY_" + index);
+    slot_keys[GetSlotID(kSlotNum, "SET_KEY_" + index)].insert("sSET_KEY_" + index);
+    slot_keys[GetSlotID(kSlotNum, "LIST_KEY_" + index)].insert("lLIST_KEY_" + index);
+    slot_keys[GetSlotID(kSlotNum, "ZSET_KEY_" + index)].insert("zZSET_KEY_" + index);
+  }
+  return slot_keys;
+}
+
+static std::set<std::string> ScanWholeSlot(storage::Storage* db, uint32_t slot, int64_t count) {
+  std::set<std::string> keys;
+  std::vector<std::string> batch;
+  int64_t cursor = 0;
+  do {
+    batch.clear();
+    Status s = db->ScanSlot(slot, cursor, "*", count, &batch, &cursor);
+    EXPECT_TRUE(s.ok());
+    keys.insert(batch.begin(), batch.end());
+  } while (cursor != 0);
+  return keys;
+}
+
+// ScanSlot & SlotKeyNum
+TEST_F(SlotKeyPrefixTest, ScanSlotTest) {
+  ASSERT_TRUE(s.ok());
+  auto slot_keys = WriteKeys(&db, 200);
+
+  for (const auto& [slot, keys] : slot_keys) {
+    int64_t num = 0;
+    ASSERT_TRUE(db.SlotKeyNum(slot, &num).ok());
+    ASSERT_EQ(num, static_cast<int64_t>(keys.size()));
+    ASSERT_EQ(ScanWholeSlot(&db, slot, 1), keys);
+    ASSERT_EQ(ScanWholeSlot(&db, slot, 100), keys);
+  }
+
+  // Pattern is matched against type tag + key
+  uint32_t slot = GetSlotID(kSlotNum, "ZSET_KEY_0");
+  std::vector<std::string> keys;
+  int64_t next_cursor = 0;
+  ASSERT_TRUE(db.ScanSlot(slot, 0, "z*", 100, &keys, &next_cursor).ok());
+  ASSERT_EQ(next_cursor, 0);
+  for (const auto& key : keys) {
+    ASSERT_EQ(key[0], 'z');
+  }
+  ASSERT_NE(std::find(keys.begin(), keys.end(), "zZSET_KEY_0"), keys.end());
+
+  // Deleted keys are not counted
+  std::vector<std::string> del_keys{"ZSET_KEY_0"};
+  ASSERT_EQ(db.Del(del_keys), 1);
+  int64_t num = 0;
+  ASSERT_TRUE(db.SlotKeyNum(slot, &num).ok());
+  ASSERT_EQ(num, static_cast<int64_t>(slot_keys[slot].size()) - 1);
+
+  ASSERT_TRUE(db.SlotKeyNum(kSlotNum, &num).IsInvalidArgument());
+}
+
+// The cursor resumes after the last returned key, deleting keys already
+// returned does not make the next page skip any
+TEST_F(SlotKeyPrefixTest, ScanSlotCursorTest) {
+  ASSERT_TRUE(s.ok());
+  auto slot_keys = WriteKeys(&db, 200);
+  auto largest = std::max_element(slot_keys.begin(), slot_keys.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.second.size() < rhs.second.size();
+  });
+  uint32_t slot = largest->first;
+  ASSERT_GT(largest->second.size(), 2);
+
+  std::set<std::string> keys;
+  std::vector<std::string> batch;
+  int64_t cursor = 0;
+  do {
+    batch.clear();
+    ASSERT_TRUE(db.ScanSlot(slot, cursor, "*", 1, &batch, &cursor).ok());
+    for (const auto& key : batch) {
+      keys.insert(key);
+      std::vector<std::string> del_keys{key.substr(1)};
+      ASSERT_EQ(db.Del(del_keys), 1);
+    }
+  } while (cursor != 0);
+  ASSERT_EQ(keys, largest->second);
+
+  // An unknown cursor starts over from the beginning of the slot
+  ASSERT_TRUE(db.Set("STRING_KEY_0", "value").ok());
+  slot = GetSlotID(kSlotNum, "STRING_KEY_0");
+  batch.clear();
+  ASSERT_TRUE(db.ScanSlot(slot, 12345, "k*", 100, &batch, &cursor).ok());
+  ASSERT_NE(std::find(batch.begin(), batch.end(), "kSTRING_KEY_0"), batch.end());
+}
+
+// Data of every type is readable, and Scan still returns every key
+TEST_F(SlotKeyPrefixTest, ReadWriteTest) {
+  ASSERT_TRUE(s.ok());
+  WriteKeys(&db, 100);
+
+  std::string value;
+  ASSERT_TRUE(db.Get("STRING_KEY_7", &value).ok());
+  ASSERT_EQ(value, "value");
+  std::vector<std::string> members;
+  ASSERT_TRUE(db.SMembers("SET_KEY_7", &members).ok());
+  ASSERT_EQ(members, std::vector<std::string>{"member"});
+  std::vector<std::string> elements;
+  ASSERT_TRUE(db.LRange("LIST_KEY_7", 0, -1, &elements).ok());
+  ASSERT_EQ(elements, (std::vector<std::string>{"a", "b"}));
+  std::vector<storage::ScoreMember> score_members;
+  ASSERT_TRUE(db.ZRange("ZSET_KEY_7", 0, -1, &score_members).ok());
+  ASSERT_EQ(score_members.size(), 2);
+  ASSERT_EQ(score_members[0].member, "a");
+  ASSERT_EQ(score_members[1].member, "b");
+
+  std::set<std::string> scanned;
+  std::vector<std::string> keys;
+  int64_t cursor = 0;
+  do {
+    keys.clear();
+    cursor = db.Scan(DataType::kAll, cursor, "*", 7, &keys);
+    scanned.insert(keys.begin(), keys.end());
+  } while (cursor != 0);
+  ASSERT_EQ(scanned.size(), 500);
+
+  ASSERT_TRUE(db.PKScanRange(DataType::kStrings, "", "", "*", 10, &keys, nullptr, &value).IsNotSupported());
+}
+
+// DeleteSlots
+TEST_F(SlotKeyPrefixTest, DeleteSlotsTest) {
+  ASSERT_TRUE(s.ok());
+  auto slot_keys = WriteKeys(&db, 200);
+
+  std::vector<uint32_t> slots;
+  for (const auto& [slot, keys] : slot_keys) {
+    if (slots.size() < 10) {
+      slots.push_back(slot);
+    }
+  }
+  ASSERT_TRUE(db.DeleteSlots(slots).ok());
+
+  for (const auto& [slot, keys] : slot_keys) {
+    bool deleted = std::find(slots.begin(), slots.end(), slot) != slots.end();
+    int64_t num = 0;
+    ASSERT_TRUE(db.SlotKeyNum(slot, &num).ok());
+    ASSERT_EQ(num, deleted ? 0 : static_cast<int64_t>(keys.size()));
+    for (const auto& key : keys) {
+      std::vector<std::string> exist_keys{key.substr(1)};
+      ASSERT_EQ(db.Exists(exist_keys), deleted ? 0 : 1);
+      if (!deleted && key[0] == 'z') {
+        int32_t card = 0;
+        ASSERT_TRUE(db.ZCard(key.substr(1), &card).ok());
+        ASSERT_EQ(card, 2);
+        std::vector<storage::ScoreMember> score_members;
+        ASSERT_TRUE(db.ZRange(key.substr(1), 0, -1, &score_members).ok());
+        ASSERT_EQ(score_members.size(), 2);
+      }
+    }
+  }
+
+  // A deleted zset is recreated from scratch
+  for (const auto& [slot, keys] : slot_keys) {
+    if (slot != slots[0]) {
+      continue;
+    }
+    for (const auto& key : keys) {
+      if (key[0] != 'z') {
+        continue;
+      }
+      int32_t ret = 0;
+      ASSERT_TRUE(db.ZAdd(key.substr(1), {{3, "c"}}, &ret).ok());
+      std::vector<storage::ScoreMember> score_members;
+      ASSERT_TRUE(db.ZRange(key.substr(1), 0, -1, &score_members).ok());
+      ASSERT_EQ(score_members.size(), 1);
+      ASSERT_EQ(score_members[0].member, "c");
+    }
+  }
+}
+
+// ConvertToSlotKeyPrefix
+TEST(SlotKeyPrefixConvertTest, ConvertTest) {
+  std::string src_path = "./db/slot_key_prefix_src";
+  std::string dst_path = "./db/slot_key_prefix_dst";
+  pstd::DeleteDirIfExist(src_path);
+  pstd::DeleteDirIfExist(dst_path);
+
+  std::map<uint32_t, std::set<std::string>> slot_keys;
+  int64_t converted = 0;
+  {
+    storage::StorageOptions src_options;
+    src_options.options.create_if_missing = true;
+    storage::Storage src;
+    ASSERT_TRUE(src.Open(src_options, src_path).ok());
+    slot_keys = WriteKeys(&src, 100);
+
+    storage::StorageOptions dst_options;
+    dst_options.options.create_if_missing = true;
+    dst_options.slot_key_prefix = true;
+    storage::Storage dst;
+    ASSERT_TRUE(dst.Open(dst_options, dst_path).ok());
+    ASSERT_TRUE(src.ConvertToSlotKeyPrefix(&dst, &converted).ok());
+    ASSERT_GT(converted, 500);
+
+    for (const auto& [slot, keys] : slot_keys) {
+      ASSERT_EQ(ScanWholeSlot(&dst, slot, 10), keys);
+    }
+    std::string value;
+    ASSERT_TRUE(dst.Get("STRING_KEY_3", &value).ok());
+    ASSERT_EQ(value, "value");
+    std::vector<storage::FieldValue> fvs;
+    ASSERT_TRUE(dst.HGetall("HASH_KEY_3", &fvs).ok());
+    ASSERT_EQ(fvs.size(), 1);
+    std::vector<std::string> elements;
+    ASSERT_TRUE(dst.LRange("LIST_KEY_3", 0, -1, &elements).ok());
+    ASSERT_EQ(elements, (std::vector<std::string>{"a", "b"}));
+    std::vector<storage::ScoreMember> score_members;
+    ASSERT_TRUE(dst.ZRange("ZSET_KEY_3", 0, -1, &score_members).ok());
+    ASSERT_EQ(score_members.size(), 2);
+
+    // Each storage keeps its own layout
+    ASSERT_EQ(src.SlotKeyPrefixNum(), 0);
+    ASSERT_NE(dst.SlotKeyPrefixNum(), 0);
+    ASSERT_TRUE(src.Get("STRING_KEY_3", &value).ok());
+    ASSERT_EQ(value, "value");
+    elements.clear();
+    ASSERT_TRUE(src.LRange("LIST_KEY_3", 0, -1, &elements).ok());
+    ASSERT_EQ(elements, (std::vector<std::string>{"a", "b"}));
+    ASSERT_TRUE(src.Set("STRING_KEY_NEW", "new").ok());
+    ASSERT_TRUE(dst.Get("STRING_KEY_NEW", &value).IsNotFound());
+    ASSERT_TRUE(src.Get("STRING_KEY_NEW", &value).ok());
+    ASSERT_EQ(value, "new");
+
+    // A target in the classic layout is refused
+    storage::StorageOptions classic_options;
+    classic_options.options.create_if_missing = true;
+    storage::Storage classic;
+    ASSERT_TRUE(classic.Open(classic_options, dst_path + "_classic").ok());
+    ASSERT_TRUE(src.ConvertToSlotKeyPrefix(&classic, &converted).IsInvalidArgument());
+  }
+  storage::DeleteFiles(src_path.c_str());
+  storage::DeleteFiles(dst_path.c_str());
+  storage::DeleteFiles((dst_path + "_classic").c_str());
+}
+
+int main(int argc, char** argv) {
+  if (!pstd::FileExists("./log")) {
+    pstd::CreatePath("./log");
+  }
+  FLAGS_log_dir = "./log";
+  FLAGS_minloglevel = 0;
+  FLAGS_max_log_size = 1800;
+  FLAGS_logbufsecs = 0;
+  ::google::InitGoogleLogging("slot_key_prefix_test");
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -531,6 +531,35 @@ TEST_F(StringsTest, MGetTest) {
   ASSERT_EQ(vss[2].value, "");
   ASSERT_TRUE(vss[3].status.IsNotFound());
   ASSERT_EQ(vss[3].value, "");
+
+  // ***************** Group 3 Test *****************
+  // Keys spread over every db instance keep their order
+  int32_t ret = 0;
+  std::vector<std::string> keys3;
+  for (int i = 0; i < 200; i++) {
+    std::string key = "GP3_MGET_KEY" + std::to_string(i);
+    if (i % 3 == 0) {
+      s = db.Set(key, "VALUE" + std::to_string(i));
+      ASSERT_TRUE(s.ok());
+    } else if (i % 3 == 1) {
+      s = db.HSet(key, "FIELD", "VALUE", &ret);
+      ASSERT_TRUE(s.ok());
+    }
+    keys3.push_back(key);
+  }
+  vss.clear();
+  s = db.MGet(keys3, &vss);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(vss.size(), 200);
+  for (int i = 0; i < 200; i++) {
+    if (i % 3 == 0) {
+      ASSERT_TRUE(vss[i].status.ok());
+      ASSERT_EQ(vss[i].value, "VALUE" + std::to_string(i));
+    } else {
+      ASSERT_TRUE(vss[i].status.IsNotFound());
+      ASSERT_EQ(vss[i].value, "");
+    }
+  }
 }
 
 // MSet
@@ -650,6 +679,75 @@ TEST_F(StringsTest, SetBitTest) {
   // The offset argument is less than 0
   s = db.SetBit("GP5_SETBIT_KEY", -1, 0, &ret);
   ASSERT_TRUE(s.IsInvalidArgument());
+
+  // ***************** Group 6 Test *****************
+  // Grows past one segment and turns into a bitmap
+  s = db.SetBit("GP6_SETBIT_KEY", 3, 1, &ret);
+  ASSERT_TRUE(s.ok());
+  s = db.SetBit("GP6_SETBIT_KEY", 1000000, 1, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 0);
+
+  s = db.GetBit("GP6_SETBIT_KEY", 1000000, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1);
+  s = db.GetBit("GP6_SETBIT_KEY", 999999, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 0);
+  s = db.GetBit("GP6_SETBIT_KEY", 3, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1);
+
+  int32_t len;
+  s = db.Strlen("GP6_SETBIT_KEY", &len);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(len, 125001);
+
+  s = db.BitCount("GP6_SETBIT_KEY", 0, -1, &ret, false);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 2);
+  s = db.BitCount("GP6_SETBIT_KEY", 1, -1, &ret, true);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1);
+
+  int64_t pos;
+  s = db.BitPos("GP6_SETBIT_KEY", 1, &pos);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(pos, 3);
+  s = db.BitPos("GP6_SETBIT_KEY", 1, 1, &pos);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(pos, 1000000);
+  s = db.BitPos("GP6_SETBIT_KEY", 0, 1, &pos);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(pos, 8);
+
+  s = db.Get("GP6_SETBIT_KEY", &value);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(value.size(), 125001);
+  ASSERT_EQ(value[0], '\x10');
+  ASSERT_EQ(value[125000], '\x80');
+
+  s = db.Set("GP6_SETBIT_SRC", "\x01");
+  ASSERT_TRUE(s.ok());
+  std::vector<std::string> src_keys {"GP6_SETBIT_KEY", "GP6_SETBIT_SRC"};
+  std::string value_to_dest;
+  int64_t dest_len;
+  s = db.BitOp(storage::BitOpType::kBitOpOr, "GP6_SETBIT_DEST", src_keys, value_to_dest, &dest_len);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(dest_len, 125001);
+  s = db.BitCount("GP6_SETBIT_DEST", 0, -1, &ret, false);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 3);
+
+  s = db.SetBit("GP6_SETBIT_KEY", 1000000, 0, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1);
+  s = db.BitCount("GP6_SETBIT_KEY", 0, -1, &ret, false);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1);
+  s = db.Strlen("GP6_SETBIT_KEY", &len);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(len, 125001);
 }
 
 // Setex
@@ -1007,6 +1105,29 @@ TEST_F(StringsTest, PKSetexAtTest) {
   ASSERT_EQ(ttl_ret, -2);
 }
 
+// PKSetexAt
+TEST_F(StringsTest, PKSetexAtReapTest) {
+  int64_t unix_time;
+  rocksdb::Env::Default()->GetCurrentTime(&unix_time);
+
+  // Indexed by its expire time like SETEX, so the reaper finds it
+  s = db.PKSetexAt("PKSETEXAT_REAP_KEY", "VALUE", unix_time + 1);
+  ASSERT_TRUE(s.ok());
+  // Set again with a later expire time, only that one is kept
+  s = db.PKSetexAt("PKSETEXAT_LATER_KEY", "VALUE", unix_time + 1);
+  ASSERT_TRUE(s.ok());
+  s = db.PKSetexAt("PKSETEXAT_LATER_KEY", "VALUE", unix_time + 100);
+  ASSERT_TRUE(s.ok());
+  std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+  s = db.ReapExpiredKeys(100, true);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(db.GetReapedKeys(), 1);
+  ASSERT_GT(db.GetReclaimedBytes(), 0);
+  ASSERT_EQ(db.Exists({"PKSETEXAT_REAP_KEY"}), 0);
+  ASSERT_EQ(db.Exists({"PKSETEXAT_LATER_KEY"}), 1);
+}
+
 int main(int argc, char** argv) {
   if (!pstd::FileExists("./log")) {
     pstd::CreatePath("./log");
@@ -4,7 +4,9 @@
 //  of patent rights can be found in the PATENTS file in the same directory.
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <iostream>
+#include <set>
 #include <thread>
 
 #include "glog/logging.h"
@@ -5235,6 +5237,196 @@ TEST_F(ZSetsTest, ZScanTest) {  // NOLINT
   ASSERT_TRUE(score_members_match(score_member_out, {}));
 }
 
+// Rank index
+TEST_F(ZSetsTest, ZRankIndexTest) {  // NOLINT
+  int32_t ret;
+  int32_t rank;
+  double score;
+  std::vector<storage::ScoreMember> score_member_out;
+  std::set<std::pair<double, std::string>> expect;
+
+  auto expect_range = [&](int32_t start, int32_t stop) {
+    std::vector<storage::ScoreMember> score_members;
+    int32_t cur_index = 0;
+    for (const auto& item : expect) {
+      if (cur_index >= start && cur_index <= stop) {
+        score_members.push_back({item.first, item.second});
+      }
+      cur_index++;
+    }
+    return score_members;
+  };
+  auto check_index = [&]() {
+    int32_t cur_index = 0;
+    for (const auto& item : expect) {
+      if (cur_index % 97 == 0) {
+        ASSERT_TRUE(db.ZRank("GP1_ZRANK_INDEX_KEY", item.second, &rank).ok());
+        ASSERT_EQ(rank, cur_index);
+        ASSERT_TRUE(db.ZRevrank("GP1_ZRANK_INDEX_KEY", item.second, &rank).ok());
+        ASSERT_EQ(rank, static_cast<int32_t>(expect.size()) - 1 - cur_index);
+      }
+      cur_index++;
+    }
+    for (int32_t start = 0; start < static_cast<int32_t>(expect.size()); start += 331) {
+      ASSERT_TRUE(db.ZRange("GP1_ZRANK_INDEX_KEY", start, start + 9, &score_member_out).ok());
+      ASSERT_TRUE(score_members_match(score_member_out, expect_range(start, start + 9)));
+      ASSERT_TRUE(db.ZRevrange("GP1_ZRANK_INDEX_KEY", start, start + 9, &score_member_out).ok());
+      std::vector<storage::ScoreMember> rev_expect =
+          expect_range(static_cast<int32_t>(expect.size()) - 10 - start, static_cast<int32_t>(expect.size()) - 1 - start);
+      std::reverse(rev_expect.begin(), rev_expect.end());
+      ASSERT_TRUE(score_members_match(score_member_out, rev_expect));
+      ASSERT_TRUE(db.ZRangebyscore("GP1_ZRANK_INDEX_KEY", std::numeric_limits<double>::lowest(),
+                                   std::numeric_limits<double>::max(), true, true, 10, start, &score_member_out)
+                      .ok());
+      ASSERT_TRUE(score_members_match(score_member_out, expect_range(start, start + 9)));
+    }
+  };
+
+  db.SetZSetsRankIndexThreshold(100);
+  std::vector<storage::ScoreMember> score_members;
+  for (int32_t i = 0; i < 3000; ++i) {
+    score_members.push_back({static_cast<double>(i % 300), "MM" + std::to_string(i)});
+    expect.insert({static_cast<double>(i % 300), "MM" + std::to_string(i)});
+  }
+  s = db.ZAdd("GP1_ZRANK_INDEX_KEY", score_members, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 3000);
+  check_index();
+
+  // Grow some buckets until they are split
+  score_members.clear();
+  for (int32_t i = 0; i < 2000; ++i) {
+    score_members.push_back({150.5, "NN" + std::to_string(i)});
+    expect.insert({150.5, "NN" + std::to_string(i)});
+  }
+  s = db.ZAdd("GP1_ZRANK_INDEX_KEY", score_members, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 2000);
+  check_index();
+
+  // Move members around and drop whole buckets
+  for (int32_t i = 0; i < 3000; i += 7) {
+    std::string member = "MM" + std::to_string(i);
+    s = db.ZIncrby("GP1_ZRANK_INDEX_KEY", member, 1000, &score);
+    ASSERT_TRUE(s.ok());
+    expect.erase({static_cast<double>(i % 300), member});
+    expect.insert({score, member});
+  }
+  std::vector<std::string> members;
+  for (int32_t i = 0; i < 1500; ++i) {
+    members.push_back("NN" + std::to_string(i));
+    expect.erase({150.5, "NN" + std::to_string(i)});
+  }
+  s = db.ZRem("GP1_ZRANK_INDEX_KEY", members, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1500);
+  check_index();
+
+  s = db.ZRemrangebyrank("GP1_ZRANK_INDEX_KEY", 100, 899, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 800);
+  expect.erase(std::next(expect.begin(), 100), std::next(expect.begin(), 900));
+  check_index();
+
+  s = db.ZPopMin("GP1_ZRANK_INDEX_KEY", 300, &score_member_out);
+  ASSERT_TRUE(s.ok());
+  expect.erase(expect.begin(), std::next(expect.begin(), 300));
+  s = db.ZRemrangebyscore("GP1_ZRANK_INDEX_KEY", 1000, 1100, true, true, &ret);
+  ASSERT_TRUE(s.ok());
+  expect.erase(expect.lower_bound({1000, ""}), expect.upper_bound({1100, "\xff"}));
+  ASSERT_TRUE(db.ZCard("GP1_ZRANK_INDEX_KEY", &ret).ok());
+  ASSERT_EQ(ret, static_cast<int32_t>(expect.size()));
+  check_index();
+
+  // The index is dropped with the key and rebuilt for the new version
+  ASSERT_EQ(db.Del({"GP1_ZRANK_INDEX_KEY"}), 1);
+  expect.clear();
+  score_members.clear();
+  for (int32_t i = 0; i < 500; ++i) {
+    score_members.push_back({static_cast<double>(-i), "OO" + std::to_string(i)});
+    expect.insert({static_cast<double>(-i), "OO" + std::to_string(i)});
+  }
+  s = db.ZAdd("GP1_ZRANK_INDEX_KEY", score_members, &ret);
+  ASSERT_TRUE(s.ok());
+  check_index();
+
+  // Disabling the index falls back to scanning
+  db.SetZSetsRankIndexThreshold(0);
+  check_index();
+}
+
+// Members scored -inf and +inf keep the same ranks with and without the rank index
+TEST_F(ZSetsTest, ZRankIndexInfinityTest) {  // NOLINT
+  int32_t ret;
+  int32_t rank;
+  const double inf = std::numeric_limits<double>::infinity();
+  std::vector<storage::ScoreMember> score_member_out;
+  std::set<std::pair<double, std::string>> expect;
+
+  auto check = [&]() {
+    std::vector<storage::ScoreMember> all;
+    for (const auto& item : expect) {
+      all.push_back({item.first, item.second});
+    }
+    int32_t size = static_cast<int32_t>(all.size());
+    for (int32_t i = 0; i < size; ++i) {
+      ASSERT_TRUE(db.ZRank("GP1_ZRANK_INDEX_INF_KEY", all[i].member, &rank).ok());
+      ASSERT_EQ(rank, i);
+      ASSERT_TRUE(db.ZRevrank("GP1_ZRANK_INDEX_INF_KEY", all[i].member, &rank).ok());
+      ASSERT_EQ(rank, size - 1 - i);
+    }
+    ASSERT_TRUE(db.ZRange("GP1_ZRANK_INDEX_INF_KEY", 0, -1, &score_member_out).ok());
+    ASSERT_TRUE(score_members_match(score_member_out, all));
+    ASSERT_TRUE(db.ZRange("GP1_ZRANK_INDEX_INF_KEY", 0, 2, &score_member_out).ok());
+    ASSERT_TRUE(score_members_match(score_member_out, {all[0], all[1], all[2]}));
+    ASSERT_TRUE(db.ZRevrange("GP1_ZRANK_INDEX_INF_KEY", 0, 2, &score_member_out).ok());
+    ASSERT_TRUE(score_members_match(score_member_out, {all[size - 1], all[size - 2], all[size - 3]}));
+    ASSERT_TRUE(db.ZRangebyscore("GP1_ZRANK_INDEX_INF_KEY", -inf, inf, true, true, 3, 1, &score_member_out).ok());
+    ASSERT_TRUE(score_members_match(score_member_out, {all[1], all[2], all[3]}));
+  };
+
+  db.SetZSetsRankIndexThreshold(50);
+  std::vector<storage::ScoreMember> score_members;
+  for (int32_t i = 0; i < 40; ++i) {
+    double score = i < 5 ? -inf : (i < 10 ? inf : static_cast<double>(i));
+    score_members.push_back({score, "MM" + std::to_string(i)});
+    expect.insert({score, "MM" + std::to_string(i)});
+  }
+  s = db.ZAdd("GP1_ZRANK_INDEX_INF_KEY", score_members, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 40);
+  // Below the threshold, scanned
+  check();
+
+  score_members.clear();
+  for (int32_t i = 40; i < 80; ++i) {
+    double score = i % 2 == 0 ? -inf : inf;
+    score_members.push_back({score, "MM" + std::to_string(i)});
+    expect.insert({score, "MM" + std::to_string(i)});
+  }
+  s = db.ZAdd("GP1_ZRANK_INDEX_INF_KEY", score_members, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 40);
+  // Over the threshold, indexed
+  check();
+
+  // The infinite members are popped first
+  s = db.ZPopMax("GP1_ZRANK_INDEX_INF_KEY", 2, &score_member_out);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(score_members_match(score_member_out, {{inf, std::prev(expect.end())->second},
+                                                     {inf, std::prev(expect.end(), 2)->second}}));
+  expect.erase(std::prev(expect.end(), 2), expect.end());
+  s = db.ZPopMin("GP1_ZRANK_INDEX_INF_KEY", 2, &score_member_out);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(score_members_match(score_member_out, {{-inf, expect.begin()->second},
+                                                     {-inf, std::next(expect.begin())->second}}));
+  expect.erase(expect.begin(), std::next(expect.begin(), 2));
+  check();
+
+  db.SetZSetsRankIndexThreshold(0);
+  check();
+}
+
 int main(int argc, char** argv) {
   if (!pstd::FileExists("./log")) {
     pstd::CreatePath("./log");
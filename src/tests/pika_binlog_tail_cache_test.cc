@@ -0,0 +1,164 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "include/pika_binlog_tail_cache.h"
+
+using Record = BinlogTailCache::Record;
+
+// num records of size bytes each, following one another from prev in file filenum
+static std::vector<Record> MakeRecords(const BinlogOffset& prev, uint32_t filenum, int num, size_t size,
+                                       uint64_t logic_id = 1) {
+  std::vector<Record> records;
+  BinlogOffset offset = prev;
+  for (int i = 0; i < num; i++) {
+    Record record;
+    record.prev_offset = offset;
+    offset = BinlogOffset(filenum, (offset.filenum == filenum ? offset.offset : 0) + size);
+    record.offset = LogOffset(offset, LogicOffset(1, logic_id + i));
+    record.binlog = std::string(size, static_cast<char>('a' + i % 26));
+    records.push_back(std::move(record));
+  }
+  return records;
+}
+
+TEST(BinlogTailCacheTest, ReadTest) {
+  BinlogTailCache cache;
+  std::vector<Record> records = MakeRecords(BinlogOffset(1, 0), 1, 10, 100);
+  std::vector<Record> expect = records;
+  cache.Append(&records, 1 << 20);
+
+  // Hit, from the first and from a later record
+  std::vector<Record> read;
+  ASSERT_TRUE(cache.Read(BinlogOffset(1, 0), 100, 1 << 20, &read));
+  ASSERT_EQ(read.size(), 10);
+  for (size_t i = 0; i < read.size(); i++) {
+    ASSERT_EQ(read[i].prev_offset, expect[i].prev_offset);
+    ASSERT_EQ(read[i].offset.b_offset, expect[i].offset.b_offset);
+    ASSERT_EQ(read[i].binlog, expect[i].binlog);
+  }
+  read.clear();
+  ASSERT_TRUE(cache.Read(BinlogOffset(1, 300), 100, 1 << 20, &read));
+  ASSERT_EQ(read.size(), 7);
+  ASSERT_EQ(read.front().prev_offset, BinlogOffset(1, 300));
+
+  // At most max_num records, stopping after max_bytes are exceeded
+  read.clear();
+  ASSERT_TRUE(cache.Read(BinlogOffset(1, 0), 4, 1 << 20, &read));
+  ASSERT_EQ(read.size(), 4);
+  read.clear();
+  ASSERT_TRUE(cache.Read(BinlogOffset(1, 0), 100, 250, &read));
+  ASSERT_EQ(read.size(), 3);
+
+  // Caught up with the cache
+  read.clear();
+  ASSERT_TRUE(cache.Read(BinlogOffset(1, 1000), 100, 1 << 20, &read));
+  ASSERT_TRUE(read.empty());
+
+  // Below the retained range, past it, and not at a record boundary
+  ASSERT_FALSE(cache.Read(BinlogOffset(0, 500), 100, 1 << 20, &read));
+  ASSERT_FALSE(cache.Read(BinlogOffset(1, 1100), 100, 1 << 20, &read));
+  ASSERT_FALSE(cache.Read(BinlogOffset(1, 150), 100, 1 << 20, &read));
+  ASSERT_TRUE(read.empty());
+
+  BinlogTailCache::Stats stats = cache.stats();
+  ASSERT_EQ(stats.hits, 4);
+  ASSERT_EQ(stats.misses, 3);
+  ASSERT_EQ(stats.served_records, 10 + 7 + 4 + 3);
+  ASSERT_EQ(stats.records, 10);
+  ASSERT_EQ(stats.bytes, 1000);
+}
+
+TEST(BinlogTailCacheTest, TrimTest) {
+  BinlogTailCache cache;
+  std::vector<Record> records = MakeRecords(BinlogOffset(1, 0), 1, 10, 100);
+  cache.Append(&records, 450);
+
+  // Trimmed from the front down to the byte budget
+  BinlogTailCache::Stats stats = cache.stats();
+  ASSERT_EQ(stats.records, 4);
+  ASSERT_EQ(stats.bytes, 400);
+  std::vector<Record> read;
+  ASSERT_FALSE(cache.Read(BinlogOffset(1, 500), 100, 1 << 20, &read));
+  ASSERT_TRUE(cache.Read(BinlogOffset(1, 600), 100, 1 << 20, &read));
+  ASSERT_EQ(read.size(), 4);
+
+  records = MakeRecords(BinlogOffset(1, 1000), 1, 2, 100, 11);
+  cache.Append(&records, 450);
+  stats = cache.stats();
+  ASSERT_EQ(stats.records, 4);
+  ASSERT_EQ(stats.bytes, 400);
+  read.clear();
+  ASSERT_FALSE(cache.Read(BinlogOffset(1, 600), 100, 1 << 20, &read));
+  ASSERT_TRUE(cache.Read(BinlogOffset(1, 800), 100, 1 << 20, &read));
+  ASSERT_EQ(read.size(), 4);
+
+  // A capacity of 0 empties the cache
+  records = MakeRecords(BinlogOffset(1, 1200), 1, 1, 100, 13);
+  cache.Append(&records, 0);
+  stats = cache.stats();
+  ASSERT_EQ(stats.records, 0);
+  ASSERT_EQ(stats.bytes, 0);
+}
+
+TEST(BinlogTailCacheTest, GapTest) {
+  BinlogTailCache cache;
+  std::vector<Record> records = MakeRecords(BinlogOffset(1, 0), 1, 5, 100);
+  cache.Append(&records, 1 << 20);
+
+  // The new records do not follow the cached ones, those are dropped
+  records = MakeRecords(BinlogOffset(1, 800), 1, 3, 100, 9);
+  cache.Append(&records, 1 << 20);
+  BinlogTailCache::Stats stats = cache.stats();
+  ASSERT_EQ(stats.records, 3);
+  ASSERT_EQ(stats.bytes, 300);
+  std::vector<Record> read;
+  ASSERT_FALSE(cache.Read(BinlogOffset(1, 0), 100, 1 << 20, &read));
+  ASSERT_FALSE(cache.Read(BinlogOffset(1, 500), 100, 1 << 20, &read));
+  ASSERT_TRUE(cache.Read(BinlogOffset(1, 800), 100, 1 << 20, &read));
+  ASSERT_EQ(read.size(), 3);
+
+  cache.Clear();
+  stats = cache.stats();
+  ASSERT_EQ(stats.records, 0);
+  ASSERT_EQ(stats.bytes, 0);
+}
+
+TEST(BinlogTailCacheTest, FileRollTest) {
+  BinlogTailCache cache;
+  std::vector<Record> records = MakeRecords(BinlogOffset(1, 0), 1, 3, 100);
+  // The last record of file 1 is followed by the first of file 2, which
+  // starts right after where the reader stood at the end of file 1
+  std::vector<Record> rolled = MakeRecords(BinlogOffset(1, 300), 2, 3, 100, 4);
+  ASSERT_EQ(rolled.front().prev_offset, BinlogOffset(1, 300));
+  ASSERT_EQ(rolled.front().offset.b_offset, BinlogOffset(2, 100));
+  records.insert(records.end(), rolled.begin(), rolled.end());
+  cache.Append(&records, 1 << 20);
+
+  BinlogTailCache::Stats stats = cache.stats();
+  ASSERT_EQ(stats.records, 6);
+  std::vector<Record> read;
+  ASSERT_TRUE(cache.Read(BinlogOffset(1, 200), 100, 1 << 20, &read));
+  ASSERT_EQ(read.size(), 4);
+  ASSERT_EQ(read[1].prev_offset, BinlogOffset(1, 300));
+  ASSERT_EQ(read[1].offset.b_offset, BinlogOffset(2, 100));
+  read.clear();
+  ASSERT_TRUE(cache.Read(BinlogOffset(2, 100), 100, 1 << 20, &read));
+  ASSERT_EQ(read.size(), 2);
+
+  // Appended in a later batch, the roll is not taken for a gap either
+  records = MakeRecords(BinlogOffset(2, 300), 3, 1, 100, 7);
+  cache.Append(&records, 1 << 20);
+  stats = cache.stats();
+  ASSERT_EQ(stats.records, 7);
+  read.clear();
+  ASSERT_TRUE(cache.Read(BinlogOffset(1, 0), 100, 1 << 20, &read));
+  ASSERT_EQ(read.size(), 7);
+  ASSERT_EQ(read.back().offset.b_offset, BinlogOffset(3, 100));
+}
@@ -0,0 +1,149 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/pika_binlog.h"
+#include "include/pika_binlog_reader.h"
+#include "include/pika_binlog_transverter.h"
+#include "include/pika_conf.h"
+#include "pstd/include/env.h"
+
+// Not set up, the binlog falls back to its defaults
+std::unique_ptr<PikaConf> g_pika_conf;
+
+class BinlogTest : public ::testing::Test {
+ public:
+  void SetUp() override { pstd::DeleteDirIfExist(binlog_path_); }
+  void TearDown() override { pstd::DeleteDirIfExist(binlog_path_); }
+
+  // Reads back every item, each one must start where the previous one ended
+  static void ReadAll(const std::shared_ptr<Binlog>& binlog, std::vector<BinlogItem>* items) {
+    PikaBinlogReader reader;
+    ASSERT_EQ(reader.Seek(binlog, 0, 0), 0);
+    uint32_t filenum = 0;
+    uint64_t offset = 0;
+    std::string scratch;
+    while (true) {
+      uint32_t end_filenum = 0;
+      uint64_t end_offset = 0;
+      pstd::Status s = reader.Get(&scratch, &end_filenum, &end_offset);
+      if (s.IsEndFile()) {
+        break;
+      }
+      ASSERT_TRUE(s.ok()) << s.ToString();
+      BinlogItem item;
+      ASSERT_TRUE(PikaBinlogTransverter::BinlogDecode(BinlogType::TypeFirst, scratch, &item));
+      ASSERT_EQ(item.filenum(), filenum);
+      ASSERT_EQ(item.offset(), offset);
+      filenum = end_filenum;
+      offset = end_offset;
+      items->push_back(std::move(item));
+    }
+
+    uint32_t pro_num = 0;
+    uint64_t pro_offset = 0;
+    uint64_t logic_id = 0;
+    ASSERT_TRUE(binlog->GetProducerStatus(&pro_num, &pro_offset, nullptr, &logic_id).ok());
+    ASSERT_EQ(pro_num, filenum);
+    ASSERT_EQ(pro_offset, offset);
+    ASSERT_EQ(logic_id, items->size());
+  }
+
+  const std::string binlog_path_ = "./binlog_group_commit/";
+};
+
+TEST_F(BinlogTest, ConcurrentPutTest) {
+  constexpr int kThreads = 8;
+  constexpr int kItemsPerThread = 500;
+  // Small files, so that batches roll over to new ones
+  auto binlog = std::make_shared<Binlog>(binlog_path_, 64 << 10);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        std::string item = std::to_string(t) + ":" + std::to_string(i) + ":" + std::string(100 + i % 50, 'x');
+        ASSERT_TRUE(binlog->Put(item).ok());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<BinlogItem> items;
+  ReadAll(binlog, &items);
+  ASSERT_EQ(items.size(), kThreads * kItemsPerThread);
+  ASSERT_GT(items.back().filenum(), 0);
+
+  // Every item is written once, in the order its thread put it
+  std::vector<int> next(kThreads, 0);
+  for (size_t i = 0; i < items.size(); i++) {
+    ASSERT_EQ(items[i].logic_id(), i + 1);
+    const std::string content = items[i].content();
+    size_t sep = content.find(':');
+    size_t sep2 = content.find(':', sep + 1);
+    int t = std::stoi(content.substr(0, sep));
+    int seq = std::stoi(content.substr(sep + 1, sep2 - sep - 1));
+    ASSERT_EQ(seq, next[t]);
+    ASSERT_EQ(content.size(), sep2 + 1 + 100 + seq % 50);
+    next[t]++;
+  }
+  for (int t = 0; t < kThreads; t++) {
+    ASSERT_EQ(next[t], kItemsPerThread);
+  }
+
+  Binlog::GroupCommitStats stats = binlog->group_commit_stats();
+  ASSERT_EQ(stats.items, kThreads * kItemsPerThread);
+  ASSERT_LE(stats.batches, stats.items);
+  ASSERT_LE(stats.max_batch_size, kBinlogGroupCommitDefaultBatch);
+}
+
+TEST_F(BinlogTest, GroupCommitTest) {
+  constexpr int kThreads = 8;
+  auto binlog = std::make_shared<Binlog>(binlog_path_);
+
+  // The first leader blocks on the binlog lock while the others queue up
+  // behind it, the next leader then writes all of them as one batch
+  binlog->Lock();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t] { ASSERT_TRUE(binlog->Put("item_" + std::to_string(t)).ok()); });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  binlog->Unlock();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  Binlog::GroupCommitStats stats = binlog->group_commit_stats();
+  ASSERT_EQ(stats.items, kThreads);
+  ASSERT_LT(stats.batches, kThreads);
+  ASSERT_GT(stats.max_batch_size, 1);
+
+  // A batch publishes the producer status once, after its last item
+  std::vector<BinlogItem> items;
+  ReadAll(binlog, &items);
+  ASSERT_EQ(items.size(), kThreads);
+
+  // Items put together are written back to back within one batch
+  std::vector<std::string> batch = {"a", "b", "c"};
+  ASSERT_TRUE(binlog->Put(batch).ok());
+  stats = binlog->group_commit_stats();
+  ASSERT_EQ(stats.items, kThreads + batch.size());
+  items.clear();
+  ReadAll(binlog, &items);
+  ASSERT_EQ(items.size(), kThreads + batch.size());
+  for (size_t i = 0; i < batch.size(); i++) {
+    ASSERT_EQ(items[kThreads + i].content(), batch[i]);
+  }
+}
@@ -0,0 +1,84 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "include/pika_repl_compression.h"
+
+// A BinlogSync frame of items alike, as a master sends to its slaves
+static std::string BinlogSyncFrame(int items) {
+  InnerMessage::InnerResponse response;
+  response.set_code(InnerMessage::kOk);
+  response.set_type(InnerMessage::Type::kBinlogSync);
+  for (int i = 0; i < items; i++) {
+    InnerMessage::InnerResponse::BinlogSync* binlog_sync = response.add_binlog_sync();
+    binlog_sync->set_session_id(1);
+    binlog_sync->mutable_slot()->set_db_name("db0");
+    binlog_sync->mutable_slot()->set_slot_id(0);
+    InnerMessage::BinlogOffset* offset = binlog_sync->mutable_binlog_offset();
+    offset->set_filenum(0);
+    offset->set_offset(i * 100);
+    offset->set_term(0);
+    offset->set_index(i);
+    binlog_sync->set_binlog("*3\r\n$3\r\nset\r\n$8\r\nkey_" + std::to_string(1000 + i) + "\r\n$10\r\nvalue_" +
+                            std::to_string(1000 + i) + "\r\n");
+  }
+  return response.SerializeAsString();
+}
+
+TEST(ReplCompressionTest, RoundTripTest) {
+  const std::string raw = BinlogSyncFrame(100);
+  for (auto type : {InnerMessage::kLZ4Compression, InnerMessage::kZSTDCompression}) {
+    std::string wire;
+    ASSERT_TRUE(ReplCompressFrame(type, raw, &wire)) << ReplCompressionName(type);
+    ASSERT_LT(wire.size(), raw.size());
+
+    InnerMessage::InnerResponse response;
+    ASSERT_TRUE(response.ParseFromString(wire));
+    ASSERT_TRUE(response.has_compressed_frame());
+    ASSERT_EQ(response.compression(), type);
+    ASSERT_EQ(response.raw_frame_size(), raw.size());
+
+    InnerMessage::InnerResponse frame;
+    ASSERT_TRUE(ReplDecompressFrame(response, raw.size(), &frame));
+    ASSERT_EQ(frame.SerializeAsString(), raw);
+    ASSERT_EQ(frame.binlog_sync_size(), 100);
+    ASSERT_EQ(frame.binlog_sync(99).binlog_offset().index(), 99);
+  }
+
+  // Frames too small to pay off are sent as they are
+  std::string wire;
+  ASSERT_FALSE(ReplCompressFrame(InnerMessage::kLZ4Compression, BinlogSyncFrame(1), &wire));
+  ASSERT_FALSE(ReplCompressFrame(InnerMessage::kNoCompression, raw, &wire));
+}
+
+TEST(ReplCompressionTest, RawFrameSizeTest) {
+  const std::string raw = BinlogSyncFrame(100);
+  for (auto type : {InnerMessage::kLZ4Compression, InnerMessage::kZSTDCompression}) {
+    std::string wire;
+    ASSERT_TRUE(ReplCompressFrame(type, raw, &wire));
+    InnerMessage::InnerResponse response;
+    ASSERT_TRUE(response.ParseFromString(wire));
+    InnerMessage::InnerResponse frame;
+
+    // Larger than the slave takes
+    ASSERT_FALSE(ReplDecompressFrame(response, raw.size() - 1, &frame)) << ReplCompressionName(type);
+
+    // A size that does not match the frame
+    response.set_raw_frame_size(raw.size() - 1);
+    ASSERT_FALSE(ReplDecompressFrame(response, raw.size(), &frame));
+    response.set_raw_frame_size(raw.size() + 1);
+    ASSERT_FALSE(ReplDecompressFrame(response, raw.size() + 1, &frame));
+
+    // Corrupted data
+    response.set_raw_frame_size(raw.size());
+    std::string corrupted = response.compressed_frame();
+    corrupted.resize(corrupted.size() / 2);
+    response.set_compressed_frame(corrupted);
+    ASSERT_FALSE(ReplDecompressFrame(response, raw.size(), &frame));
+  }
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/pika_statistic.h"
+
+TEST(LatencyHistogramTest, PercentileTest) {
+  LatencyHistogram histogram;
+  ASSERT_EQ(histogram.Count(), 0);
+  ASSERT_EQ(histogram.Percentile(50), 0);
+
+  // Values below kSubBucketNum have a bucket each
+  for (uint64_t i = 0; i < LatencyHistogram::kSubBucketNum; i++) {
+    histogram.Add(i);
+  }
+  ASSERT_EQ(histogram.Count(), LatencyHistogram::kSubBucketNum);
+  ASSERT_EQ(histogram.Percentile(0), 0);
+  ASSERT_EQ(histogram.Percentile(50), LatencyHistogram::kSubBucketNum / 2 - 1);
+  ASSERT_EQ(histogram.Percentile(100), LatencyHistogram::kSubBucketNum - 1);
+
+  // Larger ones are reported with a relative error below 1 / kSubBucketNum
+  LatencyHistogram uniform;
+  for (uint64_t i = 1; i <= 100000; i++) {
+    uniform.Add(i);
+  }
+  for (double p : {50.0, 90.0, 99.0, 99.9}) {
+    auto expect = static_cast<double>(p * 1000);
+    auto value = static_cast<double>(uniform.Percentile(p));
+    ASSERT_GE(value, expect) << p;
+    ASSERT_LE(value, expect * (1 + 1.0 / LatencyHistogram::kSubBucketNum)) << p;
+  }
+
+  // Values past the largest bucket land in it
+  LatencyHistogram huge;
+  huge.Add(UINT64_MAX);
+  huge.Add(1ULL << LatencyHistogram::kMaxValueBits);
+  ASSERT_EQ(huge.Count(), 2);
+  ASSERT_GE(huge.Percentile(100), (1ULL << LatencyHistogram::kMaxValueBits) - 1);
+}
+
+TEST(LatencyHistogramTest, MergeTest) {
+  LatencyHistogram fast;
+  LatencyHistogram slow;
+  for (int i = 0; i < 99; i++) {
+    fast.Add(10);
+  }
+  slow.Add(10000);
+
+  LatencyHistogram merged;
+  merged.Merge(fast);
+  merged.Merge(slow);
+  ASSERT_EQ(merged.Count(), 100);
+  ASSERT_EQ(merged.Percentile(99), fast.Percentile(99));
+  ASSERT_EQ(merged.Percentile(100), slow.Percentile(100));
+
+  LatencyHistogram copy(merged);
+  ASSERT_EQ(copy.Count(), 100);
+  ASSERT_EQ(copy.Percentile(100), merged.Percentile(100));
+}
+
+TEST(StatisticTest, ShardedCountersTest) {
+  constexpr int kThreads = 4;
+  constexpr int kRounds = 10000;
+  Statistic statistic;
+  statistic.Init({"get", "", "set"}, {"db0", "db1"});
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < kRounds; i++) {
+        statistic.UpdateDBQps("db0", 0, false);
+        statistic.UpdateCmdTimeStat(0, 1, 2, 3);
+        statistic.UpdateDBQps("db1", 2, true);
+        statistic.UpdateCmdTimeStat(2, 10, 20, 30);
+      }
+      // Unknown commands and DBs are counted as queries only
+      statistic.UpdateDBQps("db9", 100, false);
+      statistic.UpdateCmdTimeStat(100, 1, 1, 1);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Every shard is summed up
+  const uint64_t per_cmd = static_cast<uint64_t>(kThreads) * kRounds;
+  ASSERT_EQ(statistic.QueryNum(), 2 * per_cmd + kThreads);
+  auto exec_count = statistic.ExecCount();
+  ASSERT_EQ(exec_count.size(), 2);
+  ASSERT_EQ(exec_count["GET"], per_cmd);
+  ASSERT_EQ(exec_count["SET"], per_cmd);
+
+  statistic.ResetLastSecQuerynum();
+  ASSERT_EQ(statistic.server_stat.qps.querynum.load(), 2 * per_cmd + kThreads);
+  QpsStatistic db0 = statistic.DBStat("db0");
+  ASSERT_EQ(db0.querynum.load(), per_cmd);
+  ASSERT_EQ(db0.write_querynum.load(), 0);
+  QpsStatistic db1 = statistic.DBStat("db1");
+  ASSERT_EQ(db1.querynum.load(), per_cmd);
+  ASSERT_EQ(db1.write_querynum.load(), per_cmd);
+
+  // The latency histograms are only merged when asked for
+  auto cmd_stats = statistic.CmdStats(false);
+  ASSERT_EQ(cmd_stats.size(), 2);
+  ASSERT_EQ(cmd_stats["get"].cmd_count, per_cmd);
+  ASSERT_EQ(cmd_stats["get"].cmd_time_consuming, 3 * per_cmd);
+  ASSERT_EQ(cmd_stats["set"].cmd_time_consuming, 30 * per_cmd);
+  ASSERT_TRUE(cmd_stats["get"].latency == nullptr);
+
+  cmd_stats = statistic.CmdStats(true);
+  const CmdLatencyStatistic* latency = cmd_stats["set"].latency.get();
+  ASSERT_TRUE(latency != nullptr);
+  ASSERT_EQ(latency->total_time.Count(), per_cmd);
+  // Reported as the upper bound of their bucket
+  ASSERT_EQ(latency->queue_time.Percentile(50), 10);
+  ASSERT_EQ(latency->process_time.Percentile(99), 21);
+  ASSERT_EQ(latency->total_time.Percentile(100), 31);
+
+  // Resetting the query count keeps the shards and counts from there
+  statistic.ResetQueryNum();
+  ASSERT_EQ(statistic.QueryNum(), 0);
+  statistic.UpdateDBQps("db0", 0, false);
+  ASSERT_EQ(statistic.QueryNum(), 1);
+  ASSERT_EQ(statistic.ExecCount()["GET"], per_cmd + 1);
+}
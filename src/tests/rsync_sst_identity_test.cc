@@ -0,0 +1,189 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "rocksdb/file_checksum.h"
+
+#include "include/pika_define.h"
+#include "include/rsync_sst_identity.h"
+#include "pstd/include/env.h"
+#include "storage/backupable.h"
+#include "storage/storage.h"
+
+using namespace rsync;
+
+class SstIdentityTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    pstd::DeleteDirIfExist(db_path_);
+    pstd::DeleteDirIfExist(dump_path_);
+    pstd::CreatePath(db_path_);
+    storage_options_.options.create_if_missing = true;
+    storage_options_.options.file_checksum_gen_factory = rocksdb::GetFileChecksumGenCrc32cFactory();
+    ASSERT_TRUE(db_.Open(storage_options_, db_path_).ok());
+  }
+
+  void TearDown() override { pstd::DeleteDirIfExist(dump_path_); }
+
+  // Writes some keys and compacts them to SST files
+  static void Fill(storage::Storage* db, const std::string& value) {
+    int32_t ret;
+    for (int i = 0; i < 1000; i++) {
+      std::string key = "SST_IDENTITY_KEY_" + std::to_string(i);
+      ASSERT_TRUE(db->Set(key, value).ok());
+      ASSERT_TRUE(db->HSet(key + "_HASH", "field", value, &ret).ok());
+    }
+    ASSERT_TRUE(db->Compact(storage::DataType::kAll, true).ok());
+  }
+
+  // Fills the db and checkpoints it to dump_path_
+  void Dump() {
+    Fill(&db_, std::string(100, 'v'));
+
+    std::shared_ptr<storage::BackupEngine> engine;
+    ASSERT_TRUE(storage::BackupEngine::Open(&db_, engine, kInstanceNum).ok());
+    ASSERT_TRUE(engine->SetBackupContent().ok());
+    ASSERT_TRUE(engine->CreateNewBackup(dump_path_).ok());
+  }
+
+  static constexpr int kInstanceNum = 3;
+  const std::string db_path_ = "./db/sst_identity";
+  const std::string dump_path_ = "./dump/sst_identity";
+  storage::StorageOptions storage_options_;
+  storage::Storage db_;
+};
+
+static bool FileSize(const std::string& path, uint64_t* size) {
+  struct stat buf;
+  if (stat(path.c_str(), &buf) != 0) {
+    return false;
+  }
+  *size = static_cast<uint64_t>(buf.st_size);
+  return true;
+}
+
+TEST_F(SstIdentityTest, RoundTripTest) {
+  Dump();
+  ASSERT_TRUE(WriteDumpSstIdentities(&db_, kInstanceNum, dump_path_).ok());
+
+  SstIdentityMap dumped;
+  ASSERT_TRUE(ReadDumpSstIdentities(dump_path_, &dumped).ok());
+  SstIdentityMap live;
+  GetLiveSstIdentities(&db_, kInstanceNum, &live);
+  ASSERT_FALSE(live.empty());
+  ASSERT_EQ(dumped.size(), live.size());
+
+  // Every live SST is in the dump, with its size and checksum
+  for (const auto& [name, sst] : live) {
+    auto iter = dumped.find(name);
+    ASSERT_TRUE(iter != dumped.end()) << name;
+    ASSERT_TRUE(iter->second.SameContent(sst)) << name;
+    ASSERT_EQ(iter->second.checksum_func, "FileChecksumCrc32c");
+    ASSERT_FALSE(iter->second.checksum.empty());
+    ASSERT_FALSE(iter->second.unique_id.empty());
+    ASSERT_TRUE(iter->second.path.empty());
+    uint64_t size = 0;
+    ASSERT_TRUE(FileSize(dump_path_ + "/" + name, &size)) << name;
+    ASSERT_EQ(size, sst.size);
+  }
+}
+
+TEST_F(SstIdentityTest, ChangedFileTest) {
+  Dump();
+  SstIdentityMap live;
+  GetLiveSstIdentities(&db_, kInstanceNum, &live);
+  ASSERT_FALSE(live.empty());
+
+  // A dump file that is no longer the live one is left out
+  const std::string changed = live.begin()->first;
+  std::string changed_path = dump_path_ + "/" + changed;
+  ASSERT_EQ(unlink(changed_path.c_str()), 0);
+  std::ofstream out(changed_path, std::ios::out | std::ios::trunc);
+  out << "not the sst";
+  out.close();
+
+  ASSERT_TRUE(WriteDumpSstIdentities(&db_, kInstanceNum, dump_path_).ok());
+  SstIdentityMap dumped;
+  ASSERT_TRUE(ReadDumpSstIdentities(dump_path_, &dumped).ok());
+  ASSERT_EQ(dumped.size(), live.size() - 1);
+  ASSERT_TRUE(dumped.find(changed) == dumped.end());
+
+  // Malformed lines are skipped
+  std::ofstream append(dump_path_ + "/" + kBgsaveSstMetaFile, std::ios::out | std::ios::app);
+  append << "0/000001.sst not_a_size\n";
+  // Lines of older dumps have no unique id, their files are never reused
+  append << "0/000002.sst 4096 FileChecksumCrc32c 0a1b2c3d\n";
+  append.close();
+  SstIdentityMap reread;
+  ASSERT_TRUE(ReadDumpSstIdentities(dump_path_, &reread).ok());
+  ASSERT_EQ(reread.size(), dumped.size() + 1);
+  ASSERT_TRUE(reread["0/000002.sst"].unique_id.empty());
+  ASSERT_FALSE(reread["0/000002.sst"].SameContent(reread["0/000002.sst"]));
+}
+
+TEST_F(SstIdentityTest, SameNameTest) {
+  // Another DB written the same way numbers its files the same
+  const std::string other_path = "./db/sst_identity_other";
+  pstd::DeleteDirIfExist(other_path);
+  pstd::CreatePath(other_path);
+  storage::Storage other;
+  ASSERT_TRUE(other.Open(storage_options_, other_path).ok());
+  Fill(&db_, std::string(100, 'v'));
+  Fill(&other, std::string(100, 'w'));
+
+  SstIdentityMap live;
+  GetLiveSstIdentities(&db_, kInstanceNum, &live);
+  SstIdentityMap other_live;
+  GetLiveSstIdentities(&other, kInstanceNum, &other_live);
+  int same_name = 0;
+  for (const auto& [name, sst] : live) {
+    auto iter = other_live.find(name);
+    if (iter == other_live.end()) {
+      continue;
+    }
+    same_name++;
+    // Same name, different content, told apart by the unique id
+    ASSERT_NE(iter->second.unique_id, sst.unique_id) << name;
+    ASSERT_FALSE(iter->second.SameContent(sst)) << name;
+  }
+  ASSERT_GT(same_name, 0);
+
+  // Even a file of the same size and checksum is not taken for another one
+  const SstIdentity& sst = live.begin()->second;
+  SstIdentity forged = sst;
+  forged.unique_id = other_live.begin()->second.unique_id;
+  ASSERT_FALSE(sst.SameContent(forged));
+}
+
+TEST_F(SstIdentityTest, SameContentTest) {
+  SstIdentity sst{4096, "FileChecksumCrc32c", "0a1b2c3d", "5e6f", "/data/db/0/000007.sst"};
+  SstIdentity same{4096, "FileChecksumCrc32c", "0a1b2c3d", "5e6f", ""};
+  ASSERT_TRUE(sst.SameContent(same));
+
+  // A file of the same name is transferred when anything else differs
+  SstIdentity other_size = same;
+  other_size.size = 4097;
+  ASSERT_FALSE(sst.SameContent(other_size));
+  SstIdentity other_checksum = same;
+  other_checksum.checksum = "0a1b2c3e";
+  ASSERT_FALSE(sst.SameContent(other_checksum));
+  SstIdentity other_func = same;
+  other_func.checksum_func = "FileChecksumSha1";
+  ASSERT_FALSE(sst.SameContent(other_func));
+  SstIdentity other_id = same;
+  other_id.unique_id = "5e70";
+  ASSERT_FALSE(sst.SameContent(other_id));
+
+  // Dumps taken before the identities were recorded
+  SstIdentityMap ssts;
+  ASSERT_TRUE(ReadDumpSstIdentities("./dump/sst_identity_none", &ssts).IsNotFound());
+  ASSERT_TRUE(ssts.empty());
+}
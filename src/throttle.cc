@@ -51,6 +51,8 @@ void Throttle::ReturnUnusedThroughput(size_t acquired, size_t consumed, size_t e
     // Tokens are aqured in last cycle, ignore
     return;
   }
-  cur_throughput_bytes_ = std::max(cur_throughput_bytes_ - (acquired - consumed), size_t(0));
+  // Unsigned, so compared first rather than clamped after
+  size_t unused = acquired - consumed;
+  cur_throughput_bytes_ = cur_throughput_bytes_ > unused ? cur_throughput_bytes_ - unused : 0;
 }
 }  // namespace rsync
@@ -5,6 +5,8 @@ import (
 	"fmt"
 	"log"
 	"math/rand"
+	"regexp"
+	"strconv"
 	"strings"
 	"sync"
 	"time"
@@ -43,6 +45,31 @@ func trySlave(ctx context.Context, clientSlave *redis.Client, ip string, port st
 	}
 }
 
+// Full syncs the slave from the master even if it could resume from the binlog
+func tryForceSlave(ctx context.Context, clientSlave *redis.Client, ip string, port string) bool {
+	Expect(clientSlave.Do(ctx, "slaveof", ip, port, "force").Val()).To(Equal("OK"))
+	for count := 0; count <= 200; count++ {
+		infoRes := clientSlave.Info(ctx, "replication")
+		Expect(infoRes.Err()).NotTo(HaveOccurred())
+		if strings.Contains(infoRes.Val(), "master_link_status:up") {
+			return true
+		}
+		time.Sleep(100 * time.Millisecond)
+	}
+	return false
+}
+
+// The reused and transferred file counts of the last full sync of db0
+func fullSyncFiles(ctx context.Context, clientSlave *redis.Client) (int64, int64) {
+	infoRes := clientSlave.Info(ctx, "replication")
+	Expect(infoRes.Err()).NotTo(HaveOccurred())
+	matches := regexp.MustCompile(`db0:reused_files=(\d+),reused_bytes=\d+,transferred_files=(\d+)`).FindStringSubmatch(infoRes.Val())
+	Expect(matches).To(HaveLen(3))
+	reused, _ := strconv.ParseInt(matches[1], 10, 64)
+	transferred, _ := strconv.ParseInt(matches[2], 10, 64)
+	return reused, transferred
+}
+
 func randomString(length int) string {
 	rand.Seed(time.Now().UnixNano())
 	b := make([]byte, length)
@@ -785,6 +812,95 @@ var _ = Describe("should replication ", func() {
 			log.Println("master-slave replication test success")
 		})
 
+		It("Compress the binlog sent to the slave", func() {
+			Expect(clientMaster.ConfigSet(ctx, "repl-compression", "lz4").Err()).NotTo(HaveOccurred())
+			Expect(clientMaster.ConfigSet(ctx, "repl-batch-max-delay-us", "2000").Err()).NotTo(HaveOccurred())
+			defer func() {
+				Expect(clientMaster.ConfigSet(ctx, "repl-compression", "none").Err()).NotTo(HaveOccurred())
+				Expect(clientMaster.ConfigSet(ctx, "repl-batch-max-delay-us", "0").Err()).NotTo(HaveOccurred())
+			}()
+			Expect(trySlave(ctx, clientSlave, LOCALHOST, MASTERPORT)).To(BeTrue())
+
+			value := strings.Repeat("compressible-binlog-", 50)
+			pipe := clientMaster.Pipeline()
+			for i := 0; i < 2000; i++ {
+				pipe.Set(ctx, fmt.Sprintf("compress_key_%d", i), value, 0)
+			}
+			_, err := pipe.Exec(ctx)
+			Expect(err).NotTo(HaveOccurred())
+			Eventually(func() string {
+				return clientSlave.Get(ctx, "compress_key_1999").Val()
+			}, "10s", "100ms").Should(Equal(value))
+
+			infoRes := clientMaster.Info(ctx, "replication")
+			Expect(infoRes.Err()).NotTo(HaveOccurred())
+			Expect(infoRes.Val()).To(ContainSubstring("repl_compression=lz4"))
+			matches := regexp.MustCompile(`repl_raw_bytes=(\d+),repl_wire_bytes=(\d+)`).FindStringSubmatch(infoRes.Val())
+			Expect(matches).To(HaveLen(3))
+			rawBytes, _ := strconv.ParseInt(matches[1], 10, 64)
+			wireBytes, _ := strconv.ParseInt(matches[2], 10, 64)
+			log.Printf("binlog bytes before compression: %d, on the wire: %d", rawBytes, wireBytes)
+			Expect(rawBytes).To(BeNumerically(">", 2000*len(value)))
+			Expect(wireBytes * 2).To(BeNumerically("<", rawBytes))
+		})
+
+		It("Reuse the SST files the slave already holds on a full sync", func() {
+			value := strings.Repeat("sst-reuse-", 100)
+			pipe := clientMaster.Pipeline()
+			for i := 0; i < 2000; i++ {
+				pipe.Set(ctx, fmt.Sprintf("sst_reuse_key_%d", i), value, 0)
+			}
+			_, err := pipe.Exec(ctx)
+			Expect(err).NotTo(HaveOccurred())
+			// Everything in SST files, which every dump of the master then holds
+			Expect(clientMaster.Do(ctx, "compact").Err()).NotTo(HaveOccurred())
+			time.Sleep(3 * time.Second)
+
+			Expect(tryForceSlave(ctx, clientSlave, LOCALHOST, MASTERPORT)).To(BeTrue())
+			Eventually(func() string {
+				return clientSlave.Get(ctx, "sst_reuse_key_1999").Val()
+			}, "10s", "100ms").Should(Equal(value))
+			_, transferred := fullSyncFiles(ctx, clientSlave)
+			Expect(transferred).To(BeNumerically(">", 0))
+
+			// The files pulled by the first full sync are kept by the second one
+			cleanEnv(ctx, clientMaster, clientSlave)
+			Expect(tryForceSlave(ctx, clientSlave, LOCALHOST, MASTERPORT)).To(BeTrue())
+			reused, _ := fullSyncFiles(ctx, clientSlave)
+			log.Printf("sst files reused by the second full sync: %d", reused)
+			Expect(reused).To(BeNumerically(">", 0))
+			for i := 0; i < 2000; i += 97 {
+				Expect(clientSlave.Get(ctx, fmt.Sprintf("sst_reuse_key_%d", i)).Val()).To(Equal(value))
+			}
+
+			// Both sides now write and compact on their own, so their new files
+			// may share a name while holding different keys. Only files of the
+			// same size and checksum are kept, the others are transferred.
+			cleanEnv(ctx, clientMaster, clientSlave)
+			pipe = clientSlave.Pipeline()
+			for i := 0; i < 2000; i++ {
+				pipe.Set(ctx, fmt.Sprintf("sst_slave_key_%d", i), value, 0)
+			}
+			_, err = pipe.Exec(ctx)
+			Expect(err).NotTo(HaveOccurred())
+			Expect(clientSlave.Do(ctx, "compact").Err()).NotTo(HaveOccurred())
+			pipe = clientMaster.Pipeline()
+			for i := 0; i < 2000; i++ {
+				pipe.Set(ctx, fmt.Sprintf("sst_master_key_%d", i), value+"master", 0)
+			}
+			_, err = pipe.Exec(ctx)
+			Expect(err).NotTo(HaveOccurred())
+			Expect(clientMaster.Do(ctx, "compact").Err()).NotTo(HaveOccurred())
+			time.Sleep(3 * time.Second)
+
+			Expect(tryForceSlave(ctx, clientSlave, LOCALHOST, MASTERPORT)).To(BeTrue())
+			_, transferred = fullSyncFiles(ctx, clientSlave)
+			Expect(transferred).To(BeNumerically(">", 0))
+			Expect(clientSlave.Get(ctx, "sst_master_key_1999").Val()).To(Equal(value + "master"))
+			Expect(clientSlave.Get(ctx, "sst_reuse_key_1999").Val()).To(Equal(value))
+			Expect(clientSlave.Exists(ctx, "sst_slave_key_1999").Val()).To(Equal(int64(0)))
+		})
+
 	})
 
 })
@@ -47,6 +47,29 @@ var _ = Describe("String Commands", func() {
 			Expect(get.Val()).To(Equal("Hello World"))
 		})
 
+		It("should batch pipelined SET", func() {
+			Expect(client.ConfigSet(ctx, "pipeline-write-batch", "yes").Err()).NotTo(HaveOccurred())
+			defer client.ConfigSet(ctx, "pipeline-write-batch", "no")
+
+			pipe := client.Pipeline()
+			for i := 0; i < 100; i++ {
+				pipe.Set(ctx, "pipe_key_"+strconv.Itoa(i), "v"+strconv.Itoa(i), 0)
+			}
+			get := pipe.Get(ctx, "pipe_key_7")
+			pipe.Set(ctx, "pipe_key_7", "overwritten", 0)
+			pipe.Set(ctx, "pipe_key_7", "last", 0)
+			cmds, err := pipe.Exec(ctx)
+			Expect(err).NotTo(HaveOccurred())
+			Expect(len(cmds)).To(Equal(103))
+			for _, cmd := range cmds {
+				Expect(cmd.Err()).NotTo(HaveOccurred())
+			}
+			Expect(get.Val()).To(Equal("v7"))
+			Expect(client.Get(ctx, "pipe_key_7").Val()).To(Equal("last"))
+			Expect(client.Get(ctx, "pipe_key_99").Val()).To(Equal("v99"))
+			Expect(client.Info(ctx, "stats").Val()).To(ContainSubstring("pipeline_write_batches:"))
+		})
+
 		It("should BitCount", func() {
 			set := client.Set(ctx, "key", "foobar", 0)
 			Expect(set.Err()).NotTo(HaveOccurred())
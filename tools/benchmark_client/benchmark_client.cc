@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <algorithm>
 #include <chrono>
 #include <ctime>
 #include <functional>
@@ -33,6 +34,9 @@ DEFINE_int32(thread_num, 10, "concurrent thread num");
 DEFINE_string(dbs, "0", "dbs name, eg: 0,1,2");
 DEFINE_int32(element_count, 1, "elements number in hash/list/set/zset");
 DEFINE_bool(compare_value, false, "whether compare result or not");
+DEFINE_int32(pipeline_depth, 500, "commands sent per round by pipeline_set");
+DEFINE_string(pipeline_write_batch, "",
+              "yes/no, set pipeline-write-batch on the server before the benchmark, empty keeps the server setting");
 
 using std::default_random_engine;
 using pstd::Status;
@@ -194,6 +198,11 @@ void PrintInfo(const std::time_t& now) {
   std::cout << "Payload size : " << FLAGS_value_size << std::endl;
   std::cout << "Number of request : " << FLAGS_count << std::endl;
   std::cout << "Transmit mode: " << (FLAGS_pipeline ? "Pipeline" : "No Pipeline") << std::endl;
+  if (FLAGS_command == "pipeline_set") {
+    std::cout << "Pipeline depth: " << FLAGS_pipeline_depth << std::endl;
+    std::cout << "Pipeline write batch: "
+              << (FLAGS_pipeline_write_batch.empty() ? "server setting" : FLAGS_pipeline_write_batch) << std::endl;
+  }
   std::cout << "Collection of dbs: " << FLAGS_dbs << std::endl;
   std::cout << "Elements num: " << FLAGS_element_count << std::endl;
   std::cout << "CompareValue : " << FLAGS_compare_value << std::endl;
@@ -588,6 +597,76 @@ Status RunSetCommand(redisContext*& c, ThreadArg* arg) {
   return Status::OK();
 }
 
+// Sends pipeline_depth SETs at a time, the latency recorded is per round
+Status RunPipelineSetCommand(redisContext*& c, ThreadArg* arg) {
+  std::vector<std::string> keys;
+  PrepareKeys(arg->idx, &keys);
+
+  int depth = std::max(FLAGS_pipeline_depth, 1);
+  for (int idx = 0; idx < FLAGS_count; idx += depth) {
+    if (idx % 10000 < depth) {
+      LOG(INFO) << "finish " << idx << " request";
+    }
+    int round = std::min(depth, FLAGS_count - idx);
+    std::vector<std::string> values(round);
+    uint64_t begin = pstd::NowMicros();
+    for (int i = 0; i < round; i++) {
+      const std::string& key = keys[idx + i];
+      GenerateValue(key, FLAGS_value_size, &values[i]);
+      const char* set_argv[3] = {"set", key.c_str(), values[i].c_str()};
+      size_t set_argvlen[3] = {3, key.size(), values[i].size()};
+      redisAppendCommandArgv(c, 3, reinterpret_cast<const char**>(set_argv),
+                             reinterpret_cast<const size_t*>(set_argvlen));
+    }
+
+    for (int i = 0; i < round; i++) {
+      redisReply* res = nullptr;
+      if (redisGetReply(c, reinterpret_cast<void**>(&res)) != REDIS_OK || !res) {
+        LOG(INFO) << FLAGS_command << " timeout, key: " << keys[idx + i];
+        arg->stat.timeout_cnt += round - i;
+        redisFree(c);
+        c = Prepare(arg);
+        if (!c) {
+          return Status::InvalidArgument("reconnect failed");
+        }
+        break;
+      }
+      if (res->type != REDIS_REPLY_STATUS) {
+        LOG(INFO) << FLAGS_command << " invalid type: " << res->type << " key: " << keys[idx + i];
+        arg->stat.error_cnt++;
+      } else {
+        arg->stat.success_cnt++;
+      }
+      freeReplyObject(res);
+    }
+    hist->Add(pstd::NowMicros() - begin);
+  }
+  return Status::OK();
+}
+
+bool SetPipelineWriteBatch() {
+  if (FLAGS_pipeline_write_batch.empty()) {
+    return true;
+  }
+  ThreadArg arg(0, tables[0], 0);
+  redisContext* c = Prepare(&arg);
+  if (!c) {
+    return false;
+  }
+  const char* config_argv[4] = {"config", "set", "pipeline-write-batch", FLAGS_pipeline_write_batch.data()};
+  size_t config_argvlen[4] = {6, 3, 20, FLAGS_pipeline_write_batch.size()};
+  auto res = reinterpret_cast<redisReply*>(
+      redisCommandArgv(c, 4, reinterpret_cast<const char**>(config_argv),
+                       reinterpret_cast<const size_t*>(config_argvlen)));
+  bool ok = res && res->type == REDIS_REPLY_STATUS;
+  if (!ok) {
+    printf("Config set pipeline-write-batch failed: %s\n", res ? res->str : c->errstr);
+  }
+  freeReplyObject(res);
+  redisFree(c);
+  return ok;
+}
+
 Status RunZAddCommand(redisContext*& c, ThreadArg* arg) {
   redisReply* res = nullptr;
   std::vector<std::pair<std::string, std::set<std::string>>> keys;
@@ -812,6 +891,8 @@ void* ThreadMain(void* arg) {
     s = RunGetCommand(c, ta);
   } else if (FLAGS_command == "set") {
     s = RunSetCommand(c, ta);
+  } else if (FLAGS_command == "pipeline_set") {
+    s = RunPipelineSetCommand(c, ta);
   } else if (FLAGS_command == "hset") {
     s = RunHSetCommand(c, ta);
   } else if (FLAGS_command == "hgetall") {
@@ -854,6 +935,9 @@ int main(int argc, char* argv[]) {
   std::chrono::system_clock::time_point start_time = std::chrono::system_clock::now();
   std::time_t now = std::chrono::system_clock::to_time_t(start_time);
   PrintInfo(now);
+  if (FLAGS_command != "generate" && !SetPipelineWriteBatch()) {
+    exit(-1);
+  }
 
   for (const auto& table : tables) {
     for (int idx = 0; idx < FLAGS_thread_num; ++idx) {
@@ -883,6 +967,9 @@ int main(int argc, char* argv[]) {
   std::cout << "Total Time Cost : " << hours << " hours " << minutes % 60 << " minutes " << seconds % 60 << " seconds "
             << std::endl;
   std::cout << "Timeout Count: " << stat.timeout_cnt << " Error Count: " << stat.error_cnt << std::endl;
+  auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+  int64_t qps = millis == 0 ? 0 : static_cast<int64_t>(stat.success_cnt) * 1000 / millis;
+  std::cout << "Throughput: " << qps << " requests/s" << std::endl;
   std::cout << "stats: " << hist->ToString() << std::endl;
   return 0;
 }
@@ -0,0 +1,246 @@
+// Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+// Measures the throughput of the full sync file transfer over loopback. The
+// RsyncServer of pika serves the files of a directory the way a master serves
+// its dump, and workers pull them with the RsyncFetcher of the rsync client of
+// a slave, within a fixed or an adaptive window of chunk requests in flight.
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "include/rsync_fetcher.h"
+#include "include/rsync_server.h"
+#include "include/rsync_window.h"
+#include "include/throttle.h"
+#include "net/include/net_stats.h"
+#include "pstd/include/env.h"
+#include "pstd/include/pstd_string.h"
+
+DEFINE_string(dir, "", "directory of the files to serve, filled with generated files if empty");
+DEFINE_int32(file_num, 8, "number of files generated when dir is empty");
+DEFINE_int32(file_size_mb, 256, "size of each file generated when dir is empty");
+DEFINE_int32(port, 19221, "loopback port of the rsync server");
+DEFINE_int32(workers, 4, "concurrent workers, each one pulls its share of the files");
+DEFINE_int32(server_threads, 4, "threads of the rsync server reading the files");
+DEFINE_int32(chunk_kb, 4096, "size of each chunk request");
+DEFINE_string(windows, "1,2,4,8,adaptive", "window sizes to run, adaptive widens it up to max_window");
+DEFINE_int32(max_window, 16, "largest window of the adaptive run");
+DEFINE_int32(timeout_ms, 10000, "receive timeout of the workers");
+DEFINE_int32(rtt_us, 0, "delay before each response is sent, emulates the round trip to a remote master");
+DEFINE_int32(throttle_mb, 10240, "bandwidth the workers share, like throttle-bytes-per-second of pika");
+
+extern std::unique_ptr<net::NetworkStatistic> g_network_statistic;
+
+const std::string kSnapshotUuid = "rsync_benchmark";
+const std::string kDBName = "db0";
+
+// Serves FLAGS_dir as the dump of every DB
+class BenchDumpProvider : public rsync::RsyncDumpProvider {
+ public:
+  pstd::Status GetDumpMeta(const std::string& db_name, std::string* snapshot_uuid,
+                           RsyncService::MetaResponse* meta) override {
+    *snapshot_uuid = kSnapshotUuid;
+    return pstd::Status::OK();
+  }
+
+  pstd::Status GetDumpPath(const std::string& db_name, std::string* snapshot_uuid, std::string* dump_path) override {
+    // Holds a server thread, as a response on its way back from a remote master would
+    if (FLAGS_rtt_us > 0) {
+      std::this_thread::sleep_for(std::chrono::microseconds(FLAGS_rtt_us));
+    }
+    *snapshot_uuid = kSnapshotUuid;
+    *dump_path = FLAGS_dir;
+    return pstd::Status::OK();
+  }
+};
+
+bool GenerateFiles(std::vector<std::pair<std::string, size_t>>* files) {
+  char dir_template[] = "/tmp/rsync_benchmark.XXXXXX";
+  if (mkdtemp(dir_template) == nullptr) {
+    std::cerr << "create temporary directory failed: " << strerror(errno) << std::endl;
+    return false;
+  }
+  FLAGS_dir = dir_template;
+  std::string block(1 << 20, '\0');
+  std::mt19937_64 rand(0);
+  for (auto& c : block) {
+    c = static_cast<char>(rand());
+  }
+  for (int i = 0; i < FLAGS_file_num; i++) {
+    std::string filename = "0/" + std::to_string(i) + ".sst";
+    pstd::CreatePath(FLAGS_dir + "/0");
+    int fd = open((FLAGS_dir + "/" + filename).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      std::cerr << "create " << filename << " failed: " << strerror(errno) << std::endl;
+      return false;
+    }
+    for (int mb = 0; mb < FLAGS_file_size_mb; mb++) {
+      // Vary each block a little so that nothing can be deduplicated
+      block[mb % block.size()]++;
+      if (write(fd, block.data(), block.size()) != static_cast<ssize_t>(block.size())) {
+        std::cerr << "write " << filename << " failed: " << strerror(errno) << std::endl;
+        close(fd);
+        return false;
+      }
+    }
+    close(fd);
+    files->emplace_back(filename, static_cast<size_t>(FLAGS_file_size_mb) << 20);
+  }
+  return true;
+}
+
+bool ListFiles(std::vector<std::pair<std::string, size_t>>* files) {
+  std::vector<std::string> subdirs;
+  if (pstd::GetChildren(FLAGS_dir, subdirs) != 0) {
+    std::cerr << "list " << FLAGS_dir << " failed" << std::endl;
+    return false;
+  }
+  // The layout of a dump, one directory per db instance
+  for (const auto& subdir : subdirs) {
+    std::vector<std::string> children;
+    if (pstd::IsDir(FLAGS_dir + "/" + subdir) != 0 || pstd::GetChildren(FLAGS_dir + "/" + subdir, children) != 0) {
+      continue;
+    }
+    for (const auto& child : children) {
+      struct stat buf;
+      std::string filename = subdir + "/" + child;
+      if (pstd::IsDir(FLAGS_dir + "/" + filename) == 1 && stat((FLAGS_dir + "/" + filename).c_str(), &buf) == 0) {
+        files->emplace_back(filename, buf.st_size);
+      }
+    }
+  }
+  return !files->empty();
+}
+
+// Removes what a previous run pulled, the files are appended to
+bool ResetOutput(const std::string& out_dir, const std::vector<std::pair<std::string, size_t>>& files) {
+  pstd::DeleteDirIfExist(out_dir);
+  for (const auto& file : files) {
+    std::string filepath = out_dir + "/" + file.first;
+    std::string parent = filepath.substr(0, filepath.rfind('/'));
+    if (!pstd::FileExists(parent) && pstd::CreatePath(parent) != 0) {
+      std::cerr << "create directory of " << filepath << " failed" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+void RunWorker(int index, const std::vector<std::pair<std::string, size_t>>& files, size_t fixed_window,
+               rsync::RsyncFetcher* fetcher, std::atomic<bool>* failed) {
+  rsync::RsyncWindow window(fixed_window == 0 ? FLAGS_max_window : fixed_window, fixed_window == 0);
+  for (size_t i = index; i < files.size(); i += FLAGS_workers) {
+    pstd::Status s = fetcher->CopyRemoteFile(files[i].first, index, &window);
+    if (!s.ok()) {
+      std::cerr << "pull " << files[i].first << " failed: " << s.ToString() << std::endl;
+      failed->store(true);
+      break;
+    }
+  }
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  g_network_statistic = std::make_unique<net::NetworkStatistic>();
+  // The rsync server keeps a reader, and the client a wait object, per worker
+  FLAGS_workers = std::max(1, std::min(FLAGS_workers, kMaxRsyncParallelNum));
+
+  bool generated = FLAGS_dir.empty();
+  std::vector<std::pair<std::string, size_t>> files;
+  if (generated ? !GenerateFiles(&files) : !ListFiles(&files)) {
+    return 1;
+  }
+  size_t expected_bytes = 0;
+  for (const auto& file : files) {
+    expected_bytes += file.second;
+  }
+  char out_template[] = "/tmp/rsync_benchmark_out.XXXXXX";
+  if (mkdtemp(out_template) == nullptr) {
+    std::cerr << "create temporary directory failed: " << strerror(errno) << std::endl;
+    return 1;
+  }
+  const std::string out_dir = out_template;
+
+  rsync::RsyncServer server({"127.0.0.1"}, FLAGS_port, std::make_unique<BenchDumpProvider>(),
+                            FLAGS_server_threads);
+  if (server.Start() != net::kSuccess) {
+    std::cerr << "start rsync server on port " << FLAGS_port << " failed" << std::endl;
+    return 1;
+  }
+
+  rsync::WaitObjectManager wo_mgr;
+  rsync::RsyncClientThread client_thread(3000, 60, &wo_mgr);
+  client_thread.set_thread_name("RsyncClientThread");
+  if (client_thread.StartThread() != net::kSuccess) {
+    std::cerr << "start rsync client thread failed" << std::endl;
+    return 1;
+  }
+  rsync::Throttle throttle(static_cast<size_t>(FLAGS_throttle_mb) << 20, 10);
+  rsync::RsyncFetcher fetcher(out_dir, kDBName, &client_thread, &wo_mgr, &throttle);
+  fetcher.SetSource("127.0.0.1", FLAGS_port, kSnapshotUuid);
+  fetcher.SetChunkSize(static_cast<size_t>(FLAGS_chunk_kb) << 10);
+  fetcher.SetTimeout([] { return static_cast<int64_t>(FLAGS_timeout_ms); });
+
+  std::cout << "files: " << files.size() << ", bytes: " << expected_bytes << ", workers: " << FLAGS_workers
+            << ", chunk: " << FLAGS_chunk_kb << "KB" << std::endl;
+  std::vector<std::string> windows;
+  pstd::StringSplit(FLAGS_windows, ',', windows);
+  for (const auto& item : windows) {
+    size_t fixed_window = 0;
+    if (item != "adaptive") {
+      fixed_window = std::strtoul(item.c_str(), nullptr, 10);
+      if (fixed_window == 0) {
+        std::cerr << "invalid window " << item << std::endl;
+        continue;
+      }
+    }
+    if (!ResetOutput(out_dir, files)) {
+      break;
+    }
+    fetcher.ResetStats();
+    std::atomic<bool> failed = false;
+    uint64_t start_us = pstd::NowMicros();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < FLAGS_workers; i++) {
+      workers.emplace_back(RunWorker, i, std::cref(files), fixed_window, &fetcher, &failed);
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    double seconds = static_cast<double>(pstd::NowMicros() - start_us) / 1000000;
+    uint64_t total_bytes = fetcher.transferred_bytes();
+    if (failed.load() || total_bytes != expected_bytes) {
+      std::cerr << "window " << item << " failed, pulled " << total_bytes << " of " << expected_bytes << " bytes"
+                << std::endl;
+      continue;
+    }
+    printf("window %-8s %10.3f s %10.1f MB/s\n", item.c_str(), seconds,
+           static_cast<double>(total_bytes) / (1 << 20) / seconds);
+  }
+
+  client_thread.StopThread();
+  server.Stop();
+  pstd::DeleteDirIfExist(out_dir);
+  if (generated) {
+    pstd::DeleteDirIfExist(FLAGS_dir);
+  }
+  return 0;
+}
@@ -0,0 +1,95 @@
+//  Copyright (c) 2024-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <chrono>
+#include <iostream>
+
+#include "storage/storage.h"
+
+std::string src_db_path;
+std::string dst_db_path;
+int32_t db_instance_num = 3;
+int32_t slot_num = 1024;
+
+void PrintInfo(const std::time_t& now) {
+  std::cout << "================ Slot Prefix Converter =================" << std::endl;
+  std::cout << "Src_db_path : " << src_db_path << std::endl;
+  std::cout << "Dst_db_path : " << dst_db_path << std::endl;
+  std::cout << "Db_instance_num : " << db_instance_num << std::endl;
+  std::cout << "Slot_num : " << slot_num << std::endl;
+  std::cout << "Startup Time : " << asctime(localtime(&now));
+  std::cout << "========================================================" << std::endl;
+}
+
+void Usage() {
+  std::cout << "Usage: " << std::endl;
+  std::cout << "\tSlot_Prefix_Converter copies a stopped pika db into the slot prefix key layout," << std::endl;
+  std::cout << "\tthe result is used with slot-key-prefix : yes" << std::endl;
+  std::cout << "\t-h    -- displays this help information and exits" << std::endl;
+  std::cout << "\tdb_instance_num and slot_num must be the same as db-instance-num and default-slot-num" << std::endl;
+  std::cout << "\texample: ./slot_prefix_converter ./db/db0 ./new_db/db0 3 1024" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  if (argc != 5) {
+    Usage();
+    exit(-1);
+  }
+
+  src_db_path = std::string(argv[1]);
+  dst_db_path = std::string(argv[2]);
+  db_instance_num = atoi(argv[3]);
+  slot_num = atoi(argv[4]);
+  if (db_instance_num <= 0 || slot_num <= 0) {
+    Usage();
+    exit(-1);
+  }
+
+  std::chrono::system_clock::time_point start_time = std::chrono::system_clock::now();
+  std::time_t now = std::chrono::system_clock::to_time_t(start_time);
+  PrintInfo(now);
+
+  // The key layout is process wide and taken from the last opened storage,
+  // so the source must be opened before the target
+  storage::StorageOptions src_option;
+  auto src_db = new storage::Storage(db_instance_num, slot_num, true);
+  rocksdb::Status status = src_db->Open(src_option, src_db_path);
+  if (!status.ok()) {
+    std::cout << "Open source db failed, " << status.ToString() << std::endl;
+    return -1;
+  }
+
+  storage::StorageOptions dst_option;
+  dst_option.options.create_if_missing = true;
+  dst_option.options.write_buffer_size = 256 * 1024 * 1024;     // 256M
+  dst_option.options.target_file_size_base = 20 * 1024 * 1024;  // 20M
+  dst_option.slot_key_prefix = true;
+  auto dst_db = new storage::Storage(db_instance_num, slot_num, true);
+  status = dst_db->Open(dst_option, dst_db_path);
+  if (!status.ok()) {
+    std::cout << "Open target db failed, " << status.ToString() << std::endl;
+    return -1;
+  }
+
+  std::cout << "Start converting " << src_db_path << " to " << dst_db_path << "..." << std::endl;
+  int64_t converted = 0;
+  status = src_db->ConvertToSlotKeyPrefix(dst_db, &converted);
+
+  delete src_db;
+  delete dst_db;
+
+  std::chrono::system_clock::time_point end_time = std::chrono::system_clock::now();
+  now = std::chrono::system_clock::to_time_t(end_time);
+  auto cost = std::chrono::duration_cast<std::chrono::seconds>(end_time - start_time).count();
+  if (!status.ok()) {
+    std::cout << "Convert failed after " << converted << " records, " << status.ToString() << std::endl;
+    return -1;
+  }
+  std::cout << "====================== Convert Finish ===================" << std::endl;
+  std::cout << "Converted records : " << converted << std::endl;
+  std::cout << "Finish Time : " << asctime(localtime(&now));
+  std::cout << "Total Time Cost : " << cost << "s" << std::endl;
+  return 0;
+}